@@ -65,6 +65,20 @@ df = df.groupby(['col0', 'col1']).agg(sum=('col2', px.sum))
 px.display(df, '$0')
 )pxl";
 
+// Exercises every UDA that has a compiled grouped update, in a single aggregate.
+constexpr char kGroupByOneAllAggsQuery[] = R"pxl(
+import px
+df = px.DataFrame(table='test_table', select=['col0', 'col1'])
+df = df.groupby('col0').agg(
+    count=('col1', px.count),
+    sum=('col1', px.sum),
+    mean=('col1', px.mean),
+    min=('col1', px.min),
+    max=('col1', px.max),
+)
+px.display(df, '$0')
+)pxl";
+
 std::unique_ptr<Carnot> SetUpCarnot(std::shared_ptr<table_store::TableStore> table_store,
                                     LocalGRPCResultSinkServer* server) {
   auto func_registry = std::make_unique<px::carnot::udf::Registry>("default_registry");
@@ -198,6 +212,21 @@ BENCHMARK_CAPTURE(BM_Query_Int, eval_group_by_one_exponential_int,
     ->RangeMultiplier(2)
     ->Range(1, 1 << 16);
 
+BENCHMARK_CAPTURE(BM_Query_String, eval_group_by_one_string_all_aggs,
+                  {types::DataType::STRING, types::DataType::INT64},
+                  {datagen::DistributionType::kZipfian, datagen::DistributionType::kUniform},
+                  kGroupByOneAllAggsQuery, 20, sample_selection_params.get(),
+                  sample_length_params.get())
+    ->RangeMultiplier(2)
+    ->Range(1, 1 << 16);
+
+BENCHMARK_CAPTURE(BM_Query_Int, eval_group_by_one_uniform_int_all_aggs,
+                  {types::DataType::INT64, types::DataType::INT64},
+                  {datagen::DistributionType::kUniform, datagen::DistributionType::kUniform},
+                  kGroupByOneAllAggsQuery, 20)
+    ->RangeMultiplier(2)
+    ->Range(1, 1 << 16);
+
 }  // namespace exec
 }  // namespace carnot
 }  // namespace px
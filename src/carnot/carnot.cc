@@ -60,6 +60,9 @@ class CarnotImpl final : public Carnot {
 
   Status ExecutePlan(const planpb::Plan& plan, const sole::uuid& query_id, bool analyze) override;
 
+  Status RejectPlan(const planpb::Plan& plan, const sole::uuid& query_id,
+                    const Status& reason) override;
+
   void RegisterAgentMetadataCallback(AgentMetadataCallbackFunc func) override {
     agent_md_callback_ = func;
   };
@@ -172,6 +175,7 @@ Status CarnotImpl::RegisterUDFsInPlanFragment(exec::ExecState* exec_state, plan:
         return WalkExpression(exec_state, *filter.expression());
       })
       .OnLimit(no_op)
+      .OnTopK(no_op)
       .OnMemorySink(no_op)
       .OnMemorySource(no_op)
       .OnUnion(no_op)
@@ -273,12 +277,16 @@ Status SendFinalExecutionStatsToOutgoingConns(
 
   int64_t total_bytes_processed = 0;
   int64_t total_records_processed = 0;
+  int64_t total_result_cache_hits = 0;
+  int64_t total_result_cache_misses = 0;
 
   // Add all of the agent stats.
   for (const auto& agent_stats : all_agent_stats) {
     *(req.mutable_execution_and_timing_info()->add_agent_execution_stats()) = agent_stats;
     total_records_processed += agent_stats.records_processed();
     total_bytes_processed += agent_stats.bytes_processed();
+    total_result_cache_hits += agent_stats.result_cache_hits();
+    total_result_cache_misses += agent_stats.result_cache_misses();
   }
 
   // Add the stats for this particular agent.
@@ -286,6 +294,8 @@ Status SendFinalExecutionStatsToOutgoingConns(
   stats->mutable_timing()->set_execution_time_ns(agent_stats.execution_time_ns());
   stats->set_bytes_processed(total_bytes_processed);
   stats->set_records_processed(total_records_processed);
+  stats->set_result_cache_hits(total_result_cache_hits);
+  stats->set_result_cache_misses(total_result_cache_misses);
   return SendTransferResultChunkToOutgoingConns(outgoing_servers, add_auth_to_grpc_context_func,
                                                 std::move(req));
 }
@@ -345,6 +355,8 @@ Status CarnotImpl::ExecutePlan(const planpb::Plan& logical_plan, const sole::uui
   auto plan_state = engine_state_->CreatePlanState();
   int64_t bytes_processed = 0;
   int64_t rows_processed = 0;
+  int64_t result_cache_hits = 0;
+  int64_t result_cache_misses = 0;
   queryresultspb::AgentExecutionStats agent_operator_exec_stats;
   ToProto(agent_id_, agent_operator_exec_stats.mutable_agent_id());
   timer.Start();
@@ -367,6 +379,8 @@ Status CarnotImpl::ExecutePlan(const planpb::Plan& logical_plan, const sole::uui
             auto exec_stats = exec_graph.GetStats();
             bytes_processed += exec_stats.bytes_processed;
             rows_processed += exec_stats.rows_processed;
+            result_cache_hits += exec_stats.result_cache_hits;
+            result_cache_misses += exec_stats.result_cache_misses;
 
             if (analyze) {
               for (int64_t node_id : pf->dag().TopologicalSort()) {
@@ -445,11 +459,15 @@ Status CarnotImpl::ExecutePlan(const planpb::Plan& logical_plan, const sole::uui
   for (const auto& agent_stats : input_agent_stats) {
     bytes_processed += agent_stats.bytes_processed();
     rows_processed += agent_stats.records_processed();
+    result_cache_hits += agent_stats.result_cache_hits();
+    result_cache_misses += agent_stats.result_cache_misses();
   }
 
   agent_operator_exec_stats.set_execution_time_ns(timer.ElapsedTime_us() * 1000);
   agent_operator_exec_stats.set_bytes_processed(bytes_processed);
   agent_operator_exec_stats.set_records_processed(rows_processed);
+  agent_operator_exec_stats.set_result_cache_hits(result_cache_hits);
+  agent_operator_exec_stats.set_result_cache_misses(result_cache_misses);
 
   std::vector<queryresultspb::AgentExecutionStats> all_agent_stats;
   if (analyze) {
@@ -465,6 +483,16 @@ Status CarnotImpl::ExecutePlan(const planpb::Plan& logical_plan, const sole::uui
                                                 agent_operator_exec_stats, all_agent_stats);
 }
 
+Status CarnotImpl::RejectPlan(const planpb::Plan& plan, const sole::uuid& query_id,
+                              const Status& reason) {
+  auto exec_state = engine_state_->CreateExecState(query_id);
+  auto outgoing_conns = GetOutgoingConns(exec_state.get(), plan);
+  PX_RETURN_IF_ERROR(InitiateOutgoingConns(query_id, outgoing_conns,
+                                           engine_state_->add_auth_to_grpc_context_func()));
+  return SendErrorToOutgoingConns(query_id, outgoing_conns,
+                                  engine_state_->add_auth_to_grpc_context_func(), reason);
+}
+
 CarnotImpl::~CarnotImpl() {
   if (grpc_server_ && grpc_server_thread_) {
     grpc_server_->Shutdown();
@@ -81,6 +81,15 @@ class Carnot : public NotCopyable {
   virtual Status ExecutePlan(const planpb::Plan& plan, const sole::uuid& query_id,
                              bool analyze = false) = 0;
 
+  /**
+   * Fails the given logical plan without executing it, by sending the error to the execution
+   * status destinations of the plan.
+   *
+   * @param reason the error that the query failed with.
+   */
+  virtual Status RejectPlan(const planpb::Plan& plan, const sole::uuid& query_id,
+                            const Status& reason) = 0;
+
   /**
    * Registers the callback for updating the agents metadata state.
    */
@@ -1112,6 +1112,18 @@ TEST_F(CarnotTest, result_server_receives_execution_errors_created_by_carnot) {
               ::testing::MatchesRegex(".*No UDF matching upid_to_service_name.*"));
 }
 
+TEST_F(CarnotTest, result_server_receives_rejected_plan_error) {
+  planpb::Plan plan;
+  ASSERT_TRUE(google::protobuf::TextFormat::MergeFromString(kErrorNodePlan, &plan));
+
+  ASSERT_OK(
+      carnot_->RejectPlan(plan, sole::uuid4(), error::ResourceUnavailable("too many queries")));
+
+  auto errors = result_server_->exec_errors();
+  EXPECT_EQ(errors.size(), 1);
+  EXPECT_THAT(errors[0].DebugString(), ::testing::MatchesRegex(".*too many queries.*"));
+}
+
 constexpr char kGRPCSourcePlan[] = R"proto(
 execution_status_destinations {
   grpc_address: "result_addr"
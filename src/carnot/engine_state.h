@@ -26,6 +26,9 @@
 
 #include "src/carnot/exec/exec_metrics.h"
 #include "src/carnot/exec/exec_state.h"
+#include "src/carnot/exec/memory_tracker.h"
+#include "src/carnot/exec/morsel_executor.h"
+#include "src/carnot/exec/result_cache.h"
 #include "src/carnot/funcs/funcs.h"
 #include "src/carnot/plan/plan_state.h"
 #include "src/carnot/planner/compiler_state/compiler_state.h"
@@ -59,7 +62,17 @@ class EngineState : public NotCopyable {
         add_auth_to_grpc_context_func_(add_auth_to_grpc_context_func),
         grpc_router_(grpc_router),
         model_pool_(std::move(model_pool)),
-        metrics_(std::make_unique<ExecMetrics>(&(GetMetricsRegistry()))) {}
+        metrics_(std::make_unique<ExecMetrics>(&(GetMetricsRegistry()))),
+        memory_tracker_(std::make_shared<exec::MemoryTracker>(
+            "Carnot", FLAGS_carnot_node_memory_limit_bytes)) {
+    if (FLAGS_carnot_result_cache_bytes > 0) {
+      result_cache_ = std::make_unique<exec::ResultCache>(FLAGS_carnot_result_cache_bytes,
+                                                          FLAGS_carnot_result_cache_bucket_ns);
+    }
+    if (FLAGS_carnot_exec_threads > 1) {
+      morsel_executor_ = std::make_unique<exec::MorselExecutor>(FLAGS_carnot_exec_threads);
+    }
+  }
 
   static StatusOr<std::unique_ptr<EngineState>> CreateDefault(
       std::unique_ptr<udf::Registry> func_registry,
@@ -79,7 +92,7 @@ class EngineState : public NotCopyable {
 
   table_store::TableStore* table_store() { return table_store_.get(); }
   std::unique_ptr<exec::ExecState> CreateExecState(const sole::uuid& query_id) {
-    return std::make_unique<exec::ExecState>(
+    auto exec_state = std::make_unique<exec::ExecState>(
         func_registry_.get(), table_store_, stub_generator_,
         [this](const std::string& remote_addr, bool insecure) {
           return MetricsStubGenerator(remote_addr, insecure);
@@ -87,7 +100,10 @@ class EngineState : public NotCopyable {
         [this](const std::string& remote_addr, bool insecure) {
           return TraceStubGenerator(remote_addr, insecure);
         },
-        query_id, model_pool_.get(), grpc_router_, add_auth_to_grpc_context_func_, metrics_.get());
+        query_id, model_pool_.get(), grpc_router_, add_auth_to_grpc_context_func_, metrics_.get(),
+        result_cache_.get(), memory_tracker_);
+    exec_state->set_morsel_executor(morsel_executor_.get());
+    return exec_state;
   }
   std::shared_ptr<grpc::Channel> CreateChannel(const std::string& remote_addr, bool insecure) {
     grpc::ChannelArguments args;
@@ -139,6 +155,9 @@ class EngineState : public NotCopyable {
 
   udf::ModelPool* model_pool() const { return model_pool_.get(); }
 
+  // Accounts the memory of all the queries in flight, against --carnot_node_memory_limit_bytes.
+  const exec::MemoryTracker* memory_tracker() const { return memory_tracker_.get(); }
+
  private:
   std::unique_ptr<udf::Registry> func_registry_;
   std::shared_ptr<table_store::TableStore> table_store_;
@@ -148,6 +167,12 @@ class EngineState : public NotCopyable {
   exec::GRPCRouter* grpc_router_ = nullptr;
   std::unique_ptr<udf::ModelPool> model_pool_;
   std::unique_ptr<ExecMetrics> metrics_;
+  // nullptr if --carnot_result_cache_bytes is 0.
+  std::unique_ptr<exec::ResultCache> result_cache_;
+  // Shared with the trackers of the queries, which can outlive the engine state.
+  std::shared_ptr<exec::MemoryTracker> memory_tracker_;
+  // nullptr if --carnot_exec_threads is 1.
+  std::unique_ptr<exec::MorselExecutor> morsel_executor_;
 };
 
 }  // namespace carnot
@@ -34,52 +34,42 @@
 #include "src/shared/types/arrow_adapter.h"
 #include "src/shared/types/type_utils.h"
 #include "src/shared/types/types.h"
+#include "src/table_store/schema/dictionary_encoding.h"
 
 namespace px {
 namespace carnot {
 namespace exec {
 
 using SharedArray = std::shared_ptr<arrow::Array>;
-constexpr int64_t kAggCompactionThreshold = 512;
 
 using table_store::schema::RowBatch;
 using table_store::schema::RowDescriptor;
 
-namespace {
-template <types::DataType DT>
-void ExtractIntoGroupArgs(std::vector<GroupArgs>* group_args, arrow::Array* col, int rt_col_idx) {
-  auto num_rows = col->length();
-  for (auto row_idx = 0; row_idx < num_rows; ++row_idx) {
-    ExtractIntoRowTuple<DT>((*group_args)[row_idx].rt, col, rt_col_idx, row_idx);
-  }
-}
-
-template <types::DataType DT>
-void AppendToBuilder(arrow::ArrayBuilder* builder, RowTuple* rt, size_t rt_idx) {
-  using ArrowBuilder = typename types::DataTypeTraits<DT>::arrow_builder_type;
-  using ValueType = typename types::DataTypeTraits<DT>::value_type;
-  auto status =
-      static_cast<ArrowBuilder*>(builder)->Append(udf::UnWrap(rt->GetValue<ValueType>(rt_idx)));
-  PX_DCHECK_OK(status);
-  PX_UNUSED(status);
+UDAStateArena::UDAStateArena(udf::UDADefinition* def)
+    : def_(def),
+      stride_((def->state_size() + def->state_alignment() - 1) / def->state_alignment() *
+              def->state_alignment()) {}
+
+udf::UDA* UDAStateArena::Add() {
+  size_t idx_in_chunk = states_.size() % kStatesPerChunk;
+  if (idx_in_chunk == 0) {
+    auto alignment = def_->state_alignment();
+    chunks_.emplace_back(static_cast<uint8_t*>(::operator new(kStatesPerChunk * stride_,
+                                                              std::align_val_t(alignment))),
+                         ChunkDeleter{alignment});
+  }
+  states_.push_back(def_->MakeAt(chunks_.back().get() + idx_in_chunk * stride_));
+  return states_.back();
 }
 
-template <types::DataType DT>
-void ExtractToColumnWrapper(const std::vector<GroupArgs>& group_args,
-                            const table_store::schema::RowBatch& rb, size_t col_idx,
-                            size_t rb_col_idx) {
-  size_t num_rows = rb.num_rows();
-  DCHECK(num_rows <= group_args.size());
-  for (size_t row_idx = 0; row_idx < num_rows; ++row_idx) {
-    DCHECK(group_args[row_idx].av != nullptr);
-    auto col_wrapper = group_args[row_idx].av->agg_cols[col_idx].get();
-    auto arr = rb.ColumnAt(rb_col_idx).get();
-    types::ExtractValueToColumnWrapper<DT>(col_wrapper, arr, row_idx);
+void UDAStateArena::Clear() {
+  for (auto* state : states_) {
+    state->~UDA();
   }
+  states_.clear();
+  chunks_.clear();
 }
 
-}  // namespace
-
 std::string AggNode::DebugStringImpl() {
   return absl::Substitute("Exec::AggNode<$0>", plan_node_->DebugString());
 }
@@ -110,6 +100,25 @@ Status AggNode::InitImpl(const plan::Operator& plan_node) {
     return error::InvalidArgument("Output size mismatch in aggregate");
   }
 
+  if (IsSlidingWindow()) {
+    const auto& window = plan_node_->sliding_window();
+    if (!plan_node_->partial_agg()) {
+      return error::InvalidArgument("Sliding window aggregates must perform the partial aggregate");
+    }
+    if (window.slide_ns() <= 0 || window.window_ns() <= 0 ||
+        window.window_ns() % window.slide_ns() != 0) {
+      return error::InvalidArgument(
+          "Sliding window of $0ns must be a positive multiple of its slide of $1ns",
+          window.window_ns(), window.slide_ns());
+    }
+    auto time_idx = window.time_column().index();
+    if (time_idx >= input_descriptor_->size() ||
+        (input_descriptor_->type(time_idx) != types::INT64 &&
+         input_descriptor_->type(time_idx) != types::TIME64NS)) {
+      return error::InvalidArgument("Sliding window time column must be an INT64 or TIME64NS column");
+    }
+  }
+
   if (HasNoGroups()) {
     return Status::OK();
   }
@@ -118,23 +127,15 @@ Status AggNode::InitImpl(const plan::Operator& plan_node) {
    * Init specific for group by agg.
    */
 
-  // Compute the group and value data types.
+  // Compute the group data types.
   // The case of GroupByNone, there will be no groups.
-  auto groups_size = plan_node_->groups().size();
-  group_data_types_.reserve(groups_size);
+  group_data_types_.reserve(plan_node_->groups().size());
   for (const auto& group : plan_node_->groups()) {
     DCHECK(group.idx < input_descriptor_->size());
     group_data_types_.emplace_back(input_descriptor_->type(group.idx));
   }
-
-  auto values_size = plan_node_->values().size();
-  for (size_t i = 0; i < values_size; ++i) {
-    auto values_idx = i + groups_size;
-    DCHECK(values_idx < output_descriptor_->size());
-    value_data_types_.emplace_back(output_descriptor_->type(values_idx));
-  }
-
-  return CreateColumnMapping();
+  group_key_table_ = std::make_unique<GroupKeyTable>(group_data_types_);
+  return Status::OK();
 }
 
 Status AggNode::PrepareImpl(ExecState* exec_state) {
@@ -143,27 +144,89 @@ Status AggNode::PrepareImpl(ExecState* exec_state) {
 }
 
 Status AggNode::OpenImpl(ExecState* exec_state) {
+  for (const auto& value : plan_node_->values()) {
+    auto& init_args = value_init_args_.emplace_back();
+    for (const auto& arg : value->init_arguments()) {
+      init_args.push_back(arg.ToBaseValueType());
+    }
+  }
   if (HasNoGroups()) {
     PX_RETURN_IF_ERROR(CreateUDAInfoValues(&udas_no_groups_, exec_state));
+  } else {
+    for (const auto& value : plan_node_->values()) {
+      value_states_.push_back(
+          std::make_unique<UDAStateArena>(exec_state->GetUDADefinition(value->uda_id())));
+    }
   }
-  if (!plan_node_->partial_agg()) {
+  state_memory_.set_tracker(exec_state->memory_tracker());
+  // Cached buckets are merged from their serialized states.
+  if (!plan_node_->partial_agg() || result_cache_session_ != nullptr) {
     PX_RETURN_IF_ERROR(CreateUDAInfoValues(&udas_for_deserialize_, exec_state));
   }
   return Status::OK();
 }
 
+void AggNode::UseResultCache(ResultCacheSession* session) {
+  DCHECK(plan_node_->partial_agg() && !plan_node_->windowed() && !IsSlidingWindow());
+  result_cache_session_ = session;
+}
+
 Status AggNode::ConsumeNextImpl(ExecState* exec_state, const RowBatch& rb, size_t) {
-  if (HasNoGroups()) {
-    return AggregateGroupByNone(exec_state, rb);
+  if (rb.has_selection()) {
+    selected_columns_.assign(rb.num_columns(), nullptr);
+  }
+  if (rb.HasDictionaryColumns()) {
+    decoded_columns_.assign(rb.num_columns(), nullptr);
+  }
+  if (result_cache_session_ != nullptr) {
+    PX_RETURN_IF_ERROR(AggregateWithResultCache(exec_state, rb));
+  } else if (IsSlidingWindow()) {
+    PX_RETURN_IF_ERROR(AggregateSlidingWindow(exec_state, rb));
+  } else if (HasNoGroups()) {
+    PX_RETURN_IF_ERROR(AggregateGroupByNone(exec_state, rb));
+  } else {
+    PX_RETURN_IF_ERROR(AggregateGroupByClause(exec_state, rb));
   }
-  return AggregateGroupByClause(exec_state, rb);
+  // The groups and their states aren't allocated from the exec memory pool, so they are accounted
+  // for separately.
+  return state_memory_.Resize(StateBytes());
+}
+
+int64_t AggNode::StateBytes() const {
+  int64_t bytes = 0;
+  if (group_key_table_ != nullptr) {
+    bytes += group_key_table_->NumBytes();
+  }
+  for (const auto& states : value_states_) {
+    bytes += states->NumBytes();
+  }
+  for (const auto& entry : panes_) {
+    const Pane& pane = entry.second;
+    if (pane.group_key_table != nullptr) {
+      bytes += pane.group_key_table->NumBytes();
+    }
+    for (const auto& states : pane.value_states) {
+      bytes += states->NumBytes();
+    }
+  }
+  return bytes;
 }
 
 Status AggNode::CloseImpl(ExecState*) {
+  PX_RETURN_IF_ERROR(state_memory_.Resize(0));
+  if (IsSlidingWindow()) {
+    stats()->AddExtraInfo("late_rows_dropped", std::to_string(late_rows_dropped_));
+  }
+  if (result_cache_session_ != nullptr) {
+    stats()->AddExtraInfo("result_cache_hits", std::to_string(result_cache_session_->hits()));
+    stats()->AddExtraInfo("result_cache_misses", std::to_string(result_cache_session_->misses()));
+  }
+  panes_.clear();
   udas_no_groups_.clear();
-  group_args_chunk_.clear();
-  group_args_pool_.Clear();
-  udas_pool_.Clear();
+  value_states_.clear();
+  if (group_key_table_ != nullptr) {
+    group_key_table_->Clear();
+  }
 
   return Status::OK();
 }
@@ -177,7 +240,12 @@ Status AggNode::ClearAggState(ExecState* exec_state) {
     udas_no_groups_.clear();
     PX_RETURN_IF_ERROR(CreateUDAInfoValues(&udas_no_groups_, exec_state));
   }
-  agg_hash_map_.clear();
+  if (!HasNoGroups()) {
+    group_key_table_->Clear();
+    for (auto& states : value_states_) {
+      states->Clear();
+    }
+  }
   return Status::OK();
 }
 
@@ -194,23 +262,7 @@ Status AggNode::AggregateGroupByNone(ExecState* exec_state, const RowBatch& rb)
 
   if (ReadyToEmitBatches(rb)) {
     RowBatch output_rb(*output_descriptor_, 1);
-    for (size_t i = 0; i < values.size(); ++i) {
-      const auto& uda_info = udas_no_groups_[i];
-      std::unique_ptr<arrow::ArrayBuilder> builder;
-      if (plan_node_->finalize_results()) {
-        builder = types::MakeArrowBuilder(uda_info.def->finalize_return_type(),
-                                          exec_state->exec_mem_pool());
-        PX_RETURN_IF_ERROR(
-            uda_info.def->FinalizeArrow(uda_info.uda.get(), function_ctx_.get(), builder.get()));
-      } else {
-        builder = types::MakeArrowBuilder(types::STRING, exec_state->exec_mem_pool());
-        PX_RETURN_IF_ERROR(
-            uda_info.def->SerializeArrow(uda_info.uda.get(), function_ctx_.get(), builder.get()));
-      }
-      SharedArray out_col;
-      PX_RETURN_IF_ERROR(builder->Finish(&out_col));
-      PX_RETURN_IF_ERROR(output_rb.AddColumn(out_col));
-    }
+    PX_RETURN_IF_ERROR(ConvertNoGroupsToRowBatch(exec_state, &output_rb));
     output_rb.set_eow(rb.eow());
     output_rb.set_eos(rb.eos());
     PX_RETURN_IF_ERROR(SendRowBatchToChildren(exec_state, output_rb));
@@ -219,190 +271,474 @@ Status AggNode::AggregateGroupByNone(ExecState* exec_state, const RowBatch& rb)
   return Status::OK();
 }
 
-Status AggNode::ExtractRowTupleForBatch(const RowBatch& rb) {
-  // Grow the group_args_chunk_ to be the size of the RowBatch.
-  size_t num_rows = rb.num_rows();
-  if (group_args_chunk_.size() < num_rows) {
-    int prev_size = group_args_chunk_.size();
-    group_args_chunk_.reserve(num_rows);
-    for (size_t idx = prev_size; idx < num_rows; ++idx) {
-      group_args_chunk_.emplace_back(CreateGroupArgsRowTuple());
+Status AggNode::ConvertNoGroupsToRowBatch(ExecState* exec_state, RowBatch* output_rb) {
+  DCHECK(output_rb != nullptr);
+  for (const auto& uda_info : udas_no_groups_) {
+    std::unique_ptr<arrow::ArrayBuilder> builder;
+    if (plan_node_->finalize_results()) {
+      builder = types::MakeArrowBuilder(uda_info.def->finalize_return_type(),
+                                        exec_state->exec_mem_pool());
+      PX_RETURN_IF_ERROR(
+          uda_info.def->FinalizeArrow(uda_info.uda.get(), function_ctx_.get(), builder.get()));
+    } else {
+      builder = types::MakeArrowBuilder(types::STRING, exec_state->exec_mem_pool());
+      PX_RETURN_IF_ERROR(
+          uda_info.def->SerializeArrow(uda_info.uda.get(), function_ctx_.get(), builder.get()));
     }
+    SharedArray out_col;
+    PX_RETURN_IF_ERROR(builder->Finish(&out_col));
+    PX_RETURN_IF_ERROR(output_rb->AddColumn(out_col));
+  }
+  return Status::OK();
+}
+
+StatusOr<SharedArray> AggNode::InputColumn(ExecState* exec_state, const RowBatch& rb,
+                                           int64_t col_idx) {
+  PX_ASSIGN_OR_RETURN(auto col, InputKeyColumn(exec_state, rb, col_idx));
+  if (!table_store::schema::IsDictionaryArray(col.get())) {
+    return col;
+  }
+  auto& decoded_col = decoded_columns_[col_idx];
+  if (decoded_col == nullptr) {
+    PX_ASSIGN_OR_RETURN(decoded_col, table_store::schema::DecodeDictionaryArray(
+                                         col.get(), exec_state->exec_mem_pool()));
+  }
+  return decoded_col;
+}
+
+StatusOr<SharedArray> AggNode::InputKeyColumn(ExecState* exec_state, const RowBatch& rb,
+                                              int64_t col_idx) {
+  if (!rb.has_selection()) {
+    return rb.ColumnAt(col_idx);
   }
+  auto& col = selected_columns_[col_idx];
+  if (col == nullptr) {
+    PX_ASSIGN_OR_RETURN(col, rb.MaterializeColumn(col_idx, exec_state->exec_mem_pool()));
+  }
+  return col;
+}
 
-  // Scan through all the group args in column order and extract the entire column.
-  for (size_t idx = 0; idx < plan_node_->groups().size(); idx++) {
-    auto grp = plan_node_->groups()[idx];
-    DCHECK(grp.idx < input_descriptor_->size());
-    DCHECK(idx < group_data_types_.size());
-    auto dt = group_data_types_[idx];
-    auto col = rb.ColumnAt(grp.idx).get();
+Status AggNode::AssignGroupIDs(ExecState* exec_state, const RowBatch& rb) {
+  std::vector<const arrow::Array*> key_cols;
+  key_cols.reserve(plan_node_->groups().size());
+  for (const auto& group : plan_node_->groups()) {
+    DCHECK(group.idx < input_descriptor_->size());
+    PX_ASSIGN_OR_RETURN(auto key_col, InputKeyColumn(exec_state, rb, group.idx));
+    key_cols.push_back(key_col.get());
+  }
+  return AssignGroupIDs(key_cols, rb.num_rows(), &group_ids_);
+}
 
-#define TYPE_CASE(_dt_) ExtractIntoGroupArgs<_dt_>(&group_args_chunk_, col, idx);
-    PX_SWITCH_FOREACH_DATATYPE(dt, TYPE_CASE);
-#undef TYPE_CASE
+Status AggNode::AssignGroupIDs(const std::vector<const arrow::Array*>& key_cols, int64_t num_rows,
+                               std::vector<int64_t>* group_ids) {
+  int64_t prev_num_groups = group_key_table_->NumGroups();
+  group_key_table_->FindOrInsert(key_cols, num_rows, group_ids);
+
+  // Create the aggregate states of the new groups.
+  for (int64_t group_id = prev_num_groups; group_id < group_key_table_->NumGroups(); ++group_id) {
+    for (size_t i = 0; i < value_states_.size(); ++i) {
+      auto* uda = value_states_[i]->Add();
+      // We only init the UDAs if we're doing the partial agg ourself. See CreateUDAInfoValues.
+      if (plan_node_->partial_agg()) {
+        PX_RETURN_IF_ERROR(value_states_[i]->def()->ExecInit(uda, nullptr, value_init_args_[i]));
+      }
+    }
   }
   return Status::OK();
 }
 
-Status AggNode::HashRowBatch(ExecState* exec_state, const RowBatch& rb) {
-  PX_UNUSED(exec_state);
-  // Loop through all the row and basically store the values into column chunk based on which
-  // group they belong to.
-  for (auto row_idx = 0; row_idx < rb.num_rows(); ++row_idx) {
-    auto& ga = group_args_chunk_[row_idx];
-    AggHashValue* val = nullptr;
-    // Check to see if in hash
-    // TODO(zasgar): Change this to upsert.
-    auto it = agg_hash_map_.find(ga.rt);
-    // If not in hash then insert
-    if (it == agg_hash_map_.end()) {
-      // Create a val array.
-      val = CreateAggHashValue(exec_state);
-      agg_hash_map_[ga.rt] = val;
-      // We have inserted this, so the stored RowTuple is now in the table.
-      ga.rt = nullptr;
-    } else {
-      val = it->second;
+Status AggNode::MergeFrom(ExecState* exec_state, AggNode* other) {
+  DCHECK(other != nullptr);
+  if (HasNoGroups()) {
+    DCHECK_EQ(udas_no_groups_.size(), other->udas_no_groups_.size());
+    for (size_t i = 0; i < udas_no_groups_.size(); ++i) {
+      const auto& uda_info = udas_no_groups_[i];
+      PX_RETURN_IF_ERROR(uda_info.def->Merge(uda_info.uda.get(),
+                                             other->udas_no_groups_[i].uda.get(),
+                                             function_ctx_.get()));
     }
-    ga.av = val;
+    return Status::OK();
   }
+  PX_RETURN_IF_ERROR(MergeGroups(exec_state, *other->group_key_table_, other->value_states_));
+  return state_memory_.Resize(StateBytes());
+}
 
-  // Now extract the values in the agg hash value.
-  for (size_t i = 0; i < stored_cols_data_types_.size(); ++i) {
-    const auto& rb_col_idx = stored_cols_to_plan_idx_[i];
-    const auto& dt = input_descriptor_->type(rb_col_idx);
+Status AggNode::MergeGroups(ExecState* exec_state, const GroupKeyTable& other_keys,
+                            const std::vector<std::unique_ptr<UDAStateArena>>& other_value_states) {
+  // Look up the keys of the other groups as if they were a row batch, with one row per group, so
+  // that merge_group_ids_ maps the other group IDs to ours. group_ids_ can't be used here, because
+  // the sliding window emits while it still holds the group IDs of the current row batch.
+  std::vector<SharedArray> keys;
+  std::vector<const arrow::Array*> key_cols;
+  for (size_t i = 0; i < group_data_types_.size(); ++i) {
+    PX_ASSIGN_OR_RETURN(auto arr, other_keys.KeyColumn(i, exec_state->exec_mem_pool()));
+    key_cols.push_back(arr.get());
+    keys.push_back(std::move(arr));
+  }
+  auto other_num_groups = other_keys.NumGroups();
+  PX_RETURN_IF_ERROR(AssignGroupIDs(key_cols, other_num_groups, &merge_group_ids_));
+
+  DCHECK_EQ(value_states_.size(), other_value_states.size());
+  for (size_t i = 0; i < value_states_.size(); ++i) {
+    const auto& states = *value_states_[i];
+    const auto& other_states = *other_value_states[i];
+    for (int64_t group_id = 0; group_id < other_num_groups; ++group_id) {
+      PX_RETURN_IF_ERROR(states.def()->Merge(states.At(merge_group_ids_[group_id]),
+                                             other_states.At(group_id), function_ctx_.get()));
+    }
+  }
+  return Status::OK();
+}
 
-    // Even if we're not doing a partial agg we want to extract the group values.
-    if (plan_node_->partial_agg() || i < plan_node_->groups().size()) {
-#define TYPE_CASE(_dt_) ExtractToColumnWrapper<_dt_>(group_args_chunk_, rb, i, rb_col_idx);
+Status AggNode::ConvertGroupsToRowBatch(ExecState* exec_state, RowBatch* output_rb) {
+  DCHECK(output_rb != nullptr);
+  for (size_t i = 0; i < group_data_types_.size(); ++i) {
+    PX_ASSIGN_OR_RETURN(auto arr, group_key_table_->KeyColumn(i, exec_state->exec_mem_pool()));
+    PX_RETURN_IF_ERROR(output_rb->AddColumn(arr));
+  }
 
-      PX_SWITCH_FOREACH_DATATYPE(dt, TYPE_CASE);
-#undef TYPE_CASE
+  auto num_groups = group_key_table_->NumGroups();
+  for (size_t i = 0; i < value_states_.size(); ++i) {
+    const auto& states = *value_states_[i];
+    auto value_type = output_descriptor_->type(group_data_types_.size() + i);
+    auto builder = types::MakeArrowBuilder(value_type, exec_state->exec_mem_pool());
+    PX_RETURN_IF_ERROR(builder->Reserve(num_groups));
+    for (int64_t group_id = 0; group_id < num_groups; ++group_id) {
+      if (plan_node_->finalize_results()) {
+        PX_RETURN_IF_ERROR(
+            states.def()->FinalizeArrow(states.At(group_id), function_ctx_.get(), builder.get()));
+      } else {
+        PX_RETURN_IF_ERROR(
+            states.def()->SerializeArrow(states.At(group_id), function_ctx_.get(), builder.get()));
+      }
     }
+    SharedArray arr;
+    PX_RETURN_IF_ERROR(builder->Finish(&arr));
+    PX_RETURN_IF_ERROR(output_rb->AddColumn(arr));
   }
-  if (!plan_node_->partial_agg()) {
+  return Status::OK();
+}
+
+Status AggNode::AggregateGroupByClause(ExecState* exec_state, const RowBatch& rb) {
+  // The process is as follows:
+  // 1. Find the group of every row, inserting new groups (and their UDA states) as needed.
+  // 2. Update the UDA states of the groups, one aggregate expression at a time, with a single
+  //    pass over the row batch.
+  // 3. If it's the last batch then emit the values.
+  PX_RETURN_IF_ERROR(AssignGroupIDs(exec_state, rb));
+  if (plan_node_->partial_agg()) {
+    auto values = plan_node_->values();
+    for (size_t i = 0; i < values.size(); ++i) {
+      PX_RETURN_IF_ERROR(EvaluateSingleExpressionGrouped(exec_state, value_states_[i].get(),
+                                                         values[i].get(), rb));
+    }
+  } else {
     // If we're not performing a partial_agg, then we're receiving serialized partial aggs, so we
     // deserialize and merge them here.
-    PX_RETURN_IF_ERROR(DeserializeAndMergeGrouped(group_args_chunk_, rb));
+    PX_RETURN_IF_ERROR(DeserializeAndMergeGrouped(rb));
+  }
+  if (ReadyToEmitBatches(rb)) {
+    RowBatch output_rb(*output_descriptor_, group_key_table_->NumGroups());
+    PX_RETURN_IF_ERROR(ConvertGroupsToRowBatch(exec_state, &output_rb));
+    output_rb.set_eow(rb.eow());
+    output_rb.set_eos(rb.eos());
+    PX_RETURN_IF_ERROR(SendRowBatchToChildren(exec_state, output_rb));
+    PX_RETURN_IF_ERROR(ClearAggState(exec_state));
   }
+  return Status::OK();
+}
 
+int64_t AggNode::PaneStart(int64_t time) const {
+  auto slide = plan_node_->sliding_window().slide_ns();
+  // Round down, also for times before the epoch.
+  auto rem = time % slide;
+  if (rem < 0) {
+    rem += slide;
+  }
+  return time - rem;
+}
+
+StatusOr<AggNode::Pane*> AggNode::GetOrCreatePane(ExecState* exec_state, int64_t pane_start) {
+  auto it = panes_.find(pane_start);
+  if (it != panes_.end()) {
+    return &it->second;
+  }
+  auto& pane = panes_[pane_start];
+  if (!HasNoGroups()) {
+    pane.group_key_table = std::make_unique<GroupKeyTable>(group_data_types_);
+  }
+  for (const auto& value : plan_node_->values()) {
+    pane.value_states.push_back(
+        std::make_unique<UDAStateArena>(exec_state->GetUDADefinition(value->uda_id())));
+  }
+  if (HasNoGroups()) {
+    PX_RETURN_IF_ERROR(InitNewPaneGroups(&pane, 1));
+  }
+  return &pane;
+}
+
+Status AggNode::InitNewPaneGroups(Pane* pane, int64_t num_groups) {
+  for (size_t i = 0; i < pane->value_states.size(); ++i) {
+    auto* states = pane->value_states[i].get();
+    while (states->size() < num_groups) {
+      PX_RETURN_IF_ERROR(states->def()->ExecInit(states->Add(), nullptr, value_init_args_[i]));
+    }
+  }
   return Status::OK();
 }
 
-Status AggNode::EvaluatePartialAggregates(ExecState* exec_state, size_t num_records) {
-  PX_UNUSED(exec_state);
-  // TODO(zasgar): This only needs to run for unique groups. We should find
-  // a way to optimize this.
-  for (size_t i = 0; i < num_records; ++i) {
-    DCHECK(i < group_args_chunk_.size());
-    auto& ga = group_args_chunk_[i];
-    DCHECK(ga.av != nullptr);
-    if (ga.av->agg_cols[0]->Size() > kAggCompactionThreshold) {
-      PX_RETURN_IF_ERROR(EvaluateAggHashValue(exec_state, ga.av));
+Status AggNode::AggregateSlidingWindow(ExecState* exec_state, const RowBatch& rb) {
+  // Every row is added to the partial states of its pane. Once a row of a pane newer than all of
+  // the previous ones arrives, the previous newest pane is complete: the rows before it are applied,
+  // the window ending with the complete pane is emitted, and the panes that fall out of the window
+  // are dropped. Only the newest panes are updated, the complete ones are just merged on emit.
+  const auto& window = plan_node_->sliding_window();
+  auto num_rows = rb.num_rows();
+  PX_ASSIGN_OR_RETURN(auto time_col, InputColumn(exec_state, rb, window.time_column().index()));
+  bool is_time64 = input_descriptor_->type(window.time_column().index()) == types::TIME64NS;
+
+  std::vector<SharedArray> key_arrays;
+  if (!HasNoGroups()) {
+    std::vector<const arrow::Array*> key_cols;
+    for (const auto& group : plan_node_->groups()) {
+      PX_ASSIGN_OR_RETURN(auto key_col, InputKeyColumn(exec_state, rb, group.idx));
+      key_cols.push_back(key_col.get());
+      key_arrays.push_back(std::move(key_col));
     }
+    group_key_table_->PrepareBatch(key_cols, num_rows, &key_batch_);
+  }
+
+  PX_RETURN_IF_ERROR(EvaluateValueArgs(exec_state, rb));
+
+  row_panes_.assign(num_rows, nullptr);
+  group_ids_.resize(num_rows);
+  int64_t run_begin = 0;
+  for (int64_t row_idx = 0; row_idx < num_rows; ++row_idx) {
+    auto time = is_time64 ? types::GetValueFromArrowArray<types::TIME64NS>(time_col.get(), row_idx)
+                          : types::GetValueFromArrowArray<types::INT64>(time_col.get(), row_idx);
+    auto pane_start = PaneStart(time);
+    if (!has_newest_pane_ || pane_start > newest_pane_start_) {
+      if (has_newest_pane_) {
+        PX_RETURN_IF_ERROR(UpdatePanes(run_begin, row_idx));
+        run_begin = row_idx;
+        PX_RETURN_IF_ERROR(EmitSlidingWindow(exec_state, /* eos */ false));
+      }
+      newest_pane_start_ = pane_start;
+      has_newest_pane_ = true;
+      EvictExpiredPanes();
+    } else if (pane_start <= newest_pane_start_ - window.window_ns()) {
+      ++late_rows_dropped_;
+      continue;
+    }
+
+    PX_ASSIGN_OR_RETURN(auto* pane, GetOrCreatePane(exec_state, pane_start));
+    row_panes_[row_idx] = pane;
+    if (HasNoGroups()) {
+      group_ids_[row_idx] = 0;
+      continue;
+    }
+    group_ids_[row_idx] = pane->group_key_table->FindOrInsertRow(key_batch_, row_idx);
+    PX_RETURN_IF_ERROR(InitNewPaneGroups(pane, pane->group_key_table->NumGroups()));
+  }
+  PX_RETURN_IF_ERROR(UpdatePanes(run_begin, num_rows));
+
+  if (rb.eos()) {
+    PX_RETURN_IF_ERROR(EmitSlidingWindow(exec_state, /* eos */ true));
   }
   return Status::OK();
 }
 
-Status AggNode::ResetGroupArgs() {
-  // Reset the group args. If the row tuple is null it has been consumed, so
-  // we can replace it with a new RowTuple. We also reset the
-  // agg hash value to nullptr.
-  for (size_t i = 0; i < group_args_chunk_.size(); ++i) {
-    group_args_chunk_[i].av = nullptr;
-    if (group_args_chunk_[i].rt == nullptr) {
-      group_args_chunk_[i].rt = CreateGroupArgsRowTuple();
-    } else {
-      group_args_chunk_[i].rt->Reset();
+Status AggNode::EvaluateValueArgs(ExecState* exec_state, const RowBatch& rb) {
+  // The agg arguments can only be columns or constants, see GetTypeOfDep.
+  auto values = plan_node_->values();
+  value_args_.resize(values.size());
+  for (size_t i = 0; i < values.size(); ++i) {
+    value_args_[i].clear();
+    for (const auto& arg : values[i]->arg_deps()) {
+      switch (arg->ExpressionType()) {
+        case plan::Expression::kColumn: {
+          PX_ASSIGN_OR_RETURN(
+              auto col,
+              InputColumn(exec_state, rb, static_cast<const plan::Column*>(arg.get())->Index()));
+          value_args_[i].push_back(std::move(col));
+          break;
+        }
+        case plan::Expression::kConstant: {
+          const auto* val = static_cast<const plan::ScalarValue*>(arg.get());
+          PX_ASSIGN_OR_RETURN(auto arr, EvalScalarToArrow(exec_state, *val, rb.num_rows()));
+          value_args_[i].push_back(std::move(arr));
+          break;
+        }
+        default:
+          return error::InvalidArgument("Invalid expression type in agg: $0",
+                                        magic_enum::enum_name(arg->ExpressionType()));
+      }
     }
   }
   return Status::OK();
 }
 
-Status AggNode::ConvertAggHashMapToRowBatch(ExecState* exec_state, RowBatch* output_rb) {
-  PX_UNUSED(exec_state);
-  DCHECK(output_rb != nullptr);
-  std::vector<std::unique_ptr<arrow::ArrayBuilder>> group_builders;
-  for (const auto& group_dt : group_data_types_) {
-    group_builders.push_back(types::MakeArrowBuilder(group_dt, exec_state->exec_mem_pool()));
+Status AggNode::UpdatePanes(int64_t begin, int64_t end) {
+  auto values = plan_node_->values();
+  std::vector<SharedArray> sliced_args;
+  std::vector<const arrow::Array*> raw_args;
+  // Dropped rows split the range into runs of rows that have a pane. The argument columns are
+  // sliced to each run, which doesn't copy them.
+  while (begin < end) {
+    if (row_panes_[begin] == nullptr) {
+      ++begin;
+      continue;
+    }
+    auto run_end = begin;
+    while (run_end < end && row_panes_[run_end] != nullptr) {
+      ++run_end;
+    }
+    auto run_length = run_end - begin;
+    row_states_.resize(run_length);
+    for (size_t i = 0; i < values.size(); ++i) {
+      for (int64_t row_idx = begin; row_idx < run_end; ++row_idx) {
+        row_states_[row_idx - begin] =
+            row_panes_[row_idx]->value_states[i]->At(group_ids_[row_idx]);
+      }
+      sliced_args.clear();
+      raw_args.clear();
+      for (const auto& arg : value_args_[i]) {
+        sliced_args.push_back(arg->Slice(begin, run_length));
+        raw_args.push_back(sliced_args.back().get());
+      }
+      PX_RETURN_IF_ERROR(row_panes_[begin]->value_states[i]->def()->ExecBatchUpdateGroupedArrow(
+          row_states_.data(), nullptr /* ctx */, raw_args));
+    }
+    begin = run_end;
   }
-  std::vector<std::unique_ptr<arrow::ArrayBuilder>> value_builders;
-  for (const auto& value_data_type : value_data_types_) {
-    value_builders.push_back(types::MakeArrowBuilder(value_data_type, exec_state->exec_mem_pool()));
+  return Status::OK();
+}
+
+Status AggNode::EmitSlidingWindow(ExecState* exec_state, bool eos) {
+  // All of the live panes are part of the window ending with the newest pane.
+  for (const auto& entry : panes_) {
+    PX_RETURN_IF_ERROR(MergePane(exec_state, entry.second));
   }
+  return EmitMergedStates(exec_state, eos);
+}
 
-  // Agg into agg values and emit!
-  for (const auto& kv : agg_hash_map_) {
-    auto* groups_rt = kv.first;
-    auto* val = kv.second;
+Status AggNode::MergePane(ExecState* exec_state, const Pane& pane) {
+  if (!HasNoGroups()) {
+    return MergeGroups(exec_state, *pane.group_key_table, pane.value_states);
+  }
+  for (size_t i = 0; i < udas_no_groups_.size(); ++i) {
+    const auto& uda_info = udas_no_groups_[i];
+    PX_RETURN_IF_ERROR(uda_info.def->Merge(uda_info.uda.get(), pane.value_states[i]->At(0),
+                                           function_ctx_.get()));
+  }
+  return Status::OK();
+}
 
-    for (size_t i = 0; i < group_data_types_.size(); ++i) {
-      DCHECK(i < group_builders.size());
+Status AggNode::EmitMergedStates(ExecState* exec_state, bool eos) {
+  RowBatch output_rb(*output_descriptor_, HasNoGroups() ? 1 : group_key_table_->NumGroups());
+  if (HasNoGroups()) {
+    PX_RETURN_IF_ERROR(ConvertNoGroupsToRowBatch(exec_state, &output_rb));
+  } else {
+    PX_RETURN_IF_ERROR(ConvertGroupsToRowBatch(exec_state, &output_rb));
+  }
+  output_rb.set_eow(true);
+  output_rb.set_eos(eos);
+  PX_RETURN_IF_ERROR(SendRowBatchToChildren(exec_state, output_rb));
+  return ClearAggState(exec_state);
+}
 
-#define TYPE_CASE(_dt_) AppendToBuilder<_dt_>(group_builders[i].get(), groups_rt, i);
-      PX_SWITCH_FOREACH_DATATYPE(group_data_types_[i], TYPE_CASE);
-#undef TYPE_CASE
-    }
-    if (plan_node_->partial_agg()) {
-      PX_RETURN_IF_ERROR(EvaluateAggHashValue(exec_state, val));
-    }
+void AggNode::EvictExpiredPanes() {
+  auto window_ns = plan_node_->sliding_window().window_ns();
+  while (!panes_.empty() && panes_.begin()->first <= newest_pane_start_ - window_ns) {
+    panes_.erase(panes_.begin());
+  }
+}
 
-    if (plan_node_->finalize_results()) {
-      // Actually Finalize the UDA based on the column wrapper chunks.
-      for (size_t i = 0; i < val->udas.size(); ++i) {
-        const auto& uda_info = val->udas[i];
-        PX_RETURN_IF_ERROR(uda_info.def->FinalizeArrow(uda_info.uda.get(), function_ctx_.get(),
-                                                       value_builders[i].get()));
-      }
+Status AggNode::AggregateWithResultCache(ExecState* exec_state, const RowBatch& rb) {
+  // The memory source sends the rows of every time bucket in separate row batches, so the whole row
+  // batch belongs to the pane of the current bucket.
+  auto num_rows = rb.num_rows();
+  if (num_rows > 0) {
+    PX_ASSIGN_OR_RETURN(auto* pane,
+                        GetOrCreatePane(exec_state, result_cache_session_->current_bucket()));
+    if (HasNoGroups()) {
+      group_ids_.assign(num_rows, 0);
     } else {
-      for (size_t i = 0; i < val->udas.size(); ++i) {
-        const auto& uda_info = val->udas[i];
-        PX_RETURN_IF_ERROR(uda_info.def->SerializeArrow(uda_info.uda.get(), function_ctx_.get(),
-                                                        value_builders[i].get()));
+      std::vector<const arrow::Array*> key_cols;
+      for (const auto& group : plan_node_->groups()) {
+        PX_ASSIGN_OR_RETURN(auto key_col, InputKeyColumn(exec_state, rb, group.idx));
+        key_cols.push_back(key_col.get());
       }
+      pane->group_key_table->FindOrInsert(key_cols, num_rows, &group_ids_);
+      PX_RETURN_IF_ERROR(InitNewPaneGroups(pane, pane->group_key_table->NumGroups()));
     }
+    PX_RETURN_IF_ERROR(EvaluateValueArgs(exec_state, rb));
+    row_panes_.assign(num_rows, pane);
+    PX_RETURN_IF_ERROR(UpdatePanes(0, num_rows));
   }
 
-  for (const auto& group_builder : group_builders) {
-    std::shared_ptr<arrow::Array> arr;
-    PX_RETURN_IF_ERROR(group_builder->Finish(&arr));
-    PX_RETURN_IF_ERROR(output_rb->AddColumn(arr));
+  if (rb.eos()) {
+    return EmitWithResultCache(exec_state);
   }
+  return Status::OK();
+}
 
-  for (const auto& value_builder : value_builders) {
-    std::shared_ptr<arrow::Array> arr;
-    PX_RETURN_IF_ERROR(value_builder->Finish(&arr));
-    PX_RETURN_IF_ERROR(output_rb->AddColumn(arr));
+Status AggNode::EmitWithResultCache(ExecState* exec_state) {
+  // Merge the aggregated and the cached buckets in time order, so that the groups and the merged
+  // states come out the same whichever buckets were cached.
+  const auto& cached_buckets = result_cache_session_->cached_buckets();
+  auto cached_it = cached_buckets.begin();
+  for (const auto& [bucket_start, pane] : panes_) {
+    for (; cached_it != cached_buckets.end() && cached_it->start < bucket_start; ++cached_it) {
+      PX_RETURN_IF_ERROR(MergeSerializedStates(*cached_it->states));
+    }
+    if (result_cache_session_->IsComplete(bucket_start)) {
+      PX_ASSIGN_OR_RETURN(auto states, SerializePane(exec_state, pane));
+      result_cache_session_->AddBucket(bucket_start, std::move(states));
+    }
+    PX_RETURN_IF_ERROR(MergePane(exec_state, pane));
   }
+  for (; cached_it != cached_buckets.end(); ++cached_it) {
+    PX_RETURN_IF_ERROR(MergeSerializedStates(*cached_it->states));
+  }
+  panes_.clear();
+  return EmitMergedStates(exec_state, /* eos */ true);
+}
 
-  return Status::OK();
+StatusOr<std::shared_ptr<RowBatch>> AggNode::SerializePane(ExecState* exec_state,
+                                                           const Pane& pane) {
+  auto num_groups = HasNoGroups() ? 1 : pane.group_key_table->NumGroups();
+  std::vector<types::DataType> col_types = group_data_types_;
+  col_types.insert(col_types.end(), pane.value_states.size(), types::STRING);
+  auto rb = std::make_shared<RowBatch>(RowDescriptor(col_types), num_groups);
+  for (size_t i = 0; i < group_data_types_.size(); ++i) {
+    PX_ASSIGN_OR_RETURN(auto arr, pane.group_key_table->KeyColumn(i, exec_state->exec_mem_pool()));
+    PX_RETURN_IF_ERROR(rb->AddColumn(arr));
+  }
+  for (const auto& states : pane.value_states) {
+    auto builder = types::MakeArrowBuilder(types::STRING, exec_state->exec_mem_pool());
+    PX_RETURN_IF_ERROR(builder->Reserve(num_groups));
+    for (int64_t group_id = 0; group_id < num_groups; ++group_id) {
+      PX_RETURN_IF_ERROR(
+          states->def()->SerializeArrow(states->At(group_id), function_ctx_.get(), builder.get()));
+    }
+    SharedArray arr;
+    PX_RETURN_IF_ERROR(builder->Finish(&arr));
+    PX_RETURN_IF_ERROR(rb->AddColumn(arr));
+  }
+  return rb;
 }
 
-Status AggNode::AggregateGroupByClause(ExecState* exec_state, const RowBatch& rb) {
-  // Extracts the row tuples (column wise).
-  // TODO(zasgar): PL-455 - Chunk this so we don't create a crazy number of row tuples if the batch
-  // is large. The process is as follows:
-  // 1. Extract each column into the appropriate part of the row tuple.
-  // 2. Hash row batch and update agg values.
-  // 3. If the agg values are large then run aggregate and compact.
-  // 4. Reset state to prepare for next row batch.
-  // 5. If it's the last batch then emit the values.
-  PX_RETURN_IF_ERROR(ExtractRowTupleForBatch(rb));
-  PX_RETURN_IF_ERROR(HashRowBatch(exec_state, rb));
-  if (plan_node_->partial_agg() && plan_node_->values().size() > 0) {
-    PX_RETURN_IF_ERROR(EvaluatePartialAggregates(exec_state, rb.num_rows()));
-  }
-  PX_RETURN_IF_ERROR(ResetGroupArgs());
-  if (ReadyToEmitBatches(rb)) {
-    RowBatch output_rb(*output_descriptor_, agg_hash_map_.size());
-    PX_RETURN_IF_ERROR(ConvertAggHashMapToRowBatch(exec_state, &output_rb));
-    output_rb.set_eow(rb.eow());
-    output_rb.set_eos(rb.eos());
-    PX_RETURN_IF_ERROR(SendRowBatchToChildren(exec_state, output_rb));
-    PX_RETURN_IF_ERROR(ClearAggState(exec_state));
+Status AggNode::MergeSerializedStates(const RowBatch& rb) {
+  if (HasNoGroups()) {
+    return DeserializeAndMergeNoGroups(rb);
   }
-  return Status::OK();
+  std::vector<const arrow::Array*> key_cols;
+  for (size_t i = 0; i < group_data_types_.size(); ++i) {
+    key_cols.push_back(rb.ColumnAt(i).get());
+  }
+  PX_RETURN_IF_ERROR(AssignGroupIDs(key_cols, rb.num_rows(), &group_ids_));
+  return DeserializeAndMergeGrouped(rb);
 }
 
 StatusOr<types::DataType> AggNode::GetTypeOfDep(const plan::ScalarExpression& expr) const {
@@ -426,16 +762,16 @@ Status AggNode::EvaluateSingleExpressionNoGroups(ExecState* exec_state, const UD
   plan::ExpressionWalker<StatusOr<SharedArray>> walker;
   walker.OnScalarValue(
       [&](const plan::ScalarValue& val,
-          const std::vector<StatusOr<SharedArray>>& children) -> std::shared_ptr<arrow::Array> {
+          const std::vector<StatusOr<SharedArray>>& children) -> StatusOr<SharedArray> {
         DCHECK_EQ(children.size(), 0ULL);
         return EvalScalarToArrow(exec_state, val, input_rb.num_rows());
       });
 
   walker.OnColumn(
       [&](const plan::Column& col,
-          const std::vector<StatusOr<SharedArray>>& children) -> std::shared_ptr<arrow::Array> {
+          const std::vector<StatusOr<SharedArray>>& children) -> StatusOr<SharedArray> {
         DCHECK_EQ(children.size(), 0ULL);
-        return input_rb.ColumnAt(col.Index());
+        return InputColumn(exec_state, input_rb, col.Index());
       });
 
   walker.OnAggregateExpression(
@@ -462,102 +798,55 @@ Status AggNode::EvaluateSingleExpressionNoGroups(ExecState* exec_state, const UD
   return Status::OK();
 }
 
-Status AggNode::EvaluateAggHashValue(ExecState* exec_state, AggHashValue* val) {
-  size_t values_size = plan_node_->values().size();
-  for (size_t i = 0; i < values_size; ++i) {
-    const auto& uda_info = val->udas[i];
-    const auto& expr = *plan_node_->values()[i];
-    size_t num_records = val->agg_cols[0]->Size();
-    plan::ExpressionWalker<StatusOr<types::SharedColumnWrapper>> walker;
-    walker.OnScalarValue([&](const plan::ScalarValue& scalar_val,
-                             const std::vector<StatusOr<types::SharedColumnWrapper>>& children)
-                             -> types::SharedColumnWrapper {
-      DCHECK_EQ(children.size(), 0ULL);
-      return EvalScalarToColumnWrapper(exec_state, scalar_val, num_records);
-    });
-
-    walker.OnColumn([&](const plan::Column& col,
-                        const std::vector<StatusOr<types::SharedColumnWrapper>>& children)
-                        -> types::SharedColumnWrapper {
-      DCHECK_EQ(children.size(), 0ULL);
-      return val->agg_cols[plan_cols_to_stored_map_[col.Index()]];
-    });
-
-    walker.OnAggregateExpression(
-        [&](const plan::AggregateExpression& agg,
-            const std::vector<StatusOr<types::SharedColumnWrapper>>& children)
-            -> StatusOr<types::SharedColumnWrapper> {
-          DCHECK(agg.name() == uda_info.def->name());
-          DCHECK(children.size() == uda_info.def->update_arguments().size());
-          // collect the arguments.
-          std::vector<const types::ColumnWrapper*> raw_children;
-          raw_children.reserve(children.size());
-          for (auto& child : children) {
-            PX_RETURN_IF_ERROR(child);
-            raw_children.push_back(child.ValueOrDie().get());
-          }
-          PX_RETURN_IF_ERROR(
-              uda_info.def->ExecBatchUpdate(uda_info.uda.get(), nullptr /* ctx */, raw_children));
-          // Blocking aggregates don't produce results until all data is seen.
-          return {};
-        });
-    PX_RETURN_IF_ERROR(walker.Walk(expr));
-  }
-
-  for (auto& col : val->agg_cols) {
-    // Clear the values, so we don't aggregate them twice.
-    col->Clear();
-  }
-  return Status::OK();
-}
-
-Status AggNode::CreateColumnMapping() {
-  if (!plan_node_->partial_agg()) {
-    // If we're deserializing partial aggregates, then we have 1 column for each group and 1 column
-    // for each value.
-    auto groups_size = static_cast<int64_t>(plan_node_->groups().size());
-    auto values_size = static_cast<int64_t>(plan_node_->values().size());
-    for (int64_t i = 0; i < groups_size + values_size; i++) {
-      plan_cols_to_stored_map_[i] = i;
-      stored_cols_to_plan_idx_.emplace_back(i);
-      stored_cols_data_types_.emplace_back(input_descriptor_->type(i));
-    }
-    return Status::OK();
+Status AggNode::EvaluateSingleExpressionGrouped(ExecState* exec_state, UDAStateArena* states,
+                                                plan::AggregateExpression* expr,
+                                                const RowBatch& input_rb) {
+  // Gather the UDA instance of every row, so the whole batch can be updated in one pass.
+  row_states_.resize(input_rb.num_rows());
+  for (int64_t row_idx = 0; row_idx < input_rb.num_rows(); ++row_idx) {
+    row_states_[row_idx] = states->At(group_ids_[row_idx]);
   }
-  for (const auto& expr : plan_node_->values()) {
-    plan::ExpressionWalker<int> walker;
 
-    walker.OnScalarValue(
-        [&](const plan::ScalarValue&, const std::vector<int>&) -> int { return 0; });
+  plan::ExpressionWalker<StatusOr<SharedArray>> walker;
+  walker.OnScalarValue(
+      [&](const plan::ScalarValue& val,
+          const std::vector<StatusOr<SharedArray>>& children) -> StatusOr<SharedArray> {
+        DCHECK_EQ(children.size(), 0ULL);
+        return EvalScalarToArrow(exec_state, val, input_rb.num_rows());
+      });
 
-    walker.OnColumn([&](const plan::Column& col, const std::vector<int>&) -> int {
-      auto plan_col_idx = col.Index();
-      if (plan_cols_to_stored_map_.find(plan_col_idx) == plan_cols_to_stored_map_.end()) {
-        // We aren't currently capturing this col, so add it to the list of cols to store.
-        plan_cols_to_stored_map_[plan_col_idx] = stored_cols_to_plan_idx_.size();
-        stored_cols_to_plan_idx_.emplace_back(plan_col_idx);
-        stored_cols_data_types_.emplace_back(input_descriptor_->type(plan_col_idx));
-      }
-      return 0;
-    });
+  walker.OnColumn(
+      [&](const plan::Column& col,
+          const std::vector<StatusOr<SharedArray>>& children) -> StatusOr<SharedArray> {
+        DCHECK_EQ(children.size(), 0ULL);
+        return InputColumn(exec_state, input_rb, col.Index());
+      });
 
-    walker.OnAggregateExpression(
-        [&](const plan::AggregateExpression&, const std::vector<int>&) -> int { return 0; });
+  walker.OnAggregateExpression(
+      [&](const plan::AggregateExpression& agg,
+          const std::vector<StatusOr<SharedArray>>& children) -> StatusOr<SharedArray> {
+        DCHECK(agg.name() == states->def()->name());
+        DCHECK(children.size() == states->def()->update_arguments().size());
+        std::vector<const arrow::Array*> raw_children;
+        raw_children.reserve(children.size());
+        for (const auto& child : children) {
+          if (!child.ok()) {
+            return child;
+          }
+          raw_children.push_back(child.ValueOrDie().get());
+        }
+        if (input_rb.num_rows() > 0) {
+          PX_RETURN_IF_ERROR(states->def()->ExecBatchUpdateGroupedArrow(
+              row_states_.data(), nullptr /* ctx */, raw_children));
+        }
+        // Blocking aggregates don't produce results until all data is seen.
+        return {};
+      });
 
-    PX_RETURN_IF_ERROR(walker.Walk(*expr));
-  }
+  PX_RETURN_IF_ERROR(walker.Walk(*expr));
   return Status::OK();
 }
 
-AggHashValue* AggNode::CreateAggHashValue(ExecState* exec_state) {
-  auto* val = udas_pool_.Add(new AggHashValue);
-  PX_CHECK_OK(CreateUDAInfoValues(&(val->udas), exec_state));
-  for (const auto& dt : stored_cols_data_types_) {
-    val->agg_cols.emplace_back(types::ColumnWrapper::Make(dt, 0));
-  }
-  return val;
-}
-
 Status AggNode::CreateUDAInfoValues(std::vector<UDAInfo>* val, ExecState* exec_state) {
   CHECK(val != nullptr);
   CHECK_EQ(val->size(), 0ULL);
@@ -584,37 +873,40 @@ Status AggNode::CreateUDAInfoValues(std::vector<UDAInfo>* val, ExecState* exec_s
 
 Status AggNode::DeserializeAndMergeNoGroups(const RowBatch& rb) {
   for (int64_t row_idx = 0; row_idx < rb.num_rows(); row_idx++) {
-    PX_RETURN_IF_ERROR(DeserializeAndMergeRow(&udas_no_groups_, rb, row_idx, 0));
+    for (size_t uda_idx = 0; uda_idx < udas_no_groups_.size(); ++uda_idx) {
+      PX_RETURN_IF_ERROR(DeserializeAndMerge(udas_for_deserialize_[uda_idx],
+                                             udas_no_groups_[uda_idx].uda.get(), rb, uda_idx,
+                                             row_idx));
+    }
   }
   return Status::OK();
 }
 
-Status AggNode::DeserializeAndMergeGrouped(const std::vector<GroupArgs>& group_args,
-                                           const RowBatch& rb) {
+Status AggNode::DeserializeAndMergeGrouped(const RowBatch& rb) {
   auto groups_size = static_cast<int64_t>(plan_node_->groups().size());
-  for (int64_t row_idx = 0; row_idx < rb.num_rows(); row_idx++) {
-    DCHECK(group_args[row_idx].av != nullptr);
-    PX_RETURN_IF_ERROR(
-        DeserializeAndMergeRow(&group_args[row_idx].av->udas, rb, row_idx, groups_size));
+  for (size_t uda_idx = 0; uda_idx < value_states_.size(); ++uda_idx) {
+    const auto& states = *value_states_[uda_idx];
+    int64_t col_idx = groups_size + static_cast<int64_t>(uda_idx);
+    for (int64_t row_idx = 0; row_idx < rb.num_rows(); row_idx++) {
+      PX_RETURN_IF_ERROR(DeserializeAndMerge(udas_for_deserialize_[uda_idx],
+                                             states.At(group_ids_[row_idx]), rb, col_idx,
+                                             row_idx));
+    }
   }
-
   return Status::OK();
 }
 
-Status AggNode::DeserializeAndMergeRow(std::vector<UDAInfo>* udas, const RowBatch& rb,
-                                       int64_t row_idx, int64_t groups_size) {
-  for (size_t uda_idx = 0; uda_idx < udas->size(); ++uda_idx) {
-    auto& deserial_uda_info = udas_for_deserialize_[uda_idx];
-    auto& merge_uda_info = (*udas)[uda_idx];
-    int64_t col_idx = groups_size + static_cast<int64_t>(uda_idx);
-    DCHECK_EQ(types::STRING, rb.desc().type(col_idx));
-    auto serialized =
-        types::GetValueFromArrowArray<types::STRING>(rb.ColumnAt(col_idx).get(), row_idx);
-    PX_RETURN_IF_ERROR(deserial_uda_info.def->Deserialize(deserial_uda_info.uda.get(),
-                                                          function_ctx_.get(), serialized));
-    PX_RETURN_IF_ERROR(merge_uda_info.def->Merge(merge_uda_info.uda.get(),
-                                                 deserial_uda_info.uda.get(), function_ctx_.get()));
-  }
+Status AggNode::DeserializeAndMerge(const UDAInfo& deserial_uda_info, udf::UDA* merge_uda,
+                                   const RowBatch& rb, int64_t col_idx, int64_t row_idx) {
+  DCHECK_EQ(types::STRING, rb.desc().type(col_idx));
+  auto serialized =
+      types::GetValueFromArrowArray<types::STRING>(rb.ColumnAt(col_idx).get(),
+                                                   rb.ColumnRowIdx(row_idx));
+  PX_RETURN_IF_ERROR(deserial_uda_info.def->Deserialize(deserial_uda_info.uda.get(),
+                                                        function_ctx_.get(), serialized));
+  // The deserialize and merge UDAs are always instances of the same UDA definition.
+  PX_RETURN_IF_ERROR(
+      deserial_uda_info.def->Merge(merge_uda, deserial_uda_info.uda.get(), function_ctx_.get()));
   return Status::OK();
 }
 
@@ -19,6 +19,7 @@
 #pragma once
 #include <cstddef>
 #include <map>
+#include <new>
 #include <memory>
 #include <string>
 #include <utility>
@@ -27,16 +28,15 @@
 #include "src/carnot/exec/exec_node.h"
 #include "src/carnot/exec/exec_state.h"
 #include "src/carnot/exec/expression_evaluator.h"
-#include "src/carnot/exec/row_tuple.h"
+#include "src/carnot/exec/group_key_table.h"
+#include "src/carnot/exec/result_cache.h"
 #include "src/carnot/plan/operators.h"
 #include "src/carnot/plan/scalar_expression.h"
 #include "src/carnot/udf/base.h"
 #include "src/carnot/udf/udf.h"
 #include "src/carnot/udf/udf_definition.h"
 #include "src/common/base/base.h"
-#include "src/common/memory/memory.h"
 #include "src/shared/types/column_wrapper.h"
-#include "src/shared/types/hash_utils.h"
 #include "src/shared/types/types.h"
 #include "src/table_store/schema/row_batch.h"
 #include "src/table_store/table_store.h"
@@ -55,24 +55,74 @@ struct UDAInfo {
   udf::UDADefinition* def = nullptr;
 };
 
-struct AggHashValue {
-  std::vector<UDAInfo> udas;
-  std::vector<types::SharedColumnWrapper> agg_cols;
-};
+/**
+ * UDAStateArena holds the UDA instances of a single aggregate expression, one per group, in
+ * contiguous chunks of memory. This keeps the states of neighbouring groups on neighbouring cache
+ * lines, and avoids a heap allocation per group.
+ */
+class UDAStateArena : public NotCopyable {
+ public:
+  explicit UDAStateArena(udf::UDADefinition* def);
+  ~UDAStateArena() { Clear(); }
+
+  /**
+   * Creates the UDA instance of the next group.
+   */
+  udf::UDA* Add();
+  udf::UDA* At(int64_t group_id) const { return states_[group_id]; }
+  int64_t size() const { return static_cast<int64_t>(states_.size()); }
+  // Destroys all of the UDA instances.
+  void Clear();
+  // The number of bytes held by the chunks of UDA instances.
+  int64_t NumBytes() const {
+    return static_cast<int64_t>(chunks_.size() * kStatesPerChunk * stride_ +
+                                states_.capacity() * sizeof(udf::UDA*));
+  }
 
-struct GroupArgs {
-  explicit GroupArgs(RowTuple* rt) : rt(rt), av(nullptr) {}
-  RowTuple* rt;
-  AggHashValue* av;
+  udf::UDADefinition* def() const { return def_; }
+
+ private:
+  static constexpr size_t kStatesPerChunk = 1024;
+
+  struct ChunkDeleter {
+    size_t alignment;
+    void operator()(uint8_t* chunk) const {
+      ::operator delete(chunk, std::align_val_t(alignment));
+    }
+  };
+
+  // unowned pointer to the definition.
+  udf::UDADefinition* def_;
+  // Size of a UDA instance, rounded up to its alignment.
+  size_t stride_;
+  std::vector<std::unique_ptr<uint8_t, ChunkDeleter>> chunks_;
+  std::vector<udf::UDA*> states_;
 };
 
 class AggNode : public ProcessingNode {
-  using AggHashMap = AbslRowTupleHashMap<AggHashValue*>;
-
  public:
   AggNode() = default;
   virtual ~AggNode() = default;
 
+  /**
+   * Merges the aggregate states of another AggNode, of the same plan node, into this one. The
+   * groups of the other node that this node hasn't seen yet are added in the other node's order.
+   * Both nodes must be open, and the other node is left unchanged.
+   * @param exec_state The execution state.
+   * @param other The node to merge the states of.
+   * @return The status of the merge.
+   */
+  Status MergeFrom(ExecState* exec_state, AggNode* other);
+
+  /**
+   * Makes the aggregate keep the states of every time bucket of the session apart, cache the
+   * complete buckets, and merge the cached buckets of the session into its results. Only blocking
+   * aggregates that perform the partial aggregate can use the result cache. Must be called before
+   * the node is opened.
+   * @param session the result cache session of the pipeline that this aggregate ends.
+   */
+  void UseResultCache(ResultCacheSession* session);
+
  protected:
   Status AggregateGroupByNone(ExecState* exec_state, const table_store::schema::RowBatch& rb);
   Status AggregateGroupByClause(ExecState* exec_state, const table_store::schema::RowBatch& rb);
@@ -84,10 +134,12 @@ class AggNode : public ProcessingNode {
   Status CloseImpl(ExecState* exec_state) override;
   Status ConsumeNextImpl(ExecState* exec_state, const table_store::schema::RowBatch& rb,
                          size_t parent_index) override;
+  bool ConsumesSelection() const override { return true; }
+  bool ConsumesDictionaryColumns() const override { return true; }
 
  private:
-  AggHashMap agg_hash_map_;
   bool HasNoGroups() const { return plan_node_->groups().empty(); }
+  bool IsSlidingWindow() const { return plan_node_->has_sliding_window(); }
   // ReadyToEmitBatches returns true when the input stream has reached a point where output batches
   // can be emitted. In the windowed aggregate case, this happens whenever end of window (eow) is
   // reached. In the blocking aggregate case, this happens at eos only.
@@ -98,15 +150,16 @@ class AggNode : public ProcessingNode {
   Status EvaluateSingleExpressionNoGroups(ExecState* exec_state, const UDAInfo& uda_info,
                                           plan::AggregateExpression* expr,
                                           const table_store::schema::RowBatch& rb);
-  Status EvaluateAggHashValue(ExecState* exec_state, AggHashValue* val);
   StatusOr<types::DataType> GetTypeOfDep(const plan::ScalarExpression& expr) const;
 
+  Status ConvertNoGroupsToRowBatch(ExecState* exec_state, table_store::schema::RowBatch* output_rb);
+
   Status DeserializeAndMergeNoGroups(const RowBatch& rb);
 
-  Status DeserializeAndMergeGrouped(const std::vector<GroupArgs>& group_args, const RowBatch& rb);
+  Status DeserializeAndMergeGrouped(const RowBatch& rb);
 
-  Status DeserializeAndMergeRow(std::vector<UDAInfo>* udas, const RowBatch& rb, int64_t row_idx,
-                                int64_t groups_size);
+  Status DeserializeAndMerge(const UDAInfo& deserial_uda_info, udf::UDA* merge_uda,
+                             const RowBatch& rb, int64_t col_idx, int64_t row_idx);
 
   // Store information about aggregate node from the query planner.
   std::unique_ptr<plan::AggregateOperator> plan_node_;
@@ -121,44 +174,103 @@ class AggNode : public ProcessingNode {
   // END: Variables specific to GroupByNone Agg.
 
   // Variables specific to GroupBy Agg.
+  std::vector<types::DataType> group_data_types_;
+  std::unique_ptr<GroupKeyTable> group_key_table_;
+  // The states of each aggregate expression, indexed by group ID.
+  std::vector<std::unique_ptr<UDAStateArena>> value_states_;
+  // Init arguments of each aggregate expression, used to init the state of new groups.
+  std::vector<std::vector<std::shared_ptr<types::BaseValueType>>> value_init_args_;
 
-  // As the row batches come in we insert the correct values into the hash map based
-  // on the group by key. To do this we need to keep track of which input columns we need
-  // to eventually run the agg funcs.
-  // 1. We need to keep a mapping from plan columns to stored columns.
-  std::map<int64_t, int64_t> plan_cols_to_stored_map_;
-  // 2. The reverse mapping from stored_cols to plan cols. This can be a regular vector,
-  // since the stored column indices are contiguous.
-  std::vector<int64_t> stored_cols_to_plan_idx_;
-  // 3. The data type of the stored colums, by the index they are stored at.
-  std::vector<types::DataType> stored_cols_data_types_;
-
-  ObjectPool group_args_pool_{"group_args_pool"};
-  ObjectPool udas_pool_{"udas_pool"};
+  // Scratch space for the current row batch: the group ID of every row, and the UDA instance of
+  // every row for the aggregate expression being updated.
+  std::vector<int64_t> group_ids_;
+  std::vector<udf::UDA*> row_states_;
+  // Scratch space for MergeGroups: our group ID of every group of the merged key table.
+  std::vector<int64_t> merge_group_ids_;
+  // END: Variables specific to GroupBy Agg.
 
-  std::vector<types::DataType> group_data_types_;
-  std::vector<types::DataType> value_data_types_;
+  // Returns a column of the row batch, with only the selected rows if it has a selection. Only the
+  // columns that the aggregate reads are copied, once per row batch. Dictionary encoded string
+  // columns are decoded, since the UDAs read arrow::StringArrays.
+  StatusOr<std::shared_ptr<arrow::Array>> InputColumn(ExecState* exec_state,
+                                                      const table_store::schema::RowBatch& rb,
+                                                      int64_t col_idx);
+  // Like InputColumn, but keeps dictionary encoded string columns encoded. The GroupKeyTable groups
+  // their rows by code.
+  StatusOr<std::shared_ptr<arrow::Array>> InputKeyColumn(ExecState* exec_state,
+                                                         const table_store::schema::RowBatch& rb,
+                                                         int64_t col_idx);
+  // The selected rows of the columns of the current row batch, by column index.
+  std::vector<std::shared_ptr<arrow::Array>> selected_columns_;
+  // The decoded dictionary encoded columns of the current row batch, by column index.
+  std::vector<std::shared_ptr<arrow::Array>> decoded_columns_;
 
-  // We construct row-tuples in a batch, chunked by each column.
-  // This vector holds pointers to the row_tuples which are managed by the group_args_pool_.
+  Status AssignGroupIDs(ExecState* exec_state, const table_store::schema::RowBatch& rb);
+  Status AssignGroupIDs(const std::vector<const arrow::Array*>& key_cols, int64_t num_rows,
+                        std::vector<int64_t>* group_ids);
+  Status EvaluateSingleExpressionGrouped(ExecState* exec_state, UDAStateArena* states,
+                                         plan::AggregateExpression* expr,
+                                         const table_store::schema::RowBatch& rb);
+  Status ConvertGroupsToRowBatch(ExecState* exec_state, table_store::schema::RowBatch* output_rb);
+  // Merges the groups of a key table and their aggregate states into this node's groups.
+  Status MergeGroups(ExecState* exec_state, const GroupKeyTable& other_keys,
+                     const std::vector<std::unique_ptr<UDAStateArena>>& other_value_states);
 
-  std::vector<GroupArgs> group_args_chunk_;
-  // END: Variables specific to GroupBy Agg.
+  // Variables specific to sliding window Agg and to the result cache.
+  // A pane holds the partial aggregate states of the rows whose time is in [start, start + slide),
+  // or in the time bucket that starts at start when using the result cache. Groups are tracked per
+  // pane, so that a group that only shows up in expired panes disappears from the results along
+  // with them. Without groups, every pane has a single group.
+  struct Pane {
+    std::unique_ptr<GroupKeyTable> group_key_table;
+    std::vector<std::unique_ptr<UDAStateArena>> value_states;
+  };
+  // The live panes, by start time.
+  std::map<int64_t, Pane> panes_;
+  // The start of the newest pane seen so far. The window ends with this pane.
+  int64_t newest_pane_start_ = 0;
+  bool has_newest_pane_ = false;
+  // The rows that were older than the oldest pane of the window when they arrived.
+  int64_t late_rows_dropped_ = 0;
+  GroupKeyTable::KeyBatch key_batch_;
+  // The pane of every row of the current row batch, or nullptr if the row is dropped.
+  std::vector<Pane*> row_panes_;
+  // The arguments of each aggregate expression, evaluated over the current row batch.
+  std::vector<std::vector<std::shared_ptr<arrow::Array>>> value_args_;
+  // Set if the aggregate uses the result cache.
+  ResultCacheSession* result_cache_session_ = nullptr;
 
-  // Creates a mapping between plan cols and stored cols (see above comment).
-  Status CreateColumnMapping();
+  // The bytes held by the groups and aggregate states of all the panes.
+  int64_t StateBytes() const;
+  MemoryReservation state_memory_;
 
-  Status ExtractRowTupleForBatch(const table_store::schema::RowBatch& rb);
-  Status HashRowBatch(ExecState* exec_state, const table_store::schema::RowBatch& rb);
-  Status EvaluatePartialAggregates(ExecState* exec_state, size_t num_records);
-  Status ResetGroupArgs();
-  Status ConvertAggHashMapToRowBatch(ExecState* exec_state,
-                                     table_store::schema::RowBatch* output_rb);
+  int64_t PaneStart(int64_t time) const;
+  StatusOr<Pane*> GetOrCreatePane(ExecState* exec_state, int64_t pane_start);
+  // Creates and inits the states of the pane's groups that don't have states yet.
+  Status InitNewPaneGroups(Pane* pane, int64_t num_groups);
+  // Evaluates the arguments of the aggregate expressions over the row batch into value_args_.
+  Status EvaluateValueArgs(ExecState* exec_state, const table_store::schema::RowBatch& rb);
+  Status MergePane(ExecState* exec_state, const Pane& pane);
+  // Sends the merged states, and clears them.
+  Status EmitMergedStates(ExecState* exec_state, bool eos);
+  Status AggregateSlidingWindow(ExecState* exec_state, const table_store::schema::RowBatch& rb);
+  // Updates the pane states with rows [begin, end) of the current row batch.
+  Status UpdatePanes(int64_t begin, int64_t end);
+  // Merges the panes of the window ending with the newest pane, and sends the results.
+  Status EmitSlidingWindow(ExecState* exec_state, bool eos);
+  // Drops the panes that are no longer part of the window ending with the newest pane.
+  void EvictExpiredPanes();
 
-  AggHashValue* CreateAggHashValue(ExecState* exec_state);
-  RowTuple* CreateGroupArgsRowTuple() {
-    return group_args_pool_.Add(new RowTuple(&group_data_types_));
-  }
+  // Adds the row batch to the pane of the session's current bucket.
+  Status AggregateWithResultCache(ExecState* exec_state, const table_store::schema::RowBatch& rb);
+  // Caches the complete panes, then merges all of the panes and cached buckets, and sends the
+  // results.
+  Status EmitWithResultCache(ExecState* exec_state);
+  // Returns the states of the pane in the format of ResultCache::Bucket::states.
+  StatusOr<std::shared_ptr<table_store::schema::RowBatch>> SerializePane(ExecState* exec_state,
+                                                                         const Pane& pane);
+  Status MergeSerializedStates(const table_store::schema::RowBatch& rb);
+  // END: Variables specific to sliding window Agg and to the result cache.
 
   Status CreateUDAInfoValues(std::vector<UDAInfo>* val, ExecState* exec_state);
 };
@@ -472,6 +472,73 @@ agg_op {
   finalize_results: true
 })";
 
+constexpr char kSlidingWindowNoGroupAgg[] = R"(
+op_type: AGGREGATE_OPERATOR
+agg_op {
+  values {
+    name: "minsum"
+    args {
+      column {
+        node:0
+        index: 1
+      }
+    }
+    args {
+      column {
+        node:0
+        index: 1
+      }
+    }
+  }
+  value_names: "value1"
+  partial_agg: true
+  finalize_results: true
+  sliding_window {
+    time_column {
+      node: 0
+      index: 0
+    }
+    window_ns: 20
+    slide_ns: 10
+  }
+})";
+
+constexpr char kSlidingWindowSingleGroupAgg[] = R"(
+op_type: AGGREGATE_OPERATOR
+agg_op {
+  values {
+    name: "minsum"
+    args {
+      column {
+        node:0
+        index: 2
+      }
+    }
+    args {
+      column {
+        node:0
+        index: 2
+      }
+    }
+  }
+  groups {
+     node: 0
+     index: 1
+  }
+  group_names: "g1"
+  value_names: "value1"
+  partial_agg: true
+  finalize_results: true
+  sliding_window {
+    time_column {
+      node: 0
+      index: 0
+    }
+    window_ns: 20
+    slide_ns: 10
+  }
+})";
+
 std::unique_ptr<ExecState> MakeTestExecState(udf::Registry* registry) {
   auto table_store = std::make_shared<table_store::TableStore>();
   return std::make_unique<ExecState>(registry, table_store, MockResultSinkStubGenerator,
@@ -648,6 +715,42 @@ TEST_F(AggNodeTest, multiple_groups_with_string_blocking) {
       .Close();
 }
 
+// String group keys read from the table store's cold batches are dictionary encoded.
+TEST_F(AggNodeTest, multiple_groups_with_dictionary_string_blocking) {
+  auto plan_node = PlanNodeFromPbtxt(kBlockingMultipleGroupAgg);
+  RowDescriptor input_rd({types::DataType::STRING, types::DataType::INT64, types::DataType::INT64});
+
+  RowDescriptor output_rd(
+      {types::DataType::STRING, types::DataType::INT64, types::DataType::INT64});
+
+  // The fourth row isn't selected.
+  auto encoded_rb = RowBatchBuilder(input_rd, 5, /*eow*/ false, /*eos*/ false)
+                        .AddDictionaryColumn({"abc", "def", "abc", "zzz", "fgh"})
+                        .AddColumn<types::Int64Value>({2, 1, 3, 9, 1})
+                        .AddColumn<types::Int64Value>({2, 5, 3, 9, 1})
+                        .get();
+  ASSERT_OK(encoded_rb.SetSelection(
+      std::make_shared<RowBatch::SelectionVector>(RowBatch::SelectionVector{0, 1, 2, 4})));
+
+  auto tester = exec::ExecNodeTester<AggNode, plan::AggregateOperator>(
+      *plan_node, output_rd, {input_rd}, exec_state_.get());
+
+  tester.ConsumeNext(encoded_rb, 0, 0)
+      .ConsumeNext(RowBatchBuilder(input_rd, 4, true, true)
+                       .AddColumn<types::StringValue>({"ijk", "abc", "abc", "def"})
+                       .AddColumn<types::Int64Value>({1, 2, 3, 3})
+                       .AddColumn<types::Int64Value>({1, 3, 3, 8})
+                       .get(),
+                   0)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 6, true, true)
+                          .AddColumn<types::StringValue>({"abc", "def", "abc", "fgh", "ijk", "def"})
+                          .AddColumn<types::Int64Value>({2, 1, 3, 1, 1, 3})
+                          .AddColumn<types::Int64Value>({4, 1, 6, 1, 1, 3})
+                          .get(),
+                      false)
+      .Close();
+}
+
 TEST_F(AggNodeTest, no_groups_windowed) {
   auto plan_node = PlanNodeFromPbtxt(kWindowedNoGroupAgg);
   RowDescriptor input_rd({types::DataType::INT64, types::DataType::INT64});
@@ -982,6 +1085,123 @@ TEST_F(AggNodeTest, multiple_groups_partial_finalize) {
       .Close();
 }
 
+TEST_F(AggNodeTest, no_groups_sliding_window) {
+  auto plan_node = PlanNodeFromPbtxt(kSlidingWindowNoGroupAgg);
+  RowDescriptor input_rd({types::DataType::TIME64NS, types::DataType::INT64});
+
+  RowDescriptor output_rd({types::DataType::INT64});
+
+  auto tester = exec::ExecNodeTester<AggNode, plan::AggregateOperator>(
+      *plan_node, output_rd, {input_rd}, exec_state_.get());
+
+  // Panes: [0, 10) = 3, [10, 20) = 4, [20, 30) = 5 + 6, [30, 40) = 7.
+  tester
+      .ConsumeNext(RowBatchBuilder(input_rd, 3, /*eow*/ false, /*eos*/ false)
+                       .AddColumn<types::Time64NSValue>({1, 2, 11})
+                       .AddColumn<types::Int64Value>({1, 2, 4})
+                       .get(),
+                   0, 1)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 1, true, false)
+                          .AddColumn<types::Int64Value>({Int64Value(3)})
+                          .get())
+      .ConsumeNext(RowBatchBuilder(input_rd, 2, false, false)
+                       .AddColumn<types::Time64NSValue>({25, 26})
+                       .AddColumn<types::Int64Value>({5, 6})
+                       .get(),
+                   0, 1)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 1, true, false)
+                          .AddColumn<types::Int64Value>({Int64Value(7)})
+                          .get())
+      .ConsumeNext(RowBatchBuilder(input_rd, 1, true, true)
+                       .AddColumn<types::Time64NSValue>({35})
+                       .AddColumn<types::Int64Value>({7})
+                       .get(),
+                   0, 2)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 1, true, false)
+                          .AddColumn<types::Int64Value>({Int64Value(15)})
+                          .get())
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 1, true, true)
+                          .AddColumn<types::Int64Value>({Int64Value(18)})
+                          .get())
+      .Close();
+}
+
+TEST_F(AggNodeTest, single_group_sliding_window) {
+  auto plan_node = PlanNodeFromPbtxt(kSlidingWindowSingleGroupAgg);
+  RowDescriptor input_rd(
+      {types::DataType::INT64, types::DataType::INT64, types::DataType::INT64});
+
+  RowDescriptor output_rd({types::DataType::INT64, types::DataType::INT64});
+
+  auto tester = exec::ExecNodeTester<AggNode, plan::AggregateOperator>(
+      *plan_node, output_rd, {input_rd}, exec_state_.get());
+
+  tester
+      .ConsumeNext(RowBatchBuilder(input_rd, 4, /*eow*/ false, /*eos*/ false)
+                       .AddColumn<types::Int64Value>({1, 5, 12, 14})
+                       .AddColumn<types::Int64Value>({1, 2, 1, 1})
+                       .AddColumn<types::Int64Value>({1, 2, 3, 4})
+                       .get(),
+                   0, 1)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 2, true, false)
+                          .AddColumn<types::Int64Value>({1, 2})
+                          .AddColumn<types::Int64Value>({1, 2})
+                          .get(),
+                      false)
+      // The row at time 3 is older than the window [10, 30) when it arrives, so it's dropped.
+      // Group 2 only shows up in the expired pane [0, 10), so it isn't part of the last window.
+      .ConsumeNext(RowBatchBuilder(input_rd, 3, true, true)
+                       .AddColumn<types::Int64Value>({21, 3, 25})
+                       .AddColumn<types::Int64Value>({3, 1, 1})
+                       .AddColumn<types::Int64Value>({10, 100, 20})
+                       .get(),
+                   0, 2)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 2, true, false)
+                          .AddColumn<types::Int64Value>({1, 2})
+                          .AddColumn<types::Int64Value>({8, 2})
+                          .get(),
+                      false)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 2, true, true)
+                          .AddColumn<types::Int64Value>({1, 3})
+                          .AddColumn<types::Int64Value>({27, 10})
+                          .get(),
+                      false)
+      .Close();
+}
+
+TEST_F(AggNodeTest, single_group_sliding_window_emit_mid_batch) {
+  auto plan_node = PlanNodeFromPbtxt(kSlidingWindowSingleGroupAgg);
+  RowDescriptor input_rd(
+      {types::DataType::INT64, types::DataType::INT64, types::DataType::INT64});
+
+  RowDescriptor output_rd({types::DataType::INT64, types::DataType::INT64});
+
+  auto tester = exec::ExecNodeTester<AggNode, plan::AggregateOperator>(
+      *plan_node, output_rd, {input_rd}, exec_state_.get());
+
+  // The row at time 12 starts a new pane in the middle of the batch, so the window ending with the
+  // pane [0, 10) is sent before the rest of the batch is aggregated. It only has one group, fewer
+  // than the rows that follow it in the batch.
+  tester
+      .ConsumeNext(RowBatchBuilder(input_rd, 6, /*eow*/ true, /*eos*/ true)
+                       .AddColumn<types::Int64Value>({1, 2, 3, 12, 13, 14})
+                       .AddColumn<types::Int64Value>({1, 1, 1, 2, 3, 1})
+                       .AddColumn<types::Int64Value>({1, 2, 3, 4, 5, 6})
+                       .get(),
+                   0, 2)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 1, true, false)
+                          .AddColumn<types::Int64Value>({1})
+                          .AddColumn<types::Int64Value>({6})
+                          .get(),
+                      false)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 3, true, true)
+                          .AddColumn<types::Int64Value>({1, 2, 3})
+                          .AddColumn<types::Int64Value>({12, 4, 5})
+                          .get(),
+                      false)
+      .Close();
+}
+
 }  // namespace exec
 }  // namespace carnot
 }  // namespace px
@@ -35,6 +35,14 @@
 #include "src/shared/types/arrow_adapter.h"
 #include "src/shared/types/type_utils.h"
 
+DEFINE_int64(carnot_join_memory_budget_bytes,
+             gflags::Int64FromEnv("PL_CARNOT_JOIN_MEMORY_BUDGET_BYTES", 256 * 1024 * 1024),
+             "The number of bytes of build rows a join keeps in memory. When the build side grows "
+             "beyond this limit, partitions of it are spilled to --carnot_join_spill_dir.");
+DEFINE_string(carnot_join_spill_dir, gflags::StringFromEnv("PL_CARNOT_JOIN_SPILL_DIR", ""),
+              "Local directory that joins spill the build side to when it exceeds "
+              "--carnot_join_memory_budget_bytes. Spilling is disabled if empty.");
+
 namespace px {
 namespace carnot {
 namespace exec {
@@ -124,118 +132,42 @@ Status EquijoinNode::InitializeColumnBuilders() {
   return Status::OK();
 }
 
-Status EquijoinNode::PrepareImpl(ExecState* /*exec_state*/) {
+Status EquijoinNode::PrepareImpl(ExecState* exec_state) {
   column_builders_.resize(output_descriptor_->size());
   PX_RETURN_IF_ERROR(InitializeColumnBuilders());
 
+  // Spill before the build side takes more than half of the memory that the query has left, so
+  // that a large join degrades to spilling instead of failing the query.
+  int64_t memory_budget_bytes = std::min<int64_t>(
+      FLAGS_carnot_join_memory_budget_bytes, exec_state->memory_tracker()->available_bytes() / 2);
+  hash_table_ = std::make_unique<JoinHashTable>(key_data_types_, build_spec_.input_col_types,
+                                                memory_budget_bytes, FLAGS_carnot_join_spill_dir);
+  build_memory_.set_tracker(exec_state->memory_tracker());
   return Status::OK();
 }
 
 Status EquijoinNode::OpenImpl(ExecState* /*exec_state*/) { return Status::OK(); }
 
 Status EquijoinNode::CloseImpl(ExecState* /*exec_state*/) {
-  join_keys_chunk_.clear();
-  build_buffer_.clear();
-  probed_keys_.clear();
-  key_values_pool_.Clear();
+  PX_RETURN_IF_ERROR(build_memory_.Resize(0));
+  if (hash_table_ != nullptr) {
+    VLOG(1) << absl::Substitute(
+        "$0: $1 probe rows dropped by the bloom filter, $2 partitions spilled to disk.",
+        DebugString(), hash_table_->probe_rows_filtered(), hash_table_->num_spilled_partitions());
+  }
+  probe_matches_.clear();
+  hash_table_.reset();
   return Status::OK();
 }
 
-template <types::DataType DT>
-void ExtractIntoRowTuples(std::vector<RowTuple*>* row_tuples, arrow::Array* input_col,
-                          int rt_col_idx) {
-  auto num_rows = input_col->length();
-  for (auto row_idx = 0; row_idx < num_rows; ++row_idx) {
-    ExtractIntoRowTuple<DT>((*row_tuples)[row_idx], input_col, rt_col_idx, row_idx);
-  }
-}
-
-Status EquijoinNode::ExtractJoinKeysForBatch(const table_store::schema::RowBatch& rb,
-                                             bool is_probe) {
-  // Reset the row tuples
-  for (auto& rt : join_keys_chunk_) {
-    if (rt == nullptr) {
-      rt = key_values_pool_.Add(new RowTuple(&key_data_types_));
-    } else {
-      rt->Reset();
-    }
-  }
-
-  // Grow the join_keys_chunk_ to be the size of the RowBatch.
-  size_t num_rows = rb.num_rows();
-  if (join_keys_chunk_.size() < num_rows) {
-    int prev_size = join_keys_chunk_.size();
-    join_keys_chunk_.reserve(num_rows);
-    for (size_t idx = prev_size; idx < num_rows; ++idx) {
-      auto tuple_ptr = key_values_pool_.Add(new RowTuple(&key_data_types_));
-      join_keys_chunk_.emplace_back(tuple_ptr);
-    }
-  }
-
+std::vector<const arrow::Array*> EquijoinNode::JoinKeyColumns(
+    const table_store::schema::RowBatch& rb, bool is_probe) const {
   const TableSpec& spec = is_probe ? probe_spec_ : build_spec_;
-
-  // Scan through all the group args in column order and extract the entire column.
-  for (size_t tuple_col_idx = 0; tuple_col_idx < spec.key_indices.size(); ++tuple_col_idx) {
-    auto input_col_idx = spec.key_indices[tuple_col_idx];
-    auto dt = key_data_types_[tuple_col_idx];
-    auto col = rb.ColumnAt(input_col_idx).get();
-
-#define TYPE_CASE(_dt_) ExtractIntoRowTuples<_dt_>(&join_keys_chunk_, col, tuple_col_idx);
-    PX_SWITCH_FOREACH_DATATYPE(dt, TYPE_CASE);
-#undef TYPE_CASE
-  }
-
-  return Status::OK();
-}
-
-std::vector<types::SharedColumnWrapper>* CreateWrapper(ObjectPool* pool,
-                                                       const std::vector<types::DataType>& types) {
-  auto ptr = pool->Add(new std::vector<types::SharedColumnWrapper>(types.size()));
-  for (size_t col_idx = 0; col_idx < types.size(); ++col_idx) {
-    (*ptr)[col_idx] = types::ColumnWrapper::Make(types[col_idx], 0);
-  }
-  return ptr;
-}
-
-Status EquijoinNode::HashRowBatch(const table_store::schema::RowBatch& rb) {
-  if (rb.num_rows() > static_cast<int64_t>(build_wrappers_chunk_.size())) {
-    build_wrappers_chunk_.resize(rb.num_rows());
-  }
-  for (auto row_idx = 0; row_idx < rb.num_rows(); ++row_idx) {
-    if (build_wrappers_chunk_[row_idx] == nullptr) {
-      build_wrappers_chunk_[row_idx] =
-          CreateWrapper(&column_values_pool_, build_spec_.input_col_types);
-    }
-  }
-
-  // Make sure the map has constructed the necessary column wrappers for all of the tuples.
-  for (auto row_idx = 0; row_idx < rb.num_rows(); ++row_idx) {
-    auto& rt = join_keys_chunk_[row_idx];
-    auto& current = build_buffer_[rt];
-    auto wrappers_ptr = current != nullptr ? current : build_wrappers_chunk_[row_idx];
-
-    // Now extract the values into the corresponding column wrappers.
-    for (size_t i = 0; i < build_spec_.input_col_indices.size(); ++i) {
-      const auto& rb_col_idx = build_spec_.input_col_indices[i];
-      auto arr = rb.ColumnAt(rb_col_idx).get();
-      const auto& dt = build_spec_.input_col_types[i];
-
-#define TYPE_CASE(_dt_) \
-  types::ExtractValueToColumnWrapper<_dt_>(wrappers_ptr->at(i).get(), arr, row_idx);
-      PX_SWITCH_FOREACH_DATATYPE(dt, TYPE_CASE);
-#undef TYPE_CASE
-    }
-    // Keep track of the number of rows that the build buffer matches for each key.
-    build_buffer_rows_[rt]++;
-
-    if (current == nullptr) {
-      std::swap(build_wrappers_chunk_[row_idx], current);
-      // Reset the new tuples that we added
-      join_keys_chunk_[row_idx] = nullptr;
-    }
+  std::vector<const arrow::Array*> key_cols;
+  for (auto input_col_idx : spec.key_indices) {
+    key_cols.push_back(rb.ColumnAt(input_col_idx).get());
   }
-
-  return Status::OK();
+  return key_cols;
 }
 
 template <types::DataType DT>
@@ -281,13 +213,13 @@ Status EquijoinNode::FlushChunkedRows(ExecState* exec_state) {
       auto output_idx = build_spec_.output_col_indices[col];
       auto builder = column_builders_.at(output_idx).get();
 
-      if (chunk.wrappers_ptr == nullptr) {
+      if (chunk.build_rows == nullptr) {
 #define TYPE_CASE(_dt_) PX_RETURN_IF_ERROR(AppendColumnDefaultValue<_dt_>(builder, chunk.num_rows))
         PX_SWITCH_FOREACH_DATATYPE(output_descriptor_->type(output_idx), TYPE_CASE);
 #undef TYPE_CASE
       } else {
-#define TYPE_CASE(_dt_)                                                                  \
-  PX_RETURN_IF_ERROR(AppendValuesFromWrapper<_dt_>(builder, chunk.wrappers_ptr->at(col), \
+#define TYPE_CASE(_dt_)                                                                        \
+  PX_RETURN_IF_ERROR(AppendValuesFromWrapper<_dt_>(builder, chunk.build_rows->columns.at(col), \
                                                    chunk.bb_row_idx, chunk.num_rows))
         PX_SWITCH_FOREACH_DATATYPE(output_descriptor_->type(output_idx), TYPE_CASE);
 #undef TYPE_CASE
@@ -305,7 +237,8 @@ Status EquijoinNode::FlushChunkedRows(ExecState* exec_state) {
         PX_SWITCH_FOREACH_DATATYPE(output_descriptor_->type(output_idx), TYPE_CASE);
 #undef TYPE_CASE
       } else {
-        auto src_idx = probe_spec_.input_col_indices[col];
+        // Deferred probe batches only hold the output probe columns.
+        auto src_idx = chunk.deferred_probe_rb ? col : probe_spec_.input_col_indices[col];
         auto builder = column_builders_[output_idx].get();
         auto input_col = chunk.rb->ColumnAt(src_idx).get();
 
@@ -325,15 +258,17 @@ Status EquijoinNode::FlushChunkedRows(ExecState* exec_state) {
 }
 
 Status EquijoinNode::MatchBuildValuesAndFlush(ExecState* exec_state,
-                                              std::vector<types::SharedColumnWrapper>* wrapper,
+                                              std::shared_ptr<const JoinBuildRows> build_rows,
                                               std::shared_ptr<RowBatch> probe_rb,
-                                              int64_t probe_rb_row, int64_t matching_bb_rows) {
+                                              int64_t probe_rb_row, bool deferred_probe_rb) {
+  int64_t matching_bb_rows = build_rows->num_rows;
   int64_t bb_rows_left = matching_bb_rows;
 
   while (bb_rows_left > 0) {
     auto available = output_rows_per_batch_ - (column_builders_[0]->length() + queued_rows_);
     auto chunk_rows = std::min(bb_rows_left, available);
-    OutputChunk c{probe_rb, wrapper, chunk_rows, matching_bb_rows - bb_rows_left, probe_rb_row};
+    OutputChunk c{probe_rb, build_rows, chunk_rows, matching_bb_rows - bb_rows_left, probe_rb_row,
+                  deferred_probe_rb};
     chunks_.emplace_back(c);
     queued_rows_ += chunk_rows;
     bb_rows_left -= chunk_rows;
@@ -351,21 +286,22 @@ Status EquijoinNode::DoProbe(ExecState* exec_state, const table_store::schema::R
     probe_eos_ = true;
   }
 
-  PX_RETURN_IF_ERROR(ExtractJoinKeysForBatch(rb, true));
-
-  if (rb.num_rows() > static_cast<int64_t>(probe_wrappers_chunk_.size())) {
-    probe_wrappers_chunk_.resize(rb.num_rows());
-  }
-
-  for (auto row_idx = 0; row_idx < rb.num_rows(); ++row_idx) {
-    auto it = build_buffer_.find(join_keys_chunk_[row_idx]);
-    if (it != build_buffer_.end()) {
-      probe_wrappers_chunk_[row_idx] = it->second;
-      probed_keys_.insert(it->first);
-    } else {
-      probe_wrappers_chunk_[row_idx] = nullptr;
+  if (plan_node_->order_by_time()) {
+    // Matches in spilled partitions are read back right away, to keep the output in probe order.
+    PX_RETURN_IF_ERROR(hash_table_->Probe(JoinKeyColumns(rb, /*is_probe*/ true), rb.num_rows(),
+                                          &probe_matches_));
+    probe_deferred_.assign(rb.num_rows(), false);
+  } else {
+    std::vector<const arrow::Array*> probe_cols;
+    for (auto input_col_idx : probe_spec_.input_col_indices) {
+      probe_cols.push_back(rb.ColumnAt(input_col_idx).get());
     }
+    PX_RETURN_IF_ERROR(hash_table_->ProbeOrDefer(JoinKeyColumns(rb, /*is_probe*/ true), probe_cols,
+                                                 rb.num_rows(), &probe_matches_,
+                                                 &probe_deferred_));
   }
+  // Probing reads spilled partitions back into memory.
+  PX_RETURN_IF_ERROR(build_memory_.Resize(hash_table_->bytes_in_memory()));
 
   auto rb_ptr = std::make_shared<RowBatch>(rb);
 
@@ -374,20 +310,23 @@ Status EquijoinNode::DoProbe(ExecState* exec_state, const table_store::schema::R
       PX_RETURN_IF_ERROR(FlushChunkedRows(exec_state));
     }
 
-    if (probe_wrappers_chunk_[row_idx] == nullptr) {
-      if (probe_spec_.emit_unmatched_rows) {
-        OutputChunk c{rb_ptr, nullptr, 1, 0, row_idx};
+    if (probe_matches_[row_idx] == nullptr) {
+      // Deferred rows have matches, which are output by JoinDeferredProbeRows.
+      if (probe_spec_.emit_unmatched_rows && !probe_deferred_[row_idx]) {
+        OutputChunk c{rb_ptr, nullptr, 1, 0, row_idx, false};
         chunks_.emplace_back(c);
         queued_rows_ += 1;
       }
       continue;
     }
 
-    PX_RETURN_IF_ERROR(MatchBuildValuesAndFlush(exec_state, probe_wrappers_chunk_[row_idx], rb_ptr,
-                                                row_idx,
-                                                build_buffer_rows_[join_keys_chunk_[row_idx]]));
+    PX_RETURN_IF_ERROR(
+        MatchBuildValuesAndFlush(exec_state, probe_matches_[row_idx], rb_ptr, row_idx));
   }
 
+  if (probe_eos_) {
+    PX_RETURN_IF_ERROR(JoinDeferredProbeRows(exec_state));
+  }
   if (probe_eos_ && queued_rows_ > 0) {
     PX_RETURN_IF_ERROR(FlushChunkedRows(exec_state));
   }
@@ -395,14 +334,26 @@ Status EquijoinNode::DoProbe(ExecState* exec_state, const table_store::schema::R
   return Status::OK();
 }
 
+Status EquijoinNode::JoinDeferredProbeRows(ExecState* exec_state) {
+  return hash_table_->JoinDeferredProbeRows(
+      probe_spec_.input_col_types,
+      [this, exec_state](std::shared_ptr<RowBatch> probe_rb,
+                         const std::vector<std::shared_ptr<const JoinBuildRows>>& matches) {
+        // Every spilled partition is read back once, for all of its deferred probe rows.
+        PX_RETURN_IF_ERROR(build_memory_.Resize(hash_table_->bytes_in_memory()));
+        for (int64_t row_idx = 0; row_idx < probe_rb->num_rows(); ++row_idx) {
+          PX_RETURN_IF_ERROR(MatchBuildValuesAndFlush(exec_state, matches[row_idx], probe_rb,
+                                                      row_idx, /*deferred_probe_rb*/ true));
+        }
+        return Status::OK();
+      });
+}
+
 Status EquijoinNode::EmitUnmatchedBuildRows(ExecState* exec_state) {
-  for (auto it = build_buffer_.begin(); it != build_buffer_.end(); ++it) {
-    if (probed_keys_.find(it->first) != probed_keys_.end()) {
-      continue;
-    }
-    PX_RETURN_IF_ERROR(MatchBuildValuesAndFlush(exec_state, it->second, nullptr, 0,
-                                                build_buffer_rows_[it->first]));
-  }
+  PX_RETURN_IF_ERROR(hash_table_->ForEachUnprobed(
+      [this, exec_state](std::shared_ptr<const JoinBuildRows> build_rows) {
+        return MatchBuildValuesAndFlush(exec_state, std::move(build_rows), nullptr, 0);
+      }));
 
   if (queued_rows_ > 0) {
     PX_RETURN_IF_ERROR(FlushChunkedRows(exec_state));
@@ -416,10 +367,16 @@ Status EquijoinNode::ConsumeBuildBatch(ExecState* exec_state,
     build_eos_ = true;
   }
 
-  PX_RETURN_IF_ERROR(ExtractJoinKeysForBatch(rb, false));
-  PX_RETURN_IF_ERROR(HashRowBatch(rb));
+  std::vector<const arrow::Array*> build_cols;
+  for (auto input_col_idx : build_spec_.input_col_indices) {
+    build_cols.push_back(rb.ColumnAt(input_col_idx).get());
+  }
+  PX_RETURN_IF_ERROR(hash_table_->AddBuildBatch(JoinKeyColumns(rb, /*is_probe*/ false),
+                                                build_cols, rb.num_rows()));
+  PX_RETURN_IF_ERROR(build_memory_.Resize(hash_table_->bytes_in_memory()));
 
   if (build_eos_) {
+    PX_RETURN_IF_ERROR(hash_table_->FinishBuild());
     while (probe_batches_.size()) {
       PX_RETURN_IF_ERROR(DoProbe(exec_state, probe_batches_.front()));
       probe_batches_.pop();
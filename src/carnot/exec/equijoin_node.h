@@ -30,15 +30,17 @@
 
 #include "src/carnot/exec/exec_node.h"
 #include "src/carnot/exec/exec_state.h"
-#include "src/carnot/exec/row_tuple.h"
+#include "src/carnot/exec/join_hash_table.h"
 #include "src/carnot/plan/operators.h"
 #include "src/common/base/base.h"
 #include "src/common/base/status.h"
-#include "src/common/memory/memory.h"
 #include "src/shared/types/column_wrapper.h"
 #include "src/shared/types/types.h"
 #include "src/table_store/table_store.h"
 
+DECLARE_int64(carnot_join_memory_budget_bytes);
+DECLARE_string(carnot_join_spill_dir);
+
 namespace px {
 namespace carnot {
 namespace exec {
@@ -77,14 +79,15 @@ class EquijoinNode : public ProcessingNode {
   Status InitializeColumnBuilders();
   bool IsProbeTable(size_t parent_index);
   Status FlushChunkedRows(ExecState* exec_state);
-  Status ExtractJoinKeysForBatch(const table_store::schema::RowBatch& rb, bool is_probe);
-  Status HashRowBatch(const table_store::schema::RowBatch& rb);
+  std::vector<const arrow::Array*> JoinKeyColumns(const table_store::schema::RowBatch& rb,
+                                                  bool is_probe) const;
 
   Status DoProbe(ExecState* exec_state, const table_store::schema::RowBatch& rb);
   Status MatchBuildValuesAndFlush(ExecState* exec_state,
-                                  std::vector<types::SharedColumnWrapper>* wrapper,
+                                  std::shared_ptr<const JoinBuildRows> build_rows,
                                   std::shared_ptr<table_store::schema::RowBatch> probe_rb,
-                                  int64_t probe_rb_row_idx, int64_t matching_bb_rows);
+                                  int64_t probe_rb_row_idx, bool deferred_probe_rb = false);
+  Status JoinDeferredProbeRows(ExecState* exec_state);
   Status EmitUnmatchedBuildRows(ExecState* exec_state);
   Status NextOutputBatch(ExecState* exec_state);
   Status ConsumeBuildBatch(ExecState* exec_state, const table_store::schema::RowBatch& rb);
@@ -115,10 +118,12 @@ class EquijoinNode : public ProcessingNode {
   // to the column builders.
   struct OutputChunk {
     std::shared_ptr<table_store::schema::RowBatch> rb;
-    std::vector<types::SharedColumnWrapper>* wrappers_ptr;
+    std::shared_ptr<const JoinBuildRows> build_rows;
     int64_t num_rows;
     int64_t bb_row_idx;
     int64_t probe_row_idx;
+    // Whether rb is a batch of deferred probe rows, which only has the output probe columns.
+    bool deferred_probe_rb;
   };
 
   int64_t queued_rows_ = 0;
@@ -129,27 +134,18 @@ class EquijoinNode : public ProcessingNode {
   std::queue<table_store::schema::RowBatch> probe_batches_;
   // Column builders will flush a batch once they hit output_rows_per_batch_ rows.
   std::vector<std::unique_ptr<arrow::ArrayBuilder>> column_builders_;
-  // Manages the RowTuples containing the keys for the join.
-  ObjectPool key_values_pool_{"equijoin_kv_pool"};
-  ObjectPool column_values_pool_{"equijoin_col_vals_pool"};
-
-  // Chunk of data to use when extracting join keys.
-  std::vector<RowTuple*> join_keys_chunk_;
-  // Chunk of data to use when performing the build stage of the join.
-  std::vector<std::vector<types::SharedColumnWrapper>*> build_wrappers_chunk_;
-
-  // Chunk of data to use when performing the probe stage of the join.
-  // This will store build table data from `build_buffer_`.
-  std::vector<std::vector<types::SharedColumnWrapper>*> probe_wrappers_chunk_;
-  AbslRowTupleHashMap<std::vector<types::SharedColumnWrapper>*> build_buffer_;
-  // Store the number of rows that match a given set of keys for the build buffer.
-  // This is necessary to store in addition to the values in `build_buffer_` in
-  // the event that no columns from the build side are emitted.
-  AbslRowTupleHashMap<int64_t> build_buffer_rows_;
-
-  // For joins where the build_buffer_ needs to emit any non-probed rows at the end of the join,
-  // keep track of which ones they were.
-  AbslRowTupleHashSet probed_keys_;
+
+  // The build side of the join, which also keeps track of the build keys that were probed, for
+  // joins that emit the unmatched build rows at the end.
+  std::unique_ptr<JoinHashTable> hash_table_;
+  // The build rows that the hash table holds in memory, accounted against the query's limit.
+  MemoryReservation build_memory_;
+  // Chunk of data to use when performing the probe stage of the join. Holds the matching build
+  // rows of every row of the probe batch.
+  std::vector<std::shared_ptr<const JoinBuildRows>> probe_matches_;
+  // Whether every row of the probe batch was deferred until the end of the probe side, because its
+  // matches are spilled to disk.
+  std::vector<bool> probe_deferred_;
 
   // Handle on the most recent RowBatch (in case it's the final one).
   std::unique_ptr<table_store::schema::RowBatch> pending_output_batch_;
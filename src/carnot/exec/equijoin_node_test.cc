@@ -29,6 +29,7 @@
 #include "src/carnot/planpb/test_proto.h"
 #include "src/carnot/udf/base.h"
 #include "src/carnot/udf/registry.h"
+#include "src/common/testing/testing.h"
 
 namespace px {
 namespace carnot {
@@ -46,6 +47,7 @@ using udf::FunctionContext;
 // 3) non-time ordered full outer join (all batches from build first)
 // 4) non-time ordered no matches inner join
 // 5) non-time ordered many matches per key inner join
+// 6) the same as 5), with the build side spilled to disk
 
 class JoinNodeTest : public ::testing::Test {
  public:
@@ -686,6 +688,96 @@ TEST_F(JoinNodeTest, unordered_many_matches) {
       .Close();
 }
 
+TEST_F(JoinNodeTest, unordered_many_matches_spilled) {
+  // Same as unordered_many_matches, but every build batch is spilled to disk. The probe rows that
+  // match spilled rows are joined after the last probe batch, one spilled partition at a time, so
+  // only the order of the output changes.
+  px::testing::TempDir spill_dir;
+  auto prev_spill_dir = FLAGS_carnot_join_spill_dir;
+  auto prev_memory_budget = FLAGS_carnot_join_memory_budget_bytes;
+  FLAGS_carnot_join_spill_dir = spill_dir.path().string();
+  FLAGS_carnot_join_memory_budget_bytes = 0;
+
+  // Left table input: [left_0:Time, left_1:Int64]
+  // Right table input: [right_0:Int64, right_1:Time]
+  // Output table: [left_1:Int, right_1(time):Time, right_0:Int64]
+  // Full outer join on left_0=right_1
+  const char* proto = R"(
+  type: INNER
+  equality_conditions {
+    left_column_index: 0
+    right_column_index: 1
+  }
+  output_columns: {
+    parent_index: 0
+    column_index: 1
+  }
+  output_columns: {
+    parent_index: 1
+    column_index: 1
+  }
+  output_columns: {
+    parent_index: 1
+    column_index: 0
+  }
+  column_names: "left_1"
+  column_names: "time_"
+  column_names: "right_0"
+  rows_per_batch: 5
+)";
+
+  // Left
+  RowDescriptor input_rd_0({types::DataType::TIME64NS, types::DataType::INT64});
+  // Right
+  RowDescriptor input_rd_1({types::DataType::INT64, types::DataType::TIME64NS});
+  // Left[1], Right[1], Right[0]
+  RowDescriptor output_rd(
+      {types::DataType::INT64, types::DataType::TIME64NS, types::DataType::INT64});
+
+  auto plan_node = PlanNodeFromPbtxt(proto);
+  auto tester = exec::ExecNodeTester<EquijoinNode, plan::JoinOperator>(
+      *plan_node, output_rd, {input_rd_0, input_rd_1}, exec_state_.get());
+
+  tester
+      // Build(left) table
+      .ConsumeNext(RowBatchBuilder(input_rd_0, 5, /*eow*/ false, /*eos*/ false)
+                       .AddColumn<types::Time64NSValue>({101, 102, 103, 101, 102})
+                       .AddColumn<types::Int64Value>({1, 2, 3, 4, 5})
+                       .get(),
+                   0, 0)
+      // Build table
+      .ConsumeNext(RowBatchBuilder(input_rd_0, 3, /*eow*/ true, /*eos*/ true)
+                       .AddColumn<types::Time64NSValue>({103, 101, 104})
+                       .AddColumn<types::Int64Value>({6, 7, 8})
+                       .get(),
+                   0, 0)
+      // Probe(right) table
+      .ConsumeNext(RowBatchBuilder(input_rd_1, 4, false, false)
+                       .AddColumn<types::Int64Value>({10, 20, 30, 40})
+                       .AddColumn<types::Time64NSValue>({101, 101, 102, 102})
+                       .get(),
+                   1, 0)
+      // Probe table
+      .ConsumeNext(RowBatchBuilder(input_rd_1, 5, true, true)
+                       .AddColumn<types::Int64Value>({50, 60, 70, 80, 90})
+                       .AddColumn<types::Time64NSValue>({103, 103, 103, 103, 105})
+                       .get(),
+                   1, 4)
+      .ExpectRowBatchesData(
+          RowBatchBuilder(output_rd, 18, true, true)
+              .AddColumn<types::Int64Value>({1, 4, 7, 1, 4, 7, 2, 5, 2, 5, 3, 6, 3, 6, 3, 6, 3, 6})
+              .AddColumn<types::Time64NSValue>({101, 101, 101, 101, 101, 101, 102, 102, 102, 102,
+                                                103, 103, 103, 103, 103, 103, 103, 103})
+              .AddColumn<types::Int64Value>({10, 10, 10, 20, 20, 20, 30, 30, 40, 40, 50, 50, 60, 60,
+                                             70, 70, 80, 80})
+              .get(),
+          4)
+      .Close();
+
+  FLAGS_carnot_join_spill_dir = prev_spill_dir;
+  FLAGS_carnot_join_memory_budget_bytes = prev_memory_budget;
+}
+
 }  // namespace exec
 }  // namespace carnot
 }  // namespace px
@@ -19,6 +19,7 @@
 #include "src/carnot/exec/exec_graph.h"
 
 #include <algorithm>
+#include <limits>
 #include <memory>
 #include <set>
 #include <unordered_map>
@@ -35,7 +36,10 @@
 #include "src/carnot/exec/map_node.h"
 #include "src/carnot/exec/memory_sink_node.h"
 #include "src/carnot/exec/memory_source_node.h"
+#include "src/carnot/exec/morsel_exchange_node.h"
 #include "src/carnot/exec/otel_export_sink_node.h"
+#include "src/carnot/exec/rebatch_node.h"
+#include "src/carnot/exec/top_k_node.h"
 #include "src/carnot/exec/udtf_source_node.h"
 #include "src/carnot/exec/union_node.h"
 #include "src/carnot/plan/operators.h"
@@ -59,10 +63,14 @@ Status ExecutionGraph::Init(table_store::schema::Schema* schema, plan::PlanState
   exec_state_ = exec_state;
   collect_exec_node_stats_ = collect_exec_node_stats;
   consecutive_generate_calls_per_source_ = consecutive_generate_calls_per_source;
+  if (exec_state->morsel_executor() != nullptr) {
+    num_exec_threads_ = static_cast<int32_t>(exec_state->morsel_executor()->num_threads());
+  }
 
   std::unordered_map<int64_t, ExecNode*> nodes;
   std::unordered_map<int64_t, RowDescriptor> descriptors;
-  return plan::PlanFragmentWalker()
+  absl::flat_hash_set<int64_t> memory_sources;
+  auto walk_status = plan::PlanFragmentWalker()
       .OnMap([&](auto& node) {
         return OnOperatorImpl<plan::MapOperator, MapNode>(node, &descriptors);
       })
@@ -73,14 +81,26 @@ Status ExecutionGraph::Init(table_store::schema::Schema* schema, plan::PlanState
         return OnOperatorImpl<plan::AggregateOperator, AggNode>(node, &descriptors);
       })
       .OnMemorySource([&](auto& node) {
+        memory_sources.insert(node.id());
         return OnOperatorImpl<plan::MemorySourceOperator, MemorySourceNode>(node, &descriptors);
       })
       .OnFilter([&](auto& node) {
-        return OnOperatorImpl<plan::FilterOperator, FilterNode>(node, &descriptors);
+        PX_RETURN_IF_ERROR(OnOperatorImpl<plan::FilterOperator, FilterNode>(node, &descriptors));
+        // If the filter is the only consumer of a memory source, let the memory source use the
+        // filter to skip table batches that can't match it.
+        auto parents = pf_->dag().ParentsOf(node.id());
+        if (parents.size() == 1 && memory_sources.contains(parents[0]) &&
+            pf_->dag().DependenciesOf(parents[0]).size() == 1) {
+          static_cast<MemorySourceNode*>(nodes_[parents[0]])->PushDownFilter(node);
+        }
+        return Status::OK();
       })
       .OnLimit([&](auto& node) {
         return OnOperatorImpl<plan::LimitOperator, LimitNode>(node, &descriptors);
       })
+      .OnTopK([&](auto& node) {
+        return OnOperatorImpl<plan::TopKOperator, TopKNode>(node, &descriptors);
+      })
       .OnUnion([&](auto& node) {
         return OnOperatorImpl<plan::UnionOperator, UnionNode>(node, &descriptors);
       })
@@ -109,6 +129,186 @@ Status ExecutionGraph::Init(table_store::schema::Schema* schema, plan::PlanState
         return OnOperatorImpl<plan::OTelExportSinkOperator, OTelExportSinkNode>(node, &descriptors);
       })
       .Walk(pf_);
+  PX_RETURN_IF_ERROR(walk_status);
+
+  PX_RETURN_IF_ERROR(UseResultCache(memory_sources));
+  PX_RETURN_IF_ERROR(ParallelizePipelines(memory_sources, descriptors));
+  return RebatchSources(memory_sources, descriptors);
+}
+
+Status ExecutionGraph::UseResultCache(const absl::flat_hash_set<int64_t>& memory_sources) {
+  auto* cache = exec_state_->result_cache();
+  if (cache == nullptr) {
+    return Status::OK();
+  }
+  for (int64_t source_id : sources_) {
+    if (!memory_sources.contains(source_id) ||
+        static_cast<MemorySourceNode*>(nodes_[source_id])->streaming()) {
+      continue;
+    }
+    const auto& source_op =
+        static_cast<const plan::MemorySourceOperator&>(*pf_->nodes().at(source_id));
+    const auto* table =
+        exec_state_->table_store()->GetTable(source_op.TableName(), source_op.Tablet());
+    if (table == nullptr) {
+      continue;
+    }
+    // Rows are put in buckets by the table's time column.
+    auto relation = table->GetRelation();
+    if (!relation.HasColumn("time_") || relation.GetColumnType("time_") != types::TIME64NS) {
+      continue;
+    }
+
+    // Follow the chain of single input, single output maps and filters below the source, up to a
+    // blocking aggregate.
+    std::vector<const plan::Operator*> pipeline;
+    int64_t agg_id = -1;
+    auto deps = pf_->dag().DependenciesOf(source_id);
+    while (deps.size() == 1 && pf_->dag().ParentsOf(deps[0]).size() == 1) {
+      const auto* op = pf_->nodes().at(deps[0]).get();
+      if (op->op_type() == planpb::AGGREGATE_OPERATOR) {
+        const auto* agg_op = static_cast<const plan::AggregateOperator*>(op);
+        // Cached states are serialized, which not all UDAs support.
+        bool supports_partial = std::all_of(
+            agg_op->values().begin(), agg_op->values().end(), [this](const auto& value) {
+              auto* def = exec_state_->GetUDADefinition(value->uda_id());
+              return def != nullptr && def->supports_partial();
+            });
+        if (supports_partial && agg_op->partial_agg() && !agg_op->windowed() &&
+            !agg_op->has_sliding_window()) {
+          pipeline.push_back(op);
+          agg_id = deps[0];
+        }
+        break;
+      }
+      if ((op->op_type() != planpb::MAP_OPERATOR && op->op_type() != planpb::FILTER_OPERATOR) ||
+          !IsDeterministic(*op)) {
+        break;
+      }
+      pipeline.push_back(op);
+      deps = pf_->dag().DependenciesOf(deps[0]);
+    }
+    if (agg_id == -1) {
+      continue;
+    }
+
+    auto session = std::make_unique<ResultCacheSession>(
+        cache, ResultCache::PipelineKey(source_op, pipeline), table,
+        source_op.HasStartTime() ? source_op.start_time() : std::numeric_limits<int64_t>::min(),
+        source_op.HasStopTime() ? source_op.stop_time() : std::numeric_limits<int64_t>::max());
+    static_cast<MemorySourceNode*>(nodes_[source_id])->UseResultCache(session.get());
+    static_cast<AggNode*>(nodes_[agg_id])->UseResultCache(session.get());
+    result_cache_sessions_[source_id] = std::move(session);
+  }
+  return Status::OK();
+}
+
+bool ExecutionGraph::IsDeterministic(const plan::Operator& op) const {
+  std::vector<std::shared_ptr<const plan::ScalarExpression>> exprs;
+  if (op.op_type() == planpb::MAP_OPERATOR) {
+    exprs = static_cast<const plan::MapOperator&>(op).expressions();
+  } else if (op.op_type() == planpb::FILTER_OPERATOR) {
+    exprs.push_back(static_cast<const plan::FilterOperator&>(op).expression());
+  }
+
+  plan::ExpressionWalker<bool> walker;
+  walker.OnScalarValue([](auto, auto) -> bool { return true; });
+  walker.OnColumn([](auto, auto) -> bool { return true; });
+  walker.OnScalarFunc([this](const plan::ScalarFunc& fn, const std::vector<bool>& args) -> bool {
+    auto* def = exec_state_->GetScalarUDFDefinition(fn.udf_id());
+    return def != nullptr && def->deterministic() &&
+           std::all_of(args.begin(), args.end(), [](bool arg) { return arg; });
+  });
+  for (const auto& expr : exprs) {
+    auto deterministic_or_s = walker.Walk(*expr);
+    if (!deterministic_or_s.ok() || !deterministic_or_s.ConsumeValueOrDie()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+Status ExecutionGraph::ParallelizePipelines(
+    const absl::flat_hash_set<int64_t>& memory_sources,
+    const std::unordered_map<int64_t, RowDescriptor>& descriptors) {
+  if (num_exec_threads_ <= 1) {
+    return Status::OK();
+  }
+  // Iterate over sources_ rather than memory_sources, so that nodes are created in plan order.
+  for (int64_t source_id : sources_) {
+    if (!memory_sources.contains(source_id) ||
+        static_cast<MemorySourceNode*>(nodes_[source_id])->streaming() ||
+        result_cache_sessions_.contains(source_id)) {
+      continue;
+    }
+    // Follow the chain of single input, single output maps and filters below the source, up to a
+    // blocking aggregate.
+    std::vector<int64_t> pipeline;
+    bool ends_in_agg = false;
+    auto deps = pf_->dag().DependenciesOf(source_id);
+    while (deps.size() == 1 && pf_->dag().ParentsOf(deps[0]).size() == 1) {
+      auto it = pipeline_node_factories_.find(deps[0]);
+      if (it == pipeline_node_factories_.end()) {
+        break;
+      }
+      pipeline.push_back(deps[0]);
+      if (it->second.is_agg) {
+        ends_in_agg = true;
+        break;
+      }
+      deps = pf_->dag().DependenciesOf(deps[0]);
+    }
+    if (!ends_in_agg) {
+      continue;
+    }
+
+    std::vector<std::vector<ExecNode*>> worker_pipelines(num_exec_threads_);
+    for (auto& worker_pipeline : worker_pipelines) {
+      for (int64_t node_id : pipeline) {
+        PX_ASSIGN_OR_RETURN(auto node, pipeline_node_factories_[node_id].create());
+        if (!worker_pipeline.empty()) {
+          worker_pipeline.back()->AddChild(node, 0);
+        }
+        worker_pipeline.push_back(node);
+      }
+    }
+
+    auto head = nodes_[pipeline.front()];
+    auto exchange = pool_.Add(new MorselExchangeNode(std::move(worker_pipelines),
+                                                     static_cast<AggNode*>(nodes_[pipeline.back()]),
+                                                     exec_state_->morsel_executor()));
+    const auto& source_descriptor = descriptors.at(source_id);
+    // The exchange passes the source's batches to the head of the pipeline as is.
+    PX_RETURN_IF_ERROR(exchange->Init(*pipeline_node_factories_[pipeline.front()].op,
+                                      source_descriptor, {source_descriptor},
+                                      collect_exec_node_stats_));
+    nodes_[source_id]->ReplaceChild(head, exchange);
+    exchange->AddChild(head, 0);
+    exchanges_.push_back(exchange);
+  }
+  return Status::OK();
+}
+
+Status ExecutionGraph::RebatchSources(
+    const absl::flat_hash_set<int64_t>& memory_sources,
+    const std::unordered_map<int64_t, RowDescriptor>& descriptors) {
+  int64_t target_bytes = BatchSizer::InitialTargetBytesFromFlags();
+  if (target_bytes <= 0) {
+    return Status::OK();
+  }
+  for (int64_t source_id : sources_) {
+    // The aggregates of the result cache need to see the batches of the table as they are.
+    if (!memory_sources.contains(source_id) || result_cache_sessions_.contains(source_id)) {
+      continue;
+    }
+    auto rebatch = pool_.Add(new RebatchNode(target_bytes));
+    const auto& source_descriptor = descriptors.at(source_id);
+    PX_RETURN_IF_ERROR(rebatch->Init(*pf_->nodes().at(source_id), source_descriptor,
+                                     {source_descriptor}, collect_exec_node_stats_));
+    nodes_[source_id]->InterposeChild(rebatch);
+    rebatch_nodes_[source_id] = rebatch;
+  }
+  return Status::OK();
 }
 
 bool ExecutionGraph::YieldWithTimeout() {
@@ -215,6 +415,14 @@ Status ExecutionGraph::ExecuteSources() {
         PX_RETURN_IF_ERROR(source->GenerateNext(exec_state_));
       }
 
+      // Don't hold the rows of a source that caught up with its table while the query waits for
+      // more data.
+      auto rebatch = rebatch_nodes_.find(source_to_id[source]);
+      if (rebatch != rebatch_nodes_.end() && !source->NextBatchReady() &&
+          exec_state_->keep_running()) {
+        PX_RETURN_IF_ERROR(rebatch->second->Flush(exec_state_));
+      }
+
       // keep_running will be set to false when a downstream limit for this particular
       // source (set in exec_state) has been reached.
       if (!source->HasBatchesRemaining() || !exec_state_->keep_running()) {
@@ -298,6 +506,10 @@ Status ExecutionGraph::Execute() {
   // Get vector of nodes.
   std::vector<ExecNode*> nodes(nodes_.size());
   transform(nodes_.begin(), nodes_.end(), nodes.begin(), [](auto pair) { return pair.second; });
+  nodes.insert(nodes.end(), exchanges_.begin(), exchanges_.end());
+  for (const auto& entry : rebatch_nodes_) {
+    nodes.push_back(entry.second);
+  }
 
   for (auto node : nodes) {
     PX_RETURN_IF_ERROR(node->Prepare(exec_state_));
@@ -343,7 +555,13 @@ ExecutionStats ExecutionGraph::GetStats() const {
     bytes_processed += source_node->BytesProcessed();
     rows_processed += source_node->RowsProcessed();
   }
-  return ExecutionStats({bytes_processed, rows_processed});
+  int64_t result_cache_hits = 0;
+  int64_t result_cache_misses = 0;
+  for (const auto& entry : result_cache_sessions_) {
+    result_cache_hits += entry.second->hits();
+    result_cache_misses += entry.second->misses();
+  }
+  return ExecutionStats({bytes_processed, rows_processed, result_cache_hits, result_cache_misses});
 }
 
 }  // namespace exec
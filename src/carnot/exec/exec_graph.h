@@ -22,8 +22,10 @@
 #include <algorithm>
 #include <condition_variable>
 #include <cstdint>
+#include <functional>
 #include <memory>
 #include <string>
+#include <type_traits>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -32,6 +34,8 @@
 #include "src/carnot/exec/exec_node.h"
 #include "src/carnot/exec/exec_state.h"
 #include "src/carnot/exec/memory_source_node.h"
+#include "src/carnot/exec/rebatch_node.h"
+#include "src/carnot/exec/result_cache.h"
 #include "src/carnot/plan/plan_fragment.h"
 #include "src/carnot/plan/plan_state.h"
 #include "src/common/base/base.h"
@@ -46,6 +50,10 @@ namespace exec {
 struct ExecutionStats {
   int64_t bytes_processed;
   int64_t rows_processed;
+  // The number of time buckets of aggregate states that were merged from the result cache, and
+  // that were aggregated from the table, by the pipelines that use the result cache.
+  int64_t result_cache_hits;
+  int64_t result_cache_misses;
 };
 
 constexpr std::chrono::milliseconds kDefaultYieldTimeoutMS{1000};
@@ -195,6 +203,28 @@ class ExecutionGraph {
 
     AddNode(node.id(), execNode);
 
+    // Blocking aggregates, and the maps and filters that feed them, can be run on several threads
+    // by copying them into the pipelines of a MorselExchangeNode.
+    if constexpr (std::is_same_v<TOp, plan::MapOperator> ||
+                  std::is_same_v<TOp, plan::FilterOperator> ||
+                  std::is_same_v<TOp, plan::AggregateOperator>) {
+      bool is_agg = std::is_same_v<TOp, plan::AggregateOperator>;
+      bool windowed = false;
+      if constexpr (std::is_same_v<TOp, plan::AggregateOperator>) {
+        windowed = node.windowed();
+      }
+      if (num_exec_threads_ > 1 && !windowed) {
+        auto op = std::make_shared<TOp>(node);
+        auto create = [this, op, output_descriptor, input_descriptors]() -> StatusOr<ExecNode*> {
+          auto copy = pool_.Add(new TNode());
+          PX_RETURN_IF_ERROR(
+              copy->Init(*op, output_descriptor, input_descriptors, collect_exec_node_stats_));
+          return copy;
+        };
+        pipeline_node_factories_[node.id()] = PipelineNodeFactory{op, std::move(create), is_agg};
+      }
+    }
+
     // Update parents' children.
     for (size_t i = 0; i < parents.size(); ++i) {
       auto parent = nodes_.find(parents[i]);
@@ -209,6 +239,43 @@ class ExecutionGraph {
 
   Status ExecuteSources();
 
+  /**
+   * Makes the pipelines made of a non streaming memory source, a chain of maps and filters, and a
+   * blocking aggregate that performs the partial aggregate, use the result cache of the exec state.
+   * @param memory_sources The ids of the memory sources in the graph.
+   * @return A status of whether the result cache could be set up.
+   */
+  Status UseResultCache(const absl::flat_hash_set<int64_t>& memory_sources);
+
+  /**
+   * @return whether every function of the map or filter only depends on its arguments, so that its
+   * results can be reused by later queries.
+   */
+  bool IsDeterministic(const plan::Operator& op) const;
+
+  /**
+   * Moves the blocking aggregates that are fed by a non streaming memory source, through a chain
+   * of maps and filters, onto num_exec_threads_ worker threads. A MorselExchangeNode is inserted
+   * below every such memory source.
+   * @param memory_sources The ids of the memory sources in the graph.
+   * @param descriptors The descriptors of the execution nodes in the graph.
+   * @return A status of whether the pipelines could be created.
+   */
+  Status ParallelizePipelines(
+      const absl::flat_hash_set<int64_t>& memory_sources,
+      const std::unordered_map<int64_t, table_store::schema::RowDescriptor>& descriptors);
+
+  /**
+   * Inserts a RebatchNode below every memory source that doesn't use the result cache, if
+   * --carnot_target_batch_bytes is set.
+   * @param memory_sources The ids of the memory sources in the graph.
+   * @param descriptors The descriptors of the execution nodes in the graph.
+   * @return A status of whether the rebatch nodes could be created.
+   */
+  Status RebatchSources(
+      const absl::flat_hash_set<int64_t>& memory_sources,
+      const std::unordered_map<int64_t, table_store::schema::RowDescriptor>& descriptors);
+
   ExecState* exec_state_;
   ObjectPool pool_{"exec_graph_pool"};
   table_store::schema::Schema* schema_;
@@ -219,6 +286,27 @@ class ExecutionGraph {
   absl::flat_hash_set<int64_t> grpc_sinks_;
   std::unordered_map<int64_t, ExecNode*> nodes_;
 
+  // Number of threads of the query's MorselExecutor, 1 if it has none.
+  int32_t num_exec_threads_ = 1;
+  struct PipelineNodeFactory {
+    std::shared_ptr<const plan::Operator> op;
+    // Creates and initializes a copy of the exec node.
+    std::function<StatusOr<ExecNode*>()> create;
+    // Whether the node is the blocking aggregate at the end of a pipeline.
+    bool is_agg;
+  };
+  // The nodes that can be part of a parallel pipeline, by plan node id.
+  absl::flat_hash_map<int64_t, PipelineNodeFactory> pipeline_node_factories_;
+  // The exchanges inserted by ParallelizePipelines. They don't have a plan node id.
+  std::vector<ExecNode*> exchanges_;
+  // The rebatch nodes inserted by RebatchSources, by the id of their memory source.
+  absl::flat_hash_map<int64_t, RebatchNode*> rebatch_nodes_;
+
+  // The result cache sessions of the pipelines that use the result cache, by memory source id.
+  // These pipelines aren't parallelized, since their memory sources rely on the aggregate getting
+  // every row batch as soon as it's sent.
+  absl::flat_hash_map<int64_t, std::unique_ptr<ResultCacheSession>> result_cache_sessions_;
+
   SystemTimePoint query_start_time_;
 
   // How long to wait for any upstream result to make the initial connection to this query.
@@ -20,11 +20,14 @@
 
 #include <arrow/array.h>
 #include <arrow/memory_pool.h>
+#include <algorithm>
 #include <memory>
 #include <string>
 #include <tuple>
+#include <utility>
 #include <vector>
 
+#include <absl/strings/substitute.h>
 #include <google/protobuf/text_format.h>
 #include <gtest/gtest.h>
 #include <sole.hpp>
@@ -96,6 +99,82 @@ class ExecGraphTest : public BaseExecGraphTest {
     ASSERT_TRUE(TextFormat::MergeFromString(planpb::testutils::kPlanFragmentWithFourNodes, &pf_pb));
     ASSERT_OK(plan_fragment_->Init(pf_pb));
   }
+
+  // Writes a row batch with the given columns to the table.
+  void WriteBatch(Table* table, std::vector<std::shared_ptr<arrow::Array>> columns) {
+    auto rb = RowBatch(RowDescriptor(table->GetRelation().col_types()), columns[0]->length());
+    for (auto& column : columns) {
+      EXPECT_OK(rb.AddColumn(std::move(column)));
+    }
+    EXPECT_OK(table->WriteRowBatch(rb));
+  }
+
+  // Writes 10 batches of 5 (key, val) rows to the table, with 6 distinct keys spread across the
+  // batches. Returns the sum of the vals of each key.
+  absl::flat_hash_map<int64_t, int64_t> WriteBatches(Table* table) {
+    absl::flat_hash_map<int64_t, int64_t> sums;
+    for (int64_t batch_idx = 0; batch_idx < 10; ++batch_idx) {
+      std::vector<types::Int64Value> keys;
+      std::vector<types::Int64Value> vals;
+      for (int64_t i = 0; i < 5; ++i) {
+        int64_t key = (batch_idx * 7 + i) % 6;
+        keys.push_back(key);
+        vals.push_back(batch_idx * 10 + i);
+        sums[key] += batch_idx * 10 + i;
+      }
+      WriteBatch(table, {types::ToArrow(keys, arrow::default_memory_pool()),
+                         types::ToArrow(vals, arrow::default_memory_pool())});
+    }
+    return sums;
+  }
+
+  // Runs a plan that reads the table "numbers" and sums by key into the table "output", and
+  // returns the (key, sum) output rows in order. The plan runs on a morsel executor when
+  // num_threads > 1, and uses the result cache if there is one.
+  std::vector<std::pair<int64_t, int64_t>> RunPlan(const std::string& plan_str,
+                                                   const std::shared_ptr<Table>& table,
+                                                   int32_t num_threads = 1,
+                                                   ResultCache* cache = nullptr,
+                                                   ExecutionStats* stats = nullptr) {
+    std::vector<std::pair<int64_t, int64_t>> rows;
+    planpb::PlanFragment pf_pb;
+    EXPECT_TRUE(TextFormat::MergeFromString(plan_str, &pf_pb));
+    auto plan_fragment = std::make_shared<plan::PlanFragment>(1);
+    EXPECT_OK(plan_fragment->Init(pf_pb));
+
+    auto table_store = std::make_shared<table_store::TableStore>();
+    table_store->AddTable("numbers", table);
+    auto exec_state = std::make_unique<ExecState>(
+        func_registry_.get(), table_store, MockResultSinkStubGenerator, MockMetricsStubGenerator,
+        MockTraceStubGenerator, sole::uuid4(), nullptr, nullptr, [](grpc::ClientContext*) {},
+        nullptr, cache);
+    EXPECT_OK(exec_state->AddUDA(0, "sum", {types::DataType::INT64}));
+
+    auto plan_state = std::make_unique<plan::PlanState>(func_registry_.get());
+    auto schema = std::make_shared<table_store::schema::Schema>();
+    schema->AddRelation(1, table->GetRelation());
+
+    std::unique_ptr<MorselExecutor> executor;
+    if (num_threads > 1) {
+      executor = std::make_unique<MorselExecutor>(num_threads);
+      exec_state->set_morsel_executor(executor.get());
+    }
+    ExecutionGraph e;
+    EXPECT_OK(e.Init(schema.get(), plan_state.get(), exec_state.get(), plan_fragment.get(),
+                     /* collect_exec_node_stats */ false));
+    EXPECT_OK(e.Execute());
+    if (stats != nullptr) {
+      *stats = e.GetStats();
+    }
+
+    table_store::Table::Cursor cursor(exec_state->table_store()->GetTable("output"));
+    auto rb = cursor.GetNextRowBatch({0, 1}).ConsumeValueOrDie();
+    for (int64_t i = 0; i < rb->num_rows(); ++i) {
+      rows.emplace_back(types::GetValueFromArrowArray<types::INT64>(rb->ColumnAt(0).get(), i),
+                        types::GetValueFromArrowArray<types::INT64>(rb->ColumnAt(1).get(), i));
+    }
+    return rows;
+  }
 };
 
 TEST_F(ExecGraphTest, basic) {
@@ -279,6 +358,303 @@ TEST_F(ExecGraphTest, execute_time) {
       types::ToArrow(out_in2, arrow::default_memory_pool())));
 }
 
+class SumUDA : public udf::UDA {
+ public:
+  void Update(udf::FunctionContext*, types::Int64Value val) { sum_ = sum_.val + val.val; }
+  void Merge(udf::FunctionContext*, const SumUDA& other) { sum_ = sum_.val + other.sum_.val; }
+  types::Int64Value Finalize(udf::FunctionContext*) { return sum_; }
+
+ protected:
+  types::Int64Value sum_ = 0;
+};
+
+constexpr char kGroupedSumPlanFragment[] = R"(
+  id: 1,
+  dag {
+    nodes {
+      id: 1
+      sorted_children: 2
+    }
+    nodes {
+      id: 2
+      sorted_children: 3
+      sorted_parents: 1
+    }
+    nodes {
+      id: 3
+      sorted_parents: 2
+    }
+  }
+  nodes {
+    id: 1
+    op {
+      op_type: MEMORY_SOURCE_OPERATOR
+      mem_source_op {
+        name: "numbers"
+        column_idxs: 0
+        column_types: INT64
+        column_names: "key"
+        column_idxs: 1
+        column_types: INT64
+        column_names: "val"
+      }
+    }
+  }
+  nodes {
+    id: 2
+    op {
+      op_type: AGGREGATE_OPERATOR
+      agg_op {
+        windowed: false
+        values {
+          name: "sum"
+          args {
+            column {
+              node: 1
+              index: 1
+            }
+          }
+          args_data_types: INT64
+        }
+        groups {
+          node: 1
+          index: 0
+        }
+        group_names: "key"
+        value_names: "sum"
+        partial_agg: true
+        finalize_results: true
+      }
+    }
+  }
+  nodes {
+    id: 3
+    op {
+      op_type: MEMORY_SINK_OPERATOR
+      mem_sink_op {
+        name: "output"
+        column_types: INT64
+        column_types: INT64
+        column_names: "key"
+        column_names: "sum"
+      }
+    }
+  }
+)";
+
+TEST_F(ExecGraphTest, parallel_grouped_agg) {
+  func_registry_->RegisterOrDie<SumUDA>("sum");
+
+  table_store::schema::Relation rel({types::DataType::INT64, types::DataType::INT64},
+                                    {"key", "val"});
+  auto table = Table::Create("numbers", rel);
+  auto expected_sums = WriteBatches(table.get());
+  auto run = [&](int32_t num_threads) {
+    return RunPlan(kGroupedSumPlanFragment, table, num_threads);
+  };
+
+  auto serial_rows = run(1);
+  auto parallel_rows = run(4);
+  ASSERT_EQ(expected_sums.size(), serial_rows.size());
+  for (const auto& [key, sum] : serial_rows) {
+    EXPECT_EQ(expected_sums[key], sum);
+  }
+  // The groups may be in a different order than when running serially, but the same on every run.
+  EXPECT_THAT(parallel_rows, ::testing::UnorderedElementsAreArray(serial_rows));
+  EXPECT_EQ(parallel_rows, run(4));
+}
+
+TEST_F(ExecGraphTest, rebatched_grouped_agg) {
+  func_registry_->RegisterOrDie<SumUDA>("sum");
+
+  table_store::schema::Relation rel({types::DataType::INT64, types::DataType::INT64},
+                                    {"key", "val"});
+  auto table = Table::Create("numbers", rel);
+  // Batches of 5 rows of 16 bytes.
+  auto expected_sums = WriteBatches(table.get());
+  auto run = [&](int64_t target_batch_bytes, int32_t num_threads) {
+    PX_SET_FOR_SCOPE(FLAGS_carnot_target_batch_bytes, target_batch_bytes);
+    return RunPlan(kGroupedSumPlanFragment, table, num_threads);
+  };
+
+  auto rows = run(0, 1);
+  ASSERT_EQ(expected_sums.size(), rows.size());
+  // Coalesced into batches of 15 rows.
+  EXPECT_THAT(run(200, 1), ::testing::UnorderedElementsAreArray(rows));
+  // Split into batches of at most 2 rows.
+  EXPECT_THAT(run(32, 1), ::testing::UnorderedElementsAreArray(rows));
+  EXPECT_THAT(run(200, 4), ::testing::UnorderedElementsAreArray(rows));
+}
+
+class SerializableSumUDA : public udf::UDA {
+ public:
+  void Update(udf::FunctionContext*, types::Int64Value val) { sum_ = sum_.val + val.val; }
+  void Merge(udf::FunctionContext*, const SerializableSumUDA& other) {
+    sum_ = sum_.val + other.sum_.val;
+  }
+  types::Int64Value Finalize(udf::FunctionContext*) { return sum_; }
+  types::StringValue Serialize(udf::FunctionContext*) { return std::to_string(sum_.val); }
+  Status Deserialize(udf::FunctionContext*, const types::StringValue& data) {
+    sum_ = std::stoll(data);
+    return Status::OK();
+  }
+
+ protected:
+  types::Int64Value sum_ = 0;
+};
+
+// Sums val by key, over the rows of the table with time_ >= $0. The time column isn't read.
+constexpr char kTimedGroupedSumPlanFragment[] = R"(
+  id: 1,
+  dag {
+    nodes {
+      id: 1
+      sorted_children: 2
+    }
+    nodes {
+      id: 2
+      sorted_children: 3
+      sorted_parents: 1
+    }
+    nodes {
+      id: 3
+      sorted_parents: 2
+    }
+  }
+  nodes {
+    id: 1
+    op {
+      op_type: MEMORY_SOURCE_OPERATOR
+      mem_source_op {
+        name: "numbers"
+        column_idxs: 1
+        column_types: INT64
+        column_names: "key"
+        column_idxs: 2
+        column_types: INT64
+        column_names: "val"
+        start_time {
+          value: $0
+        }
+      }
+    }
+  }
+  nodes {
+    id: 2
+    op {
+      op_type: AGGREGATE_OPERATOR
+      agg_op {
+        windowed: false
+        values {
+          name: "sum"
+          args {
+            column {
+              node: 1
+              index: 1
+            }
+          }
+          args_data_types: INT64
+        }
+        groups {
+          node: 1
+          index: 0
+        }
+        group_names: "key"
+        value_names: "sum"
+        partial_agg: true
+        finalize_results: true
+      }
+    }
+  }
+  nodes {
+    id: 3
+    op {
+      op_type: MEMORY_SINK_OPERATOR
+      mem_sink_op {
+        name: "output"
+        column_types: INT64
+        column_types: INT64
+        column_names: "key"
+        column_names: "sum"
+      }
+    }
+  }
+)";
+
+TEST_F(ExecGraphTest, result_cache_reuses_complete_buckets) {
+  func_registry_->RegisterOrDie<SerializableSumUDA>("sum");
+
+  table_store::schema::Relation rel(
+      {types::DataType::TIME64NS, types::DataType::INT64, types::DataType::INT64},
+      {"time_", "key", "val"});
+  auto table = Table::Create("numbers", rel);
+  std::vector<int64_t> written_times;
+  // Writes a row per ns for times [begin, end), in batches that don't line up with the buckets.
+  auto write_rows = [&](int64_t begin, int64_t end) {
+    for (int64_t batch_begin = begin; batch_begin < end; batch_begin += 7) {
+      std::vector<types::Time64NSValue> times;
+      std::vector<types::Int64Value> keys;
+      std::vector<types::Int64Value> vals;
+      for (int64_t time = batch_begin; time < std::min(batch_begin + 7, end); ++time) {
+        times.push_back(time);
+        keys.push_back(time % 3);
+        vals.push_back(time);
+        written_times.push_back(time);
+      }
+      WriteBatch(table.get(), {types::ToArrow(times, arrow::default_memory_pool()),
+                               types::ToArrow(keys, arrow::default_memory_pool()),
+                               types::ToArrow(vals, arrow::default_memory_pool())});
+    }
+  };
+  auto expected_sums = [&](int64_t start_time, int64_t end) {
+    absl::flat_hash_map<int64_t, int64_t> sums;
+    for (int64_t time : written_times) {
+      if (time >= start_time && time < end) {
+        sums[time % 3] += time;
+      }
+    }
+    return sums;
+  };
+
+  ResultCache cache(/* max_bytes */ 1024 * 1024, /* bucket_ns */ 10);
+  // Runs the plan from the given start time, checks its results, and returns its stats.
+  auto run = [&](int64_t start_time, int64_t end) {
+    ExecutionStats stats;
+    auto rows = RunPlan(absl::Substitute(kTimedGroupedSumPlanFragment, start_time), table,
+                        /* num_threads */ 1, &cache, &stats);
+    EXPECT_EQ(expected_sums(start_time, end),
+              absl::flat_hash_map<int64_t, int64_t>(rows.begin(), rows.end()));
+    return stats;
+  };
+
+  write_rows(0, 100);
+  // Buckets [10, 80] are complete: they are after the start time, and followed by newer rows.
+  auto stats = run(5, 100);
+  EXPECT_EQ(0, stats.result_cache_hits);
+  EXPECT_EQ(10, stats.result_cache_misses);
+  EXPECT_EQ(95, stats.rows_processed);
+
+  stats = run(5, 100);
+  EXPECT_EQ(8, stats.result_cache_hits);
+  EXPECT_EQ(2, stats.result_cache_misses);
+  // Only the rows of buckets 0 and 90 are read.
+  EXPECT_EQ(15, stats.rows_processed);
+
+  // A later query only aggregates the partial bucket at its start, and the new rows.
+  write_rows(100, 120);
+  stats = run(25, 120);
+  EXPECT_EQ(6, stats.result_cache_hits);
+  EXPECT_EQ(4, stats.result_cache_misses);
+  EXPECT_EQ(35, stats.rows_processed);
+
+  // A late row of bucket 50 invalidates the cached buckets from 50 on, but buckets 30 and 40 are
+  // still used.
+  write_rows(55, 56);
+  stats = run(25, 120);
+  EXPECT_EQ(2, stats.result_cache_hits);
+  EXPECT_EQ(76, stats.rows_processed);
+}
+
 TEST_F(ExecGraphTest, two_limits_dont_interfere) {
   planpb::PlanFragment pf_pb;
   ASSERT_TRUE(
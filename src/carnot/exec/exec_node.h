@@ -18,8 +18,10 @@
 
 #pragma once
 
+#include <algorithm>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "src/carnot/exec/exec_state.h"
@@ -218,6 +220,16 @@ class ExecNode {
       return error::Internal(
           "ConsumeNext received row batch with end of stream set but not end of window.");
     }
+    if (rb.has_selection() && !ConsumesSelection()) {
+      // This node reads the arrays of its input directly, so copy the selected rows for it.
+      PX_ASSIGN_OR_RETURN(auto materialized_rb, rb.Materialize(exec_state->exec_mem_pool()));
+      return ConsumeNext(exec_state, *materialized_rb, parent_index);
+    }
+    if (!ConsumesDictionaryColumns() && rb.HasDictionaryColumns()) {
+      // This node reads string columns as arrow::StringArrays, so decode them for it.
+      PX_ASSIGN_OR_RETURN(auto decoded_rb, rb.DecodeDictionaryColumns(exec_state->exec_mem_pool()));
+      return ConsumeNext(exec_state, *decoded_rb, parent_index);
+    }
     stats_->AddInputStats(rb);
     stats_->ResumeTotalTimer();
     PX_RETURN_IF_ERROR(ConsumeNextImpl(exec_state, rb, parent_index));
@@ -262,6 +274,30 @@ class ExecNode {
     parent_ids_for_children_.emplace_back(parent_index);
   }
 
+  /**
+   * Replaces a child node, keeping the parent index it was added with.
+   * @param old_child the child to replace.
+   * @param new_child the node that receives old_child's row batches instead.
+   */
+  void ReplaceChild(ExecNode* old_child, ExecNode* new_child) {
+    auto it = std::find(children_.begin(), children_.end(), old_child);
+    DCHECK(it != children_.end());
+    *it = new_child;
+  }
+
+  /**
+   * Moves the children of this node, along with their parent indices, below the given node, and
+   * makes the given node the only child of this node.
+   * @param node a node with no children yet.
+   */
+  void InterposeChild(ExecNode* node) {
+    DCHECK(node->children_.empty());
+    node->children_ = std::move(children_);
+    node->parent_ids_for_children_ = std::move(parent_ids_for_children_);
+    children_ = {node};
+    parent_ids_for_children_ = {0};
+  }
+
   /**
    * Get the type of the execution node.
    * @return the ExecNodeType.
@@ -313,6 +349,19 @@ class ExecNode {
   virtual Status ConsumeNextImpl(ExecState*, const table_store::schema::RowBatch&, size_t) {
     return error::Unimplemented("Implement in derived class (if sink or processing)");
   }
+
+  /**
+   * Whether ConsumeNextImpl handles row batches with a selection vector. Row batches with a
+   * selection are materialized before they are passed to nodes that don't.
+   */
+  virtual bool ConsumesSelection() const { return false; }
+
+  /**
+   * Whether ConsumeNextImpl handles dictionary encoded string columns. Their columns are decoded
+   * into plain arrow::StringArrays before row batches are passed to nodes that don't.
+   */
+  virtual bool ConsumesDictionaryColumns() const { return false; }
+
   bool is_closed() { return is_closed_; }
 
   std::unique_ptr<table_store::schema::RowDescriptor> output_descriptor_;
@@ -31,6 +31,9 @@
 #include "src/carnot/carnotpb/carnot.pb.h"
 #include "src/carnot/exec/exec_metrics.h"
 #include "src/carnot/exec/grpc_router.h"
+#include "src/carnot/exec/memory_tracker.h"
+#include "src/carnot/exec/morsel_executor.h"
+#include "src/carnot/exec/result_cache.h"
 #include "src/carnot/udf/model_pool.h"
 #include "src/carnot/udf/registry.h"
 #include "src/common/base/base.h"
@@ -72,7 +75,8 @@ class ExecState {
       const TraceStubGenerator& trace_stub_generator, const sole::uuid& query_id,
       udf::ModelPool* model_pool, GRPCRouter* grpc_router = nullptr,
       std::function<void(grpc::ClientContext*)> add_auth_func = [](grpc::ClientContext*) {},
-      ExecMetrics* exec_metrics = nullptr)
+      ExecMetrics* exec_metrics = nullptr, ResultCache* result_cache = nullptr,
+      std::shared_ptr<MemoryTracker> node_memory_tracker = nullptr)
       : func_registry_(func_registry),
         table_store_(std::move(table_store)),
         stub_generator_(stub_generator),
@@ -82,17 +86,24 @@ class ExecState {
         model_pool_(model_pool),
         grpc_router_(grpc_router),
         add_auth_to_grpc_client_context_func_(add_auth_func),
-        exec_metrics_(exec_metrics) {}
+        exec_metrics_(exec_metrics),
+        result_cache_(result_cache),
+        exec_mem_pool_(new TrackingMemoryPool(std::make_unique<MemoryTracker>(
+            absl::Substitute("Query $0", query_id.str()), FLAGS_carnot_query_memory_limit_bytes,
+            std::move(node_memory_tracker)))) {}
 
   ~ExecState() {
     if (grpc_router_ != nullptr) {
       grpc_router_->DeleteQuery(query_id_);
     }
+    // The pool deletes itself once the arrays the query allocated are freed. Until then they only
+    // count against the query's own limit, not against the Carnot instance.
+    exec_mem_pool_->ReleaseOwner();
   }
-  arrow::MemoryPool* exec_mem_pool() {
-    // TOOD(zasgar): Make this the correct pool.
-    return arrow::default_memory_pool();
-  }
+  arrow::MemoryPool* exec_mem_pool() { return exec_mem_pool_; }
+
+  // Accounts the memory of the query, against --carnot_query_memory_limit_bytes.
+  MemoryTracker* memory_tracker() { return exec_mem_pool_->tracker(); }
 
   udf::Registry* func_registry() { return func_registry_; }
 
@@ -158,13 +169,21 @@ class ExecState {
     return raw;
   }
 
-  udf::ScalarUDFDefinition* GetScalarUDFDefinition(int64_t id) { return id_to_scalar_udf_map_[id]; }
+  // The UDF and UDA lookups don't modify the maps, so that the exec nodes of a query can look up
+  // definitions from several threads at once.
+  udf::ScalarUDFDefinition* GetScalarUDFDefinition(int64_t id) const {
+    auto it = id_to_scalar_udf_map_.find(id);
+    return it == id_to_scalar_udf_map_.end() ? nullptr : it->second;
+  }
 
   std::map<int64_t, udf::ScalarUDFDefinition*> id_to_scalar_udf_map() {
     return id_to_scalar_udf_map_;
   }
 
-  udf::UDADefinition* GetUDADefinition(int64_t id) { return id_to_uda_map_[id]; }
+  udf::UDADefinition* GetUDADefinition(int64_t id) const {
+    auto it = id_to_uda_map_.find(id);
+    return it == id_to_uda_map_.end() ? nullptr : it->second;
+  }
 
   std::unique_ptr<udf::FunctionContext> CreateFunctionContext() {
     auto ctx = std::make_unique<udf::FunctionContext>(metadata_state_, model_pool_);
@@ -193,6 +212,11 @@ class ExecState {
     metadata_state_ = metadata_state;
   }
 
+  // The executor shared by the queries of this Carnot instance to run parallel pipelines on, or
+  // nullptr if queries run on the calling thread only.
+  MorselExecutor* morsel_executor() { return morsel_executor_; }
+  void set_morsel_executor(MorselExecutor* morsel_executor) { morsel_executor_ = morsel_executor; }
+
   GRPCRouter* grpc_router() { return grpc_router_; }
 
   void AddAuthToGRPCClientContext(grpc::ClientContext* ctx) {
@@ -202,6 +226,9 @@ class ExecState {
 
   ExecMetrics* exec_metrics() { return exec_metrics_; }
 
+  // The result cache shared by the queries of this Carnot instance, or nullptr if disabled.
+  ResultCache* result_cache() { return result_cache_; }
+
  private:
   udf::Registry* func_registry_;
   std::shared_ptr<table_store::TableStore> table_store_;
@@ -216,6 +243,9 @@ class ExecState {
   GRPCRouter* grpc_router_ = nullptr;
   std::function<void(grpc::ClientContext*)> add_auth_to_grpc_client_context_func_;
   ExecMetrics* exec_metrics_;
+  ResultCache* result_cache_;
+  MorselExecutor* morsel_executor_ = nullptr;
+  TrackingMemoryPool* exec_mem_pool_;
 
   int64_t current_source_ = 0;
   bool current_source_set_ = false;
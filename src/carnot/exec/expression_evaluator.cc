@@ -28,6 +28,7 @@
 #include <ostream>
 #include <vector>
 
+#include <absl/container/flat_hash_map.h>
 #include <absl/strings/str_join.h>
 #include <absl/strings/substitute.h>
 
@@ -37,6 +38,11 @@
 #include "src/shared/types/types.h"
 #include "src/shared/types/typespb/wrapper/types_pb_wrapper.h"
 
+DEFINE_bool(carnot_fuse_scalar_expressions,
+            gflags::BoolFromEnv("PL_CARNOT_FUSE_SCALAR_EXPRESSIONS", true),
+            "Evaluate nested scalar UDF calls that all have batch kernels in a single pass, "
+            "without materializing the intermediate columns.");
+
 namespace px {
 namespace carnot {
 namespace exec {
@@ -44,7 +50,6 @@ namespace exec {
 // PX_CARNOT_UPDATE_FOR_NEW_TYPES
 using table_store::schema::CopyValueRepeated;
 using table_store::schema::RowBatch;
-using types::ArrowToDataType;
 using types::BaseValueType;
 using types::BoolValueColumnWrapper;
 using types::ColumnWrapper;
@@ -74,14 +79,14 @@ std::unique_ptr<ScalarExpressionEvaluator> ScalarExpressionEvaluator::Create(
 namespace {
 // Evaluate a scalar value to an arrow::Array.
 template <types::DataType T>
-std::shared_ptr<arrow::Array> EvalScalar(
+StatusOr<std::shared_ptr<arrow::Array>> EvalScalar(
     arrow::MemoryPool* mem_pool, const typename px::types::DataTypeTraits<T>::native_type& val,
     size_t count) {
   auto builder = GetArrowBuilder<T>(mem_pool);
-  PX_CHECK_OK(builder->Reserve(count));
-  PX_CHECK_OK(CopyValueRepeated<T>(builder.get(), val, count));
+  PX_RETURN_IF_ERROR(builder->Reserve(count));
+  PX_RETURN_IF_ERROR(CopyValueRepeated<T>(builder.get(), val, count));
   std::shared_ptr<arrow::Array> arr;
-  PX_CHECK_OK(builder->Finish(&arr));
+  PX_RETURN_IF_ERROR(builder->Finish(&arr));
   return arr;
 }
 
@@ -89,8 +94,9 @@ std::shared_ptr<arrow::Array> EvalScalar(
 
 // Evaluate Scalar to arrow.
 // PX_CARNOT_UPDATE_FOR_NEW_TYPES.
-std::shared_ptr<arrow::Array> EvalScalarToArrow(ExecState* exec_state, const plan::ScalarValue& val,
-                                                size_t count) {
+StatusOr<std::shared_ptr<arrow::Array>> EvalScalarToArrow(ExecState* exec_state,
+                                                          const plan::ScalarValue& val,
+                                                          size_t count) {
   auto mem_pool = exec_state->exec_mem_pool();
   switch (val.DataType()) {
     case types::BOOLEAN:
@@ -180,11 +186,24 @@ Status VectorNativeScalarExpressionEvaluator::Open(ExecState* exec_state) {
   for (auto expr : expressions_) {
     PX_RETURN_IF_ERROR(InitFuncsInExpression(exec_state, expr));
   }
+  if (!FLAGS_carnot_fuse_scalar_expressions) {
+    return Status::OK();
+  }
+  for (const auto& expr : expressions_) {
+    auto fused_or_s =
+        FusedScalarExpression::Compile(exec_state, *expr, id_to_udf_map_, function_ctx_);
+    if (!fused_or_s.ok()) {
+      VLOG(1) << absl::Substitute("Not fusing expression $0: $1", expr->DebugString(),
+                                  fused_or_s.msg());
+      continue;
+    }
+    fused_expressions_[expr.get()] = fused_or_s.ConsumeValueOrDie();
+  }
   return Status::OK();
 }
 
 Status VectorNativeScalarExpressionEvaluator::Close(ExecState*) {
-  // Nothing here yet.
+  fused_expressions_.clear();
   return Status();
 }
 
@@ -194,6 +213,11 @@ VectorNativeScalarExpressionEvaluator::EvaluateSingleExpression(
   CHECK(exec_state != nullptr);
   CHECK_GT(input.num_columns(), 0);
 
+  auto fused_it = fused_expressions_.find(&expr);
+  if (fused_it != fused_expressions_.end()) {
+    return fused_it->second->Evaluate(input);
+  }
+
   size_t num_rows = input.num_rows();
 
   // Path for scalar funcs an their dependencies to get evaluated.
@@ -255,7 +279,7 @@ Status VectorNativeScalarExpressionEvaluator::EvaluateSingleExpression(
   // Fast path for just having a constant.
   if (expr.ExpressionType() == plan::Expression::kConstant) {
     auto scalar_expr = static_cast<const plan::ScalarValue&>(expr);
-    auto arr = EvalScalarToArrow(exec_state, scalar_expr, num_rows);
+    PX_ASSIGN_OR_RETURN(auto arr, EvalScalarToArrow(exec_state, scalar_expr, num_rows));
     PX_RETURN_IF_ERROR(output->AddColumn(arr));
     return Status::OK();
   }
@@ -270,7 +294,8 @@ Status VectorNativeScalarExpressionEvaluator::EvaluateSingleExpression(
 
   PX_ASSIGN_OR_RETURN(auto result, VectorNativeScalarExpressionEvaluator::EvaluateSingleExpression(
                                        exec_state, input, expr));
-  PX_RETURN_IF_ERROR(output->AddColumn(result->ConvertToArrow(exec_state->exec_mem_pool())));
+  PX_ASSIGN_OR_RETURN(auto arr, result->TryConvertToArrow(exec_state->exec_mem_pool()));
+  PX_RETURN_IF_ERROR(output->AddColumn(arr));
   return Status::OK();
 }
 
@@ -292,29 +317,47 @@ Status ArrowNativeScalarExpressionEvaluator::Close(ExecState*) {
 Status exec::ArrowNativeScalarExpressionEvaluator::EvaluateSingleExpression(
     exec::ExecState* exec_state, const RowBatch& input, const plan::ScalarExpression& expr,
     RowBatch* output) {
+  using SharedArray = std::shared_ptr<arrow::Array>;
   size_t num_rows = input.num_rows();
-  plan::ExpressionWalker<std::shared_ptr<arrow::Array>> walker;
+  // Evaluating constants allocates from the exec memory pool, which fails once the query is over
+  // its memory limit, so the walk passes the errors up rather than dying on them.
+  plan::ExpressionWalker<StatusOr<SharedArray>> walker;
+  // Constants are evaluated to single value arrays, and only expanded to num_rows values when they
+  // are passed to a UDF without a batch kernel. The arrays are kept alive for the whole walk, so
+  // that their addresses identify them.
+  absl::flat_hash_map<const arrow::Array*, const plan::ScalarValue*> constants;
+  std::vector<SharedArray> constant_arrays;
+  auto expand_constant = [&](const SharedArray& arr) -> StatusOr<SharedArray> {
+    auto it = constants.find(arr.get());
+    if (it == constants.end() || num_rows == 1) {
+      return arr;
+    }
+    return EvalScalarToArrow(exec_state, *it->second, num_rows);
+  };
   walker.OnScalarValue(
-      [&](const plan::ScalarValue& val, const std::vector<std::shared_ptr<arrow::Array>>& children)
-          -> std::shared_ptr<arrow::Array> {
+      [&](const plan::ScalarValue& val,
+          const std::vector<StatusOr<SharedArray>>& children) -> StatusOr<SharedArray> {
         DCHECK_EQ(children.size(), 0ULL);
-        return EvalScalarToArrow(exec_state, val, num_rows);
+        PX_ASSIGN_OR_RETURN(auto arr, EvalScalarToArrow(exec_state, val, 1));
+        constants[arr.get()] = &val;
+        constant_arrays.push_back(arr);
+        return arr;
       });
 
   walker.OnColumn(
-      [&](const plan::Column& col, const std::vector<std::shared_ptr<arrow::Array>>& children)
-          -> std::shared_ptr<arrow::Array> {
+      [&](const plan::Column& col,
+          const std::vector<StatusOr<SharedArray>>& children) -> StatusOr<SharedArray> {
         DCHECK_EQ(children.size(), 0ULL);
         return input.ColumnAt(col.Index());
       });
 
   walker.OnScalarFunc(
-      [&](const plan::ScalarFunc& fn, const std::vector<std::shared_ptr<arrow::Array>>& children)
-          -> std::shared_ptr<arrow::Array> {
-        std::vector<types::DataType> arg_types;
-        arg_types.reserve(children.size());
+      [&](const plan::ScalarFunc& fn,
+          const std::vector<StatusOr<SharedArray>>& children) -> StatusOr<SharedArray> {
         for (const auto& child : children) {
-          arg_types.emplace_back(ArrowToDataType(child->type_id()));
+          if (!child.ok()) {
+            return child;
+          }
         }
 
         auto def = exec_state->GetScalarUDFDefinition(fn.udf_id());
@@ -322,22 +365,32 @@ Status exec::ArrowNativeScalarExpressionEvaluator::EvaluateSingleExpression(
 
         auto output = MakeArrowBuilder(def->exec_return_type(), arrow::default_memory_pool());
 
+        std::vector<SharedArray> expanded_children;
         std::vector<arrow::Array*> raw_children;
         raw_children.reserve(children.size());
         for (const auto& child : children) {
-          raw_children.push_back(child.get());
+          if (def->has_exec_batch()) {
+            raw_children.push_back(child.ValueOrDie().get());
+          } else {
+            PX_ASSIGN_OR_RETURN(auto expanded, expand_constant(child.ValueOrDie()));
+            expanded_children.push_back(std::move(expanded));
+            raw_children.push_back(expanded_children.back().get());
+          }
         }
 
-        PX_CHECK_OK(def->ExecBatchArrow(udf, function_ctx_, raw_children, output.get(), num_rows));
+        PX_RETURN_IF_ERROR(
+            def->ExecBatchArrow(udf, function_ctx_, raw_children, output.get(), num_rows));
 
-        std::shared_ptr<arrow::Array> output_array;
-        PX_CHECK_OK(output->Finish(&output_array));
+        SharedArray output_array;
+        PX_RETURN_IF_ERROR(output->Finish(&output_array));
         return output_array;
       });
 
-  PX_ASSIGN_OR_RETURN(auto result, walker.Walk(expr));
+  PX_ASSIGN_OR_RETURN(auto result_or, walker.Walk(expr));
+  PX_ASSIGN_OR_RETURN(auto result, result_or);
+  PX_ASSIGN_OR_RETURN(auto expanded_result, expand_constant(result));
 
-  PX_RETURN_IF_ERROR(output->AddColumn(result));
+  PX_RETURN_IF_ERROR(output->AddColumn(expanded_result));
   return Status::OK();
 }
 
@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include <absl/container/flat_hash_map.h>
 #include <arrow/array.h>
 #include <cstddef>
 #include <map>
@@ -27,6 +28,7 @@
 #include <vector>
 
 #include "src/carnot/exec/exec_state.h"
+#include "src/carnot/exec/fused_expression.h"
 #include "src/carnot/plan/scalar_expression.h"
 #include "src/carnot/udf/base.h"
 #include "src/carnot/udf/udf.h"
@@ -38,8 +40,9 @@ namespace px {
 namespace carnot {
 namespace exec {
 
-std::shared_ptr<arrow::Array> EvalScalarToArrow(ExecState* exec_state, const plan::ScalarValue& val,
-                                                size_t count);
+StatusOr<std::shared_ptr<arrow::Array>> EvalScalarToArrow(ExecState* exec_state,
+                                                          const plan::ScalarValue& val,
+                                                          size_t count);
 
 std::shared_ptr<types::ColumnWrapper> EvalScalarToColumnWrapper(ExecState*,
                                                                 const plan::ScalarValue& val,
@@ -131,6 +134,10 @@ class ScalarExpressionEvaluator : public ExpressionEvaluator {
 /**
  * A scalar expression evaluator thar uses native C++ vectors for intermediate state.
  * (The input is always assumed to be RowBatches with arrow::Arrays).
+ *
+ * Expressions where every UDF has a batch kernel are compiled into a FusedScalarExpression on
+ * Open, which doesn't materialize the intermediate results. Every other expression is evaluated
+ * one UDF call at a time.
  */
 class VectorNativeScalarExpressionEvaluator : public ScalarExpressionEvaluator {
  public:
@@ -145,10 +152,21 @@ class VectorNativeScalarExpressionEvaluator : public ScalarExpressionEvaluator {
       ExecState* exec_state, const table_store::schema::RowBatch& input,
       const plan::ScalarExpression& expr);
 
+  /**
+   * @return whether the given expression is evaluated as a FusedScalarExpression.
+   */
+  bool IsFused(const plan::ScalarExpression& expr) const {
+    return fused_expressions_.contains(&expr);
+  }
+
  protected:
   Status EvaluateSingleExpression(ExecState* exec_state, const table_store::schema::RowBatch& input,
                                   const plan::ScalarExpression& expr,
                                   table_store::schema::RowBatch* output) override;
+
+ private:
+  absl::flat_hash_map<const plan::ScalarExpression*, std::unique_ptr<FusedScalarExpression>>
+      fused_expressions_;
 };
 
 /**
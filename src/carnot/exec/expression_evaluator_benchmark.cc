@@ -51,10 +51,13 @@ using px::carnot::exec::MockResultSinkStubGenerator;
 using px::carnot::exec::MockTraceStubGenerator;
 using px::carnot::exec::ScalarExpressionEvaluator;
 using px::carnot::exec::ScalarExpressionEvaluatorType;
+using px::carnot::planpb::testutils::kAddScalarFuncConstPbtxt;
 using px::carnot::planpb::testutils::kAddScalarFuncNestedPbtxt;
 using px::carnot::planpb::testutils::kAddScalarFuncPbtxt;
 using px::carnot::planpb::testutils::kColumnReferencePbtxt;
 using px::carnot::planpb::testutils::kScalarInt64ValuePbtxt;
+using px::carnot::udf::BatchArg;
+using px::carnot::udf::BinaryBatchKernel;
 using px::carnot::udf::FunctionContext;
 using px::carnot::udf::Registry;
 using px::carnot::udf::ScalarUDF;
@@ -69,9 +72,19 @@ class AddUDF : public ScalarUDF {
   Int64Value Exec(FunctionContext*, Int64Value v1, Int64Value v2) { return v1.val + v2.val; }
 };
 
+class AddBatchUDF : public ScalarUDF {
+ public:
+  Int64Value Exec(FunctionContext*, Int64Value v1, Int64Value v2) { return v1.val + v2.val; }
+  void ExecBatch(FunctionContext*, size_t count, BatchArg<Int64Value> v1, BatchArg<Int64Value> v2,
+                 int64_t* out) {
+    BinaryBatchKernel(count, v1, v2, out, [](int64_t a, int64_t b) { return a + b; });
+  }
+};
+
 // NOLINTNEXTLINE : runtime/references.
 void BM_ScalarExpressionTwoCols(benchmark::State& state,
-                                const ScalarExpressionEvaluatorType& eval_type, const char* pbtxt) {
+                                const ScalarExpressionEvaluatorType& eval_type, const char* pbtxt,
+                                bool batch_kernel = false) {
   px::carnot::planpb::ScalarExpression se_pb;
   size_t data_size = state.range(0);
 
@@ -82,7 +95,11 @@ void BM_ScalarExpressionTwoCols(benchmark::State& state,
 
   auto func_registry = std::make_unique<Registry>("test_registry");
   auto table_store = std::make_shared<px::table_store::TableStore>();
-  PX_CHECK_OK(func_registry->Register<AddUDF>("add"));
+  if (batch_kernel) {
+    PX_CHECK_OK(func_registry->Register<AddBatchUDF>("add"));
+  } else {
+    PX_CHECK_OK(func_registry->Register<AddUDF>("add"));
+  }
   auto exec_state = std::make_unique<ExecState>(
       func_registry.get(), table_store, MockResultSinkStubGenerator, MockMetricsStubGenerator,
       MockTraceStubGenerator, sole::uuid4(), nullptr);
@@ -149,3 +166,30 @@ BENCHMARK_CAPTURE(BM_ScalarExpressionTwoCols, two_cols_simple_add_vector,
                   ScalarExpressionEvaluatorType::kVectorNative, kAddScalarFuncNestedPbtxt)
     ->RangeMultiplier(2)
     ->Range(1, 1 << 16);
+
+// With batch kernels, the vector native evaluator fuses the nested calls into a single pass.
+BENCHMARK_CAPTURE(BM_ScalarExpressionTwoCols, add_nested_vector_per_row,
+                  ScalarExpressionEvaluatorType::kVectorNative, kAddScalarFuncNestedPbtxt, false)
+    ->RangeMultiplier(16)
+    ->Range(1 << 12, 1 << 20);
+BENCHMARK_CAPTURE(BM_ScalarExpressionTwoCols, add_nested_vector_fused,
+                  ScalarExpressionEvaluatorType::kVectorNative, kAddScalarFuncNestedPbtxt, true)
+    ->RangeMultiplier(16)
+    ->Range(1 << 12, 1 << 20);
+
+BENCHMARK_CAPTURE(BM_ScalarExpressionTwoCols, add_cols_arrow_per_row,
+                  ScalarExpressionEvaluatorType::kArrowNative, kAddScalarFuncPbtxt, false)
+    ->RangeMultiplier(16)
+    ->Range(1 << 12, 1 << 20);
+BENCHMARK_CAPTURE(BM_ScalarExpressionTwoCols, add_cols_arrow_batch_kernel,
+                  ScalarExpressionEvaluatorType::kArrowNative, kAddScalarFuncPbtxt, true)
+    ->RangeMultiplier(16)
+    ->Range(1 << 12, 1 << 20);
+BENCHMARK_CAPTURE(BM_ScalarExpressionTwoCols, add_col_const_arrow_per_row,
+                  ScalarExpressionEvaluatorType::kArrowNative, kAddScalarFuncConstPbtxt, false)
+    ->RangeMultiplier(16)
+    ->Range(1 << 12, 1 << 20);
+BENCHMARK_CAPTURE(BM_ScalarExpressionTwoCols, add_col_const_arrow_batch_kernel,
+                  ScalarExpressionEvaluatorType::kArrowNative, kAddScalarFuncConstPbtxt, true)
+    ->RangeMultiplier(16)
+    ->Range(1 << 12, 1 << 20);
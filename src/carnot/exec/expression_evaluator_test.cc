@@ -270,6 +270,25 @@ TEST_P(ScalarExpressionTest, eval_init_arg_udf) {
   EXPECT_EQ("init_arg, 1234, c", casted->GetString(2));
 }
 
+TEST_P(ScalarExpressionTest, over_memory_limit_returns_error) {
+  auto prev_limit = FLAGS_carnot_query_memory_limit_bytes;
+  FLAGS_carnot_query_memory_limit_bytes = 1;
+  ExecState exec_state(func_registry_.get(), std::make_shared<table_store::TableStore>(),
+                       MockResultSinkStubGenerator, MockMetricsStubGenerator,
+                       MockTraceStubGenerator, sole::uuid4(), nullptr);
+  FLAGS_carnot_query_memory_limit_bytes = prev_limit;
+
+  RowDescriptor rd_output({types::DataType::INT64});
+  RowBatch output_rb(rd_output, input_rb_->num_rows());
+  function_ctx_ = std::make_unique<udf::FunctionContext>(nullptr, nullptr);
+  auto evaluator =
+      ScalarExpressionEvaluator::Create({Int64ConstScalarExpr()}, GetParam(), function_ctx_.get());
+  ASSERT_OK(evaluator->Open(&exec_state));
+  auto s = evaluator->Evaluate(&exec_state, *input_rb_, &output_rb);
+  EXPECT_EQ(s.code(), statuspb::UNKNOWN);
+  EXPECT_THAT(s.msg(), ::testing::HasSubstr("exceeded its memory limit"));
+}
+
 }  // namespace exec
 }  // namespace carnot
 }  // namespace px
@@ -22,6 +22,7 @@
 #include <arrow/array/builder_binary.h>
 #include <arrow/memory_pool.h>
 #include <arrow/status.h>
+#include <optional>
 #include <ostream>
 #include <string>
 #include <utility>
@@ -38,6 +39,13 @@
 #include "src/shared/types/type_utils.h"
 #include "src/shared/types/types.h"
 #include "src/shared/types/typespb/wrapper/types_pb_wrapper.h"
+#include "src/table_store/schema/dictionary_encoding.h"
+
+DEFINE_double(carnot_filter_selection_threshold,
+              gflags::DoubleFromEnv("PL_CARNOT_FILTER_SELECTION_THRESHOLD", 0.1),
+              "Filters pass a selection vector over their input's arrays to the downstream nodes, "
+              "unless fewer than this fraction of the rows pass, in which case the rows that "
+              "pass are copied into new arrays.");
 
 namespace px {
 namespace carnot {
@@ -55,9 +63,46 @@ Status FilterNode::InitImpl(const plan::Operator& plan_node) {
   const auto* filter_plan_node = static_cast<const plan::FilterOperator*>(&plan_node);
   // copy the plan node to local object;
   plan_node_ = std::make_unique<plan::FilterOperator>(*filter_plan_node);
+  calls_funcs_ = plan_node_->expression()->ExpressionType() == plan::Expression::kFunc;
+  plan::ExpressionWalker<int>()
+      .OnColumn([this](const plan::Column& col, const std::vector<int>&) {
+        expression_cols_.push_back(col.Index());
+        return 0;
+      })
+      .Walk(*plan_node_->expression());
+  string_equality_ = GetStringEqualityPredicate(*plan_node_->expression());
   return Status::OK();
 }
 
+std::optional<FilterNode::StringEqualityPredicate> FilterNode::GetStringEqualityPredicate(
+    const plan::ScalarExpression& expr) {
+  if (expr.ExpressionType() != plan::Expression::kFunc) {
+    return std::nullopt;
+  }
+  const auto& func = static_cast<const plan::ScalarFunc&>(expr);
+  if (func.name() != "equal" && func.name() != "notEqual") {
+    return std::nullopt;
+  }
+  const auto& args = func.arg_deps();
+  auto arg_types = func.registry_arg_types();
+  if (args.size() != 2 || arg_types.size() != 2 || arg_types[0] != types::STRING ||
+      arg_types[1] != types::STRING) {
+    return std::nullopt;
+  }
+  for (size_t i = 0; i < 2; ++i) {
+    const auto& col = args[i];
+    const auto& constant = args[1 - i];
+    if (col->ExpressionType() == plan::Expression::kColumn &&
+        constant->ExpressionType() == plan::Expression::kConstant) {
+      const auto* col_expr = static_cast<const plan::Column*>(col.get());
+      const auto* constant_expr = static_cast<const plan::ScalarValue*>(constant.get());
+      return StringEqualityPredicate{col_expr->Index(), constant_expr->StringValue(),
+                                     func.name() == "notEqual"};
+    }
+  }
+  return std::nullopt;
+}
+
 Status FilterNode::PrepareImpl(ExecState* exec_state) {
   function_ctx_ = exec_state->CreateFunctionContext();
   evaluator_ = std::make_unique<VectorNativeScalarExpressionEvaluator>(
@@ -75,99 +120,90 @@ Status FilterNode::CloseImpl(ExecState* exec_state) {
   return Status::OK();
 }
 
-template <types::DataType T>
-Status PredicateCopyValues(const types::BoolValueColumnWrapper& pred, const arrow::Array* input_col,
-                           RowBatch* output_rb) {
-  DCHECK_EQ(pred.Size(), static_cast<size_t>(input_col->length()));
-  size_t num_output_records = output_rb->num_rows();
-  size_t num_input_records = input_col->length();
-  auto output_col_builder_generic = MakeArrowBuilder(T, arrow::default_memory_pool());
-  auto* output_col_builder = static_cast<typename types::DataTypeTraits<T>::arrow_builder_type*>(
-      output_col_builder_generic.get());
-  PX_RETURN_IF_ERROR(output_col_builder->Reserve(num_output_records));
-  for (size_t idx = 0; idx < num_input_records; ++idx) {
-    if (udf::UnWrap(pred[idx])) {
-      output_col_builder->UnsafeAppend(types::GetValueFromArrowArray<T>(input_col, idx));
+Status FilterNode::SelectMatchingRows(ExecState* exec_state, const RowBatch& rb,
+                                      RowBatch::SelectionVector* selection) {
+  // The predicate must only see the selected rows, since the rows that a previous filter dropped
+  // might make it fail (e.g. a modulo by zero). So if it calls functions, the selected rows of the
+  // columns it reads are copied first. Otherwise it is evaluated on all of the rows of the arrays.
+  std::unique_ptr<RowBatch> selected_rb;
+  if (rb.has_selection() && calls_funcs_) {
+    PX_ASSIGN_OR_RETURN(selected_rb,
+                        rb.MaterializeColumns(expression_cols_, exec_state->exec_mem_pool()));
+  }
+  const RowBatch& eval_rb = selected_rb == nullptr ? rb.WithoutSelection() : *selected_rb;
+  // The functions of the predicate read string columns as arrow::StringArrays.
+  std::unique_ptr<RowBatch> decoded_rb;
+  if (eval_rb.HasDictionaryColumns()) {
+    PX_ASSIGN_OR_RETURN(decoded_rb, eval_rb.DecodeDictionaryColumns(
+                                        expression_cols_, exec_state->exec_mem_pool()));
+  }
+  PX_ASSIGN_OR_RETURN(auto pred_col,
+                      evaluator_->EvaluateSingleExpression(
+                          exec_state, decoded_rb == nullptr ? eval_rb : *decoded_rb,
+                          *plan_node_->expression()));
+
+  // Verify that the type of the column is boolean.
+  DCHECK_EQ(pred_col->data_type(), types::BOOLEAN) << "Predicate expression must be a boolean";
+
+  const types::BoolValueColumnWrapper& pred_col_wrapper =
+      *static_cast<types::BoolValueColumnWrapper*>(pred_col.get());
+  DCHECK_EQ(static_cast<size_t>(eval_rb.num_rows()), pred_col_wrapper.Size());
+
+  for (int64_t row_idx = 0; row_idx < rb.num_rows(); ++row_idx) {
+    auto col_row_idx = rb.ColumnRowIdx(row_idx);
+    // The predicate of the copied rows is at their index among the selected rows.
+    if (pred_col_wrapper[selected_rb == nullptr ? col_row_idx : row_idx].val) {
+      selection->push_back(col_row_idx);
     }
   }
-  std::shared_ptr<arrow::Array> output_array;
-  PX_RETURN_IF_ERROR(output_col_builder->Finish(&output_array));
-  PX_RETURN_IF_ERROR(output_rb->AddColumn(output_array));
   return Status::OK();
 }
 
-template <>
-Status PredicateCopyValues<types::STRING>(const types::BoolValueColumnWrapper& pred,
-                                          const arrow::Array* input_col, RowBatch* output_rb) {
-  DCHECK_EQ(pred.Size(), static_cast<size_t>(input_col->length()));
-  size_t num_output_records = output_rb->num_rows();
-  size_t num_input_records = input_col->length();
-  size_t reserved =
-      100;  // This can be an arbritrary number, since we do exponential doubling below.
-  size_t total_size = 0;
-
-  auto output_col_builder_generic = MakeArrowBuilder(types::STRING, arrow::default_memory_pool());
-  auto* output_col_builder = static_cast<types::DataTypeTraits<types::STRING>::arrow_builder_type*>(
-      output_col_builder_generic.get());
-
-  PX_RETURN_IF_ERROR(output_col_builder->Reserve(num_output_records));
-  PX_RETURN_IF_ERROR(output_col_builder->ReserveData(reserved));
-  for (size_t idx = 0; idx < num_input_records; ++idx) {
-    if (udf::UnWrap(pred[idx])) {
-      auto res = types::GetValueFromArrowArray<types::STRING>(input_col, idx);
-      total_size += res.size();
-      while (total_size >= reserved) {
-        reserved *= 2;
-      }
-      PX_RETURN_IF_ERROR(output_col_builder->ReserveData(reserved));
-      output_col_builder->UnsafeAppend(std::move(res));
+void FilterNode::SelectMatchingCodes(const RowBatch& rb, RowBatch::SelectionVector* selection) {
+  const arrow::Array* col = rb.ColumnAt(string_equality_->col_idx).get();
+  // If the dictionary doesn't hold the value, the code is -1 and no row is equal to it.
+  int32_t code = table_store::schema::FindDictionaryCode(col, string_equality_->value);
+  table_store::schema::GetDictionaryCodes(col, &codes_);
+  for (int64_t row_idx = 0; row_idx < rb.num_rows(); ++row_idx) {
+    auto col_row_idx = rb.ColumnRowIdx(row_idx);
+    if ((codes_[col_row_idx] == code) != string_equality_->negate) {
+      selection->push_back(col_row_idx);
     }
   }
-  std::shared_ptr<arrow::Array> output_array;
-  PX_RETURN_IF_ERROR(output_col_builder->Finish(&output_array));
-  PX_RETURN_IF_ERROR(output_rb->AddColumn(output_array));
-  return Status::OK();
 }
 
 Status FilterNode::ConsumeNextImpl(ExecState* exec_state, const RowBatch& rb, size_t) {
   // Current implementation does not merge across row batches, we should
   // consider this for cases where the filter has really low selectivity.
-  PX_ASSIGN_OR_RETURN(auto pred_col, evaluator_->EvaluateSingleExpression(
-                                         exec_state, rb, *plan_node_->expression()));
-
-  // Verify that the type of the column is boolean.
-  DCHECK_EQ(pred_col->data_type(), types::BOOLEAN) << "Predicate expression must be a boolean";
-
-  const types::BoolValueColumnWrapper& pred_col_wrapper =
-      *static_cast<types::BoolValueColumnWrapper*>(pred_col.get());
-  size_t num_pred = pred_col_wrapper.Size();
-
-  DCHECK_EQ(static_cast<size_t>(rb.num_rows()), num_pred);
-
-  // Find out how many of them returned true;
-  size_t num_output_records = 0;
-  for (size_t i = 0; i < num_pred; ++i) {
-    if (pred_col_wrapper[i].val) {
-      ++num_output_records;
-    }
+  auto selection = std::make_shared<RowBatch::SelectionVector>();
+  selection->reserve(rb.num_rows());
+  if (string_equality_.has_value() &&
+      table_store::schema::IsDictionaryArray(rb.ColumnAt(string_equality_->col_idx).get())) {
+    SelectMatchingCodes(rb, selection.get());
+  } else {
+    PX_RETURN_IF_ERROR(SelectMatchingRows(exec_state, rb, selection.get()));
   }
 
-  RowBatch output_rb(*output_descriptor_, num_output_records);
+  // The output shares the arrays of the input, and selects the rows that passed the filter.
+  RowBatch output_rb(*output_descriptor_, rb.num_column_rows());
   DCHECK_EQ(output_descriptor_->size(), plan_node_->selected_cols().size());
-
-  for (const auto& [output_col_idx, input_col_idx] : Enumerate(plan_node_->selected_cols())) {
-    auto input_col = rb.ColumnAt(input_col_idx);
-    auto col_type = output_descriptor_->type(output_col_idx);
-#define TYPE_CASE(_dt_) \
-  PX_RETURN_IF_ERROR(PredicateCopyValues<_dt_>(pred_col_wrapper, input_col.get(), &output_rb));
-    PX_SWITCH_FOREACH_DATATYPE(col_type, TYPE_CASE);
-#undef TYPE_CASE
+  for (int64_t input_col_idx : plan_node_->selected_cols()) {
+    PX_RETURN_IF_ERROR(output_rb.AddColumn(rb.ColumnAt(input_col_idx)));
+  }
+  if (static_cast<int64_t>(selection->size()) < rb.num_column_rows()) {
+    PX_RETURN_IF_ERROR(output_rb.SetSelection(selection));
   }
-
   output_rb.set_eow(rb.eow());
   output_rb.set_eos(rb.eos());
-  PX_RETURN_IF_ERROR(SendRowBatchToChildren(exec_state, output_rb));
-  return Status::OK();
+
+  // When few rows pass the filter, copying them is cheaper than having the downstream nodes
+  // evaluate their expressions on all of the rows of the arrays.
+  if (output_rb.has_selection() &&
+      selection->size() < FLAGS_carnot_filter_selection_threshold * rb.num_column_rows()) {
+    PX_ASSIGN_OR_RETURN(auto materialized_rb, output_rb.Materialize(exec_state->exec_mem_pool()));
+    return SendRowBatchToChildren(exec_state, *materialized_rb);
+  }
+  return SendRowBatchToChildren(exec_state, output_rb);
 }
 
 }  // namespace exec
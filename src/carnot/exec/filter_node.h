@@ -20,6 +20,7 @@
 
 #include <stddef.h>
 #include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -32,6 +33,8 @@
 #include "src/common/base/status.h"
 #include "src/table_store/table_store.h"
 
+DECLARE_double(carnot_filter_selection_threshold);
+
 namespace px {
 namespace carnot {
 namespace exec {
@@ -49,11 +52,42 @@ class FilterNode : public ProcessingNode {
   Status CloseImpl(ExecState* exec_state) override;
   Status ConsumeNextImpl(ExecState* exec_state, const table_store::schema::RowBatch& rb,
                          size_t parent_index) override;
+  bool ConsumesSelection() const override { return true; }
+  bool ConsumesDictionaryColumns() const override { return true; }
 
  private:
+  // A predicate that compares a string column to a constant, e.g. `df.service == 'foo'`.
+  struct StringEqualityPredicate {
+    int64_t col_idx;
+    std::string value;
+    // Whether the predicate is a notEqual.
+    bool negate;
+  };
+
+  // Returns the string (in)equality that the expression computes, if it compares a column to a
+  // string constant using the builtin equal or notEqual functions.
+  static std::optional<StringEqualityPredicate> GetStringEqualityPredicate(
+      const plan::ScalarExpression& expr);
+  // Appends the rows of rb that pass the predicate to selection, by evaluating the expression.
+  Status SelectMatchingRows(ExecState* exec_state, const table_store::schema::RowBatch& rb,
+                            table_store::schema::RowBatch::SelectionVector* selection);
+  // Appends the rows of rb that pass string_equality_ to selection, by comparing the codes of the
+  // dictionary encoded column instead of its strings.
+  void SelectMatchingCodes(const table_store::schema::RowBatch& rb,
+                           table_store::schema::RowBatch::SelectionVector* selection);
+
   std::unique_ptr<VectorNativeScalarExpressionEvaluator> evaluator_;
   std::unique_ptr<plan::FilterOperator> plan_node_;
   std::unique_ptr<udf::FunctionContext> function_ctx_;
+  // Whether the predicate calls a function, rather than just selecting a column or constant.
+  bool calls_funcs_ = false;
+  // The input columns that the predicate reads.
+  std::vector<int64_t> expression_cols_;
+  // Set if the predicate is a string (in)equality, which is evaluated on the codes of the column
+  // when the column is dictionary encoded.
+  std::optional<StringEqualityPredicate> string_equality_;
+  // Scratch space for the codes of the dictionary encoded column.
+  std::vector<int32_t> codes_;
 };
 
 }  // namespace exec
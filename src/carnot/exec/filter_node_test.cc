@@ -18,6 +18,8 @@
 
 #include "src/carnot/exec/filter_node.h"
 
+#include <memory>
+
 #include <sole.hpp>
 
 #include "src/carnot/exec/test_utils.h"
@@ -52,12 +54,21 @@ class StrEqUDF : public udf::ScalarUDF {
   }
 };
 
+class StrNotEqUDF : public udf::ScalarUDF {
+ public:
+  types::BoolValue Exec(FunctionContext*, types::StringValue v1, types::StringValue v2) {
+    return v1 != v2;
+  }
+};
+
 class FilterNodeTest : public ::testing::Test {
  public:
   FilterNodeTest() {
     func_registry_ = std::make_unique<udf::Registry>("test_registry");
     EXPECT_OK(func_registry_->Register<EqUDF>("eq"));
     EXPECT_OK(func_registry_->Register<StrEqUDF>("eq"));
+    EXPECT_OK(func_registry_->Register<StrEqUDF>("equal"));
+    EXPECT_OK(func_registry_->Register<StrNotEqUDF>("notEqual"));
     auto table_store = std::make_shared<table_store::TableStore>();
 
     exec_state_ = std::make_unique<ExecState>(func_registry_.get(), table_store,
@@ -67,6 +78,12 @@ class FilterNodeTest : public ::testing::Test {
         0, "eq", std::vector<types::DataType>({types::DataType::INT64, types::DataType::INT64})));
     EXPECT_OK(exec_state_->AddScalarUDF(
         1, "eq", std::vector<types::DataType>({types::DataType::STRING, types::DataType::STRING})));
+    EXPECT_OK(exec_state_->AddScalarUDF(
+        2, "equal",
+        std::vector<types::DataType>({types::DataType::STRING, types::DataType::STRING})));
+    EXPECT_OK(exec_state_->AddScalarUDF(
+        3, "notEqual",
+        std::vector<types::DataType>({types::DataType::STRING, types::DataType::STRING})));
   }
 
  protected:
@@ -223,6 +240,134 @@ TEST_F(FilterNodeTest, string_pred) {
       .Close();
 }
 
+// Returns a filter on `col0 == "A"` (or `!=`) that calls the builtin string equality function.
+planpb::Operator CreateTestFilterStringEquality(bool negate) {
+  auto op_proto = planpb::testutils::CreateTestFilterTwoColsString();
+  auto* func = op_proto.mutable_filter_op()->mutable_expression()->mutable_func();
+  func->set_name(negate ? "notEqual" : "equal");
+  func->set_id(negate ? 3 : 2);
+  return op_proto;
+}
+
+TEST_F(FilterNodeTest, string_equality_on_dictionary_column) {
+  plan_node_ =
+      plan::FilterOperator::FromProto(CreateTestFilterStringEquality(/*negate*/ false), /*id*/ 1);
+
+  RowDescriptor input_rd({types::DataType::STRING, types::DataType::INT64, types::DataType::INT64});
+  RowDescriptor output_rd(
+      {types::DataType::STRING, types::DataType::INT64, types::DataType::INT64});
+
+  // The last row passes the filter, but isn't selected.
+  auto input_rb = RowBatchBuilder(input_rd, 5, /*eow*/ false, /*eos*/ false)
+                      .AddDictionaryColumn({"A", "B", "A", "D", "A"})
+                      .AddColumn<types::Int64Value>({1, 3, 6, 9, 12})
+                      .AddColumn<types::Int64Value>({2, 4, 7, 10, 13})
+                      .get();
+  ASSERT_OK(input_rb.SetSelection(
+      std::make_shared<RowBatch::SelectionVector>(RowBatch::SelectionVector{0, 1, 2, 3})));
+
+  auto tester = exec::ExecNodeTester<FilterNode, plan::FilterOperator>(
+      *plan_node_, output_rd, {input_rd}, exec_state_.get());
+  tester.ConsumeNext(input_rb, 0)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 2, false, false)
+                          .AddColumn<types::StringValue>({"A", "A"})
+                          .AddColumn<types::Int64Value>({1, 6})
+                          .AddColumn<types::Int64Value>({2, 7})
+                          .get())
+      // The dictionary of this batch doesn't hold "A", so none of its rows pass.
+      .ConsumeNext(RowBatchBuilder(input_rd, 3, true, true)
+                       .AddDictionaryColumn({"C", "B", "C"})
+                       .AddColumn<types::Int64Value>({1, 4, 6})
+                       .AddColumn<types::Int64Value>({2, 5, 7})
+                       .get(),
+                   0)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 0, true, true)
+                          .AddColumn<types::StringValue>({})
+                          .AddColumn<types::Int64Value>({})
+                          .AddColumn<types::Int64Value>({})
+                          .get())
+      .Close();
+}
+
+TEST_F(FilterNodeTest, string_inequality_on_dictionary_column) {
+  plan_node_ =
+      plan::FilterOperator::FromProto(CreateTestFilterStringEquality(/*negate*/ true), /*id*/ 1);
+
+  RowDescriptor input_rd({types::DataType::STRING, types::DataType::INT64, types::DataType::INT64});
+  RowDescriptor output_rd(
+      {types::DataType::STRING, types::DataType::INT64, types::DataType::INT64});
+
+  auto tester = exec::ExecNodeTester<FilterNode, plan::FilterOperator>(
+      *plan_node_, output_rd, {input_rd}, exec_state_.get());
+  tester
+      .ConsumeNext(RowBatchBuilder(input_rd, 4, /*eow*/ true, /*eos*/ true)
+                       .AddDictionaryColumn({"A", "B", "A", "D"})
+                       .AddColumn<types::Int64Value>({1, 3, 6, 9})
+                       .AddColumn<types::Int64Value>({2, 4, 7, 10})
+                       .get(),
+                   0)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 2, true, true)
+                          .AddColumn<types::StringValue>({"B", "D"})
+                          .AddColumn<types::Int64Value>({3, 9})
+                          .AddColumn<types::Int64Value>({4, 10})
+                          .get())
+      .Close();
+}
+
+// Predicates other than the builtin string equality decode the dictionary encoded columns.
+TEST_F(FilterNodeTest, string_pred_on_dictionary_column) {
+  auto op_proto = planpb::testutils::CreateTestFilterTwoColsString();
+  plan_node_ = plan::FilterOperator::FromProto(op_proto, /*id*/ 1);
+
+  RowDescriptor input_rd({types::DataType::STRING, types::DataType::INT64, types::DataType::INT64});
+  RowDescriptor output_rd(
+      {types::DataType::STRING, types::DataType::INT64, types::DataType::INT64});
+
+  auto tester = exec::ExecNodeTester<FilterNode, plan::FilterOperator>(
+      *plan_node_, output_rd, {input_rd}, exec_state_.get());
+  tester
+      .ConsumeNext(RowBatchBuilder(input_rd, 4, /*eow*/ true, /*eos*/ true)
+                       .AddDictionaryColumn({"A", "B", "A", "D"})
+                       .AddColumn<types::Int64Value>({1, 3, 6, 9})
+                       .AddColumn<types::Int64Value>({2, 4, 7, 10})
+                       .get(),
+                   0)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 2, true, true)
+                          .AddColumn<types::StringValue>({"A", "A"})
+                          .AddColumn<types::Int64Value>({1, 6})
+                          .AddColumn<types::Int64Value>({2, 7})
+                          .get())
+      .Close();
+}
+
+TEST_F(FilterNodeTest, input_with_selection) {
+  auto op_proto = planpb::testutils::CreateTestFilterTwoCols();
+  plan_node_ = plan::FilterOperator::FromProto(op_proto, /*id*/ 1);
+
+  RowDescriptor input_rd({types::DataType::INT64, types::DataType::INT64, types::DataType::STRING});
+  RowDescriptor output_rd(
+      {types::DataType::INT64, types::DataType::INT64, types::DataType::STRING});
+
+  // The first row passes the filter, but isn't selected.
+  auto input_rb = RowBatchBuilder(input_rd, 4, /*eow*/ true, /*eos*/ true)
+                      .AddColumn<types::Int64Value>({1, 1, 3, 4})
+                      .AddColumn<types::Int64Value>({1, 3, 6, 9})
+                      .AddColumn<types::StringValue>({"ABC", "DEF", "HELLO", "WORLD"})
+                      .get();
+  ASSERT_OK(input_rb.SetSelection(
+      std::make_shared<RowBatch::SelectionVector>(RowBatch::SelectionVector{1, 2, 3})));
+
+  auto tester = exec::ExecNodeTester<FilterNode, plan::FilterOperator>(
+      *plan_node_, output_rd, {input_rd}, exec_state_.get());
+  tester.ConsumeNext(input_rb, 0)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 1, true, true)
+                          .AddColumn<types::Int64Value>({1})
+                          .AddColumn<types::Int64Value>({3})
+                          .AddColumn<types::StringValue>({"DEF"})
+                          .get())
+      .Close();
+}
+
 TEST_F(FilterNodeTest, child_fail) {
   auto op_proto = planpb::testutils::CreateTestFilterTwoCols();
   plan_node_ = plan::FilterOperator::FromProto(op_proto, /*id*/ 1);
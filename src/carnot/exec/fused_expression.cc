@@ -0,0 +1,212 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/fused_expression.h"
+
+#include <arrow/array.h>
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <absl/strings/substitute.h>
+
+#include "src/shared/types/arrow_adapter.h"
+#include "src/shared/types/type_utils.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+using table_store::schema::RowBatch;
+using types::DataType;
+
+namespace {
+
+// PX_CARNOT_UPDATE_FOR_NEW_TYPES
+template <DataType T>
+void CopyToColumnWrapper(const void* values, int64_t offset, size_t count,
+                         types::ColumnWrapper* out) {
+  using value_type = typename types::DataTypeTraits<T>::value_type;
+  using native_type = typename types::ValueTypeTraits<value_type>::native_type;
+  const auto* src = static_cast<const native_type*>(values);
+  auto* dst = static_cast<types::ColumnWrapperTmpl<value_type>*>(out)->UnsafeRawData() + offset;
+  for (size_t i = 0; i < count; ++i) {
+    dst[i] = src[i];
+  }
+}
+
+void CopyToColumnWrapper(DataType type, const void* values, int64_t offset, size_t count,
+                         types::ColumnWrapper* out) {
+  switch (type) {
+    case DataType::BOOLEAN:
+      return CopyToColumnWrapper<DataType::BOOLEAN>(values, offset, count, out);
+    case DataType::INT64:
+      return CopyToColumnWrapper<DataType::INT64>(values, offset, count, out);
+    case DataType::FLOAT64:
+      return CopyToColumnWrapper<DataType::FLOAT64>(values, offset, count, out);
+    case DataType::TIME64NS:
+      return CopyToColumnWrapper<DataType::TIME64NS>(values, offset, count, out);
+    default:
+      CHECK(0) << "Type has no batch kernels: " << types::ToString(type);
+  }
+}
+
+}  // namespace
+
+StatusOr<std::unique_ptr<FusedScalarExpression>> FusedScalarExpression::Compile(
+    ExecState* exec_state, const plan::ScalarExpression& expr,
+    const std::map<int64_t, std::unique_ptr<udf::ScalarUDF>>& udfs,
+    udf::FunctionContext* function_ctx) {
+  if (expr.ExpressionType() != plan::Expression::kFunc) {
+    return error::Unimplemented("Only scalar functions can be fused");
+  }
+  std::unique_ptr<FusedScalarExpression> fused(new FusedScalarExpression(function_ctx));
+  // The type of the root is ignored, since it isn't the argument of anything.
+  PX_RETURN_IF_ERROR(fused->CompileOperand(exec_state, expr, DataType::DATA_TYPE_UNKNOWN, udfs));
+  return fused;
+}
+
+StatusOr<FusedScalarExpression::Operand> FusedScalarExpression::CompileOperand(
+    ExecState* exec_state, const plan::ScalarExpression& expr, DataType type,
+    const std::map<int64_t, std::unique_ptr<udf::ScalarUDF>>& udfs) {
+  Operand operand;
+  operand.type = type;
+  switch (expr.ExpressionType()) {
+    case plan::Expression::kColumn: {
+      operand.kind = Operand::Kind::kColumn;
+      operand.idx = static_cast<const plan::Column&>(expr).Index();
+      if (type == DataType::BOOLEAN) {
+        operand.unpacked = std::make_unique<bool[]>(kChunkSize);
+      }
+      return operand;
+    }
+    case plan::Expression::kConstant: {
+      const auto& val = static_cast<const plan::ScalarValue&>(expr);
+      if (val.DataType() != type) {
+        return error::Unimplemented("Constant of type $0 can't be fused as an argument of type $1",
+                                    types::ToString(val.DataType()), types::ToString(type));
+      }
+      operand.kind = Operand::Kind::kConstant;
+      // PX_CARNOT_UPDATE_FOR_NEW_TYPES
+      switch (type) {
+        case DataType::BOOLEAN:
+          operand.constant.bool_val = val.BoolValue();
+          break;
+        case DataType::INT64:
+          operand.constant.int64_val = val.Int64Value();
+          break;
+        case DataType::TIME64NS:
+          operand.constant.int64_val = val.Time64NSValue();
+          break;
+        case DataType::FLOAT64:
+          operand.constant.float64_val = val.Float64Value();
+          break;
+        default:
+          return error::Unimplemented("Type $0 has no batch kernels", types::ToString(type));
+      }
+      return operand;
+    }
+    case plan::Expression::kFunc: {
+      const auto& fn = static_cast<const plan::ScalarFunc&>(expr);
+      auto def = exec_state->GetScalarUDFDefinition(fn.udf_id());
+      auto udf_it = udfs.find(fn.udf_id());
+      if (def == nullptr || udf_it == udfs.end()) {
+        return error::NotFound("UDF '$0' not found", fn.name());
+      }
+      if (!def->has_exec_batch()) {
+        return error::Unimplemented("UDF '$0' doesn't have a batch kernel", fn.name());
+      }
+      if (def->exec_arguments().size() != fn.arg_deps().size()) {
+        return error::InvalidArgument("UDF '$0' expects $1 arguments, got $2", fn.name(),
+                                      def->exec_arguments().size(), fn.arg_deps().size());
+      }
+
+      FuncNode node;
+      node.def = def;
+      node.udf = udf_it->second.get();
+      node.return_type = def->exec_return_type();
+      for (const auto& [idx, arg] : Enumerate(fn.arg_deps())) {
+        PX_ASSIGN_OR_RETURN(auto arg_operand,
+                            CompileOperand(exec_state, *arg, def->exec_arguments()[idx], udfs));
+        node.args.push_back(std::move(arg_operand));
+      }
+      node.raw_args.resize(node.args.size());
+      node.out = std::make_unique<uint64_t[]>(kChunkSize);
+      nodes_.push_back(std::move(node));
+
+      operand.kind = Operand::Kind::kFunc;
+      operand.idx = nodes_.size() - 1;
+      return operand;
+    }
+    default:
+      return error::Unimplemented("Expression can't be fused");
+  }
+}
+
+StatusOr<udf::RawBatchArg> FusedScalarExpression::OperandData(Operand* operand,
+                                                              const RowBatch& input,
+                                                              int64_t offset, size_t count) {
+  switch (operand->kind) {
+    case Operand::Kind::kFunc:
+      return udf::RawBatchArg{nodes_[operand->idx].out.get(), false};
+    case Operand::Kind::kConstant:
+      return udf::RawBatchArg{&operand->constant, true};
+    case Operand::Kind::kColumn:
+      break;
+  }
+
+  const auto& arr = input.ColumnAt(operand->idx);
+  if (types::ArrowToDataType(arr->type_id()) != operand->type) {
+    return error::InvalidArgument("Column $0 has type $1, expected $2", operand->idx,
+                                  types::ToString(types::ArrowToDataType(arr->type_id())),
+                                  types::ToString(operand->type));
+  }
+  if (operand->type == DataType::BOOLEAN) {
+    const auto* bool_arr = static_cast<const arrow::BooleanArray*>(arr.get());
+    for (size_t i = 0; i < count; ++i) {
+      operand->unpacked[i] = bool_arr->Value(offset + i);
+    }
+    return udf::RawBatchArg{operand->unpacked.get(), false};
+  }
+  // Every other type with batch kernels has 8 byte values.
+  const auto* values =
+      reinterpret_cast<const uint64_t*>(arr->data()->buffers[1]->data()) + arr->offset();
+  return udf::RawBatchArg{values + offset, false};
+}
+
+StatusOr<types::SharedColumnWrapper> FusedScalarExpression::Evaluate(const RowBatch& input) {
+  int64_t num_rows = input.num_rows();
+  auto output = types::ColumnWrapper::Make(output_type(), num_rows);
+  for (int64_t offset = 0; offset < num_rows; offset += kChunkSize) {
+    size_t count = std::min<int64_t>(kChunkSize, num_rows - offset);
+    for (auto& node : nodes_) {
+      for (size_t i = 0; i < node.args.size(); ++i) {
+        PX_ASSIGN_OR_RETURN(node.raw_args[i], OperandData(&node.args[i], input, offset, count));
+      }
+      PX_RETURN_IF_ERROR(node.def->ExecBatchKernel(node.udf, function_ctx_, node.raw_args,
+                                                   node.out.get(), count));
+    }
+    CopyToColumnWrapper(output_type(), nodes_.back().out.get(), offset, count, output.get());
+  }
+  return output;
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,121 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "src/carnot/exec/exec_state.h"
+#include "src/carnot/plan/scalar_expression.h"
+#include "src/carnot/udf/udf.h"
+#include "src/carnot/udf/udf_definition.h"
+#include "src/common/base/base.h"
+#include "src/shared/types/column_wrapper.h"
+#include "src/shared/types/types.h"
+#include "src/table_store/schema/row_batch.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+/**
+ * FusedScalarExpression evaluates a tree of scalar UDF calls as a single pass over the batch,
+ * instead of materializing a full column for every intermediate UDF call.
+ *
+ * The batch is processed in chunks of kChunkSize rows. For every chunk, the UDF calls are run in
+ * post order with their batch kernels, and each call writes into a chunk sized scratch buffer
+ * that is read by its parent. The scratch buffers are small enough to stay in cache, so the
+ * intermediate results never go to memory, and nothing is allocated per batch except the output.
+ *
+ * Only expressions where every UDF has a batch kernel can be fused, see ScalarUDF::ExecBatch.
+ * Compile returns an error for anything else, and the caller should fall back to evaluating the
+ * expression one UDF call at a time.
+ */
+class FusedScalarExpression : public NotCopyable {
+ public:
+  static constexpr size_t kChunkSize = 1024;
+
+  /**
+   * Compiles an expression into a fused program.
+   * @param exec_state The execution state, which holds the UDF definitions.
+   * @param expr The expression, which must be a scalar function.
+   * @param udfs The initialized UDF instances, by UDF ID. They must outlive the fused expression.
+   * @param function_ctx The function context to run the UDFs with.
+   * @return The fused expression, or an Unimplemented error if the expression can't be fused.
+   */
+  static StatusOr<std::unique_ptr<FusedScalarExpression>> Compile(
+      ExecState* exec_state, const plan::ScalarExpression& expr,
+      const std::map<int64_t, std::unique_ptr<udf::ScalarUDF>>& udfs,
+      udf::FunctionContext* function_ctx);
+
+  /**
+   * Evaluates the expression on all of the rows of the input's arrays.
+   */
+  StatusOr<types::SharedColumnWrapper> Evaluate(const table_store::schema::RowBatch& input);
+
+  types::DataType output_type() const { return nodes_.back().return_type; }
+
+ private:
+  // Native values are at most 8 bytes for every type that has batch kernels.
+  using ScratchBuffer = std::unique_ptr<uint64_t[]>;
+
+  struct Operand {
+    enum class Kind { kColumn, kConstant, kFunc };
+    Kind kind;
+    types::DataType type;
+    // The column index for kColumn, or the node index for kFunc.
+    int64_t idx = -1;
+    // The native value for kConstant.
+    union {
+      bool bool_val;
+      int64_t int64_val;
+      double float64_val;
+    } constant;
+    // Booleans are packed into bits by arrow, so boolean columns are unpacked into this first.
+    std::unique_ptr<bool[]> unpacked;
+  };
+
+  struct FuncNode {
+    udf::ScalarUDFDefinition* def;
+    udf::ScalarUDF* udf;
+    types::DataType return_type;
+    std::vector<Operand> args;
+    std::vector<udf::RawBatchArg> raw_args;
+    ScratchBuffer out;
+  };
+
+  explicit FusedScalarExpression(udf::FunctionContext* function_ctx)
+      : function_ctx_(function_ctx) {}
+
+  StatusOr<Operand> CompileOperand(ExecState* exec_state, const plan::ScalarExpression& expr,
+                                   types::DataType type,
+                                   const std::map<int64_t, std::unique_ptr<udf::ScalarUDF>>& udfs);
+  StatusOr<udf::RawBatchArg> OperandData(Operand* operand,
+                                         const table_store::schema::RowBatch& input,
+                                         int64_t offset, size_t count);
+
+  udf::FunctionContext* function_ctx_;
+  // The UDF calls in post order, so the root of the expression is last.
+  std::vector<FuncNode> nodes_;
+};
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,239 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/fused_expression.h"
+
+#include <arrow/memory_pool.h>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <google/protobuf/text_format.h>
+#include <gtest/gtest.h>
+#include <sole.hpp>
+
+#include "src/carnot/exec/expression_evaluator.h"
+#include "src/carnot/exec/test_utils.h"
+#include "src/carnot/planpb/plan.pb.h"
+#include "src/carnot/udf/registry.h"
+#include "src/common/testing/testing.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/shared/types/types.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+using table_store::schema::RowBatch;
+using table_store::schema::RowDescriptor;
+using types::BoolValue;
+using types::Int64Value;
+using types::ToArrow;
+using udf::BatchArg;
+using udf::BinaryBatchKernel;
+using udf::FunctionContext;
+
+class AddUDF : public udf::ScalarUDF {
+ public:
+  Int64Value Exec(FunctionContext*, Int64Value v1, Int64Value v2) { return v1.val + v2.val; }
+  void ExecBatch(FunctionContext*, size_t count, BatchArg<Int64Value> v1, BatchArg<Int64Value> v2,
+                 int64_t* out) {
+    BinaryBatchKernel(count, v1, v2, out, [](int64_t a, int64_t b) { return a + b; });
+  }
+};
+
+class GreaterThanUDF : public udf::ScalarUDF {
+ public:
+  BoolValue Exec(FunctionContext*, Int64Value v1, Int64Value v2) { return v1.val > v2.val; }
+  void ExecBatch(FunctionContext*, size_t count, BatchArg<Int64Value> v1, BatchArg<Int64Value> v2,
+                 bool* out) {
+    BinaryBatchKernel(count, v1, v2, out, [](int64_t a, int64_t b) { return a > b; });
+  }
+};
+
+class LogicalAndUDF : public udf::ScalarUDF {
+ public:
+  BoolValue Exec(FunctionContext*, BoolValue b1, BoolValue b2) { return b1.val && b2.val; }
+  void ExecBatch(FunctionContext*, size_t count, BatchArg<BoolValue> b1, BatchArg<BoolValue> b2,
+                 bool* out) {
+    BinaryBatchKernel(count, b1, b2, out, [](bool a, bool b) { return a && b; });
+  }
+};
+
+// Doesn't have a batch kernel, so expressions that use it can't be fused.
+class SubtractUDF : public udf::ScalarUDF {
+ public:
+  Int64Value Exec(FunctionContext*, Int64Value v1, Int64Value v2) { return v1.val - v2.val; }
+};
+
+// and(gt(add(col0, col1), 100), col2)
+constexpr char kFusablePbtxt[] = R"(
+func {
+  id: 2
+  name: "and"
+  args {
+    func {
+      id: 1
+      name: "gt"
+      args {
+        func {
+          id: 0
+          name: "add"
+          args { column { node: 0 index: 0 } }
+          args { column { node: 0 index: 1 } }
+          args_data_types: INT64
+          args_data_types: INT64
+        }
+      }
+      args { constant { data_type: INT64 int64_value: 100 } }
+      args_data_types: INT64
+      args_data_types: INT64
+    }
+  }
+  args { column { node: 0 index: 2 } }
+  args_data_types: BOOLEAN
+  args_data_types: BOOLEAN
+})";
+
+// gt(sub(col0, col1), 100)
+constexpr char kNotFusablePbtxt[] = R"(
+func {
+  id: 1
+  name: "gt"
+  args {
+    func {
+      id: 3
+      name: "sub"
+      args { column { node: 0 index: 0 } }
+      args { column { node: 0 index: 1 } }
+      args_data_types: INT64
+      args_data_types: INT64
+    }
+  }
+  args { constant { data_type: INT64 int64_value: 100 } }
+  args_data_types: INT64
+  args_data_types: INT64
+})";
+
+class FusedScalarExpressionTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    func_registry_ = std::make_unique<udf::Registry>("test_registry");
+    ASSERT_OK(func_registry_->Register<AddUDF>("add"));
+    ASSERT_OK(func_registry_->Register<GreaterThanUDF>("gt"));
+    ASSERT_OK(func_registry_->Register<LogicalAndUDF>("and"));
+    ASSERT_OK(func_registry_->Register<SubtractUDF>("sub"));
+    exec_state_ = std::make_unique<ExecState>(
+        func_registry_.get(), std::make_shared<table_store::TableStore>(),
+        MockResultSinkStubGenerator, MockMetricsStubGenerator, MockTraceStubGenerator,
+        sole::uuid4(), nullptr);
+    ASSERT_OK(exec_state_->AddScalarUDF(0, "add", {types::INT64, types::INT64}));
+    ASSERT_OK(exec_state_->AddScalarUDF(1, "gt", {types::INT64, types::INT64}));
+    ASSERT_OK(exec_state_->AddScalarUDF(2, "and", {types::BOOLEAN, types::BOOLEAN}));
+    ASSERT_OK(exec_state_->AddScalarUDF(3, "sub", {types::INT64, types::INT64}));
+
+    // Spans several chunks, and ends with a partial one.
+    for (int64_t i = 0; i < kNumRows; ++i) {
+      in0_.emplace_back(i % 150);
+      in1_.emplace_back(i % 7);
+      in2_.emplace_back(i % 3 != 0);
+    }
+    RowDescriptor rd({types::INT64, types::INT64, types::BOOLEAN});
+    input_rb_ = std::make_unique<RowBatch>(rd, kNumRows);
+    ASSERT_OK(input_rb_->AddColumn(ToArrow(in0_, arrow::default_memory_pool())));
+    ASSERT_OK(input_rb_->AddColumn(ToArrow(in1_, arrow::default_memory_pool())));
+    ASSERT_OK(input_rb_->AddColumn(ToArrow(in2_, arrow::default_memory_pool())));
+  }
+
+  std::shared_ptr<plan::ScalarExpression> ScalarExpressionOf(const std::string& pbtxt) {
+    planpb::ScalarExpression se_pb;
+    EXPECT_TRUE(google::protobuf::TextFormat::MergeFromString(pbtxt, &se_pb));
+    auto s_or_se = plan::ScalarExpression::FromProto(se_pb);
+    EXPECT_OK(s_or_se);
+    return s_or_se.ConsumeValueOrDie();
+  }
+
+  std::map<int64_t, std::unique_ptr<udf::ScalarUDF>> MakeUDFs() {
+    std::map<int64_t, std::unique_ptr<udf::ScalarUDF>> udfs;
+    for (const auto& [id, def] : exec_state_->id_to_scalar_udf_map()) {
+      udfs[id] = def->Make();
+    }
+    return udfs;
+  }
+
+  static constexpr int64_t kNumRows = 2 * FusedScalarExpression::kChunkSize + 17;
+
+  std::vector<Int64Value> in0_;
+  std::vector<Int64Value> in1_;
+  std::vector<BoolValue> in2_;
+  std::unique_ptr<udf::Registry> func_registry_;
+  std::unique_ptr<ExecState> exec_state_;
+  std::unique_ptr<RowBatch> input_rb_;
+  FunctionContext function_ctx_{nullptr, nullptr};
+};
+
+TEST_F(FusedScalarExpressionTest, evaluate) {
+  auto udfs = MakeUDFs();
+  auto expr = ScalarExpressionOf(kFusablePbtxt);
+  ASSERT_OK_AND_ASSIGN(
+      auto fused, FusedScalarExpression::Compile(exec_state_.get(), *expr, udfs, &function_ctx_));
+  EXPECT_EQ(types::BOOLEAN, fused->output_type());
+
+  ASSERT_OK_AND_ASSIGN(auto out, fused->Evaluate(*input_rb_));
+  ASSERT_EQ(types::BOOLEAN, out->data_type());
+  ASSERT_EQ(static_cast<size_t>(kNumRows), out->Size());
+  const auto& out_col = *static_cast<types::BoolValueColumnWrapper*>(out.get());
+  for (int64_t i = 0; i < kNumRows; ++i) {
+    bool expected = (in0_[i].val + in1_[i].val > 100) && in2_[i].val;
+    EXPECT_EQ(expected, out_col[i].val) << "row " << i;
+  }
+}
+
+TEST_F(FusedScalarExpressionTest, no_batch_kernel) {
+  auto udfs = MakeUDFs();
+  auto expr = ScalarExpressionOf(kNotFusablePbtxt);
+  auto fused_or_s = FusedScalarExpression::Compile(exec_state_.get(), *expr, udfs, &function_ctx_);
+  ASSERT_NOT_OK(fused_or_s);
+  EXPECT_EQ(statuspb::UNIMPLEMENTED, fused_or_s.code());
+}
+
+TEST_F(FusedScalarExpressionTest, evaluator_falls_back) {
+  auto fusable = ScalarExpressionOf(kFusablePbtxt);
+  auto not_fusable = ScalarExpressionOf(kNotFusablePbtxt);
+  VectorNativeScalarExpressionEvaluator evaluator({fusable, not_fusable}, &function_ctx_);
+  ASSERT_OK(evaluator.Open(exec_state_.get()));
+  EXPECT_TRUE(evaluator.IsFused(*fusable));
+  EXPECT_FALSE(evaluator.IsFused(*not_fusable));
+
+  ASSERT_OK_AND_ASSIGN(auto fused_out,
+                       evaluator.EvaluateSingleExpression(exec_state_.get(), *input_rb_, *fusable));
+  ASSERT_OK_AND_ASSIGN(auto fallback_out, evaluator.EvaluateSingleExpression(
+                                              exec_state_.get(), *input_rb_, *not_fusable));
+  const auto& fused_col = *static_cast<types::BoolValueColumnWrapper*>(fused_out.get());
+  const auto& fallback_col = *static_cast<types::BoolValueColumnWrapper*>(fallback_out.get());
+  for (int64_t i = 0; i < kNumRows; ++i) {
+    EXPECT_EQ((in0_[i].val + in1_[i].val > 100) && in2_[i].val, fused_col[i].val);
+    EXPECT_EQ(in0_[i].val - in1_[i].val > 100, fallback_col[i].val);
+  }
+  ASSERT_OK(evaluator.Close(exec_state_.get()));
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
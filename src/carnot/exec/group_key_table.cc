@@ -0,0 +1,413 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/group_key_table.h"
+
+#include <arrow/builder.h>
+#include <farmhash.h>
+
+#include <algorithm>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+#include "src/common/base/hash_utils.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/table_store/schema/dictionary_encoding.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+namespace {
+
+// Hash of a row before any key column is combined into it.
+constexpr uint64_t kHashSeed = 0x2c0e5c1a9f3b7d45ULL;
+// The hash table is grown to keep its load factor at or below 1/kMaxLoadFactorInverse.
+constexpr int64_t kMaxLoadFactorInverse = 2;
+// FindOrInsert memoizes the groups of the code tuples of a batch whose key columns are all
+// dictionary encoded, as long as there are at most this many tuples, or one per row.
+constexpr int64_t kMaxMemoizedCodeTuples = 1024;
+
+using table_store::schema::DictionaryValues;
+using table_store::schema::IsDictionaryArray;
+
+template <types::DataType DT>
+void NormalizeFixedColumn(const arrow::Array* arr, int64_t num_rows, uint64_t* words) {
+  for (int64_t row_idx = 0; row_idx < num_rows; ++row_idx) {
+    auto val = types::GetValueFromArrowArray<DT>(arr, row_idx);
+    uint64_t word = 0;
+    static_assert(sizeof(val) <= sizeof(word));
+    // Copy the bits, so that floats are compared bit for bit like RowTuple does.
+    std::memcpy(&word, &val, sizeof(val));
+    words[row_idx] = word;
+  }
+}
+
+void NormalizeUInt128Column(const arrow::Array* arr, int64_t num_rows, uint64_t* high_words,
+                            uint64_t* low_words) {
+  for (int64_t row_idx = 0; row_idx < num_rows; ++row_idx) {
+    types::UInt128Value val(types::GetValueFromArrowArray<types::UINT128>(arr, row_idx));
+    high_words[row_idx] = val.High64();
+    low_words[row_idx] = val.Low64();
+  }
+}
+
+void NormalizeStringColumn(const arrow::Array* arr, int64_t num_rows, uint64_t* words) {
+  for (int64_t row_idx = 0; row_idx < num_rows; ++row_idx) {
+    auto view = types::GetStringViewFromArrowArray(arr, row_idx);
+    words[row_idx] = ::util::Hash64(view.data(), view.size());
+  }
+}
+
+void NormalizeDictionaryColumn(const arrow::Array* arr, int64_t num_rows, uint64_t* words,
+                               std::vector<int32_t>* codes) {
+  table_store::schema::GetDictionaryCodes(arr, codes);
+  // Hash every value of the dictionary once, the same way NormalizeStringColumn does, so that the
+  // groups of encoded and plain rows match.
+  const auto* dictionary = DictionaryValues(arr);
+  std::vector<uint64_t> value_hashes(dictionary->length());
+  for (int64_t code = 0; code < dictionary->length(); ++code) {
+    auto view = types::GetStringViewFromArrowArray(dictionary, code);
+    value_hashes[code] = ::util::Hash64(view.data(), view.size());
+  }
+  for (int64_t row_idx = 0; row_idx < num_rows; ++row_idx) {
+    words[row_idx] = value_hashes[(*codes)[row_idx]];
+  }
+}
+
+// Returns the value of a string key column of the batch.
+std::string_view KeyString(const GroupKeyTable::KeyBatch& batch, size_t col_idx,
+                           int64_t row_idx) {
+  const auto* arr = batch.key_cols[col_idx];
+  if (IsDictionaryArray(arr)) {
+    return types::GetStringViewFromArrowArray(DictionaryValues(arr),
+                                              batch.codes[col_idx][row_idx]);
+  }
+  return types::GetStringViewFromArrowArray(arr, row_idx);
+}
+
+template <types::DataType DT>
+Status AppendFixedWords(const std::vector<uint64_t>& words, arrow::ArrayBuilder* builder) {
+  using ArrowBuilder = typename types::DataTypeTraits<DT>::arrow_builder_type;
+  using NativeType = typename types::DataTypeTraits<DT>::native_type;
+  auto* casted_builder = static_cast<ArrowBuilder*>(builder);
+  PX_RETURN_IF_ERROR(casted_builder->Reserve(words.size()));
+  for (uint64_t word : words) {
+    NativeType val;
+    std::memcpy(&val, &word, sizeof(val));
+    casted_builder->UnsafeAppend(val);
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
+GroupKeyTable::GroupKeyTable(const std::vector<types::DataType>& key_types) {
+  int64_t num_strings = 0;
+  for (auto type : key_types) {
+    layout_.push_back(
+        KeyColumnLayout{type, num_words_, type == types::STRING ? num_strings++ : -1});
+    num_words_ += type == types::UINT128 ? 2 : 1;
+  }
+  group_words_.resize(num_words_);
+  group_strings_.resize(num_strings);
+}
+
+void GroupKeyTable::PrepareBatch(const std::vector<const arrow::Array*>& key_cols,
+                                 int64_t num_rows, KeyBatch* batch) const {
+  DCHECK_EQ(key_cols.size(), layout_.size());
+  batch->key_cols = key_cols;
+  batch->codes.resize(layout_.size());
+  batch->words.resize(num_words_);
+  for (auto& words : batch->words) {
+    words.resize(num_rows);
+  }
+  for (size_t col_idx = 0; col_idx < layout_.size(); ++col_idx) {
+    const auto& layout = layout_[col_idx];
+    const auto* arr = key_cols[col_idx];
+    DCHECK_GE(arr->length(), num_rows);
+    uint64_t* words = batch->words[layout.word_idx].data();
+    batch->codes[col_idx].clear();
+    switch (layout.type) {
+      case types::BOOLEAN:
+        NormalizeFixedColumn<types::BOOLEAN>(arr, num_rows, words);
+        break;
+      case types::INT64:
+        NormalizeFixedColumn<types::INT64>(arr, num_rows, words);
+        break;
+      case types::TIME64NS:
+        NormalizeFixedColumn<types::TIME64NS>(arr, num_rows, words);
+        break;
+      case types::FLOAT64:
+        NormalizeFixedColumn<types::FLOAT64>(arr, num_rows, words);
+        break;
+      case types::UINT128:
+        NormalizeUInt128Column(arr, num_rows, words, batch->words[layout.word_idx + 1].data());
+        break;
+      case types::STRING:
+        if (IsDictionaryArray(arr)) {
+          NormalizeDictionaryColumn(arr, num_rows, words, &batch->codes[col_idx]);
+        } else {
+          NormalizeStringColumn(arr, num_rows, words);
+        }
+        break;
+      default:
+        CHECK(0) << "Unknown Type: " << layout.type;
+    }
+  }
+
+  // Hash column by column, so that the inner loop runs over a contiguous buffer.
+  batch->hashes.assign(num_rows, kHashSeed);
+  uint64_t* hashes = batch->hashes.data();
+  for (const auto& words : batch->words) {
+    for (int64_t row_idx = 0; row_idx < num_rows; ++row_idx) {
+      hashes[row_idx] = ::px::HashCombine(hashes[row_idx], words[row_idx]);
+    }
+  }
+}
+
+void GroupKeyTable::ReserveSlots(int64_t num_groups) {
+  size_t min_slots = std::max<int64_t>(16, num_groups * kMaxLoadFactorInverse);
+  if (slots_.size() >= min_slots) {
+    return;
+  }
+  size_t num_slots = std::max<size_t>(slots_.size(), 16);
+  while (num_slots < min_slots) {
+    num_slots *= 2;
+  }
+  slots_.assign(num_slots, 0);
+  size_t mask = num_slots - 1;
+  for (int64_t group_id = 0; group_id < NumGroups(); ++group_id) {
+    size_t pos = group_hashes_[group_id] & mask;
+    while (slots_[pos] != 0) {
+      pos = (pos + 1) & mask;
+    }
+    slots_[pos] = group_id + 1;
+  }
+}
+
+bool GroupKeyTable::KeyEquals(int64_t group_id, const KeyBatch& batch, int64_t row_idx) const {
+  for (size_t word_idx = 0; word_idx < num_words_; ++word_idx) {
+    if (group_words_[word_idx][group_id] != batch.words[word_idx][row_idx]) {
+      return false;
+    }
+  }
+  // The string hashes matched, so compare the strings themselves.
+  for (size_t col_idx = 0; col_idx < layout_.size(); ++col_idx) {
+    if (layout_[col_idx].string_idx < 0) {
+      continue;
+    }
+    const auto& strings = group_strings_[layout_[col_idx].string_idx];
+    std::string_view group_val(strings.data.data() + strings.offsets[group_id],
+                               strings.offsets[group_id + 1] - strings.offsets[group_id]);
+    if (group_val != KeyString(batch, col_idx, row_idx)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+int64_t GroupKeyTable::InsertGroup(const KeyBatch& batch, int64_t row_idx) {
+  int64_t group_id = NumGroups();
+  group_hashes_.push_back(batch.hashes[row_idx]);
+  for (size_t word_idx = 0; word_idx < num_words_; ++word_idx) {
+    group_words_[word_idx].push_back(batch.words[word_idx][row_idx]);
+  }
+  for (size_t col_idx = 0; col_idx < layout_.size(); ++col_idx) {
+    if (layout_[col_idx].string_idx < 0) {
+      continue;
+    }
+    auto& strings = group_strings_[layout_[col_idx].string_idx];
+    strings.data.append(KeyString(batch, col_idx, row_idx));
+    strings.offsets.push_back(strings.data.size());
+  }
+  return group_id;
+}
+
+int64_t GroupKeyTable::NumCodeTuples(const KeyBatch& batch, int64_t num_rows) const {
+  int64_t max_tuples = std::max(num_rows, kMaxMemoizedCodeTuples);
+  int64_t num_tuples = 1;
+  for (const auto* arr : batch.key_cols) {
+    if (!IsDictionaryArray(arr)) {
+      return 0;
+    }
+    num_tuples *= std::max<int64_t>(DictionaryValues(arr)->length(), 1);
+    if (num_tuples > max_tuples) {
+      return 0;
+    }
+  }
+  return num_tuples;
+}
+
+void GroupKeyTable::FindOrInsert(const std::vector<const arrow::Array*>& key_cols,
+                                 int64_t num_rows, std::vector<int64_t>* group_ids) {
+  DCHECK(group_ids != nullptr);
+  group_ids->resize(num_rows);
+  PrepareBatch(key_cols, num_rows, &batch_);
+  // Make room for the worst case, where every row is a new group, so that the table doesn't have
+  // to be grown while probing.
+  ReserveSlots(NumGroups() + num_rows);
+
+  auto find_or_insert = [&](int64_t row_idx) {
+    size_t pos;
+    int64_t group_id = FindSlot(batch_, row_idx, &pos);
+    if (group_id < 0) {
+      group_id = InsertGroup(batch_, row_idx);
+      slots_[pos] = group_id + 1;
+    }
+    return group_id;
+  };
+
+  int64_t num_code_tuples = NumCodeTuples(batch_, num_rows);
+  if (num_code_tuples == 0) {
+    for (int64_t row_idx = 0; row_idx < num_rows; ++row_idx) {
+      (*group_ids)[row_idx] = find_or_insert(row_idx);
+    }
+    return;
+  }
+  // Rows with the same codes have the same key, so only the first one of them is probed.
+  code_tuple_groups_.assign(num_code_tuples, -1);
+  for (int64_t row_idx = 0; row_idx < num_rows; ++row_idx) {
+    int64_t tuple_idx = 0;
+    for (size_t col_idx = 0; col_idx < key_cols.size(); ++col_idx) {
+      tuple_idx = tuple_idx * DictionaryValues(key_cols[col_idx])->length() +
+                  batch_.codes[col_idx][row_idx];
+    }
+    auto& group_id = code_tuple_groups_[tuple_idx];
+    if (group_id < 0) {
+      group_id = find_or_insert(row_idx);
+    }
+    (*group_ids)[row_idx] = group_id;
+  }
+}
+
+int64_t GroupKeyTable::FindSlot(const KeyBatch& batch, int64_t row_idx, size_t* pos) const {
+  DCHECK(!slots_.empty());
+  uint64_t hash = batch.hashes[row_idx];
+  size_t mask = slots_.size() - 1;
+  *pos = hash & mask;
+  while (true) {
+    int64_t group_id = slots_[*pos] - 1;
+    if (group_id < 0) {
+      return -1;
+    }
+    if (group_hashes_[group_id] == hash && KeyEquals(group_id, batch, row_idx)) {
+      return group_id;
+    }
+    *pos = (*pos + 1) & mask;
+  }
+}
+
+int64_t GroupKeyTable::FindOrInsertRow(const KeyBatch& batch, int64_t row_idx) {
+  ReserveSlots(NumGroups() + 1);
+  size_t pos;
+  int64_t group_id = FindSlot(batch, row_idx, &pos);
+  if (group_id < 0) {
+    group_id = InsertGroup(batch, row_idx);
+    slots_[pos] = group_id + 1;
+  }
+  return group_id;
+}
+
+int64_t GroupKeyTable::Find(const KeyBatch& batch, int64_t row_idx) const {
+  if (slots_.empty()) {
+    return -1;
+  }
+  size_t pos;
+  return FindSlot(batch, row_idx, &pos);
+}
+
+StatusOr<std::shared_ptr<arrow::Array>> GroupKeyTable::KeyColumn(
+    size_t key_idx, arrow::MemoryPool* mem_pool) const {
+  DCHECK_LT(key_idx, layout_.size());
+  const auto& layout = layout_[key_idx];
+  auto builder = types::MakeArrowBuilder(layout.type, mem_pool);
+  switch (layout.type) {
+    case types::BOOLEAN:
+      PX_RETURN_IF_ERROR(
+          AppendFixedWords<types::BOOLEAN>(group_words_[layout.word_idx], builder.get()));
+      break;
+    case types::INT64:
+      PX_RETURN_IF_ERROR(
+          AppendFixedWords<types::INT64>(group_words_[layout.word_idx], builder.get()));
+      break;
+    case types::TIME64NS:
+      PX_RETURN_IF_ERROR(
+          AppendFixedWords<types::TIME64NS>(group_words_[layout.word_idx], builder.get()));
+      break;
+    case types::FLOAT64:
+      PX_RETURN_IF_ERROR(
+          AppendFixedWords<types::FLOAT64>(group_words_[layout.word_idx], builder.get()));
+      break;
+    case types::UINT128: {
+      auto* casted_builder = static_cast<arrow::UInt128Builder*>(builder.get());
+      const auto& high_words = group_words_[layout.word_idx];
+      const auto& low_words = group_words_[layout.word_idx + 1];
+      for (int64_t group_id = 0; group_id < NumGroups(); ++group_id) {
+        PX_RETURN_IF_ERROR(
+            casted_builder->Append(absl::MakeUint128(high_words[group_id], low_words[group_id])));
+      }
+      break;
+    }
+    case types::STRING: {
+      auto* casted_builder = static_cast<arrow::StringBuilder*>(builder.get());
+      const auto& strings = group_strings_[layout.string_idx];
+      PX_RETURN_IF_ERROR(casted_builder->Reserve(NumGroups()));
+      PX_RETURN_IF_ERROR(casted_builder->ReserveData(strings.data.size()));
+      for (int64_t group_id = 0; group_id < NumGroups(); ++group_id) {
+        PX_RETURN_IF_ERROR(
+            casted_builder->Append(strings.data.data() + strings.offsets[group_id],
+                                   strings.offsets[group_id + 1] - strings.offsets[group_id]));
+      }
+      break;
+    }
+    default:
+      return error::InvalidArgument("Unsupported group by type: $0", layout.type);
+  }
+  std::shared_ptr<arrow::Array> arr;
+  PX_RETURN_IF_ERROR(builder->Finish(&arr));
+  return arr;
+}
+
+void GroupKeyTable::Clear() {
+  for (auto& words : group_words_) {
+    words.clear();
+  }
+  for (auto& strings : group_strings_) {
+    strings.data.clear();
+    strings.offsets = {0};
+  }
+  group_hashes_.clear();
+  std::fill(slots_.begin(), slots_.end(), 0);
+}
+
+int64_t GroupKeyTable::NumBytes() const {
+  size_t bytes = (group_hashes_.capacity() + slots_.capacity()) * sizeof(uint64_t);
+  for (const auto& words : group_words_) {
+    bytes += words.capacity() * sizeof(uint64_t);
+  }
+  for (const auto& strings : group_strings_) {
+    bytes += strings.data.capacity() + strings.offsets.capacity() * sizeof(size_t);
+  }
+  return static_cast<int64_t>(bytes);
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,167 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <arrow/array.h>
+#include <arrow/memory_pool.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "src/common/base/base.h"
+#include "src/shared/types/types.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+/**
+ * GroupKeyTable maps the group by keys of rows to dense group IDs, a batch at a time.
+ *
+ * Keys are normalized into fixed width columnar buffers of 64-bit words: one word per key column
+ * (two for UINT128), where a string column contributes the hash of the string. The rows of a batch
+ * are then hashed column by column, and probed against an open addressing table of group IDs.
+ * Strings are only compared byte by byte when the hashes of a row and a group match. This avoids
+ * materializing a heap allocated key per row, like RowTuple does.
+ *
+ * String key columns may be dictionary encoded (see table_store::schema::IsDictionaryArray). Then
+ * every value of the dictionary is hashed once per batch, and the rows are normalized through their
+ * codes. When all of the key columns are dictionary encoded, the rows with the same codes are only
+ * looked up in the hash table once per batch.
+ *
+ * The keys of the groups are stored columnar too, so they can be turned back into arrow arrays
+ * without going through the hash table. Group IDs are assigned in insertion order.
+ */
+class GroupKeyTable : public NotCopyable {
+ public:
+  /**
+   * The key columns of a batch, normalized and hashed. Preparing a batch once allows its rows to be
+   * looked up in several tables that have the same key types.
+   */
+  struct KeyBatch {
+    std::vector<const arrow::Array*> key_cols;
+    // The dictionary codes of the dictionary encoded key columns by row, empty for the others.
+    std::vector<std::vector<int32_t>> codes;
+    // The normalized keys, by word and then by row.
+    std::vector<std::vector<uint64_t>> words;
+    std::vector<uint64_t> hashes;
+  };
+
+  explicit GroupKeyTable(const std::vector<types::DataType>& key_types);
+
+  /**
+   * Finds the group of every row of a batch, inserting a new group for every key that hasn't been
+   * seen before.
+   * @param key_cols the key columns of the batch, in the order of the key types.
+   * @param num_rows the number of rows in the batch.
+   * @param group_ids output, resized to num_rows, holds the group ID of every row.
+   */
+  void FindOrInsert(const std::vector<const arrow::Array*>& key_cols, int64_t num_rows,
+                    std::vector<int64_t>* group_ids);
+
+  /**
+   * Normalizes and hashes the key columns of a batch, without touching the table.
+   */
+  void PrepareBatch(const std::vector<const arrow::Array*>& key_cols, int64_t num_rows,
+                    KeyBatch* batch) const;
+
+  /**
+   * Finds the group of a single row of a prepared batch, inserting a new group if its key hasn't
+   * been seen before.
+   */
+  int64_t FindOrInsertRow(const KeyBatch& batch, int64_t row_idx);
+
+  /**
+   * @return the group of a single row of a prepared batch, or -1 if its key isn't in the table.
+   */
+  int64_t Find(const KeyBatch& batch, int64_t row_idx) const;
+
+  /**
+   * @return the number of groups in the table. Group IDs are in [0, NumGroups()).
+   */
+  int64_t NumGroups() const { return static_cast<int64_t>(group_hashes_.size()); }
+
+  /**
+   * @return the hash of the key of a group.
+   */
+  uint64_t GroupHash(int64_t group_id) const { return group_hashes_[group_id]; }
+
+  /**
+   * Builds an arrow array of the given key column, with one value per group ordered by group ID.
+   */
+  StatusOr<std::shared_ptr<arrow::Array>> KeyColumn(size_t key_idx,
+                                                    arrow::MemoryPool* mem_pool) const;
+
+  /**
+   * Removes all groups.
+   */
+  void Clear();
+
+  /**
+   * @return the number of bytes held by the keys of the groups and the hash table.
+   */
+  int64_t NumBytes() const;
+
+ private:
+  struct KeyColumnLayout {
+    types::DataType type;
+    // Index of the first word of this key column in the normalized key.
+    size_t word_idx;
+    // Index into group_strings_, or -1 if this isn't a string column.
+    int64_t string_idx;
+  };
+
+  // Group keys of string columns are stored back to back in a single buffer.
+  struct StringKeyColumn {
+    std::string data;
+    std::vector<size_t> offsets = {0};
+  };
+
+  void ReserveSlots(int64_t num_groups);
+  // Returns the group of the row, or -1 and the empty slot the row would be inserted at.
+  int64_t FindSlot(const KeyBatch& batch, int64_t row_idx, size_t* pos) const;
+  bool KeyEquals(int64_t group_id, const KeyBatch& batch, int64_t row_idx) const;
+  int64_t InsertGroup(const KeyBatch& batch, int64_t row_idx);
+  // Returns the number of distinct code tuples of the batch if all of its key columns are
+  // dictionary encoded, and there are few enough of them to memoize their groups. Otherwise 0.
+  int64_t NumCodeTuples(const KeyBatch& batch, int64_t num_rows) const;
+
+  std::vector<KeyColumnLayout> layout_;
+  size_t num_words_ = 0;
+
+  // The keys of the groups, by word and then by group ID.
+  std::vector<std::vector<uint64_t>> group_words_;
+  std::vector<StringKeyColumn> group_strings_;
+  std::vector<uint64_t> group_hashes_;
+
+  // Open addressing hash table, with a power of two size. Every slot holds a group ID plus one, or
+  // zero if the slot is empty.
+  std::vector<int64_t> slots_;
+
+  // Scratch space for the batch passed to FindOrInsert.
+  KeyBatch batch_;
+  // Scratch space for FindOrInsert: the group of every code tuple of the batch, or -1 if no row of
+  // the batch has it yet.
+  std::vector<int64_t> code_tuple_groups_;
+};
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,187 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "src/carnot/exec/group_key_table.h"
+#include "src/common/testing/testing.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/table_store/schema/dictionary_encoding.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+using ::testing::ElementsAre;
+
+TEST(GroupKeyTableTest, single_int_key) {
+  GroupKeyTable table({types::INT64});
+  auto keys = types::ToArrow(std::vector<types::Int64Value>{5, 3, 5, 7, 3},
+                             arrow::default_memory_pool());
+  std::vector<int64_t> group_ids;
+  table.FindOrInsert({keys.get()}, keys->length(), &group_ids);
+  EXPECT_THAT(group_ids, ElementsAre(0, 1, 0, 2, 1));
+  EXPECT_EQ(3, table.NumGroups());
+
+  // Groups persist across batches.
+  auto more_keys =
+      types::ToArrow(std::vector<types::Int64Value>{7, 9}, arrow::default_memory_pool());
+  table.FindOrInsert({more_keys.get()}, more_keys->length(), &group_ids);
+  EXPECT_THAT(group_ids, ElementsAre(2, 3));
+
+  ASSERT_OK_AND_ASSIGN(auto key_col, table.KeyColumn(0, arrow::default_memory_pool()));
+  EXPECT_TRUE(key_col->Equals(types::ToArrow(std::vector<types::Int64Value>{5, 3, 7, 9},
+                                             arrow::default_memory_pool())));
+}
+
+TEST(GroupKeyTableTest, multiple_keys_with_strings) {
+  GroupKeyTable table({types::STRING, types::INT64, types::FLOAT64, types::BOOLEAN});
+  auto strings = types::ToArrow(std::vector<types::StringValue>{"abc", "abc", "def", "abc", ""},
+                                arrow::default_memory_pool());
+  auto ints =
+      types::ToArrow(std::vector<types::Int64Value>{1, 2, 1, 1, 1}, arrow::default_memory_pool());
+  auto floats = types::ToArrow(std::vector<types::Float64Value>{0.5, 0.5, 0.5, 0.5, 0.5},
+                               arrow::default_memory_pool());
+  auto bools = types::ToArrow(std::vector<types::BoolValue>{true, true, true, true, false},
+                              arrow::default_memory_pool());
+  std::vector<int64_t> group_ids;
+  table.FindOrInsert({strings.get(), ints.get(), floats.get(), bools.get()}, 5, &group_ids);
+  EXPECT_THAT(group_ids, ElementsAre(0, 1, 2, 0, 3));
+
+  ASSERT_OK_AND_ASSIGN(auto string_col, table.KeyColumn(0, arrow::default_memory_pool()));
+  EXPECT_TRUE(string_col->Equals(types::ToArrow(
+      std::vector<types::StringValue>{"abc", "abc", "def", ""}, arrow::default_memory_pool())));
+  ASSERT_OK_AND_ASSIGN(auto bool_col, table.KeyColumn(3, arrow::default_memory_pool()));
+  EXPECT_TRUE(bool_col->Equals(types::ToArrow(
+      std::vector<types::BoolValue>{true, true, true, false}, arrow::default_memory_pool())));
+}
+
+TEST(GroupKeyTableTest, uint128_and_time_keys) {
+  GroupKeyTable table({types::UINT128, types::TIME64NS});
+  auto upids = types::ToArrow(std::vector<types::UInt128Value>{{1, 2}, {1, 3}, {1, 2}, {2, 2}},
+                              arrow::default_memory_pool());
+  auto times = types::ToArrow(std::vector<types::Time64NSValue>{10, 10, 10, 10},
+                              arrow::default_memory_pool());
+  std::vector<int64_t> group_ids;
+  table.FindOrInsert({upids.get(), times.get()}, 4, &group_ids);
+  EXPECT_THAT(group_ids, ElementsAre(0, 1, 0, 2));
+
+  ASSERT_OK_AND_ASSIGN(auto upid_col, table.KeyColumn(0, arrow::default_memory_pool()));
+  EXPECT_TRUE(upid_col->Equals(types::ToArrow(
+      std::vector<types::UInt128Value>{{1, 2}, {1, 3}, {2, 2}}, arrow::default_memory_pool())));
+  ASSERT_OK_AND_ASSIGN(auto time_col, table.KeyColumn(1, arrow::default_memory_pool()));
+  EXPECT_TRUE(time_col->Equals(types::ToArrow(std::vector<types::Time64NSValue>{10, 10, 10},
+                                              arrow::default_memory_pool())));
+}
+
+TEST(GroupKeyTableTest, grows_and_clears) {
+  constexpr int64_t kNumKeys = 10000;
+  GroupKeyTable table({types::INT64});
+  std::vector<types::Int64Value> values;
+  for (int64_t i = 0; i < kNumKeys; ++i) {
+    values.push_back(i);
+  }
+  auto keys = types::ToArrow(values, arrow::default_memory_pool());
+  std::vector<int64_t> group_ids;
+  // Insert the keys twice, so that the second pass finds every key after the table has grown.
+  for (int pass = 0; pass < 2; ++pass) {
+    table.FindOrInsert({keys.get()}, kNumKeys, &group_ids);
+    ASSERT_EQ(kNumKeys, table.NumGroups());
+    for (int64_t i = 0; i < kNumKeys; ++i) {
+      EXPECT_EQ(i, group_ids[i]);
+    }
+  }
+
+  table.Clear();
+  EXPECT_EQ(0, table.NumGroups());
+  table.FindOrInsert({keys.get()}, 2, &group_ids);
+  EXPECT_THAT(group_ids, ElementsAre(0, 1));
+}
+
+TEST(GroupKeyTableTest, prepared_batch_row_lookups) {
+  GroupKeyTable table({types::STRING});
+  auto keys = types::ToArrow(std::vector<types::StringValue>{"a", "b", "a", "c"},
+                             arrow::default_memory_pool());
+  GroupKeyTable::KeyBatch batch;
+  table.PrepareBatch({keys.get()}, 4, &batch);
+  ASSERT_EQ(4, batch.hashes.size());
+  EXPECT_EQ(batch.hashes[0], batch.hashes[2]);
+
+  EXPECT_EQ(-1, table.Find(batch, 0));
+  EXPECT_EQ(0, table.FindOrInsertRow(batch, 0));
+  EXPECT_EQ(1, table.FindOrInsertRow(batch, 1));
+  EXPECT_EQ(0, table.FindOrInsertRow(batch, 2));
+  EXPECT_EQ(0, table.Find(batch, 2));
+  EXPECT_EQ(-1, table.Find(batch, 3));
+  EXPECT_EQ(2, table.NumGroups());
+  EXPECT_EQ(batch.hashes[1], table.GroupHash(1));
+}
+
+TEST(GroupKeyTableTest, dictionary_encoded_strings) {
+  // Few distinct values, so that the columns get dictionary encoded.
+  const char* kMethods[] = {"GET", "POST", "PUT"};
+  std::vector<types::StringValue> methods;
+  std::vector<types::StringValue> services;
+  for (int i = 0; i < 120; ++i) {
+    methods.push_back(kMethods[i % 3]);
+    services.push_back(i % 2 == 0 ? "frontend" : "backend");
+  }
+  auto plain_methods = types::ToArrow(methods, arrow::default_memory_pool());
+  auto plain_services = types::ToArrow(services, arrow::default_memory_pool());
+  ASSERT_OK_AND_ASSIGN(auto encoded_methods,
+                       table_store::schema::MaybeDictionaryEncodeStringArray(
+                           plain_methods.get(), arrow::default_memory_pool()));
+  ASSERT_OK_AND_ASSIGN(auto encoded_services,
+                       table_store::schema::MaybeDictionaryEncodeStringArray(
+                           plain_services.get(), arrow::default_memory_pool()));
+  ASSERT_NE(nullptr, encoded_methods);
+  ASSERT_NE(nullptr, encoded_services);
+
+  GroupKeyTable plain_table({types::STRING, types::STRING});
+  std::vector<int64_t> plain_group_ids;
+  plain_table.FindOrInsert({plain_methods.get(), plain_services.get()}, 120, &plain_group_ids);
+
+  // All of the key columns are encoded, so the groups are looked up once per code tuple.
+  GroupKeyTable table({types::STRING, types::STRING});
+  std::vector<int64_t> group_ids;
+  table.FindOrInsert({encoded_methods.get(), encoded_services.get()}, 120, &group_ids);
+  EXPECT_EQ(plain_group_ids, group_ids);
+  EXPECT_EQ(6, table.NumGroups());
+  for (size_t key_idx = 0; key_idx < 2; ++key_idx) {
+    ASSERT_OK_AND_ASSIGN(auto key_col, table.KeyColumn(key_idx, arrow::default_memory_pool()));
+    ASSERT_OK_AND_ASSIGN(auto plain_key_col,
+                         plain_table.KeyColumn(key_idx, arrow::default_memory_pool()));
+    EXPECT_TRUE(key_col->Equals(plain_key_col));
+  }
+
+  // Encoded and plain rows with the same values share their groups, also when the rows are a slice
+  // of the encoded column.
+  table.FindOrInsert({plain_methods->Slice(1, 6).get(), encoded_services->Slice(1, 6).get()}, 6,
+                     &group_ids);
+  EXPECT_THAT(group_ids, ElementsAre(1, 2, 3, 4, 5, 0));
+  table.FindOrInsert({encoded_methods->Slice(4, 2).get(), plain_services->Slice(4, 2).get()}, 2,
+                     &group_ids);
+  EXPECT_THAT(group_ids, ElementsAre(4, 5));
+  EXPECT_EQ(6, table.NumGroups());
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -67,6 +67,22 @@ StatusOr<carnotpb::TransferResultChunkRequest> RequestWithMetadata(
   return req;
 }
 
+// Serializes the row batch with the encoding that the plan chose for the destination.
+Status SerializeRowBatch(const plan::GRPCSinkOperator& plan_node, const RowBatch& rb,
+                         table_store::schemapb::RowBatchData* proto) {
+  switch (plan_node.row_batch_encoding()) {
+    case planpb::GRPCSinkOperator::ROW_BATCH_ENCODING_PROTO:
+      return rb.ToProto(proto);
+    case planpb::GRPCSinkOperator::ROW_BATCH_ENCODING_COLUMNAR:
+      return rb.ToEncodedProto(proto, table_store::schemapb::EncodedColumns::NONE);
+    case planpb::GRPCSinkOperator::ROW_BATCH_ENCODING_COLUMNAR_ZLIB:
+      return rb.ToEncodedProto(proto, table_store::schemapb::EncodedColumns::ZLIB);
+    default:
+      return error::InvalidArgument("Unknown row batch encoding $0",
+                                    magic_enum::enum_name(plan_node.row_batch_encoding()));
+  }
+}
+
 Status GRPCSinkNode::OptionallyCheckConnection(ExecState* exec_state) {
   if (sent_eos_ || cancelled_) {
     return Status::OK();
@@ -83,7 +99,8 @@ Status GRPCSinkNode::OptionallyCheckConnection(ExecState* exec_state) {
   PX_ASSIGN_OR_RETURN(auto req, RequestWithMetadata(plan_node_.get(), exec_state));
   PX_ASSIGN_OR_RETURN(auto rb,
                       RowBatch::WithZeroRows(*input_descriptor_, /* eow */ false, /* eos */ false));
-  PX_RETURN_IF_ERROR(rb->ToProto(req.mutable_query_result()->mutable_row_batch()));
+  PX_RETURN_IF_ERROR(
+      SerializeRowBatch(*plan_node_, *rb, req.mutable_query_result()->mutable_row_batch()));
 
   PX_RETURN_IF_ERROR(TryWriteRequest(exec_state, req));
   return Status::OK();
@@ -99,6 +116,13 @@ Status GRPCSinkNode::InitImpl(const plan::Operator& plan_node) {
   input_descriptor_ = std::make_unique<RowDescriptor>(input_descriptors_[0]);
   const auto* sink_plan_node = static_cast<const plan::GRPCSinkOperator*>(&plan_node);
   plan_node_ = std::make_unique<plan::GRPCSinkOperator>(*sink_plan_node);
+  // Result tables are read by services that only understand row batches that are encoded value by
+  // value.
+  if (plan_node_->has_table_name() &&
+      plan_node_->row_batch_encoding() != planpb::GRPCSinkOperator::ROW_BATCH_ENCODING_PROTO) {
+    return error::InvalidArgument("GRPCSink to table $0 must use ROW_BATCH_ENCODING_PROTO",
+                                  plan_node_->table_name());
+  }
   return Status::OK();
 }
 
@@ -135,7 +159,8 @@ Status GRPCSinkNode::StartConnectionWithRetries(ExecState* exec_state, size_t n_
   // initiate_result_stream request.
   PX_ASSIGN_OR_RETURN(auto rb,
                       RowBatch::WithZeroRows(*input_descriptor_, /* eow */ false, /* eos */ false));
-  PX_RETURN_IF_ERROR(rb->ToProto(req.mutable_query_result()->mutable_row_batch()));
+  PX_RETURN_IF_ERROR(
+      SerializeRowBatch(*plan_node_, *rb, req.mutable_query_result()->mutable_row_batch()));
 
   if (!writer_->Write(req)) {
     return StartConnectionWithRetries(exec_state, n_retries - 1);
@@ -226,7 +251,7 @@ static inline bool GetRowSizes(const RowBatch& rb, std::vector<int64_t>* string_
       for (int64_t row_idx = 0; row_idx < rb.num_rows(); ++row_idx) {
         (*string_col_row_sizes)[row_idx] +=
             sizeof(char) * std::static_pointer_cast<arrow::StringArray>(rb.ColumnAt(col_idx))
-                               ->value_length(row_idx);
+                               ->value_length(rb.ColumnRowIdx(row_idx));
       }
     }
   }
@@ -312,7 +337,8 @@ Status GRPCSinkNode::ConsumeNextImpl(ExecState* exec_state, const RowBatch& rb,
 Status GRPCSinkNode::ConsumeNextImplNoSplit(ExecState* exec_state, const RowBatch& rb, size_t) {
   PX_ASSIGN_OR_RETURN(auto req, RequestWithMetadata(plan_node_.get(), exec_state));
   // Serialize the RowBatch.
-  PX_RETURN_IF_ERROR(rb.ToProto(req.mutable_query_result()->mutable_row_batch()));
+  PX_RETURN_IF_ERROR(
+      SerializeRowBatch(*plan_node_, rb, req.mutable_query_result()->mutable_row_batch()));
 
   PX_RETURN_IF_ERROR(TryWriteRequest(exec_state, req));
 
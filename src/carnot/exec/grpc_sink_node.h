@@ -76,6 +76,8 @@ class GRPCSinkNode : public SinkNode {
   Status CloseImpl(ExecState* exec_state) override;
   Status ConsumeNextImpl(ExecState* exec_state, const table_store::schema::RowBatch& rb,
                          size_t parent_index) override;
+  // Row batches are serialized one selected row at a time, so they are never materialized.
+  bool ConsumesSelection() const override { return true; }
   Status ConsumeNextImplNoSplit(ExecState* exec_state, const table_store::schema::RowBatch& rb,
                                 size_t parent_index);
   Status SplitAndSendBatch(ExecState* exec_state, const table_store::schema::RowBatch& rb,
@@ -16,9 +16,11 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <algorithm>
 #include <utility>
 #include <vector>
 
+#include <absl/strings/str_cat.h>
 #include <benchmark/benchmark.h>
 #include <grpcpp/test/mock_stream.h>
 #include <gtest/gtest.h>
@@ -47,6 +49,7 @@ using px::table_store::schema::RowDescriptor;
 using px::types::DataType;
 using ::testing::_;
 using ::testing::DoAll;
+using ::testing::Invoke;
 using ::testing::Return;
 using ::testing::SetArgPointee;
 // NOLINTNEXTLINE : runtime/references.
@@ -104,3 +107,92 @@ void BM_GRPCSinkNodeSplitting(benchmark::State& state) {
 }
 
 BENCHMARK(BM_GRPCSinkNodeSplitting)->Unit(benchmark::kMillisecond);
+
+// Sends row batches from a GRPCSink to a GRPCSource (serializing the requests to the wire format
+// and back), with the row batch encoding given by the argument. Reports the bytes sent over the
+// wire per row, while the time per row is the CPU cost of encoding and decoding.
+// NOLINTNEXTLINE : runtime/references.
+void BM_GRPCSinkNodeRowBatchEncoding(benchmark::State& state) {
+  auto func_registry = std::make_unique<px::carnot::udf::Registry>("test_registry");
+  auto table_store = std::make_shared<px::table_store::TableStore>();
+
+  auto mock_unique = std::make_unique<::testing::NiceMock<MockResultSinkServiceStub>>();
+  auto mock = mock_unique.get();
+
+  auto exec_state = std::make_unique<px::carnot::exec::ExecState>(
+      func_registry.get(), table_store,
+      [&](const std::string&, const std::string&)
+          -> std::unique_ptr<ResultSinkService::StubInterface> { return std::move(mock_unique); },
+      MockMetricsStubGenerator, MockTraceStubGenerator, sole::uuid4(), nullptr, nullptr,
+      [&](grpc::ClientContext*) {});
+  TransferResultChunkResponse resp;
+  resp.set_success(true);
+
+  int64_t wire_bytes = 0;
+  int64_t received_rows = 0;
+  auto writer =
+      new ::testing::NiceMock<grpc::testing::MockClientWriter<TransferResultChunkRequest>>();
+  ON_CALL(*writer, Write(_, _))
+      .WillByDefault(Invoke([&](const TransferResultChunkRequest& req, grpc::WriteOptions) {
+        std::string wire = req.SerializeAsString();
+        wire_bytes += wire.size();
+        TransferResultChunkRequest received_req;
+        CHECK(received_req.ParseFromString(wire));
+        auto rb = RowBatch::FromProto(
+                      std::move(*received_req.mutable_query_result()->mutable_row_batch()))
+                      .ConsumeValueOrDie();
+        received_rows += rb->num_rows();
+        return true;
+      }));
+  ON_CALL(*writer, WritesDone()).WillByDefault(Return(true));
+  ON_CALL(*writer, Finish()).WillByDefault(Return(grpc::Status::OK));
+  ON_CALL(*mock, TransferResultChunkRaw(_, _))
+      .WillByDefault(DoAll(SetArgPointee<1>(resp), Return(writer)));
+
+  px::carnot::exec::GRPCSinkNode node;
+  auto op_proto = px::carnot::planpb::testutils::CreateTestGRPCSink1PB();
+  op_proto.mutable_grpc_sink_op()->set_row_batch_encoding(
+      static_cast<px::carnot::planpb::GRPCSinkOperator::RowBatchEncoding>(state.range(0)));
+  auto plan_node = std::make_unique<px::carnot::plan::GRPCSinkOperator>(1);
+  PX_CHECK_OK(plan_node->Init(op_proto.grpc_sink_op()));
+
+  int64_t num_rows = 4096;
+  RowDescriptor rd({DataType::TIME64NS, DataType::INT64, DataType::FLOAT64, DataType::STRING});
+  PX_CHECK_OK(node.Init(*plan_node, rd, {rd}));
+  PX_CHECK_OK(node.Prepare(exec_state.get()));
+  PX_CHECK_OK(node.Open(exec_state.get()));
+
+  // Data that looks like a typical table, with increasing timestamps, low cardinality integers and
+  // repetitive strings.
+  std::vector<px::types::Time64NSValue> times;
+  std::vector<px::types::Int64Value> codes;
+  std::vector<px::types::Float64Value> latencies;
+  std::vector<px::types::StringValue> paths;
+  for (int64_t i = 0; i < num_rows; ++i) {
+    times.emplace_back(1000000 + i * 1000);
+    codes.emplace_back(i % 7 == 0 ? 500 : 200);
+    latencies.emplace_back(0.5 * (i % 100));
+    paths.emplace_back(absl::StrCat("/api/v1/services/", i % 16, "/endpoints"));
+  }
+  auto rb = px::carnot::exec::RowBatchBuilder(rd, num_rows, /*eow*/ false, /*eos*/ false)
+                .AddColumn<px::types::Time64NSValue>(times)
+                .AddColumn<px::types::Int64Value>(codes)
+                .AddColumn<px::types::Float64Value>(latencies)
+                .AddColumn<px::types::StringValue>(paths)
+                .get();
+
+  wire_bytes = 0;
+  received_rows = 0;
+  for (auto _ : state) {
+    PX_CHECK_OK(node.ConsumeNext(exec_state.get(), rb, 0));
+  }
+  state.SetItemsProcessed(state.iterations() * num_rows);
+  state.counters["wire_bytes_per_row"] =
+      static_cast<double>(wire_bytes) / std::max<int64_t>(received_rows, 1);
+}
+
+BENCHMARK(BM_GRPCSinkNodeRowBatchEncoding)
+    ->Arg(px::carnot::planpb::GRPCSinkOperator::ROW_BATCH_ENCODING_PROTO)
+    ->Arg(px::carnot::planpb::GRPCSinkOperator::ROW_BATCH_ENCODING_COLUMNAR)
+    ->Arg(px::carnot::planpb::GRPCSinkOperator::ROW_BATCH_ENCODING_COLUMNAR_ZLIB)
+    ->Unit(benchmark::kMicrosecond);
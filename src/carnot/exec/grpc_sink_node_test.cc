@@ -217,6 +217,61 @@ TEST_F(GRPCSinkNodeTest, internal_result) {
   EXPECT_FALSE(add_metadata_called_);
 }
 
+TEST_F(GRPCSinkNodeTest, internal_result_columnar) {
+  auto op_proto = planpb::testutils::CreateTestGRPCSink1PB();
+  op_proto.mutable_grpc_sink_op()->set_row_batch_encoding(
+      planpb::GRPCSinkOperator::ROW_BATCH_ENCODING_COLUMNAR_ZLIB);
+  auto plan_node = std::make_unique<plan::GRPCSinkOperator>(1);
+  ASSERT_OK(plan_node->Init(op_proto.grpc_sink_op()));
+  RowDescriptor input_rd({types::DataType::INT64, types::DataType::STRING});
+  RowDescriptor output_rd({types::DataType::INT64, types::DataType::STRING});
+
+  TransferResultChunkResponse resp;
+  resp.set_success(true);
+
+  std::vector<TransferResultChunkRequest> actual_protos(2);
+  auto writer = new grpc::testing::MockClientWriter<TransferResultChunkRequest>();
+  EXPECT_CALL(*writer, Write(_, _))
+      .Times(2)
+      .WillOnce(DoAll(SaveArg<0>(&actual_protos[0]), Return(true)))
+      .WillOnce(DoAll(SaveArg<0>(&actual_protos[1]), Return(true)));
+  EXPECT_CALL(*writer, WritesDone());
+  EXPECT_CALL(*writer, Finish()).WillOnce(Return(grpc::Status::OK));
+  EXPECT_CALL(*mock_, TransferResultChunkRaw(_, _))
+      .WillOnce(DoAll(SetArgPointee<1>(resp), Return(writer)));
+
+  auto tester = exec::ExecNodeTester<GRPCSinkNode, plan::GRPCSinkOperator>(
+      *plan_node, output_rd, {input_rd}, exec_state_.get());
+  auto rb = RowBatchBuilder(output_rd, 3, /*eow*/ true, /*eos*/ true)
+                .AddColumn<types::Int64Value>({1, 2, 3})
+                .AddColumn<types::StringValue>({"abc", "", "de"})
+                .get();
+  tester.ConsumeNext(rb, 5, 0);
+  tester.Close();
+
+  for (const auto& req : actual_protos) {
+    EXPECT_EQ(0, req.query_result().row_batch().cols_size());
+    EXPECT_EQ(table_store::schemapb::EncodedColumns::ZLIB,
+              req.query_result().row_batch().encoded_cols().compression());
+  }
+  ASSERT_OK_AND_ASSIGN(auto received_rb,
+                       RowBatch::FromProto(actual_protos[1].query_result().row_batch()));
+  EXPECT_EQ(rb.DebugString(), received_rb->DebugString());
+}
+
+TEST_F(GRPCSinkNodeTest, result_table_requires_proto_encoding) {
+  auto op_proto = planpb::testutils::CreateTestGRPCSink2PB();
+  op_proto.mutable_grpc_sink_op()->set_row_batch_encoding(
+      planpb::GRPCSinkOperator::ROW_BATCH_ENCODING_COLUMNAR);
+  auto plan_node = std::make_unique<plan::GRPCSinkOperator>(1);
+  ASSERT_OK(plan_node->Init(op_proto.grpc_sink_op()));
+  RowDescriptor input_rd({types::DataType::INT64});
+  RowDescriptor output_rd({types::DataType::INT64});
+
+  GRPCSinkNode node;
+  EXPECT_NOT_OK(node.Init(*plan_node, output_rd, {input_rd}));
+}
+
 constexpr char kExpectedExternal0RowResult[] = R"proto(
 address: "localhost:1234"
 query_id {
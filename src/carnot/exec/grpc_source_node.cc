@@ -78,7 +78,9 @@ Status GRPCSourceNode::PopRowBatch() {
         "message.");
   }
 
-  PX_ASSIGN_OR_RETURN(rb_, RowBatch::FromProto(rb_request->query_result().row_batch()));
+  // The request isn't used after this, so the row batch can take its buffers.
+  auto* row_batch_proto = rb_request->mutable_query_result()->mutable_row_batch();
+  PX_ASSIGN_OR_RETURN(rb_, RowBatch::FromProto(std::move(*row_batch_proto)));
   return Status::OK();
 }
 
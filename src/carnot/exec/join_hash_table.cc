@@ -0,0 +1,583 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/join_hash_table.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include <absl/strings/substitute.h>
+#include <sole.hpp>
+
+#include "src/shared/types/arrow_adapter.h"
+#include "src/shared/types/type_utils.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+namespace {
+
+// The build side is split into 2^kPartitionBits partitions. The fan-out is fixed, so that the
+// partition of a key doesn't depend on how many build rows there are.
+constexpr int kPartitionBits = 6;
+constexpr size_t kNumPartitions = 1 << kPartitionBits;
+// False positive rate of the bloom filter over the build keys.
+constexpr double kBloomFilterErrorRate = 0.01;
+// Deferred probe rows are buffered per partition, and appended to disk once the buffer is full.
+constexpr size_t kDeferredProbeBufferBytes = 256 * 1024;
+// Number of deferred probe rows that are read back into a single batch.
+constexpr int64_t kDeferredProbeBatchRows = 1024;
+
+std::string_view HashView(const uint64_t& hash) {
+  return std::string_view(reinterpret_cast<const char*>(&hash), sizeof(hash));
+}
+
+template <types::DataType DT>
+int64_t AppendArrowValue(const arrow::Array* arr, int64_t row_idx, types::ColumnWrapper* col) {
+  auto val = types::GetValueFromArrowArray<DT>(arr, row_idx);
+  // Every value takes up space, even an empty string, so a partition with rows is never empty.
+  int64_t bytes;
+  if constexpr (DT == types::STRING) {
+    bytes = sizeof(types::StringValue) + val.size();
+  } else {
+    bytes = sizeof(val);
+  }
+  static_cast<typename types::ColumnWrapperType<DT>::type*>(col)->Append(std::move(val));
+  return bytes;
+}
+
+// Spill files are a sequence of records, one per key that had rows in memory when the partition
+// was spilled: the key ID and number of rows, followed by the values of every column. Strings are
+// prefixed by their length.
+template <typename T>
+void AppendRaw(const T& val, std::string* out) {
+  out->append(reinterpret_cast<const char*>(&val), sizeof(val));
+}
+
+template <types::DataType DT>
+void SerializeColumn(const types::ColumnWrapper& col, std::string* out) {
+  using ValueType = typename types::DataTypeTraits<DT>::value_type;
+  for (size_t row_idx = 0; row_idx < col.Size(); ++row_idx) {
+    if constexpr (DT == types::STRING) {
+      auto view = col.GetView(row_idx);
+      AppendRaw<int64_t>(view.size(), out);
+      out->append(view);
+    } else {
+      AppendRaw(col.Get<ValueType>(row_idx).val, out);
+    }
+  }
+}
+
+class SpillReader {
+ public:
+  explicit SpillReader(std::string_view data) : data_(data) {}
+
+  bool Done() const { return pos_ == data_.size(); }
+
+  template <typename T>
+  Status Read(T* val) {
+    std::string_view bytes;
+    PX_RETURN_IF_ERROR(ReadBytes(sizeof(T), &bytes));
+    std::memcpy(val, bytes.data(), sizeof(T));
+    return Status::OK();
+  }
+
+  Status ReadBytes(int64_t size, std::string_view* bytes) {
+    if (size < 0 || static_cast<size_t>(size) > data_.size() - pos_) {
+      return error::Internal("Join spill file is truncated.");
+    }
+    *bytes = data_.substr(pos_, size);
+    pos_ += size;
+    return Status::OK();
+  }
+
+ private:
+  std::string_view data_;
+  size_t pos_ = 0;
+};
+
+template <types::DataType DT>
+Status DeserializeColumn(int64_t num_rows, SpillReader* reader, types::ColumnWrapper* col) {
+  using ValueType = typename types::DataTypeTraits<DT>::value_type;
+  for (int64_t row_idx = 0; row_idx < num_rows; ++row_idx) {
+    if constexpr (DT == types::STRING) {
+      int64_t size;
+      PX_RETURN_IF_ERROR(reader->Read(&size));
+      std::string_view bytes;
+      PX_RETURN_IF_ERROR(reader->ReadBytes(size, &bytes));
+      col->Append<ValueType>(ValueType(bytes.data(), bytes.size()));
+    } else {
+      ValueType val;
+      PX_RETURN_IF_ERROR(reader->Read(&val.val));
+      col->Append<ValueType>(val);
+    }
+  }
+  return Status::OK();
+}
+
+// Deferred probe rows are stored like build rows, except that every record is a single row: the key
+// ID, followed by the value of every probe column.
+template <types::DataType DT>
+void SerializeArrowValue(const arrow::Array* arr, int64_t row_idx, std::string* out) {
+  if constexpr (DT == types::STRING) {
+    auto view = types::GetStringViewFromArrowArray(arr, row_idx);
+    AppendRaw<int64_t>(view.size(), out);
+    out->append(view);
+  } else {
+    typename types::DataTypeTraits<DT>::native_type val =
+        types::GetValueFromArrowArray<DT>(arr, row_idx);
+    AppendRaw(val, out);
+  }
+}
+
+template <types::DataType DT>
+Status DeserializeArrowValue(SpillReader* reader, arrow::ArrayBuilder* builder) {
+  if constexpr (DT == types::STRING) {
+    int64_t size;
+    PX_RETURN_IF_ERROR(reader->Read(&size));
+    std::string_view bytes;
+    PX_RETURN_IF_ERROR(reader->ReadBytes(size, &bytes));
+    return table_store::schema::CopyValue<DT>(builder, std::string(bytes));
+  } else {
+    typename types::DataTypeTraits<DT>::native_type val;
+    PX_RETURN_IF_ERROR(reader->Read(&val));
+    return table_store::schema::CopyValue<DT>(builder, val);
+  }
+}
+
+Status AppendToFile(const std::filesystem::path& path, std::string_view data) {
+  int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0600);
+  if (fd < 0) {
+    return error::Internal("Failed to open join spill file $0. errno $1.", path.string(), errno);
+  }
+  while (!data.empty()) {
+    auto written = write(fd, data.data(), data.size());
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      int write_errno = errno;
+      close(fd);
+      return error::Internal("Failed to write join spill file $0. errno $1.", path.string(),
+                             write_errno);
+    }
+    data.remove_prefix(written);
+  }
+  if (close(fd) != 0) {
+    return error::Internal("Failed to close join spill file $0. errno $1.", path.string(), errno);
+  }
+  return Status::OK();
+}
+
+StatusOr<std::string> ReadFile(const std::filesystem::path& path) {
+  int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return error::Internal("Failed to open join spill file $0. errno $1.", path.string(), errno);
+  }
+  std::string data;
+  char buf[64 * 1024];
+  while (true) {
+    auto num_read = read(fd, buf, sizeof(buf));
+    if (num_read < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      int read_errno = errno;
+      close(fd);
+      return error::Internal("Failed to read join spill file $0. errno $1.", path.string(),
+                             read_errno);
+    }
+    if (num_read == 0) {
+      break;
+    }
+    data.append(buf, num_read);
+  }
+  close(fd);
+  return data;
+}
+
+}  // namespace
+
+JoinHashTable::JoinHashTable(const std::vector<types::DataType>& key_types,
+                             const std::vector<types::DataType>& build_col_types,
+                             int64_t memory_budget_bytes, const std::filesystem::path& spill_dir)
+    : build_col_types_(build_col_types),
+      memory_budget_bytes_(memory_budget_bytes),
+      spill_dir_(spill_dir),
+      spill_prefix_(absl::Substitute("join_$0", sole::uuid4().str())),
+      partitions_(kNumPartitions),
+      partition_rows_(kNumPartitions) {
+  for (auto& partition : partitions_) {
+    partition.keys = std::make_unique<GroupKeyTable>(key_types);
+  }
+}
+
+JoinHashTable::~JoinHashTable() {
+  for (const auto& partition : partitions_) {
+    for (const auto& path : {partition.spill_path, partition.probe_spill_path}) {
+      if (path.empty()) {
+        continue;
+      }
+      std::error_code ec;
+      std::filesystem::remove(path, ec);
+      LOG_IF(WARNING, ec) << absl::Substitute("Failed to remove join spill file $0: $1",
+                                              path.string(), ec.message());
+    }
+  }
+}
+
+size_t JoinHashTable::PartitionOf(uint64_t hash) { return hash >> (64 - kPartitionBits); }
+
+int64_t JoinHashTable::num_spilled_partitions() const {
+  return std::count_if(partitions_.begin(), partitions_.end(),
+                       [](const Partition& partition) { return !partition.spill_path.empty(); });
+}
+
+std::shared_ptr<JoinBuildRows> JoinHashTable::NewBuildRows() const {
+  auto rows = std::make_shared<JoinBuildRows>();
+  for (auto type : build_col_types_) {
+    rows->columns.push_back(types::ColumnWrapper::Make(type, 0));
+  }
+  return rows;
+}
+
+Status JoinHashTable::AppendBuildRow(const std::vector<const arrow::Array*>& build_cols,
+                                     int64_t row_idx, JoinBuildRows* rows,
+                                     int64_t* row_bytes) const {
+  for (size_t col_idx = 0; col_idx < build_col_types_.size(); ++col_idx) {
+#define TYPE_CASE(_dt_) \
+  *row_bytes += AppendArrowValue<_dt_>(build_cols[col_idx], row_idx, rows->columns[col_idx].get());
+    PX_SWITCH_FOREACH_DATATYPE(build_col_types_[col_idx], TYPE_CASE);
+#undef TYPE_CASE
+  }
+  ++rows->num_rows;
+  return Status::OK();
+}
+
+Status JoinHashTable::AddBuildBatch(const std::vector<const arrow::Array*>& key_cols,
+                                    const std::vector<const arrow::Array*>& build_cols,
+                                    int64_t num_rows) {
+  DCHECK(!build_finished_);
+  DCHECK_EQ(build_cols.size(), build_col_types_.size());
+  partitions_.front().keys->PrepareBatch(key_cols, num_rows, &key_batch_);
+  for (int64_t row_idx = 0; row_idx < num_rows; ++row_idx) {
+    auto& partition = partitions_[PartitionOf(key_batch_.hashes[row_idx])];
+    auto key_id = partition.keys->FindOrInsertRow(key_batch_, row_idx);
+    if (key_id == static_cast<int64_t>(partition.rows.size())) {
+      partition.rows.push_back(nullptr);
+      partition.probed.push_back(false);
+    }
+    auto& rows = partition.rows[key_id];
+    if (rows == nullptr) {
+      rows = NewBuildRows();
+    }
+    int64_t row_bytes = 0;
+    PX_RETURN_IF_ERROR(AppendBuildRow(build_cols, row_idx, rows.get(), &row_bytes));
+    partition.bytes += row_bytes;
+    bytes_in_memory_ += row_bytes;
+  }
+  return SpillUntilUnderBudget();
+}
+
+Status JoinHashTable::SpillUntilUnderBudget() {
+  if (spill_dir_.empty()) {
+    return Status::OK();
+  }
+  while (bytes_in_memory_ > memory_budget_bytes_) {
+    auto largest = std::max_element(
+        partitions_.begin(), partitions_.end(),
+        [](const Partition& a, const Partition& b) { return a.bytes < b.bytes; });
+    if (largest->bytes == 0) {
+      break;
+    }
+    PX_RETURN_IF_ERROR(SpillPartition(largest - partitions_.begin()));
+  }
+  return Status::OK();
+}
+
+Status JoinHashTable::SpillPartition(size_t partition_idx) {
+  auto& partition = partitions_[partition_idx];
+  if (partition.spill_path.empty()) {
+    std::error_code ec;
+    std::filesystem::create_directories(spill_dir_, ec);
+    if (ec) {
+      return error::Internal("Failed to create join spill dir $0: $1", spill_dir_.string(),
+                             ec.message());
+    }
+    partition.spill_path =
+        spill_dir_ / absl::Substitute("$0_$1.spill", spill_prefix_, partition_idx);
+  }
+
+  std::string data;
+  for (size_t key_id = 0; key_id < partition.rows.size(); ++key_id) {
+    auto& rows = partition.rows[key_id];
+    if (rows == nullptr) {
+      continue;
+    }
+    AppendRaw<int64_t>(key_id, &data);
+    AppendRaw<int64_t>(rows->num_rows, &data);
+    for (size_t col_idx = 0; col_idx < build_col_types_.size(); ++col_idx) {
+#define TYPE_CASE(_dt_) SerializeColumn<_dt_>(*rows->columns[col_idx], &data);
+      PX_SWITCH_FOREACH_DATATYPE(build_col_types_[col_idx], TYPE_CASE);
+#undef TYPE_CASE
+    }
+    rows.reset();
+  }
+  PX_RETURN_IF_ERROR(AppendToFile(partition.spill_path, data));
+  bytes_in_memory_ -= partition.bytes;
+  partition.bytes = 0;
+  return Status::OK();
+}
+
+Status JoinHashTable::LoadPartition(size_t partition_idx) {
+  if (loaded_partition_ == static_cast<int64_t>(partition_idx)) {
+    return Status::OK();
+  }
+  if (loaded_partition_ >= 0) {
+    // Rows that are still referenced by the caller stay alive until they are released.
+    auto& loaded = partitions_[loaded_partition_];
+    std::fill(loaded.rows.begin(), loaded.rows.end(), nullptr);
+    loaded_partition_ = -1;
+  }
+
+  auto& partition = partitions_[partition_idx];
+  PX_ASSIGN_OR_RETURN(auto data, ReadFile(partition.spill_path));
+  SpillReader reader(data);
+  while (!reader.Done()) {
+    int64_t key_id;
+    int64_t num_rows;
+    PX_RETURN_IF_ERROR(reader.Read(&key_id));
+    PX_RETURN_IF_ERROR(reader.Read(&num_rows));
+    if (key_id < 0 || key_id >= static_cast<int64_t>(partition.rows.size())) {
+      return error::Internal("Join spill file $0 has unknown key $1.",
+                             partition.spill_path.string(), key_id);
+    }
+    auto& rows = partition.rows[key_id];
+    if (rows == nullptr) {
+      rows = NewBuildRows();
+    }
+    for (size_t col_idx = 0; col_idx < build_col_types_.size(); ++col_idx) {
+#define TYPE_CASE(_dt_) \
+  PX_RETURN_IF_ERROR(DeserializeColumn<_dt_>(num_rows, &reader, rows->columns[col_idx].get()));
+      PX_SWITCH_FOREACH_DATATYPE(build_col_types_[col_idx], TYPE_CASE);
+#undef TYPE_CASE
+    }
+    rows->num_rows += num_rows;
+  }
+  loaded_partition_ = partition_idx;
+  return Status::OK();
+}
+
+Status JoinHashTable::FinishBuild() {
+  DCHECK(!build_finished_);
+  build_finished_ = true;
+
+  int64_t num_keys = 0;
+  for (size_t partition_idx = 0; partition_idx < partitions_.size(); ++partition_idx) {
+    auto& partition = partitions_[partition_idx];
+    num_keys += partition.keys->NumGroups();
+    // Spilled partitions are read back from disk in full, so move the rows that were added since
+    // the partition was last spilled to disk too.
+    if (!partition.spill_path.empty() && partition.bytes > 0) {
+      PX_RETURN_IF_ERROR(SpillPartition(partition_idx));
+    }
+  }
+  if (num_keys == 0) {
+    return Status::OK();
+  }
+
+  PX_ASSIGN_OR_RETURN(bloom_filter_,
+                      bloomfilter::XXHash64BloomFilter::Create(num_keys, kBloomFilterErrorRate));
+  for (const auto& partition : partitions_) {
+    for (int64_t key_id = 0; key_id < partition.keys->NumGroups(); ++key_id) {
+      uint64_t hash = partition.keys->GroupHash(key_id);
+      bloom_filter_->Insert(HashView(hash));
+    }
+  }
+  return Status::OK();
+}
+
+Status JoinHashTable::Probe(const std::vector<const arrow::Array*>& key_cols, int64_t num_rows,
+                            std::vector<std::shared_ptr<const JoinBuildRows>>* matches) {
+  return ProbeImpl(key_cols, /*probe_cols*/ nullptr, num_rows, matches, /*deferred*/ nullptr);
+}
+
+Status JoinHashTable::ProbeOrDefer(const std::vector<const arrow::Array*>& key_cols,
+                                   const std::vector<const arrow::Array*>& probe_cols,
+                                   int64_t num_rows,
+                                   std::vector<std::shared_ptr<const JoinBuildRows>>* matches,
+                                   std::vector<bool>* deferred) {
+  DCHECK(deferred != nullptr);
+  deferred->assign(num_rows, false);
+  return ProbeImpl(key_cols, &probe_cols, num_rows, matches, deferred);
+}
+
+Status JoinHashTable::ProbeImpl(const std::vector<const arrow::Array*>& key_cols,
+                                const std::vector<const arrow::Array*>* probe_cols,
+                                int64_t num_rows,
+                                std::vector<std::shared_ptr<const JoinBuildRows>>* matches,
+                                std::vector<bool>* deferred) {
+  DCHECK(build_finished_);
+  DCHECK(matches != nullptr);
+  matches->assign(num_rows, nullptr);
+  if (bloom_filter_ == nullptr) {
+    // The build side is empty.
+    probe_rows_filtered_ += num_rows;
+    return Status::OK();
+  }
+
+  partitions_.front().keys->PrepareBatch(key_cols, num_rows, &key_batch_);
+  for (auto& rows : partition_rows_) {
+    rows.clear();
+  }
+  for (int64_t row_idx = 0; row_idx < num_rows; ++row_idx) {
+    uint64_t hash = key_batch_.hashes[row_idx];
+    if (!bloom_filter_->Contains(HashView(hash))) {
+      ++probe_rows_filtered_;
+      continue;
+    }
+    partition_rows_[PartitionOf(hash)].push_back(row_idx);
+  }
+
+  for (size_t partition_idx = 0; partition_idx < partitions_.size(); ++partition_idx) {
+    auto& partition = partitions_[partition_idx];
+    for (int64_t row_idx : partition_rows_[partition_idx]) {
+      auto key_id = partition.keys->Find(key_batch_, row_idx);
+      if (key_id < 0) {
+        continue;
+      }
+      partition.probed[key_id] = true;
+      if (partition.rows[key_id] == nullptr) {
+        if (deferred != nullptr) {
+          DeferProbeRow(*probe_cols, row_idx, key_id, &partition);
+          (*deferred)[row_idx] = true;
+          continue;
+        }
+        PX_RETURN_IF_ERROR(LoadPartition(partition_idx));
+      }
+      (*matches)[row_idx] = partition.rows[key_id];
+    }
+    if (partition.deferred_probe_rows.size() >= kDeferredProbeBufferBytes) {
+      PX_RETURN_IF_ERROR(WriteDeferredProbeRows(partition_idx));
+    }
+  }
+  return Status::OK();
+}
+
+void JoinHashTable::DeferProbeRow(const std::vector<const arrow::Array*>& probe_cols,
+                                  int64_t row_idx, int64_t key_id, Partition* partition) const {
+  AppendRaw<int64_t>(key_id, &partition->deferred_probe_rows);
+  for (const auto* col : probe_cols) {
+#define TYPE_CASE(_dt_) SerializeArrowValue<_dt_>(col, row_idx, &partition->deferred_probe_rows);
+    PX_SWITCH_FOREACH_DATATYPE(types::ArrowToDataType(col->type_id()), TYPE_CASE);
+#undef TYPE_CASE
+  }
+  ++partition->num_deferred_probe_rows;
+}
+
+Status JoinHashTable::WriteDeferredProbeRows(size_t partition_idx) {
+  auto& partition = partitions_[partition_idx];
+  if (partition.probe_spill_path.empty()) {
+    partition.probe_spill_path =
+        spill_dir_ / absl::Substitute("$0_$1.probe.spill", spill_prefix_, partition_idx);
+  }
+  PX_RETURN_IF_ERROR(AppendToFile(partition.probe_spill_path, partition.deferred_probe_rows));
+  // Release the buffer, instead of keeping its capacity around for every partition.
+  std::string().swap(partition.deferred_probe_rows);
+  return Status::OK();
+}
+
+Status JoinHashTable::JoinDeferredProbeRows(
+    const std::vector<types::DataType>& probe_col_types,
+    const std::function<Status(std::shared_ptr<table_store::schema::RowBatch>,
+                               const std::vector<std::shared_ptr<const JoinBuildRows>>&)>& fn) {
+  DCHECK(build_finished_);
+  table_store::schema::RowDescriptor probe_desc(probe_col_types);
+  for (size_t partition_idx = 0; partition_idx < partitions_.size(); ++partition_idx) {
+    auto& partition = partitions_[partition_idx];
+    if (partition.num_deferred_probe_rows == 0) {
+      continue;
+    }
+    PX_RETURN_IF_ERROR(WriteDeferredProbeRows(partition_idx));
+    PX_RETURN_IF_ERROR(LoadPartition(partition_idx));
+    PX_ASSIGN_OR_RETURN(auto data, ReadFile(partition.probe_spill_path));
+    SpillReader reader(data);
+    int64_t rows_left = partition.num_deferred_probe_rows;
+    while (rows_left > 0) {
+      int64_t batch_rows = std::min(rows_left, kDeferredProbeBatchRows);
+      std::vector<std::unique_ptr<arrow::ArrayBuilder>> builders;
+      for (auto type : probe_col_types) {
+        builders.push_back(types::MakeArrowBuilder(type, arrow::default_memory_pool()));
+        PX_RETURN_IF_ERROR(builders.back()->Reserve(batch_rows));
+      }
+      std::vector<std::shared_ptr<const JoinBuildRows>> matches;
+      matches.reserve(batch_rows);
+      for (int64_t row_idx = 0; row_idx < batch_rows; ++row_idx) {
+        int64_t key_id;
+        PX_RETURN_IF_ERROR(reader.Read(&key_id));
+        if (key_id < 0 || key_id >= static_cast<int64_t>(partition.rows.size())) {
+          return error::Internal("Join spill file $0 has unknown key $1.",
+                                 partition.probe_spill_path.string(), key_id);
+        }
+        matches.push_back(partition.rows[key_id]);
+        for (size_t col_idx = 0; col_idx < probe_col_types.size(); ++col_idx) {
+#define TYPE_CASE(_dt_) \
+  PX_RETURN_IF_ERROR(DeserializeArrowValue<_dt_>(&reader, builders[col_idx].get()));
+          PX_SWITCH_FOREACH_DATATYPE(probe_col_types[col_idx], TYPE_CASE);
+#undef TYPE_CASE
+        }
+      }
+      PX_ASSIGN_OR_RETURN(auto probe_rb,
+                          table_store::schema::RowBatch::FromColumnBuilders(
+                              probe_desc, /*eow*/ false, /*eos*/ false, &builders));
+      PX_RETURN_IF_ERROR(fn(std::move(probe_rb), matches));
+      rows_left -= batch_rows;
+    }
+    partition.num_deferred_probe_rows = 0;
+  }
+  return Status::OK();
+}
+
+Status JoinHashTable::ForEachUnprobed(
+    const std::function<Status(std::shared_ptr<const JoinBuildRows>)>& fn) {
+  DCHECK(build_finished_);
+  for (size_t partition_idx = 0; partition_idx < partitions_.size(); ++partition_idx) {
+    auto& partition = partitions_[partition_idx];
+    for (size_t key_id = 0; key_id < partition.rows.size(); ++key_id) {
+      if (partition.probed[key_id]) {
+        continue;
+      }
+      if (partition.rows[key_id] == nullptr) {
+        PX_RETURN_IF_ERROR(LoadPartition(partition_idx));
+      }
+      PX_RETURN_IF_ERROR(fn(partition.rows[key_id]));
+    }
+  }
+  return Status::OK();
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,206 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <arrow/array.h>
+
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "src/carnot/exec/group_key_table.h"
+#include "src/common/base/base.h"
+#include "src/shared/bloomfilter/bloomfilter.h"
+#include "src/shared/types/column_wrapper.h"
+#include "src/shared/types/types.h"
+#include "src/table_store/schema/row_batch.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+/**
+ * JoinBuildRows holds the rows of the build side of a join that share a join key.
+ */
+struct JoinBuildRows {
+  // One column wrapper per build column that is output by the join.
+  std::vector<types::SharedColumnWrapper> columns;
+  // Tracked separately from the columns, since the join might not output any build columns.
+  int64_t num_rows = 0;
+};
+
+/**
+ * JoinHashTable holds the build side of a hash join, and finds the build rows that match the
+ * rows of probe batches.
+ *
+ * Build rows are radix partitioned on the high bits of the hash of their join keys, and every
+ * partition has its own GroupKeyTable that maps a key to the rows with that key. The rows of a
+ * probe batch are bucketed by partition and looked up one partition at a time, so the hash table
+ * being probed is a fraction of the whole build side and stays in cache.
+ *
+ * Once the build side is complete, a bloom filter is built over the hashes of all build keys.
+ * Probe rows whose key isn't in the filter are dropped before any partition is touched.
+ *
+ * If a spill directory is given and the build rows outgrow the memory budget, the rows of the
+ * largest partitions are appended to files on local disk. The keys of a spilled partition stay in
+ * memory, so that probe rows without a match never read the file. Probe rows that do match a
+ * spilled partition are handled in one of two ways:
+ *  - ProbeOrDefer appends them to a probe spill file of the partition. Once the probe side is
+ *    complete, JoinDeferredProbeRows reads back every spilled partition once, together with its
+ *    deferred probe rows (a grace hash join).
+ *  - Probe reads the partition back right away, which keeps the output in probe order, but might
+ *    read the same partition many times.
+ * At most one spilled partition is in memory at a time.
+ */
+class JoinHashTable : public NotCopyable {
+ public:
+  /**
+   * @param key_types the types of the join keys.
+   * @param build_col_types the types of the build columns that are output by the join.
+   * @param memory_budget_bytes the number of bytes of build rows to keep in memory before
+   * partitions are spilled.
+   * @param spill_dir directory to spill partitions to. Spilling is disabled if empty.
+   */
+  JoinHashTable(const std::vector<types::DataType>& key_types,
+                const std::vector<types::DataType>& build_col_types, int64_t memory_budget_bytes,
+                const std::filesystem::path& spill_dir);
+
+  /**
+   * Deletes the spill files.
+   */
+  ~JoinHashTable();
+
+  /**
+   * Adds a batch of build rows. Must not be called after FinishBuild.
+   * @param key_cols the join key columns of the batch, in the order of the key types.
+   * @param build_cols the output build columns of the batch, in the order of the build types.
+   * @param num_rows the number of rows in the batch.
+   */
+  Status AddBuildBatch(const std::vector<const arrow::Array*>& key_cols,
+                       const std::vector<const arrow::Array*>& build_cols, int64_t num_rows);
+
+  /**
+   * Marks the build side as complete, and builds the bloom filter over the build keys.
+   */
+  Status FinishBuild();
+
+  /**
+   * Finds the build rows matching every row of a probe batch, and marks them as probed.
+   * @param key_cols the join key columns of the probe batch, in the order of the key types.
+   * @param num_rows the number of rows in the batch.
+   * @param matches output, resized to num_rows, holds the matching build rows of every probe row,
+   * or nullptr if there are none.
+   */
+  Status Probe(const std::vector<const arrow::Array*>& key_cols, int64_t num_rows,
+               std::vector<std::shared_ptr<const JoinBuildRows>>* matches);
+
+  /**
+   * Like Probe, but the probe rows whose matches are spilled to disk are deferred: their probe
+   * columns are written to disk, and they are joined by JoinDeferredProbeRows.
+   * @param key_cols the join key columns of the probe batch, in the order of the key types.
+   * @param probe_cols the output probe columns of the batch.
+   * @param num_rows the number of rows in the batch.
+   * @param matches output, same as for Probe. nullptr for deferred rows.
+   * @param deferred output, resized to num_rows, holds whether every probe row was deferred.
+   */
+  Status ProbeOrDefer(const std::vector<const arrow::Array*>& key_cols,
+                      const std::vector<const arrow::Array*>& probe_cols, int64_t num_rows,
+                      std::vector<std::shared_ptr<const JoinBuildRows>>* matches,
+                      std::vector<bool>* deferred);
+
+  /**
+   * Joins the probe rows that were deferred by ProbeOrDefer, one spilled partition at a time.
+   * Must be called once, after the last probe batch.
+   * @param probe_col_types the types of the probe columns that were passed to ProbeOrDefer.
+   * @param fn called with batches of deferred probe rows, which hold the probe columns, and the
+   * matching build rows of every row in the batch.
+   */
+  Status JoinDeferredProbeRows(
+      const std::vector<types::DataType>& probe_col_types,
+      const std::function<Status(std::shared_ptr<table_store::schema::RowBatch>,
+                                 const std::vector<std::shared_ptr<const JoinBuildRows>>&)>& fn);
+
+  /**
+   * Calls fn with the build rows of every key that was never matched by Probe.
+   */
+  Status ForEachUnprobed(const std::function<Status(std::shared_ptr<const JoinBuildRows>)>& fn);
+
+  int64_t bytes_in_memory() const { return bytes_in_memory_; }
+  int64_t num_spilled_partitions() const;
+  // Number of probe rows that were dropped by the bloom filter.
+  int64_t probe_rows_filtered() const { return probe_rows_filtered_; }
+
+ private:
+  struct Partition {
+    std::unique_ptr<GroupKeyTable> keys;
+    // Build rows by key ID. Entries are nullptr while the rows of the key are spilled.
+    std::vector<std::shared_ptr<JoinBuildRows>> rows;
+    // Whether each key was matched by a probe row, by key ID.
+    std::vector<bool> probed;
+    // Size of the build rows of the partition that are in memory and not on disk.
+    int64_t bytes = 0;
+    // Empty if the partition was never spilled.
+    std::filesystem::path spill_path;
+    // Probe rows deferred by ProbeOrDefer, that weren't appended to probe_spill_path yet.
+    std::string deferred_probe_rows;
+    int64_t num_deferred_probe_rows = 0;
+    // Empty if no deferred probe rows were written to disk.
+    std::filesystem::path probe_spill_path;
+  };
+
+  static size_t PartitionOf(uint64_t hash);
+  std::shared_ptr<JoinBuildRows> NewBuildRows() const;
+  Status AppendBuildRow(const std::vector<const arrow::Array*>& build_cols, int64_t row_idx,
+                        JoinBuildRows* rows, int64_t* row_bytes) const;
+  Status SpillUntilUnderBudget();
+  Status SpillPartition(size_t partition_idx);
+  Status LoadPartition(size_t partition_idx);
+  Status ProbeImpl(const std::vector<const arrow::Array*>& key_cols,
+                   const std::vector<const arrow::Array*>* probe_cols, int64_t num_rows,
+                   std::vector<std::shared_ptr<const JoinBuildRows>>* matches,
+                   std::vector<bool>* deferred);
+  void DeferProbeRow(const std::vector<const arrow::Array*>& probe_cols, int64_t row_idx,
+                     int64_t key_id, Partition* partition) const;
+  Status WriteDeferredProbeRows(size_t partition_idx);
+
+  const std::vector<types::DataType> build_col_types_;
+  const int64_t memory_budget_bytes_;
+  const std::filesystem::path spill_dir_;
+  // Unique prefix of the spill files of this table.
+  const std::string spill_prefix_;
+
+  std::vector<Partition> partitions_;
+  int64_t bytes_in_memory_ = 0;
+  bool build_finished_ = false;
+  // The spilled partition whose rows were read back into memory, or -1.
+  int64_t loaded_partition_ = -1;
+
+  std::unique_ptr<bloomfilter::XXHash64BloomFilter> bloom_filter_;
+  int64_t probe_rows_filtered_ = 0;
+
+  // Scratch space, reused across batches.
+  GroupKeyTable::KeyBatch key_batch_;
+  std::vector<std::vector<int64_t>> partition_rows_;
+};
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
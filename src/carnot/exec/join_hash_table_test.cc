@@ -0,0 +1,273 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <absl/container/flat_hash_map.h>
+#include <absl/strings/str_cat.h>
+
+#include "src/carnot/exec/join_hash_table.h"
+#include "src/common/testing/testing.h"
+#include "src/shared/types/arrow_adapter.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+namespace {
+
+std::vector<std::string> StringValues(const JoinBuildRows& rows, size_t col_idx) {
+  std::vector<std::string> values;
+  for (int64_t row_idx = 0; row_idx < rows.num_rows; ++row_idx) {
+    values.emplace_back(rows.columns[col_idx]->GetView(row_idx));
+  }
+  return values;
+}
+
+std::vector<int64_t> Int64Values(const JoinBuildRows& rows, size_t col_idx) {
+  std::vector<int64_t> values;
+  for (int64_t row_idx = 0; row_idx < rows.num_rows; ++row_idx) {
+    values.push_back(rows.columns[col_idx]->Get<types::Int64Value>(row_idx).val);
+  }
+  return values;
+}
+
+}  // namespace
+
+using ::testing::ElementsAre;
+
+TEST(JoinHashTableTest, matches_build_rows_in_insertion_order) {
+  JoinHashTable table({types::INT64}, {types::STRING}, /*memory_budget_bytes*/ 1024 * 1024,
+                      /*spill_dir*/ "");
+  auto keys = types::ToArrow(std::vector<types::Int64Value>{1, 2, 1, 3},
+                             arrow::default_memory_pool());
+  auto vals = types::ToArrow(std::vector<types::StringValue>{"a", "b", "c", "d"},
+                             arrow::default_memory_pool());
+  ASSERT_OK(table.AddBuildBatch({keys.get()}, {vals.get()}, 4));
+  auto more_keys = types::ToArrow(std::vector<types::Int64Value>{1}, arrow::default_memory_pool());
+  auto more_vals =
+      types::ToArrow(std::vector<types::StringValue>{"e"}, arrow::default_memory_pool());
+  ASSERT_OK(table.AddBuildBatch({more_keys.get()}, {more_vals.get()}, 1));
+  ASSERT_OK(table.FinishBuild());
+
+  auto probe_keys = types::ToArrow(std::vector<types::Int64Value>{1, 4, 3, 2},
+                                   arrow::default_memory_pool());
+  std::vector<std::shared_ptr<const JoinBuildRows>> matches;
+  ASSERT_OK(table.Probe({probe_keys.get()}, 4, &matches));
+  ASSERT_EQ(4, matches.size());
+  ASSERT_NE(nullptr, matches[0]);
+  EXPECT_THAT(StringValues(*matches[0], 0), ElementsAre("a", "c", "e"));
+  EXPECT_EQ(nullptr, matches[1]);
+  ASSERT_NE(nullptr, matches[2]);
+  EXPECT_THAT(StringValues(*matches[2], 0), ElementsAre("d"));
+  ASSERT_NE(nullptr, matches[3]);
+  EXPECT_THAT(StringValues(*matches[3], 0), ElementsAre("b"));
+  EXPECT_EQ(0, table.num_spilled_partitions());
+}
+
+TEST(JoinHashTableTest, bloom_filter_drops_missing_keys) {
+  JoinHashTable table({types::INT64, types::STRING}, {}, /*memory_budget_bytes*/ 1024 * 1024,
+                      /*spill_dir*/ "");
+  std::vector<types::Int64Value> build_ints;
+  std::vector<types::StringValue> build_strings;
+  for (int64_t i = 0; i < 100; ++i) {
+    build_ints.push_back(i);
+    build_strings.push_back(absl::StrCat("key", i));
+  }
+  auto keys = types::ToArrow(build_ints, arrow::default_memory_pool());
+  auto strings = types::ToArrow(build_strings, arrow::default_memory_pool());
+  ASSERT_OK(table.AddBuildBatch({keys.get(), strings.get()}, {}, 100));
+  ASSERT_OK(table.FinishBuild());
+
+  // Same ints, but none of the strings match.
+  std::vector<types::StringValue> probe_strings;
+  for (int64_t i = 0; i < 100; ++i) {
+    probe_strings.push_back(absl::StrCat("other", i));
+  }
+  auto missing = types::ToArrow(probe_strings, arrow::default_memory_pool());
+  std::vector<std::shared_ptr<const JoinBuildRows>> matches;
+  ASSERT_OK(table.Probe({keys.get(), missing.get()}, 100, &matches));
+  for (const auto& match : matches) {
+    EXPECT_EQ(nullptr, match);
+  }
+  EXPECT_GT(table.probe_rows_filtered(), 90);
+
+  // Join keys without build columns still count their rows.
+  ASSERT_OK(table.Probe({keys.get(), strings.get()}, 100, &matches));
+  for (const auto& match : matches) {
+    ASSERT_NE(nullptr, match);
+    EXPECT_EQ(1, match->num_rows);
+    EXPECT_TRUE(match->columns.empty());
+  }
+}
+
+TEST(JoinHashTableTest, unprobed_build_rows) {
+  JoinHashTable table({types::INT64}, {types::INT64}, /*memory_budget_bytes*/ 1024 * 1024,
+                      /*spill_dir*/ "");
+  auto keys =
+      types::ToArrow(std::vector<types::Int64Value>{1, 2, 3, 2}, arrow::default_memory_pool());
+  auto vals =
+      types::ToArrow(std::vector<types::Int64Value>{10, 20, 30, 40}, arrow::default_memory_pool());
+  ASSERT_OK(table.AddBuildBatch({keys.get()}, {vals.get()}, 4));
+  ASSERT_OK(table.FinishBuild());
+
+  auto probe_keys =
+      types::ToArrow(std::vector<types::Int64Value>{3, 5}, arrow::default_memory_pool());
+  std::vector<std::shared_ptr<const JoinBuildRows>> matches;
+  ASSERT_OK(table.Probe({probe_keys.get()}, 2, &matches));
+
+  std::vector<std::vector<int64_t>> unprobed;
+  ASSERT_OK(table.ForEachUnprobed([&](std::shared_ptr<const JoinBuildRows> rows) {
+    unprobed.push_back(Int64Values(*rows, 0));
+    return Status::OK();
+  }));
+  EXPECT_THAT(unprobed, ::testing::UnorderedElementsAre(ElementsAre(10), ElementsAre(20, 40)));
+}
+
+TEST(JoinHashTableTest, spills_partitions_over_memory_budget) {
+  px::testing::TempDir spill_dir;
+  constexpr int64_t kNumKeys = 100;
+  constexpr int64_t kRowsPerKey = 10;
+  {
+    // Every batch exceeds the budget, so all of the build rows end up on disk.
+    JoinHashTable table({types::INT64}, {types::INT64, types::STRING},
+                        /*memory_budget_bytes*/ 0, spill_dir.path());
+    for (int64_t batch = 0; batch < kRowsPerKey; ++batch) {
+      std::vector<types::Int64Value> keys;
+      std::vector<types::Int64Value> ints;
+      std::vector<types::StringValue> strings;
+      for (int64_t key = 0; key < kNumKeys; ++key) {
+        keys.push_back(key);
+        ints.push_back(batch * kNumKeys + key);
+        strings.push_back(absl::StrCat("row", batch * kNumKeys + key));
+      }
+      auto key_col = types::ToArrow(keys, arrow::default_memory_pool());
+      auto int_col = types::ToArrow(ints, arrow::default_memory_pool());
+      auto string_col = types::ToArrow(strings, arrow::default_memory_pool());
+      ASSERT_OK(table.AddBuildBatch({key_col.get()}, {int_col.get(), string_col.get()}, kNumKeys));
+      EXPECT_EQ(0, table.bytes_in_memory());
+    }
+    ASSERT_OK(table.FinishBuild());
+    EXPECT_GT(table.num_spilled_partitions(), 0);
+    EXPECT_FALSE(std::filesystem::is_empty(spill_dir.path()));
+
+    std::vector<types::Int64Value> probe_keys;
+    for (int64_t key = kNumKeys - 1; key >= 0; --key) {
+      probe_keys.push_back(key);
+    }
+    auto probe_col = types::ToArrow(probe_keys, arrow::default_memory_pool());
+    std::vector<std::shared_ptr<const JoinBuildRows>> matches;
+    ASSERT_OK(table.Probe({probe_col.get()}, kNumKeys, &matches));
+    for (int64_t row_idx = 0; row_idx < kNumKeys; ++row_idx) {
+      int64_t key = probe_keys[row_idx].val;
+      ASSERT_NE(nullptr, matches[row_idx]);
+      std::vector<int64_t> expected_ints;
+      std::vector<std::string> expected_strings;
+      for (int64_t batch = 0; batch < kRowsPerKey; ++batch) {
+        expected_ints.push_back(batch * kNumKeys + key);
+        expected_strings.push_back(absl::StrCat("row", batch * kNumKeys + key));
+      }
+      EXPECT_EQ(expected_ints, Int64Values(*matches[row_idx], 0));
+      EXPECT_EQ(expected_strings, StringValues(*matches[row_idx], 1));
+    }
+  }
+  // The spill files are deleted with the table.
+  EXPECT_TRUE(std::filesystem::is_empty(spill_dir.path()));
+}
+
+TEST(JoinHashTableTest, defers_probe_rows_of_spilled_partitions) {
+  px::testing::TempDir spill_dir;
+  constexpr int64_t kNumKeys = 100;
+  {
+    JoinHashTable table({types::INT64}, {types::INT64}, /*memory_budget_bytes*/ 0,
+                        spill_dir.path());
+    std::vector<types::Int64Value> keys;
+    std::vector<types::Int64Value> vals;
+    for (int64_t key = 0; key < kNumKeys; ++key) {
+      keys.push_back(key);
+      vals.push_back(10 * key);
+    }
+    auto key_col = types::ToArrow(keys, arrow::default_memory_pool());
+    auto val_col = types::ToArrow(vals, arrow::default_memory_pool());
+    ASSERT_OK(table.AddBuildBatch({key_col.get()}, {val_col.get()}, kNumKeys));
+    ASSERT_OK(table.FinishBuild());
+
+    // Every key is probed twice, by two batches.
+    std::vector<types::StringValue> probe_vals;
+    for (int64_t key = 0; key < kNumKeys; ++key) {
+      probe_vals.push_back(absl::StrCat("probe", key));
+    }
+    auto probe_col = types::ToArrow(probe_vals, arrow::default_memory_pool());
+    std::vector<std::shared_ptr<const JoinBuildRows>> matches;
+    std::vector<bool> deferred;
+    for (int64_t batch = 0; batch < 2; ++batch) {
+      ASSERT_OK(table.ProbeOrDefer({key_col.get()}, {probe_col.get()}, kNumKeys, &matches,
+                                   &deferred));
+      EXPECT_THAT(matches, ::testing::Each(nullptr));
+      EXPECT_THAT(deferred, ::testing::Each(true));
+    }
+
+    absl::flat_hash_map<std::string, std::vector<int64_t>> joined;
+    ASSERT_OK(table.JoinDeferredProbeRows(
+        {types::STRING},
+        [&](std::shared_ptr<table_store::schema::RowBatch> probe_rb,
+            const std::vector<std::shared_ptr<const JoinBuildRows>>& build_rows) {
+          EXPECT_EQ(probe_rb->num_rows(), static_cast<int64_t>(build_rows.size()));
+          for (int64_t row_idx = 0; row_idx < probe_rb->num_rows(); ++row_idx) {
+            auto probe_val = types::GetValueFromArrowArray<types::STRING>(
+                probe_rb->ColumnAt(0).get(), row_idx);
+            for (auto val : Int64Values(*build_rows[row_idx], 0)) {
+              joined[probe_val].push_back(val);
+            }
+          }
+          return Status::OK();
+        }));
+    ASSERT_EQ(kNumKeys, static_cast<int64_t>(joined.size()));
+    for (int64_t key = 0; key < kNumKeys; ++key) {
+      EXPECT_THAT(joined[absl::StrCat("probe", key)], ElementsAre(10 * key, 10 * key));
+    }
+
+    // The deferred probe rows marked their keys as probed.
+    ASSERT_OK(table.ForEachUnprobed([](std::shared_ptr<const JoinBuildRows>) {
+      return error::Internal("Every key was probed.");
+    }));
+  }
+  // The probe spill files are deleted with the table too.
+  EXPECT_TRUE(std::filesystem::is_empty(spill_dir.path()));
+}
+
+TEST(JoinHashTableTest, empty_build_side) {
+  JoinHashTable table({types::INT64}, {types::INT64}, /*memory_budget_bytes*/ 1024 * 1024,
+                      /*spill_dir*/ "");
+  ASSERT_OK(table.FinishBuild());
+  auto probe_keys =
+      types::ToArrow(std::vector<types::Int64Value>{1, 2}, arrow::default_memory_pool());
+  std::vector<std::shared_ptr<const JoinBuildRows>> matches;
+  ASSERT_OK(table.Probe({probe_keys.get()}, 2, &matches));
+  EXPECT_THAT(matches, ElementsAre(nullptr, nullptr));
+  ASSERT_OK(table.ForEachUnprobed([](std::shared_ptr<const JoinBuildRows>) {
+    return error::Internal("There are no build rows.");
+  }));
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -67,23 +67,30 @@ Status LimitNode::ConsumeNextImpl(ExecState* exec_state, const RowBatch& rb, siz
 
   // Check if the entire row batch will fit.
   if (remainder_records > rb.num_rows()) {
-    RowBatch output_rb(*output_descriptor_, rb.num_rows());
+    RowBatch output_rb(*output_descriptor_, rb.num_column_rows());
     DCHECK_EQ(output_descriptor_->size(), plan_node_->selected_cols().size());
     // If so we just need to convert to output descriptor and transfer it.
     for (int64_t input_col_idx : plan_node_->selected_cols()) {
       PX_RETURN_IF_ERROR(output_rb.AddColumn(rb.ColumnAt(input_col_idx)));
     }
+    if (rb.has_selection()) {
+      PX_RETURN_IF_ERROR(output_rb.SetSelection(rb.selection()));
+    }
     records_processed_ += rb.num_rows();
     output_rb.set_eos(rb.eos());
     output_rb.set_eow(rb.eow());
     return SendRowBatchToChildren(exec_state, output_rb);
   }
 
-  RowBatch output_rb(*output_descriptor_, remainder_records);
+  // Slicing a row batch with a selection only truncates its selection.
+  PX_ASSIGN_OR_RETURN(auto sliced_rb, rb.Slice(0, remainder_records));
+  RowBatch output_rb(*output_descriptor_, sliced_rb->num_column_rows());
   DCHECK_EQ(output_descriptor_->size(), plan_node_->selected_cols().size());
   for (int64_t input_col_idx : plan_node_->selected_cols()) {
-    auto col = rb.ColumnAt(input_col_idx);
-    PX_RETURN_IF_ERROR(output_rb.AddColumn(col->Slice(0, remainder_records)));
+    PX_RETURN_IF_ERROR(output_rb.AddColumn(sliced_rb->ColumnAt(input_col_idx)));
+  }
+  if (sliced_rb->has_selection()) {
+    PX_RETURN_IF_ERROR(output_rb.SetSelection(sliced_rb->selection()));
   }
   output_rb.set_eow(true);
   output_rb.set_eos(true);
@@ -23,6 +23,7 @@
 
 #include <absl/strings/substitute.h>
 
+#include "src/carnot/plan/scalar_expression.h"
 #include "src/carnot/planpb/plan.pb.h"
 #include "src/common/base/base.h"
 
@@ -42,6 +43,15 @@ Status MapNode::InitImpl(const plan::Operator& plan_node) {
   const auto* map_plan_node = static_cast<const plan::MapOperator*>(&plan_node);
   // copy the plan node to local object;
   plan_node_ = std::make_unique<plan::MapOperator>(*map_plan_node);
+  plan::ExpressionWalker<int> column_walker;
+  column_walker.OnColumn([this](const plan::Column& col, const std::vector<int>&) {
+    expression_cols_.push_back(col.Index());
+    return 0;
+  });
+  for (const auto& expr : plan_node_->expressions()) {
+    calls_funcs_ |= expr->ExpressionType() == plan::Expression::kFunc;
+    column_walker.Walk(*expr);
+  }
   return Status::OK();
 }
 Status MapNode::PrepareImpl(ExecState* exec_state) {
@@ -61,8 +71,23 @@ Status MapNode::CloseImpl(ExecState* exec_state) {
   return Status::OK();
 }
 Status MapNode::ConsumeNextImpl(ExecState* exec_state, const RowBatch& rb, size_t) {
-  RowBatch output_rb(*output_descriptor_, rb.num_rows());
-  PX_RETURN_IF_ERROR(evaluator_->Evaluate(exec_state, rb, &output_rb));
+  // Functions must only see the selected rows, since the rows that a filter dropped might make
+  // them fail (e.g. a modulo by zero), so the selected rows of the columns that the expressions
+  // read are copied first.
+  std::unique_ptr<RowBatch> materialized_rb;
+  const RowBatch* input_rb = &rb;
+  if (rb.has_selection() && calls_funcs_) {
+    PX_ASSIGN_OR_RETURN(materialized_rb,
+                        rb.MaterializeColumns(expression_cols_, exec_state->exec_mem_pool()));
+    input_rb = materialized_rb.get();
+  }
+  // Otherwise the columns and constants are evaluated on all of the rows of the input's arrays, and
+  // the output keeps the input's selection, so that the selected rows are never copied.
+  RowBatch output_rb(*output_descriptor_, input_rb->num_column_rows());
+  PX_RETURN_IF_ERROR(evaluator_->Evaluate(exec_state, input_rb->WithoutSelection(), &output_rb));
+  if (input_rb->has_selection()) {
+    PX_RETURN_IF_ERROR(output_rb.SetSelection(input_rb->selection()));
+  }
   output_rb.set_eow(rb.eow());
   output_rb.set_eos(rb.eos());
   PX_RETURN_IF_ERROR(SendRowBatchToChildren(exec_state, output_rb));
@@ -49,11 +49,17 @@ class MapNode : public ProcessingNode {
   Status CloseImpl(ExecState* exec_state) override;
   Status ConsumeNextImpl(ExecState* exec_state, const table_store::schema::RowBatch& rb,
                          size_t parent_index) override;
+  bool ConsumesSelection() const override { return true; }
 
  private:
   std::unique_ptr<ExpressionEvaluator> evaluator_;
   std::unique_ptr<plan::MapOperator> plan_node_;
   std::unique_ptr<udf::FunctionContext> function_ctx_;
+  // Whether any of the expressions calls a function, rather than just selecting a column or
+  // constant.
+  bool calls_funcs_ = false;
+  // The input columns that the expressions read.
+  std::vector<int64_t> expression_cols_;
 };
 
 }  // namespace exec
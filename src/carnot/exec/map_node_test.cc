@@ -21,6 +21,8 @@
 #include <memory>
 #include <vector>
 
+#include <absl/strings/substitute.h>
+#include <google/protobuf/text_format.h>
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 #include <sole.hpp>
@@ -51,6 +53,13 @@ class AddUDF : public udf::ScalarUDF {
   }
 };
 
+class ModuloUDF : public udf::ScalarUDF {
+ public:
+  types::Int64Value Exec(FunctionContext*, types::Int64Value v1, types::Int64Value v2) {
+    return v1.val % v2.val;
+  }
+};
+
 class MapNodeTest : public ::testing::Test {
  public:
   MapNodeTest() {
@@ -59,6 +68,7 @@ class MapNodeTest : public ::testing::Test {
 
     func_registry_ = std::make_unique<udf::Registry>("test_registry");
     EXPECT_OK(func_registry_->Register<AddUDF>("add"));
+    EXPECT_OK(func_registry_->Register<ModuloUDF>("modulo"));
     auto table_store = std::make_shared<table_store::TableStore>();
 
     exec_state_ = std::make_unique<ExecState>(func_registry_.get(), table_store,
@@ -66,6 +76,9 @@ class MapNodeTest : public ::testing::Test {
                                               MockTraceStubGenerator, sole::uuid4(), nullptr);
     EXPECT_OK(exec_state_->AddScalarUDF(
         0, "add", std::vector<types::DataType>({types::DataType::INT64, types::DataType::INT64})));
+    EXPECT_OK(exec_state_->AddScalarUDF(
+        1, "modulo",
+        std::vector<types::DataType>({types::DataType::INT64, types::DataType::INT64})));
   }
 
  protected:
@@ -131,6 +144,51 @@ TEST_F(MapNodeTest, zero_row_row_batch) {
       .Close();
 }
 
+TEST_F(MapNodeTest, funcs_only_see_selected_rows) {
+  planpb::Operator op_proto;
+  ASSERT_TRUE(google::protobuf::TextFormat::MergeFromString(
+      absl::Substitute(planpb::testutils::kOperatorProtoTmpl, "MAP_OPERATOR", "map_op",
+                       absl::Substitute(planpb::testutils::kMapOperatorTmpl, R"(
+func {
+  name: "modulo"
+  id: 1
+  args {
+    column {
+      node: 0
+      index: 0
+    }
+  }
+  args {
+    column {
+      node: 0
+      index: 1
+    }
+  }
+  args_data_types: INT64
+  args_data_types: INT64
+})")),
+      &op_proto));
+  auto plan_node = plan::MapOperator::FromProto(op_proto, 1);
+
+  RowDescriptor input_rd({types::DataType::INT64, types::DataType::INT64});
+  RowDescriptor output_rd({types::DataType::INT64});
+
+  // A filter on the divisor dropped the rows where it is 0, which would crash the modulo.
+  auto input_rb = RowBatchBuilder(input_rd, 4, /*eow*/ true, /*eos*/ true)
+                      .AddColumn<types::Int64Value>({7, 8, 9, 10})
+                      .AddColumn<types::Int64Value>({0, 3, 0, 4})
+                      .get();
+  ASSERT_OK(input_rb.SetSelection(
+      std::make_shared<RowBatch::SelectionVector>(RowBatch::SelectionVector{1, 3})));
+
+  auto tester = exec::ExecNodeTester<MapNode, plan::MapOperator>(*plan_node, output_rd, {},
+                                                                 exec_state_.get());
+  tester.ConsumeNext(input_rb, 0)
+      .ExpectRowBatch(
+          RowBatchBuilder(output_rd, 2, true, true).AddColumn<types::Int64Value>({2, 2}).get())
+      .Close();
+}
+
 TEST_F(MapNodeTest, child_fail) {
   RowDescriptor input_rd({types::DataType::INT64, types::DataType::INT64});
   RowDescriptor output_rd({types::DataType::INT64});
@@ -19,14 +19,20 @@
 #include "src/carnot/exec/memory_source_node.h"
 #include "src/table_store/table/table.h"
 
+#include <algorithm>
 #include <limits>
+#include <optional>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include <absl/strings/str_join.h>
 #include <absl/strings/substitute.h>
 
+#include "src/carnot/plan/scalar_expression.h"
 #include "src/carnot/planpb/plan.pb.h"
 #include "src/common/base/base.h"
+#include "src/shared/types/arrow_adapter.h"
 
 namespace px {
 namespace carnot {
@@ -34,6 +40,119 @@ namespace exec {
 
 using StartSpec = Table::Cursor::StartSpec;
 using StopSpec = Table::Cursor::StopSpec;
+using ColumnPredicate = Table::ColumnPredicate;
+
+namespace {
+
+std::optional<ColumnPredicate::Op> ComparisonOp(const std::string& func_name) {
+  if (func_name == "equal") {
+    return ColumnPredicate::kEqual;
+  }
+  if (func_name == "lessThan") {
+    return ColumnPredicate::kLessThan;
+  }
+  if (func_name == "lessThanEqual") {
+    return ColumnPredicate::kLessThanEqual;
+  }
+  if (func_name == "greaterThan") {
+    return ColumnPredicate::kGreaterThan;
+  }
+  if (func_name == "greaterThanEqual") {
+    return ColumnPredicate::kGreaterThanEqual;
+  }
+  return std::nullopt;
+}
+
+// Returns the op such that `literal op col` is equivalent to `col FlipOp(op) literal`.
+ColumnPredicate::Op FlipOp(ColumnPredicate::Op op) {
+  switch (op) {
+    case ColumnPredicate::kLessThan:
+      return ColumnPredicate::kGreaterThan;
+    case ColumnPredicate::kLessThanEqual:
+      return ColumnPredicate::kGreaterThanEqual;
+    case ColumnPredicate::kGreaterThan:
+      return ColumnPredicate::kLessThan;
+    case ColumnPredicate::kGreaterThanEqual:
+      return ColumnPredicate::kLessThanEqual;
+    default:
+      return op;
+  }
+}
+
+std::optional<table_store::internal::ZoneMapValue> LiteralToZoneMapValue(
+    const plan::ScalarValue& literal, types::DataType col_type) {
+  if (literal.IsNull()) {
+    return std::nullopt;
+  }
+  switch (col_type) {
+    case types::DataType::INT64:
+    case types::DataType::TIME64NS:
+      if (literal.DataType() == types::DataType::INT64) {
+        return literal.Int64Value();
+      }
+      if (literal.DataType() == types::DataType::TIME64NS) {
+        return literal.Time64NSValue();
+      }
+      return std::nullopt;
+    case types::DataType::UINT128:
+      if (literal.DataType() == types::DataType::UINT128) {
+        return literal.UInt128Value();
+      }
+      return std::nullopt;
+    default:
+      return std::nullopt;
+  }
+}
+
+// Adds a ColumnPredicate for every `col op literal` term of the conjunction in `expr`. Terms that
+// can't be expressed as a ColumnPredicate are ignored, which is always safe since the predicates
+// are only used to skip batches.
+void ExtractColumnPredicates(const plan::ScalarExpression& expr,
+                             const std::vector<int64_t>& source_cols,
+                             const table_store::schema::RowDescriptor& output_descriptor,
+                             std::vector<ColumnPredicate>* predicates) {
+  if (expr.ExpressionType() != plan::Expression::kFunc) {
+    return;
+  }
+  const auto& func = static_cast<const plan::ScalarFunc&>(expr);
+  const auto& args = func.arg_deps();
+  if (func.name() == "logicalAnd") {
+    for (const auto& arg : args) {
+      ExtractColumnPredicates(*arg, source_cols, output_descriptor, predicates);
+    }
+    return;
+  }
+  auto op = ComparisonOp(func.name());
+  if (!op.has_value() || args.size() != 2) {
+    return;
+  }
+
+  const plan::ScalarExpression* col_expr = args[0].get();
+  const plan::ScalarExpression* literal_expr = args[1].get();
+  if (col_expr->ExpressionType() == plan::Expression::kConstant &&
+      literal_expr->ExpressionType() == plan::Expression::kColumn) {
+    std::swap(col_expr, literal_expr);
+    op = FlipOp(op.value());
+  }
+  if (col_expr->ExpressionType() != plan::Expression::kColumn ||
+      literal_expr->ExpressionType() != plan::Expression::kConstant) {
+    return;
+  }
+
+  auto col_idx = static_cast<const plan::Column*>(col_expr)->Index();
+  if (col_idx < 0 || static_cast<size_t>(col_idx) >= source_cols.size()) {
+    return;
+  }
+  auto col_type = output_descriptor.type(col_idx);
+  auto value =
+      LiteralToZoneMapValue(*static_cast<const plan::ScalarValue*>(literal_expr), col_type);
+  if (!value.has_value()) {
+    return;
+  }
+  predicates->push_back(ColumnPredicate{source_cols[col_idx], op.value(), value.value()});
+}
+
+}  // namespace
 
 std::string MemorySourceNode::DebugStringImpl() {
   return absl::Substitute("Exec::MemorySourceNode: <name: $0, output: $1>", plan_node_->TableName(),
@@ -51,6 +170,18 @@ Status MemorySourceNode::InitImpl(const plan::Operator& plan_node) {
 
 Status MemorySourceNode::PrepareImpl(ExecState*) { return Status::OK(); }
 
+void MemorySourceNode::UseResultCache(ResultCacheSession* session) {
+  DCHECK(cursor_ == nullptr) << "The result cache must be used before the node is opened";
+  DCHECK(!plan_node_->streaming());
+  result_cache_session_ = session;
+}
+
+void MemorySourceNode::PushDownFilter(const plan::FilterOperator& filter) {
+  DCHECK(cursor_ == nullptr) << "Filters must be pushed down before the node is opened";
+  ExtractColumnPredicates(*filter.expression(), plan_node_->Columns(), *output_descriptor_,
+                          &predicates_);
+}
+
 Status MemorySourceNode::OpenImpl(ExecState* exec_state) {
   table_ = exec_state->table_store()->GetTable(plan_node_->TableName(), plan_node_->Tablet());
   DCHECK(table_ != nullptr);
@@ -61,6 +192,21 @@ Status MemorySourceNode::OpenImpl(ExecState* exec_state) {
     return error::NotFound("Table '$0' not found", plan_node_->TableName());
   }
 
+  if (result_cache_session_ != nullptr) {
+    read_cols_ = plan_node_->Columns();
+    auto table_time_col = table_->GetRelation().GetColumnIndex("time_");
+    auto it = std::find(read_cols_.begin(), read_cols_.end(), table_time_col);
+    time_col_idx_ = it - read_cols_.begin();
+    if (it == read_cols_.end()) {
+      read_cols_.push_back(table_time_col);
+    }
+    // If all of the buckets of the query are cached, there is nothing to read.
+    if (!result_cache_session_->uncached_ranges().empty()) {
+      cursor_ = CreateRangeCursor(0);
+    }
+    return Status::OK();
+  }
+
   StartSpec start_spec;
   if (plan_node_->HasStartTime()) {
     start_spec.type = StartSpec::StartType::StartAtTime;
@@ -85,19 +231,61 @@ Status MemorySourceNode::OpenImpl(ExecState* exec_state) {
       stop_spec.type = StopSpec::StopType::CurrentEndOfTable;
     }
   }
-  cursor_ = std::make_unique<Table::Cursor>(table_, start_spec, stop_spec);
+  cursor_ = std::make_unique<Table::Cursor>(table_, start_spec, stop_spec, predicates_);
+  // Dictionary encoded string columns are passed on as is. The nodes that can't handle them decode
+  // them (see ExecNode::ConsumesDictionaryColumns), while filters and aggregates work on the codes.
+  cursor_->set_keep_dictionary_columns(true);
 
   return Status::OK();
 }
 
+std::unique_ptr<Table::Cursor> MemorySourceNode::CreateRangeCursor(size_t range_idx) {
+  const auto& range = result_cache_session_->uncached_ranges()[range_idx];
+  StartSpec start_spec;
+  if (range.start != std::numeric_limits<int64_t>::min()) {
+    start_spec.type = StartSpec::StartType::StartAtTime;
+    start_spec.start_time = range.start;
+  }
+  StopSpec stop_spec;
+  if (range.stop != std::numeric_limits<int64_t>::max()) {
+    stop_spec.type = StopSpec::StopType::StopAtTimeOrEndOfTable;
+    stop_spec.stop_time = range.stop;
+  }
+  auto cursor = std::make_unique<Table::Cursor>(table_, start_spec, stop_spec, predicates_);
+  cursor->set_keep_dictionary_columns(true);
+  return cursor;
+}
+
 Status MemorySourceNode::CloseImpl(ExecState*) {
   stats()->AddExtraInfo("streaming", streaming_ ? "true" : "false");
+  if (result_cache_session_ != nullptr) {
+    stats()->AddExtraInfo("result_cache_uncached_ranges",
+                          std::to_string(result_cache_session_->uncached_ranges().size()));
+  }
+  if (!predicates_.empty()) {
+    std::vector<std::string> predicate_strs;
+    for (const auto& predicate : predicates_) {
+      predicate_strs.push_back(predicate.DebugString());
+    }
+    stats()->AddExtraInfo("pushed_down_predicates", absl::StrJoin(predicate_strs, " && "));
+  }
   return Status::OK();
 }
 
-StatusOr<std::unique_ptr<RowBatch>> MemorySourceNode::GetNextRowBatch(ExecState*) {
+StatusOr<std::unique_ptr<RowBatch>> MemorySourceNode::GetNextRowBatch(ExecState* exec_state) {
   DCHECK(table_ != nullptr);
 
+  if (result_cache_session_ != nullptr) {
+    if (cursor_ == nullptr) {
+      return RowBatch::WithZeroRows(*output_descriptor_, /* eow */ true, /* eos */ true);
+    }
+    // Move on to the next uncached range once the current one is read.
+    auto num_ranges = result_cache_session_->uncached_ranges().size();
+    while (cursor_->Done() && range_idx_ + 1 < num_ranges) {
+      cursor_ = CreateRangeCursor(++range_idx_);
+    }
+  }
+
   if (!cursor_->NextBatchReady()) {
     // If the NextBatch is not ready, but the cursor is not yet exhausted, then we need to output
     // 0-row row batches, while we wait for more data to be added. This currently only occurs in the
@@ -108,7 +296,11 @@ StatusOr<std::unique_ptr<RowBatch>> MemorySourceNode::GetNextRowBatch(ExecState*
                                   /* eos */ cursor_->Done());
   }
 
-  PX_ASSIGN_OR_RETURN(auto row_batch, cursor_->GetNextRowBatch(plan_node_->Columns()));
+  PX_ASSIGN_OR_RETURN(auto row_batch,
+                      cursor_->GetNextRowBatch(result_cache_session_ == nullptr
+                                                   ? plan_node_->Columns()
+                                                   : read_cols_,
+                                               exec_state->exec_mem_pool()));
 
   rows_processed_ += row_batch->num_rows();
   bytes_processed_ += row_batch->NumBytes();
@@ -116,7 +308,9 @@ StatusOr<std::unique_ptr<RowBatch>> MemorySourceNode::GetNextRowBatch(ExecState*
   // If infinite stream is set, we don't send Eow or Eos. Infinite streams therefore never cause
   // HasBatchesRemaining to be false. Instead the outer loop that calls GenerateNext() is
   // responsible for managing whether we continue the stream or end it.
-  if (cursor_->Done()) {
+  bool last_range = result_cache_session_ == nullptr ||
+                    range_idx_ + 1 == result_cache_session_->uncached_ranges().size();
+  if (cursor_->Done() && last_range) {
     row_batch->set_eow(true);
     row_batch->set_eos(true);
   }
@@ -125,10 +319,58 @@ StatusOr<std::unique_ptr<RowBatch>> MemorySourceNode::GetNextRowBatch(ExecState*
 
 Status MemorySourceNode::GenerateNextImpl(ExecState* exec_state) {
   PX_ASSIGN_OR_RETURN(auto row_batch, GetNextRowBatch(exec_state));
+  if (result_cache_session_ != nullptr) {
+    return SendBucketsToChildren(exec_state, *row_batch);
+  }
   PX_RETURN_IF_ERROR(SendRowBatchToChildren(exec_state, *row_batch));
   return Status::OK();
 }
 
+Status MemorySourceNode::SendBucketsToChildren(ExecState* exec_state, const RowBatch& rb) {
+  // Slices rows [offset, offset + length) of the output columns, leaving out the time column if it
+  // was only read to find the buckets.
+  auto output_slice = [&](int64_t offset, int64_t length, bool last) -> StatusOr<RowBatch> {
+    RowBatch output_rb(*output_descriptor_, length);
+    for (size_t i = 0; i < output_descriptor_->size(); ++i) {
+      PX_RETURN_IF_ERROR(output_rb.AddColumn(rb.ColumnAt(i)->Slice(offset, length)));
+    }
+    output_rb.set_eow(last && rb.eow());
+    output_rb.set_eos(last && rb.eos());
+    return output_rb;
+  };
+
+  auto num_rows = rb.num_rows();
+  if (num_rows == 0) {
+    PX_ASSIGN_OR_RETURN(auto output_rb, output_slice(0, 0, /* last */ true));
+    return SendRowBatchToChildren(exec_state, output_rb);
+  }
+
+  auto time_col = rb.ColumnAt(time_col_idx_);
+  auto bucket_of_row = [&](int64_t row_idx) {
+    return result_cache_session_->BucketStart(
+        types::GetValueFromArrowArray<types::TIME64NS>(time_col.get(), row_idx));
+  };
+  // The aggregate decides which buckets are complete once it gets eos, so the newest time has to
+  // be known before the last row batch is sent.
+  result_cache_session_->UpdateMaxTime(
+      types::GetValueFromArrowArray<types::TIME64NS>(time_col.get(), num_rows - 1));
+
+  // Rows are read in time order, so the rows of each bucket are contiguous.
+  int64_t begin = 0;
+  while (begin < num_rows) {
+    auto bucket = bucket_of_row(begin);
+    auto end = begin + 1;
+    while (end < num_rows && bucket_of_row(end) == bucket) {
+      ++end;
+    }
+    PX_ASSIGN_OR_RETURN(auto output_rb, output_slice(begin, end - begin, end == num_rows));
+    result_cache_session_->SetCurrentBucket(bucket);
+    PX_RETURN_IF_ERROR(SendRowBatchToChildren(exec_state, output_rb));
+    begin = end;
+  }
+  return Status::OK();
+}
+
 bool MemorySourceNode::InfiniteStreamNextBatchReady() { return cursor_->NextBatchReady(); }
 
 bool MemorySourceNode::NextBatchReady() {
@@ -25,6 +25,7 @@
 
 #include "src/carnot/exec/exec_node.h"
 #include "src/carnot/exec/exec_state.h"
+#include "src/carnot/exec/result_cache.h"
 #include "src/carnot/plan/operators.h"
 #include "src/common/base/base.h"
 #include "src/common/base/status.h"
@@ -46,6 +47,28 @@ class MemorySourceNode : public SourceNode {
 
   bool NextBatchReady() override;
 
+  /**
+   * PushDownFilter extracts the simple column comparisons from the filter's expression (`col op
+   * literal` terms of a conjunction on INT64, TIME64NS and UINT128 columns) and uses them as
+   * predicates for the table cursor, so that batches that can't match the filter are never read.
+   * Must be called before the node is opened, and only if the filter is the only consumer of this
+   * node. The filter still needs to be evaluated on the returned batches.
+   * @param filter the filter operator directly downstream of this memory source.
+   */
+  void PushDownFilter(const plan::FilterOperator& filter);
+
+  /**
+   * Makes the memory source read only the time ranges of the session that aren't cached, and send
+   * the rows of every time bucket in separate row batches, setting the session's current bucket
+   * before sending them. Must be called before the node is opened.
+   * @param session the result cache session of the pipeline that this memory source is the head of.
+   */
+  void UseResultCache(ResultCacheSession* session);
+
+  // Whether this memory source will stream future results, rather than stopping at the end of the
+  // table.
+  bool streaming() const { return plan_node_->streaming(); }
+
  protected:
   std::string DebugStringImpl() override;
   Status InitImpl(const plan::Operator& plan_node) override;
@@ -57,13 +80,28 @@ class MemorySourceNode : public SourceNode {
  private:
   StatusOr<std::unique_ptr<RowBatch>> GetNextRowBatch(ExecState* exec_state);
   bool InfiniteStreamNextBatchReady();
+  std::unique_ptr<Table::Cursor> CreateRangeCursor(size_t range_idx);
+  // Sends the rows of each time bucket of the row batch in a separate row batch.
+  Status SendBucketsToChildren(ExecState* exec_state, const RowBatch& rb);
   // Whether this memory source will stream future results.
   bool streaming_ = false;
 
   std::unique_ptr<Table::Cursor> cursor_;
+  std::vector<Table::ColumnPredicate> predicates_;
 
   std::unique_ptr<plan::MemorySourceOperator> plan_node_;
   table_store::Table* table_ = nullptr;
+
+  // Variables specific to reading through the result cache.
+  ResultCacheSession* result_cache_session_ = nullptr;
+  // The range of the session's uncached ranges that cursor_ reads.
+  size_t range_idx_ = 0;
+  // The columns read from the table. The time column is read after the output columns if it isn't
+  // one of them.
+  std::vector<int64_t> read_cols_;
+  // The index of the time column in read_cols_.
+  int64_t time_col_idx_ = -1;
+  // END: Variables specific to reading through the result cache.
 };
 
 }  // namespace exec
@@ -0,0 +1,162 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/memory_tracker.h"
+
+#include <algorithm>
+#include <limits>
+
+DEFINE_int64(carnot_query_memory_limit_bytes,
+             gflags::Int64FromEnv("PL_CARNOT_QUERY_MEMORY_LIMIT_BYTES", 0),
+             "The number of bytes that a single query can hold in row batches, hash tables and "
+             "aggregate states before it fails. 0 disables the limit.");
+DEFINE_int64(carnot_node_memory_limit_bytes,
+             gflags::Int64FromEnv("PL_CARNOT_NODE_MEMORY_LIMIT_BYTES", 0),
+             "The number of bytes that all of the queries of a Carnot instance can hold at once. "
+             "Queries are queued while the queries in flight leave less than a query's limit, and "
+             "fail if they hit it. 0 disables the limit.");
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+MemoryTracker::~MemoryTracker() { DetachFromParent(); }
+
+void MemoryTracker::DetachFromParent() {
+  absl::base_internal::SpinLockHolder lock(&lock_);
+  if (parent_ != nullptr) {
+    parent_->Release(bytes_.load());
+    parent_.reset();
+  }
+}
+
+Status MemoryTracker::Consume(int64_t bytes) {
+  absl::base_internal::SpinLockHolder lock(&lock_);
+  int64_t new_bytes = bytes_.load() + bytes;
+  if (limit_bytes_ > 0 && new_bytes > limit_bytes_) {
+    return error::ResourceUnavailable(
+        "$0 exceeded its memory limit of $1 bytes, $2 bytes are in use and $3 more were requested.",
+        name_, limit_bytes_, new_bytes - bytes, bytes);
+  }
+  if (parent_ != nullptr) {
+    PX_RETURN_IF_ERROR(parent_->Consume(bytes));
+  }
+  bytes_.store(new_bytes);
+  if (new_bytes > peak_bytes_.load()) {
+    peak_bytes_.store(new_bytes);
+  }
+  return Status::OK();
+}
+
+void MemoryTracker::Release(int64_t bytes) {
+  absl::base_internal::SpinLockHolder lock(&lock_);
+  bytes_.fetch_sub(bytes);
+  if (parent_ != nullptr) {
+    parent_->Release(bytes);
+  }
+}
+
+int64_t MemoryTracker::available_bytes() const {
+  int64_t available = std::numeric_limits<int64_t>::max();
+  if (limit_bytes_ > 0) {
+    available = std::max<int64_t>(0, limit_bytes_ - bytes_.load());
+  }
+  absl::base_internal::SpinLockHolder lock(&lock_);
+  if (parent_ != nullptr) {
+    available = std::min(available, parent_->available_bytes());
+  }
+  return available;
+}
+
+Status MemoryReservation::Resize(int64_t bytes) {
+  if (tracker_ == nullptr) {
+    return Status::OK();
+  }
+  if (bytes > bytes_) {
+    PX_RETURN_IF_ERROR(tracker_->Consume(bytes - bytes_));
+  } else {
+    tracker_->Release(bytes_ - bytes);
+  }
+  bytes_ = bytes;
+  return Status::OK();
+}
+
+arrow::Status TrackingMemoryPool::Allocate(int64_t size, uint8_t** out) {
+  auto s = tracker_->Consume(size);
+  if (!s.ok()) {
+    return arrow::Status::OutOfMemory(s.msg());
+  }
+  auto arrow_s = parent_->Allocate(size, out);
+  if (!arrow_s.ok()) {
+    tracker_->Release(size);
+    return arrow_s;
+  }
+  refs_.fetch_add(1);
+  int64_t allocated = bytes_allocated_.fetch_add(size) + size;
+  int64_t max_memory = max_memory_.load();
+  while (allocated > max_memory && !max_memory_.compare_exchange_weak(max_memory, allocated)) {
+  }
+  return arrow::Status::OK();
+}
+
+arrow::Status TrackingMemoryPool::Reallocate(int64_t old_size, int64_t new_size, uint8_t** ptr) {
+  int64_t delta = new_size - old_size;
+  if (delta > 0) {
+    auto s = tracker_->Consume(delta);
+    if (!s.ok()) {
+      return arrow::Status::OutOfMemory(s.msg());
+    }
+  }
+  auto arrow_s = parent_->Reallocate(old_size, new_size, ptr);
+  if (!arrow_s.ok()) {
+    if (delta > 0) {
+      tracker_->Release(delta);
+    }
+    return arrow_s;
+  }
+  if (delta < 0) {
+    tracker_->Release(-delta);
+  }
+  int64_t allocated = bytes_allocated_.fetch_add(delta) + delta;
+  int64_t max_memory = max_memory_.load();
+  while (allocated > max_memory && !max_memory_.compare_exchange_weak(max_memory, allocated)) {
+  }
+  return arrow::Status::OK();
+}
+
+void TrackingMemoryPool::Free(uint8_t* buffer, int64_t size) {
+  parent_->Free(buffer, size);
+  tracker_->Release(size);
+  bytes_allocated_.fetch_sub(size);
+  Unref();
+}
+
+void TrackingMemoryPool::ReleaseOwner() {
+  tracker_->DetachFromParent();
+  Unref();
+}
+
+void TrackingMemoryPool::Unref() {
+  if (refs_.fetch_sub(1) == 1) {
+    delete this;
+  }
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,172 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <arrow/memory_pool.h>
+#include <absl/base/internal/spinlock.h>
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "src/common/base/base.h"
+
+DECLARE_int64(carnot_query_memory_limit_bytes);
+DECLARE_int64(carnot_node_memory_limit_bytes);
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+/**
+ * MemoryTracker accounts the bytes used by a query, or by all the queries of a Carnot instance,
+ * against a limit. A tracker with a parent also consumes the bytes from its parent, so that a
+ * query is stopped when either its own limit or the limit of the Carnot instance is hit.
+ *
+ * MemoryTracker is thread safe.
+ */
+class MemoryTracker : public NotCopyable {
+ public:
+  /**
+   * @param name the name of the tracker, used in error messages.
+   * @param limit_bytes the number of bytes that can be consumed at once, or 0 for no limit.
+   * @param parent the tracker that the bytes are also consumed from, or nullptr.
+   */
+  MemoryTracker(std::string name, int64_t limit_bytes,
+                std::shared_ptr<MemoryTracker> parent = nullptr)
+      : name_(std::move(name)), limit_bytes_(limit_bytes), parent_(std::move(parent)) {}
+
+  /**
+   * Returns the bytes that are still consumed to the parent.
+   */
+  ~MemoryTracker();
+
+  /**
+   * Returns the bytes consumed so far to the parent, and stops consuming from it. The bytes that
+   * are consumed afterwards only count against the limit of this tracker.
+   */
+  void DetachFromParent();
+
+  /**
+   * Consumes bytes from this tracker and its parents.
+   * @return ResourceUnavailable, without consuming anything, if a limit would be exceeded.
+   */
+  Status Consume(int64_t bytes);
+  void Release(int64_t bytes);
+
+  int64_t bytes() const { return bytes_.load(); }
+  int64_t peak_bytes() const { return peak_bytes_.load(); }
+  int64_t limit_bytes() const { return limit_bytes_; }
+
+  /**
+   * @return the number of bytes that can be consumed before this tracker or one of its parents
+   * hits its limit, or std::numeric_limits<int64_t>::max() if none of them has a limit.
+   */
+  int64_t available_bytes() const;
+
+ private:
+  const std::string name_;
+  const int64_t limit_bytes_;
+  // Held while bytes are consumed or released, so that they go to the parent as long as it's
+  // attached, and are returned to it exactly once.
+  mutable absl::base_internal::SpinLock lock_;
+  std::shared_ptr<MemoryTracker> parent_ ABSL_GUARDED_BY(lock_);
+  std::atomic<int64_t> bytes_ = 0;
+  std::atomic<int64_t> peak_bytes_ = 0;
+};
+
+/**
+ * MemoryReservation is the memory that an exec node holds outside of the exec memory pool, such as
+ * its hash tables and aggregate states, consumed from the tracker of the query. The node resizes
+ * the reservation as its state grows, and resizes it to 0 when it's closed.
+ */
+class MemoryReservation : public NotCopyable {
+ public:
+  explicit MemoryReservation(MemoryTracker* tracker = nullptr) : tracker_(tracker) {}
+
+  void set_tracker(MemoryTracker* tracker) {
+    DCHECK_EQ(bytes_, 0);
+    tracker_ = tracker;
+  }
+
+  /**
+   * Consumes or releases the difference with the current size of the reservation.
+   * @return ResourceUnavailable, leaving the reservation unchanged, if the query would exceed its
+   * memory limit.
+   */
+  Status Resize(int64_t bytes);
+
+  int64_t bytes() const { return bytes_; }
+
+ private:
+  MemoryTracker* tracker_;
+  int64_t bytes_ = 0;
+};
+
+/**
+ * TrackingMemoryPool is the arrow memory pool of a query. It allocates from the default memory
+ * pool, and consumes every allocation from the tracker of the query, so that the row batches of a
+ * query can't grow past its memory limit.
+ *
+ * Arrays allocated by a query can outlive it, for instance in the tables of memory sinks. Arrow
+ * buffers point to the pool they are freed to, so the pool isn't deleted by its owner. The owner
+ * calls Unref() instead, and the pool deletes itself once every allocation was freed. Once the
+ * owner is gone the query no longer counts against the Carnot instance, so Unref() also detaches
+ * the tracker of the query from its parent.
+ */
+class TrackingMemoryPool : public arrow::MemoryPool {
+ public:
+  /**
+   * @param tracker the tracker of the query, which is owned by the pool.
+   */
+  explicit TrackingMemoryPool(std::unique_ptr<MemoryTracker> tracker)
+      : tracker_(std::move(tracker)) {}
+
+  arrow::Status Allocate(int64_t size, uint8_t** out) override;
+  arrow::Status Reallocate(int64_t old_size, int64_t new_size, uint8_t** ptr) override;
+  void Free(uint8_t* buffer, int64_t size) override;
+
+  int64_t bytes_allocated() const override { return bytes_allocated_.load(); }
+  int64_t max_memory() const override { return max_memory_.load(); }
+
+  MemoryTracker* tracker() const { return tracker_.get(); }
+
+  /**
+   * Releases the reference of the owner of the pool, and detaches the tracker of the query from
+   * its parent.
+   */
+  void ReleaseOwner();
+
+ private:
+  void Unref();
+
+  ~TrackingMemoryPool() override = default;
+
+  arrow::MemoryPool* const parent_ = arrow::default_memory_pool();
+  const std::unique_ptr<MemoryTracker> tracker_;
+  // One reference for the owner, and one for every allocation that wasn't freed yet.
+  std::atomic<int64_t> refs_ = 1;
+  std::atomic<int64_t> bytes_allocated_ = 0;
+  std::atomic<int64_t> max_memory_ = 0;
+};
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,122 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/memory_tracker.h"
+
+#include <arrow/buffer.h>
+
+#include <limits>
+#include <memory>
+
+#include <gtest/gtest.h>
+
+#include "src/common/testing/testing.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+TEST(MemoryTrackerTest, limit) {
+  MemoryTracker tracker("query", 100);
+  EXPECT_OK(tracker.Consume(60));
+  EXPECT_EQ(40, tracker.available_bytes());
+  EXPECT_NOT_OK(tracker.Consume(50));
+  EXPECT_EQ(60, tracker.bytes());
+
+  tracker.Release(30);
+  EXPECT_OK(tracker.Consume(50));
+  EXPECT_EQ(80, tracker.bytes());
+  EXPECT_EQ(80, tracker.peak_bytes());
+}
+
+TEST(MemoryTrackerTest, parent_limit) {
+  auto node_tracker = std::make_shared<MemoryTracker>("node", 100);
+  {
+    MemoryTracker query_a("query a", 80, node_tracker);
+    MemoryTracker query_b("query b", 0, node_tracker);
+    EXPECT_OK(query_a.Consume(70));
+    EXPECT_EQ(30, query_b.available_bytes());
+    // Query b has no limit of its own, but the node is out of memory.
+    EXPECT_NOT_OK(query_b.Consume(40));
+    EXPECT_EQ(0, query_b.bytes());
+    EXPECT_OK(query_b.Consume(30));
+    EXPECT_EQ(100, node_tracker->bytes());
+  }
+  // The bytes of the queries are returned to the node once they're done.
+  EXPECT_EQ(0, node_tracker->bytes());
+  EXPECT_EQ(std::numeric_limits<int64_t>::max(),
+            MemoryTracker("unlimited", 0).available_bytes());
+}
+
+TEST(MemoryTrackerTest, reservation) {
+  MemoryTracker tracker("query", 100);
+  MemoryReservation reservation(&tracker);
+  EXPECT_OK(reservation.Resize(50));
+  EXPECT_OK(reservation.Resize(90));
+  EXPECT_EQ(90, tracker.bytes());
+  EXPECT_NOT_OK(reservation.Resize(120));
+  EXPECT_EQ(90, reservation.bytes());
+  EXPECT_OK(reservation.Resize(0));
+  EXPECT_EQ(0, tracker.bytes());
+}
+
+TEST(TrackingMemoryPoolTest, allocations_are_tracked) {
+  auto node_tracker = std::make_shared<MemoryTracker>("node", 0);
+  auto pool = new TrackingMemoryPool(std::make_unique<MemoryTracker>("query", 1024, node_tracker));
+
+  uint8_t* data = nullptr;
+  ASSERT_TRUE(pool->Allocate(512, &data).ok());
+  EXPECT_EQ(512, pool->tracker()->bytes());
+  ASSERT_TRUE(pool->Reallocate(512, 768, &data).ok());
+  EXPECT_EQ(768, pool->bytes_allocated());
+  EXPECT_EQ(768, node_tracker->bytes());
+
+  uint8_t* too_large = nullptr;
+  EXPECT_TRUE(pool->Allocate(512, &too_large).IsOutOfMemory());
+  EXPECT_EQ(768, pool->tracker()->bytes());
+
+  pool->Free(data, 768);
+  EXPECT_EQ(0, pool->bytes_allocated());
+  EXPECT_EQ(768, pool->max_memory());
+  pool->ReleaseOwner();
+  EXPECT_EQ(0, node_tracker->bytes());
+}
+
+TEST(TrackingMemoryPoolTest, buffers_outlive_owner) {
+  auto node_tracker = std::make_shared<MemoryTracker>("node", 0);
+  auto pool = new TrackingMemoryPool(std::make_unique<MemoryTracker>("query", 0, node_tracker));
+  std::shared_ptr<arrow::Buffer> buffer;
+  std::shared_ptr<arrow::Buffer> other_buffer;
+  ASSERT_TRUE(arrow::AllocateBuffer(pool, 256, &buffer).ok());
+  auto* query_tracker = pool->tracker();
+  pool->ReleaseOwner();
+  // The pool is kept alive by the buffer, but the query is done so the buffer no longer counts
+  // against the node.
+  EXPECT_EQ(256, query_tracker->bytes());
+  EXPECT_EQ(0, node_tracker->bytes());
+  ASSERT_TRUE(arrow::AllocateBuffer(pool, 128, &other_buffer).ok());
+  EXPECT_EQ(384, query_tracker->bytes());
+  EXPECT_EQ(0, node_tracker->bytes());
+  buffer.reset();
+  other_buffer.reset();
+  EXPECT_EQ(0, node_tracker->bytes());
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,175 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#include "src/carnot/exec/morsel_exchange_node.h"
+
+#include <utility>
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+using table_store::schema::RowBatch;
+
+MorselExchangeNode::MorselExchangeNode(std::vector<std::vector<ExecNode*>> worker_pipelines,
+                                       AggNode* merge_agg, MorselExecutor* executor)
+    : merge_agg_(merge_agg), executor_(executor) {
+  for (auto& pipeline : worker_pipelines) {
+    DCHECK(!pipeline.empty());
+    auto worker = std::make_unique<Worker>();
+    worker->agg = static_cast<AggNode*>(pipeline.back());
+    worker->pipeline = std::move(pipeline);
+    workers_.push_back(std::move(worker));
+  }
+}
+
+MorselExchangeNode::~MorselExchangeNode() {
+  // The workers are normally stopped by Close, this only matters if the query failed before that.
+  // Tasks that are still queued on the executor must finish before the workers are destroyed.
+  auto s = StopWorkers();
+  PX_UNUSED(s);
+}
+
+std::string MorselExchangeNode::DebugStringImpl() {
+  return absl::Substitute("Exec::MorselExchangeNode<workers=$0>", workers_.size());
+}
+
+Status MorselExchangeNode::InitImpl(const plan::Operator&) {
+  // The plan node is the head of the pipeline, which this node passes its row batches to
+  // unchanged.
+  if (input_descriptors_.size() != 1) {
+    return error::InvalidArgument("Morsel exchange expects a single input relation, got $0",
+                                  input_descriptors_.size());
+  }
+  if (workers_.empty()) {
+    return error::InvalidArgument("Morsel exchange needs at least one worker");
+  }
+  return Status::OK();
+}
+
+Status MorselExchangeNode::PrepareImpl(ExecState* exec_state) {
+  for (const auto& worker : workers_) {
+    for (auto* node : worker->pipeline) {
+      PX_RETURN_IF_ERROR(node->Prepare(exec_state));
+    }
+  }
+  return Status::OK();
+}
+
+Status MorselExchangeNode::OpenImpl(ExecState* exec_state) {
+  for (const auto& worker : workers_) {
+    for (auto* node : worker->pipeline) {
+      PX_RETURN_IF_ERROR(node->Open(exec_state));
+    }
+  }
+  return Status::OK();
+}
+
+Status MorselExchangeNode::CloseImpl(ExecState* exec_state) {
+  Status status = StopWorkers();
+  for (const auto& worker : workers_) {
+    for (auto* node : worker->pipeline) {
+      auto s = node->Close(exec_state);
+      if (status.ok() && !s.ok()) {
+        status = s;
+      }
+    }
+  }
+  return status;
+}
+
+Status MorselExchangeNode::ConsumeNextImpl(ExecState* exec_state, const RowBatch& rb, size_t) {
+  if (rb.num_rows() > 0) {
+    auto morsel = std::make_shared<RowBatch>(rb);
+    // The worker pipelines never see the end of the stream, their states are merged instead.
+    morsel->set_eow(false);
+    morsel->set_eos(false);
+
+    Worker* worker = workers_[next_worker_].get();
+    next_worker_ = (next_worker_ + 1) % workers_.size();
+    absl::MutexLock lock(&worker->lock);
+    worker->lock.Await(absl::Condition(
+        +[](Worker* w) ABSL_EXCLUSIVE_LOCKS_REQUIRED(w->lock) {
+          return w->failed || w->morsels.size() < kMaxQueuedMorsels;
+        },
+        worker));
+    if (worker->failed) {
+      return worker->status;
+    }
+    worker->morsels.push_back(std::move(morsel));
+    if (!worker->running) {
+      worker->running = true;
+      executor_->Schedule([this, exec_state, worker] { RunWorker(exec_state, worker); });
+    }
+  }
+
+  if (!rb.eos()) {
+    return Status::OK();
+  }
+
+  PX_RETURN_IF_ERROR(StopWorkers());
+  for (const auto& worker : workers_) {
+    PX_RETURN_IF_ERROR(merge_agg_->MergeFrom(exec_state, worker->agg));
+  }
+  PX_ASSIGN_OR_RETURN(auto eos_rb,
+                      RowBatch::WithZeroRows(*output_descriptor_, /*eow*/ true, /*eos*/ true));
+  return SendRowBatchToChildren(exec_state, *eos_rb);
+}
+
+void MorselExchangeNode::RunWorker(ExecState* exec_state, Worker* worker) {
+  while (true) {
+    std::shared_ptr<RowBatch> morsel;
+    {
+      absl::MutexLock lock(&worker->lock);
+      if (worker->morsels.empty()) {
+        worker->running = false;
+        return;
+      }
+      morsel = std::move(worker->morsels.front());
+      worker->morsels.pop_front();
+    }
+
+    auto s = worker->pipeline.front()->ConsumeNext(exec_state, *morsel, /*parent_index*/ 0);
+    if (!s.ok()) {
+      absl::MutexLock lock(&worker->lock);
+      worker->status = s;
+      worker->failed = true;
+      worker->morsels.clear();
+      worker->running = false;
+      return;
+    }
+  }
+}
+
+Status MorselExchangeNode::StopWorkers() {
+  Status status;
+  for (const auto& worker : workers_) {
+    absl::MutexLock lock(&worker->lock);
+    worker->lock.Await(absl::Condition(
+        +[](Worker* w) ABSL_EXCLUSIVE_LOCKS_REQUIRED(w->lock) { return !w->running; }, worker.get()));
+    if (status.ok() && !worker->status.ok()) {
+      status = worker->status;
+    }
+  }
+  return status;
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,112 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <absl/base/thread_annotations.h>
+#include <absl/synchronization/mutex.h>
+
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "src/carnot/exec/agg_node.h"
+#include "src/carnot/exec/exec_node.h"
+#include "src/carnot/exec/exec_state.h"
+#include "src/carnot/exec/morsel_executor.h"
+#include "src/carnot/plan/operators.h"
+#include "src/common/base/base.h"
+#include "src/table_store/table_store.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+/**
+ * MorselExchangeNode runs a pipeline of Map and Filter nodes, ending in a blocking AggNode, on the
+ * threads of a MorselExecutor. It sits between a memory source and the head of the pipeline.
+ *
+ * Every worker owns its own copy of the pipeline. The row batches (morsels) from the source are
+ * dispatched to the workers round robin, so the morsels a worker sees only depend on the order of
+ * the source's batches and not on thread timing. Every worker pre-aggregates its morsels in its
+ * own AggNode. At end of stream, the worker AggNodes are merged, in worker order, into the AggNode
+ * of the original pipeline, and a zero row end of stream batch is sent down the original pipeline
+ * so that it emits the merged results to the rest of the graph.
+ *
+ * While a worker has morsels queued, a single task on the executor runs them through the worker's
+ * pipeline. So a pipeline never runs on two threads at once, and a worker doesn't hold on to a
+ * thread while it waits for morsels.
+ */
+class MorselExchangeNode : public ProcessingNode {
+ public:
+  /**
+   * @param worker_pipelines the pipeline of every worker, from the node that consumes the morsels
+   * down to the AggNode. The nodes must be initialized, and are prepared, opened and closed by
+   * this node.
+   * @param merge_agg the AggNode of the original pipeline, which the worker states are merged into.
+   * @param executor the executor to run the worker pipelines on.
+   */
+  MorselExchangeNode(std::vector<std::vector<ExecNode*>> worker_pipelines, AggNode* merge_agg,
+                     MorselExecutor* executor);
+  virtual ~MorselExchangeNode();
+
+  size_t num_workers() const { return workers_.size(); }
+
+ protected:
+  std::string DebugStringImpl() override;
+  Status InitImpl(const plan::Operator& plan_node) override;
+  Status PrepareImpl(ExecState* exec_state) override;
+  Status OpenImpl(ExecState* exec_state) override;
+  Status CloseImpl(ExecState* exec_state) override;
+  Status ConsumeNextImpl(ExecState* exec_state, const table_store::schema::RowBatch& rb,
+                         size_t parent_index) override;
+
+ private:
+  // Max number of morsels waiting for a worker, per worker, before the source is blocked.
+  static constexpr size_t kMaxQueuedMorsels = 4;
+
+  struct Worker {
+    std::vector<ExecNode*> pipeline;
+    AggNode* agg;
+
+    absl::Mutex lock;
+    std::deque<std::shared_ptr<table_store::schema::RowBatch>> morsels ABSL_GUARDED_BY(lock);
+    // Set while a task of the executor runs the queued morsels.
+    bool running ABSL_GUARDED_BY(lock) = false;
+    // Set, along with status, when the pipeline returned an error. The worker then stops
+    // consuming morsels.
+    bool failed ABSL_GUARDED_BY(lock) = false;
+    Status status ABSL_GUARDED_BY(lock);
+  };
+
+  // Runs the worker's queued morsels, until there are none left.
+  void RunWorker(ExecState* exec_state, Worker* worker);
+  // Waits for the workers to finish their queued morsels, and returns the first error of a worker.
+  Status StopWorkers();
+
+  std::vector<std::unique_ptr<Worker>> workers_;
+  AggNode* merge_agg_;
+  MorselExecutor* executor_;
+  // The worker that the next morsel is dispatched to.
+  size_t next_worker_ = 0;
+};
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,77 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/morsel_executor.h"
+
+#include <utility>
+
+DEFINE_int32(carnot_exec_threads, gflags::Int32FromEnv("PL_CARNOT_EXEC_THREADS", 1),
+             "The number of threads, shared by all queries, that aggregation pipelines run on. "
+             "Memory source batches are dispatched round robin to the pipelines, which "
+             "pre-aggregate them before their results are merged. 1 runs queries on the calling "
+             "thread only.");
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+MorselExecutor::MorselExecutor(size_t num_threads) {
+  DCHECK_GT(num_threads, 0U);
+  for (size_t i = 0; i < num_threads; ++i) {
+    threads_.emplace_back(&MorselExecutor::ThreadLoop, this);
+  }
+}
+
+MorselExecutor::~MorselExecutor() {
+  {
+    absl::MutexLock lock(&lock_);
+    stopped_ = true;
+  }
+  for (auto& thread : threads_) {
+    thread.join();
+  }
+}
+
+void MorselExecutor::Schedule(std::function<void()> task) {
+  absl::MutexLock lock(&lock_);
+  tasks_.push_back(std::move(task));
+}
+
+void MorselExecutor::ThreadLoop() {
+  while (true) {
+    std::function<void()> task;
+    {
+      absl::MutexLock lock(&lock_);
+      lock_.Await(absl::Condition(
+          +[](MorselExecutor* executor) ABSL_EXCLUSIVE_LOCKS_REQUIRED(executor->lock_) {
+            return executor->stopped_ || !executor->tasks_.empty();
+          },
+          this));
+      if (stopped_) {
+        return;
+      }
+      task = std::move(tasks_.front());
+      tasks_.pop_front();
+    }
+    task();
+  }
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
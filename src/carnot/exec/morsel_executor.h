@@ -0,0 +1,73 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <absl/base/thread_annotations.h>
+#include <absl/synchronization/mutex.h>
+
+#include <deque>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include "src/common/base/base.h"
+
+DECLARE_int32(carnot_exec_threads);
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+/**
+ * MorselExecutor is a fixed size pool of threads that runs the parallel pipelines of every query
+ * of a Carnot instance (see MorselExchangeNode), so that the number of threads doesn't grow with
+ * the number of queries in flight.
+ *
+ * Tasks run in the order they are scheduled. A task must not block waiting for another task,
+ * since there might not be a free thread to run it on.
+ */
+class MorselExecutor : public NotCopyable {
+ public:
+  explicit MorselExecutor(size_t num_threads);
+
+  /**
+   * Waits for the tasks that are running. Tasks that haven't started yet are dropped.
+   */
+  ~MorselExecutor();
+
+  /**
+   * Queues a task to run on one of the threads.
+   */
+  void Schedule(std::function<void()> task);
+
+  size_t num_threads() const { return threads_.size(); }
+
+ private:
+  void ThreadLoop();
+
+  absl::Mutex lock_;
+  std::deque<std::function<void()>> tasks_ ABSL_GUARDED_BY(lock_);
+  bool stopped_ ABSL_GUARDED_BY(lock_) = false;
+
+  std::vector<std::thread> threads_;
+};
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
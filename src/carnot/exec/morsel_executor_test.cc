@@ -0,0 +1,58 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <absl/container/flat_hash_set.h>
+#include <absl/synchronization/blocking_counter.h>
+#include <absl/synchronization/mutex.h>
+
+#include <thread>
+
+#include "src/carnot/exec/morsel_executor.h"
+#include "src/common/testing/testing.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+TEST(MorselExecutorTest, runs_tasks_on_its_threads) {
+  constexpr int kNumTasks = 100;
+  MorselExecutor executor(2);
+  EXPECT_EQ(2U, executor.num_threads());
+
+  absl::Mutex lock;
+  absl::flat_hash_set<std::thread::id> thread_ids;
+  absl::BlockingCounter done(kNumTasks);
+  for (int i = 0; i < kNumTasks; ++i) {
+    executor.Schedule([&] {
+      {
+        absl::MutexLock l(&lock);
+        thread_ids.insert(std::this_thread::get_id());
+      }
+      done.DecrementCount();
+    });
+  }
+  done.Wait();
+
+  absl::MutexLock l(&lock);
+  EXPECT_LE(thread_ids.size(), 2U);
+  EXPECT_FALSE(thread_ids.contains(std::this_thread::get_id()));
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,192 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/rebatch_node.h"
+
+#include <arrow/array/concatenate.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+
+DEFINE_int64(carnot_target_batch_bytes, gflags::Int64FromEnv("PL_CARNOT_TARGET_BATCH_BYTES", 0),
+             "The number of bytes that the row batches of memory sources are coalesced or split "
+             "to before the rest of the query processes them. The target is then tuned to the "
+             "throughput of the query. -1 uses half of the L2 cache, 0 leaves batches as they are "
+             "in the table.");
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+using table_store::schema::RowBatch;
+
+namespace {
+// Used when the size of the L2 cache can't be read.
+constexpr int64_t kDefaultL2CacheBytes = 256 * 1024;
+}  // namespace
+
+int64_t BatchSizer::InitialTargetBytesFromFlags() {
+  if (FLAGS_carnot_target_batch_bytes >= 0) {
+    return FLAGS_carnot_target_batch_bytes;
+  }
+  int64_t l2_bytes = sysconf(_SC_LEVEL2_CACHE_SIZE);
+  if (l2_bytes <= 0) {
+    l2_bytes = kDefaultL2CacheBytes;
+  }
+  // Leave the other half of the cache to the state of the nodes, such as hash tables.
+  return l2_bytes / 2;
+}
+
+void BatchSizer::Record(int64_t bytes, int64_t elapsed_ns) {
+  ++window_batches_;
+  window_bytes_ += bytes;
+  window_ns_ += elapsed_ns;
+  if (window_batches_ < kWindowBatches) {
+    return;
+  }
+  double throughput = static_cast<double>(window_bytes_) / std::max<int64_t>(1, window_ns_);
+  if (throughput < last_throughput_) {
+    growing_ = !growing_;
+  }
+  last_throughput_ = throughput;
+  window_batches_ = 0;
+  window_bytes_ = 0;
+  window_ns_ = 0;
+
+  auto target = static_cast<int64_t>(growing_ ? target_bytes_ * kStep : target_bytes_ / kStep);
+  target_bytes_ = std::clamp(target, min_target_bytes_, max_target_bytes_);
+}
+
+std::string RebatchNode::DebugStringImpl() {
+  return absl::Substitute("Exec::RebatchNode<target_bytes=$0>", sizer_.target_bytes());
+}
+
+Status RebatchNode::InitImpl(const plan::Operator&) {
+  // The plan node is the source, whose row batches this node passes on resized.
+  if (input_descriptors_.size() != 1) {
+    return error::InvalidArgument("Rebatch expects a single input relation, got $0",
+                                  input_descriptors_.size());
+  }
+  if (sizer_.target_bytes() <= 0) {
+    return error::InvalidArgument("Rebatch needs a positive target batch size, got $0",
+                                  sizer_.target_bytes());
+  }
+  return Status::OK();
+}
+
+Status RebatchNode::PrepareImpl(ExecState*) { return Status::OK(); }
+
+Status RebatchNode::OpenImpl(ExecState*) { return Status::OK(); }
+
+Status RebatchNode::CloseImpl(ExecState*) {
+  pending_.clear();
+  pending_bytes_ = 0;
+  stats()->AddExtraMetric("target_batch_bytes", sizer_.target_bytes());
+  return Status::OK();
+}
+
+Status RebatchNode::ConsumeNextImpl(ExecState* exec_state, const RowBatch& rb, size_t) {
+  int64_t bytes = rb.NumBytes();
+  if (bytes >= sizer_.target_bytes()) {
+    PX_RETURN_IF_ERROR(SendPending(exec_state, /*eow*/ false, /*eos*/ false));
+    return SendSplit(exec_state, rb, bytes);
+  }
+  if (rb.num_rows() > 0) {
+    pending_.push_back(std::make_shared<RowBatch>(rb));
+    pending_bytes_ += bytes;
+  }
+  if (pending_bytes_ >= sizer_.target_bytes() || rb.eow()) {
+    return SendPending(exec_state, rb.eow(), rb.eos());
+  }
+  return Status::OK();
+}
+
+Status RebatchNode::Flush(ExecState* exec_state) {
+  return SendPending(exec_state, /*eow*/ false, /*eos*/ false);
+}
+
+Status RebatchNode::SendPending(ExecState* exec_state, bool eow, bool eos) {
+  if (pending_.empty()) {
+    if (!eow) {
+      return Status::OK();
+    }
+    PX_ASSIGN_OR_RETURN(auto rb, RowBatch::WithZeroRows(*output_descriptor_, eow, eos));
+    return Send(exec_state, *rb, 0);
+  }
+
+  std::shared_ptr<RowBatch> out;
+  if (pending_.size() == 1) {
+    out = pending_.front();
+  } else {
+    int64_t num_rows = 0;
+    for (const auto& rb : pending_) {
+      num_rows += rb->num_rows();
+    }
+    out = std::make_shared<RowBatch>(*output_descriptor_, num_rows);
+    for (int64_t i = 0; i < out->num_columns(); ++i) {
+      arrow::ArrayVector cols;
+      cols.reserve(pending_.size());
+      for (const auto& rb : pending_) {
+        cols.push_back(rb->ColumnAt(i));
+      }
+      std::shared_ptr<arrow::Array> col;
+      PX_RETURN_IF_ERROR(arrow::Concatenate(cols, exec_state->exec_mem_pool(), &col));
+      PX_RETURN_IF_ERROR(out->AddColumn(col));
+    }
+  }
+  int64_t bytes = pending_bytes_;
+  pending_.clear();
+  pending_bytes_ = 0;
+  out->set_eow(eow);
+  out->set_eos(eos);
+  return Send(exec_state, *out, bytes);
+}
+
+Status RebatchNode::SendSplit(ExecState* exec_state, const RowBatch& rb, int64_t bytes) {
+  int64_t target_bytes = sizer_.target_bytes();
+  if (bytes <= 2 * target_bytes) {
+    return Send(exec_state, rb, bytes);
+  }
+  // Assume that the rows are of similar size.
+  int64_t num_slices = (bytes + target_bytes - 1) / target_bytes;
+  int64_t rows_per_slice = std::max<int64_t>(1, (rb.num_rows() + num_slices - 1) / num_slices);
+  for (int64_t offset = 0; offset < rb.num_rows(); offset += rows_per_slice) {
+    int64_t length = std::min(rows_per_slice, rb.num_rows() - offset);
+    PX_ASSIGN_OR_RETURN(auto slice, rb.Slice(offset, length));
+    bool last = offset + length == rb.num_rows();
+    slice->set_eow(last && rb.eow());
+    slice->set_eos(last && rb.eos());
+    PX_RETURN_IF_ERROR(Send(exec_state, *slice, bytes * length / rb.num_rows()));
+  }
+  return Status::OK();
+}
+
+Status RebatchNode::Send(ExecState* exec_state, const RowBatch& rb, int64_t bytes) {
+  auto start = std::chrono::steady_clock::now();
+  PX_RETURN_IF_ERROR(SendRowBatchToChildren(exec_state, rb));
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  if (rb.num_rows() > 0) {
+    sizer_.Record(bytes, std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+  }
+  return Status::OK();
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,129 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "src/carnot/exec/exec_node.h"
+#include "src/carnot/exec/exec_state.h"
+#include "src/carnot/plan/operators.h"
+#include "src/common/base/base.h"
+#include "src/table_store/table_store.h"
+
+DECLARE_int64(carnot_target_batch_bytes);
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+/**
+ * BatchSizer picks the number of bytes that a RebatchNode makes its row batches. It starts at an
+ * initial target and hill climbs it, within [initial / 4, initial * 2], towards the target at
+ * which the nodes downstream process the most bytes per second: every kWindowBatches batches, the
+ * target keeps moving in the same direction if the throughput went up, and reverses if it went
+ * down.
+ */
+class BatchSizer {
+ public:
+  static constexpr int64_t kWindowBatches = 16;
+  static constexpr double kStep = 1.25;
+
+  explicit BatchSizer(int64_t initial_target_bytes)
+      : target_bytes_(initial_target_bytes),
+        min_target_bytes_(std::max<int64_t>(1, initial_target_bytes / 4)),
+        max_target_bytes_(initial_target_bytes * 2) {}
+
+  /**
+   * @return the target for the size of the first batches, from --carnot_target_batch_bytes, or 0
+   * if batches shouldn't be resized.
+   */
+  static int64_t InitialTargetBytesFromFlags();
+
+  int64_t target_bytes() const { return target_bytes_; }
+
+  /**
+   * Records that a batch of the given size took elapsed_ns to be processed downstream.
+   */
+  void Record(int64_t bytes, int64_t elapsed_ns);
+
+ private:
+  int64_t target_bytes_;
+  const int64_t min_target_bytes_;
+  const int64_t max_target_bytes_;
+  bool growing_ = true;
+
+  int64_t window_batches_ = 0;
+  int64_t window_bytes_ = 0;
+  int64_t window_ns_ = 0;
+  // The bytes per second of the last window, or 0 before the first one.
+  double last_throughput_ = 0;
+};
+
+/**
+ * RebatchNode sits below a memory source and resizes the source's row batches to the target of
+ * its BatchSizer before they are passed on to the rest of the graph. Small batches, such as the
+ * few row batches that a streaming query over a quiet table reads, are held and concatenated until
+ * they reach the target, and batches larger than twice the target are sliced, so that the batches
+ * that the nodes downstream work on stay in cache.
+ *
+ * Batches are never concatenated across the end of a window. The graph calls Flush whenever the
+ * source runs out of data, so that held rows aren't delayed while the query waits for more.
+ */
+class RebatchNode : public ProcessingNode {
+ public:
+  explicit RebatchNode(int64_t initial_target_bytes) : sizer_(initial_target_bytes) {}
+  virtual ~RebatchNode() = default;
+
+  /**
+   * Sends the held row batches to the children, concatenated into one.
+   */
+  Status Flush(ExecState* exec_state);
+
+  const BatchSizer& sizer() const { return sizer_; }
+
+ protected:
+  std::string DebugStringImpl() override;
+  Status InitImpl(const plan::Operator& plan_node) override;
+  Status PrepareImpl(ExecState* exec_state) override;
+  Status OpenImpl(ExecState* exec_state) override;
+  Status CloseImpl(ExecState* exec_state) override;
+  Status ConsumeNextImpl(ExecState* exec_state, const table_store::schema::RowBatch& rb,
+                         size_t parent_index) override;
+
+ private:
+  // Sends the held row batches concatenated into one, with the given eow and eos. Only sends a
+  // zero row batch if eow is set.
+  Status SendPending(ExecState* exec_state, bool eow, bool eos);
+  // Sends the row batch, and records how long the children took to process its bytes.
+  Status Send(ExecState* exec_state, const table_store::schema::RowBatch& rb, int64_t bytes);
+  // Sends the row batch, sliced into batches of about the target size if it's more than twice
+  // the target.
+  Status SendSplit(ExecState* exec_state, const table_store::schema::RowBatch& rb, int64_t bytes);
+
+  BatchSizer sizer_;
+  std::vector<std::shared_ptr<table_store::schema::RowBatch>> pending_;
+  int64_t pending_bytes_ = 0;
+};
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,167 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/rebatch_node.h"
+
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <sole.hpp>
+
+#include "src/carnot/exec/test_utils.h"
+#include "src/carnot/planpb/test_proto.h"
+#include "src/carnot/udf/registry.h"
+#include "src/common/testing/testing.h"
+#include "src/shared/types/types.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+using table_store::schema::RowDescriptor;
+using types::Int64Value;
+
+// Rows of two INT64 columns are 16 bytes, so batches are coalesced or split to 4 rows.
+constexpr int64_t kTargetBytes = 64;
+
+class RebatchNodeTest : public ::testing::Test {
+ public:
+  RebatchNodeTest() {
+    plan_node_ = plan::MemorySourceOperator::FromProto(planpb::testutils::CreateTestSource1PB(), 1);
+    func_registry_ = std::make_unique<udf::Registry>("test_registry");
+    auto table_store = std::make_shared<table_store::TableStore>();
+    exec_state_ = std::make_unique<ExecState>(func_registry_.get(), table_store,
+                                              MockResultSinkStubGenerator, MockMetricsStubGenerator,
+                                              MockTraceStubGenerator, sole::uuid4(), nullptr);
+  }
+
+ protected:
+  RowDescriptor rd_{types::DataType::INT64, types::DataType::INT64};
+  std::unique_ptr<plan::Operator> plan_node_;
+  std::unique_ptr<ExecState> exec_state_;
+  std::unique_ptr<udf::Registry> func_registry_;
+};
+
+TEST_F(RebatchNodeTest, coalesce_small_batches) {
+  auto tester = exec::ExecNodeTester<RebatchNode, plan::MemorySourceOperator>(
+      *plan_node_, rd_, {rd_}, exec_state_.get(), kTargetBytes);
+  tester
+      .ConsumeNext(RowBatchBuilder(rd_, 1, /*eow*/ false, /*eos*/ false)
+                       .AddColumn<Int64Value>({1})
+                       .AddColumn<Int64Value>({10})
+                       .get(),
+                   0, 0)
+      .ConsumeNext(RowBatchBuilder(rd_, 2, /*eow*/ false, /*eos*/ false)
+                       .AddColumn<Int64Value>({2, 3})
+                       .AddColumn<Int64Value>({20, 30})
+                       .get(),
+                   0, 0)
+      .ConsumeNext(RowBatchBuilder(rd_, 1, /*eow*/ false, /*eos*/ false)
+                       .AddColumn<Int64Value>({4})
+                       .AddColumn<Int64Value>({40})
+                       .get(),
+                   0, 1)
+      .ExpectRowBatch(RowBatchBuilder(rd_, 4, /*eow*/ false, /*eos*/ false)
+                          .AddColumn<Int64Value>({1, 2, 3, 4})
+                          .AddColumn<Int64Value>({10, 20, 30, 40})
+                          .get())
+      .ConsumeNext(RowBatchBuilder(rd_, 1, /*eow*/ false, /*eos*/ false)
+                       .AddColumn<Int64Value>({5})
+                       .AddColumn<Int64Value>({50})
+                       .get(),
+                   0, 0)
+      // The end of the window is sent as soon as it's received, along with the held rows.
+      .ConsumeNext(RowBatchBuilder(rd_, 0, /*eow*/ true, /*eos*/ true)
+                       .AddColumn<Int64Value>({})
+                       .AddColumn<Int64Value>({})
+                       .get(),
+                   0, 1)
+      .ExpectRowBatch(RowBatchBuilder(rd_, 1, /*eow*/ true, /*eos*/ true)
+                          .AddColumn<Int64Value>({5})
+                          .AddColumn<Int64Value>({50})
+                          .get())
+      .Close();
+}
+
+TEST_F(RebatchNodeTest, split_large_batch) {
+  auto tester = exec::ExecNodeTester<RebatchNode, plan::MemorySourceOperator>(
+      *plan_node_, rd_, {rd_}, exec_state_.get(), kTargetBytes);
+  tester
+      .ConsumeNext(RowBatchBuilder(rd_, 1, /*eow*/ false, /*eos*/ false)
+                       .AddColumn<Int64Value>({0})
+                       .AddColumn<Int64Value>({0})
+                       .get(),
+                   0, 0)
+      // The held row is sent on its own, rather than concatenated with a batch that is already
+      // large enough.
+      .ConsumeNext(RowBatchBuilder(rd_, 10, /*eow*/ true, /*eos*/ true)
+                       .AddColumn<Int64Value>({1, 2, 3, 4, 5, 6, 7, 8, 9, 10})
+                       .AddColumn<Int64Value>({10, 20, 30, 40, 50, 60, 70, 80, 90, 100})
+                       .get(),
+                   0, 4)
+      .ExpectRowBatch(RowBatchBuilder(rd_, 1, /*eow*/ false, /*eos*/ false)
+                          .AddColumn<Int64Value>({0})
+                          .AddColumn<Int64Value>({0})
+                          .get())
+      .ExpectRowBatch(RowBatchBuilder(rd_, 4, /*eow*/ false, /*eos*/ false)
+                          .AddColumn<Int64Value>({1, 2, 3, 4})
+                          .AddColumn<Int64Value>({10, 20, 30, 40})
+                          .get())
+      .ExpectRowBatch(RowBatchBuilder(rd_, 4, /*eow*/ false, /*eos*/ false)
+                          .AddColumn<Int64Value>({5, 6, 7, 8})
+                          .AddColumn<Int64Value>({50, 60, 70, 80})
+                          .get())
+      .ExpectRowBatch(RowBatchBuilder(rd_, 2, /*eow*/ true, /*eos*/ true)
+                          .AddColumn<Int64Value>({9, 10})
+                          .AddColumn<Int64Value>({90, 100})
+                          .get())
+      .Close();
+}
+
+TEST(BatchSizerTest, follows_throughput) {
+  BatchSizer sizer(1000);
+  auto record_window = [&](int64_t ns_per_byte) {
+    for (int64_t i = 0; i < BatchSizer::kWindowBatches; ++i) {
+      sizer.Record(sizer.target_bytes(), sizer.target_bytes() * ns_per_byte);
+    }
+  };
+
+  // Grows while the throughput goes up.
+  record_window(10);
+  EXPECT_EQ(1250, sizer.target_bytes());
+  record_window(5);
+  EXPECT_EQ(1562, sizer.target_bytes());
+  // And shrinks once it goes down.
+  record_window(8);
+  EXPECT_EQ(1249, sizer.target_bytes());
+}
+
+TEST(BatchSizerTest, clamped_to_initial_target) {
+  BatchSizer sizer(1000);
+  for (int64_t ns_per_byte = 100; ns_per_byte > 80; --ns_per_byte) {
+    for (int64_t i = 0; i < BatchSizer::kWindowBatches; ++i) {
+      sizer.Record(sizer.target_bytes(), sizer.target_bytes() * ns_per_byte);
+    }
+  }
+  EXPECT_EQ(2000, sizer.target_bytes());
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,278 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/result_cache.h"
+
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl_lite.h>
+
+#include <utility>
+
+#include <absl/strings/str_cat.h>
+
+#include "src/carnot/planpb/plan.pb.h"
+
+DEFINE_int64(carnot_result_cache_bytes,
+             gflags::Int64FromEnv("PL_CARNOT_RESULT_CACHE_BYTES", 0),
+             "The number of bytes of partial aggregate states that Carnot keeps to reuse in later "
+             "queries that aggregate the same table over an overlapping time range. 0 disables "
+             "the result cache.");
+DEFINE_int64(carnot_result_cache_bucket_ns,
+             gflags::Int64FromEnv("PL_CARNOT_RESULT_CACHE_BUCKET_NS", 10'000'000'000),
+             "The width of the time buckets that the result cache keeps partial aggregate states "
+             "for. Queries only reuse the buckets that are fully inside their time range.");
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+using table_store::Table;
+using table_store::schema::RowBatch;
+
+namespace {
+
+// Clears the IDs that a plan assigns to its nodes, UDFs and UDAs, which can differ between two
+// compilations of the same query.
+void ClearPlanIDs(google::protobuf::Message* msg) {
+  const auto* descriptor = msg->GetDescriptor();
+  if (descriptor == planpb::Column::descriptor()) {
+    static_cast<planpb::Column*>(msg)->clear_node();
+    return;
+  }
+  if (descriptor == planpb::ScalarFunc::descriptor()) {
+    static_cast<planpb::ScalarFunc*>(msg)->clear_id();
+  } else if (descriptor == planpb::AggregateExpression::descriptor()) {
+    static_cast<planpb::AggregateExpression*>(msg)->clear_id();
+  }
+
+  const auto* reflection = msg->GetReflection();
+  std::vector<const google::protobuf::FieldDescriptor*> fields;
+  reflection->ListFields(*msg, &fields);
+  for (const auto* field : fields) {
+    if (field->cpp_type() != google::protobuf::FieldDescriptor::CPPTYPE_MESSAGE) {
+      continue;
+    }
+    if (!field->is_repeated()) {
+      ClearPlanIDs(reflection->MutableMessage(msg, field));
+      continue;
+    }
+    for (int i = 0; i < reflection->FieldSize(*msg, field); ++i) {
+      ClearPlanIDs(reflection->MutableRepeatedMessage(msg, field, i));
+    }
+  }
+}
+
+void AppendCanonicalOperator(planpb::OperatorType op_type, google::protobuf::Message* msg,
+                             std::string* key) {
+  ClearPlanIDs(msg);
+  std::string serialized;
+  {
+    google::protobuf::io::StringOutputStream stream(&serialized);
+    google::protobuf::io::CodedOutputStream coded(&stream);
+    coded.SetSerializationDeterministic(true);
+    msg->SerializeToCodedStream(&coded);
+  }
+  absl::StrAppend(key, op_type, ":", serialized.size(), ":", serialized);
+}
+
+}  // namespace
+
+ResultCache::ResultCache(int64_t max_bytes, int64_t bucket_ns)
+    : max_bytes_(max_bytes), bucket_ns_(bucket_ns) {
+  CHECK_GT(bucket_ns_, 0);
+}
+
+std::string ResultCache::PipelineKey(const plan::MemorySourceOperator& source,
+                                     const std::vector<const plan::Operator*>& ops) {
+  std::string key;
+  auto source_pb = source.pb();
+  source_pb.clear_start_time();
+  source_pb.clear_stop_time();
+  AppendCanonicalOperator(planpb::MEMORY_SOURCE_OPERATOR, &source_pb, &key);
+  for (const auto* op : ops) {
+    switch (op->op_type()) {
+      case planpb::MAP_OPERATOR: {
+        auto pb = static_cast<const plan::MapOperator*>(op)->pb();
+        AppendCanonicalOperator(op->op_type(), &pb, &key);
+        break;
+      }
+      case planpb::FILTER_OPERATOR: {
+        auto pb = static_cast<const plan::FilterOperator*>(op)->pb();
+        AppendCanonicalOperator(op->op_type(), &pb, &key);
+        break;
+      }
+      case planpb::AGGREGATE_OPERATOR: {
+        auto pb = static_cast<const plan::AggregateOperator*>(op)->pb();
+        AppendCanonicalOperator(op->op_type(), &pb, &key);
+        break;
+      }
+      default:
+        LOG(DFATAL) << "Unexpected operator in a result cache pipeline: " << op->DebugString();
+    }
+  }
+  return key;
+}
+
+int64_t ResultCache::BucketStart(int64_t time) const {
+  // Round down, also for times before the epoch.
+  auto rem = time % bucket_ns_;
+  if (rem < 0) {
+    rem += bucket_ns_;
+  }
+  return time - rem;
+}
+
+std::vector<ResultCache::Bucket> ResultCache::Lookup(const std::string& key, const Table* table,
+                                                     int64_t start_time, int64_t stop_time) {
+  std::vector<Bucket> buckets;
+  absl::MutexLock lock(&mu_);
+  auto it = entries_.find(key);
+  if (it == entries_.end()) {
+    return buckets;
+  }
+  auto& entry = it->second;
+
+  // Rows expire from the table in order, so only the oldest buckets can have lost rows.
+  auto first_row_id = table->FirstRowID();
+  while (!entry.buckets.empty() && entry.buckets.begin()->second.first_row_id < first_row_id) {
+    EraseBucket(&entry, entry.buckets.begin());
+  }
+  if (entry.buckets.empty()) {
+    lru_.erase(entry.lru_pos);
+    entries_.erase(it);
+    return buckets;
+  }
+  lru_.splice(lru_.begin(), lru_, entry.lru_pos);
+
+  for (auto bucket_it = entry.buckets.lower_bound(start_time); bucket_it != entry.buckets.end();) {
+    if (bucket_it->first > stop_time - (bucket_ns_ - 1)) {
+      break;
+    }
+    // The table got a late row of the bucket after it was read.
+    const auto& bucket = bucket_it->second;
+    if (table->MinTimeWrittenOutOfOrderSince(bucket.generation) < bucket.start + bucket_ns_) {
+      EraseBucket(&entry, bucket_it++);
+      continue;
+    }
+    buckets.push_back(bucket);
+    ++bucket_it;
+  }
+  return buckets;
+}
+
+void ResultCache::Insert(const std::string& key, Bucket bucket) {
+  auto bytes = bucket.states->NumBytes();
+  if (bytes > max_bytes_) {
+    return;
+  }
+  absl::MutexLock lock(&mu_);
+  auto [it, inserted] = entries_.try_emplace(key);
+  auto& entry = it->second;
+  if (inserted) {
+    lru_.push_front(key);
+    entry.lru_pos = lru_.begin();
+  } else {
+    lru_.splice(lru_.begin(), lru_, entry.lru_pos);
+  }
+
+  auto bucket_it = entry.buckets.find(bucket.start);
+  if (bucket_it != entry.buckets.end()) {
+    EraseBucket(&entry, bucket_it);
+  }
+  entry.bytes += bytes;
+  bytes_ += bytes;
+  entry.buckets.emplace(bucket.start, std::move(bucket));
+  EvictUnlocked(key);
+}
+
+void ResultCache::EraseBucket(Entry* entry, std::map<int64_t, Bucket>::iterator it) {
+  auto bytes = it->second.states->NumBytes();
+  entry->bytes -= bytes;
+  bytes_ -= bytes;
+  entry->buckets.erase(it);
+}
+
+void ResultCache::EvictUnlocked(const std::string& keep_key) {
+  // Evict whole pipelines, least recently used first, before the oldest buckets of the pipeline
+  // that is being inserted into.
+  while (bytes_ > max_bytes_ && lru_.back() != keep_key) {
+    auto it = entries_.find(lru_.back());
+    bytes_ -= it->second.bytes;
+    entries_.erase(it);
+    lru_.pop_back();
+  }
+  auto& entry = entries_.at(keep_key);
+  while (bytes_ > max_bytes_ && !entry.buckets.empty()) {
+    EraseBucket(&entry, entry.buckets.begin());
+  }
+}
+
+ResultCacheSession::ResultCacheSession(ResultCache* cache, std::string key, const Table* table,
+                                       int64_t start_time, int64_t stop_time)
+    : cache_(cache),
+      table_(table),
+      generation_(table->generation()),
+      key_(std::move(key)),
+      start_time_(start_time),
+      stop_time_(stop_time) {
+  cached_buckets_ = cache_->Lookup(key_, table_, start_time_, stop_time_);
+  // The rows that aren't in cached buckets are in the gaps between them.
+  auto range_start = start_time_;
+  for (const auto& bucket : cached_buckets_) {
+    if (bucket.start > range_start) {
+      uncached_ranges_.push_back({range_start, bucket.start - 1});
+    }
+    range_start = bucket.start + cache_->bucket_ns();
+  }
+  if (range_start <= stop_time_) {
+    uncached_ranges_.push_back({range_start, stop_time_});
+  }
+}
+
+void ResultCacheSession::SetCurrentBucket(int64_t bucket_start) {
+  if (!has_current_bucket_ || bucket_start != current_bucket_) {
+    ++misses_;
+  }
+  current_bucket_ = bucket_start;
+  has_current_bucket_ = true;
+}
+
+bool ResultCacheSession::IsComplete(int64_t bucket_start) const {
+  auto bucket_ns = cache_->bucket_ns();
+  return bucket_start >= start_time_ && bucket_start <= stop_time_ - (bucket_ns - 1) &&
+         max_time_ >= bucket_start + bucket_ns;
+}
+
+void ResultCacheSession::AddBucket(int64_t bucket_start, std::shared_ptr<const RowBatch> states) {
+  // Rows of the bucket might have been written out of order since the rows were read.
+  if (table_->MinTimeWrittenOutOfOrderSince(generation_) < bucket_start + cache_->bucket_ns()) {
+    return;
+  }
+  // Unless the table still has a row older than the bucket, some of the bucket's rows might have
+  // expired before they were read.
+  auto first_row_id = table_->FindRowIDFromTimeFirstGreaterThanOrEqual(bucket_start);
+  if (first_row_id <= table_->FirstRowID()) {
+    return;
+  }
+  cache_->Insert(key_,
+                 ResultCache::Bucket{bucket_start, first_row_id, generation_, std::move(states)});
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
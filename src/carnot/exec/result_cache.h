@@ -0,0 +1,219 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <limits>
+#include <list>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <absl/base/thread_annotations.h>
+#include <absl/container/node_hash_map.h>
+#include <absl/synchronization/mutex.h>
+
+#include "src/carnot/plan/operators.h"
+#include "src/common/base/base.h"
+#include "src/table_store/schema/row_batch.h"
+#include "src/table_store/table/table.h"
+
+DECLARE_int64(carnot_result_cache_bytes);
+DECLARE_int64(carnot_result_cache_bucket_ns);
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+/**
+ * ResultCache keeps the partial aggregate states of the blocking aggregates that read a memory
+ * source table through a chain of maps and filters, one set of states per fixed size time bucket
+ * of the table. A query that runs the same pipeline over a time range that overlaps an earlier
+ * query, such as a script polled with a relative start time, merges the cached buckets instead of
+ * aggregating their rows again, and only reads the rows of the buckets that aren't cached.
+ *
+ * Only complete buckets are cached: buckets that were fully inside the time range of the query
+ * that computed them, and older than a row that the query read. While rows are appended to the
+ * table in time order these buckets don't change anymore, until their rows expire. Every bucket
+ * records the generation of the table that its rows were read in. A bucket is dropped once the
+ * table gets a row out of time order since that generation that is older than the end of the
+ * bucket, so a late row is never missing from a cached bucket, while late rows of newer buckets
+ * don't invalidate it. Buckets of another table with the same name are dropped the same way.
+ * A bucket is dropped once the table's first row ID passes the first row ID of the bucket.
+ *
+ * Pipelines whose functions aren't deterministic, like the metadata functions, aren't cached.
+ *
+ * ResultCache is shared by all of the queries of a Carnot instance and is thread safe.
+ */
+class ResultCache : public NotCopyable {
+ public:
+  struct Bucket {
+    // The start time of the bucket, a multiple of bucket_ns().
+    int64_t start;
+    // The ID of the first row of the table with a time in the bucket.
+    table_store::Table::RowID first_row_id;
+    // The generation of the table when the rows of the bucket were read.
+    int64_t generation;
+    // The serialized partial aggregate states of the bucket, in the format of the output of an
+    // aggregate that doesn't finalize its results: the group columns followed by a string column
+    // of serialized states for every aggregate expression.
+    std::shared_ptr<const table_store::schema::RowBatch> states;
+  };
+
+  ResultCache(int64_t max_bytes, int64_t bucket_ns);
+
+  /**
+   * Returns the key of the given pipeline. The key is the same for two compilations of the same
+   * pipeline, irrespective of the time range of the memory source and of the IDs the plan assigns
+   * to its nodes and functions.
+   * @param source The memory source at the head of the pipeline.
+   * @param ops The maps and filters of the pipeline, in order, followed by its aggregate.
+   */
+  static std::string PipelineKey(const plan::MemorySourceOperator& source,
+                                 const std::vector<const plan::Operator*>& ops);
+
+  /**
+   * Returns the cached buckets of the pipeline that are fully inside [start_time, stop_time], in
+   * order. Buckets whose rows started expiring from the table, or that the table got late rows for,
+   * are dropped.
+   */
+  std::vector<Bucket> Lookup(const std::string& key, const table_store::Table* table,
+                             int64_t start_time, int64_t stop_time);
+
+  /**
+   * Caches the states of a complete bucket of the pipeline. The least recently used pipelines are
+   * evicted to stay within max_bytes.
+   */
+  void Insert(const std::string& key, Bucket bucket);
+
+  int64_t bucket_ns() const { return bucket_ns_; }
+  int64_t BucketStart(int64_t time) const;
+
+  int64_t bytes() const {
+    absl::MutexLock lock(&mu_);
+    return bytes_;
+  }
+
+ private:
+  struct Entry {
+    std::map<int64_t, Bucket> buckets;
+    int64_t bytes = 0;
+    // The position of the key in lru_.
+    std::list<std::string>::iterator lru_pos;
+  };
+
+  void EraseBucket(Entry* entry, std::map<int64_t, Bucket>::iterator it)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  void EvictUnlocked(const std::string& keep_key) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const int64_t max_bytes_;
+  const int64_t bucket_ns_;
+
+  mutable absl::Mutex mu_;
+  absl::node_hash_map<std::string, Entry> entries_ ABSL_GUARDED_BY(mu_);
+  // The keys of entries_, from the most to the least recently used.
+  std::list<std::string> lru_ ABSL_GUARDED_BY(mu_);
+  int64_t bytes_ ABSL_GUARDED_BY(mu_) = 0;
+};
+
+/**
+ * ResultCacheSession is the use of the ResultCache by one pipeline of a query. The memory source
+ * of the pipeline only reads the time ranges that aren't cached, and sends the rows of each bucket
+ * in separate row batches, setting the current bucket before sending them. The aggregate of the
+ * pipeline keeps the states of every bucket apart, caches the complete ones, and merges the cached
+ * buckets into its results.
+ *
+ * Batches are sent down the pipeline synchronously, so the aggregate can rely on the current bucket
+ * when it consumes a row batch.
+ */
+class ResultCacheSession : public NotCopyable {
+ public:
+  struct TimeRange {
+    // Inclusive bounds. The start is std::numeric_limits<int64_t>::min() if the range starts at the
+    // start of the table, the stop is std::numeric_limits<int64_t>::max() if it ends at the end.
+    int64_t start;
+    int64_t stop;
+  };
+
+  /**
+   * Looks up the cached buckets of the pipeline for a query over [start_time, stop_time], in the
+   * current generation of the table.
+   */
+  ResultCacheSession(ResultCache* cache, std::string key, const table_store::Table* table,
+                     int64_t start_time, int64_t stop_time);
+
+  int64_t BucketStart(int64_t time) const { return cache_->BucketStart(time); }
+
+  // The time ranges of the query that aren't covered by cached buckets, in order.
+  const std::vector<TimeRange>& uncached_ranges() const { return uncached_ranges_; }
+  // The cached buckets of the query, in order.
+  const std::vector<ResultCache::Bucket>& cached_buckets() const { return cached_buckets_; }
+
+  /**
+   * Sets the bucket of the rows that are sent down the pipeline next. Rows are read in time order,
+   * so the buckets are set in increasing order.
+   */
+  void SetCurrentBucket(int64_t bucket_start);
+  int64_t current_bucket() const { return current_bucket_; }
+
+  /**
+   * Records the time of the newest row read from the table.
+   */
+  void UpdateMaxTime(int64_t time) { max_time_ = std::max(max_time_, time); }
+
+  /**
+   * @return whether the bucket that starts at the given time can be cached: it is fully inside the
+   * time range of the query, and newer rows were read from the table.
+   */
+  bool IsComplete(int64_t bucket_start) const;
+
+  /**
+   * Caches the states of a complete bucket, unless some of its rows were already expired or the
+   * table got rows of the bucket out of time order since the lookup.
+   */
+  void AddBucket(int64_t bucket_start,
+                 std::shared_ptr<const table_store::schema::RowBatch> states);
+
+  // The number of buckets merged from the cache.
+  int64_t hits() const { return static_cast<int64_t>(cached_buckets_.size()); }
+  // The number of buckets aggregated from the rows of the table.
+  int64_t misses() const { return misses_; }
+
+ private:
+  ResultCache* cache_;
+  const table_store::Table* table_;
+  // The generation of the table when the session looked up the cache, before reading any rows.
+  const int64_t generation_;
+  const std::string key_;
+  const int64_t start_time_;
+  const int64_t stop_time_;
+
+  std::vector<ResultCache::Bucket> cached_buckets_;
+  std::vector<TimeRange> uncached_ranges_;
+
+  int64_t current_bucket_ = 0;
+  bool has_current_bucket_ = false;
+  int64_t max_time_ = std::numeric_limits<int64_t>::min();
+  int64_t misses_ = 0;
+};
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
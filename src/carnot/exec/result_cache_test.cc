@@ -0,0 +1,261 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/result_cache.h"
+
+#include <arrow/memory_pool.h>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <absl/strings/substitute.h>
+#include <google/protobuf/text_format.h>
+#include <gtest/gtest.h>
+
+#include "src/carnot/planpb/plan.pb.h"
+#include "src/common/testing/testing.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/shared/types/types.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+using table_store::Table;
+using table_store::schema::RowBatch;
+using table_store::schema::RowDescriptor;
+
+constexpr int64_t kMinTime = std::numeric_limits<int64_t>::min();
+constexpr int64_t kMaxTime = std::numeric_limits<int64_t>::max();
+
+constexpr char kMemorySourceOperator[] = R"(
+  op_type: MEMORY_SOURCE_OPERATOR
+  mem_source_op {
+    name: "numbers"
+    column_idxs: 1
+    column_types: INT64
+    column_names: "key"
+    column_idxs: 2
+    column_types: INT64
+    column_names: "val"
+    start_time {
+      value: $0
+    }
+  }
+)";
+
+constexpr char kAggregateOperator[] = R"(
+  op_type: AGGREGATE_OPERATOR
+  agg_op {
+    values {
+      name: "$1"
+      id: $2
+      args {
+        column {
+          node: $0
+          index: 1
+        }
+      }
+      args_data_types: INT64
+    }
+    groups {
+      node: $0
+      index: 0
+    }
+    group_names: "key"
+    value_names: "sum"
+    partial_agg: true
+    finalize_results: true
+  }
+)";
+
+std::unique_ptr<plan::Operator> ParseOperator(const std::string& text, int64_t id) {
+  planpb::Operator pb;
+  EXPECT_TRUE(google::protobuf::TextFormat::MergeFromString(text, &pb));
+  return plan::Operator::FromProto(pb, id);
+}
+
+// Returns the key of a memory source followed by an aggregate, with the given plan IDs.
+std::string Key(int64_t source_id, int64_t start_time, const std::string& uda_name,
+                int64_t uda_id) {
+  auto source = ParseOperator(absl::Substitute(kMemorySourceOperator, start_time), source_id);
+  auto agg = ParseOperator(absl::Substitute(kAggregateOperator, source_id, uda_name, uda_id),
+                           source_id + 1);
+  return ResultCache::PipelineKey(*static_cast<plan::MemorySourceOperator*>(source.get()),
+                                  {agg.get()});
+}
+
+TEST(ResultCacheTest, pipeline_key_ignores_plan_ids_and_time_range) {
+  auto key = Key(1, 10, "sum", 0);
+  EXPECT_EQ(key, Key(5, 10, "sum", 3));
+  EXPECT_EQ(key, Key(1, 1000, "sum", 0));
+  EXPECT_NE(key, Key(1, 10, "count", 0));
+}
+
+class ResultCacheSessionTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    table_store::schema::Relation rel({types::DataType::TIME64NS, types::DataType::INT64},
+                                      {"time_", "val"});
+    table_ = Table::Create("numbers", rel);
+    std::vector<types::Time64NSValue> times;
+    std::vector<types::Int64Value> vals;
+    for (int64_t time = 0; time < 100; ++time) {
+      times.push_back(time);
+      vals.push_back(time);
+    }
+    WriteRows(times, vals);
+  }
+
+  void WriteRows(const std::vector<types::Time64NSValue>& times,
+                 const std::vector<types::Int64Value>& vals) {
+    auto rb = RowBatch(RowDescriptor(table_->GetRelation().col_types()), times.size());
+    EXPECT_OK(rb.AddColumn(types::ToArrow(times, arrow::default_memory_pool())));
+    EXPECT_OK(rb.AddColumn(types::ToArrow(vals, arrow::default_memory_pool())));
+    EXPECT_OK(table_->WriteRowBatch(rb));
+  }
+
+  void WriteRow(int64_t time) { WriteRows({time}, {time}); }
+
+  std::shared_ptr<RowBatch> States() {
+    auto rb = std::make_shared<RowBatch>(RowDescriptor({types::DataType::STRING}), 1);
+    std::vector<types::StringValue> states = {"0"};
+    EXPECT_OK(rb->AddColumn(types::ToArrow(states, arrow::default_memory_pool())));
+    return rb;
+  }
+
+  std::shared_ptr<Table> table_;
+  ResultCache cache_{/* max_bytes */ 1024 * 1024, /* bucket_ns */ 10};
+};
+
+TEST_F(ResultCacheSessionTest, complete_buckets) {
+  ResultCacheSession session(&cache_, "key", table_.get(), 5, kMaxTime);
+  EXPECT_EQ(0, session.hits());
+  ASSERT_EQ(1, session.uncached_ranges().size());
+  EXPECT_EQ(5, session.uncached_ranges()[0].start);
+  EXPECT_EQ(kMaxTime, session.uncached_ranges()[0].stop);
+
+  session.UpdateMaxTime(25);
+  // Bucket 0 starts before the query, and bucket 20 isn't followed by a row yet.
+  EXPECT_FALSE(session.IsComplete(0));
+  EXPECT_TRUE(session.IsComplete(10));
+  EXPECT_FALSE(session.IsComplete(20));
+  session.UpdateMaxTime(30);
+  EXPECT_TRUE(session.IsComplete(20));
+
+  ResultCacheSession bounded_session(&cache_, "key", table_.get(), kMinTime, 45);
+  bounded_session.UpdateMaxTime(99);
+  EXPECT_TRUE(bounded_session.IsComplete(30));
+  // Bucket 40 ends after the query.
+  EXPECT_FALSE(bounded_session.IsComplete(40));
+}
+
+TEST_F(ResultCacheSessionTest, uncached_ranges) {
+  {
+    ResultCacheSession session(&cache_, "key", table_.get(), 5, kMaxTime);
+    session.AddBucket(10, States());
+    session.AddBucket(20, States());
+    session.AddBucket(40, States());
+    // Bucket 0 might have lost rows to expiry already, so it isn't cached.
+    session.AddBucket(0, States());
+  }
+
+  ResultCacheSession session(&cache_, "key", table_.get(), 15, kMaxTime);
+  ASSERT_EQ(2, session.hits());
+  EXPECT_EQ(20, session.cached_buckets()[0].start);
+  EXPECT_EQ(40, session.cached_buckets()[1].start);
+  const auto& ranges = session.uncached_ranges();
+  ASSERT_EQ(3, ranges.size());
+  EXPECT_EQ(15, ranges[0].start);
+  EXPECT_EQ(19, ranges[0].stop);
+  EXPECT_EQ(30, ranges[1].start);
+  EXPECT_EQ(39, ranges[1].stop);
+  EXPECT_EQ(50, ranges[2].start);
+  EXPECT_EQ(kMaxTime, ranges[2].stop);
+
+  // Other pipelines don't share the buckets.
+  ResultCacheSession other_session(&cache_, "other_key", table_.get(), 15, kMaxTime);
+  EXPECT_EQ(0, other_session.hits());
+}
+
+TEST_F(ResultCacheSessionTest, out_of_order_rows_invalidate_buckets) {
+  {
+    ResultCacheSession session(&cache_, "key", table_.get(), 5, kMaxTime);
+    session.AddBucket(10, States());
+  }
+  ASSERT_EQ(1, ResultCacheSession(&cache_, "key", table_.get(), 5, kMaxTime).hits());
+
+  // A late row of bucket 10 means that the bucket isn't used anymore.
+  ResultCacheSession session(&cache_, "key", table_.get(), 5, kMaxTime);
+  WriteRow(12);
+  EXPECT_EQ(0, ResultCacheSession(&cache_, "key", table_.get(), 5, kMaxTime).hits());
+  // Buckets of sessions that started before the late row aren't cached either.
+  session.AddBucket(20, States());
+  EXPECT_EQ(0, ResultCacheSession(&cache_, "key", table_.get(), 5, kMaxTime).hits());
+
+  // Tables recreated with the same name don't share buckets either.
+  ResultCacheSession new_session(&cache_, "key", table_.get(), 5, kMaxTime);
+  new_session.AddBucket(10, States());
+  ASSERT_EQ(1, ResultCacheSession(&cache_, "key", table_.get(), 5, kMaxTime).hits());
+  SetUp();
+  EXPECT_EQ(0, ResultCacheSession(&cache_, "key", table_.get(), 5, kMaxTime).hits());
+}
+
+TEST_F(ResultCacheSessionTest, out_of_order_rows_of_newer_buckets_keep_buckets) {
+  ResultCacheSession session(&cache_, "key", table_.get(), 5, kMaxTime);
+  session.AddBucket(10, States());
+  ASSERT_EQ(1, ResultCacheSession(&cache_, "key", table_.get(), 5, kMaxTime).hits());
+
+  // Late rows after bucket 10 don't change its rows, so it's still used, and buckets of sessions
+  // that started before the late rows are still cached if they end before them.
+  WriteRow(50);
+  WriteRow(45);
+  EXPECT_EQ(1, ResultCacheSession(&cache_, "key", table_.get(), 5, kMaxTime).hits());
+  session.AddBucket(30, States());
+  session.AddBucket(40, States());
+  ResultCacheSession other_session(&cache_, "key", table_.get(), 5, kMaxTime);
+  ASSERT_EQ(2, other_session.hits());
+  EXPECT_EQ(10, other_session.cached_buckets()[0].start);
+  EXPECT_EQ(30, other_session.cached_buckets()[1].start);
+}
+
+TEST_F(ResultCacheSessionTest, evicts_least_recently_used_pipelines) {
+  ResultCache cache(/* max_bytes */ 2 * States()->NumBytes(), /* bucket_ns */ 10);
+  {
+    ResultCacheSession session(&cache, "a", table_.get(), 0, kMaxTime);
+    session.AddBucket(10, States());
+  }
+  {
+    ResultCacheSession session(&cache, "b", table_.get(), 0, kMaxTime);
+    session.AddBucket(10, States());
+  }
+  // Looking up a makes b the least recently used pipeline.
+  EXPECT_EQ(1, ResultCacheSession(&cache, "a", table_.get(), 0, kMaxTime).hits());
+  {
+    ResultCacheSession session(&cache, "c", table_.get(), 0, kMaxTime);
+    session.AddBucket(10, States());
+  }
+  EXPECT_EQ(1, ResultCacheSession(&cache, "a", table_.get(), 0, kMaxTime).hits());
+  EXPECT_EQ(0, ResultCacheSession(&cache, "b", table_.get(), 0, kMaxTime).hits());
+  EXPECT_EQ(1, ResultCacheSession(&cache, "c", table_.get(), 0, kMaxTime).hits());
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
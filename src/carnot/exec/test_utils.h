@@ -25,6 +25,10 @@
 #include <utility>
 #include <vector>
 
+#include <absl/container/flat_hash_map.h>
+#include <arrow/array.h>
+#include <arrow/builder.h>
+
 #include "opentelemetry/proto/collector/metrics/v1/metrics_service_mock.grpc.pb.h"
 #include "opentelemetry/proto/collector/trace/v1/trace_service_mock.grpc.pb.h"
 #include "src/carnot/carnotpb/carnot.grpc.pb.h"
@@ -283,6 +287,33 @@ class RowBatchBuilder {
     return *this;
   }
 
+  /**
+   * Add a dictionary encoded string column to the rowbatch, as the table store's cold batches hold
+   * them.
+   * @param col The strings of the column.
+   * @return the RowBatchBuilder, to allow for chaining.
+   */
+  RowBatchBuilder& AddDictionaryColumn(const std::vector<std::string>& col) {
+    arrow::StringBuilder dictionary_builder;
+    arrow::Int32Builder indices_builder;
+    absl::flat_hash_map<std::string, int32_t> codes;
+    for (const auto& val : col) {
+      auto [it, inserted] = codes.try_emplace(val, codes.size());
+      if (inserted) {
+        EXPECT_OK(dictionary_builder.Append(val));
+      }
+      EXPECT_OK(indices_builder.Append(it->second));
+    }
+    std::shared_ptr<arrow::Array> dictionary;
+    std::shared_ptr<arrow::Array> indices;
+    EXPECT_OK(dictionary_builder.Finish(&dictionary));
+    EXPECT_OK(indices_builder.Finish(&indices));
+    EXPECT_OK(rb_->AddColumn(std::make_shared<arrow::DictionaryArray>(
+        arrow::dictionary(arrow::int32(), arrow::utf8()), indices, dictionary)));
+
+    return *this;
+  }
+
   /**
    * @return The rowbatch.
    */
@@ -0,0 +1,215 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/top_k_node.h"
+
+#include <arrow/array.h>
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <absl/strings/substitute.h>
+
+#include "src/carnot/planpb/plan.pb.h"
+#include "src/common/base/base.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/shared/types/type_utils.h"
+#include "src/table_store/schema/row_batch.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+using table_store::schema::RowBatch;
+
+namespace {
+
+template <typename T>
+int ThreeWayCompare(const T& a, const T& b) {
+  if (a < b) {
+    return -1;
+  }
+  return b < a ? 1 : 0;
+}
+
+template <types::DataType T>
+int CompareValues(const arrow::Array* a, int64_t a_idx, const arrow::Array* b, int64_t b_idx) {
+  if constexpr (T == types::STRING) {
+    return types::GetStringViewFromArrowArray(a, a_idx)
+        .compare(types::GetStringViewFromArrowArray(b, b_idx));
+  } else if constexpr (T == types::UINT128) {
+    types::UInt128Value a_val(types::GetValueFromArrowArray<T>(a, a_idx));
+    types::UInt128Value b_val(types::GetValueFromArrowArray<T>(b, b_idx));
+    return ThreeWayCompare(std::make_pair(a_val.High64(), a_val.Low64()),
+                           std::make_pair(b_val.High64(), b_val.Low64()));
+  } else {
+    return ThreeWayCompare(types::GetValueFromArrowArray<T>(a, a_idx),
+                           types::GetValueFromArrowArray<T>(b, b_idx));
+  }
+}
+
+}  // namespace
+
+std::string TopKNode::DebugStringImpl() {
+  return absl::Substitute("Exec::TopKNode<$0>", plan_node_->DebugString());
+}
+
+Status TopKNode::InitImpl(const plan::Operator& plan_node) {
+  CHECK(plan_node.op_type() == planpb::OperatorType::TOP_K_OPERATOR);
+  const auto* top_k_plan_node = static_cast<const plan::TopKOperator*>(&plan_node);
+  // copy the plan node to local object;
+  plan_node_ = std::make_unique<plan::TopKOperator>(*top_k_plan_node);
+
+  if (input_descriptors_.size() != 1) {
+    return error::InvalidArgument("TopK operator expects a single input relation, got $0",
+                                  input_descriptors_.size());
+  }
+  for (const auto& col : plan_node_->order_by()) {
+    DCHECK(col.idx < static_cast<int64_t>(input_descriptors_[0].size()));
+#define TYPE_CASE(_dt_) compare_fns_.push_back(&CompareValues<_dt_>);
+    PX_SWITCH_FOREACH_DATATYPE(input_descriptors_[0].type(col.idx), TYPE_CASE);
+#undef TYPE_CASE
+  }
+  return Status::OK();
+}
+
+Status TopKNode::PrepareImpl(ExecState* /*exec_state*/) { return Status::OK(); }
+
+Status TopKNode::OpenImpl(ExecState* /*exec_state*/) { return Status::OK(); }
+
+Status TopKNode::CloseImpl(ExecState* /*exec_state*/) {
+  heap_.clear();
+  ClearBatches();
+  return Status::OK();
+}
+
+bool TopKNode::SortsBefore(const RowRef& a, const RowRef& b) const {
+  const auto& a_cols = batches_[a.batch_idx];
+  const auto& b_cols = batches_[b.batch_idx];
+  const auto& order_by = plan_node_->order_by();
+  for (size_t i = 0; i < order_by.size(); ++i) {
+    auto col_idx = order_by[i].idx;
+    int cmp = compare_fns_[i](a_cols[col_idx].get(), a.row_idx, b_cols[col_idx].get(), b.row_idx);
+    if (cmp != 0) {
+      return order_by[i].descending ? cmp > 0 : cmp < 0;
+    }
+  }
+  return false;
+}
+
+void TopKNode::ReleaseRow(const RowRef& row) {
+  if (--batch_refs_[row.batch_idx] == 0) {
+    batches_[row.batch_idx].clear();
+    free_batch_slots_.push_back(row.batch_idx);
+  }
+}
+
+int64_t TopKNode::HoldBatch(const RowBatch& rb) {
+  int64_t batch_idx;
+  if (free_batch_slots_.empty()) {
+    batch_idx = static_cast<int64_t>(batches_.size());
+    batches_.emplace_back();
+    batch_refs_.push_back(0);
+  } else {
+    batch_idx = free_batch_slots_.back();
+    free_batch_slots_.pop_back();
+  }
+  auto& cols = batches_[batch_idx];
+  for (int64_t i = 0; i < rb.num_columns(); ++i) {
+    cols.push_back(rb.ColumnAt(i));
+  }
+  // The batch itself holds a reference until all of its rows are processed.
+  batch_refs_[batch_idx] = 1;
+  return batch_idx;
+}
+
+void TopKNode::ClearBatches() {
+  batches_.clear();
+  batch_refs_.clear();
+  free_batch_slots_.clear();
+}
+
+Status TopKNode::ConsumeNextImpl(ExecState* exec_state, const RowBatch& rb, size_t) {
+  auto k = plan_node_->k();
+  auto sorts_before = [this](const RowRef& a, const RowRef& b) { return SortsBefore(a, b); };
+
+  // Hold on to the batch while its rows are compared against the heap. Its columns are released
+  // right away if none of its rows make it into the top k.
+  auto batch_idx = HoldBatch(rb);
+
+  for (int64_t i = 0; i < rb.num_rows() && k > 0; ++i) {
+    RowRef row{batch_idx, rb.ColumnRowIdx(i)};
+    if (static_cast<int64_t>(heap_.size()) < k) {
+      heap_.push_back(row);
+      std::push_heap(heap_.begin(), heap_.end(), sorts_before);
+      ++batch_refs_[batch_idx];
+      continue;
+    }
+    if (!SortsBefore(row, heap_.front())) {
+      continue;
+    }
+    std::pop_heap(heap_.begin(), heap_.end(), sorts_before);
+    ReleaseRow(heap_.back());
+    heap_.back() = row;
+    std::push_heap(heap_.begin(), heap_.end(), sorts_before);
+    ++batch_refs_[batch_idx];
+  }
+  ReleaseRow(RowRef{batch_idx, 0});
+
+  if (rb.eow() || rb.eos()) {
+    return EmitTopK(exec_state, rb);
+  }
+  return Status::OK();
+}
+
+Status TopKNode::EmitTopK(ExecState* exec_state, const RowBatch& rb) {
+  auto sorts_before = [this](const RowRef& a, const RowRef& b) { return SortsBefore(a, b); };
+  std::sort_heap(heap_.begin(), heap_.end(), sorts_before);
+
+  auto num_rows = static_cast<int64_t>(heap_.size());
+  RowBatch output_rb(*output_descriptor_, num_rows);
+  const auto& selected_cols = plan_node_->selected_cols();
+  DCHECK_EQ(output_descriptor_->size(), selected_cols.size());
+  for (size_t i = 0; i < selected_cols.size(); ++i) {
+    auto builder = types::MakeArrowBuilder(output_descriptor_->type(i), exec_state->exec_mem_pool());
+    PX_RETURN_IF_ERROR(builder->Reserve(num_rows));
+    for (const auto& row : heap_) {
+      const auto* input_col = batches_[row.batch_idx][selected_cols[i]].get();
+#define TYPE_CASE(_dt_)                                    \
+  PX_RETURN_IF_ERROR(table_store::schema::CopyValue<_dt_>( \
+      builder.get(), types::GetValueFromArrowArray<_dt_>(input_col, row.row_idx)));
+      PX_SWITCH_FOREACH_DATATYPE(output_descriptor_->type(i), TYPE_CASE);
+#undef TYPE_CASE
+    }
+    std::shared_ptr<arrow::Array> out_col;
+    PX_RETURN_IF_ERROR(builder->Finish(&out_col));
+    PX_RETURN_IF_ERROR(output_rb.AddColumn(out_col));
+  }
+  output_rb.set_eow(rb.eow());
+  output_rb.set_eos(rb.eos());
+
+  // Every window gets its own top k.
+  heap_.clear();
+  ClearBatches();
+  return SendRowBatchToChildren(exec_state, output_rb);
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
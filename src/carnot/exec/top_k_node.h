@@ -0,0 +1,95 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <arrow/array.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "src/carnot/exec/exec_node.h"
+#include "src/carnot/exec/exec_state.h"
+#include "src/carnot/plan/operators.h"
+#include "src/common/base/base.h"
+#include "src/common/base/status.h"
+#include "src/table_store/table_store.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+/**
+ * TopKNode keeps the k rows of its input that sort first, in a bounded heap, and sends them in
+ * sorted order at the end of every window. Rows are kept by reference into the input row batches,
+ * which are held on to for as long as one of their rows is in the heap, so a row is only copied once
+ * it is part of the output.
+ */
+class TopKNode : public ProcessingNode {
+ public:
+  TopKNode() = default;
+  virtual ~TopKNode() = default;
+
+ protected:
+  std::string DebugStringImpl() override;
+  Status InitImpl(const plan::Operator& plan_node) override;
+  Status PrepareImpl(ExecState* exec_state) override;
+  Status OpenImpl(ExecState* exec_state) override;
+  Status CloseImpl(ExecState* exec_state) override;
+  Status ConsumeNextImpl(ExecState* exec_state, const table_store::schema::RowBatch& rb,
+                         size_t parent_index) override;
+  bool ConsumesSelection() const override { return true; }
+
+ private:
+  // A row of one of the held row batches.
+  struct RowRef {
+    // The slot of the row batch in batches_.
+    int64_t batch_idx;
+    int64_t row_idx;
+  };
+
+  // Compares two values of a column, returning a negative, zero or positive value like memcmp.
+  using CompareFn = int (*)(const arrow::Array* a, int64_t a_idx, const arrow::Array* b,
+                            int64_t b_idx);
+
+  // Returns whether row a sorts before row b.
+  bool SortsBefore(const RowRef& a, const RowRef& b) const;
+  // Removes a row from the heap's accounting, releasing its row batch if no other row of it is
+  // kept.
+  void ReleaseRow(const RowRef& row);
+  // Holds on to the columns of a row batch in a free slot of batches_, and returns the slot.
+  int64_t HoldBatch(const table_store::schema::RowBatch& rb);
+  void ClearBatches();
+  Status EmitTopK(ExecState* exec_state, const table_store::schema::RowBatch& rb);
+
+  std::unique_ptr<plan::TopKOperator> plan_node_;
+  std::vector<CompareFn> compare_fns_;
+
+  // The input columns of the row batches that have a kept row, by slot, and the number of their
+  // kept rows. The columns of a batch are dropped once none of its rows are kept, and its slot is
+  // reused by a later batch, so there are at most k + 1 slots however many batches there are.
+  std::vector<std::vector<std::shared_ptr<arrow::Array>>> batches_;
+  std::vector<int64_t> batch_refs_;
+  std::vector<int64_t> free_batch_slots_;
+  // The kept rows, as a heap with the row that sorts last on top.
+  std::vector<RowRef> heap_;
+};
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,146 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/top_k_node.h"
+
+#include <memory>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <sole.hpp>
+
+#include "src/carnot/exec/test_utils.h"
+#include "src/carnot/planpb/test_proto.h"
+#include "src/carnot/udf/base.h"
+#include "src/carnot/udf/registry.h"
+#include "src/common/base/base.h"
+#include "src/shared/types/types.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+using table_store::schema::RowBatch;
+using table_store::schema::RowDescriptor;
+
+class TopKNodeTest : public ::testing::Test {
+ public:
+  TopKNodeTest() {
+    // Keeps 3 rows, sorted by column 1 descending and then by column 0 ascending.
+    auto op_proto = planpb::testutils::CreateTestTopK1PB();
+    plan_node_ = plan::TopKOperator::FromProto(op_proto, 1);
+
+    func_registry_ = std::make_unique<udf::Registry>("test_registry");
+
+    auto table_store = std::make_shared<table_store::TableStore>();
+
+    exec_state_ = std::make_unique<ExecState>(func_registry_.get(), table_store,
+                                              MockResultSinkStubGenerator, MockMetricsStubGenerator,
+                                              MockTraceStubGenerator, sole::uuid4(), nullptr);
+  }
+
+ protected:
+  std::unique_ptr<plan::Operator> plan_node_;
+  std::unique_ptr<ExecState> exec_state_;
+  std::unique_ptr<udf::Registry> func_registry_;
+};
+
+TEST_F(TopKNodeTest, multiple_batches) {
+  RowDescriptor input_rd({types::DataType::INT64, types::DataType::INT64});
+  RowDescriptor output_rd({types::DataType::INT64, types::DataType::INT64});
+
+  auto tester = exec::ExecNodeTester<TopKNode, plan::TopKOperator>(*plan_node_, output_rd,
+                                                                   {input_rd}, exec_state_.get());
+  tester
+      .ConsumeNext(RowBatchBuilder(input_rd, 4, /*eow*/ false, /*eos*/ false)
+                       .AddColumn<types::Int64Value>({1, 2, 3, 4})
+                       .AddColumn<types::Int64Value>({5, 9, 1, 9})
+                       .get(),
+                   0, 0)
+      .ConsumeNext(RowBatchBuilder(input_rd, 3, /*eow*/ true, /*eos*/ true)
+                       .AddColumn<types::Int64Value>({5, 6, 7})
+                       .AddColumn<types::Int64Value>({7, 8, 2})
+                       .get(),
+                   0)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 3, true, true)
+                          .AddColumn<types::Int64Value>({2, 4, 6})
+                          .AddColumn<types::Int64Value>({9, 9, 8})
+                          .get())
+      .Close();
+}
+
+TEST_F(TopKNodeTest, fewer_rows_than_k_per_window) {
+  RowDescriptor input_rd({types::DataType::INT64, types::DataType::INT64});
+  RowDescriptor output_rd({types::DataType::INT64, types::DataType::INT64});
+
+  auto tester = exec::ExecNodeTester<TopKNode, plan::TopKOperator>(*plan_node_, output_rd,
+                                                                   {input_rd}, exec_state_.get());
+  tester
+      .ConsumeNext(RowBatchBuilder(input_rd, 2, /*eow*/ true, /*eos*/ false)
+                       .AddColumn<types::Int64Value>({1, 2})
+                       .AddColumn<types::Int64Value>({3, 4})
+                       .get(),
+                   0)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 2, true, false)
+                          .AddColumn<types::Int64Value>({2, 1})
+                          .AddColumn<types::Int64Value>({4, 3})
+                          .get())
+      .ConsumeNext(RowBatchBuilder(input_rd, 0, /*eow*/ true, /*eos*/ true)
+                       .AddColumn<types::Int64Value>({})
+                       .AddColumn<types::Int64Value>({})
+                       .get(),
+                   0)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 0, true, true)
+                          .AddColumn<types::Int64Value>({})
+                          .AddColumn<types::Int64Value>({})
+                          .get())
+      .Close();
+}
+
+TEST_F(TopKNodeTest, reuses_released_batches) {
+  RowDescriptor input_rd({types::DataType::INT64, types::DataType::INT64});
+  RowDescriptor output_rd({types::DataType::INT64, types::DataType::INT64});
+
+  auto tester = exec::ExecNodeTester<TopKNode, plan::TopKOperator>(*plan_node_, output_rd,
+                                                                   {input_rd}, exec_state_.get());
+  // Every batch pushes the oldest kept row out of the heap, so later batches take over the slots
+  // of the released ones.
+  for (int64_t i = 1; i < 6; ++i) {
+    tester.ConsumeNext(RowBatchBuilder(input_rd, 1, /*eow*/ false, /*eos*/ false)
+                           .AddColumn<types::Int64Value>({i})
+                           .AddColumn<types::Int64Value>({i})
+                           .get(),
+                       0, 0);
+  }
+  tester
+      .ConsumeNext(RowBatchBuilder(input_rd, 2, /*eow*/ true, /*eos*/ true)
+                       .AddColumn<types::Int64Value>({6, 0})
+                       .AddColumn<types::Int64Value>({6, 0})
+                       .get(),
+                   0)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 3, true, true)
+                          .AddColumn<types::Int64Value>({6, 5, 4})
+                          .AddColumn<types::Int64Value>({6, 5, 4})
+                          .get())
+      .Close();
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
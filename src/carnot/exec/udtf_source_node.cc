@@ -113,8 +113,9 @@ Status UDTFSourceNode::GenerateNextImpl(ExecState* exec_state) {
     outputs_raw.emplace_back(out.get());
   }
 
-  auto has_more_batches = udtf_def_->ExecBatchUpdate(udtf_inst_.get(), function_ctx_.get(),
-                                                     kUDTFBatchSize, &outputs_raw);
+  PX_ASSIGN_OR_RETURN(auto has_more_batches,
+                      udtf_def_->ExecBatchUpdate(udtf_inst_.get(), function_ctx_.get(),
+                                                 kUDTFBatchSize, &outputs_raw));
 
   DCHECK_GT(outputs.size(), 0U);
 
@@ -35,6 +35,10 @@ template <typename TReturn, typename TArg1 = TReturn, typename TArg2 = TReturn>
 class AddUDF : public udf::ScalarUDF {
  public:
   TReturn Exec(FunctionContext*, TArg1 b1, TArg2 b2) { return b1.val + b2.val; }
+  void ExecBatch(FunctionContext*, size_t count, udf::BatchArg<TArg1> b1,
+                 udf::BatchArg<TArg2> b2, typename udf::BatchArg<TReturn>::native_type* out) {
+    udf::BinaryBatchKernel(count, b1, b2, out, [](auto a, auto b) { return a + b; });
+  }
   static udf::InfRuleVec SemanticInferenceRules() {
     return {
         udf::InheritTypeFromArgs<AddUDF>::Create({types::ST_BYTES, types::ST_THROUGHPUT_PER_NS,
@@ -60,6 +64,10 @@ template <typename TReturn, typename TArg1 = TReturn, typename TArg2 = TReturn>
 class SubtractUDF : public udf::ScalarUDF {
  public:
   TReturn Exec(FunctionContext*, TArg1 b1, TArg2 b2) { return b1.val - b2.val; }
+  void ExecBatch(FunctionContext*, size_t count, udf::BatchArg<TArg1> b1,
+                 udf::BatchArg<TArg2> b2, typename udf::BatchArg<TReturn>::native_type* out) {
+    udf::BinaryBatchKernel(count, b1, b2, out, [](auto a, auto b) { return a - b; });
+  }
   static udf::InfRuleVec SemanticInferenceRules() {
     return {
         udf::InheritTypeFromArgs<SubtractUDF>::Create({types::ST_BYTES, types::ST_THROUGHPUT_PER_NS,
@@ -88,6 +96,12 @@ class DivideUDF : public udf::ScalarUDF {
   types::Float64Value Exec(FunctionContext*, TArg1 b1, TArg2 b2) {
     return static_cast<double>(b1.val) / static_cast<double>(b2.val);
   }
+  void ExecBatch(FunctionContext*, size_t count, udf::BatchArg<TArg1> b1,
+                 udf::BatchArg<TArg2> b2, double* out) {
+    udf::BinaryBatchKernel(count, b1, b2, out, [](auto a, auto b) {
+      return static_cast<double>(a) / static_cast<double>(b);
+    });
+  }
 
   static udf::InfRuleVec SemanticInferenceRules() {
     return {udf::ExplicitRule::Create<DivideUDF>(types::ST_THROUGHPUT_PER_NS,
@@ -113,6 +127,10 @@ template <typename TReturn, typename TArg1 = TReturn, typename TArg2 = TReturn>
 class MultiplyUDF : public udf::ScalarUDF {
  public:
   TReturn Exec(FunctionContext*, TArg1 b1, TArg2 b2) { return b1.val * b2.val; }
+  void ExecBatch(FunctionContext*, size_t count, udf::BatchArg<TArg1> b1,
+                 udf::BatchArg<TArg2> b2, typename udf::BatchArg<TReturn>::native_type* out) {
+    udf::BinaryBatchKernel(count, b1, b2, out, [](auto a, auto b) { return a * b; });
+  }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Multiplies the arguments.")
         .Details("Multiplies the two values together. Accessible using the `*` operator syntax.")
@@ -266,6 +284,10 @@ template <typename TArg1, typename TArg2 = TArg1>
 class LogicalOrUDF : public udf::ScalarUDF {
  public:
   BoolValue Exec(FunctionContext*, TArg1 b1, TArg2 b2) { return b1.val || b2.val; }
+  void ExecBatch(FunctionContext*, size_t count, udf::BatchArg<TArg1> b1,
+                 udf::BatchArg<TArg2> b2, typename udf::BatchArg<BoolValue>::native_type* out) {
+    udf::BinaryBatchKernel(count, b1, b2, out, [](auto a, auto b) { return a || b; });
+  }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Boolean ORs the passed in values.")
         .Example(R"doc(# Implicit call.
@@ -285,6 +307,10 @@ template <typename TArg1, typename TArg2 = TArg1>
 class LogicalAndUDF : public udf::ScalarUDF {
  public:
   BoolValue Exec(FunctionContext*, TArg1 b1, TArg2 b2) { return b1.val && b2.val; }
+  void ExecBatch(FunctionContext*, size_t count, udf::BatchArg<TArg1> b1,
+                 udf::BatchArg<TArg2> b2, typename udf::BatchArg<BoolValue>::native_type* out) {
+    udf::BinaryBatchKernel(count, b1, b2, out, [](auto a, auto b) { return a && b; });
+  }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Boolean ANDs the passed in values.")
         .Example(R"doc(# Implicit call.
@@ -374,6 +400,10 @@ template <typename TArg1, typename TArg2 = TArg1>
 class EqualUDF : public udf::ScalarUDF {
  public:
   BoolValue Exec(FunctionContext*, TArg1 b1, TArg2 b2) { return b1 == b2; }
+  void ExecBatch(FunctionContext*, size_t count, udf::BatchArg<TArg1> b1,
+                 udf::BatchArg<TArg2> b2, typename udf::BatchArg<BoolValue>::native_type* out) {
+    udf::BinaryBatchKernel(count, b1, b2, out, [](auto a, auto b) { return a == b; });
+  }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Returns whether the values are equal.")
         .Details(
@@ -394,6 +424,10 @@ template <typename TArg1, typename TArg2 = TArg1>
 class NotEqualUDF : public udf::ScalarUDF {
  public:
   BoolValue Exec(FunctionContext*, TArg1 b1, TArg2 b2) { return b1 != b2; }
+  void ExecBatch(FunctionContext*, size_t count, udf::BatchArg<TArg1> b1,
+                 udf::BatchArg<TArg2> b2, typename udf::BatchArg<BoolValue>::native_type* out) {
+    udf::BinaryBatchKernel(count, b1, b2, out, [](auto a, auto b) { return a != b; });
+  }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Returns whether the values are not equal.")
         .Details(
@@ -439,6 +473,10 @@ template <typename TArg1, typename TArg2 = TArg1>
 class GreaterThanUDF : public udf::ScalarUDF {
  public:
   BoolValue Exec(FunctionContext*, TArg1 b1, TArg2 b2) { return b1 > b2; }
+  void ExecBatch(FunctionContext*, size_t count, udf::BatchArg<TArg1> b1,
+                 udf::BatchArg<TArg2> b2, typename udf::BatchArg<BoolValue>::native_type* out) {
+    udf::BinaryBatchKernel(count, b1, b2, out, [](auto a, auto b) { return a > b; });
+  }
 
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder(
@@ -458,6 +496,10 @@ template <typename TArg1, typename TArg2 = TArg1>
 class GreaterThanEqualUDF : public udf::ScalarUDF {
  public:
   BoolValue Exec(FunctionContext*, TArg1 b1, TArg2 b2) { return b1 >= b2; }
+  void ExecBatch(FunctionContext*, size_t count, udf::BatchArg<TArg1> b1,
+                 udf::BatchArg<TArg2> b2, typename udf::BatchArg<BoolValue>::native_type* out) {
+    udf::BinaryBatchKernel(count, b1, b2, out, [](auto a, auto b) { return a >= b; });
+  }
 
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder(
@@ -478,6 +520,10 @@ template <typename TArg1, typename TArg2 = TArg1>
 class LessThanUDF : public udf::ScalarUDF {
  public:
   BoolValue Exec(FunctionContext*, TArg1 b1, TArg2 b2) { return b1 < b2; }
+  void ExecBatch(FunctionContext*, size_t count, udf::BatchArg<TArg1> b1,
+                 udf::BatchArg<TArg2> b2, typename udf::BatchArg<BoolValue>::native_type* out) {
+    udf::BinaryBatchKernel(count, b1, b2, out, [](auto a, auto b) { return a < b; });
+  }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Returns which value is less than the other.")
         .Example(R"doc(# Implict call.
@@ -494,6 +540,10 @@ template <typename TArg1, typename TArg2 = TArg1>
 class LessThanEqualUDF : public udf::ScalarUDF {
  public:
   BoolValue Exec(FunctionContext*, TArg1 b1, TArg2 b2) { return b1 <= b2; }
+  void ExecBatch(FunctionContext*, size_t count, udf::BatchArg<TArg1> b1,
+                 udf::BatchArg<TArg2> b2, typename udf::BatchArg<BoolValue>::native_type* out) {
+    udf::BinaryBatchKernel(count, b1, b2, out, [](auto a, auto b) { return a <= b; });
+  }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Returns which value is less than or equal to the the other.")
         .Example(R"doc(
@@ -514,6 +564,10 @@ template <typename TReturn, typename TArg1 = TReturn, typename TArg2 = TReturn>
 class BinUDF : public udf::ScalarUDF {
  public:
   TReturn Exec(FunctionContext*, TArg1 b1, TArg2 b2) { return b1.val - (b1.val % b2.val); }
+  void ExecBatch(FunctionContext*, size_t count, udf::BatchArg<TArg1> b1,
+                 udf::BatchArg<TArg2> b2, typename udf::BatchArg<TReturn>::native_type* out) {
+    udf::BinaryBatchKernel(count, b1, b2, out, [](auto a, auto b) { return a - (a % b); });
+  }
   static udf::ScalarUDFDocBuilder Doc() { return BinDoc(); }
 };
 
@@ -524,6 +578,12 @@ class BinUDF<TReturn, types::Float64Value, TArg2> : public udf::ScalarUDF {
   TReturn Exec(FunctionContext*, Float64Value b1, Int64Value b2) {
     return static_cast<int64_t>(b1.val) - (static_cast<int64_t>(b1.val) % b2.val);
   }
+  void ExecBatch(FunctionContext*, size_t count, udf::BatchArg<Float64Value> b1,
+                 udf::BatchArg<Int64Value> b2, typename udf::BatchArg<TReturn>::native_type* out) {
+    udf::BinaryBatchKernel(count, b1, b2, out, [](double a, int64_t b) {
+      return static_cast<int64_t>(a) - (static_cast<int64_t>(a) % b);
+    });
+  }
   static udf::ScalarUDFDocBuilder Doc() { return BinDoc(); }
 };
 
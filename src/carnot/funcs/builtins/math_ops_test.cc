@@ -17,6 +17,7 @@
  */
 
 #include <gtest/gtest.h>
+#include <memory>
 #include <numeric>
 #include <type_traits>
 #include <vector>
@@ -448,6 +449,121 @@ TEST(MathOps, time_time_bin_test) {
   udf_tester.ForInput(11, 2).Expect(10);
 }
 
+// Copies the values of a UDF argument into the native buffer that an ExecBatch kernel reads.
+template <typename TValue>
+std::unique_ptr<typename udf::BatchArg<TValue>::native_type[]> ToBatchData(
+    const std::vector<TValue>& values) {
+  auto data = std::make_unique<typename udf::BatchArg<TValue>::native_type[]>(values.size());
+  for (size_t i = 0; i < values.size(); ++i) {
+    data[i] = values[i].val;
+  }
+  return data;
+}
+
+template <typename TNative>
+void ExpectSameBatchValue(TNative expected, TNative actual) {
+  EXPECT_EQ(expected, actual);
+}
+
+// Dividing zero by zero produces NaN, which never compares equal to itself.
+void ExpectSameBatchValue(double expected, double actual) {
+  EXPECT_THAT(actual, ::testing::NanSensitiveDoubleEq(expected));
+}
+
+// Checks that the ExecBatch kernel of TUDF computes the same values as calling Exec on every row,
+// for each combination of column and constant arguments. A constant argument is the first value
+// of its vector.
+template <typename TUDF, typename TArg1, typename TArg2>
+void ExpectExecBatchMatchesExec(const std::vector<TArg1>& arg1, const std::vector<TArg2>& arg2) {
+  ASSERT_EQ(arg1.size(), arg2.size());
+  using TReturn = decltype(std::declval<TUDF>().Exec(nullptr, arg1[0], arg2[0]));
+  using TReturnNative = typename udf::BatchArg<TReturn>::native_type;
+
+  const size_t count = arg1.size();
+  auto arg1_data = ToBatchData(arg1);
+  auto arg2_data = ToBatchData(arg2);
+  auto out = std::make_unique<TReturnNative[]>(count);
+  TUDF udf;
+  for (bool arg1_constant : {false, true}) {
+    for (bool arg2_constant : {false, true}) {
+      SCOPED_TRACE(absl::Substitute("arg1_constant=$0, arg2_constant=$1", arg1_constant,
+                                    arg2_constant));
+      udf.ExecBatch(nullptr, count, udf::BatchArg<TArg1>{arg1_data.get(), arg1_constant},
+                    udf::BatchArg<TArg2>{arg2_data.get(), arg2_constant}, out.get());
+      for (size_t i = 0; i < count; ++i) {
+        TReturn expected =
+            udf.Exec(nullptr, arg1[arg1_constant ? 0 : i], arg2[arg2_constant ? 0 : i]);
+        ExpectSameBatchValue(expected.val, out[i]);
+      }
+    }
+  }
+}
+
+TEST(MathOps, int_int_bin_exec_batch_test) {
+  ExpectExecBatchMatchesExec<BinUDF<types::Int64Value>>(
+      std::vector<types::Int64Value>{11, 0, -7, 100, 12345},
+      std::vector<types::Int64Value>{2, 3, 5, 7, 1000});
+}
+
+TEST(MathOps, int_float_bin_exec_batch_test) {
+  ExpectExecBatchMatchesExec<BinUDF<types::Int64Value, types::Float64Value, types::Int64Value>>(
+      std::vector<types::Float64Value>{11.5, 0.2, -7.9, 100.0, 12345.678},
+      std::vector<types::Int64Value>{2, 3, 5, 7, 1000});
+}
+
+TEST(MathOps, time_int_bin_exec_batch_test) {
+  ExpectExecBatchMatchesExec<
+      BinUDF<types::Time64NSValue, types::Time64NSValue, types::Int64Value>>(
+      std::vector<types::Time64NSValue>{11, 1000000000, 1234567890123},
+      std::vector<types::Int64Value>{3, 1000, 1000000000});
+}
+
+TEST(MathOps, divide_exec_batch_test) {
+  ExpectExecBatchMatchesExec<DivideUDF<types::Int64Value>>(
+      std::vector<types::Int64Value>{1, -3, 0, 7, 10},
+      std::vector<types::Int64Value>{2, 4, 5, 0, -3});
+  ExpectExecBatchMatchesExec<DivideUDF<types::Float64Value, types::Int64Value>>(
+      std::vector<types::Float64Value>{1.5, -3.25, 0.0, 7.0},
+      std::vector<types::Int64Value>{5, 2, 0, 3});
+}
+
+TEST(MathOps, divide_by_zero_exec_batch_test) {
+  // Every divisor is zero, so the results are +inf, -inf and NaN.
+  ExpectExecBatchMatchesExec<DivideUDF<types::Int64Value>>(
+      std::vector<types::Int64Value>{1, -1, 0}, std::vector<types::Int64Value>{0, 0, 0});
+  ExpectExecBatchMatchesExec<DivideUDF<types::Float64Value>>(
+      std::vector<types::Float64Value>{0.0, 2.5, -2.5},
+      std::vector<types::Float64Value>{0.0, 0.0, 0.0});
+}
+
+TEST(MathOps, bool_logical_and_exec_batch_test) {
+  ExpectExecBatchMatchesExec<LogicalAndUDF<types::BoolValue>>(
+      std::vector<types::BoolValue>{true, true, false, false},
+      std::vector<types::BoolValue>{true, false, true, false});
+  ExpectExecBatchMatchesExec<LogicalAndUDF<types::BoolValue>>(
+      std::vector<types::BoolValue>{false, true, true, false},
+      std::vector<types::BoolValue>{true, false, true, false});
+}
+
+TEST(MathOps, bool_logical_or_exec_batch_test) {
+  ExpectExecBatchMatchesExec<LogicalOrUDF<types::BoolValue>>(
+      std::vector<types::BoolValue>{true, true, false, false},
+      std::vector<types::BoolValue>{true, false, true, false});
+  ExpectExecBatchMatchesExec<LogicalOrUDF<types::BoolValue>>(
+      std::vector<types::BoolValue>{false, true, true, false},
+      std::vector<types::BoolValue>{true, false, true, false});
+}
+
+TEST(MathOps, int64_arithmetic_exec_batch_test) {
+  std::vector<types::Int64Value> a{1, -2, 300, 0, 45};
+  std::vector<types::Int64Value> b{7, 8, -9, 10, 0};
+  ExpectExecBatchMatchesExec<AddUDF<types::Int64Value>>(a, b);
+  ExpectExecBatchMatchesExec<SubtractUDF<types::Int64Value>>(a, b);
+  ExpectExecBatchMatchesExec<MultiplyUDF<types::Int64Value>>(a, b);
+  ExpectExecBatchMatchesExec<EqualUDF<types::Int64Value>>(a, b);
+  ExpectExecBatchMatchesExec<GreaterThanUDF<types::Int64Value>>(a, b);
+}
+
 TEST(MathOps, round_test) {
   auto udf_tester = udf::UDFTester<RoundUDF>();
   udf_tester.ForInput(11.2, 2).Expect("11.20");
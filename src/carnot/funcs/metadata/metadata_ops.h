@@ -39,7 +39,13 @@ namespace carnot {
 namespace funcs {
 namespace metadata {
 
-using ScalarUDF = px::carnot::udf::ScalarUDF;
+// The results of metadata UDFs depend on the metadata of the agent when they run, not only on their
+// arguments.
+class ScalarUDF : public px::carnot::udf::ScalarUDF {
+ public:
+  static bool Deterministic() { return false; }
+};
+
 using K8sNameIdentView = px::md::K8sMetadataState::K8sNameIdentView;
 
 namespace internal {
@@ -3170,7 +3176,7 @@ class VizierNamespaceUDF : public ScalarUDF {
   }
 };
 
-class CreateUPIDUDF : public udf::ScalarUDF {
+class CreateUPIDUDF : public ScalarUDF {
  public:
   UInt128Value Exec(FunctionContext* ctx, Int64Value pid, Int64Value pid_start_time) {
     auto md = GetMetadataState(ctx);
@@ -3214,7 +3220,7 @@ class CreateUPIDWithASIDUDF : public udf::ScalarUDF {
   }
 };
 
-class GetClusterCIDRRangeUDF : public udf::ScalarUDF {
+class GetClusterCIDRRangeUDF : public ScalarUDF {
  public:
   Status Init(FunctionContext* ctx) {
     auto md = GetMetadataState(ctx);
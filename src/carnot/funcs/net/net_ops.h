@@ -43,6 +43,9 @@ using ScalarUDF = px::carnot::udf::ScalarUDF;
 
 class NSLookupUDF : public ScalarUDF {
  public:
+  // DNS records change over time.
+  static bool Deterministic() { return false; }
+
   StringValue Exec(FunctionContext*, StringValue addr) { return cache_.Lookup(addr); }
 
   static udf::ScalarUDFDocBuilder Doc() {
@@ -44,6 +44,8 @@ using ScalarUDF = px::carnot::udf::ScalarUDF;
 class SharedLibrariesUDF : public ScalarUDF {
  public:
   static udfspb::UDFSourceExecutor Executor() { return udfspb::UDFSourceExecutor::UDF_PEM; }
+  // Reads the current state of the process.
+  static bool Deterministic() { return false; }
 
   StringValue Exec(FunctionContext*, UInt128Value upid_value) {
     auto upid = md::UPID(upid_value.val);
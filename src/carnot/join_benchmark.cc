@@ -0,0 +1,153 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <sole.hpp>
+
+#include "src/carnot/carnot.h"
+#include "src/carnot/exec/equijoin_node.h"
+#include "src/carnot/exec/local_grpc_result_server.h"
+#include "src/carnot/funcs/funcs.h"
+#include "src/carnot/udf/udf.h"
+#include "src/common/base/base.h"
+#include "src/common/benchmark/benchmark.h"
+#include "src/datagen/datagen.h"
+#include "src/table_store/test_utils.h"
+
+namespace px {
+namespace carnot {
+
+constexpr char kInnerJoinQuery[] = R"pxl(
+import px
+left = px.DataFrame(table='left_table', select=['col0', 'col1'])
+right = px.DataFrame(table='right_table', select=['col0', 'col1'])
+df = left.merge(right, how='inner', left_on=['col0'], right_on=['col0'], suffixes=['', '_x'])
+px.display(df, '$0')
+)pxl";
+
+constexpr char kLeftJoinQuery[] = R"pxl(
+import px
+left = px.DataFrame(table='left_table', select=['col0', 'col1'])
+right = px.DataFrame(table='right_table', select=['col0', 'col1'])
+df = left.merge(right, how='left', left_on=['col0'], right_on=['col0'], suffixes=['', '_x'])
+px.display(df, '$0')
+)pxl";
+
+std::unique_ptr<Carnot> SetUpCarnot(std::shared_ptr<table_store::TableStore> table_store,
+                                    exec::LocalGRPCResultSinkServer* server) {
+  auto func_registry = std::make_unique<px::carnot::udf::Registry>("default_registry");
+  funcs::RegisterFuncsOrDie(func_registry.get());
+  auto clients_config = std::make_unique<Carnot::ClientsConfig>(Carnot::ClientsConfig{
+      [server](const std::string& address, const std::string&) {
+        return server->StubGenerator(address);
+      },
+      [](grpc::ClientContext*) {},
+  });
+  auto server_config = std::make_unique<Carnot::ServerConfig>();
+  server_config->grpc_server_port = 0;
+
+  return px::carnot::Carnot::Create(sole::uuid4(), std::move(func_registry), table_store,
+                                    std::move(clients_config), std::move(server_config))
+      .ConsumeValueOrDie();
+}
+
+// Joins two tables of [col0, col1:INT64] on col0.
+// INT64 keys are drawn from [0, 100], so every probe row matches many build rows. STRING keys are
+// random strings that differ between the two tables, so no probe row has a match and almost all of
+// them are dropped by the bloom filter.
+// NOLINTNEXTLINE : runtime/references.
+void BM_Join(benchmark::State& state, const std::string& query, types::DataType key_type,
+             bool spill) {
+  const datagen::UniformParams selection_params(0, 1 << 12);
+  const datagen::UniformParams length_params(16, 16);
+  std::vector<types::DataType> types = {key_type, types::DataType::INT64};
+  std::vector<datagen::DistributionType> distribution_types = {
+      datagen::DistributionType::kUniform, datagen::DistributionType::kUniform};
+  constexpr int64_t kNumBatches = 20;
+
+  auto prev_spill_dir = FLAGS_carnot_join_spill_dir;
+  auto prev_memory_budget = FLAGS_carnot_join_memory_budget_bytes;
+  if (spill) {
+    // Spill every build batch, to measure the worst case of reading the build side back in.
+    FLAGS_carnot_join_spill_dir =
+        (std::filesystem::temp_directory_path() / "join_benchmark").string();
+    FLAGS_carnot_join_memory_budget_bytes = 0;
+  }
+
+  auto table_store = std::make_shared<table_store::TableStore>();
+  auto server = exec::LocalGRPCResultSinkServer();
+  auto carnot = SetUpCarnot(table_store, &server);
+  for (const auto& table_name : {"left_table", "right_table"}) {
+    auto table = table_store::CreateTable(types, distribution_types, state.range(0), kNumBatches,
+                                          &selection_params, &length_params)
+                     .ConsumeValueOrDie();
+    table_store->AddTable(table_name, table);
+  }
+
+  int64_t bytes_processed = 0;
+  int i = 0;
+  for (auto _ : state) {
+    auto query_with_table_name = absl::Substitute(query, "results_" + std::to_string(i));
+    auto res = carnot->ExecuteQuery(query_with_table_name, sole::uuid4(), CurrentTimeNS());
+    if (!res.ok()) {
+      LOG(FATAL) << "Join benchmark query did not execute successfully.";
+    }
+    bytes_processed += server.exec_stats().ConsumeValueOrDie().execution_stats().bytes_processed();
+    server.ResetQueryResults();
+    ++i;
+  }
+  state.SetBytesProcessed(int64_t(bytes_processed));
+
+  FLAGS_carnot_join_spill_dir = prev_spill_dir;
+  FLAGS_carnot_join_memory_budget_bytes = prev_memory_budget;
+}
+
+BENCHMARK_CAPTURE(BM_Join, inner_join_int_matches, kInnerJoinQuery, types::DataType::INT64,
+                  /*spill*/ false)
+    ->RangeMultiplier(2)
+    ->Range(64, 1 << 8);
+
+BENCHMARK_CAPTURE(BM_Join, inner_join_int_matches_spilled, kInnerJoinQuery,
+                  types::DataType::INT64, /*spill*/ true)
+    ->RangeMultiplier(2)
+    ->Range(64, 1 << 8);
+
+BENCHMARK_CAPTURE(BM_Join, inner_join_string_no_matches, kInnerJoinQuery,
+                  types::DataType::STRING, /*spill*/ false)
+    ->RangeMultiplier(4)
+    ->Range(64, 1 << 14);
+
+BENCHMARK_CAPTURE(BM_Join, left_join_string_no_matches, kLeftJoinQuery, types::DataType::STRING,
+                  /*spill*/ false)
+    ->RangeMultiplier(4)
+    ->Range(64, 1 << 14);
+
+BENCHMARK_CAPTURE(BM_Join, inner_join_string_no_matches_spilled, kInnerJoinQuery,
+                  types::DataType::STRING, /*spill*/ true)
+    ->RangeMultiplier(4)
+    ->Range(64, 1 << 14);
+
+}  // namespace carnot
+}  // namespace px
@@ -75,6 +75,8 @@ std::unique_ptr<Operator> Operator::FromProto(const planpb::Operator& pb, int64_
       return CreateOperator<FilterOperator>(id, pb.filter_op());
     case planpb::LIMIT_OPERATOR:
       return CreateOperator<LimitOperator>(id, pb.limit_op());
+    case planpb::TOP_K_OPERATOR:
+      return CreateOperator<TopKOperator>(id, pb.top_k_op());
     case planpb::UNION_OPERATOR:
       return CreateOperator<UnionOperator>(id, pb.union_op());
     case planpb::JOIN_OPERATOR:
@@ -454,6 +456,73 @@ StatusOr<table_store::schema::Relation> LimitOperator::OutputRelation(
   return output_relation;
 }
 
+/**
+ * TopK Operator Implementation.
+ */
+std::string TopKOperator::DebugString() const {
+  std::vector<std::string> order_by;
+  for (const auto& col : order_by_) {
+    order_by.push_back(absl::Substitute("$0 $1", col.idx, col.descending ? "desc" : "asc"));
+  }
+  return absl::Substitute("Op:TopK($0, order_by: [$1], cols: [$2])", k(),
+                          absl::StrJoin(order_by, ","), absl::StrJoin(selected_cols_, ","));
+}
+
+Status TopKOperator::Init(const planpb::TopKOperator& pb) {
+  pb_ = pb;
+  if (pb_.k() < 0) {
+    return error::InvalidArgument("TopK expects a non-negative k, got $0", pb_.k());
+  }
+  if (pb_.order_by_size() == 0) {
+    return error::InvalidArgument("TopK expects at least one column to sort by");
+  }
+
+  order_by_.reserve(pb_.order_by_size());
+  for (const auto& col : pb_.order_by()) {
+    order_by_.push_back(OrderBy{static_cast<int64_t>(col.column().index()), col.descending()});
+  }
+  selected_cols_.reserve(pb_.columns_size());
+  for (const auto& col : pb_.columns()) {
+    selected_cols_.push_back(col.index());
+  }
+
+  is_initialized_ = true;
+  return Status::OK();
+}
+
+StatusOr<table_store::schema::Relation> TopKOperator::OutputRelation(
+    const table_store::schema::Schema& schema, const PlanState& /*state*/,
+    const std::vector<int64_t>& input_ids) const {
+  DCHECK(is_initialized_) << "Not initialized";
+
+  if (input_ids.size() != 1) {
+    return error::InvalidArgument("TopK operator must have exactly one input");
+  }
+  if (!schema.HasRelation(input_ids[0])) {
+    return error::NotFound("Missing relation ($0) for input of TopKOperator", input_ids[0]);
+  }
+
+  PX_ASSIGN_OR_RETURN(const table_store::schema::Relation& input_relation,
+                      schema.GetRelation(input_ids[0]));
+  for (const auto& col : order_by_) {
+    if (col.idx >= static_cast<int64_t>(input_relation.NumColumns())) {
+      return error::InvalidArgument("TopK order by column $0 is out of bounds, got $1 columns",
+                                    col.idx, input_relation.NumColumns());
+    }
+  }
+  table_store::schema::Relation output_relation;
+  for (auto selected_col_idx : selected_cols_) {
+    if (selected_col_idx >= static_cast<int64_t>(input_relation.NumColumns())) {
+      return error::InvalidArgument("TopK column $0 is out of bounds, got $1 columns",
+                                    selected_col_idx, input_relation.NumColumns());
+    }
+    output_relation.AddColumn(input_relation.GetColumnType(selected_col_idx),
+                              input_relation.GetColumnName(selected_col_idx),
+                              input_relation.GetColumnDesc(selected_col_idx));
+  }
+  return output_relation;
+}
+
 /**
  * Zip Operator Implementation.
  */
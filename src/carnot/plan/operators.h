@@ -97,6 +97,7 @@ class MemorySourceOperator : public Operator {
   std::vector<int64_t> Columns() const { return column_idxs_; }
   const types::TabletID& Tablet() const { return pb_.tablet(); }
   bool streaming() const { return pb_.streaming(); }
+  const planpb::MemorySourceOperator& pb() const { return pb_; }
 
  private:
   planpb::MemorySourceOperator pb_;
@@ -117,6 +118,7 @@ class MapOperator : public Operator {
   const std::vector<std::shared_ptr<const ScalarExpression>>& expressions() const {
     return expressions_;
   }
+  const planpb::MapOperator& pb() const { return pb_; }
 
  private:
   std::vector<std::shared_ptr<const ScalarExpression>> expressions_;
@@ -146,6 +148,11 @@ class AggregateOperator : public Operator {
   bool windowed() const { return pb_.windowed(); }
   bool partial_agg() const { return pb_.partial_agg(); }
   bool finalize_results() const { return pb_.finalize_results(); }
+  bool has_sliding_window() const { return pb_.has_sliding_window(); }
+  const planpb::AggregateOperator::SlidingWindow& sliding_window() const {
+    return pb_.sliding_window();
+  }
+  const planpb::AggregateOperator& pb() const { return pb_; }
 
  private:
   std::vector<std::shared_ptr<AggregateExpression>> values_;
@@ -217,6 +224,10 @@ class GRPCSinkOperator : public Operator {
   }
   std::string table_name() const { return pb_.output_table().table_name(); }
 
+  planpb::GRPCSinkOperator::RowBatchEncoding row_batch_encoding() const {
+    return pb_.row_batch_encoding();
+  }
+
  private:
   planpb::GRPCSinkOperator pb_;
 };
@@ -234,6 +245,7 @@ class FilterOperator : public Operator {
   std::vector<int64_t> selected_cols() { return selected_cols_; }
 
   const std::shared_ptr<const ScalarExpression>& expression() const { return expression_; }
+  const planpb::FilterOperator& pb() const { return pb_; }
 
  private:
   std::shared_ptr<const ScalarExpression> expression_;
@@ -264,6 +276,32 @@ class LimitOperator : public Operator {
   planpb::LimitOperator pb_;
 };
 
+class TopKOperator : public Operator {
+ public:
+  explicit TopKOperator(int64_t id) : Operator(id, planpb::TOP_K_OPERATOR) {}
+  ~TopKOperator() override = default;
+
+  StatusOr<table_store::schema::Relation> OutputRelation(
+      const table_store::schema::Schema& schema, const PlanState& state,
+      const std::vector<int64_t>& input_ids) const override;
+  Status Init(const planpb::TopKOperator& pb);
+  std::string DebugString() const override;
+
+  struct OrderBy {
+    int64_t idx;
+    bool descending;
+  };
+
+  const std::vector<OrderBy>& order_by() const { return order_by_; }
+  int64_t k() const { return pb_.k(); }
+  const std::vector<int64_t>& selected_cols() const { return selected_cols_; }
+
+ private:
+  std::vector<OrderBy> order_by_;
+  std::vector<int64_t> selected_cols_;
+  planpb::TopKOperator pb_;
+};
+
 class UnionOperator : public Operator {
  public:
   explicit UnionOperator(int64_t id) : Operator(id, planpb::UNION_OPERATOR) {}
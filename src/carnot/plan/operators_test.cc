@@ -239,6 +239,22 @@ TEST_F(OperatorTest, from_proto_drop_limit) {
   auto limit_typed_op = static_cast<LimitOperator*>(limit_op.get());
   EXPECT_THAT(limit_typed_op->selected_cols(), ElementsAre(0, 2));
 }
+TEST_F(OperatorTest, from_proto_top_k) {
+  auto top_k_pb = planpb::testutils::CreateTestTopK1PB();
+  auto top_k_op = Operator::FromProto(top_k_pb, 1);
+  EXPECT_EQ(1, top_k_op->id());
+  EXPECT_TRUE(top_k_op->is_initialized());
+  EXPECT_EQ(planpb::OperatorType::TOP_K_OPERATOR, top_k_op->op_type());
+  auto top_k_typed_op = static_cast<TopKOperator*>(top_k_op.get());
+  EXPECT_EQ(3, top_k_typed_op->k());
+  ASSERT_EQ(2, top_k_typed_op->order_by().size());
+  EXPECT_EQ(1, top_k_typed_op->order_by()[0].idx);
+  EXPECT_TRUE(top_k_typed_op->order_by()[0].descending);
+  EXPECT_EQ(0, top_k_typed_op->order_by()[1].idx);
+  EXPECT_FALSE(top_k_typed_op->order_by()[1].descending);
+  EXPECT_THAT(top_k_typed_op->selected_cols(), ElementsAre(0, 1));
+}
+
 TEST_F(OperatorTest, from_proto_join_with_time) {
   auto join_pb = planpb::testutils::CreateTestJoinWithTimePB();
   auto join_op = std::make_unique<JoinOperator>(1);
@@ -415,6 +431,18 @@ TEST_F(OperatorTest, output_relation_drop_limit) {
   EXPECT_EQ(expected_relation, rel);
 }
 
+TEST_F(OperatorTest, output_relation_top_k) {
+  auto top_k_pb = planpb::testutils::CreateTestTopK1PB();
+  auto top_k_op = Operator::FromProto(top_k_pb, 1);
+
+  auto rel =
+      top_k_op->OutputRelation(schema_, *state_, std::vector<int64_t>({0})).ConsumeValueOrDie();
+  Relation expected_relation;
+  expected_relation.AddColumn(types::DataType::INT64, "col0");
+  expected_relation.AddColumn(types::DataType::FLOAT64, "col1");
+  EXPECT_EQ(expected_relation, rel);
+}
+
 TEST_F(OperatorTest, output_relation_union) {
   auto union_pb = planpb::testutils::CreateTestUnionOrderedPB();
   auto union_op = Operator::FromProto(union_pb, 4);
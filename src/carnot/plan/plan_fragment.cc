@@ -77,6 +77,9 @@ Status PlanFragmentWalker::CallWalkFn(const Operator& op) {
     case planpb::OperatorType::LIMIT_OPERATOR:
       PX_RETURN_IF_ERROR(CallAs<LimitOperator>(on_limit_walk_fn_, op));
       break;
+    case planpb::OperatorType::TOP_K_OPERATOR:
+      PX_RETURN_IF_ERROR(CallAs<TopKOperator>(on_top_k_walk_fn_, op));
+      break;
     case planpb::OperatorType::JOIN_OPERATOR:
       PX_RETURN_IF_ERROR(CallAs<JoinOperator>(on_join_walk_fn_, op));
       break;
@@ -0,0 +1,82 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <vector>
+
+#include "src/carnot/planner/compiler/analyzer/merge_rolling_into_blocking_agg_rule.h"
+#include "src/carnot/planner/ir/metadata_ir.h"
+
+namespace px {
+namespace carnot {
+namespace planner {
+namespace compiler {
+
+StatusOr<bool> MergeRollingIntoBlockingAggRule::Apply(IRNode* ir_node) {
+  if (Match(ir_node, OperatorWithParent(BlockingAgg(), Rolling()))) {
+    return MergeRollingIntoAgg(static_cast<BlockingAggIR*>(ir_node));
+  }
+  return false;
+}
+
+StatusOr<bool> MergeRollingIntoBlockingAggRule::MergeRollingIntoAgg(BlockingAggIR* agg) {
+  DCHECK_EQ(agg->parents().size(), 1UL);
+  RollingIR* rolling = static_cast<RollingIR*>(agg->parents()[0]);
+  if (agg->has_sliding_window()) {
+    return agg->CreateIRNodeError("Cannot apply a rolling window to an aggregate more than once");
+  }
+
+  std::vector<ColumnIR*> new_groups;
+  for (ColumnIR* g : rolling->groups()) {
+    PX_ASSIGN_OR_RETURN(ColumnIR * col, CopyColumn(g));
+    new_groups.push_back(col);
+  }
+  new_groups.insert(new_groups.end(), agg->groups().begin(), agg->groups().end());
+  PX_RETURN_IF_ERROR(agg->SetGroups(new_groups));
+
+  PX_ASSIGN_OR_RETURN(ColumnIR * time_col, CopyColumn(rolling->window_col()));
+  PX_RETURN_IF_ERROR(
+      agg->SetSlidingWindow(time_col, rolling->window_size(), rolling->slide_size()));
+
+  DCHECK_EQ(rolling->parents().size(), 1UL);
+  PX_RETURN_IF_ERROR(agg->ReplaceParent(rolling, rolling->parents()[0]));
+
+  // Other aggs might still follow the rolling, in which case they remove it once they are merged.
+  if (rolling->Children().empty()) {
+    auto graph = rolling->graph();
+    auto rolling_children = graph->dag().DependenciesOf(rolling->id());
+    PX_RETURN_IF_ERROR(graph->DeleteNode(rolling->id()));
+    for (const auto& child_id : rolling_children) {
+      PX_RETURN_IF_ERROR(graph->DeleteOrphansInSubtree(child_id));
+    }
+  }
+  return true;
+}
+
+StatusOr<ColumnIR*> MergeRollingIntoBlockingAggRule::CopyColumn(ColumnIR* g) {
+  if (Match(g, Metadata())) {
+    return g->graph()->CreateNode<MetadataIR>(g->ast(), g->col_name(),
+                                              g->container_op_parent_idx());
+  }
+
+  return g->graph()->CreateNode<ColumnIR>(g->ast(), g->col_name(), g->container_op_parent_idx());
+}
+
+}  // namespace compiler
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
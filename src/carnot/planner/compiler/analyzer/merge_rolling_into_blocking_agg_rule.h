@@ -0,0 +1,55 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include "src/carnot/planner/compiler_state/compiler_state.h"
+#include "src/carnot/planner/ir/blocking_agg_ir.h"
+#include "src/carnot/planner/ir/column_ir.h"
+#include "src/carnot/planner/ir/rolling_ir.h"
+#include "src/carnot/planner/rules/rules.h"
+
+namespace px {
+namespace carnot {
+namespace planner {
+namespace compiler {
+
+/**
+ * @brief This rule finds every agg that follows a rolling and turns it into a sliding window agg
+ * over the rolling's window column, with the groups of the rolling added to the agg's groups.
+ *
+ * Must run after MergeGroupByIntoGroupAcceptorRule, so that the groups of a groupby before the
+ * rolling are already part of the rolling. The rolling is removed once no agg follows it anymore.
+ */
+class MergeRollingIntoBlockingAggRule : public Rule {
+ public:
+  MergeRollingIntoBlockingAggRule()
+      : Rule(nullptr, /*use_topo*/ false, /*reverse_topological_execution*/ false) {}
+
+ protected:
+  StatusOr<bool> Apply(IRNode* ir_node) override;
+
+ private:
+  StatusOr<bool> MergeRollingIntoAgg(BlockingAggIR* agg);
+  StatusOr<ColumnIR*> CopyColumn(ColumnIR* g);
+};
+
+}  // namespace compiler
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
@@ -2729,6 +2729,51 @@ TEST_F(CompilerTest, RollingNonTimeUnsupported) {
               HasCompilerError("Windowing is only supported on time_ at the moment"));
 }
 
+constexpr char kRollingAggQuery[] = R"pxl(
+import px
+t1 = px.DataFrame(table='http_events', select=['time_', 'remote_addr', 'resp_latency_ns'])
+t1 = t1.groupby('remote_addr').rolling('60s', slide='10s').agg(
+    latency=('resp_latency_ns', px.mean),
+)
+px.display(t1)
+)pxl";
+TEST_F(CompilerTest, RollingAggIsSlidingWindowAgg) {
+  auto graph_or_s = compiler_.CompileToIR(kRollingAggQuery, compiler_state_.get());
+  ASSERT_OK(graph_or_s);
+  auto graph = graph_or_s.ConsumeValueOrDie();
+
+  EXPECT_EQ(graph->FindNodesOfType(IRNodeType::kRolling).size(), 0);
+  std::vector<IRNode*> agg_nodes = graph->FindNodesThatMatch(BlockingAgg());
+  ASSERT_EQ(agg_nodes.size(), 1);
+  auto agg = static_cast<BlockingAggIR*>(agg_nodes[0]);
+  ASSERT_TRUE(agg->has_sliding_window());
+  ASSERT_EQ(agg->groups().size(), 1);
+  EXPECT_EQ(agg->groups()[0]->col_name(), "remote_addr");
+
+  planpb::Operator op;
+  ASSERT_OK(agg->ToProto(&op));
+  const auto& window = op.agg_op().sliding_window();
+  // time_ stays the first column of the memory source.
+  EXPECT_EQ(window.time_column().index(), 0);
+  EXPECT_EQ(window.window_ns(), 60 * 1000 * 1000 * 1000L);
+  EXPECT_EQ(window.slide_ns(), 10 * 1000 * 1000 * 1000L);
+  Relation agg_relation({types::STRING, types::FLOAT64}, {"remote_addr", "latency"});
+  EXPECT_THAT(*agg->resolved_table_type(), IsTableType(agg_relation));
+}
+
+constexpr char kRollingBadSlideQuery[] = R"pxl(
+import px
+t1 = px.DataFrame(table='http_events', select=['time_', 'resp_latency_ns'])
+t1 = t1.rolling('60s', slide='7s').agg(latency=('resp_latency_ns', px.mean))
+px.display(t1)
+)pxl";
+TEST_F(CompilerTest, RollingSlideMustDivideWindow) {
+  auto graph_or_s = compiler_.CompileToIR(kRollingBadSlideQuery, compiler_state_.get());
+  ASSERT_NOT_OK(graph_or_s);
+
+  EXPECT_THAT(graph_or_s.status(), HasCompilerError("Slide must be > 0 and evenly divide"));
+}
+
 const char* kFunctionOptimizationQuery = R"pxl(
 import px
 bytes_per_mb = 1024.0 * 1024.0
@@ -128,11 +128,15 @@ bool DoTimeIntervalsMerge(MemorySourceIR* src_a, MemorySourceIR* src_b) {
     auto time_start_a = src_a->time_start_ns();
     auto time_start_b = src_b->time_start_ns();
     can_merge &= (time_start_a == time_start_b);
+    // The plan cache moves relative times along with the compile time, so they can't merge with
+    // an absolute time.
+    can_merge &= (src_a->time_start_relative_to_now() == src_b->time_start_relative_to_now());
   }
   if (src_a->IsTimeStopSet()) {
     auto time_stop_a = src_a->time_stop_ns();
     auto time_stop_b = src_b->time_stop_ns();
     can_merge &= (time_stop_a == time_stop_b);
+    can_merge &= (src_a->time_stop_relative_to_now() == src_b->time_stop_relative_to_now());
   }
 
   return can_merge;
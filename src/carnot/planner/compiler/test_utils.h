@@ -568,8 +568,14 @@ class OperatorTests : public ::testing::Test {
   }
 
   RollingIR* MakeRolling(OperatorIR* parent, ColumnIR* window_col, int64_t window_size) {
+    return MakeRolling(parent, window_col, window_size, window_size);
+  }
+
+  RollingIR* MakeRolling(OperatorIR* parent, ColumnIR* window_col, int64_t window_size,
+                         int64_t slide_size) {
     RollingIR* rolling =
-        graph->CreateNode<RollingIR>(ast, parent, window_col, window_size).ConsumeValueOrDie();
+        graph->CreateNode<RollingIR>(ast, parent, window_col, window_size, slide_size)
+            .ConsumeValueOrDie();
     return rolling;
   }
 
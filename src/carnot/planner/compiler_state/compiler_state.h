@@ -176,6 +176,11 @@ class CompilerState : public NotCopyable {
   PluginConfig* plugin_config() { return plugin_config_.get(); }
   const DebugInfo& debug_info() { return debug_info_; }
 
+  // Whether time_now() ended up in the plan other than through the relative start and stop times
+  // of memory sources, e.g. through px.now(), so the plan can't be reused at a later time.
+  bool plan_depends_on_time_now() const { return plan_depends_on_time_now_; }
+  void set_plan_depends_on_time_now() { plan_depends_on_time_now_ = true; }
+
  private:
   std::unique_ptr<RelationMap> relation_map_;
   SensitiveColumnMap table_names_to_sensitive_columns_;
@@ -191,6 +196,7 @@ class CompilerState : public NotCopyable {
   std::unique_ptr<planpb::OTelEndpointConfig> endpoint_config_ = nullptr;
   std::unique_ptr<PluginConfig> plugin_config_ = nullptr;
   DebugInfo debug_info_;
+  bool plan_depends_on_time_now_ = false;
 };
 
 }  // namespace planner
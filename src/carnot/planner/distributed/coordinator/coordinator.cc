@@ -194,11 +194,10 @@ StatusOr<std::unique_ptr<DistributedPlan>> CoordinatorImpl::CoordinateImpl(const
   remote_carnot->AddPlan(remote_plan);
   distributed_plan->AddPlan(std::move(remote_plan_uptr));
 
-  std::vector<int64_t> source_node_ids;
-  for (const auto& [i, data_store_info] : Enumerate(data_store_nodes_)) {
-    PX_ASSIGN_OR_RETURN(int64_t source_node_id, distributed_plan->AddCarnot(data_store_info));
+  PX_ASSIGN_OR_RETURN(std::vector<int64_t> source_node_ids,
+                      distributed_plan->AddCarnots(data_store_nodes_));
+  for (int64_t source_node_id : source_node_ids) {
     distributed_plan->AddEdge(source_node_id, remote_node_id);
-    source_node_ids.push_back(source_node_id);
   }
 
   PX_ASSIGN_OR_RETURN(auto agent_schema_map,
@@ -18,24 +18,144 @@
 
 #include "src/carnot/planner/distributed/distributed_plan/distributed_plan.h"
 
+#include <algorithm>
+#include <functional>
+#include <thread>
+
+#include "src/carnot/planner/ir/grpc_sink_ir.h"
+
+DEFINE_int32(planner_threads, gflags::Int32FromEnv("PL_PLANNER_THREADS", 4),
+             "The number of threads that the planner generates the plans of the Carnot instances "
+             "of large clusters on.");
+
 namespace px {
 namespace carnot {
 namespace planner {
 namespace distributed {
 
+namespace {
+
+// Plans with fewer Carnot instances than this per thread are generated on the calling thread only.
+constexpr int64_t kMinCarnotInstancesPerThread = 64;
+
+/**
+ * Runs fn(i) for every i in [0, n) on up to FLAGS_planner_threads threads.
+ *
+ * @return the first error that fn returned, if any.
+ */
+Status ParallelFor(int64_t n, const std::function<Status(int64_t)>& fn) {
+  int64_t num_threads =
+      std::min<int64_t>(FLAGS_planner_threads, n / kMinCarnotInstancesPerThread);
+  if (num_threads <= 1) {
+    for (int64_t i = 0; i < n; ++i) {
+      PX_RETURN_IF_ERROR(fn(i));
+    }
+    return Status::OK();
+  }
+
+  std::vector<Status> statuses(num_threads);
+  std::vector<std::thread> threads;
+  threads.reserve(num_threads);
+  for (int64_t thread_idx = 0; thread_idx < num_threads; ++thread_idx) {
+    threads.emplace_back([&, thread_idx] {
+      for (int64_t i = thread_idx; i < n; i += num_threads) {
+        auto s = fn(i);
+        if (!s.ok()) {
+          statuses[thread_idx] = s;
+          return;
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (const auto& s : statuses) {
+    PX_RETURN_IF_ERROR(s);
+  }
+  return Status::OK();
+}
+
+/**
+ * The plan proto of an IR that is shared by Carnot instances, such as all the PEMs that run the
+ * same plan. The IR is only converted to a proto once: the GRPC source IDs of its GRPC sinks are
+ * the only part of the proto that differs between the instances, and are patched in per instance.
+ */
+class SharedPlanProto {
+ public:
+  static StatusOr<SharedPlanProto> Create(const IR* plan, int64_t carnot_id) {
+    SharedPlanProto shared_plan;
+    PX_ASSIGN_OR_RETURN(shared_plan.plan_pb_, plan->ToProto(carnot_id));
+    DCHECK_EQ(1, shared_plan.plan_pb_.nodes_size());
+    const auto& fragment_pb = shared_plan.plan_pb_.nodes(0);
+    for (int node_idx = 0; node_idx < fragment_pb.nodes_size(); ++node_idx) {
+      auto node = plan->Get(fragment_pb.nodes(node_idx).id());
+      if (!Match(node, GRPCSink())) {
+        continue;
+      }
+      auto grpc_sink = static_cast<const GRPCSinkIR*>(node);
+      if (!grpc_sink->has_output_table()) {
+        shared_plan.grpc_sinks_.emplace_back(node_idx, grpc_sink);
+      }
+    }
+    return shared_plan;
+  }
+
+  StatusOr<planpb::Plan> ForCarnot(int64_t carnot_id) const {
+    planpb::Plan plan_pb = plan_pb_;
+    for (const auto& [node_idx, grpc_sink] : grpc_sinks_) {
+      const auto& destination_ids = grpc_sink->agent_id_to_destination_id();
+      auto it = destination_ids.find(carnot_id);
+      if (it == destination_ids.end()) {
+        return grpc_sink->CreateIRNodeError("No agent ID '$0' found in grpc sink '$1'", carnot_id,
+                                            grpc_sink->DebugString());
+      }
+      plan_pb.mutable_nodes(0)
+          ->mutable_nodes(node_idx)
+          ->mutable_op()
+          ->mutable_grpc_sink_op()
+          ->set_grpc_source_id(it->second);
+    }
+    return plan_pb;
+  }
+
+ private:
+  planpb::Plan plan_pb_;
+  // The GRPC sinks whose GRPC source ID depends on the Carnot instance, and their indexes in the
+  // fragment of plan_pb_.
+  std::vector<std::pair<int, const GRPCSinkIR*>> grpc_sinks_;
+};
+
+}  // namespace
+
 StatusOr<distributedpb::DistributedPlan> DistributedPlan::ToProto() const {
   distributedpb::DistributedPlan physical_plan_pb;
   auto physical_plan_dag = physical_plan_pb.mutable_dag();
   auto qb_address_to_plan_pb = physical_plan_pb.mutable_qb_address_to_plan();
   auto qb_address_to_dag_id_pb = physical_plan_pb.mutable_qb_address_to_dag_id();
 
-  for (int64_t i : dag_.TopologicalSort()) {
+  std::vector<int64_t> carnot_ids = dag_.TopologicalSort();
+  absl::flat_hash_map<const IR*, SharedPlanProto> shared_plans;
+  for (int64_t i : carnot_ids) {
     CarnotInstance* carnot = Get(i);
     CHECK_EQ(carnot->id(), i) << absl::Substitute("Index in node ($1) and DAG ($0) don't agree.", i,
                                                   carnot->id());
     DCHECK(carnot->plan()) << absl::Substitute("$0 doesn't have a plan set.",
                                                carnot->DebugString());
-    PX_ASSIGN_OR_RETURN(auto plan_proto, carnot->PlanProto());
+    if (shared_plans.contains(carnot->plan())) {
+      continue;
+    }
+    PX_ASSIGN_OR_RETURN(auto shared_plan, SharedPlanProto::Create(carnot->plan(), i));
+    shared_plans.emplace(carnot->plan(), std::move(shared_plan));
+  }
+
+  // Copying the shared plans dominates for clusters with many agents, so it runs in parallel.
+  std::vector<planpb::Plan> plan_pbs(carnot_ids.size());
+  PX_RETURN_IF_ERROR(ParallelFor(carnot_ids.size(), [&](int64_t idx) -> Status {
+    int64_t i = carnot_ids[idx];
+    CarnotInstance* carnot = Get(i);
+    PX_ASSIGN_OR_RETURN(plan_pbs[idx], shared_plans.at(carnot->plan()).ForCarnot(i));
+    auto& plan_proto = plan_pbs[idx];
     for (int64_t parent_i : dag_.ParentsOf(i)) {
       *(plan_proto.add_incoming_agent_ids()) = Get(parent_i)->carnot_info().agent_id();
     }
@@ -50,25 +170,49 @@ StatusOr<distributedpb::DistributedPlan> DistributedPlan::ToProto() const {
       dest->set_grpc_address(exec_complete_address_);
       dest->set_ssl_targetname(exec_complete_ssl_targetname_);
     }
-    (*qb_address_to_plan_pb)[carnot->QueryBrokerAddress()] = plan_proto;
-    (*qb_address_to_dag_id_pb)[carnot->QueryBrokerAddress()] = i;
+    plan_proto.mutable_plan_options()->CopyFrom(plan_options_);
+    return Status::OK();
+  }));
 
-    auto plan_opts = (*qb_address_to_plan_pb)[carnot->QueryBrokerAddress()].mutable_plan_options();
-    plan_opts->CopyFrom(plan_options_);
+  for (const auto& [idx, i] : Enumerate(carnot_ids)) {
+    const auto& qb_address = Get(i)->QueryBrokerAddress();
+    (*qb_address_to_plan_pb)[qb_address] = std::move(plan_pbs[idx]);
+    (*qb_address_to_dag_id_pb)[qb_address] = i;
   }
   dag_.ToProto(physical_plan_dag);
   return physical_plan_pb;
 }
 
 StatusOr<int64_t> DistributedPlan::AddCarnot(const distributedpb::CarnotInfo& carnot_info) {
-  int64_t carnot_id = id_counter_;
-  ++id_counter_;
-  PX_ASSIGN_OR_RETURN(auto instance, CarnotInstance::Create(carnot_id, carnot_info, this));
-  id_to_node_map_.emplace(carnot_id, std::move(instance));
-  PX_ASSIGN_OR_RETURN(sole::uuid uuid, ParseUUID(carnot_info.agent_id()));
-  uuid_to_id_map_[uuid] = carnot_id;
-  dag_.AddNode(carnot_id);
-  return carnot_id;
+  PX_ASSIGN_OR_RETURN(auto carnot_ids, AddCarnots({carnot_info}));
+  return carnot_ids[0];
+}
+
+StatusOr<std::vector<int64_t>> DistributedPlan::AddCarnots(
+    const std::vector<distributedpb::CarnotInfo>& carnot_infos) {
+  // Parsing the metadata filters of the instances dominates for clusters with many agents, so the
+  // instances are created in parallel.
+  std::vector<std::unique_ptr<CarnotInstance>> instances(carnot_infos.size());
+  int64_t first_carnot_id = id_counter_;
+  PX_RETURN_IF_ERROR(ParallelFor(carnot_infos.size(), [&](int64_t idx) -> Status {
+    PX_ASSIGN_OR_RETURN(instances[idx],
+                        CarnotInstance::Create(first_carnot_id + idx, carnot_infos[idx], this));
+    return Status::OK();
+  }));
+
+  std::vector<int64_t> carnot_ids;
+  carnot_ids.reserve(instances.size());
+  for (auto& instance : instances) {
+    int64_t carnot_id = id_counter_;
+    ++id_counter_;
+    DCHECK_EQ(carnot_id, instance->id());
+    PX_ASSIGN_OR_RETURN(sole::uuid uuid, ParseUUID(instance->carnot_info().agent_id()));
+    id_to_node_map_.emplace(carnot_id, std::move(instance));
+    uuid_to_id_map_[uuid] = carnot_id;
+    dag_.AddNode(carnot_id);
+    carnot_ids.push_back(carnot_id);
+  }
+  return carnot_ids;
 }
 
 StatusOr<std::unique_ptr<CarnotInstance>> CarnotInstance::Create(
@@ -33,6 +33,8 @@
 #include "src/common/uuid/uuid.h"
 #include "src/shared/metadata/metadata_filter.h"
 
+DECLARE_int32(planner_threads);
+
 namespace px {
 namespace carnot {
 namespace planner {
@@ -100,6 +102,16 @@ class DistributedPlan {
    */
   StatusOr<int64_t> AddCarnot(const distributedpb::CarnotInfo& carnot_instance);
 
+  /**
+   * @brief Adds Carnot instances into the graph, and assigns them new ids. Creates the instances in
+   * parallel, which matters for clusters with thousands of agents.
+   *
+   * @param carnot_instances the proto representations of the Carnot instances.
+   * @return the ids of the added carnot instances, in order.
+   */
+  StatusOr<std::vector<int64_t>> AddCarnots(
+      const std::vector<distributedpb::CarnotInfo>& carnot_instances);
+
   /**
    * @brief Gets the carnot instance at the index i.
    *
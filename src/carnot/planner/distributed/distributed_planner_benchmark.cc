@@ -0,0 +1,75 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#include <benchmark/benchmark.h>
+
+#include "src/carnot/planner/compiler/compiler.h"
+#include "src/carnot/planner/distributed/distributed_planner.h"
+#include "src/carnot/planner/logical_planner.h"
+#include "src/carnot/planner/test_utils.h"
+#include "src/carnot/udf_exporter/udf_exporter.h"
+#include "src/common/perf/perf.h"
+#include "src/common/testing/testing.h"
+
+namespace px {
+namespace carnot {
+namespace planner {
+namespace distributed {
+
+// Plans a compiled query for a cluster of synthetic PEMs, on the given number of threads.
+// NOLINTNEXTLINE : runtime/references.
+void BM_DistributedPlan(benchmark::State& state) {
+  int64_t num_pems = state.range(0);
+  int32_t prev_num_threads = FLAGS_planner_threads;
+  FLAGS_planner_threads = state.range(1);
+
+  auto info = udfexporter::ExportUDFInfo().ConsumeValueOrDie()->info_pb();
+  RegistryInfo registry_info;
+  EXPECT_OK(registry_info.Init(info));
+  auto logical_state =
+      testutils::CreateManyPEMsOneKelvinPlannerState(num_pems, testutils::kHttpEventsSchema);
+  auto compiler_state =
+      CreateCompilerState(logical_state, &registry_info, /* max_output_rows_per_table */ 0)
+          .ConsumeValueOrDie();
+  compiler::Compiler compiler;
+  auto single_node_plan =
+      compiler.CompileToIR(testutils::kHttpRequestStats, compiler_state.get()).ConsumeValueOrDie();
+  auto planner = DistributedPlanner::Create().ConsumeValueOrDie();
+
+  for (auto _ : state) {
+    auto plan_or_s = planner->Plan(logical_state.distributed_state(), compiler_state.get(),
+                                   single_node_plan.get());
+    EXPECT_OK(plan_or_s);
+    auto plan_pb_or_s = plan_or_s.ConsumeValueOrDie()->ToProto();
+    EXPECT_OK(plan_pb_or_s);
+  }
+  FLAGS_planner_threads = prev_num_threads;
+}
+
+BENCHMARK(BM_DistributedPlan)
+    ->Args({1000, 1})
+    ->Args({1000, 4})
+    ->Args({5000, 1})
+    ->Args({5000, 4})
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace distributed
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
@@ -213,6 +213,42 @@ TEST_F(DistributedPlannerTest, three_agents_one_kelvin) {
   EXPECT_THAT(grpc_sink_destinations, UnorderedElementsAreArray(grpc_source_ids));
 }
 
+TEST_F(DistributedPlannerTest, many_agents_plan_in_parallel) {
+  auto mem_src = MakeMemSource(MakeRelation());
+  compiler_state_->relation_map()->emplace("table", MakeRelation());
+  MakeMemSink(mem_src, "out");
+
+  ResolveTypesRule rule(compiler_state_.get());
+  ASSERT_OK(rule.Execute(graph.get()));
+
+  // Enough PEMs that the plan is generated on several threads.
+  distributedpb::DistributedState ps_pb = LoadDistributedStatePb(kOnePEMOneKelvinDistributedState);
+  auto pem_info = ps_pb.carnot_info(0);
+  for (int64_t i = 2; i <= 300; ++i) {
+    auto new_pem_info = ps_pb.add_carnot_info();
+    *new_pem_info = pem_info;
+    new_pem_info->set_query_broker_address(absl::Substitute("pem$0", i));
+    new_pem_info->mutable_agent_id()->set_low_bits(0x1000 + i);
+    *ps_pb.mutable_schema_info(0)->add_agent_list() = new_pem_info->agent_id();
+  }
+
+  std::unique_ptr<DistributedPlanner> physical_planner =
+      DistributedPlanner::Create().ConsumeValueOrDie();
+  auto plan_proto = [&](int32_t num_threads) {
+    int32_t prev_num_threads = FLAGS_planner_threads;
+    FLAGS_planner_threads = num_threads;
+    auto physical_plan =
+        physical_planner->Plan(ps_pb, compiler_state_.get(), graph.get()).ConsumeValueOrDie();
+    auto plan_pb = physical_plan->ToProto().ConsumeValueOrDie();
+    FLAGS_planner_threads = prev_num_threads;
+    return plan_pb;
+  };
+
+  auto serial_plan_pb = plan_proto(1);
+  EXPECT_EQ(301, serial_plan_pb.qb_address_to_plan_size());
+  EXPECT_THAT(plan_proto(4), EqualsProto(serial_plan_pb.DebugString()));
+}
+
 using DistributedPlannerUDTFTests = DistributedRulesTest;
 TEST_F(DistributedPlannerUDTFTests, UDTFOnlyOnPEMsDoesntRunOnKelvin) {
   uint32_t asid = 123;
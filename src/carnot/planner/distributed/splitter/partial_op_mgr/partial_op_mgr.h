@@ -87,6 +87,19 @@ class LimitOperatorMgr : public PartialOperatorMgr {
                                             OperatorIR* op) const override;
 };
 
+/**
+ * @brief TopKOperatorMgr manages splitting a TopK into a TopK on each data source and a TopK that
+ * merges their results. Each source then sends at most k rows over the network instead of all of
+ * its rows.
+ */
+class TopKOperatorMgr : public PartialOperatorMgr {
+ public:
+  bool Matches(OperatorIR* op) const override { return Match(op, TopK()); }
+  StatusOr<OperatorIR*> CreatePrepareOperator(IR* plan, OperatorIR* op) const override;
+  StatusOr<OperatorIR*> CreateMergeOperator(IR* plan, OperatorIR* new_parent,
+                                            OperatorIR* op) const override;
+};
+
 /**
  * @brief AggOperatorMgr manages splitting aggregates into partial aggregate and the merging node
  * over a network boundary.
@@ -98,6 +111,11 @@ class AggOperatorMgr : public PartialOperatorMgr {
       return false;
     }
     BlockingAggIR* agg = static_cast<BlockingAggIR*>(op);
+    // A sliding window agg emits one result per window rather than partial states, so it runs whole
+    // after the data of every agent is merged.
+    if (agg->has_sliding_window()) {
+      return false;
+    }
     for (const auto& col_expr : agg->aggregate_expressions()) {
       if (!Match(col_expr.node, PartialUDA())) {
         return false;
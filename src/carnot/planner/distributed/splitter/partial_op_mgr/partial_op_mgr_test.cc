@@ -20,6 +20,7 @@
 #include <google/protobuf/text_format.h>
 #include <gtest/gtest.h>
 
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -68,6 +69,38 @@ TEST_F(PartialOpMgrTest, limit_test) {
   EXPECT_NE(merge_limit, limit);
 }
 
+TEST_F(PartialOpMgrTest, top_k_test) {
+  auto mem_src = MakeMemSource(MakeRelation());
+  TopKIR* top_k = graph->CreateNode<TopKIR>(ast, mem_src, std::vector<std::string>{"count"},
+                                            /* descending */ true, 10)
+                      .ConsumeValueOrDie();
+  MakeMemSink(top_k, "out");
+
+  TopKOperatorMgr mgr;
+  EXPECT_TRUE(mgr.Matches(top_k));
+  auto prepare_top_k_or_s = mgr.CreatePrepareOperator(graph.get(), top_k);
+  ASSERT_OK(prepare_top_k_or_s);
+  OperatorIR* prepare_top_k_uncasted = prepare_top_k_or_s.ConsumeValueOrDie();
+  ASSERT_MATCH(prepare_top_k_uncasted, TopK());
+  TopKIR* prepare_top_k = static_cast<TopKIR*>(prepare_top_k_uncasted);
+  EXPECT_EQ(prepare_top_k->k(), top_k->k());
+  EXPECT_THAT(prepare_top_k->order_by_cols(), ElementsAre("count"));
+  EXPECT_TRUE(prepare_top_k->descending());
+  EXPECT_EQ(prepare_top_k->parents(), top_k->parents());
+  EXPECT_NE(prepare_top_k, top_k);
+
+  auto mem_src2 = MakeMemSource(MakeRelation());
+  auto merge_top_k_or_s = mgr.CreateMergeOperator(graph.get(), mem_src2, top_k);
+  ASSERT_OK(merge_top_k_or_s);
+  OperatorIR* merge_top_k_uncasted = merge_top_k_or_s.ConsumeValueOrDie();
+  ASSERT_MATCH(merge_top_k_uncasted, TopK());
+  TopKIR* merge_top_k = static_cast<TopKIR*>(merge_top_k_uncasted);
+  EXPECT_EQ(merge_top_k->k(), top_k->k());
+  EXPECT_THAT(merge_top_k->order_by_cols(), ElementsAre("count"));
+  EXPECT_EQ(merge_top_k->parents()[0], mem_src2);
+  EXPECT_NE(merge_top_k, top_k);
+}
+
 TEST_F(PartialOpMgrTest, agg_test) {
   auto relation = MakeRelation();
   relation.AddColumn(types::STRING, "service");
@@ -62,12 +62,27 @@ Status BlockingAggIR::SetAggExprs(const ColExpressionVector& agg_exprs) {
   return Status::OK();
 }
 
+Status BlockingAggIR::SetSlidingWindow(ColumnIR* time_col, int64_t window_ns, int64_t slide_ns) {
+  if (slide_ns <= 0 || window_ns % slide_ns != 0) {
+    return CreateIRNodeError(
+        "Sliding window of $0ns must be a positive multiple of its slide of $1ns", window_ns,
+        slide_ns);
+  }
+  PX_ASSIGN_OR_RETURN(window_time_col_, graph()->OptionallyCloneWithEdge(this, time_col));
+  window_ns_ = window_ns;
+  slide_ns_ = slide_ns;
+  return Status::OK();
+}
+
 StatusOr<std::vector<absl::flat_hash_set<std::string>>> BlockingAggIR::RequiredInputColumns()
     const {
   absl::flat_hash_set<std::string> required;
   for (const auto& group : groups()) {
     required.insert(group->col_name());
   }
+  if (has_sliding_window()) {
+    required.insert(window_time_col_->col_name());
+  }
   for (const auto& agg_expr : aggregate_expressions_) {
     PX_ASSIGN_OR_RETURN(auto ret, agg_expr.node->InputColumnNames());
     required.insert(ret.begin(), ret.end());
@@ -138,6 +153,12 @@ Status BlockingAggIR::ToProto(planpb::Operator* op) const {
   pb->set_windowed(false);
   pb->set_partial_agg(partial_agg_);
   pb->set_finalize_results(finalize_results_);
+  if (has_sliding_window()) {
+    auto window_pb = pb->mutable_sliding_window();
+    PX_RETURN_IF_ERROR(window_time_col_->ToProto(window_pb->mutable_time_column()));
+    window_pb->set_window_ns(window_ns_);
+    window_pb->set_slide_ns(slide_ns_);
+  }
 
   op->set_op_type(planpb::AGGREGATE_OPERATOR);
   return Status::OK();
@@ -167,6 +188,13 @@ Status BlockingAggIR::CopyFromNodeImpl(
   partial_agg_ = blocking_agg->partial_agg_;
   pre_split_proto_ = blocking_agg->pre_split_proto_;
 
+  if (blocking_agg->has_sliding_window()) {
+    PX_ASSIGN_OR_RETURN(ColumnIR * new_time_col,
+                        graph()->CopyNode(blocking_agg->window_time_col_, copied_nodes_map));
+    PX_RETURN_IF_ERROR(
+        SetSlidingWindow(new_time_col, blocking_agg->window_ns_, blocking_agg->slide_ns_));
+  }
+
   return Status::OK();
 }
 
@@ -177,6 +205,9 @@ Status BlockingAggIR::ResolveType(CompilerState* compiler_state) {
     PX_RETURN_IF_ERROR(ResolveExpressionType(group_col, compiler_state, parent_types()));
     new_table->AddColumn(group_col->col_name(), group_col->resolved_type());
   }
+  if (has_sliding_window()) {
+    PX_RETURN_IF_ERROR(ResolveExpressionType(window_time_col_, compiler_state, parent_types()));
+  }
   for (const auto& col_expr : aggregate_expressions_) {
     PX_RETURN_IF_ERROR(ResolveExpressionType(col_expr.node, compiler_state, parent_types()));
     new_table->AddColumn(col_expr.name, col_expr.node->resolved_type());
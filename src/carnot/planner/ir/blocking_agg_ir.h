@@ -71,6 +71,17 @@ class BlockingAggIR : public GroupAcceptorIR {
 
   bool partial_agg() const { return partial_agg_; }
   bool finalize_results() const { return finalize_results_; }
+
+  /**
+   * @brief Makes this agg emit a result for the last window_ns of time_col every slide_ns, instead
+   * of a single result at the end of the stream.
+   */
+  Status SetSlidingWindow(ColumnIR* time_col, int64_t window_ns, int64_t slide_ns);
+  bool has_sliding_window() const { return window_time_col_ != nullptr; }
+  ColumnIR* window_time_col() const { return window_time_col_; }
+  int64_t window_ns() const { return window_ns_; }
+  int64_t slide_ns() const { return slide_ns_; }
+
   void SetPreSplitProto(const planpb::AggregateOperator& pre_split_proto) {
     pre_split_proto_ = pre_split_proto;
   }
@@ -88,6 +99,10 @@ class BlockingAggIR : public GroupAcceptorIR {
   // Whether this finalizes the result of a partial aggregate.
   bool finalize_results_ = true;
   planpb::AggregateOperator pre_split_proto_;
+  // The time column of the sliding window, or nullptr if this agg isn't windowed.
+  ColumnIR* window_time_col_ = nullptr;
+  int64_t window_ns_ = 0;
+  int64_t slide_ns_ = 0;
 };
 }  // namespace planner
 }  // namespace carnot
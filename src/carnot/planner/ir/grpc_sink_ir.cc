@@ -18,6 +18,13 @@
 
 #include "src/carnot/planner/ir/grpc_sink_ir.h"
 
+DEFINE_string(grpc_sink_row_batch_encoding,
+              gflags::StringFromEnv("PL_GRPC_SINK_ROW_BATCH_ENCODING",
+                                    "ROW_BATCH_ENCODING_COLUMNAR"),
+              "How row batches are encoded when they are sent between Carnot instances. One of "
+              "ROW_BATCH_ENCODING_PROTO, ROW_BATCH_ENCODING_COLUMNAR and "
+              "ROW_BATCH_ENCODING_COLUMNAR_ZLIB.");
+
 namespace px {
 namespace carnot {
 namespace planner {
@@ -62,6 +69,16 @@ Status GRPCSinkIR::ToProto(planpb::Operator* op, int64_t agent_id) const {
     return CreateIRNodeError("No agent ID '$0' found in grpc sink '$1'", agent_id, DebugString());
   }
   pb->set_grpc_source_id(agent_id_to_destination_id_.find(agent_id)->second);
+
+  // Row batches sent to other Carnot instances don't have to be readable by anything else, so they
+  // can use the cheaper columnar encoding.
+  planpb::GRPCSinkOperator::RowBatchEncoding encoding;
+  if (!planpb::GRPCSinkOperator::RowBatchEncoding_Parse(FLAGS_grpc_sink_row_batch_encoding,
+                                                        &encoding)) {
+    return CreateIRNodeError("Unknown row batch encoding '$0'",
+                             FLAGS_grpc_sink_row_batch_encoding);
+  }
+  pb->set_row_batch_encoding(encoding);
   return Status::OK();
 }
 
@@ -1166,6 +1166,7 @@ constexpr char kExpectedInternalGRPCSinkPb[] = R"proto(
     connection_options {
       ssl_targetname: "$2"
     }
+    row_batch_encoding: ROW_BATCH_ENCODING_COLUMNAR
   }
 )proto";
 
@@ -66,6 +66,12 @@ class MemorySourceIR : public OperatorIR {
   bool IsTimeStartSet() const { return time_start_ns_.has_value(); }
   bool IsTimeStopSet() const { return time_stop_ns_.has_value(); }
 
+  // Whether the start or stop time was given relative to the compile time, e.g. as '-5m'.
+  bool time_start_relative_to_now() const { return time_start_relative_to_now_; }
+  bool time_stop_relative_to_now() const { return time_stop_relative_to_now_; }
+  void set_time_start_relative_to_now(bool relative) { time_start_relative_to_now_ = relative; }
+  void set_time_stop_relative_to_now(bool relative) { time_stop_relative_to_now_ = relative; }
+
   std::string DebugString() const override;
 
   int64_t time_start_ns() const { return time_start_ns_.value(); }
@@ -116,6 +122,8 @@ class MemorySourceIR : public OperatorIR {
 
   std::optional<int64_t> time_start_ns_;
   std::optional<int64_t> time_stop_ns_;
+  bool time_start_relative_to_now_ = false;
+  bool time_stop_relative_to_now_ = false;
 
   // Hold of columns in the order that they are selected.
   std::vector<std::string> column_names_;
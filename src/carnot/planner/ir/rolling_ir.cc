@@ -24,10 +24,12 @@ namespace px {
 namespace carnot {
 namespace planner {
 
-Status RollingIR::Init(OperatorIR* parent, ColumnIR* window_col, int64_t window_size) {
+Status RollingIR::Init(OperatorIR* parent, ColumnIR* window_col, int64_t window_size,
+                       int64_t slide_size) {
   PX_RETURN_IF_ERROR(AddParent(parent));
   PX_RETURN_IF_ERROR(SetWindowCol(window_col));
   window_size_ = window_size;
+  slide_size_ = slide_size;
   return Status::OK();
 }
 
@@ -44,6 +46,7 @@ Status RollingIR::CopyFromNodeImpl(const IRNode* source,
   DCHECK(Match(new_window_col, ColumnNode()));
   PX_RETURN_IF_ERROR(SetWindowCol(static_cast<ColumnIR*>(new_window_col)));
   window_size_ = rolling_node->window_size();
+  slide_size_ = rolling_node->slide_size();
   std::vector<ColumnIR*> new_groups;
   for (const ColumnIR* column : rolling_node->groups()) {
     PX_ASSIGN_OR_RETURN(ColumnIR * new_column, graph()->CopyNode(column, copied_nodes_map));
@@ -45,11 +45,12 @@ class RollingIR : public GroupAcceptorIR {
  public:
   RollingIR() = delete;
   explicit RollingIR(int64_t id) : GroupAcceptorIR(id, IRNodeType::kRolling) {}
-  Status Init(OperatorIR* parent, ColumnIR* window_col, int64_t window_size);
+  Status Init(OperatorIR* parent, ColumnIR* window_col, int64_t window_size, int64_t slide_size);
 
   Status ToProto(planpb::Operator*) const override;
   ColumnIR* window_col() const { return window_col_; }
   int64_t window_size() const { return window_size_; }
+  int64_t slide_size() const { return slide_size_; }
 
   Status CopyFromNodeImpl(const IRNode* source,
                           absl::flat_hash_map<const IRNode*, IRNode*>* copied_nodes_map) override;
@@ -65,6 +66,8 @@ class RollingIR : public GroupAcceptorIR {
 
   ColumnIR* window_col_;
   int64_t window_size_;
+  // How far the window moves between results. Equal to window_size_ for tumbling windows.
+  int64_t slide_size_;
 };
 }  // namespace planner
 }  // namespace carnot
@@ -0,0 +1,106 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/planner/ir/top_k_ir.h"
+
+namespace px {
+namespace carnot {
+namespace planner {
+
+Status TopKIR::Init(OperatorIR* parent, const std::vector<std::string>& order_by_cols,
+                    bool descending, int64_t k) {
+  PX_RETURN_IF_ERROR(AddParent(parent));
+  if (order_by_cols.empty()) {
+    return CreateIRNodeError("TopK expects at least one column to sort by");
+  }
+  if (k < 0) {
+    return CreateIRNodeError("TopK expects a non-negative number of rows, got $0", k);
+  }
+  order_by_cols_ = order_by_cols;
+  descending_ = descending;
+  k_ = k;
+  return Status::OK();
+}
+
+Status TopKIR::ResolveType(CompilerState* /* compiler_state */) {
+  DCHECK_EQ(1U, parent_types().size());
+  auto parent_table = std::static_pointer_cast<TableType>(parent_types()[0]);
+  for (const auto& col_name : order_by_cols_) {
+    if (!parent_table->HasColumn(col_name)) {
+      return CreateIRNodeError("Column '$0' not found in parent dataframe", col_name);
+    }
+  }
+  return SetResolvedType(parent_table->Copy());
+}
+
+StatusOr<std::vector<absl::flat_hash_set<std::string>>> TopKIR::RequiredInputColumns() const {
+  DCHECK(is_type_resolved());
+  absl::flat_hash_set<std::string> required(resolved_table_type()->ColumnNames().begin(),
+                                            resolved_table_type()->ColumnNames().end());
+  required.insert(order_by_cols_.begin(), order_by_cols_.end());
+  return std::vector<absl::flat_hash_set<std::string>>{required};
+}
+
+StatusOr<absl::flat_hash_set<std::string>> TopKIR::PruneOutputColumnsToImpl(
+    const absl::flat_hash_set<std::string>& output_cols) {
+  auto kept_cols = output_cols;
+  kept_cols.insert(order_by_cols_.begin(), order_by_cols_.end());
+  return kept_cols;
+}
+
+Status TopKIR::ToProto(planpb::Operator* op) const {
+  auto pb = op->mutable_top_k_op();
+  op->set_op_type(planpb::TOP_K_OPERATOR);
+  DCHECK_EQ(parents().size(), 1UL);
+
+  DCHECK(parents()[0]->is_type_resolved());
+  auto parent_table_type = parents()[0]->resolved_table_type();
+  auto parent_id = parents()[0]->id();
+
+  for (const auto& col_name : order_by_cols_) {
+    if (!parent_table_type->HasColumn(col_name)) {
+      return CreateIRNodeError("Column '$0' not found in parent dataframe", col_name);
+    }
+    auto order_by_pb = pb->add_order_by();
+    order_by_pb->mutable_column()->set_node(parent_id);
+    order_by_pb->mutable_column()->set_index(parent_table_type->GetColumnIndex(col_name));
+    order_by_pb->set_descending(descending_);
+  }
+
+  DCHECK(is_type_resolved());
+  for (const std::string& col_name : resolved_table_type()->ColumnNames()) {
+    planpb::Column* col_pb = pb->add_columns();
+    col_pb->set_node(parent_id);
+    DCHECK(parent_table_type->HasColumn(col_name));
+    col_pb->set_index(parent_table_type->GetColumnIndex(col_name));
+  }
+  pb->set_k(k_);
+  return Status::OK();
+}
+
+Status TopKIR::CopyFromNodeImpl(const IRNode* node, absl::flat_hash_map<const IRNode*, IRNode*>*) {
+  const TopKIR* top_k = static_cast<const TopKIR*>(node);
+  order_by_cols_ = top_k->order_by_cols_;
+  descending_ = top_k->descending_;
+  k_ = top_k->k_;
+  return Status::OK();
+}
+
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,73 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "src/carnot/planner/compiler_state/compiler_state.h"
+#include "src/carnot/planner/ir/operator_ir.h"
+#include "src/carnot/planner/types/types.h"
+#include "src/common/base/base.h"
+
+namespace px {
+namespace carnot {
+namespace planner {
+
+/**
+ * @brief The TopKIR keeps the k rows that sort first by a list of columns. Since the top k of
+ * several inputs is the top k of their top k rows, the splitter runs a TopK next to each data source
+ * and another one where their results are merged.
+ */
+class TopKIR : public OperatorIR {
+ public:
+  TopKIR() = delete;
+  explicit TopKIR(int64_t id) : OperatorIR(id, IRNodeType::kTopK) {}
+  Status Init(OperatorIR* parent, const std::vector<std::string>& order_by_cols, bool descending,
+              int64_t k);
+
+  Status ToProto(planpb::Operator*) const override;
+
+  const std::vector<std::string>& order_by_cols() const { return order_by_cols_; }
+  bool descending() const { return descending_; }
+  int64_t k() const { return k_; }
+
+  Status CopyFromNodeImpl(const IRNode* node,
+                          absl::flat_hash_map<const IRNode*, IRNode*>* copied_nodes_map) override;
+  inline bool IsBlocking() const override { return true; }
+
+  StatusOr<std::vector<absl::flat_hash_set<std::string>>> RequiredInputColumns() const override;
+
+  Status ResolveType(CompilerState* compiler_state);
+
+ protected:
+  // The order by columns are always kept, so that a merging TopK can sort the output of this one.
+  StatusOr<absl::flat_hash_set<std::string>> PruneOutputColumnsToImpl(
+      const absl::flat_hash_set<std::string>& output_cols) override;
+
+ private:
+  std::vector<std::string> order_by_cols_;
+  bool descending_ = false;
+  int64_t k_ = 0;
+};
+
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
@@ -125,24 +125,52 @@ Status LogicalPlanner::Init(const udfspb::UDFInfo& udf_info) {
 
 StatusOr<std::unique_ptr<distributed::DistributedPlan>> LogicalPlanner::Plan(
     const plannerpb::QueryRequest& query_request) {
-  // Compile into the IR.
-
   auto ms = query_request.logical_planner_state().plan_options().max_output_rows_per_table();
   VLOG(1) << "Max output rows: " << ms;
   PX_ASSIGN_OR_RETURN(
       std::unique_ptr<CompilerState> compiler_state,
       CreateCompilerState(query_request.logical_planner_state(), registry_info_.get(), ms));
+  return PlanWithCompilerState(query_request, compiler_state.get());
+}
+
+StatusOr<distributedpb::DistributedPlan> LogicalPlanner::PlanProto(
+    const plannerpb::QueryRequest& query_request) {
+  auto key = PlanCache::Key(query_request);
+  auto cached_plan = plan_cache_.Lookup(key);
+  if (cached_plan != nullptr) {
+    return cached_plan->Bind(px::CurrentTimeNS());
+  }
+
+  auto ms = query_request.logical_planner_state().plan_options().max_output_rows_per_table();
+  PX_ASSIGN_OR_RETURN(
+      std::unique_ptr<CompilerState> compiler_state,
+      CreateCompilerState(query_request.logical_planner_state(), registry_info_.get(), ms));
+  PX_ASSIGN_OR_RETURN(auto distributed_plan,
+                      PlanWithCompilerState(query_request, compiler_state.get()));
+  distributed_plan->SetPlanOptions(query_request.logical_planner_state().plan_options());
+  PX_ASSIGN_OR_RETURN(auto plan_pb, distributed_plan->ToProto());
+  if (!compiler_state->plan_depends_on_time_now()) {
+    PX_ASSIGN_OR_RETURN(std::shared_ptr<const CachedPlan> new_cached_plan,
+                        CachedPlan::Create(*distributed_plan, plan_pb,
+                                           compiler_state->time_now().val));
+    plan_cache_.Insert(key, std::move(new_cached_plan));
+  }
+  return plan_pb;
+}
 
+StatusOr<std::unique_ptr<distributed::DistributedPlan>> LogicalPlanner::PlanWithCompilerState(
+    const plannerpb::QueryRequest& query_request, CompilerState* compiler_state) {
+  // Compile into the IR.
   std::vector<plannerpb::FuncToExecute> exec_funcs(query_request.exec_funcs().begin(),
                                                    query_request.exec_funcs().end());
   PX_ASSIGN_OR_RETURN(
       std::shared_ptr<IR> single_node_plan,
-      compiler_.CompileToIR(query_request.query_str(), compiler_state.get(), exec_funcs));
+      compiler_.CompileToIR(query_request.query_str(), compiler_state, exec_funcs));
   // Create the distributed plan.
   PX_ASSIGN_OR_RETURN(
       auto distributed_plan,
       distributed_planner_->Plan(query_request.logical_planner_state().distributed_state(),
-                                 compiler_state.get(), single_node_plan.get()));
+                                 compiler_state, single_node_plan.get()));
   distributed_plan->SetExecutionCompleteAddress(
       query_request.logical_planner_state().result_address(),
       query_request.logical_planner_state().result_ssl_targetname());
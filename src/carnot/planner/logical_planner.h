@@ -25,6 +25,7 @@
 #include "src/carnot/planner/compiler_state/compiler_state.h"
 #include "src/carnot/planner/distributed/distributed_plan/distributed_plan.h"
 #include "src/carnot/planner/distributed/distributed_planner.h"
+#include "src/carnot/planner/plan_cache.h"
 #include "src/carnot/planner/plannerpb/service.pb.h"
 #include "src/carnot/planner/probes/probes.h"
 #include "src/shared/scriptspb/scripts.pb.h"
@@ -57,6 +58,16 @@ class LogicalPlanner : public NotCopyable {
   StatusOr<std::unique_ptr<distributed::DistributedPlan>> Plan(
       const plannerpb::QueryRequest& query);
 
+  /**
+   * @brief Plans the query and returns the proto of the distributed plan, with the plan options of
+   * the query set. Reuses the plan compiled for an earlier identical query request if it's cached,
+   * moving the relative time ranges of the plan to the current time.
+   *
+   * @param query: QueryRequest
+   * @return distributedpb::DistributedPlan or error if one occurs during compilation.
+   */
+  StatusOr<distributedpb::DistributedPlan> PlanProto(const plannerpb::QueryRequest& query);
+
   StatusOr<std::unique_ptr<compiler::MutationsIR>> CompileTrace(
       const plannerpb::CompileMutationsRequest& mutations_req);
 
@@ -67,12 +78,16 @@ class LogicalPlanner : public NotCopyable {
   Status Init(const udfspb::UDFInfo& udf_info);
 
  protected:
-  LogicalPlanner() {}
+  LogicalPlanner() : plan_cache_(FLAGS_planner_plan_cache_size) {}
 
  private:
+  StatusOr<std::unique_ptr<distributed::DistributedPlan>> PlanWithCompilerState(
+      const plannerpb::QueryRequest& query, CompilerState* compiler_state);
+
   compiler::Compiler compiler_;
   std::unique_ptr<distributed::Planner> distributed_planner_;
   std::unique_ptr<planner::RegistryInfo> registry_info_;
+  PlanCache plan_cache_;
 };
 
 StatusOr<std::unique_ptr<CompilerState>> CreateCompilerState(
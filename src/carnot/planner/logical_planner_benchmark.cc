@@ -45,6 +45,46 @@ void BM_Query(benchmark::State& state) {
 
 BENCHMARK(BM_Query);
 
+plannerpb::QueryRequest ManyPEMsQueryRequest(int64_t num_pems) {
+  plannerpb::QueryRequest query_request;
+  query_request.set_query_str(testutils::kHttpRequestStats);
+  *query_request.mutable_logical_planner_state() =
+      testutils::CreateManyPEMsOneKelvinPlannerState(num_pems, testutils::kHttpEventsSchema);
+  return query_request;
+}
+
+// Plans a query that isn't in the plan cache, as for the first run of a script.
+// NOLINTNEXTLINE : runtime/references.
+void BM_QueryCold(benchmark::State& state) {
+  auto info = udfexporter::ExportUDFInfo().ConsumeValueOrDie()->info_pb();
+  auto planner = LogicalPlanner::Create(info).ConsumeValueOrDie();
+  auto query_request = ManyPEMsQueryRequest(state.range(0));
+  for (auto _ : state) {
+    // Every iteration has different plan options, so it misses the cache.
+    query_request.mutable_logical_planner_state()
+        ->mutable_plan_options()
+        ->set_max_output_rows_per_table(state.iterations() + 1);
+    auto plan_or_s = planner->PlanProto(query_request);
+    EXPECT_OK(plan_or_s);
+  }
+}
+
+// Plans a query that is in the plan cache, as for the later runs of a polled script.
+// NOLINTNEXTLINE : runtime/references.
+void BM_QueryWarm(benchmark::State& state) {
+  auto info = udfexporter::ExportUDFInfo().ConsumeValueOrDie()->info_pb();
+  auto planner = LogicalPlanner::Create(info).ConsumeValueOrDie();
+  auto query_request = ManyPEMsQueryRequest(state.range(0));
+  EXPECT_OK(planner->PlanProto(query_request));
+  for (auto _ : state) {
+    auto plan_or_s = planner->PlanProto(query_request);
+    EXPECT_OK(plan_or_s);
+  }
+}
+
+BENCHMARK(BM_QueryCold)->Arg(2)->Arg(100)->Arg(1000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_QueryWarm)->Arg(2)->Arg(100)->Arg(1000)->Unit(benchmark::kMillisecond);
+
 }  // namespace logical_planner
 }  // namespace planner
 }  // namespace carnot
@@ -941,6 +941,70 @@ px.export(otel_df, px.otel.Data(
 )))otel");
 }
 
+// Returns the start times of the memory sources of the plan, and clears them from the plan.
+std::vector<int64_t> TakeMemorySourceStartTimes(distributedpb::DistributedPlan* plan_pb) {
+  std::vector<int64_t> start_times;
+  for (auto& qb_address_and_plan : *plan_pb->mutable_qb_address_to_plan()) {
+    for (auto& fragment : *qb_address_and_plan.second.mutable_nodes()) {
+      for (auto& node : *fragment.mutable_nodes()) {
+        if (node.op().op_type() != planpb::MEMORY_SOURCE_OPERATOR) {
+          continue;
+        }
+        auto mem_source = node.mutable_op()->mutable_mem_source_op();
+        start_times.push_back(mem_source->start_time().value());
+        mem_source->clear_start_time();
+      }
+    }
+  }
+  return start_times;
+}
+
+TEST_F(LogicalPlannerTest, plan_proto_rebinds_cached_plan) {
+  auto planner = LogicalPlanner::Create(info_).ConsumeValueOrDie();
+  auto state = testutils::CreateTwoPEMsOneKelvinPlannerState(testutils::kHttpEventsSchema);
+  auto query_request = MakeQueryRequest(state, kSimpleQueryDefaultLimit);
+
+  int64_t before = CurrentTimeNS();
+  ASSERT_OK_AND_ASSIGN(auto plan_pb, planner->PlanProto(query_request));
+  int64_t between = CurrentTimeNS();
+  ASSERT_OK_AND_ASSIGN(auto cached_plan_pb, planner->PlanProto(query_request));
+  int64_t after = CurrentTimeNS();
+
+  int64_t window = 120LL * 1000 * 1000 * 1000;
+  auto start_times = TakeMemorySourceStartTimes(&plan_pb);
+  ASSERT_EQ(2, start_times.size());
+  for (auto start_time : start_times) {
+    EXPECT_GE(start_time, before - window);
+    EXPECT_LE(start_time, between - window);
+  }
+  // The cached plan keeps the start time 120s before the time it is reused at.
+  auto cached_start_times = TakeMemorySourceStartTimes(&cached_plan_pb);
+  ASSERT_EQ(2, cached_start_times.size());
+  for (auto start_time : cached_start_times) {
+    EXPECT_GE(start_time, between - window);
+    EXPECT_LE(start_time, after - window);
+  }
+  EXPECT_THAT(cached_plan_pb, EqualsProto(plan_pb.DebugString()));
+}
+
+constexpr char kTimeNowFilterQuery[] = R"pxl(
+import px
+t1 = px.DataFrame(table='http_events', select=['time_'])
+t1 = t1[t1.time_ > px.now() - px.minutes(2)]
+px.display(t1)
+)pxl";
+
+TEST_F(LogicalPlannerTest, plan_proto_doesnt_cache_time_now) {
+  auto planner = LogicalPlanner::Create(info_).ConsumeValueOrDie();
+  auto state = testutils::CreateTwoPEMsOneKelvinPlannerState(testutils::kHttpEventsSchema);
+  auto query_request = MakeQueryRequest(state, kTimeNowFilterQuery);
+
+  // px.now() is compiled into the filter, so the plan is compiled again every time.
+  ASSERT_OK_AND_ASSIGN(auto plan_pb, planner->PlanProto(query_request));
+  ASSERT_OK_AND_ASSIGN(auto next_plan_pb, planner->PlanProto(query_request));
+  EXPECT_THAT(next_plan_pb, ::testing::Not(EqualsProto(plan_pb.DebugString())));
+}
+
 }  // namespace planner
 }  // namespace carnot
 }  // namespace px
@@ -117,12 +117,14 @@ StatusOr<QLObjectPtr> DataFrameConstructor(CompilerState* compiler_state, IR* gr
     PX_ASSIGN_OR_RETURN(auto start_time_ns,
                         ParseAllTimeFormats(compiler_state->time_now().val, start_time));
     mem_source_op->SetTimeStartNS(start_time_ns);
+    mem_source_op->set_time_start_relative_to_now(IsRelativeTime(start_time));
   }
   if (!NoneObject::IsNoneObject(args.GetArg("end_time"))) {
     PX_ASSIGN_OR_RETURN(ExpressionIR * end_time, GetArgAs<ExpressionIR>(ast, args, "end_time"));
     PX_ASSIGN_OR_RETURN(auto end_time_ns,
                         ParseAllTimeFormats(compiler_state->time_now().val, end_time));
     mem_source_op->SetTimeStopNS(end_time_ns);
+    mem_source_op->set_time_stop_relative_to_now(IsRelativeTime(end_time));
   }
   return Dataframe::Create(compiler_state, mem_source_op, visitor);
 }
@@ -270,6 +272,21 @@ StatusOr<QLObjectPtr> LimitHandler(CompilerState* compiler_state, IR* graph, Ope
   return Dataframe::Create(compiler_state, limit_op, visitor);
 }
 
+// Handles the top_k() DataFrame logic.
+StatusOr<QLObjectPtr> TopKHandler(CompilerState* compiler_state, IR* graph, OperatorIR* op,
+                                  const pypa::AstPtr& ast, const ParsedArgs& args,
+                                  ASTVisitor* visitor) {
+  PX_ASSIGN_OR_RETURN(IntIR * rows_node, GetArgAs<IntIR>(ast, args, "n"));
+  PX_ASSIGN_OR_RETURN(std::vector<std::string> order_by_cols,
+                      ParseAsListOfStrings(args.GetArg("by"), "by"));
+  PX_ASSIGN_OR_RETURN(BoolIR * ascending, GetArgAs<BoolIR>(ast, args, "ascending"));
+
+  PX_ASSIGN_OR_RETURN(TopKIR * top_k_op,
+                      graph->CreateNode<TopKIR>(ast, op, order_by_cols, !ascending->val(),
+                                                rows_node->val()));
+  return Dataframe::Create(compiler_state, top_k_op, visitor);
+}
+
 class SubscriptHandler {
  public:
   /**
@@ -400,11 +417,22 @@ StatusOr<QLObjectPtr> RollingHandler(CompilerState* compiler_state, IR* graph, O
     return window_size_node->CreateIRNodeError("Window size must be > 0");
   }
 
+  // Without a slide, consecutive windows don't overlap.
+  int64_t slide_size = window_size;
+  if (!NoneObject::IsNoneObject(args.GetArg("slide"))) {
+    PX_ASSIGN_OR_RETURN(ExpressionIR * slide_size_node, GetArgAs<ExpressionIR>(ast, args, "slide"));
+    PX_ASSIGN_OR_RETURN(slide_size, ParseAllTimeFormats(/* time_now */ 0, slide_size_node));
+    if (slide_size <= 0 || window_size % slide_size != 0) {
+      return slide_size_node->CreateIRNodeError(
+          "Slide must be > 0 and evenly divide the window size of $0ns", window_size);
+    }
+  }
+
   PX_ASSIGN_OR_RETURN(ColumnIR * window_col,
                       graph->CreateNode<ColumnIR>(ast, window_col_name->str(), /* parent_idx */ 0));
 
   PX_ASSIGN_OR_RETURN(RollingIR * rolling_op,
-                      graph->CreateNode<RollingIR>(ast, op, window_col, window_size));
+                      graph->CreateNode<RollingIR>(ast, op, window_col, window_size, slide_size));
   return Dataframe::Create(compiler_state, rolling_op, visitor);
 }
 
@@ -515,6 +543,23 @@ Status Dataframe::Init() {
   PX_RETURN_IF_ERROR(limitfn->SetDocString(kLimitOpDocstring));
   AddMethod(kLimitOpID, limitfn);
 
+  /**
+   * # Equivalent to the python method method syntax:
+   * def top_k(self, n, by, ascending=False):
+   *     ...
+   */
+  PX_ASSIGN_OR_RETURN(
+      std::shared_ptr<FuncObject> top_k_fn,
+      FuncObject::Create(kTopKOpID, {"n", "by", "ascending"}, {{"ascending", "False"}},
+                         /* has_variable_len_args */ false,
+                         /* has_variable_len_kwargs */ false,
+                         std::bind(&TopKHandler, compiler_state_, graph(), op(),
+                                   std::placeholders::_1, std::placeholders::_2,
+                                   std::placeholders::_3),
+                         ast_visitor()));
+  PX_RETURN_IF_ERROR(top_k_fn->SetDocString(kTopKOpDocstring));
+  AddMethod(kTopKOpID, top_k_fn);
+
   /**
    *
    * # Equivalent to the python method method syntax:
@@ -572,11 +617,12 @@ Status Dataframe::Init() {
 
   /**
    * # Equivalent to the python method syntax:
-   * def rolling(self, window, on="time_"):
+   * def rolling(self, window, on="time_", slide=None):
    *     ...
    */
   PX_ASSIGN_OR_RETURN(std::shared_ptr<FuncObject> rolling_fn,
-                      FuncObject::Create(kRollingOpID, {"window", "on"}, {{"on", "'time_'"}},
+                      FuncObject::Create(kRollingOpID, {"window", "on", "slide"},
+                                         {{"on", "'time_'"}, {"slide", "None"}},
                                          /* has_variable_len_args */ false,
                                          /* has_variable_len_kwargs */ false,
                                          std::bind(&RollingHandler, compiler_state_, graph(), op(),
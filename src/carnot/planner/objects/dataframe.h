@@ -281,6 +281,32 @@ class Dataframe : public QLObject {
     px.DataFrame: DataFrame with the first n rows.
   )doc";
 
+  inline static constexpr char kTopKOpID[] = "top_k";
+  inline static constexpr char kTopKOpDocstring[] = R"doc(
+  Return the first n rows in sorted order.
+
+  Returns a DataFrame with the n rows that sort first by the given columns, in sorted order.
+  The rows are picked next to the data before they are sent to be merged, so only n rows per
+  data source leave it.
+
+  :topic: dataframe_ops
+  :opname: TopK
+
+  Examples:
+    df = px.DataFrame('http_events')
+    # Keep the 100 slowest http requests.
+    df = df.top_k(100, by='latency')
+
+  Args:
+    n (int): The number of rows to return.
+    by (string, List[string]): The column(s) to sort by, most significant first.
+    ascending (bool): Whether to return the smallest values instead of the largest. Defaults to
+      False.
+
+  Returns:
+    px.DataFrame: DataFrame with the first n rows in sorted order.
+  )doc";
+
   inline static constexpr char kMergeOpID[] = "merge";
   inline static constexpr char kMergeOpDocstring[] = R"doc(
   Merges the input DataFrame with this one using a database-style join.
@@ -385,16 +411,28 @@ class Dataframe : public QLObject {
   Rolls up data into groups based on the rolling window that it belongs to. Used to define
   window aggregates, the streaming analog of batch aggregates.
 
+  Each result covers the rows of the last `window` of time, and a new result is emitted every
+  `slide`. The windows don't overlap unless a slide smaller than the window is given.
+
   Examples:
     df = px.DataFrame('process_stats')
     df = df.rolling('2s').agg(...)
 
+  Examples:
+    df = px.DataFrame('http_events')
+    df = df.groupby('service').rolling('1m', slide='10s').agg(
+        latency=('latency', px.mean),
+    )
+
 
   :topic: dataframe_ops
   :opname: Rolling Window
 
   Args:
     window (px.Duration): the size of the rolling window.
+    on (string): the time column that assigns rows to windows. Only time_ is supported.
+    slide (px.Duration): how far the window moves between results. Must evenly divide the
+      window. Defaults to the window size.
 
   Returns:
     px.DataFrame: DataFrame grouped into rolling windows. Must apply either a groupby or an aggregate on the
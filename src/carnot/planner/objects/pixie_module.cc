@@ -204,6 +204,7 @@ Status PixieModule::RegisterUDTFs() {
 
 StatusOr<QLObjectPtr> NowEval(CompilerState* compiler_state, IR* graph, const pypa::AstPtr& ast,
                               const ParsedArgs&, ASTVisitor* visitor) {
+  compiler_state->set_plan_depends_on_time_now();
   PX_ASSIGN_OR_RETURN(IntIR * time_now,
                       graph->CreateNode<IntIR>(ast, compiler_state->time_now().val));
   return ExprObject::Create(time_now, visitor);
@@ -408,11 +409,14 @@ StatusOr<QLObjectPtr> FormatDuration(IR* graph, const pypa::AstPtr& ast, const P
   return ExprObject::Create(node, visitor);
 }
 
-StatusOr<QLObjectPtr> ParseTime(int64_t time_now, IR* graph, const pypa::AstPtr& ast,
+StatusOr<QLObjectPtr> ParseTime(CompilerState* compiler_state, IR* graph, const pypa::AstPtr& ast,
                                 const ParsedArgs& args, ASTVisitor* visitor) {
   PX_ASSIGN_OR_RETURN(ExpressionIR * time_ir, GetArgAs<ExpressionIR>(ast, args, "time"));
 
-  auto int_or_s = ParseAllTimeFormats(time_now, time_ir);
+  if (IsRelativeTime(time_ir)) {
+    compiler_state->set_plan_depends_on_time_now();
+  }
+  auto int_or_s = ParseAllTimeFormats(compiler_state->time_now().val, time_ir);
   if (!int_or_s.ok()) {
     return WrapAstError(time_ir->ast(), int_or_s.status());
   }
@@ -527,7 +531,7 @@ Status PixieModule::RegisterCompileTimeFuncs() {
       FuncObject::Create(
           kParseTimeOpID, {"time"}, {},
           /* has_variable_len_args */ false, /* has_variable_len_kwargs */ false,
-          std::bind(&ParseTime, compiler_state_->time_now().val, graph_, std::placeholders::_1,
+          std::bind(&ParseTime, compiler_state_, graph_, std::placeholders::_1,
                     std::placeholders::_2, std::placeholders::_3),
           ast_visitor()));
 
@@ -35,6 +35,11 @@ StatusOr<int64_t> ParseAllTimeFormats(int64_t time_now, ExpressionIR* time_expr)
   return 0;
 }
 
+bool IsRelativeTime(ExpressionIR* time_expr) {
+  return Match(time_expr, String()) &&
+         StringToTimeInt(static_cast<StringIR*>(time_expr)->str()).ok();
+}
+
 }  // namespace compiler
 }  // namespace planner
 }  // namespace carnot
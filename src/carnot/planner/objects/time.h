@@ -36,6 +36,9 @@ namespace compiler {
 
 StatusOr<int64_t> ParseAllTimeFormats(int64_t time_now, ExpressionIR* time_expr);
 
+// Whether ParseAllTimeFormats returns a time relative to time_now for the expression, e.g. '-5m'.
+bool IsRelativeTime(ExpressionIR* time_expr);
+
 }  // namespace compiler
 }  // namespace planner
 }  // namespace carnot
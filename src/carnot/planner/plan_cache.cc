@@ -0,0 +1,139 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/planner/plan_cache.h"
+
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl_lite.h>
+
+#include "src/carnot/planner/ir/memory_source_ir.h"
+#include "src/carnot/planner/ir/pattern_match.h"
+
+DEFINE_int64(planner_plan_cache_size, gflags::Int64FromEnv("PL_PLANNER_PLAN_CACHE_SIZE", 16),
+             "The number of compiled plans that the planner keeps to reuse for identical query "
+             "requests. 0 disables the plan cache.");
+
+namespace px {
+namespace carnot {
+namespace planner {
+
+StatusOr<std::unique_ptr<CachedPlan>> CachedPlan::Create(const distributed::DistributedPlan& plan,
+                                                         distributedpb::DistributedPlan plan_pb,
+                                                         int64_t time_now) {
+  auto cached_plan = std::unique_ptr<CachedPlan>(new CachedPlan(std::move(plan_pb)));
+  for (int64_t carnot_id : plan.dag().TopologicalSort()) {
+    auto carnot = plan.Get(carnot_id);
+    const auto& qb_address = carnot->QueryBrokerAddress();
+    auto plan_it = cached_plan->plan_pb_.qb_address_to_plan().find(qb_address);
+    if (plan_it == cached_plan->plan_pb_.qb_address_to_plan().end()) {
+      return error::Internal("No plan for $0 in the distributed plan.", qb_address);
+    }
+    const auto& carnot_plan_pb = plan_it->second;
+    for (IRNode* node : carnot->plan()->FindNodesThatMatch(MemorySource())) {
+      auto src = static_cast<MemorySourceIR*>(node);
+      if (!src->time_start_relative_to_now() && !src->time_stop_relative_to_now()) {
+        continue;
+      }
+      bool found = false;
+      for (int fragment_idx = 0; fragment_idx < carnot_plan_pb.nodes_size() && !found;
+           ++fragment_idx) {
+        const auto& fragment_pb = carnot_plan_pb.nodes(fragment_idx);
+        for (int node_idx = 0; node_idx < fragment_pb.nodes_size() && !found; ++node_idx) {
+          if (fragment_pb.nodes(node_idx).id() != static_cast<uint64_t>(src->id())) {
+            continue;
+          }
+          found = true;
+          if (src->time_start_relative_to_now()) {
+            cached_plan->time_bindings_.push_back({qb_address, fragment_idx, node_idx,
+                                                   /* stop */ false,
+                                                   src->time_start_ns() - time_now});
+          }
+          if (src->time_stop_relative_to_now()) {
+            cached_plan->time_bindings_.push_back({qb_address, fragment_idx, node_idx,
+                                                   /* stop */ true,
+                                                   src->time_stop_ns() - time_now});
+          }
+        }
+      }
+      if (!found) {
+        return error::Internal("No node $0 in the plan of $1.", src->id(), qb_address);
+      }
+    }
+  }
+  return cached_plan;
+}
+
+distributedpb::DistributedPlan CachedPlan::Bind(int64_t time_now) const {
+  distributedpb::DistributedPlan plan_pb = plan_pb_;
+  for (const auto& binding : time_bindings_) {
+    auto mem_source_pb = (*plan_pb.mutable_qb_address_to_plan())[binding.qb_address]
+                             .mutable_nodes(binding.fragment_idx)
+                             ->mutable_nodes(binding.node_idx)
+                             ->mutable_op()
+                             ->mutable_mem_source_op();
+    if (binding.stop) {
+      mem_source_pb->mutable_stop_time()->set_value(time_now + binding.offset_ns);
+    } else {
+      mem_source_pb->mutable_start_time()->set_value(time_now + binding.offset_ns);
+    }
+  }
+  return plan_pb;
+}
+
+std::string PlanCache::Key(const plannerpb::QueryRequest& query_request) {
+  std::string key;
+  google::protobuf::io::StringOutputStream stream(&key);
+  google::protobuf::io::CodedOutputStream coded(&stream);
+  coded.SetSerializationDeterministic(true);
+  query_request.SerializeToCodedStream(&coded);
+  coded.Trim();
+  return key;
+}
+
+std::shared_ptr<const CachedPlan> PlanCache::Lookup(const std::string& key) {
+  absl::MutexLock lock(&mu_);
+  auto it = entries_.find(key);
+  if (it == entries_.end()) {
+    return nullptr;
+  }
+  lru_.splice(lru_.begin(), lru_, it->second.lru_pos);
+  return it->second.plan;
+}
+
+void PlanCache::Insert(const std::string& key, std::shared_ptr<const CachedPlan> plan) {
+  if (max_entries_ == 0) {
+    return;
+  }
+  absl::MutexLock lock(&mu_);
+  auto [it, inserted] = entries_.try_emplace(key);
+  if (inserted) {
+    lru_.push_front(key);
+    it->second.lru_pos = lru_.begin();
+  } else {
+    lru_.splice(lru_.begin(), lru_, it->second.lru_pos);
+  }
+  it->second.plan = std::move(plan);
+  while (entries_.size() > max_entries_) {
+    entries_.erase(lru_.back());
+    lru_.pop_back();
+  }
+}
+
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,130 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <list>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <absl/base/thread_annotations.h>
+#include <absl/container/node_hash_map.h>
+#include <absl/synchronization/mutex.h>
+
+#include "src/carnot/planner/distributed/distributed_plan/distributed_plan.h"
+#include "src/carnot/planner/distributedpb/distributed_plan.pb.h"
+#include "src/carnot/planner/plannerpb/service.pb.h"
+#include "src/common/base/base.h"
+
+DECLARE_int64(planner_plan_cache_size);
+
+namespace px {
+namespace carnot {
+namespace planner {
+
+/**
+ * CachedPlan is the compiled distributed plan of a query request, along with the memory source
+ * times in it that are relative to the time it was compiled at, so it can be bound to a later
+ * time without compiling it again.
+ */
+class CachedPlan : public NotCopyable {
+ public:
+  /**
+   * Creates the cached plan of the given distributed plan, compiled at time_now.
+   *
+   * @param plan the distributed plan.
+   * @param plan_pb the proto of the distributed plan, with its plan options set.
+   * @param time_now the time the plan was compiled at.
+   */
+  static StatusOr<std::unique_ptr<CachedPlan>> Create(const distributed::DistributedPlan& plan,
+                                                      distributedpb::DistributedPlan plan_pb,
+                                                      int64_t time_now);
+
+  /**
+   * Returns the plan as if it was compiled at the given time.
+   */
+  distributedpb::DistributedPlan Bind(int64_t time_now) const;
+
+  // The number of memory source times that are rebound to the compile time.
+  size_t num_time_bindings() const { return time_bindings_.size(); }
+
+ private:
+  // A start or stop time of a memory source, relative to the compile time.
+  struct TimeBinding {
+    std::string qb_address;
+    int fragment_idx;
+    int node_idx;
+    bool stop;
+    int64_t offset_ns;
+  };
+
+  explicit CachedPlan(distributedpb::DistributedPlan plan_pb) : plan_pb_(std::move(plan_pb)) {}
+
+  const distributedpb::DistributedPlan plan_pb_;
+  std::vector<TimeBinding> time_bindings_;
+};
+
+/**
+ * PlanCache keeps the most recently compiled plans of a LogicalPlanner, so that scripts which are
+ * run over and over against the same cluster state, such as the scripts polled by the UI, aren't
+ * parsed and planned again on every run.
+ *
+ * A plan is keyed by everything the planner reads from the query request: the script, its
+ * arguments, the schemas and the agents of the distributed state, and the planner options. The
+ * only other input is the compile time, which the cached plan substitutes for when it's bound.
+ * Plans that use the compile time in a way that can't be substituted aren't cached.
+ *
+ * PlanCache is thread safe.
+ */
+class PlanCache : public NotCopyable {
+ public:
+  explicit PlanCache(size_t max_entries) : max_entries_(max_entries) {}
+
+  static std::string Key(const plannerpb::QueryRequest& query_request);
+
+  /**
+   * @return the cached plan for the key, or nullptr if it isn't cached.
+   */
+  std::shared_ptr<const CachedPlan> Lookup(const std::string& key);
+  void Insert(const std::string& key, std::shared_ptr<const CachedPlan> plan);
+
+  size_t size() const {
+    absl::MutexLock lock(&mu_);
+    return entries_.size();
+  }
+
+ private:
+  struct Entry {
+    std::shared_ptr<const CachedPlan> plan;
+    // The position of the key in lru_.
+    std::list<std::string>::iterator lru_pos;
+  };
+
+  const size_t max_entries_;
+
+  mutable absl::Mutex mu_;
+  absl::node_hash_map<std::string, Entry> entries_ ABSL_GUARDED_BY(mu_);
+  // The keys of entries_, from the most to the least recently used.
+  std::list<std::string> lru_ ABSL_GUARDED_BY(mu_);
+};
+
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
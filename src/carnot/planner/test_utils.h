@@ -25,6 +25,7 @@
 #include <string>
 #include <vector>
 
+#include <absl/strings/str_format.h>
 #include <absl/strings/str_replace.h>
 #include <absl/strings/substitute.h>
 #include "src/carnot/dag/dag.h"
@@ -558,6 +559,22 @@ distributedpb::LogicalPlannerState CreateTwoPEMsOneKelvinPlannerState() {
   return CreateTwoPEMsOneKelvinPlannerState(kSchema);
 }
 
+// Creates the state of a cluster with the given number of PEMs and a single Kelvin, for benchmarks
+// of planning on large clusters.
+distributedpb::LogicalPlannerState CreateManyPEMsOneKelvinPlannerState(int64_t num_pems,
+                                                                       std::string_view schema) {
+  std::string table_info = MakeTableInfoStr("table1", "upid", {"1", "2"});
+  std::vector<std::string> carnot_infos;
+  for (int64_t i = 1; i <= num_pems; ++i) {
+    carnot_infos.push_back(MakePEMCarnotInfo(absl::Substitute("pem$0", i),
+                                             absl::StrFormat("00000001-0000-0000-0000-%012d", i),
+                                             static_cast<uint32_t>(i), {table_info}));
+  }
+  carnot_infos.push_back(MakeKelvinCarnotInfo("kelvin", "00000002-0000-0000-0000-000000000001",
+                                              "1111", static_cast<uint32_t>(num_pems + 1)));
+  return LoadLogicalPlannerStatePB(MakeDistributedState(carnot_infos), LoadSchemaPb(schema));
+}
+
 constexpr char kExpectedPlanTwoPEMs[] = R"proto(
 qb_address_to_plan {
   key: "pem1"
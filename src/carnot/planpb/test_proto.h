@@ -339,6 +339,31 @@ columns {
   index: 2
 }
 )";
+constexpr char kTopKOperator1[] = R"(
+order_by {
+  column {
+    node: 1
+    index: 1
+  }
+  descending: true
+}
+order_by {
+  column {
+    node: 1
+    index: 0
+  }
+}
+k: 3
+columns {
+  node: 1
+  index: 0
+}
+columns {
+  node: 1
+  index: 1
+}
+)";
+
 // relation 1: [abc, time_]
 // relation 2: [time_, abc]
 // maps to output relation:
@@ -1482,6 +1507,14 @@ planpb::Operator CreateTestDropLimit1PB() {
   return op;
 }
 
+planpb::Operator CreateTestTopK1PB() {
+  planpb::Operator op;
+  auto op_proto =
+      absl::Substitute(kOperatorProtoTmpl, "TOP_K_OPERATOR", "top_k_op", kTopKOperator1);
+  CHECK(google::protobuf::TextFormat::MergeFromString(op_proto, &op)) << "Failed to parse proto";
+  return op;
+}
+
 planpb::Operator CreateTestJoinWithTimePB() {
   planpb::Operator op;
   auto op_proto = absl::Substitute(kOperatorProtoTmpl, "JOIN_OPERATOR", "join_op", kJoinOperator1);
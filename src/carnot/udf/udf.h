@@ -20,11 +20,14 @@
 #include <arrow/builder.h>
 #include <arrow/type.h>
 
+#include <algorithm>
 #include <array>
 #include <cstdint>
 #include <iostream>
 #include <memory>
 #include <string>
+#include <tuple>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -74,12 +77,94 @@ class AnyUDA : public BaseFunc {
  *      Status Init(FunctionContext *ctx, UDFValue... init_args) {}
  *  This function is called once during initialization of each instance (many instances
  *  may exists in a given query). The arguments are as provided by the query.
+ *
+ * If all of the argument and return types of Exec are BOOLEAN, INT64, FLOAT64 or TIME64NS, the
+ * ScalarUDF can also _optionally_ implement a batch kernel:
+ *      void ExecBatch(FunctionContext *ctx, size_t count, BatchArg<UDFValue>... values,
+ *                     native_type* out) {}
+ *  which computes Exec for count rows at a time, straight from the column buffers. When it
+ *  exists, it is used instead of Exec when evaluating arrow arrays. It must give the same results
+ *  as Exec.
+ *
+ * A ScalarUDF whose result doesn't only depend on its arguments, for example because it reads the
+ * metadata of the agent or the state of the host, must implement:
+ *      static bool Deterministic() { return false; }
+ *  Results computed with such UDFs are never reused across queries.
  */
 class ScalarUDF : public AnyUDF {
  public:
   ~ScalarUDF() override = default;
 };
 
+/**
+ * BatchArg is an argument of a ScalarUDF batch kernel: either a column of contiguous values, or a
+ * constant that is the value of every row.
+ * @tparam TValue the UDF value type of the argument, as in Exec.
+ */
+template <typename TValue>
+struct BatchArg {
+  using native_type = typename types::ValueTypeTraits<TValue>::native_type;
+
+  const native_type* data;
+  // If true, data only holds a single value which applies to every row.
+  bool is_constant;
+
+  native_type operator[](size_t idx) const { return is_constant ? data[0] : data[idx]; }
+};
+
+// PX_CARNOT_UPDATE_FOR_NEW_TYPES
+template <typename TValue>
+constexpr bool SupportsBatchKernel() {
+  return std::is_same_v<TValue, types::BoolValue> || std::is_same_v<TValue, types::Int64Value> ||
+         std::is_same_v<TValue, types::Float64Value> ||
+         std::is_same_v<TValue, types::Time64NSValue>;
+}
+
+/**
+ * Computes out[i] = fn(a[i]) for count rows. The loop is a plain loop over contiguous buffers, so
+ * that the compiler can vectorize it.
+ */
+template <typename TArg, typename TOut, typename TFn>
+inline void UnaryBatchKernel(size_t count, const BatchArg<TArg>& a, TOut* __restrict out,
+                             TFn fn) {
+  if (a.is_constant) {
+    std::fill(out, out + count, fn(a.data[0]));
+    return;
+  }
+  const auto* __restrict a_data = a.data;
+  for (size_t i = 0; i < count; ++i) {
+    out[i] = fn(a_data[i]);
+  }
+}
+
+/**
+ * Computes out[i] = fn(a[i], b[i]) for count rows. Each combination of constant and column
+ * arguments gets its own loop, so that the compiler can vectorize all of them.
+ */
+template <typename TArg1, typename TArg2, typename TOut, typename TFn>
+inline void BinaryBatchKernel(size_t count, const BatchArg<TArg1>& a, const BatchArg<TArg2>& b,
+                              TOut* __restrict out, TFn fn) {
+  const auto* __restrict a_data = a.data;
+  const auto* __restrict b_data = b.data;
+  if (a.is_constant && b.is_constant) {
+    std::fill(out, out + count, fn(a_data[0], b_data[0]));
+  } else if (a.is_constant) {
+    auto a_val = a_data[0];
+    for (size_t i = 0; i < count; ++i) {
+      out[i] = fn(a_val, b_data[i]);
+    }
+  } else if (b.is_constant) {
+    auto b_val = b_data[0];
+    for (size_t i = 0; i < count; ++i) {
+      out[i] = fn(a_data[i], b_val);
+    }
+  } else {
+    for (size_t i = 0; i < count; ++i) {
+      out[i] = fn(a_data[i], b_data[i]);
+    }
+  }
+}
+
 /**
  * UDA is a stateful function that updates internal state bases on the input
  * values. It must be Merge-able with other UDAs of the same type.
@@ -167,6 +252,13 @@ struct has_udf_executor_fn<T, std::void_t<decltype(&T::Executor)>> : std::true_t
       "If an executor function exists, it must have the form: UDFSourceExecutor Executor()");
 };
 
+// SFINAE test for Deterministic fn.
+template <typename T, typename = void>
+struct has_udf_deterministic_fn : std::false_type {};
+
+template <typename T>
+struct has_udf_deterministic_fn<T, std::void_t<decltype(&T::Deterministic)>> : std::true_type {};
+
 template <typename T, typename = void>
 struct check_executor_fn {};
 
@@ -188,6 +280,28 @@ static constexpr types::DataType ReturnTypeHelper(ReturnType (TUDF::*)(Types...)
   return types::ValueTypeTraits<ReturnType>::data_type;
 }
 
+// SFINAE test for the batch kernel of a ScalarUDF, given the return and argument types of Exec.
+template <typename T, typename TReturn, typename TArgs, typename = void>
+struct has_udf_exec_batch_fn : std::false_type {};
+
+template <typename T, typename TReturn, typename... TArgs>
+struct has_udf_exec_batch_fn<
+    T, TReturn, std::tuple<TArgs...>,
+    std::void_t<decltype(std::declval<T&>().ExecBatch(
+        std::declval<FunctionContext*>(), std::declval<size_t>(),
+        std::declval<BatchArg<TArgs>>()...,
+        std::declval<typename types::ValueTypeTraits<TReturn>::native_type*>()))>>
+    : std::true_type {};
+
+template <typename ReturnType, typename TUDF, typename... Types>
+static constexpr bool HasExecBatchHelper(ReturnType (TUDF::*)(FunctionContext*, Types...)) {
+  if constexpr ((SupportsBatchKernel<ReturnType>() && ... && SupportsBatchKernel<Types>())) {
+    return has_udf_exec_batch_fn<TUDF, ReturnType, std::tuple<Types...>>::value;
+  } else {
+    return false;
+  }
+}
+
 template <typename T, typename = void>
 struct check_init_fn {};
 
@@ -228,6 +342,23 @@ class ScalarUDFTraits {
    */
   static constexpr bool HasExecutor() { return has_udf_executor_fn<T>::value; }
 
+  /**
+   * Checks if the result of the UDF only depends on its arguments.
+   * @return false if the UDF declares itself not deterministic.
+   */
+  static bool IsDeterministic() {
+    if constexpr (has_udf_deterministic_fn<T>::value) {
+      return T::Deterministic();
+    }
+    return true;
+  }
+
+  /**
+   * Checks if the UDF has a batch kernel (ExecBatch) for the argument types of its Exec function.
+   * @return true if it has a batch kernel.
+   */
+  static constexpr bool HasExecBatch() { return HasExecBatchHelper(&T::Exec); }
+
   template <typename Q = T, std::enable_if_t<ScalarUDFTraits<Q>::HasInit(), void>* = nullptr>
   static constexpr auto InitArguments() {
     return GetArgumentTypesHelper(&Q::Init);
@@ -95,6 +95,8 @@ class ScalarUDFDefinition : public UDFDefinition {
     exec_arguments_ = {begin(exec_arguments_array), end(exec_arguments_array)};
     exec_wrapper_fn_ = ScalarUDFWrapper<TUDF>::ExecBatch;
     exec_wrapper_arrow_fn_ = ScalarUDFWrapper<TUDF>::ExecBatchArrow;
+    exec_kernel_fn_ = ScalarUDFWrapper<TUDF>::ExecBatchKernel;
+    has_exec_batch_ = ScalarUDFTraits<TUDF>::HasExecBatch();
     init_wrapper_fn_ = ScalarUDFWrapper<TUDF>::ExecInit;
 
     auto init_arguments_array = ScalarUDFTraits<TUDF>::InitArguments();
@@ -111,6 +113,7 @@ class ScalarUDFDefinition : public UDFDefinition {
     } else {
       executor_ = udfspb::UDFSourceExecutor::UDF_ALL;
     }
+    deterministic_ = ScalarUDFTraits<TUDF>::IsDeterministic();
 
     return Status::OK();
   }
@@ -131,6 +134,12 @@ class ScalarUDFDefinition : public UDFDefinition {
     return exec_wrapper_arrow_fn_(udf, ctx, inputs, output, count);
   }
 
+  // Runs the batch kernel directly on native buffers. Only valid if has_exec_batch() is true.
+  Status ExecBatchKernel(ScalarUDF* udf, FunctionContext* ctx,
+                         const std::vector<RawBatchArg>& inputs, void* output, size_t count) {
+    return exec_kernel_fn_(udf, ctx, inputs, output, count);
+  }
+
   Status ExecInit(ScalarUDF* udf, FunctionContext* ctx,
                   const std::vector<std::shared_ptr<types::BaseValueType>>& inputs) {
     return init_wrapper_fn_(udf, ctx, inputs);
@@ -144,6 +153,10 @@ class ScalarUDFDefinition : public UDFDefinition {
   const std::vector<types::DataType>& exec_arguments() const { return exec_arguments_; }
   const std::vector<types::DataType>& init_arguments() const { return init_arguments_; }
   udfspb::UDFSourceExecutor executor() const { return executor_; }
+  // Whether the result of the UDF only depends on its arguments.
+  bool deterministic() const { return deterministic_; }
+  // Whether ExecBatchArrow runs a batch kernel, which accepts single value arrays as constants.
+  bool has_exec_batch() const { return has_exec_batch_; }
 
   const std::vector<types::DataType>& RegistryArgTypes() override { return registry_arguments_; }
   size_t Arity() const { return exec_arguments_.size(); }
@@ -155,6 +168,8 @@ class ScalarUDFDefinition : public UDFDefinition {
   std::vector<types::DataType> registry_arguments_;
   types::DataType exec_return_type_;
   udfspb::UDFSourceExecutor executor_;
+  bool deterministic_ = true;
+  bool has_exec_batch_ = false;
   std::function<std::unique_ptr<ScalarUDF>()> make_fn_;
   std::function<Status(ScalarUDF*, FunctionContext* ctx,
                        const std::vector<const types::ColumnWrapper*>& inputs,
@@ -166,6 +181,10 @@ class ScalarUDFDefinition : public UDFDefinition {
                        int count)>
       exec_wrapper_arrow_fn_;
 
+  std::function<Status(ScalarUDF* udf, FunctionContext* ctx,
+                       const std::vector<RawBatchArg>& inputs, void* output, size_t count)>
+      exec_kernel_fn_;
+
   std::function<Status(ScalarUDF* udf, FunctionContext* ctx,
                        const std::vector<std::shared_ptr<types::BaseValueType>>& inputs)>
       init_wrapper_fn_;
@@ -194,8 +213,12 @@ class UDADefinition : public UDFDefinition {
     update_arguments_ = {update_arguments_array.begin(), update_arguments_array.end()};
     finalize_return_type_ = UDATraits<T>::FinalizeReturnType();
     make_fn_ = UDAWrapper<T>::Make;
+    make_at_fn_ = UDAWrapper<T>::MakeAt;
+    state_size_ = UDAWrapper<T>::StateSize;
+    state_alignment_ = UDAWrapper<T>::StateAlignment;
     exec_batch_update_fn_ = UDAWrapper<T>::ExecBatchUpdate;
     exec_batch_update_arrow_fn_ = UDAWrapper<T>::ExecBatchUpdateArrow;
+    exec_batch_update_grouped_arrow_fn_ = UDAWrapper<T>::ExecBatchUpdateGroupedArrow;
     init_wrapper_fn_ = UDAWrapper<T>::ExecInit;
 
     auto init_arguments_array = UDATraits<T>::InitArguments();
@@ -227,6 +250,14 @@ class UDADefinition : public UDFDefinition {
 
   std::unique_ptr<UDA> Make() { return make_fn_(); }
 
+  /**
+   * Creates a UDA in caller owned memory, which must be at least state_size() bytes and aligned to
+   * state_alignment(). The caller has to call the UDA's destructor before releasing the memory.
+   */
+  UDA* MakeAt(void* mem) { return make_at_fn_(mem); }
+  size_t state_size() const { return state_size_; }
+  size_t state_alignment() const { return state_alignment_; }
+
   Status ExecBatchUpdate(UDA* uda, FunctionContext* ctx,
                          const std::vector<const types::ColumnWrapper*>& inputs) {
     return exec_batch_update_fn_(uda, ctx, inputs);
@@ -235,6 +266,15 @@ class UDADefinition : public UDFDefinition {
                               const std::vector<const arrow::Array*>& inputs) {
     return exec_batch_update_arrow_fn_(uda, ctx, inputs);
   }
+  /**
+   * Updates udas[i] with the i-th record of the inputs, for every record. This lets the UDA's
+   * update function be inlined into a single loop over the batch, no matter how many groups the
+   * records belong to.
+   */
+  Status ExecBatchUpdateGroupedArrow(UDA* const* udas, FunctionContext* ctx,
+                                     const std::vector<const arrow::Array*>& inputs) {
+    return exec_batch_update_grouped_arrow_fn_(udas, ctx, inputs);
+  }
 
   Status ExecInit(UDA* uda, FunctionContext* ctx,
                   const std::vector<std::shared_ptr<types::BaseValueType>>& inputs) {
@@ -262,7 +302,11 @@ class UDADefinition : public UDFDefinition {
   types::DataType finalize_return_type_;
   bool supports_partial_;
 
+  size_t state_size_;
+  size_t state_alignment_;
+
   std::function<std::unique_ptr<UDA>()> make_fn_;
+  std::function<UDA*(void* mem)> make_at_fn_;
   std::function<Status(UDA* uda, FunctionContext* ctx,
                        const std::vector<const types::ColumnWrapper*>& inputs)>
       exec_batch_update_fn_;
@@ -271,6 +315,10 @@ class UDADefinition : public UDFDefinition {
                        const std::vector<const arrow::Array*>& inputs)>
       exec_batch_update_arrow_fn_;
 
+  std::function<Status(UDA* const* udas, FunctionContext* ctx,
+                       const std::vector<const arrow::Array*>& inputs)>
+      exec_batch_update_grouped_arrow_fn_;
+
   std::function<Status(UDA* uda, FunctionContext* ctx, arrow::ArrayBuilder* output)>
       finalize_arrow_fn_;
   std::function<Status(UDA* uda, FunctionContext* ctx, types::BaseValueType* output)>
@@ -347,8 +395,8 @@ class UDTFDefinition : public UDFDefinition {
     return exec_init_(udtf, ctx, args);
   }
 
-  bool ExecBatchUpdate(AnyUDTF* udtf, FunctionContext* ctx, int max_gen_records,
-                       std::vector<arrow::ArrayBuilder*>* outputs) {
+  StatusOr<bool> ExecBatchUpdate(AnyUDTF* udtf, FunctionContext* ctx, int max_gen_records,
+                                 std::vector<arrow::ArrayBuilder*>* outputs) {
     return exec_batch_update_(udtf, ctx, max_gen_records, outputs);
   }
 
@@ -360,8 +408,8 @@ class UDTFDefinition : public UDFDefinition {
   std::unique_ptr<UDTFFactory> factory_;
   std::function<Status(AnyUDTF*, FunctionContext*, const std::vector<const types::BaseValueType*>&)>
       exec_init_;
-  std::function<bool(AnyUDTF* udtf, FunctionContext* ctx, int max_gen_records,
-                     std::vector<arrow::ArrayBuilder*>* outputs)>
+  std::function<StatusOr<bool>(AnyUDTF* udtf, FunctionContext* ctx, int max_gen_records,
+                               std::vector<arrow::ArrayBuilder*>* outputs)>
       exec_batch_update_;
   std::vector<UDTFArg> init_arguments_;
   std::vector<ColInfo> output_relation_;
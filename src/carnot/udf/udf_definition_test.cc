@@ -20,9 +20,11 @@
 #include <arrow/pretty_print.h>
 
 #include <algorithm>
+#include <type_traits>
 
 #include "src/carnot/udf/udf_definition.h"
 #include "src/common/testing/testing.h"
+#include "src/shared/types/arrow_adapter.h"
 #include "src/shared/types/column_wrapper.h"
 #include "src/shared/types/types.h"
 
@@ -52,6 +54,28 @@ class AddUDF : public ScalarUDF {
   }
 };
 
+class AddBatchUDF : public ScalarUDF {
+ public:
+  types::Int64Value Exec(FunctionContext*, types::Int64Value v1, types::Int64Value v2) {
+    return v1.val + v2.val;
+  }
+  void ExecBatch(FunctionContext*, size_t count, BatchArg<types::Int64Value> v1,
+                 BatchArg<types::Int64Value> v2, int64_t* out) {
+    BinaryBatchKernel(count, v1, v2, out, [](int64_t a, int64_t b) { return a + b; });
+  }
+};
+
+class GreaterThanBatchUDF : public ScalarUDF {
+ public:
+  types::BoolValue Exec(FunctionContext*, types::Int64Value v1, types::Int64Value v2) {
+    return v1.val > v2.val;
+  }
+  void ExecBatch(FunctionContext*, size_t count, BatchArg<types::Int64Value> v1,
+                 BatchArg<types::Int64Value> v2, bool* out) {
+    BinaryBatchKernel(count, v1, v2, out, [](int64_t a, int64_t b) { return a > b; });
+  }
+};
+
 class InitArgUDF : public ScalarUDF {
  public:
   Status Init(FunctionContext*, types::StringValue str, types::Int64Value i) {
@@ -137,6 +161,66 @@ TEST(UDFDefinition, arrow_write) {
   EXPECT_EQ(6, resArr->Value(1));
 }
 
+TEST(UDFDefinition, has_exec_batch) {
+  EXPECT_FALSE(ScalarUDFTraits<AddUDF>::HasExecBatch());
+  EXPECT_FALSE(ScalarUDFTraits<SubStrUDF>::HasExecBatch());
+  EXPECT_TRUE(ScalarUDFTraits<AddBatchUDF>::HasExecBatch());
+  EXPECT_TRUE(ScalarUDFTraits<GreaterThanBatchUDF>::HasExecBatch());
+
+  ScalarUDFDefinition def("add");
+  EXPECT_OK(def.Init<AddBatchUDF>());
+  EXPECT_TRUE(def.has_exec_batch());
+}
+
+TEST(UDFDefinition, arrow_write_batch_kernel) {
+  auto ctx = FunctionContext(nullptr, nullptr);
+  std::vector<types::Int64Value> v1 = {1, 2, 3};
+  std::vector<types::Int64Value> v2 = {3, 4, 5};
+
+  auto v1a = ToArrow(v1, arrow::default_memory_pool());
+  auto v2a = ToArrow(v2, arrow::default_memory_pool());
+
+  auto output_builder = std::make_shared<arrow::Int64Builder>();
+  auto u = std::make_shared<AddBatchUDF>();
+  EXPECT_OK(ScalarUDFWrapper<AddBatchUDF>::ExecBatchArrow(u.get(), &ctx, {v1a.get(), v2a.get()},
+                                                          output_builder.get(), 3));
+
+  std::shared_ptr<arrow::Array> res;
+  EXPECT_OK(output_builder->Finish(&res));
+  auto* res_arr = static_cast<arrow::Int64Array*>(res.get());
+  ASSERT_EQ(3, res_arr->length());
+  EXPECT_EQ(4, res_arr->Value(0));
+  EXPECT_EQ(6, res_arr->Value(1));
+  EXPECT_EQ(8, res_arr->Value(2));
+}
+
+TEST(UDFDefinition, arrow_write_batch_kernel_constant) {
+  auto ctx = FunctionContext(nullptr, nullptr);
+  std::vector<types::Int64Value> v1 = {1, 2, 3, 4};
+  // A single value array is broadcast to every row.
+  std::vector<types::Int64Value> v2 = {2};
+
+  auto v1a = ToArrow(v1, arrow::default_memory_pool());
+  auto v2a = ToArrow(v2, arrow::default_memory_pool());
+
+  auto output_builder = std::make_shared<arrow::BooleanBuilder>();
+  auto u = std::make_shared<GreaterThanBatchUDF>();
+  EXPECT_OK(ScalarUDFWrapper<GreaterThanBatchUDF>::ExecBatchArrow(
+      u.get(), &ctx, {v1a.get(), v2a.get()}, output_builder.get(), 4));
+  EXPECT_OK(ScalarUDFWrapper<GreaterThanBatchUDF>::ExecBatchArrow(
+      u.get(), &ctx, {v2a.get(), v1a.get()}, output_builder.get(), 4));
+
+  std::shared_ptr<arrow::Array> res;
+  EXPECT_OK(output_builder->Finish(&res));
+  auto* res_arr = static_cast<arrow::BooleanArray*>(res.get());
+  ASSERT_EQ(8, res_arr->length());
+  std::vector<bool> actual;
+  for (int64_t i = 0; i < res_arr->length(); ++i) {
+    actual.push_back(res_arr->Value(i));
+  }
+  EXPECT_THAT(actual, ElementsAre(false, false, true, true, true, false, false, false));
+}
+
 TEST(UDFDefinition, init_args) {
   auto ctx = FunctionContext(nullptr, nullptr);
   ScalarUDFDefinition def("initargudf");
@@ -321,6 +405,34 @@ TEST(UDADefinition, serialize_deserialize) {
   EXPECT_EQ(100, out.val);
 }
 
+TEST(UDADefinition, grouped_update_in_place) {
+  auto ctx = FunctionContext(nullptr, nullptr);
+  UDADefinition def("minsum");
+  EXPECT_OK(def.Init<MinSumUDA>());
+  EXPECT_EQ(sizeof(MinSumUDA), def.state_size());
+  EXPECT_EQ(alignof(MinSumUDA), def.state_alignment());
+
+  // Create two UDAs next to each other in caller owned memory.
+  std::aligned_storage_t<sizeof(MinSumUDA), alignof(MinSumUDA)> storage[2];
+  UDA* u1 = def.MakeAt(&storage[0]);
+  UDA* u2 = def.MakeAt(&storage[1]);
+
+  auto v1 = types::ToArrow(std::vector<types::Int64Value>{1, 2, 3, 4},
+                           arrow::default_memory_pool());
+  auto v2 = types::ToArrow(std::vector<types::Int64Value>{5, 1, 3, 10},
+                           arrow::default_memory_pool());
+  std::vector<UDA*> udas = {u1, u2, u1, u1};
+  EXPECT_OK(def.ExecBatchUpdateGroupedArrow(udas.data(), &ctx, {v1.get(), v2.get()}));
+
+  types::Int64Value out;
+  EXPECT_OK(def.FinalizeValue(u1, &ctx, &out));
+  EXPECT_EQ(8, out.val);
+  EXPECT_OK(def.FinalizeValue(u2, &ctx, &out));
+  EXPECT_EQ(1, out.val);
+  u1->~UDA();
+  u2->~UDA();
+}
+
 }  // namespace udf
 }  // namespace carnot
 }  // namespace px
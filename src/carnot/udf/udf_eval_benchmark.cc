@@ -18,7 +18,9 @@
 
 #include <benchmark/benchmark.h>
 
+#include <memory>
 #include <random>
+#include <type_traits>
 #include <vector>
 
 #include "src/carnot/udf/registry.h"
@@ -31,11 +33,13 @@
 #include "src/shared/types/types.h"
 
 using px::Status;
+using px::carnot::udf::BatchArg;
 using px::carnot::udf::FunctionContext;
 using px::carnot::udf::ScalarUDF;
 using px::carnot::udf::ScalarUDFDefinition;
 using px::carnot::udf::ScalarUDFWrapper;
 using px::types::BaseValueType;
+using px::types::BoolValue;
 using px::types::Int64Value;
 using px::types::Int64ValueColumnWrapper;
 using px::types::StringValue;
@@ -62,6 +66,31 @@ class SubStrUDF : public ScalarUDF {
   StringValue Exec(FunctionContext*, StringValue v1) { return v1.substr(1, 2); }
 };
 
+// Same as AddUDF, with a batch kernel.
+class AddBatchUDF : public ScalarUDF {
+ public:
+  Int64Value Exec(FunctionContext*, Int64Value v1, Int64Value v2) { return v1.val + v2.val; }
+  void ExecBatch(FunctionContext*, size_t count, BatchArg<Int64Value> v1, BatchArg<Int64Value> v2,
+                 int64_t* out) {
+    px::carnot::udf::BinaryBatchKernel(count, v1, v2, out, [](auto a, auto b) { return a + b; });
+  }
+};
+
+class GreaterThanUDF : public ScalarUDF {
+ public:
+  BoolValue Exec(FunctionContext*, Int64Value v1, Int64Value v2) { return v1 > v2; }
+};
+
+// Same as GreaterThanUDF, with a batch kernel.
+class GreaterThanBatchUDF : public ScalarUDF {
+ public:
+  BoolValue Exec(FunctionContext*, Int64Value v1, Int64Value v2) { return v1 > v2; }
+  void ExecBatch(FunctionContext*, size_t count, BatchArg<Int64Value> v1, BatchArg<Int64Value> v2,
+                 bool* out) {
+    px::carnot::udf::BinaryBatchKernel(count, v1, v2, out, [](auto a, auto b) { return a > b; });
+  }
+};
+
 // This benchmark add two columns using Int64ValueVectors.
 // NOLINTNEXTLINE : runtime/references.
 static void BM_AddInt64Values(benchmark::State& state) {
@@ -159,6 +188,65 @@ static void BM_AddTwoInt64sArrow(benchmark::State& state) {
   state.SetBytesProcessed(int64_t(state.iterations()) * sizeof(int64_t) * 2 * size);
 }
 
+// Benchmark a binary UDF on arrow arrays. The second argument is a single value constant if
+// constant_arg is set, which only UDFs with a batch kernel accept.
+template <typename TUDF, typename TOutputBuilder>
+void BinaryInt64ArrowBenchmark(benchmark::State& state, bool constant_arg) {
+  size_t size = state.range(0);
+  auto arr1 = ToArrow(CreateLargeData<Int64Value>(size), arrow::default_memory_pool());
+  auto arr2 = ToArrow(CreateLargeData<Int64Value>(constant_arg ? 1 : size),
+                      arrow::default_memory_pool());
+  if (constant_arg && !px::carnot::udf::ScalarUDFTraits<TUDF>::HasExecBatch()) {
+    arr2 = ToArrow(std::vector<Int64Value>(size, CreateLargeData<Int64Value>(1)[0]),
+                   arrow::default_memory_pool());
+  }
+
+  auto u = std::make_shared<TUDF>();
+  std::shared_ptr<arrow::Array> out;
+  // NOLINTNEXTLINE : clang-analyzer-deadcode.DeadStores.
+  for (auto _ : state) {
+    auto output_builder = std::make_shared<TOutputBuilder>();
+    auto res = ScalarUDFWrapper<TUDF>::ExecBatchArrow(u.get(), nullptr, {arr1.get(), arr2.get()},
+                                                      output_builder.get(), size);
+    CHECK(res.ok());
+    CHECK(output_builder->Finish(&out).ok());
+    benchmark::DoNotOptimize(out);
+  }
+  CHECK_EQ(static_cast<int64_t>(size), out->length());
+  state.SetItemsProcessed(int64_t(state.iterations()) * size);
+}
+
+// NOLINTNEXTLINE : runtime/references.
+static void BM_AddInt64sArrowPerRow(benchmark::State& state) {
+  BinaryInt64ArrowBenchmark<AddUDF, arrow::Int64Builder>(state, /*constant_arg*/ false);
+}
+
+// NOLINTNEXTLINE : runtime/references.
+static void BM_AddInt64sArrowBatchKernel(benchmark::State& state) {
+  BinaryInt64ArrowBenchmark<AddBatchUDF, arrow::Int64Builder>(state, /*constant_arg*/ false);
+}
+
+// NOLINTNEXTLINE : runtime/references.
+static void BM_AddInt64ConstantArrowPerRow(benchmark::State& state) {
+  BinaryInt64ArrowBenchmark<AddUDF, arrow::Int64Builder>(state, /*constant_arg*/ true);
+}
+
+// NOLINTNEXTLINE : runtime/references.
+static void BM_AddInt64ConstantArrowBatchKernel(benchmark::State& state) {
+  BinaryInt64ArrowBenchmark<AddBatchUDF, arrow::Int64Builder>(state, /*constant_arg*/ true);
+}
+
+// NOLINTNEXTLINE : runtime/references.
+static void BM_GreaterThanInt64ArrowPerRow(benchmark::State& state) {
+  BinaryInt64ArrowBenchmark<GreaterThanUDF, arrow::BooleanBuilder>(state, /*constant_arg*/ true);
+}
+
+// NOLINTNEXTLINE : runtime/references.
+static void BM_GreaterThanInt64ArrowBatchKernel(benchmark::State& state) {
+  BinaryInt64ArrowBenchmark<GreaterThanBatchUDF, arrow::BooleanBuilder>(state,
+                                                                        /*constant_arg*/ true);
+}
+
 // Benchmark converting Int64 to Arrow.
 // NOLINTNEXTLINE : runtime/references.
 static void BM_ConvertToArrowInt64(benchmark::State& state) {
@@ -248,6 +336,13 @@ BENCHMARK(BM_AddInt64ValueToArrow)->RangeMultiplier(2)->Range(1, 1 << 16);
 BENCHMARK(BM_AddTwoInt64sArrow)->RangeMultiplier(2)->Range(1, 1 << 16);
 BENCHMARK(BM_AddInt64Values)->RangeMultiplier(2)->Range(1, 1 << 16);
 
+BENCHMARK(BM_AddInt64sArrowPerRow)->RangeMultiplier(16)->Range(1 << 12, 1 << 20);
+BENCHMARK(BM_AddInt64sArrowBatchKernel)->RangeMultiplier(16)->Range(1 << 12, 1 << 20);
+BENCHMARK(BM_AddInt64ConstantArrowPerRow)->RangeMultiplier(16)->Range(1 << 12, 1 << 20);
+BENCHMARK(BM_AddInt64ConstantArrowBatchKernel)->RangeMultiplier(16)->Range(1 << 12, 1 << 20);
+BENCHMARK(BM_GreaterThanInt64ArrowPerRow)->RangeMultiplier(16)->Range(1 << 12, 1 << 20);
+BENCHMARK(BM_GreaterThanInt64ArrowBatchKernel)->RangeMultiplier(16)->Range(1 << 12, 1 << 20);
+
 BENCHMARK(BM_ConvertToArrowString)->RangeMultiplier(2)->Range(1, 1 << 16);
 BENCHMARK(BM_ConvertToArrowInt64)->RangeMultiplier(2)->Range(1, 1 << 16);
 
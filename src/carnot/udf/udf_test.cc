@@ -43,6 +43,12 @@ class ScalarUDF1WithInit : ScalarUDF {
   types::Int64Value Exec(FunctionContext*, types::BoolValue, types::BoolValue) { return 0; }
 };
 
+class NonDeterministicScalarUDF : ScalarUDF {
+ public:
+  static bool Deterministic() { return false; }
+  types::Int64Value Exec(FunctionContext*) { return 0; }
+};
+
 TEST(ScalarUDF, basic_tests) {
   EXPECT_EQ(types::DataType::INT64, ScalarUDFTraits<ScalarUDF1>::ReturnType());
   EXPECT_THAT(ScalarUDFTraits<ScalarUDF1>::ExecArguments(),
@@ -51,6 +57,11 @@ TEST(ScalarUDF, basic_tests) {
   EXPECT_TRUE(ScalarUDFTraits<ScalarUDF1WithInit>::HasInit());
 }
 
+TEST(ScalarUDF, deterministic) {
+  EXPECT_TRUE(ScalarUDFTraits<ScalarUDF1>::IsDeterministic());
+  EXPECT_FALSE(ScalarUDFTraits<NonDeterministicScalarUDF>::IsDeterministic());
+}
+
 TEST(UDFDataTypes, valid_tests) {
   EXPECT_TRUE((true == types::IsValidValueType<types::BoolValue>::value));
   EXPECT_TRUE((true == types::IsValidValueType<types::Int64Value>::value));
@@ -21,6 +21,7 @@
 #include <arrow/array.h>
 
 #include <memory>
+#include <new>
 #include <string>
 #include <vector>
 
@@ -105,14 +106,14 @@ Status ExecWrapperArrow(TUDF* udf, FunctionContext* ctx, size_t count, TOutput*
                         const std::vector<arrow::Array*>& args, std::index_sequence<I...>) {
   [[maybe_unused]] static constexpr auto exec_argument_types =
       ScalarUDFTraits<TUDF>::ExecArguments();
-  CHECK(out->Reserve(count).ok());
+  PX_RETURN_IF_ERROR(out->Reserve(count));
   size_t reserved = count * kStringAssumedSizeHeuristic;
   size_t total_size = 0;
   // If it's a string type we also need to allocate memory for the data.
   // This actually applies to all non-fixed data allocations.
   // PX_CARNOT_UPDATE_FOR_NEW_TYPES.
   if constexpr (std::is_same_v<arrow::StringBuilder, TOutput>) {
-    CHECK(out->ReserveData(reserved).ok());
+    PX_RETURN_IF_ERROR(out->ReserveData(reserved));
   }
   for (size_t idx = 0; idx < count; ++idx) {
     auto res = UnWrap(
@@ -133,6 +134,95 @@ Status ExecWrapperArrow(TUDF* udf, FunctionContext* ctx, size_t count, TOutput*
   return Status::OK();
 }
 
+/**
+ * Returns the batch kernel argument for an arrow array. A single value array is a constant when
+ * the batch has more rows than that. Booleans are packed into bits by arrow, so they are unpacked
+ * into scratch first.
+ */
+template <types::DataType TArgType>
+auto MakeBatchArg(const arrow::Array* arr, size_t count, std::unique_ptr<bool[]>* scratch) {
+  using value_type = typename types::DataTypeTraits<TArgType>::value_type;
+  using native_type = typename BatchArg<value_type>::native_type;
+  bool is_constant = count > 1 && arr->length() == 1;
+  size_t length = is_constant ? 1 : count;
+  if (length == 0) {
+    return BatchArg<value_type>{nullptr, false};
+  }
+  if constexpr (TArgType == types::DataType::BOOLEAN) {
+    scratch->reset(new bool[length]);
+    for (size_t idx = 0; idx < length; ++idx) {
+      (*scratch)[idx] = types::GetValueFromArrowArray<TArgType>(arr, idx);
+    }
+    return BatchArg<value_type>{scratch->get(), is_constant};
+  } else {
+    const auto* values =
+        reinterpret_cast<const native_type*>(arr->data()->buffers[1]->data()) + arr->offset();
+    return BatchArg<value_type>{values, is_constant};
+  }
+}
+
+/**
+ * This is the inner wrapper for UDFs that have a batch kernel. Instead of calling Exec once per
+ * row, it passes the raw buffers of the arrow arrays to ExecBatch, and appends all of the results
+ * to the output builder at once.
+ */
+template <typename TUDF, typename TOutput, std::size_t... I>
+Status ExecBatchKernelArrow(TUDF* udf, FunctionContext* ctx, size_t count, TOutput* out,
+                            const std::vector<arrow::Array*>& args, std::index_sequence<I...>) {
+  [[maybe_unused]] static constexpr auto exec_argument_types =
+      ScalarUDFTraits<TUDF>::ExecArguments();
+  constexpr types::DataType return_type = ScalarUDFTraits<TUDF>::ReturnType();
+  using native_type = typename BatchArg<
+      typename types::DataTypeTraits<return_type>::value_type>::native_type;
+
+  [[maybe_unused]] std::array<std::unique_ptr<bool[]>, sizeof...(I)> scratch;
+  auto results = std::make_unique<native_type[]>(count);
+  udf->ExecBatch(ctx, count, MakeBatchArg<exec_argument_types[I]>(args[I], count, &scratch[I])...,
+                 results.get());
+
+  // PX_CARNOT_UPDATE_FOR_NEW_TYPES.
+  if constexpr (return_type == types::DataType::BOOLEAN) {
+    PX_RETURN_IF_ERROR(out->AppendValues(reinterpret_cast<const uint8_t*>(results.get()), count));
+  } else {
+    PX_RETURN_IF_ERROR(out->AppendValues(results.get(), count));
+  }
+  return Status::OK();
+}
+
+/**
+ * A type erased argument of a batch kernel. data points to the native values of the argument's
+ * type (see BatchArg), which the caller owns.
+ */
+struct RawBatchArg {
+  const void* data;
+  bool is_constant;
+};
+
+template <types::DataType TArgType>
+auto FromRawBatchArg(const RawBatchArg& arg) {
+  using value_type = typename types::DataTypeTraits<TArgType>::value_type;
+  using native_type = typename BatchArg<value_type>::native_type;
+  return BatchArg<value_type>{static_cast<const native_type*>(arg.data), arg.is_constant};
+}
+
+/**
+ * This is the inner wrapper to call a batch kernel directly on native buffers, which lets callers
+ * chain kernels without materializing their inputs and outputs as arrays.
+ */
+template <typename TUDF, std::size_t... I>
+void ExecBatchKernelRaw(TUDF* udf, FunctionContext* ctx, size_t count,
+                        const std::vector<RawBatchArg>& args, void* out,
+                        std::index_sequence<I...>) {
+  [[maybe_unused]] static constexpr auto exec_argument_types =
+      ScalarUDFTraits<TUDF>::ExecArguments();
+  constexpr types::DataType return_type = ScalarUDFTraits<TUDF>::ReturnType();
+  using native_type = typename BatchArg<
+      typename types::DataTypeTraits<return_type>::value_type>::native_type;
+
+  udf->ExecBatch(ctx, count, FromRawBatchArg<exec_argument_types[I]>(args[I])...,
+                 static_cast<native_type*>(out));
+}
+
 /**
  * Checks types between column wrapper and array of types::UDFDataTypes.
  * @return true if all types match.
@@ -180,6 +270,9 @@ struct ScalarUDFWrapper {
    *
    * @note This function and underlying templates are fully expanded at compile time.
    *
+   * If the UDF has a batch kernel, an input with a single value is treated as a constant (when
+   * count > 1). Otherwise all inputs must have count values.
+   *
    * @param udf a pointer to the UDF.
    * @param ctx The function context.
    * @param inputs A vector of arrow::array* of inputs to the udf.
@@ -198,13 +291,50 @@ struct ScalarUDFWrapper {
     // Check that the arity is correct.
     DCHECK(inputs.size() == ScalarUDFTraits<TUDF>::ExecArguments().size());
 
+    auto* casted_output =
+        static_cast<typename types::DataTypeTraits<return_type>::arrow_builder_type*>(output);
+    if constexpr (ScalarUDFTraits<TUDF>::HasExecBatch()) {
+      return ExecBatchKernelArrow<TUDF>(static_cast<TUDF*>(udf), ctx, count, casted_output, inputs,
+                                        std::make_index_sequence<exec_argument_types.size()>{});
+    }
+
     // The outer wrapper just casts the output type and UDF type. We then pass in
     // the inputs with a sequence based on the number of arguments to iterate through and
     // cast the inputs.
-    return ExecWrapperArrow<TUDF>(
-        static_cast<TUDF*>(udf), ctx, count,
-        static_cast<typename types::DataTypeTraits<return_type>::arrow_builder_type*>(output),
-        inputs, std::make_index_sequence<exec_argument_types.size()>{});
+    return ExecWrapperArrow<TUDF>(static_cast<TUDF*>(udf), ctx, count, casted_output, inputs,
+                                  std::make_index_sequence<exec_argument_types.size()>{});
+  }
+
+  /**
+   * Runs the batch kernel of the UDF on native buffers, see RawBatchArg.
+   *
+   * This function is unsafe: the arguments and output must point to count values (or one value
+   * for constant arguments) of the native types of the UDF's arguments and return type.
+   *
+   * @param udf a pointer to the UDF.
+   * @param ctx The function context.
+   * @param inputs The arguments of the kernel.
+   * @param output Pointer to the start of the output.
+   * @param count The number of rows.
+   * @return Status of execution, which is an error if the UDF doesn't have a batch kernel.
+   */
+  static Status ExecBatchKernel(ScalarUDF* udf, FunctionContext* ctx,
+                                const std::vector<RawBatchArg>& inputs, void* output,
+                                size_t count) {
+    if constexpr (ScalarUDFTraits<TUDF>::HasExecBatch()) {
+      DCHECK(inputs.size() == ScalarUDFTraits<TUDF>::ExecArguments().size());
+      ExecBatchKernelRaw<TUDF>(
+          static_cast<TUDF*>(udf), ctx, count, inputs, output,
+          std::make_index_sequence<ScalarUDFTraits<TUDF>::ExecArguments().size()>{});
+      return Status::OK();
+    } else {
+      PX_UNUSED(udf);
+      PX_UNUSED(ctx);
+      PX_UNUSED(inputs);
+      PX_UNUSED(output);
+      PX_UNUSED(count);
+      return error::Unimplemented("UDF does not have a batch kernel");
+    }
   }
 
   /**
@@ -310,6 +440,22 @@ Status UpdateWrapperArrow(TUDA* uda, FunctionContext* ctx, size_t count,
   return Status::OK();
 }
 
+/**
+ * Performs a grouped update on a batch of records (arrow), where every record updates the UDA
+ * instance of its own group: record idx updates udas[idx].
+ */
+template <typename TUDA, std::size_t... I>
+Status GroupedUpdateWrapperArrow(UDA* const* udas, FunctionContext* ctx, size_t count,
+                                 const std::vector<const arrow::Array*>& args,
+                                 std::index_sequence<I...>) {
+  constexpr auto update_argument_types = UDATraits<TUDA>::UpdateArgumentTypes();
+  for (size_t idx = 0; idx < count; ++idx) {
+    static_cast<TUDA*>(udas[idx])->Update(
+        ctx, types::GetValueFromArrowArray<update_argument_types[I]>(args[I], idx)...);
+  }
+  return Status::OK();
+}
+
 /**
  * Provides a set of static methods that wrap UDAs and allow vectorized execution (for update).
  * @tparam TUDA The UDA class.
@@ -325,6 +471,15 @@ struct UDAWrapper {
    */
   static std::unique_ptr<UDA> Make() { return std::make_unique<TUDA>(); }
 
+  /**
+   * Create a new UDA in the given memory, which must be at least StateSize bytes and aligned to
+   * StateAlignment. The UDA has to be destroyed by calling its destructor.
+   * @return A pointer to the UDA instance.
+   */
+  static UDA* MakeAt(void* mem) { return new (mem) TUDA(); }
+  static constexpr size_t StateSize = sizeof(TUDA);
+  static constexpr size_t StateAlignment = alignof(TUDA);
+
   /**
    * Perform a batch update of the passed in UDA based in the inputs.
    * @param uda The UDA instances.
@@ -362,6 +517,23 @@ struct UDAWrapper {
                                     std::make_index_sequence<update_argument_types.size()>{});
   }
 
+  /**
+   * Perform a grouped batch update, where every record of the inputs updates its own UDA.
+   * @param udas The UDA instances, one per input record. Several records may share an instance.
+   * @param ctx The function context.
+   * @param inputs A vector of pointers to arrow arrays.
+   * @return Status of update.
+   */
+  static Status ExecBatchUpdateGroupedArrow(UDA* const* udas, FunctionContext* ctx,
+                                            const std::vector<const arrow::Array*>& inputs) {
+    constexpr auto update_argument_types = UDATraits<TUDA>::UpdateArgumentTypes();
+    DCHECK(inputs.size() == update_argument_types.size());
+
+    size_t num_records = inputs[0]->length();
+    return GroupedUpdateWrapperArrow<TUDA>(
+        udas, ctx, num_records, inputs, std::make_index_sequence<update_argument_types.size()>{});
+  }
+
   /**
    * Call the UDA's init method.
    *
@@ -521,15 +693,15 @@ struct UDTFWrapper {
     return Status::OK();
   }
 
-  static bool ExecBatchUpdate(AnyUDTF* udtf, FunctionContext* ctx, int max_gen_records,
-                              std::vector<arrow::ArrayBuilder*>* outputs) {
+  static StatusOr<bool> ExecBatchUpdate(AnyUDTF* udtf, FunctionContext* ctx, int max_gen_records,
+                                        std::vector<arrow::ArrayBuilder*>* outputs) {
     if (max_gen_records == 0) {
       return false;
     }
 
     // Reserve the output.
     for (auto* out : *outputs) {
-      CHECK(out->Reserve(max_gen_records).ok());
+      PX_RETURN_IF_ERROR(out->Reserve(max_gen_records));
     }
 
     auto* u = static_cast<TUDTF*>(udtf);
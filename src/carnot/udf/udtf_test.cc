@@ -174,7 +174,8 @@ TEST(BasicUDTFOneCol, can_run) {
   arrow::StringBuilder string_builder(0);
   std::vector<arrow::ArrayBuilder*> outs{&string_builder};
 
-  EXPECT_FALSE(wrapper.ExecBatchUpdate(u.get(), nullptr, 100, &outs));
+  ASSERT_OK_AND_ASSIGN(bool has_more, wrapper.ExecBatchUpdate(u.get(), nullptr, 100, &outs));
+  EXPECT_FALSE(has_more);
 
   std::shared_ptr<arrow::StringArray> out;
   EXPECT_TRUE(string_builder.Finish(&out).ok());
@@ -93,6 +93,19 @@ constexpr TIntType IntRoundUpToPow2(TIntType x) {
   return power;
 }
 
+/**
+ * Rounds an integer down to the previous closest power of 2.
+ * If already a power of 2, returns the same value. Returns 1 for values less than 1.
+ */
+template <typename TIntType>
+constexpr TIntType IntRoundDownToPow2(TIntType x) {
+  TIntType power = 1;
+  while (power <= x / 2) {
+    power *= 2;
+  }
+  return power;
+}
+
 /**
  * Interpolate the y value at x=`value` along the line defined by the points (`x_a`, `y_a`) (`x_b`,
  * `y_b`). If `value` falls outside [`x_a`, `x_b`] this function will extrapolate. If `x_a` equals
@@ -25,7 +25,8 @@
 namespace px {
 namespace zlib {
 
-StatusOr<std::string> Inflate(std::string_view in, size_t output_block_size) {
+StatusOr<std::string> Inflate(std::string_view in, size_t output_block_size,
+                              size_t max_output_size) {
   z_stream zs = {};
 
   if (inflateInit2(&zs, MAX_WBITS + 16) != Z_OK) {
@@ -41,7 +42,14 @@ StatusOr<std::string> Inflate(std::string_view in, size_t output_block_size) {
 
   // Get the decompressed bytes blockwise using repeated calls to inflate.
   do {
-    out.resize(out.size() + output_block_size);
+    if (out.size() > max_output_size) {
+      inflateEnd(&zs);
+      return error::ResourceUnavailable("zlib decompressed output is larger than $0 bytes",
+                                        max_output_size);
+    }
+    // Never allocate more than one byte past the limit, which is enough to detect going over it.
+    size_t remaining = max_output_size - out.size();
+    out.resize(out.size() + (remaining < output_block_size ? remaining + 1 : output_block_size));
     zs.next_out = reinterpret_cast<Bytef*>(out.data() + zs.total_out);
     zs.avail_out = out.size() - zs.total_out;
 
@@ -52,6 +60,11 @@ StatusOr<std::string> Inflate(std::string_view in, size_t output_block_size) {
 
   inflateEnd(&zs);
 
+  if (out.size() > max_output_size) {
+    return error::ResourceUnavailable("zlib decompressed output is larger than $0 bytes",
+                                      max_output_size);
+  }
+
   if (ret != Z_STREAM_END) {
     // An error occurred that was not EOF.
     return error::Internal("Exception during zlib decompression: $0", zs.msg);
@@ -60,5 +73,33 @@ StatusOr<std::string> Inflate(std::string_view in, size_t output_block_size) {
   return out;
 }
 
+StatusOr<std::string> Deflate(std::string_view in, int level) {
+  z_stream zs = {};
+
+  if (deflateInit2(&zs, level, Z_DEFLATED, MAX_WBITS + 16, /* memLevel */ 8,
+                   Z_DEFAULT_STRATEGY) != Z_OK) {
+    return error::Internal("deflateInit2 failed while compressing.");
+  }
+
+  zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(in.data()));
+  zs.avail_in = in.size();
+
+  // deflateBound is an upper bound on the compressed size, so a single call to deflate suffices.
+  std::string out(deflateBound(&zs, in.size()), '\0');
+  zs.next_out = reinterpret_cast<Bytef*>(out.data());
+  zs.avail_out = out.size();
+
+  int ret = deflate(&zs, Z_FINISH);
+  out.resize(zs.total_out);
+
+  deflateEnd(&zs);
+
+  if (ret != Z_STREAM_END) {
+    return error::Internal("Exception during zlib compression: $0", zs.msg);
+  }
+
+  return out;
+}
+
 }  // namespace zlib
 }  // namespace px
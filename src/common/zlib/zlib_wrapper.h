@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include <limits>
 #include <string>
 
 #include "src/common/base/statusor.h"
@@ -31,9 +32,21 @@ namespace zlib {
  * @param in A view into the source buffer.
  * @param output_block_size How many bytes to decompress into the output buffer at a time.
  *        For small strings, best to keep this only slightly larger than the expected output size.
+ * @param max_output_size Decompression fails once the output grows past this many bytes.
  * @return Status or the decompressed content as a string.
  */
-StatusOr<std::string> Inflate(std::string_view in, size_t output_block_size = 16384);
+StatusOr<std::string> Inflate(std::string_view in, size_t output_block_size = 16384,
+                              size_t max_output_size = std::numeric_limits<size_t>::max());
+
+/**
+ * @brief Deflates (gzip) a source buffer and returns the compressed content as a string, in the
+ * format that Inflate expects.
+ *
+ * @param in A view into the source buffer.
+ * @param level The zlib compression level, from 1 (fastest) to 9 (smallest output).
+ * @return Status or the compressed content as a string.
+ */
+StatusOr<std::string> Deflate(std::string_view in, int level = 1);
 
 }  // namespace zlib
 }  // namespace px
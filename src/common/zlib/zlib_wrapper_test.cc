@@ -17,6 +17,7 @@
  */
 
 #include "src/common/zlib/zlib_wrapper.h"
+#include <absl/strings/str_cat.h>
 #include <zlib.h>
 #include <string>
 
@@ -46,4 +47,26 @@ TEST_F(ZlibTest, inflate_test) {
   EXPECT_OK_AND_EQ(result, GetExpectedResult());
 }
 
+TEST_F(ZlibTest, deflate_inflate_round_trip) {
+  std::string input;
+  for (int i = 0; i < 1000; ++i) {
+    input += absl::StrCat("row ", i % 10, "\n");
+  }
+  ASSERT_OK_AND_ASSIGN(std::string compressed, px::zlib::Deflate(input));
+  EXPECT_LT(compressed.size(), input.size());
+  EXPECT_OK_AND_EQ(px::zlib::Inflate(compressed), input);
+}
+
+TEST_F(ZlibTest, inflate_max_output_size) {
+  std::string input(10000, 'a');
+  ASSERT_OK_AND_ASSIGN(std::string compressed, px::zlib::Deflate(input));
+  EXPECT_OK_AND_EQ(px::zlib::Inflate(compressed, 1024, input.size()), input);
+  EXPECT_NOT_OK(px::zlib::Inflate(compressed, 1024, input.size() - 1));
+}
+
+TEST_F(ZlibTest, deflate_empty) {
+  ASSERT_OK_AND_ASSIGN(std::string compressed, px::zlib::Deflate(""));
+  EXPECT_OK_AND_EQ(px::zlib::Inflate(compressed), "");
+}
+
 }  // namespace px
@@ -45,59 +45,68 @@ inline Status StatusAdapter<arrow::Status>(const arrow::Status& s) noexcept {
 namespace types {
 
 // The functions convert vector of UDF values to an arrow representation on
-// the given MemoryPool.
+// the given MemoryPool. They fail if the pool can't allocate the array, for instance when the
+// pool enforces a memory limit.
 template <typename TUDFValue>
-inline std::shared_ptr<arrow::Array> ToArrow(const std::vector<TUDFValue>& data,
-                                             arrow::MemoryPool* mem_pool) {
+inline StatusOr<std::shared_ptr<arrow::Array>> TryToArrow(const std::vector<TUDFValue>& data,
+                                                          arrow::MemoryPool* mem_pool) {
   DCHECK(mem_pool != nullptr);
 
   typename ValueTypeTraits<TUDFValue>::arrow_builder_type builder(mem_pool);
-  PX_CHECK_OK(builder.Reserve(data.size()));
+  PX_RETURN_IF_ERROR(builder.Reserve(data.size()));
   for (const auto& v : data) {
     builder.UnsafeAppend(v.val);
   }
   std::shared_ptr<arrow::Array> arr;
-  PX_CHECK_OK(builder.Finish(&arr));
+  PX_RETURN_IF_ERROR(builder.Finish(&arr));
   return arr;
 }
 
 // Specialization of the above for time64
 template <>
-inline std::shared_ptr<arrow::Array> ToArrow<Time64NSValue>(const std::vector<Time64NSValue>& data,
-                                                            arrow::MemoryPool* mem_pool) {
+inline StatusOr<std::shared_ptr<arrow::Array>> TryToArrow<Time64NSValue>(
+    const std::vector<Time64NSValue>& data, arrow::MemoryPool* mem_pool) {
   DCHECK(mem_pool != nullptr);
 
   arrow::Time64Builder builder(arrow::time64(arrow::TimeUnit::NANO), mem_pool);
-  PX_CHECK_OK(builder.Reserve(data.size()));
+  PX_RETURN_IF_ERROR(builder.Reserve(data.size()));
   for (const auto& v : data) {
     builder.UnsafeAppend(v.val);
   }
   std::shared_ptr<arrow::Array> arr;
-  PX_CHECK_OK(builder.Finish(&arr));
+  PX_RETURN_IF_ERROR(builder.Finish(&arr));
   return arr;
 }
 
 // Specialization of the above for strings.
 template <>
-inline std::shared_ptr<arrow::Array> ToArrow<StringValue>(const std::vector<StringValue>& data,
-                                                          arrow::MemoryPool* mem_pool) {
+inline StatusOr<std::shared_ptr<arrow::Array>> TryToArrow<StringValue>(
+    const std::vector<StringValue>& data, arrow::MemoryPool* mem_pool) {
   DCHECK(mem_pool != nullptr);
   arrow::StringBuilder builder(mem_pool);
   size_t total_size =
       std::accumulate(data.begin(), data.end(), 0ULL,
                       [](uint64_t sum, const std::string& str) { return sum + str.size(); });
   // This allocates space for null/ptrs/size.
-  PX_CHECK_OK(builder.Reserve(data.size()));
+  PX_RETURN_IF_ERROR(builder.Reserve(data.size()));
   // This allocates space for the actual data.
-  PX_CHECK_OK(builder.ReserveData(total_size));
+  PX_RETURN_IF_ERROR(builder.ReserveData(total_size));
   for (const auto& val : data) {
     builder.UnsafeAppend(val);
   }
   std::shared_ptr<arrow::Array> arr;
-  PX_CHECK_OK(builder.Finish(&arr));
+  PX_RETURN_IF_ERROR(builder.Finish(&arr));
   return arr;
 }
 
+// Same as TryToArrow, but dies if the array can't be allocated. Only use it with pools that don't
+// enforce a memory limit.
+template <typename TUDFValue>
+inline std::shared_ptr<arrow::Array> ToArrow(const std::vector<TUDFValue>& data,
+                                             arrow::MemoryPool* mem_pool) {
+  return TryToArrow(data, mem_pool).ConsumeValueOrDie();
+}
+
 /**
  * Find the UDFDataType for a given arrow type.
  * @param arrow_type The arrow type.
@@ -70,6 +70,9 @@ class ColumnWrapper {
   virtual void Clear() = 0;
   virtual void ShrinkToFit() = 0;
   virtual std::shared_ptr<arrow::Array> ConvertToArrow(arrow::MemoryPool* mem_pool) = 0;
+  // Same as ConvertToArrow, but returns an error instead of dying if mem_pool can't allocate it.
+  virtual StatusOr<std::shared_ptr<arrow::Array>> TryConvertToArrow(
+      arrow::MemoryPool* mem_pool) = 0;
   // GetView returns an empty string view for all non-string columns.
   virtual std::string_view GetView(size_t idx) const = 0;
 
@@ -125,6 +128,10 @@ class ColumnWrapperTmpl : public ColumnWrapper {
     return ToArrow(data_, mem_pool);
   }
 
+  StatusOr<std::shared_ptr<arrow::Array>> TryConvertToArrow(arrow::MemoryPool* mem_pool) override {
+    return TryToArrow(data_, mem_pool);
+  }
+
   T operator[](size_t idx) const { return data_[idx]; }
 
   T& operator[](size_t idx) { return data_[idx]; }
@@ -48,6 +48,35 @@
   {}
 #endif
 
+// Event outputs to user space. Build the program with PX_USE_RINGBUF in the defines of its
+// pl_bpf_cc_resource to make them BPF ring buffers, which are shared by all CPUs but need
+// Linux 5.8+; otherwise they are per-CPU perf buffers. The ring buffer of an output named foo is
+// sized by the foo_ringbuf_pages cflag, see bpf_tools::RingBufferSizeCFlags().
+//
+// Like BPF_DEBUG, PX_USE_RINGBUF must be set at build time: BCC rewrites the output method calls
+// after preprocessing, and cannot rewrite them from inside a macro.
+//
+// A ring buffer has no loss notifications, so the events that don't fit are counted in the per-CPU
+// array foo_ringbuf_lost, which BCCWrapper reports through the loss callback of the output.
+#ifdef PX_USE_RINGBUF
+#define BPF_EVENT_OUTPUT(name)                    \
+  BPF_RINGBUF_OUTPUT(name, name##_ringbuf_pages); \
+  BPF_PERCPU_ARRAY(name##_ringbuf_lost, uint64_t, 1)
+#define BPF_EVENT_SUBMIT(name, ctx, data, size)               \
+  {                                                           \
+    if (name.ringbuf_output(data, size, 0) != 0) {            \
+      int lost_idx = 0;                                       \
+      uint64_t* lost = name##_ringbuf_lost.lookup(&lost_idx); \
+      if (lost != NULL) {                                     \
+        ++*lost;                                              \
+      }                                                       \
+    }                                                         \
+  }
+#else
+#define BPF_EVENT_OUTPUT(name) BPF_PERF_OUTPUT(name)
+#define BPF_EVENT_SUBMIT(name, ctx, data, size) name.perf_submit(ctx, data, size)
+#endif
+
 // _VAR suffix indicates that the count of bytes being read is equal to the variable's byte size.
 #define BPF_PROBE_READ_VAR(value, ptr) bpf_probe_read(&value, sizeof(value), ptr)
 #define BPF_PROBE_READ_KERNEL_VAR(value, ptr) bpf_probe_read_kernel(&value, sizeof(value), ptr)
@@ -18,12 +18,14 @@
 
 #include "src/stirling/bpf_tools/bcc_wrapper.h"
 
+#include <bcc/libbpf.h>
 #include <linux/perf_event.h>
 #include <sys/mount.h>
 
 #include <iostream>
 #include <string>
 
+#include <absl/strings/str_cat.h>
 #include <magic_enum.hpp>
 
 #include "src/common/base/base.h"
@@ -35,6 +37,11 @@
 #include "src/stirling/bpf_tools/task_struct_resolver.h"
 #include "src/stirling/utils/linux_headers.h"
 
+DEFINE_bool(stirling_bpf_use_ring_buffers,
+            gflags::BoolFromEnv("PL_STIRLING_BPF_USE_RING_BUFFERS", true),
+            "If true, BPF programs that support it send their events through BPF ring buffers on "
+            "kernels that have them (5.8+), instead of per-CPU perf buffers.");
+
 namespace px {
 namespace stirling {
 namespace bpf_tools {
@@ -99,6 +106,51 @@ StatusOr<utils::TaskStructOffsets> BCCWrapper::ComputeTaskStructOffsets() {
   return task_struct_offsets_opt_.value();
 }
 
+namespace {
+
+// The suffix of the per-CPU array that counts the lost events of a ring buffer, see
+// BPF_EVENT_OUTPUT.
+constexpr std::string_view kRingBufferLostSuffix = "_ringbuf_lost";
+
+// BPFTable does not expose the descriptor of its map: the ring buffer API needs its fd, and its
+// type tells ring buffers apart from perf buffers. Tables that the program does not declare have
+// an empty descriptor, whose type is BPF_MAP_TYPE_UNSPEC.
+class BPFTableDesc : public ebpf::BPFTable {
+ public:
+  explicit BPFTableDesc(const ebpf::BPFTable& table) : ebpf::BPFTable(table) {}
+  int fd() const { return desc.fd; }
+  int type() const { return desc.type; }
+};
+
+}  // namespace
+
+bool UseRingBuffers() {
+  if (!FLAGS_stirling_bpf_use_ring_buffers) {
+    return false;
+  }
+  // BPF_MAP_TYPE_RINGBUF was added in Linux 5.8.
+  constexpr system::KernelVersion kKernelVersion5_8 = {5, 8, 0};
+  const auto order =
+      system::CompareKernelVersions(system::GetCachedKernelVersion(), kKernelVersion5_8);
+  return order == system::KernelVersionOrder::kSame || order == system::KernelVersionOrder::kNewer;
+}
+
+std::vector<std::string> RingBufferSizeCFlags(const ArrayView<PerfBufferSpec>& specs) {
+  const int page_size_bytes = system::Config::GetInstance().PageSizeBytes();
+  std::vector<std::string> cflags;
+  for (const PerfBufferSpec& spec : specs) {
+    const int64_t size_bytes = static_cast<int64_t>(spec.size_bytes) * BCCWrapper::kCPUCount;
+    // Ring buffers must be sized to a power of 2 number of pages. Rounding down keeps the ring
+    // buffer within the memory of the perf buffers that it replaces.
+    const int64_t num_pages = IntRoundDownToPow2(size_bytes / page_size_bytes);
+    LOG(INFO) << absl::Substitute(
+        "Ring buffer $0 uses $1 bytes, replacing $2 bytes of perf buffers.", spec.name,
+        num_pages * page_size_bytes, size_bytes);
+    cflags.push_back(absl::Substitute("-D$0_ringbuf_pages=$1", spec.name, num_pages));
+  }
+  return cflags;
+}
+
 Status BCCWrapperImpl::InitBPFProgram(std::string_view bpf_program, std::vector<std::string> cflags,
                                       bool requires_linux_headers,
                                       bool always_infer_task_struct_offsets) {
@@ -365,6 +417,59 @@ int BCCWrapperImpl::CommonPerfBufferSetup(const PerfBufferSpec& perf_buffer_spec
   return num_pages;
 }
 
+int BCCWrapperImpl::HandleRingBufferEvent(void* ctx, void* data, size_t data_size) {
+  auto* ring_buffer = static_cast<RingBuffer*>(ctx);
+  ring_buffer->data_fn(ring_buffer->cb_cookie, data, static_cast<int>(data_size));
+  return 0;
+}
+
+void BCCWrapperImpl::ReportRingBufferLoss(RingBuffer* ring_buffer) {
+  if (ring_buffer->lost_table == nullptr || ring_buffer->loss_fn == nullptr) {
+    return;
+  }
+  std::vector<uint64_t> per_cpu_lost;
+  if (!ring_buffer->lost_table->get_value(0, per_cpu_lost).ok()) {
+    return;
+  }
+  uint64_t lost = 0;
+  for (uint64_t n : per_cpu_lost) {
+    lost += n;
+  }
+  if (lost > ring_buffer->reported_lost) {
+    ring_buffer->loss_fn(ring_buffer->cb_cookie, lost - ring_buffer->reported_lost);
+    ring_buffer->reported_lost = lost;
+  }
+}
+
+Status BCCWrapperImpl::OpenEventBuffer(const std::string& name, perf_reader_raw_cb data_fn,
+                                       perf_reader_lost_cb loss_fn, void* cb_cookie,
+                                       int num_pages) {
+  const BPFTableDesc table(bpf_.get_table(name));
+  if (table.type() != BPF_MAP_TYPE_RINGBUF) {
+    PX_RETURN_IF_ERROR(bpf_.open_perf_buffer(name, data_fn, loss_fn, cb_cookie, num_pages));
+    ++num_open_perf_buffers_;
+    return Status::OK();
+  }
+
+  if (ring_buffers_.contains(name)) {
+    return error::AlreadyExists("Ring buffer \"$0\" is already open.", name);
+  }
+  // The ring buffer itself was sized when the BPF program was compiled.
+  auto ring_buffer = std::make_unique<RingBuffer>(RingBuffer{data_fn, loss_fn, cb_cookie});
+  const std::string lost_table_name = absl::StrCat(name, kRingBufferLostSuffix);
+  if (BPFTableDesc(bpf_.get_table(lost_table_name)).type() == BPF_MAP_TYPE_PERCPU_ARRAY) {
+    ring_buffer->lost_table = std::make_unique<ebpf::BPFPercpuArrayTable<uint64_t>>(
+        bpf_.get_percpu_array_table<uint64_t>(lost_table_name));
+  }
+  ring_buffer->buffer = bpf_new_ringbuf(table.fd(), &HandleRingBufferEvent, ring_buffer.get());
+  if (ring_buffer->buffer == nullptr) {
+    return error::Internal("Unable to open ring buffer \"$0\": $1", name, strerror(errno));
+  }
+  ring_buffers_[name] = std::move(ring_buffer);
+  ++num_open_perf_buffers_;
+  return Status::OK();
+}
+
 Status BCCWrapperImpl::OpenPerfBuffer(const PerfBufferSpec& perf_buffer_spec) {
   const int num_pages = CommonPerfBufferSetup(perf_buffer_spec);
 
@@ -373,10 +478,7 @@ Status BCCWrapperImpl::OpenPerfBuffer(const PerfBufferSpec& perf_buffer_spec) {
   auto& data_fn = perf_buffer_spec.probe_output_fn;
   auto& loss_fn = perf_buffer_spec.probe_loss_fn;
 
-  PX_RETURN_IF_ERROR(bpf_.open_perf_buffer(name, data_fn, loss_fn, cb_cookie, num_pages));
-
-  ++num_open_perf_buffers_;
-  return Status::OK();
+  return OpenEventBuffer(name, data_fn, loss_fn, cb_cookie, num_pages);
 }
 
 Status BCCWrapperImpl::OpenPerfBuffers(const ArrayView<PerfBufferSpec>& perf_buffers) {
@@ -388,7 +490,13 @@ Status BCCWrapperImpl::OpenPerfBuffers(const ArrayView<PerfBufferSpec>& perf_buf
 
 Status BCCWrapperImpl::ClosePerfBuffer(const PerfBufferSpec& perf_buffer) {
   VLOG(1) << "Closing perf buffer: " << perf_buffer.name;
-  PX_RETURN_IF_ERROR(bpf_.close_perf_buffer(std::string(perf_buffer.name)));
+  auto iter = ring_buffers_.find(perf_buffer.name);
+  if (iter != ring_buffers_.end()) {
+    bpf_free_ringbuf(static_cast<struct ring_buffer*>(iter->second->buffer));
+    ring_buffers_.erase(iter);
+  } else {
+    PX_RETURN_IF_ERROR(bpf_.close_perf_buffer(std::string(perf_buffer.name)));
+  }
   --num_open_perf_buffers_;
   return Status::OK();
 }
@@ -444,6 +552,19 @@ std::string BCCWrapperImpl::GetKProbeTargetName(const KProbeSpec& probe) {
 }
 
 Status BCCWrapperImpl::PollPerfBuffer(const std::string& name, const int timeout_ms) {
+  auto iter = ring_buffers_.find(name);
+  if (iter != ring_buffers_.end()) {
+    auto* buffer = static_cast<struct ring_buffer*>(iter->second->buffer);
+    // Consuming does not wait on epoll, which saves a syscall when there is no timeout.
+    if (timeout_ms == 0) {
+      bpf_consume_ringbuf(buffer);
+    } else {
+      bpf_poll_ringbuf(buffer, timeout_ms);
+    }
+    ReportRingBufferLoss(iter->second.get());
+    return Status::OK();
+  }
+
   auto perf_buffer = bpf_.get_perf_buffer(name);
   if (perf_buffer == nullptr) {
     return error::NotFound(absl::Substitute("Perf buffer \"$0\" not found.", name));
@@ -478,10 +599,8 @@ Status RecordingBCCWrapperImpl::OpenPerfBuffer(const PerfBufferSpec& perf_buffer
   auto data_fn = &RecordPerfBufferEvent;
   auto loss_fn = &RecordPerfBufferLoss;
 
-  PX_RETURN_IF_ERROR(bpf_.open_perf_buffer(name, data_fn, loss_fn, cb_cookie, num_pages));
-  ++num_open_perf_buffers_;
-
-  return Status::OK();
+  // Ring buffer events are recorded as perf buffer events, so that they replay the same way.
+  return OpenEventBuffer(name, data_fn, loss_fn, cb_cookie, num_pages);
 }
 
 std::unique_ptr<BCCWrapper> CreateBCC() { return std::make_unique<BCCWrapperImpl>(); }
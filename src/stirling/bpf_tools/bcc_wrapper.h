@@ -32,6 +32,7 @@
 
 #include <linux/perf_event.h>
 
+#include <absl/container/flat_hash_map.h>
 #include <absl/container/flat_hash_set.h>
 #include <gtest/gtest_prod.h>
 
@@ -50,6 +51,8 @@
 #include "src/stirling/bpf_tools/task_struct_resolver.h"
 #include "src/stirling/obj_tools/elf_reader.h"
 
+DECLARE_bool(stirling_bpf_use_ring_buffers);
+
 namespace px {
 /*
  * Status adapter for ebpf::StatusTuple.
@@ -140,7 +143,9 @@ class BCCWrapper {
   virtual Status AttachSamplingProbe(const SamplingProbeSpec& probe) = 0;
 
   /**
-   * Open a perf buffer for reading events.
+   * Open a perf buffer for reading events. If the BPF program declared the output as a BPF ring
+   * buffer (see BPF_EVENT_OUTPUT), the ring buffer is opened instead, with the same callbacks.
+   * The events that a ring buffer lost are read from its lost counter when it is polled.
    * @param perf_buff Specifications of the perf buffer (name, callback function, etc.).
    * @return Error if perf buffer cannot be opened (e.g. perf buffer does not exist).
    */
@@ -328,12 +333,36 @@ class BCCWrapperImpl : public BCCWrapper {
   // Returns the name that identifies the target to attach this k-probe.
   std::string GetKProbeTargetName(const KProbeSpec& probe);
 
+  // A BPF ring buffer opened in place of a perf buffer, along with the perf buffer callbacks that
+  // its events and losses are passed on to.
+  struct RingBuffer {
+    perf_reader_raw_cb data_fn;
+    perf_reader_lost_cb loss_fn;
+    void* cb_cookie;
+    // The struct ring_buffer of BCC's libbpf.h, kept opaque so that this header does not need it.
+    void* buffer = nullptr;
+    // The per-CPU count of the events that didn't fit, if the BPF program declared it (see
+    // BPF_EVENT_OUTPUT), and the total that was already passed on to loss_fn.
+    std::unique_ptr<ebpf::BPFPercpuArrayTable<uint64_t>> lost_table;
+    uint64_t reported_lost = 0;
+  };
+  static int HandleRingBufferEvent(void* ctx, void* data, size_t data_size);
+  // Passes the events that the ring buffer lost since the last call on to its loss callback.
+  static void ReportRingBufferLoss(RingBuffer* ring_buffer);
+
   std::vector<KProbeSpec> kprobes_;
   std::vector<UProbeSpec> uprobes_;
   std::vector<TracepointSpec> tracepoints_;
   std::vector<PerfEventSpec> perf_events_;
 
+  // The ring buffers that are open, keyed by the name of their BPF_RINGBUF_OUTPUT.
+  absl::flat_hash_map<std::string, std::unique_ptr<RingBuffer>> ring_buffers_;
+
  protected:
+  // Opens the perf buffer or ring buffer named name, with the given callbacks.
+  Status OpenEventBuffer(const std::string& name, perf_reader_raw_cb data_fn,
+                         perf_reader_lost_cb loss_fn, void* cb_cookie, int num_pages);
+
   std::vector<PerfBufferSpec> perf_buffer_specs_;
 
  private:
@@ -451,6 +480,20 @@ class ReplayingBCCWrapperImpl : public BCCWrapper {
 
 std::unique_ptr<BCCWrapper> CreateBCC();
 
+/**
+ * Returns true if BPF programs should send their events through BPF ring buffers rather than
+ * per-CPU perf buffers: the kernel has them (Linux 5.8+), and --stirling_bpf_use_ring_buffers is
+ * set. Callers pick the build of their BPF program accordingly (see BPF_EVENT_OUTPUT).
+ */
+bool UseRingBuffers();
+
+/**
+ * Returns the cflags that size the ring buffer of each BPF_EVENT_OUTPUT in specs. A ring buffer is
+ * shared by all CPUs, so it gets the memory of the per-CPU perf buffers that it replaces, rounded
+ * down to a power of 2 number of pages.
+ */
+std::vector<std::string> RingBufferSizeCFlags(const ArrayView<PerfBufferSpec>& specs);
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // Array Table.
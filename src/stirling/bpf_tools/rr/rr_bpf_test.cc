@@ -22,6 +22,8 @@
 
 #include <memory>
 #include <set>
+#include <string>
+#include <string_view>
 #include <vector>
 
 #include "src/common/testing/testing.h"
@@ -37,6 +39,7 @@ using px::stirling::obj_tools::ElfReader;
 // Create a std::string_view named rr_test_bcc_script based on the bazel target :rr_test_bpf_text.
 // This is the BPF program we will invoke for this test.
 OBJ_STRVIEW(rr_test_bcc_script, rr_test_bpf_text);
+OBJ_STRVIEW(rr_test_ringbuf_bcc_script, rr_test_ringbuf_bpf_text);
 
 namespace test {
 
@@ -84,14 +87,15 @@ class BasicRecorderTest : public ::testing::Test {
   BasicRecorderTest() {}
 
  protected:
-  void SetUp() override {
+  void SetUp() override { SetUpBPFProgram(rr_test_bcc_script); }
+
+  void SetUpBPFProgram(std::string_view bcc_script) {
+    test::gold_data.clear();
+    test::test_idx = 0;
+
     recording_bcc_ = std::make_unique<bpf_tools::RecordingBCCWrapperImpl>();
     replaying_bcc_ = std::make_unique<bpf_tools::ReplayingBCCWrapperImpl>();
 
-    // Register our BPF program in the kernel, for real (recording), and for fake (replaying).
-    ASSERT_OK(recording_bcc_->InitBPFProgram(rr_test_bcc_script));
-    ASSERT_OK(replaying_bcc_->InitBPFProgram(rr_test_bcc_script));
-
     const auto recording_perf_buffer_specs = MakeArray<bpf_tools::PerfBufferSpec>({
         .name = std::string("perf_buffer"),
         .probe_output_fn = test::PerfBufferRecordingDataFn,
@@ -105,6 +109,12 @@ class BasicRecorderTest : public ::testing::Test {
         .cb_cookie = this,
     });
 
+    // Register our BPF program in the kernel, for real (recording), and for fake (replaying).
+    // The size cflags only matter to the ring buffer build of the program.
+    const auto cflags = bpf_tools::RingBufferSizeCFlags(recording_perf_buffer_specs);
+    ASSERT_OK(recording_bcc_->InitBPFProgram(bcc_script, cflags));
+    ASSERT_OK(replaying_bcc_->InitBPFProgram(bcc_script, cflags));
+
     // Open perf buffers for real (recording), and for fake (replaying).
     ASSERT_OK(recording_bcc_->OpenPerfBuffers(recording_perf_buffer_specs));
     ASSERT_OK(replaying_bcc_->OpenPerfBuffers(replaying_perf_buffer_specs));
@@ -139,14 +149,56 @@ class BasicRecorderTest : public ::testing::Test {
   }
 
   void TearDown() override {
+    if (recording_bcc_ != nullptr) {
+      recording_bcc_->Close();
+      replaying_bcc_->Close();
+    }
+  }
+
+  // Records the events that calls to Foo() and Bar() push into the perf buffer, then replays them
+  // and checks them against the recorded ones.
+  void RecordAndReplayPerfBuffer(const std::string& pb_file_name) {
+    constexpr uint32_t kLoopIters = 16;
+
+    for (uint32_t i = 0; i < kLoopIters; ++i) {
+      // Invoking Foo() or Bar() triggers our eBPF uprobe, which will capture the function argument.
+      PX_UNUSED(::test::Foo(2 * i + 0));
+      PX_UNUSED(::test::Bar(2 * i + 1));
+    }
+
+    // Polling perf buffers will cause the recording BCC wrapper to record each perf buffer event.
+    recording_bcc_->PollPerfBuffers();
+    EXPECT_EQ(test::gold_data.size(), 2 * kLoopIters);
+
+    // Write out the protobuf file and close the recording BCC wrapper.
+    recording_bcc_->WriteProto(pb_file_name);
     recording_bcc_->Close();
-    replaying_bcc_->Close();
+
+    // Open the protobuf file in the replaying BCC wrapper.
+    // The "replaying" data callback will check "test" (replay) data vs. "gold" data (captured
+    // on the side during original recording when we invoked functions Foo() and Bar()).
+    // Finally, we check that the "test" event count (from replay)
+    // is the same as the "gold" event count (from recording).
+    ASSERT_OK(replaying_bcc_->OpenReplayProtobuf(pb_file_name));
+    replaying_bcc_->PollPerfBuffers();
+    EXPECT_EQ(test::test_idx, test::gold_data.size());
   }
 
   std::unique_ptr<bpf_tools::RecordingBCCWrapperImpl> recording_bcc_;
   std::unique_ptr<bpf_tools::ReplayingBCCWrapperImpl> replaying_bcc_;
 };
 
+// The same, with the build of the BPF program that pushes into a BPF ring buffer.
+class RingBufferRecorderTest : public BasicRecorderTest {
+ protected:
+  void SetUp() override {
+    if (!bpf_tools::UseRingBuffers()) {
+      GTEST_SKIP() << "BPF ring buffers need Linux 5.8+.";
+    }
+    SetUpBPFProgram(rr_test_ringbuf_bcc_script);
+  }
+};
+
 class StackTableRecorderTest : public ::testing::Test {
  public:
   StackTableRecorderTest() {}
@@ -219,33 +271,16 @@ class StackTableRecorderTest : public ::testing::Test {
 };
 
 TEST_F(BasicRecorderTest, PerfBufferRRTest) {
-  constexpr uint32_t kLoopIters = 16;
-
-  for (uint32_t i = 0; i < kLoopIters; ++i) {
-    // Invoking Foo() or Bar() triggers our eBPF uprobe, which will capture the function argument.
-    PX_UNUSED(::test::Foo(2 * i + 0));
-    PX_UNUSED(::test::Bar(2 * i + 1));
-  }
-
-  const std::string pb_file_name = "perf_buffer_replay_test.pb";
-
-  // Polling perf buffers will cause the recording BCC wrapper to record each perf buffer event.
-  recording_bcc_->PollPerfBuffers();
-
-  // Write out the protobuf file and close the recording BCC wrapper.
-  recording_bcc_->WriteProto(pb_file_name);
-  recording_bcc_->Close();
+  RecordAndReplayPerfBuffer("perf_buffer_replay_test.pb");
+}
 
-  // Open the protobuf file in the replaying BCC wrapper.
-  // The "replaying" data callback will check "test" (replay) data vs. "gold" data (captured
-  // on the side during original recording when we invoked functions Foo() and Bar()).
-  // Finally, we check that the "test" event count (from replay)
-  // is the same as the "gold" event count (from recording).
-  ASSERT_OK(replaying_bcc_->OpenReplayProtobuf(pb_file_name));
-  replaying_bcc_->PollPerfBuffers();
-  EXPECT_EQ(test::test_idx, test::gold_data.size());
+TEST_F(RingBufferRecorderTest, RingBufferRRTest) {
+  RecordAndReplayPerfBuffer("ring_buffer_replay_test.pb");
 
-  // TODO(jps): add the expectations.
+  // Unlike per-CPU perf buffers, the ring buffer keeps the events in the order they were pushed.
+  for (uint32_t i = 0; i < test::gold_data.size(); ++i) {
+    EXPECT_EQ(test::gold_data[i], static_cast<int>(i));
+  }
 }
 
 TEST_F(BasicRecorderTest, BPFArrayRRTest) {
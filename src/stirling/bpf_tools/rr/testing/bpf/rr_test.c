@@ -26,7 +26,12 @@
 // LINT_C_FILE: Do not remove this line. It ensures cpplint treats this as a C file.
 #include <linux/ptrace.h>
 
+// The build with PX_USE_RINGBUF pushes into a ring buffer instead, like BPF_EVENT_OUTPUT does.
+#ifdef PX_USE_RINGBUF
+BPF_RINGBUF_OUTPUT(perf_buffer, perf_buffer_ringbuf_pages);
+#else
 BPF_PERF_OUTPUT(perf_buffer);
+#endif
 BPF_HASH(map, int, int);
 BPF_ARRAY(state, int, 1);
 BPF_ARRAY(results, int, 1024);
@@ -46,7 +51,11 @@ int push_something_into_a_perf_buffer(struct pt_regs* ctx) {
   int count = *pcount;
 
   int arg_val = PT_REGS_PARM1(ctx);
+#ifdef PX_USE_RINGBUF
+  perf_buffer.ringbuf_output(&arg_val, sizeof(int), 0);
+#else
   perf_buffer.perf_submit(ctx, &arg_val, sizeof(int));
+#endif
   map.update(&count, &arg_val);
   results.update(&count, &arg_val);
 
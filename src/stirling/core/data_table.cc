@@ -59,6 +59,38 @@ Tablet* DataTable::GetTablet(types::TabletIDView tablet_id) {
   return &tablet;
 }
 
+namespace {
+
+template <types::DataType TDataType>
+void MoveColumn(ColumnWrapper* from, ColumnWrapper* to) {
+  using TValueType = typename types::DataTypeTraits<TDataType>::value_type;
+  auto* from_col = static_cast<types::ColumnWrapperTmpl<TValueType>*>(from);
+  auto* to_col = static_cast<types::ColumnWrapperTmpl<TValueType>*>(to);
+  for (size_t i = 0; i < from_col->Size(); ++i) {
+    to_col->Append(std::move((*from_col)[i]));
+  }
+  from_col->Clear();
+}
+
+}  // namespace
+
+void DataTable::MoveRecordsFrom(DataTable* other) {
+  DCHECK_EQ(&table_schema_, &other->table_schema_);
+  for (auto& [tablet_id, from] : other->tablets_) {
+    if (from.times.empty()) {
+      continue;
+    }
+    Tablet* to = GetTablet(tablet_id);
+    to->times.insert(to->times.end(), from.times.begin(), from.times.end());
+    for (size_t i = 0; i < from.records.size(); ++i) {
+#define TYPE_CASE(_dt_) MoveColumn<_dt_>(from.records[i].get(), to->records[i].get());
+      PX_SWITCH_FOREACH_DATATYPE(table_schema_.elements()[i].type(), TYPE_CASE);
+#undef TYPE_CASE
+    }
+    from.times.clear();
+  }
+}
+
 std::vector<TaggedRecordBatch> DataTable::ConsumeRecords() {
   std::vector<TaggedRecordBatch> tablets_out;
   absl::flat_hash_map<types::TabletID, Tablet> carryover_tablets;
@@ -105,6 +105,15 @@ class DataTable : public NotCopyable {
    */
   double OccupancyPct() const { return 1.0 * Occupancy() / kTargetCapacity; }
 
+  /**
+   * Moves the records buffered in another data table of the same schema into this one, as if they
+   * had been appended to this table. This lets several threads build records for the same table
+   * in tables of their own, which are then merged before the records are consumed.
+   *
+   * @param other The table to move records from, which is left empty.
+   */
+  void MoveRecordsFrom(DataTable* other);
+
   // Example usage:
   // DataTable::RecordBuilder<&kTable> r(data_table, time);
   // r.Append<r.ColIndex("field0")>(val0);
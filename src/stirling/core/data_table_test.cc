@@ -314,6 +314,38 @@ TEST_F(DataTableTest, Carryover) {
   }
 }
 
+TEST_F(DataTableTest, MoveRecordsFrom) {
+  auto other_table = std::make_unique<DataTable>(/*id*/ 0, kSchema);
+
+  std::vector<int> time_vals = {0, 10, 40, 20, 30, 50};
+  std::vector<int> x_vals = {0, 1, 4, 2, 3, 5};
+  std::vector<std::string> s_vals = {"a", "b", "e", "c", "d", "f"};
+
+  // Alternate the records between the two tables.
+  for (size_t i = 0; i < time_vals.size(); ++i) {
+    DataTable* table = (i % 2 == 0) ? data_table_.get() : other_table.get();
+    DataTable::RecordBuilder<&kSchema> r(table, time_vals[i]);
+    r.Append<r.ColIndex("time_")>(time_vals[i]);
+    r.Append<r.ColIndex("x")>(x_vals[i]);
+    r.Append<r.ColIndex("s")>(s_vals[i]);
+  }
+
+  data_table_->MoveRecordsFrom(other_table.get());
+  EXPECT_EQ(data_table_->Occupancy(), 6);
+  EXPECT_EQ(other_table->Occupancy(), 0);
+  EXPECT_TRUE(other_table->ConsumeRecords().empty());
+
+  std::vector<TaggedRecordBatch> record_batches = data_table_->ConsumeRecords();
+  ASSERT_EQ(record_batches.size(), 1);
+  types::ColumnWrapperRecordBatch& rb = record_batches[0].records;
+  ASSERT_EQ(rb[0]->Size(), 6);
+  for (size_t i = 0; i < time_vals.size(); ++i) {
+    EXPECT_EQ(rb[0]->Get<types::Time64NSValue>(i), 10 * static_cast<int>(i));
+    EXPECT_EQ(rb[1]->Get<types::Int64Value>(i), static_cast<int>(i));
+    EXPECT_EQ(rb[2]->Get<types::StringValue>(i), std::string(1, 'a' + i));
+  }
+}
+
 class DataTableStressTest : public ::testing::Test {
  private:
   std::default_random_engine rng_;
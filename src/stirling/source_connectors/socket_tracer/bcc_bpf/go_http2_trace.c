@@ -29,7 +29,7 @@
 
 #define MAX_HEADER_COUNT 59
 
-BPF_PERF_OUTPUT(go_grpc_events);
+BPF_EVENT_OUTPUT(go_grpc_events);
 
 // BPF programs are limited to a 512-byte stack. We store this value per CPU
 // and use it as a heap allocated value.
@@ -213,7 +213,7 @@ static __inline void submit_headers(struct pt_regs* ctx, enum http2_probe_type_t
   for (unsigned int i = 0; i < MAX_HEADER_COUNT; ++i) {
     if (i < fields_len) {
       fill_header_field(event, fields_ptr + i * kSizeOfHeaderField, symaddrs);
-      go_grpc_events.perf_submit(ctx, event, sizeof(*event));
+      BPF_EVENT_SUBMIT(go_grpc_events, ctx, event, sizeof(*event));
     }
   }
 
@@ -222,7 +222,7 @@ static __inline void submit_headers(struct pt_regs* ctx, enum http2_probe_type_t
     event->name.size = 0;
     event->value.size = 0;
     event->attr.end_stream = true;
-    go_grpc_events.perf_submit(ctx, event, sizeof(*event));
+    BPF_EVENT_SUBMIT(go_grpc_events, ctx, event, sizeof(*event));
   }
 }
 
@@ -250,7 +250,7 @@ static __inline void submit_header(struct pt_regs* ctx, enum http2_probe_type_t
   copy_header_field(&event->name, name_ptr);
   copy_header_field(&event->value, value_ptr);
 
-  go_grpc_events.perf_submit(ctx, event, sizeof(*event));
+  BPF_EVENT_SUBMIT(go_grpc_events, ctx, event, sizeof(*event));
 }
 
 // TODO(oazizi): Remove this struct; Use DWARF instead.
@@ -782,7 +782,7 @@ int probe_http_http2writeResHeaders_write_frame(struct pt_regs* ctx) {
     event->value.size = 0;
     event->attr.end_stream = true;
 
-    go_grpc_events.perf_submit(ctx, event, sizeof(*event));
+    BPF_EVENT_SUBMIT(go_grpc_events, ctx, event, sizeof(*event));
   }
 
   // TODO(oazizi): We are leaking BPF map entries until this line is activated,
@@ -841,8 +841,8 @@ static __inline void go_http2_submit_data(struct pt_regs* ctx, enum http2_probe_
 
   if (data_buf_size_minus_1 < MAX_DATA_SIZE) {
     bpf_probe_read(info->data, data_buf_size, data_ptr);
-    go_grpc_events.perf_submit(ctx, info,
-                               sizeof(info->attr) + sizeof(info->data_attr) + data_buf_size);
+    BPF_EVENT_SUBMIT(go_grpc_events, ctx, info,
+                     sizeof(info->attr) + sizeof(info->data_attr) + data_buf_size);
   }
 }
 
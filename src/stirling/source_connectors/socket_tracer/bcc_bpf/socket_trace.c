@@ -44,13 +44,13 @@ const int32_t kInvalidFD = -1;
 // is reported to user-space. It applies to read and write traffic combined.
 const int kConnStatsDataThreshold = 65536;
 
-// This is the perf buffer for BPF program to export data from kernel to user space.
-BPF_PERF_OUTPUT(socket_data_events);
-BPF_PERF_OUTPUT(socket_control_events);
-BPF_PERF_OUTPUT(conn_stats_events);
+// These are the event outputs for BPF program to export data from kernel to user space.
+BPF_EVENT_OUTPUT(socket_data_events);
+BPF_EVENT_OUTPUT(socket_control_events);
+BPF_EVENT_OUTPUT(conn_stats_events);
 
 // This output is used to export notification of processes that have performed an mmap.
-BPF_PERF_OUTPUT(mmap_events);
+BPF_EVENT_OUTPUT(mmap_events);
 
 // This control_map is a bit-mask that controls which endpoints are traced in a connection.
 // The bits are defined in endpoint_role_t enum, kRoleClient or kRoleServer. kRoleUnknown is not
@@ -407,7 +407,8 @@ static __inline void submit_new_conn(struct pt_regs* ctx, uint32_t tgid, int32_t
   control_event.open.laddr = conn_info.laddr;
   control_event.open.role = conn_info.role;
 
-  socket_control_events.perf_submit(ctx, &control_event, sizeof(struct socket_control_event_t));
+  BPF_EVENT_SUBMIT(socket_control_events, ctx, &control_event,
+                   sizeof(struct socket_control_event_t));
 }
 
 static __inline void submit_close_event(struct pt_regs* ctx, struct conn_info_t* conn_info,
@@ -420,7 +421,8 @@ static __inline void submit_close_event(struct pt_regs* ctx, struct conn_info_t*
   control_event.close.rd_bytes = conn_info->rd_bytes;
   control_event.close.wr_bytes = conn_info->wr_bytes;
 
-  socket_control_events.perf_submit(ctx, &control_event, sizeof(struct socket_control_event_t));
+  BPF_EVENT_SUBMIT(socket_control_events, ctx, &control_event,
+                   sizeof(struct socket_control_event_t));
 }
 
 // Writes the input buf to event, and submits the event to the corresponding perf buffer.
@@ -493,7 +495,7 @@ static __inline void perf_submit_buf(struct pt_regs* ctx, const enum traffic_dir
   // If-statement is redundant, but is required to keep the 4.14 verifier happy.
   if (amount_copied > 0) {
     event->attr.msg_buf_size = amount_copied;
-    socket_data_events.perf_submit(ctx, event, sizeof(event->attr) + amount_copied);
+    BPF_EVENT_SUBMIT(socket_data_events, ctx, event, sizeof(event->attr) + amount_copied);
   }
 }
 
@@ -729,7 +731,7 @@ static __inline void update_conn_stats(struct pt_regs* ctx, struct conn_info_t*
   if (meets_activity_threshold) {
     struct conn_stats_event_t* event = fill_conn_stats_event(conn_info);
     if (event != NULL) {
-      conn_stats_events.perf_submit(ctx, event, sizeof(struct conn_stats_event_t));
+      BPF_EVENT_SUBMIT(conn_stats_events, ctx, event, sizeof(struct conn_stats_event_t));
     }
 
     conn_info->last_reported_bytes = conn_info->rd_bytes + conn_info->wr_bytes;
@@ -899,7 +901,7 @@ static __inline void process_syscall_sendfile(struct pt_regs* ctx, uint64_t id,
     event->attr.pos = conn_info->wr_bytes;
     event->attr.msg_size = bytes_count;
     event->attr.msg_buf_size = 0;
-    socket_data_events.perf_submit(ctx, event, sizeof(event->attr));
+    BPF_EVENT_SUBMIT(socket_data_events, ctx, event, sizeof(event->attr));
   }
 
   update_conn_stats(ctx, conn_info, kEgress, bytes_count);
@@ -941,7 +943,7 @@ static __inline void process_syscall_close(struct pt_regs* ctx, uint64_t id,
     struct conn_stats_event_t* event = fill_conn_stats_event(conn_info);
     if (event != NULL) {
       event->conn_events = event->conn_events | CONN_CLOSE;
-      conn_stats_events.perf_submit(ctx, event, sizeof(struct conn_stats_event_t));
+      BPF_EVENT_SUBMIT(conn_stats_events, ctx, event, sizeof(struct conn_stats_event_t));
     }
   }
 
@@ -1610,7 +1612,7 @@ int syscall__probe_entry_mmap(struct pt_regs* ctx) {
   upid.tgid = id >> 32;
   upid.start_time_ticks = get_tgid_start_time();
 
-  mmap_events.perf_submit(ctx, &upid, sizeof(upid));
+  BPF_EVENT_SUBMIT(mmap_events, ctx, &upid, sizeof(upid));
 
   return 0;
 }
@@ -141,24 +141,24 @@ void ConnTracker::AddConnCloseEvent(const socket_control_event_t& event) {
   MarkForDeath();
 }
 
-void ConnTracker::AddDataEvent(std::unique_ptr<SocketDataEvent> event) {
-  SetRole(event->attr.role, "inferred from data_event");
-  SetProtocol(event->attr.protocol, "inferred from data_event");
-  SetSSL(event->attr.ssl, event->attr.ssl_source, "inferred from data_event");
+void ConnTracker::AddDataEvent(const SocketDataEvent& event) {
+  SetRole(event.attr.role, "inferred from data_event");
+  SetProtocol(event.attr.protocol, "inferred from data_event");
+  SetSSL(event.attr.ssl, event.attr.ssl_source, "inferred from data_event");
 
   CheckTracker();
-  UpdateTimestamps(event->attr.timestamp_ns);
-  UpdateDataStats(*event);
+  UpdateTimestamps(event.attr.timestamp_ns);
+  UpdateDataStats(event);
 
-  CONN_TRACE(1) << absl::Substitute("Data event: $0", event->ToString());
+  CONN_TRACE(1) << absl::Substitute("Data event: $0", event.ToString());
 
   // TODO(yzhao): Change to let userspace resolve the connection type and signal back to BPF.
   // Then we need at least one data event to let ConnTracker know the field descriptor.
-  if (event->attr.protocol == kProtocolUnknown) {
+  if (event.attr.protocol == kProtocolUnknown) {
     return;
   }
 
-  if (event->attr.protocol != protocol_) {
+  if (event.attr.protocol != protocol_) {
     return;
   }
 
@@ -167,12 +167,12 @@ void ConnTracker::AddDataEvent(std::unique_ptr<SocketDataEvent> event) {
     return;
   }
 
-  switch (event->attr.direction) {
+  switch (event.attr.direction) {
     case traffic_direction_t::kEgress: {
-      send_data_.AddData(std::move(event));
+      send_data_.AddData(event);
     } break;
     case traffic_direction_t::kIngress: {
-      recv_data_.AddData(std::move(event));
+      recv_data_.AddData(event);
     } break;
   }
 }
@@ -210,9 +210,11 @@ class ConnTracker : NotCopyMoveable {
   /**
    * Registers a BPF data event into the tracker.
    *
-   * @param event The data event from BPF.
+   * @param event The data event from BPF. Its data is copied, so it may be released once this
+   * returns.
    */
-  void AddDataEvent(std::unique_ptr<SocketDataEvent> event);
+  void AddDataEvent(const SocketDataEvent& event);
+  void AddDataEvent(std::unique_ptr<SocketDataEvent> event) { AddDataEvent(*event); }
 
   /**
    * Registers a BPF connection stats event into the tracker.
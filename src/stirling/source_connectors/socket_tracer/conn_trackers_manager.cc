@@ -17,6 +17,9 @@
  */
 
 #include "src/stirling/source_connectors/socket_tracer/conn_trackers_manager.h"
+
+#include <absl/hash/hash.h>
+
 #include "src/common/metrics/metrics.h"
 
 DEFINE_double(
@@ -139,6 +142,10 @@ ConnTracker& ConnTrackersManager::GetOrCreateConnTracker(struct conn_id_t conn_i
   return *conn_tracker_ptr;
 }
 
+size_t ConnTrackersManager::ShardOf(const struct conn_id_t& conn_id, size_t num_shards) {
+  return absl::Hash<uint64_t>()(GetConnMapKey(conn_id.upid.pid, conn_id.fd)) % num_shards;
+}
+
 StatusOr<const ConnTracker*> ConnTrackersManager::GetConnTracker(uint32_t pid, int32_t fd) const {
   const uint64_t conn_map_key = GetConnMapKey(pid, fd);
 
@@ -110,6 +110,12 @@ class ConnTrackersManager {
 
   const std::list<ConnTracker*>& active_trackers() const { return active_trackers_; }
 
+  /**
+   * Returns the shard, out of num_shards, that the trackers of a connection are processed in.
+   * Trackers are sharded by {PID, FD}, so all the generations of a connection share a shard.
+   */
+  static size_t ShardOf(const struct conn_id_t& conn_id, size_t num_shards);
+
   /**
    * Returns the latest generation of a connection tracker for the given pid and fd.
    * If there is no tracker for {pid, fd}, returns error::NotFound.
@@ -17,6 +17,7 @@
  */
 
 #include <random>
+#include <vector>
 
 #include "src/common/testing/testing.h"
 #include "src/stirling/source_connectors/socket_tracer/conn_trackers_manager.h"
@@ -112,6 +113,25 @@ TEST_F(ConnTrackersManagerTest, DebugInfo) {
   EXPECT_THAT(debug_info, HasSubstr("conn_tracker=conn_id=[upid=1:1 fd=1 gen=1]"));
 }
 
+// Tests that all the generations of a connection are processed in the same shard.
+TEST_F(ConnTrackersManagerTest, ShardOf) {
+  constexpr size_t kNumShards = 4;
+  std::vector<int> shard_counts(kNumShards, 0);
+  for (uint32_t pid = 1; pid <= 100; ++pid) {
+    struct conn_id_t conn_id = {{{pid}, 1}, /*fd*/ 3, /*tsid*/ 1};
+    size_t shard = ConnTrackersManager::ShardOf(conn_id, kNumShards);
+    ASSERT_LT(shard, kNumShards);
+    ++shard_counts[shard];
+
+    conn_id.tsid = 2;
+    EXPECT_EQ(ConnTrackersManager::ShardOf(conn_id, kNumShards), shard);
+  }
+  for (int count : shard_counts) {
+    EXPECT_GT(count, 0);
+  }
+  EXPECT_EQ(ConnTrackersManager::ShardOf({{{1}, 1}, 3, 1}, 1), 0);
+}
+
 class ConnTrackerGenerationsTest : public ::testing::Test {
  protected:
   ConnTrackerGenerationsTest() : tracker_pool(1024) {
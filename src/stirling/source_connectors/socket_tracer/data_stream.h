@@ -58,8 +58,10 @@ class DataStream : NotCopyMoveable {
 
   /**
    * Adds a raw (unparsed) chunk of data into the stream.
+   * The data is copied, so the event may be released once this returns.
    */
-  void AddData(std::unique_ptr<SocketDataEvent> event);
+  void AddData(const SocketDataEvent& event);
+  void AddData(std::unique_ptr<SocketDataEvent> event) { AddData(*event); }
 
   /**
    * Parses as many messages as it can from the raw events into the messages container.
@@ -279,6 +279,30 @@ TEST_P(DataStreamBufferTest, LargeGap) {
   }
 }
 
+// Tests that the data left in the head after an iteration is kept when the events of the next
+// iterations are added, whether they arrive in order or not.
+TEST_P(DataStreamBufferTest, HeadAcrossIterations) {
+  DataStreamBuffer stream_buffer(15, 15, 15);
+
+  stream_buffer.Add(0, "012", 0);
+  stream_buffer.Add(3, "345", 3);
+  EXPECT_EQ(stream_buffer.Head(), "012345");
+  stream_buffer.RemovePrefix(4);
+  EXPECT_EQ(stream_buffer.Head(), "45");
+
+  stream_buffer.Add(6, "67", 6);
+  stream_buffer.Add(8, "89", 8);
+  EXPECT_EQ(stream_buffer.Head(), "456789");
+  EXPECT_OK_AND_EQ(stream_buffer.GetTimestamp(8), 8);
+  stream_buffer.RemovePrefix(6);
+  EXPECT_EQ(stream_buffer.Head(), "");
+
+  stream_buffer.Add(12, "cd", 12);
+  stream_buffer.Add(10, "ab", 10);
+  EXPECT_EQ(stream_buffer.Head(), "abcd");
+  EXPECT_OK_AND_EQ(stream_buffer.GetTimestamp(12), 12);
+}
+
 INSTANTIATE_TEST_SUITE_P(DataStreamBufferImplTest, DataStreamBufferTest,
                          ::testing::Values(true, false),
                          [](const ::testing::TestParamInfo<DataStreamBufferTest::ParamType>& info) {
@@ -33,8 +33,15 @@ FixedSizeContiguousBuffer::FixedSizeContiguousBuffer(size_t capacity)
   DCHECK_GT(capacity, 0U);
 }
 
+FixedSizeContiguousBuffer::FixedSizeContiguousBuffer(std::string data)
+    : adopted_(std::move(data)),
+      data_(reinterpret_cast<uint8_t*>(adopted_.data())),
+      capacity_(adopted_.size()) {
+  DCHECK_GT(capacity_, 0U);
+}
+
 FixedSizeContiguousBuffer::~FixedSizeContiguousBuffer() {
-  if (capacity_ == 0) {
+  if (capacity_ == 0 || !adopted_.empty()) {
     return;
   }
   // TODO(james): investigate sized delete.
@@ -78,10 +85,14 @@ void LazyContiguousDataStreamBufferImpl::Add(size_t pos, std::string_view data,
   if (size() + data.size() > capacity_) {
     EvictBytes(size() + data.size() - capacity_);
   }
+  CompactStaging();
 
+  auto [_, inserted] = events_.try_emplace(pos, Event{timestamp, staging_.size(), data.size()});
+  if (!inserted) {
+    return;
+  }
   events_size_ += data.size();
-  auto event = Event{timestamp, std::string(data)};
-  events_.emplace(pos, std::move(event));
+  staging_.append(data);
 }
 
 size_t LazyContiguousDataStreamBufferImpl::EvictBytes(size_t n_bytes) {
@@ -104,14 +115,34 @@ size_t LazyContiguousDataStreamBufferImpl::EvictBytes(size_t n_bytes) {
   }
   auto it = events_.begin();
   while (it != events_.end() && evicted < n_bytes) {
-    size_t event_size = it->second.data.size();
+    size_t event_size = it->second.size;
     evicted += event_size;
     events_size_ -= event_size;
     it = events_.erase(it);
   }
+  ReleaseStagingIfUnused();
   return evicted;
 }
 
+void LazyContiguousDataStreamBufferImpl::CompactStaging() {
+  if (staging_.size() - events_size_ <= capacity_) {
+    return;
+  }
+  std::string compacted;
+  compacted.reserve(events_size_);
+  for (auto& [_, event] : events_) {
+    compacted.append(staging_, event.offset, event.size);
+    event.offset = compacted.size() - event.size;
+  }
+  staging_.swap(compacted);
+}
+
+void LazyContiguousDataStreamBufferImpl::ReleaseStagingIfUnused() {
+  if (events_.empty()) {
+    std::string().swap(staging_);
+  }
+}
+
 bool LazyContiguousDataStreamBufferImpl::IsHeadAndEventsMergeable() const {
   if (head_ == nullptr) {
     return events_size_ != 0;
@@ -134,27 +165,47 @@ void LazyContiguousDataStreamBufferImpl::MergeContiguousEventsIntoHead() {
   }
 
   // We first calculate how big the new buffer needs to be, and then we fill the buffer later.
+  // While doing so, check whether the events also follow each other in `staging_`, up to its end.
   auto it = events_.begin();
+  size_t staging_end = it->second.offset;
+  bool staging_contiguous = true;
   while (it != events_.end() && it->first == buffer_end_pos) {
-    size_t event_size = it->second.data.size();
+    size_t event_size = it->second.size;
     new_buffer_size += event_size;
     buffer_end_pos += event_size;
+    staging_contiguous = staging_contiguous && it->second.offset == staging_end;
+    staging_end += event_size;
     it++;
   }
   auto end_it = it;
 
-  auto new_buffer = std::make_unique<FixedSizeContiguousBuffer>(new_buffer_size);
+  // If the merged events are all of the events, and they are laid out in order in `staging_`,
+  // `staging_` already holds the new head, so it is taken over rather than copied.
+  bool adopt_staging = head_ == nullptr && end_it == events_.end() && staging_contiguous &&
+                       staging_end == staging_.size();
+
+  std::unique_ptr<FixedSizeContiguousBuffer> new_buffer;
   size_t offset = 0;
-  if (head_ != nullptr) {
-    memcpy(new_buffer->Data(), head_->Data(), head_->Size());
-    offset += head_->Size();
+  if (adopt_staging) {
+    size_t first_event_offset = events_.begin()->second.offset;
+    new_buffer = std::make_unique<FixedSizeContiguousBuffer>(std::move(staging_));
+    new_buffer->RemovePrefix(first_event_offset);
+    staging_ = std::string();
+  } else {
+    new_buffer = std::make_unique<FixedSizeContiguousBuffer>(new_buffer_size);
+    if (head_ != nullptr) {
+      memcpy(new_buffer->Data(), head_->Data(), head_->Size());
+      offset += head_->Size();
+    }
   }
 
   it = events_.begin();
   // end_it stopped at the first non-contiguous event (at the end of current head)
   while (it != end_it) {
-    size_t event_size = it->second.data.size();
-    memcpy(new_buffer->Data() + offset, it->second.data.data(), event_size);
+    size_t event_size = it->second.size;
+    if (!adopt_staging) {
+      memcpy(new_buffer->Data() + offset, staging_.data() + it->second.offset, event_size);
+    }
     // Ensure that the event timestamps are monotonically increasing for a given contiguous head
     if (prev_timestamp_ > 0 && it->second.timestamp < prev_timestamp_) {
       LOG(WARNING) << absl::Substitute(
@@ -169,6 +220,7 @@ void LazyContiguousDataStreamBufferImpl::MergeContiguousEventsIntoHead() {
     events_size_ -= event_size;
     it = events_.erase(it);
   }
+  ReleaseStagingIfUnused();
 
   head_position_ = new_head_position;
   head_.swap(new_buffer);
@@ -225,7 +277,7 @@ void LazyContiguousDataStreamBufferImpl::RemovePrefix(ssize_t n) {
   // of the loop and handle the last event separately.
   auto it = events_.begin();
   while (remaining > 0 && it != events_.end()) {
-    size_t event_size = it->second.data.size();
+    size_t event_size = it->second.size;
     if (event_size > remaining) {
       break;
     }
@@ -238,10 +290,12 @@ void LazyContiguousDataStreamBufferImpl::RemovePrefix(ssize_t n) {
   if (remaining > 0 && events_.size() > 0) {
     auto node_handle = events_.extract(events_.begin());
     node_handle.key() += remaining;
-    node_handle.mapped().data = node_handle.mapped().data.substr(remaining);
+    node_handle.mapped().offset += remaining;
+    node_handle.mapped().size -= remaining;
     events_.insert(std::move(node_handle));
     events_size_ -= remaining;
   }
+  ReleaseStagingIfUnused();
 
   // Increment head_position_ even if head_ became invalid. In normal operation (where `Head()` is
   // called before the next call to `position()`), this doesn't matter. However, its useful to align
@@ -267,6 +321,7 @@ void LazyContiguousDataStreamBufferImpl::Reset() {
   head_pos_to_ts_.clear();
   events_.clear();
   events_size_ = 0;
+  std::string().swap(staging_);
 }
 
 void LazyContiguousDataStreamBufferImpl::ShrinkToFit() {
@@ -296,9 +351,9 @@ size_t LazyContiguousDataStreamBufferImpl::size() const {
 
 size_t LazyContiguousDataStreamBufferImpl::capacity() const {
   if (head_ == nullptr) {
-    return events_size_;
+    return staging_.capacity();
   }
-  return head_->Capacity() + events_size_;
+  return head_->Capacity() + staging_.capacity();
 }
 
 bool LazyContiguousDataStreamBufferImpl::empty() const { return size() == 0; }
@@ -43,6 +43,9 @@ class FixedSizeContiguousBuffer : public NotCopyable {
   ~FixedSizeContiguousBuffer();
   // Passing capacity == 0 is undefined behaviour.
   explicit FixedSizeContiguousBuffer(size_t capacity);
+  // Takes over the bytes of data, without copying them. Passing an empty string is undefined
+  // behaviour.
+  explicit FixedSizeContiguousBuffer(std::string data);
   std::string_view StringView();
   // Invalidate first n bytes of data
   void RemovePrefix(size_t n);
@@ -51,6 +54,8 @@ class FixedSizeContiguousBuffer : public NotCopyable {
   size_t Capacity() const;
 
  private:
+  // Holds the bytes when they were taken over from a string, otherwise empty.
+  std::string adopted_;
   uint8_t* data_;
   size_t capacity_;
   size_t offset_ = 0;
@@ -59,6 +64,11 @@ class FixedSizeContiguousBuffer : public NotCopyable {
 /**
  * This version of the DataStreamBuffer creates contiguous regions lazily, only when requested by
  * Head().
+ *
+ * The events added between two calls to Head() are copied back to back into a single staging
+ * buffer. When they all turn out to be contiguous, which is the common case of a connection whose
+ * data arrived in order, Head() takes over the staging buffer as is, so that the data is parsed
+ * from where it was first copied to.
  */
 class LazyContiguousDataStreamBufferImpl : public DataStreamBufferImpl {
  public:
@@ -93,16 +103,12 @@ class LazyContiguousDataStreamBufferImpl : public DataStreamBufferImpl {
 
  private:
   // Store individual events separately before lazyily merging them into a contiguous buffer when
-  // requested by `Head()`.
+  // requested by `Head()`. The data of an event is the range [offset, offset + size) of
+  // `staging_`.
   struct Event {
     uint64_t timestamp;
-    std::string data;
-
-    // Only allow moving events.
-    Event(Event&&) = default;
-    Event& operator=(Event&&) = default;
-    Event(const Event&) = delete;
-    Event& operator=(const Event&) = delete;
+    size_t offset;
+    size_t size;
   };
 
   // Attempt to evict n_bytes worth of data, return the number of bytes evicted.
@@ -123,6 +129,13 @@ class LazyContiguousDataStreamBufferImpl : public DataStreamBufferImpl {
   // Cleanup `head_pos_to_ts_` by removing all entries before `head_position_ + removed`.
   void CleanupHeadTimestamps(size_t removed);
 
+  // Drops the bytes of `staging_` that no event refers to anymore, if they take up more space than
+  // the buffer may hold.
+  void CompactStaging();
+
+  // Releases `staging_` once no event refers to it.
+  void ReleaseStagingIfUnused();
+
   const size_t capacity_;
 
   size_t head_position_ = 0;
@@ -132,6 +145,7 @@ class LazyContiguousDataStreamBufferImpl : public DataStreamBufferImpl {
 
   std::map<size_t, Event> events_;
   size_t events_size_ = 0;
+  std::string staging_;
 };
 
 }  // namespace protocols
@@ -0,0 +1,248 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/source_connectors/socket_tracer/protocols/common/multi_pattern_finder.h"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+#include <algorithm>
+
+#include "src/common/base/base.h"
+
+namespace px {
+namespace stirling {
+namespace protocols {
+
+namespace {
+
+constexpr size_t kNPos = std::string_view::npos;
+
+#if defined(__x86_64__)
+
+// Each scan calls matches_at() on the positions of its range whose byte is one of first_bytes, and
+// returns the first (or last) position that matches, or npos. They only scan whole blocks, and
+// leave *pos (or *end) at the bytes that remain for the caller.
+
+template <typename TMatchFn>
+size_t ScanForwardSSE2(std::string_view buf, size_t* pos, std::string_view first_bytes,
+                       const TMatchFn& matches_at) {
+  __m128i needles[16];
+  for (size_t i = 0; i < first_bytes.size(); ++i) {
+    needles[i] = _mm_set1_epi8(first_bytes[i]);
+  }
+  for (; *pos + 16 <= buf.size(); *pos += 16) {
+    const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf.data() + *pos));
+    __m128i eq = _mm_setzero_si128();
+    for (size_t i = 0; i < first_bytes.size(); ++i) {
+      eq = _mm_or_si128(eq, _mm_cmpeq_epi8(block, needles[i]));
+    }
+    for (uint32_t mask = _mm_movemask_epi8(eq); mask != 0; mask &= mask - 1) {
+      const size_t candidate = *pos + __builtin_ctz(mask);
+      if (matches_at(candidate)) {
+        return candidate;
+      }
+    }
+  }
+  return kNPos;
+}
+
+template <typename TMatchFn>
+size_t ScanBackwardSSE2(std::string_view buf, size_t* end, std::string_view first_bytes,
+                        const TMatchFn& matches_at) {
+  __m128i needles[16];
+  for (size_t i = 0; i < first_bytes.size(); ++i) {
+    needles[i] = _mm_set1_epi8(first_bytes[i]);
+  }
+  for (; *end >= 16; *end -= 16) {
+    const __m128i block =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf.data() + *end - 16));
+    __m128i eq = _mm_setzero_si128();
+    for (size_t i = 0; i < first_bytes.size(); ++i) {
+      eq = _mm_or_si128(eq, _mm_cmpeq_epi8(block, needles[i]));
+    }
+    for (uint32_t mask = _mm_movemask_epi8(eq); mask != 0;) {
+      const int bit = 31 - __builtin_clz(mask);
+      const size_t candidate = *end - 16 + bit;
+      if (matches_at(candidate)) {
+        return candidate;
+      }
+      mask &= ~(1u << bit);
+    }
+  }
+  return kNPos;
+}
+
+template <typename TMatchFn>
+__attribute__((target("avx2"))) size_t ScanForwardAVX2(std::string_view buf, size_t* pos,
+                                                       std::string_view first_bytes,
+                                                       const TMatchFn& matches_at) {
+  __m256i needles[16];
+  for (size_t i = 0; i < first_bytes.size(); ++i) {
+    needles[i] = _mm256_set1_epi8(first_bytes[i]);
+  }
+  for (; *pos + 32 <= buf.size(); *pos += 32) {
+    const __m256i block =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(buf.data() + *pos));
+    __m256i eq = _mm256_setzero_si256();
+    for (size_t i = 0; i < first_bytes.size(); ++i) {
+      eq = _mm256_or_si256(eq, _mm256_cmpeq_epi8(block, needles[i]));
+    }
+    for (uint32_t mask = _mm256_movemask_epi8(eq); mask != 0; mask &= mask - 1) {
+      const size_t candidate = *pos + __builtin_ctz(mask);
+      if (matches_at(candidate)) {
+        return candidate;
+      }
+    }
+  }
+  return kNPos;
+}
+
+template <typename TMatchFn>
+__attribute__((target("avx2"))) size_t ScanBackwardAVX2(std::string_view buf, size_t* end,
+                                                        std::string_view first_bytes,
+                                                        const TMatchFn& matches_at) {
+  __m256i needles[16];
+  for (size_t i = 0; i < first_bytes.size(); ++i) {
+    needles[i] = _mm256_set1_epi8(first_bytes[i]);
+  }
+  for (; *end >= 32; *end -= 32) {
+    const __m256i block =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(buf.data() + *end - 32));
+    __m256i eq = _mm256_setzero_si256();
+    for (size_t i = 0; i < first_bytes.size(); ++i) {
+      eq = _mm256_or_si256(eq, _mm256_cmpeq_epi8(block, needles[i]));
+    }
+    for (uint32_t mask = _mm256_movemask_epi8(eq); mask != 0;) {
+      const int bit = 31 - __builtin_clz(mask);
+      const size_t candidate = *end - 32 + bit;
+      if (matches_at(candidate)) {
+        return candidate;
+      }
+      mask &= ~(1u << bit);
+    }
+  }
+  return kNPos;
+}
+
+#endif
+
+}  // namespace
+
+MultiPatternFinder::Impl MultiPatternFinder::BestImpl() {
+#if defined(__x86_64__)
+  static const Impl kBestImpl = __builtin_cpu_supports("avx2") ? Impl::kAVX2 : Impl::kSSE2;
+  return kBestImpl;
+#else
+  return Impl::kScalar;
+#endif
+}
+
+MultiPatternFinder::MultiPatternFinder(const std::vector<std::string_view>& patterns, Impl impl)
+    : impl_(std::min(impl, BestImpl())) {
+  for (std::string_view pattern : patterns) {
+    DCHECK(!pattern.empty());
+    patterns_.emplace_back(pattern);
+    const auto first_byte = static_cast<uint8_t>(pattern.front());
+    if (!is_first_byte_[first_byte]) {
+      is_first_byte_[first_byte] = true;
+      first_bytes_.push_back(pattern.front());
+    }
+  }
+  if (first_bytes_.size() > kMaxSIMDFirstBytes) {
+    impl_ = Impl::kScalar;
+  }
+}
+
+bool MultiPatternFinder::MatchesAt(std::string_view buf, size_t pos) const {
+  const std::string_view tail = buf.substr(pos);
+  for (const std::string& pattern : patterns_) {
+    if (pattern.front() == tail.front() && tail.size() >= pattern.size() &&
+        tail.compare(0, pattern.size(), pattern) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+size_t MultiPatternFinder::Find(std::string_view buf, size_t pos) const {
+  [[maybe_unused]] auto matches_at = [this, buf](size_t i) { return MatchesAt(buf, i); };
+  switch (impl_) {
+#if defined(__x86_64__)
+    case Impl::kAVX2: {
+      const size_t match_pos = ScanForwardAVX2(buf, &pos, first_bytes_, matches_at);
+      if (match_pos != kNPos) {
+        return match_pos;
+      }
+      break;
+    }
+    case Impl::kSSE2: {
+      const size_t match_pos = ScanForwardSSE2(buf, &pos, first_bytes_, matches_at);
+      if (match_pos != kNPos) {
+        return match_pos;
+      }
+      break;
+    }
+#endif
+    default:
+      break;
+  }
+  for (; pos < buf.size(); ++pos) {
+    if (is_first_byte_[static_cast<uint8_t>(buf[pos])] && MatchesAt(buf, pos)) {
+      return pos;
+    }
+  }
+  return kNPos;
+}
+
+size_t MultiPatternFinder::RFind(std::string_view buf) const {
+  [[maybe_unused]] auto matches_at = [this, buf](size_t i) { return MatchesAt(buf, i); };
+  size_t end = buf.size();
+  switch (impl_) {
+#if defined(__x86_64__)
+    case Impl::kAVX2: {
+      const size_t match_pos = ScanBackwardAVX2(buf, &end, first_bytes_, matches_at);
+      if (match_pos != kNPos) {
+        return match_pos;
+      }
+      break;
+    }
+    case Impl::kSSE2: {
+      const size_t match_pos = ScanBackwardSSE2(buf, &end, first_bytes_, matches_at);
+      if (match_pos != kNPos) {
+        return match_pos;
+      }
+      break;
+    }
+#endif
+    default:
+      break;
+  }
+  while (end > 0) {
+    --end;
+    if (is_first_byte_[static_cast<uint8_t>(buf[end])] && MatchesAt(buf, end)) {
+      return end;
+    }
+  }
+  return kNPos;
+}
+
+}  // namespace protocols
+}  // namespace stirling
+}  // namespace px
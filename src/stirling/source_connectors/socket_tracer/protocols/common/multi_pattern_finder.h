@@ -0,0 +1,87 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace px {
+namespace stirling {
+namespace protocols {
+
+/**
+ * MultiPatternFinder finds any of a fixed set of patterns in a buffer, in a single pass.
+ *
+ * It uses SIMD to skip over the bytes that cannot start a pattern, 16 or 32 at a time, and only
+ * compares the patterns at the remaining positions. This keeps the frame boundary search of text
+ * protocols cheap when it has to go through a large buffer, e.g. to resynchronize after a gap.
+ */
+class MultiPatternFinder {
+ public:
+  enum class Impl {
+    kScalar,
+    // SSE2 is part of x86-64, so this is available on any x86-64 CPU.
+    kSSE2,
+    kAVX2,
+  };
+
+  // Returns the fastest Impl that the CPU supports.
+  static Impl BestImpl();
+
+  /**
+   * @param patterns The patterns to find. Must not be empty strings.
+   * @param impl The implementation to use, for tests and benchmarks. Falls back to BestImpl() if
+   *             the CPU does not support it.
+   */
+  explicit MultiPatternFinder(const std::vector<std::string_view>& patterns,
+                              Impl impl = BestImpl());
+
+  /**
+   * Returns the position of the first occurrence of any of the patterns in buf, starting the
+   * search at pos, or npos if there is none.
+   */
+  size_t Find(std::string_view buf, size_t pos = 0) const;
+
+  /**
+   * Returns the position of the last occurrence of any of the patterns in buf, or npos if there is
+   * none. Like std::string_view::rfind(), the occurrence must end within buf.
+   */
+  size_t RFind(std::string_view buf) const;
+
+  Impl impl() const { return impl_; }
+
+ private:
+  // SSE2 and AVX2 compare a block against each first byte, so only take that many of them.
+  static constexpr size_t kMaxSIMDFirstBytes = 16;
+
+  bool MatchesAt(std::string_view buf, size_t pos) const;
+
+  std::vector<std::string> patterns_;
+
+  // The distinct first bytes of the patterns, and a lookup table of them for the scalar scan.
+  std::string first_bytes_;
+  bool is_first_byte_[256] = {};
+
+  Impl impl_;
+};
+
+}  // namespace protocols
+}  // namespace stirling
+}  // namespace px
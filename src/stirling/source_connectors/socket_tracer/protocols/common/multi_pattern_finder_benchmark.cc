@@ -0,0 +1,109 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "src/stirling/source_connectors/socket_tracer/protocols/common/multi_pattern_finder.h"
+
+using px::stirling::protocols::MultiPatternFinder;
+
+// The HTTP request start patterns, as searched for by http::FindFrameBoundary().
+const std::vector<std::string_view> kPatterns = {
+    "GET ", "HEAD ", "POST ", "PUT ", "DELETE ", "CONNECT ", "OPTIONS ", "TRACE ", "PATCH ",
+};
+
+// A buffer with none of the patterns, e.g. the body bytes that must be skipped to resynchronize
+// after a gap. One in 64 bytes is a 'P', so that the patterns still need to be compared sometimes.
+std::string NoMatchBuffer(size_t size) {
+  std::default_random_engine rng(37);
+  std::uniform_int_distribution<int> dist(0, 63);
+  std::string buf(size, '\0');
+  for (char& c : buf) {
+    int r = dist(rng);
+    c = r < 26 ? 'a' + r : r == 26 ? 'P' : '0' + r % 10;
+  }
+  return buf;
+}
+
+// The original approach: one std::string_view::find() per pattern.
+// NOLINTNEXTLINE : runtime/references.
+static void BM_PerPatternFind(benchmark::State& state) {
+  std::string buf = NoMatchBuffer(state.range(0));
+  for (auto _ : state) {
+    size_t pos = std::string_view::npos;
+    for (std::string_view pattern : kPatterns) {
+      pos = std::min(pos, std::string_view(buf).find(pattern));
+    }
+    benchmark::DoNotOptimize(pos);
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * buf.size());
+}
+
+template <MultiPatternFinder::Impl TImpl>
+// NOLINTNEXTLINE : runtime/references.
+static void BM_MultiPatternFind(benchmark::State& state) {
+  std::string buf = NoMatchBuffer(state.range(0));
+  MultiPatternFinder finder(kPatterns, TImpl);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(finder.Find(buf));
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * buf.size());
+}
+
+// NOLINTNEXTLINE : runtime/references.
+static void BM_PerPatternRFind(benchmark::State& state) {
+  std::string buf = NoMatchBuffer(state.range(0));
+  for (auto _ : state) {
+    size_t pos = 0;
+    for (std::string_view pattern : kPatterns) {
+      pos = std::max(pos, std::string_view(buf).rfind(pattern) + 1);
+    }
+    benchmark::DoNotOptimize(pos);
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * buf.size());
+}
+
+template <MultiPatternFinder::Impl TImpl>
+// NOLINTNEXTLINE : runtime/references.
+static void BM_MultiPatternRFind(benchmark::State& state) {
+  std::string buf = NoMatchBuffer(state.range(0));
+  MultiPatternFinder finder(kPatterns, TImpl);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(finder.RFind(buf));
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * buf.size());
+}
+
+BENCHMARK(BM_PerPatternFind)->Range(1024, 1024 * 1024);
+BENCHMARK_TEMPLATE(BM_MultiPatternFind, MultiPatternFinder::Impl::kScalar)
+    ->Range(1024, 1024 * 1024);
+BENCHMARK_TEMPLATE(BM_MultiPatternFind, MultiPatternFinder::Impl::kSSE2)->Range(1024, 1024 * 1024);
+BENCHMARK_TEMPLATE(BM_MultiPatternFind, MultiPatternFinder::Impl::kAVX2)->Range(1024, 1024 * 1024);
+
+BENCHMARK(BM_PerPatternRFind)->Range(1024, 1024 * 1024);
+BENCHMARK_TEMPLATE(BM_MultiPatternRFind, MultiPatternFinder::Impl::kScalar)
+    ->Range(1024, 1024 * 1024);
+BENCHMARK_TEMPLATE(BM_MultiPatternRFind, MultiPatternFinder::Impl::kSSE2)
+    ->Range(1024, 1024 * 1024);
+BENCHMARK_TEMPLATE(BM_MultiPatternRFind, MultiPatternFinder::Impl::kAVX2)
+    ->Range(1024, 1024 * 1024);
@@ -0,0 +1,116 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/source_connectors/socket_tracer/protocols/common/multi_pattern_finder.h"
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "src/common/testing/testing.h"
+
+namespace px {
+namespace stirling {
+namespace protocols {
+
+using Impl = MultiPatternFinder::Impl;
+
+constexpr size_t kNPos = std::string_view::npos;
+
+class MultiPatternFinderTest : public ::testing::TestWithParam<Impl> {};
+
+TEST_P(MultiPatternFinderTest, Find) {
+  MultiPatternFinder finder({"GET ", "POST ", "HTTP/1.1 "}, GetParam());
+
+  EXPECT_EQ(finder.Find(""), kNPos);
+  EXPECT_EQ(finder.Find("GET /index.html"), 0);
+  EXPECT_EQ(finder.Find("body bytes, then POST /a and GET /b"), 17);
+  EXPECT_EQ(finder.Find("body bytes, then POST /a and GET /b", 18), 29);
+  EXPECT_EQ(finder.Find("GETPOS GE"), kNPos);
+  // A match that starts in one SIMD block and ends in the next.
+  EXPECT_EQ(finder.Find(std::string(30, 'x') + "HTTP/1.1 200 OK"), 30);
+  EXPECT_EQ(finder.Find(std::string(100, 'H') + "HTTP/1.1 200 OK"), 100);
+}
+
+TEST_P(MultiPatternFinderTest, RFind) {
+  MultiPatternFinder finder({"GET ", "POST ", "HTTP/1.1 "}, GetParam());
+
+  EXPECT_EQ(finder.RFind(""), kNPos);
+  EXPECT_EQ(finder.RFind("GET /index.html"), 0);
+  EXPECT_EQ(finder.RFind("body bytes, then POST /a and GET /b"), 29);
+  // The last occurrence must end within the buffer.
+  EXPECT_EQ(finder.RFind("POST /a GET"), 0);
+  EXPECT_EQ(finder.RFind("HTTP/1.1 200 OK" + std::string(100, 'H')), 0);
+}
+
+// Compares against calling std::string_view::find() and rfind() for every pattern, on random
+// buffers with a small alphabet so that the patterns and their prefixes show up often.
+TEST_P(MultiPatternFinderTest, MatchesPerPatternSearch) {
+  const std::vector<std::string_view> patterns = {"ab", "ba", "abc", "c", "cab"};
+  MultiPatternFinder finder(patterns, GetParam());
+
+  std::default_random_engine rng(37);
+  std::uniform_int_distribution<int> char_dist(0, 7);
+  std::uniform_int_distribution<size_t> size_dist(0, 200);
+
+  for (int i = 0; i < 1000; ++i) {
+    std::string buf(size_dist(rng), '\0');
+    for (char& c : buf) {
+      // Mostly bytes that do not start a pattern, to exercise whole block skips.
+      int r = char_dist(rng);
+      c = r < 3 ? "abc"[r] : 'x';
+    }
+
+    for (size_t pos = 0; pos <= buf.size(); pos += 7) {
+      size_t expected = kNPos;
+      for (std::string_view pattern : patterns) {
+        expected = std::min(expected, std::string_view(buf).find(pattern, pos));
+      }
+      ASSERT_EQ(finder.Find(buf, pos), expected) << buf << " " << pos;
+    }
+
+    size_t expected = kNPos;
+    for (std::string_view pattern : patterns) {
+      size_t rpos = std::string_view(buf).rfind(pattern);
+      if (rpos != kNPos) {
+        expected = expected == kNPos ? rpos : std::max(expected, rpos);
+      }
+    }
+    ASSERT_EQ(finder.RFind(buf), expected) << buf;
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(AllImpls, MultiPatternFinderTest,
+                         ::testing::Values(Impl::kScalar, Impl::kSSE2, Impl::kAVX2));
+
+TEST(MultiPatternFinderImplTest, FallsBackWithTooManyFirstBytes) {
+  std::vector<std::string> pattern_strs;
+  for (char c = 'a'; c <= 'z'; ++c) {
+    pattern_strs.push_back(std::string(1, c) + "!");
+  }
+  std::vector<std::string_view> patterns(pattern_strs.begin(), pattern_strs.end());
+  MultiPatternFinder finder(patterns, Impl::kAVX2);
+
+  EXPECT_EQ(finder.impl(), Impl::kScalar);
+  EXPECT_EQ(finder.Find("xyz abc q! z!"), 8);
+}
+
+}  // namespace protocols
+}  // namespace stirling
+}  // namespace px
@@ -24,6 +24,7 @@
 #include <utility>
 
 #include "src/common/base/byte_utils.h"
+#include "src/stirling/source_connectors/socket_tracer/protocols/common/multi_pattern_finder.h"
 #include "src/stirling/source_connectors/socket_tracer/protocols/mysql/types.h"
 #include "src/stirling/utils/parse_state.h"
 
@@ -85,18 +86,24 @@ size_t FindFrameBoundary(message_type_t type, std::string_view buf, size_t start
     return std::string::npos;
   }
 
+  static const MultiPatternFinder kZeroSequenceID({std::string_view("\0", 1)});
+
   // Need at least kPacketHeaderLength bytes + 1 command byte in buf.
   for (size_t i = start_pos; i < buf.size() - mysql::kPacketHeaderLength; ++i) {
+    // Requests must have sequence id of 0, so skip ahead to the next packet header that has one.
+    size_t sequence_id_pos = kZeroSequenceID.Find(buf, i + mysql::kPayloadLengthLength);
+    if (sequence_id_pos == std::string::npos) {
+      break;
+    }
+    i = sequence_id_pos - mysql::kPayloadLengthLength;
+    if (i >= buf.size() - mysql::kPacketHeaderLength) {
+      break;
+    }
+
     std::string_view cur_buf = buf.substr(i);
     int packet_length = utils::LEndianBytesToInt<int, mysql::kPayloadLengthLength>(cur_buf);
-    uint8_t sequence_id = static_cast<uint8_t>(cur_buf[3]);
     auto command_byte = magic_enum::enum_cast<mysql::Command>(cur_buf[mysql::kPacketHeaderLength]);
 
-    // Requests must have sequence id of 0.
-    if (sequence_id != 0) {
-      continue;
-    }
-
     // If the command byte doesn't decode to a valid command, then this can't a message boundary.
     if (!command_byte.has_value()) {
       continue;
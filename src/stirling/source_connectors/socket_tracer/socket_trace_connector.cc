@@ -168,6 +168,11 @@ DEFINE_uint32(datastream_buffer_retention_size,
 DEFINE_uint64(max_body_bytes, gflags::Uint64FromEnv("PL_STIRLING_MAX_BODY_BYTES", 512),
               "The maximum number of bytes in the body of protocols like HTTP");
 
+DEFINE_uint32(stirling_socket_tracer_threads,
+              gflags::Uint32FromEnv("PL_STIRLING_SOCKET_TRACER_THREADS", 1),
+              "The number of threads that process the connection trackers of the socket tracer. "
+              "Connections are sharded across the threads by PID and FD.");
+
 DEFINE_bool(
     stirling_trace_static_tls_binaries, gflags::BoolFromEnv("PX_TRACE_STATIC_TLS_BINARIES", true),
     "If true, stirling will tls trace binaries statically linked with OpenSSL or BoringSSL");
@@ -186,6 +191,7 @@ DEFINE_uint32(stirling_bpf_chunk_limit, 4,
               "This applies to messages that are over MAX_MSG_SIZE.");
 
 OBJ_STRVIEW(socket_trace_bcc_script, socket_trace);
+OBJ_STRVIEW(socket_trace_ringbuf_bcc_script, socket_trace_ringbuf);
 
 namespace px {
 namespace stirling {
@@ -475,13 +481,24 @@ Status SocketTraceConnector::InitBPF() {
       absl::StrCat("-DBPF_LOOP_LIMIT=", FLAGS_stirling_bpf_loop_limit),
       absl::StrCat("-DBPF_CHUNK_LIMIT=", FLAGS_stirling_bpf_chunk_limit),
   };
-  PX_RETURN_IF_ERROR(bcc_->InitBPFProgram(socket_trace_bcc_script, defines));
+
+  // On kernels with BPF ring buffers, the events go through ring buffers that hold as much as the
+  // perf buffers would. Otherwise, the perf buffers are used.
+  const auto perf_buffer_specs = InitPerfBufferSpecs();
+  std::string_view bcc_script = socket_trace_bcc_script;
+  if (bpf_tools::UseRingBuffers()) {
+    bcc_script = socket_trace_ringbuf_bcc_script;
+    for (auto& cflag : bpf_tools::RingBufferSizeCFlags(perf_buffer_specs)) {
+      defines.push_back(std::move(cflag));
+    }
+    LOG(INFO) << "Using BPF ring buffers for socket tracer events.";
+  }
+  PX_RETURN_IF_ERROR(bcc_->InitBPFProgram(bcc_script, defines));
 
   PX_RETURN_IF_ERROR(bcc_->AttachKProbes(kProbeSpecs));
   LOG(INFO) << absl::Substitute("Number of kprobes deployed = $0", kProbeSpecs.size());
   LOG(INFO) << "Probes successfully deployed.";
 
-  const auto perf_buffer_specs = InitPerfBufferSpecs();
   PX_RETURN_IF_ERROR(bcc_->OpenPerfBuffers(perf_buffer_specs));
   LOG(INFO) << absl::Substitute("Number of perf buffers opened = $0", perf_buffer_specs.size());
 
@@ -551,6 +568,10 @@ Status SocketTraceConnector::InitImpl() {
                    protocol_transfer_specs_[kProtocolHTTP2].enabled,
                    FLAGS_stirling_disable_self_tracing);
 
+  if (FLAGS_stirling_socket_tracer_threads > 1) {
+    transfer_workers_ = std::make_unique<WorkerGroup>(FLAGS_stirling_socket_tracer_threads);
+  }
+
   openssl_trace_state_ = WrappedBCCArrayTable<int>::Create(bcc_.get(), "openssl_trace_state");
   openssl_trace_state_debug_ = WrappedBCCMap<uint32_t, struct openssl_trace_state_debug_t>::Create(
       bcc_.get(), "openssl_trace_state_debug");
@@ -793,14 +814,12 @@ void SocketTraceConnector::TransferDataImpl(ConnectorContext* ctx) {
     }
   }
 
-  for (const auto& conn_tracker : conn_trackers_mgr_.active_trackers()) {
-    const auto& transfer_spec = protocol_transfer_specs_[conn_tracker->protocol()];
-
-    DataTable* data_table = nullptr;
-    if (transfer_spec.enabled) {
-      data_table = data_tables_[transfer_spec.table_num];
-    }
+  const size_t num_shards = transfer_workers_ == nullptr ? 1 : transfer_workers_->num_workers();
+  std::vector<std::vector<ConnTracker*>> shard_trackers(num_shards);
 
+  // Connection inference reads /proc and the socket info cache, which are not thread-safe,
+  // so this part is done for all the trackers before they are handed to the workers.
+  for (const auto& conn_tracker : conn_trackers_mgr_.active_trackers()) {
     UpdateTrackerTraceLevel(conn_tracker);
 
     // Once a known UPID, always a known UPID.
@@ -815,6 +834,66 @@ void SocketTraceConnector::TransferDataImpl(ConnectorContext* ctx) {
     conn_tracker->IterationPreTick(iteration_time_, cluster_cidrs, proc_parser_.get(),
                                    socket_info_mgr_.get());
 
+    shard_trackers[ConnTrackersManager::ShardOf(conn_tracker->conn_id(), num_shards)].push_back(
+        conn_tracker);
+  }
+
+  if (transfer_workers_ == nullptr) {
+    TransferConnTrackers(ctx, shard_trackers[0], data_tables_);
+  } else {
+    // Shard 0 writes to the output tables directly, the other shards write to their own tables,
+    // whose records are moved to the output tables once all the shards are done.
+    if (worker_data_tables_.empty()) {
+      worker_data_tables_.resize(num_shards);
+      for (size_t shard = 1; shard < num_shards; ++shard) {
+        for (size_t i = 0; i < data_tables_.size(); ++i) {
+          std::unique_ptr<DataTable> table;
+          if (data_tables_[i] != nullptr && i != kConnStatsTableNum) {
+            table = std::make_unique<DataTable>(i, table_schemas()[i]);
+          }
+          worker_data_tables_[shard].push_back(std::move(table));
+        }
+      }
+    }
+
+    transfer_workers_->Run([&](size_t shard) {
+      if (shard == 0) {
+        TransferConnTrackers(ctx, shard_trackers[0], data_tables_);
+        return;
+      }
+      std::vector<DataTable*> data_tables;
+      for (const auto& table : worker_data_tables_[shard]) {
+        data_tables.push_back(table.get());
+      }
+      TransferConnTrackers(ctx, shard_trackers[shard], data_tables);
+    });
+
+    for (size_t shard = 1; shard < num_shards; ++shard) {
+      for (size_t i = 0; i < data_tables_.size(); ++i) {
+        if (worker_data_tables_[shard][i] != nullptr) {
+          data_tables_[i]->MoveRecordsFrom(worker_data_tables_[shard][i].get());
+        }
+      }
+    }
+  }
+
+  CheckTracerState();
+
+  // Once we've cleared all the debug trace levels for this pid, we can remove it from the list.
+  pids_to_trace_disable_.clear();
+}
+
+void SocketTraceConnector::TransferConnTrackers(ConnectorContext* ctx,
+                                                const std::vector<ConnTracker*>& conn_trackers,
+                                                const std::vector<DataTable*>& data_tables) {
+  for (ConnTracker* conn_tracker : conn_trackers) {
+    const auto& transfer_spec = protocol_transfer_specs_[conn_tracker->protocol()];
+
+    DataTable* data_table = nullptr;
+    if (transfer_spec.enabled) {
+      data_table = data_tables[transfer_spec.table_num];
+    }
+
     if (transfer_spec.transfer_fn != nullptr) {
       transfer_spec.transfer_fn(*this, ctx, conn_tracker, data_table);
     } else {
@@ -827,11 +906,6 @@ void SocketTraceConnector::TransferDataImpl(ConnectorContext* ctx) {
 
     conn_tracker->IterationPostTick();
   }
-
-  CheckTracerState();
-
-  // Once we've cleared all the debug trace levels for this pid, we can remove it from the list.
-  pids_to_trace_disable_.clear();
 }
 
 Status SocketTraceConnector::UpdateBPFProtocolTraceRole(traffic_protocol_t protocol,
@@ -872,28 +946,32 @@ void SocketTraceConnector::HandleDataEvent(void* cb_cookie, void* data, int data
   auto* connector = static_cast<SocketTraceConnector*>(cb_cookie);
   connector->stats_.Increment(StatKey::kPollSocketDataEventSize, data_size);
 
-  std::unique_ptr<SocketDataEvent> data_event_ptr = std::make_unique<SocketDataEvent>(data);
+  // The events only live for the duration of this callback, since their data is copied into the
+  // data stream buffers. So they are kept on the stack, rather than allocated for every event.
+  SocketDataEvent data_event(data);
 
   // The servers of certain protocols (e.g. Kafka) read the length headers of frames separately
   // from the payload. In these cases, the protocol inference misses the header of the first frame.
   // This header is encoded in the attributes instead.
   // We account for this with a separate header event.
-  std::unique_ptr<SocketDataEvent> header_event_ptr = data_event_ptr->ExtractHeaderEvent();
+  SocketDataEvent header_event;
+  bool has_header_event = data_event.ExtractHeaderEvent(&header_event);
 
   // In some scenarios when we are unable to trace the data (notably including sendfile syscalls),
   // we create a filler event instead. This is important to Kafka, for example,
   // where the sendfile data is in the payload and the protocol parser can still succeed
   // as long as it is properly accounted for.
-  std::unique_ptr<SocketDataEvent> filler_event_ptr = data_event_ptr->ExtractFillerEvent();
+  SocketDataEvent filler_event;
+  bool has_filler_event = data_event.ExtractFillerEvent(&filler_event);
 
-  if (header_event_ptr) {
-    connector->AcceptDataEvent(std::move(header_event_ptr));
+  if (has_header_event) {
+    connector->AcceptDataEvent(header_event);
   }
-  if (data_event_ptr && !data_event_ptr->msg.empty()) {
-    connector->AcceptDataEvent(std::move(data_event_ptr));
+  if (!data_event.msg.empty()) {
+    connector->AcceptDataEvent(data_event);
   }
-  if (filler_event_ptr) {
-    connector->AcceptDataEvent(std::move(filler_event_ptr));
+  if (has_filler_event) {
+    connector->AcceptDataEvent(filler_event);
   }
 }
 
@@ -1048,17 +1126,17 @@ ConnTracker& SocketTraceConnector::GetOrCreateConnTracker(struct conn_id_t conn_
   return tracker;
 }
 
-void SocketTraceConnector::AcceptDataEvent(std::unique_ptr<SocketDataEvent> event) {
+void SocketTraceConnector::AcceptDataEvent(const SocketDataEvent& event) {
   if (perf_buffer_events_output_stream_ != nullptr) {
-    WriteDataEvent(*event);
+    WriteDataEvent(event);
   }
 
   stats_.Increment(StatKey::kPollSocketDataEventCount);
-  stats_.Increment(StatKey::kPollSocketDataEventAttrSize, sizeof(event->attr));
-  stats_.Increment(StatKey::kPollSocketDataEventDataSize, event->msg.size());
+  stats_.Increment(StatKey::kPollSocketDataEventAttrSize, sizeof(event.attr));
+  stats_.Increment(StatKey::kPollSocketDataEventDataSize, event.msg.size());
 
-  ConnTracker& tracker = GetOrCreateConnTracker(event->attr.conn_id);
-  tracker.AddDataEvent(std::move(event));
+  ConnTracker& tracker = GetOrCreateConnTracker(event.attr.conn_id);
+  tracker.AddDataEvent(event);
 }
 
 void SocketTraceConnector::AcceptControlEvent(socket_control_event_t event) {
@@ -50,6 +50,7 @@
 #include "src/stirling/utils/linux_headers.h"
 #include "src/stirling/utils/proc_path_tools.h"
 #include "src/stirling/utils/proc_tracker.h"
+#include "src/stirling/utils/worker_group.h"
 
 DECLARE_uint32(stirling_conn_stats_sampling_ratio);
 DECLARE_bool(stirling_enable_periodic_bpf_map_cleanup);
@@ -78,6 +79,7 @@ DECLARE_uint32(datastream_buffer_expiry_duration_secs);
 DECLARE_uint32(datastream_buffer_retention_size);
 
 DECLARE_uint64(max_body_bytes);
+DECLARE_uint32(stirling_socket_tracer_threads);
 
 namespace px {
 namespace stirling {
@@ -193,7 +195,8 @@ class SocketTraceConnector : public BCCSourceConnector {
   ConnTracker& GetOrCreateConnTracker(struct conn_id_t conn_id);
 
   // Events from BPF.
-  void AcceptDataEvent(std::unique_ptr<SocketDataEvent> event);
+  void AcceptDataEvent(const SocketDataEvent& event);
+  void AcceptDataEvent(std::unique_ptr<SocketDataEvent> event) { AcceptDataEvent(*event); }
   void AcceptControlEvent(socket_control_event_t event);
   void AcceptConnStatsEvent(conn_stats_event_t event);
   void AcceptHTTP2Header(std::unique_ptr<HTTP2HeaderEvent> event);
@@ -212,6 +215,10 @@ class SocketTraceConnector : public BCCSourceConnector {
   template <typename TProtocolTraits>
   void TransferStream(ConnectorContext* ctx, ConnTracker* tracker, DataTable* data_table);
   void TransferConnStats(ConnectorContext* ctx, DataTable* data_table);
+  // Transfers the data of the given trackers to data_tables, which are indexed by table num.
+  // Calls for disjoint sets of trackers and tables can run concurrently.
+  void TransferConnTrackers(ConnectorContext* ctx, const std::vector<ConnTracker*>& conn_trackers,
+                            const std::vector<DataTable*>& data_tables);
 
   void set_iteration_time(std::chrono::time_point<std::chrono::steady_clock> time) {
     DCHECK(time >= iteration_time_);
@@ -295,6 +302,13 @@ class SocketTraceConnector : public BCCSourceConnector {
 
   std::shared_ptr<ConnInfoMapManager> conn_info_map_mgr_;
 
+  // Processes the ConnTrackers of a TransferData() call in shards, one per worker.
+  // Nullptr if the trackers are processed on the calling thread only.
+  std::unique_ptr<WorkerGroup> transfer_workers_;
+
+  // The tables that the shards other than shard 0 write to, indexed by shard and then table num.
+  std::vector<std::vector<std::unique_ptr<DataTable>>> worker_data_tables_;
+
   UProbeManager uprobe_mgr_;
 
   enum class StatKey {
@@ -18,6 +18,8 @@
 
 #include <gflags/gflags.h>
 
+#include <utility>
+
 #include <absl/container/flat_hash_set.h>
 #include <absl/strings/str_split.h>
 #include <benchmark/benchmark.h>
@@ -220,6 +222,17 @@ static void BM_SocketTraceConnector(benchmark::State& state, BenchmarkDataGenera
 #undef MEM_COUNTER
 }
 
+// Same as BM_SocketTraceConnector, but with the LazyContiguousDataStreamBufferImpl, which parses
+// the data of in-order events from the buffer it was first copied to.
+// NOLINTNEXTLINE: runtime/references.
+static void BM_SocketTraceConnectorLazyBuffer(benchmark::State& state,
+                                              BenchmarkDataGenerationSpec spec) {
+  bool always_contiguous_buffer = FLAGS_stirling_data_stream_buffer_always_contiguous_buffer;
+  FLAGS_stirling_data_stream_buffer_always_contiguous_buffer = false;
+  BM_SocketTraceConnector(state, std::move(spec));
+  FLAGS_stirling_data_stream_buffer_always_contiguous_buffer = always_contiguous_buffer;
+}
+
 constexpr uint64_t kRecordSize = 128 * 1024;
 BENCHMARK_CAPTURE(BM_SocketTraceConnector, http1_no_gaps,
                   BenchmarkDataGenerationSpec{
@@ -397,3 +410,64 @@ BENCHMARK_CAPTURE(BM_SocketTraceConnector, http1_intra_iter_gaps,
                           },
                   })
     ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_CAPTURE(BM_SocketTraceConnectorLazyBuffer, http1_no_gaps,
+                  BenchmarkDataGenerationSpec{
+                      .num_conns = 10,
+                      .num_poll_iterations = 1,
+                      .records_per_conn = 16,
+                      .protocol = kProtocolHTTP,
+                      .role = kRoleServer,
+                      .rec_gen_func =
+                          []() { return std::make_unique<HTTP1SingleReqRespGen>(kRecordSize); },
+                      .pos_gen_func = []() { return std::make_unique<NoGapsPosGenerator>(); },
+                  })
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_CAPTURE(BM_SocketTraceConnectorLazyBuffer, mysql_no_gaps,
+                  BenchmarkDataGenerationSpec{
+                      .num_conns = 10,
+                      .num_poll_iterations = 1,
+                      .records_per_conn = 16,
+                      .protocol = kProtocolMySQL,
+                      .role = kRoleServer,
+                      .rec_gen_func =
+                          []() { return std::make_unique<MySQLExecuteReqRespGen>(kRecordSize); },
+                      .pos_gen_func = []() { return std::make_unique<NoGapsPosGenerator>(); },
+                  })
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_CAPTURE(
+    BM_SocketTraceConnectorLazyBuffer, http1_inter_iter_gaps,
+    BenchmarkDataGenerationSpec{
+        .num_conns = 10,
+        .num_poll_iterations = 5,
+        .records_per_conn = 16,
+        .protocol = kProtocolHTTP,
+        .role = kRoleServer,
+        .rec_gen_func =
+            []() { return std::make_unique<HTTP1SingleReqRespGen>(/*body size*/ kRecordSize); },
+        .pos_gen_func =
+            []() {
+              return std::make_unique<IterationGapPosGenerator>(/*gap size*/ 500 * 1024 * 1024);
+            },
+    })
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_CAPTURE(BM_SocketTraceConnectorLazyBuffer, http1_intra_iter_gaps,
+                  BenchmarkDataGenerationSpec{
+                      .num_conns = 10,
+                      .num_poll_iterations = 1,
+                      .records_per_conn = 48,
+                      .protocol = kProtocolHTTP,
+                      .role = kRoleServer,
+                      .rec_gen_func =
+                          []() { return std::make_unique<HTTP1SingleReqRespGen>(kRecordSize); },
+                      .pos_gen_func =
+                          []() {
+                            return std::make_unique<GapPosGenerator>(
+                                /*continuous chunk size*/ 10 * kRecordSize,
+                                /*gap size*/ 5 * 1024 * 1024);
+                          },
+                  })
+    ->Unit(benchmark::kMillisecond);
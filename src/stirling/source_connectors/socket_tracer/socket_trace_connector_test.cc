@@ -18,7 +18,9 @@
 
 #include "src/stirling/source_connectors/socket_tracer/socket_trace_connector.h"
 
+#include <algorithm>
 #include <memory>
+#include <vector>
 
 #include <absl/functional/bind_front.h>
 #include <gmock/gmock.h>
@@ -223,6 +225,62 @@ TEST_F(SocketTraceConnectorTest, Basic) {
   EXPECT_THAT(ToStringVector(records[kHTTPRespBodyIdx]), ElementsAre("foo"));
 }
 
+// Tests that the header and filler events that are extracted from a perf buffer event are added
+// to the data stream, along with the event's own data.
+TEST_F(SocketTraceConnectorTest, HandleDataEventWithHeaderAndFiller) {
+  constexpr std::string_view kPayload = "abcd";
+
+  source_->AcceptControlEvent(event_gen_.InitConn());
+
+  struct socket_data_event_t event = {};
+  event.attr.direction = traffic_direction_t::kEgress;
+  event.attr.protocol = kProtocolHTTP;
+  event.attr.role = kRoleClient;
+  event.attr.timestamp_ns = mock_clock_.now();
+  event.attr.conn_id = {{{kPID}, kPIDStartTimeTicks}, kFD, 1};
+  event.attr.prepend_length_header = true;
+  event.attr.length_header = 8;
+  event.attr.pos = 4;
+  event.attr.msg_size = 8;
+  event.attr.msg_buf_size = kPayload.size();
+  kPayload.copy(event.msg, kPayload.size());
+
+  source_->HandleDataEvent(&event, sizeof(event.attr) + kPayload.size());
+
+  ASSERT_OK_AND_ASSIGN(const ConnTracker* tracker, source_->GetConnTracker(kPID, kFD));
+  // 4 bytes of header, 4 bytes of payload, and 4 bytes of filler.
+  EXPECT_EQ(tracker->send_data().data_buffer().size(), 12U);
+}
+
+// Tests that the records of connections transferred by different threads all end up in the
+// output table, sorted by time.
+TEST_F(SocketTraceConnectorTest, ShardedTransfer) {
+  constexpr int kNumConns = 16;
+  source_->SetTransferThreads(4);
+
+  std::vector<testing::EventGenerator> event_gens;
+  for (int i = 0; i < kNumConns; ++i) {
+    event_gens.emplace_back(&mock_clock_, kPID, kFD + i);
+  }
+  for (auto& event_gen : event_gens) {
+    source_->AcceptControlEvent(event_gen.InitConn());
+  }
+  for (auto& event_gen : event_gens) {
+    source_->AcceptDataEvent(event_gen.InitSendEvent<kProtocolHTTP>(kReq0));
+  }
+  for (auto& event_gen : event_gens) {
+    source_->AcceptDataEvent(event_gen.InitRecvEvent<kProtocolHTTP>(kResp0));
+  }
+
+  connector_->TransferData(ctx_.get());
+
+  std::vector<TaggedRecordBatch> tablets = http_table_->ConsumeRecords();
+  ASSERT_NOT_EMPTY_AND_GET_RECORDS(RecordBatch & records, tablets);
+  ASSERT_THAT(records, RecordBatchSizeIs(kNumConns));
+  std::vector<int64_t> times = ToIntVector<types::Time64NSValue>(records[kHTTPTimeIdx]);
+  EXPECT_TRUE(std::is_sorted(times.begin(), times.end()));
+}
+
 TEST_F(SocketTraceConnectorTest, HTTPDelayedRespBody) {
   struct socket_control_event_t conn = event_gen_.InitConn();
   std::unique_ptr<SocketDataEvent> event0_req = event_gen_.InitSendEvent<kProtocolHTTP>(kReq4);
@@ -69,6 +69,9 @@ class SocketTraceConnectorFriend : public SocketTraceConnector {
   void HandleHTTP2Data(go_grpc_data_event_t* data, int data_size) {
     SocketTraceConnector::HandleHTTP2Event(this, data, data_size);
   }
+  void SetTransferThreads(size_t num_threads) {
+    transfer_workers_ = std::make_unique<WorkerGroup>(num_threads);
+  }
 };
 
 }  // namespace stirling
@@ -0,0 +1,86 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/utils/worker_group.h"
+
+namespace px {
+namespace stirling {
+
+WorkerGroup::WorkerGroup(size_t num_workers) {
+  for (size_t worker_idx = 1; worker_idx < num_workers; ++worker_idx) {
+    threads_.emplace_back(&WorkerGroup::WorkerLoop, this, worker_idx);
+  }
+}
+
+WorkerGroup::~WorkerGroup() {
+  {
+    absl::MutexLock lock(&lock_);
+    stop_ = true;
+  }
+  for (auto& thread : threads_) {
+    thread.join();
+  }
+}
+
+void WorkerGroup::Run(const std::function<void(size_t)>& fn) {
+  {
+    absl::MutexLock lock(&lock_);
+    fn_ = &fn;
+    num_running_ = threads_.size();
+    ++generation_;
+  }
+
+  fn(0);
+
+  absl::MutexLock lock(&lock_);
+  lock_.Await(absl::Condition(
+      +[](size_t* num_running) { return *num_running == 0; }, &num_running_));
+  fn_ = nullptr;
+}
+
+void WorkerGroup::WorkerLoop(size_t worker_idx) {
+  struct Waiter {
+    WorkerGroup* group;
+    uint64_t last_generation;
+  };
+  Waiter waiter{this, 0};
+  while (true) {
+    const std::function<void(size_t)>* fn;
+    {
+      absl::MutexLock lock(&lock_);
+      lock_.Await(absl::Condition(
+          +[](Waiter* w) ABSL_EXCLUSIVE_LOCKS_REQUIRED(w->group->lock_) {
+            return w->group->stop_ || w->group->generation_ != w->last_generation;
+          },
+          &waiter));
+      if (stop_) {
+        return;
+      }
+      waiter.last_generation = generation_;
+      fn = fn_;
+    }
+
+    (*fn)(worker_idx);
+
+    absl::MutexLock lock(&lock_);
+    --num_running_;
+  }
+}
+
+}  // namespace stirling
+}  // namespace px
@@ -0,0 +1,64 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include <absl/base/thread_annotations.h>
+#include <absl/synchronization/mutex.h>
+
+namespace px {
+namespace stirling {
+
+/**
+ * WorkerGroup runs the same function on a fixed number of workers, and waits for all of them to
+ * finish. Worker 0 is the calling thread, the other workers are threads that live as long as the
+ * group, so that a connector can spread the work of every TransferData() call over several cores
+ * without starting threads on every call.
+ */
+class WorkerGroup {
+ public:
+  explicit WorkerGroup(size_t num_workers);
+  ~WorkerGroup();
+
+  size_t num_workers() const { return threads_.size() + 1; }
+
+  /**
+   * Calls fn(worker_idx) for every worker_idx in [0, num_workers()), each on its own worker, and
+   * returns once all of the calls returned.
+   */
+  void Run(const std::function<void(size_t)>& fn);
+
+ private:
+  void WorkerLoop(size_t worker_idx);
+
+  std::vector<std::thread> threads_;
+
+  absl::Mutex lock_;
+  // The function of the current Run() call, and the number of threads still running it.
+  const std::function<void(size_t)>* fn_ ABSL_GUARDED_BY(lock_) = nullptr;
+  uint64_t generation_ ABSL_GUARDED_BY(lock_) = 0;
+  size_t num_running_ ABSL_GUARDED_BY(lock_) = 0;
+  bool stop_ ABSL_GUARDED_BY(lock_) = false;
+};
+
+}  // namespace stirling
+}  // namespace px
@@ -0,0 +1,59 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <thread>
+#include <vector>
+
+#include "src/common/testing/testing.h"
+
+#include "src/stirling/utils/worker_group.h"
+
+namespace px {
+namespace stirling {
+
+TEST(WorkerGroupTest, RunsEveryWorker) {
+  WorkerGroup workers(4);
+  ASSERT_EQ(workers.num_workers(), 4);
+
+  std::vector<int> counts(workers.num_workers(), 0);
+  std::vector<std::thread::id> thread_ids(workers.num_workers());
+  for (int i = 0; i < 3; ++i) {
+    workers.Run([&](size_t worker_idx) {
+      ++counts[worker_idx];
+      thread_ids[worker_idx] = std::this_thread::get_id();
+    });
+  }
+
+  EXPECT_THAT(counts, ::testing::Each(3));
+  // Worker 0 is the calling thread.
+  EXPECT_EQ(thread_ids[0], std::this_thread::get_id());
+  EXPECT_NE(thread_ids[1], std::this_thread::get_id());
+}
+
+TEST(WorkerGroupTest, SingleWorker) {
+  WorkerGroup workers(1);
+  int count = 0;
+  workers.Run([&](size_t worker_idx) {
+    EXPECT_EQ(worker_idx, 0);
+    ++count;
+  });
+  EXPECT_EQ(count, 1);
+}
+
+}  // namespace stirling
+}  // namespace px
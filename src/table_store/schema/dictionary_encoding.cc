@@ -0,0 +1,225 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <arrow/builder.h>
+
+#include <limits>
+#include <memory>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include <absl/container/flat_hash_map.h>
+
+#include "src/shared/types/arrow_adapter.h"
+#include "src/table_store/schema/dictionary_encoding.h"
+
+namespace px {
+namespace table_store {
+namespace schema {
+
+namespace {
+
+int64_t IndexWidthBytes(size_t num_distinct) {
+  if (num_distinct <= static_cast<size_t>(std::numeric_limits<int8_t>::max()) + 1) {
+    return sizeof(int8_t);
+  }
+  if (num_distinct <= static_cast<size_t>(std::numeric_limits<int16_t>::max()) + 1) {
+    return sizeof(int16_t);
+  }
+  return sizeof(int32_t);
+}
+
+template <typename TIndexBuilder>
+StatusOr<std::shared_ptr<arrow::Array>> BuildIndices(const std::vector<int32_t>& codes,
+                                                     arrow::MemoryPool* mem_pool) {
+  using TIndex = typename TIndexBuilder::value_type;
+  TIndexBuilder builder(mem_pool);
+  PX_RETURN_IF_ERROR(builder.Reserve(codes.size()));
+  for (auto code : codes) {
+    builder.UnsafeAppend(static_cast<TIndex>(code));
+  }
+  std::shared_ptr<arrow::Array> out;
+  PX_RETURN_IF_ERROR(builder.Finish(&out));
+  return out;
+}
+
+// Calls fn with the indices of a dictionary array, cast to their concrete arrow array type. The
+// encoder only ever produces int8, int16 or int32 indices.
+template <typename TFn>
+auto VisitIndices(const arrow::Array* arr, TFn fn) {
+  DCHECK(IsDictionaryArray(arr));
+  const auto* indices = static_cast<const arrow::DictionaryArray*>(arr)->indices().get();
+  switch (indices->type_id()) {
+    case arrow::Type::INT8:
+      return fn(static_cast<const arrow::Int8Array*>(indices));
+    case arrow::Type::INT16:
+      return fn(static_cast<const arrow::Int16Array*>(indices));
+    default:
+      DCHECK_EQ(indices->type_id(), arrow::Type::INT32);
+      return fn(static_cast<const arrow::Int32Array*>(indices));
+  }
+}
+
+}  // namespace
+
+int64_t StringArrayBytes(const arrow::Array* arr) {
+  return arr->length() * sizeof(int32_t) +
+         types::GetArrowArrayBytes<types::DataType::STRING>(arr);
+}
+
+int64_t DictionaryArrayBytes(const arrow::Array* arr) {
+  DCHECK(IsDictionaryArray(arr));
+  const auto* dictionary = DictionaryValues(arr);
+  return arr->length() * IndexWidthBytes(dictionary->length()) + StringArrayBytes(dictionary);
+}
+
+StatusOr<std::shared_ptr<arrow::Array>> MaybeDictionaryEncodeStringArray(
+    const arrow::Array* arr, arrow::MemoryPool* mem_pool) {
+  DCHECK_EQ(arr->type_id(), arrow::Type::STRING);
+  auto num_rows = arr->length();
+  if (num_rows < kDictionaryEncodingMinRows) {
+    return std::shared_ptr<arrow::Array>(nullptr);
+  }
+  const auto* str_arr = static_cast<const arrow::StringArray*>(arr);
+  auto plain_bytes = StringArrayBytes(arr);
+
+  absl::flat_hash_map<std::string_view, int32_t> value_to_code;
+  std::vector<std::string_view> dict_values;
+  std::vector<int32_t> codes;
+  codes.reserve(num_rows);
+  int64_t dict_data_bytes = 0;
+  for (int64_t i = 0; i < num_rows; ++i) {
+    auto view = str_arr->GetView(i);
+    std::string_view value(view.data(), view.size());
+    auto [it, inserted] =
+        value_to_code.try_emplace(value, static_cast<int32_t>(dict_values.size()));
+    if (inserted) {
+      dict_values.push_back(value);
+      dict_data_bytes += value.size();
+      // Give up as soon as the dictionary alone is too big for the encoding to pay off.
+      if (4 * (dict_data_bytes + static_cast<int64_t>(dict_values.size()) * sizeof(int32_t)) >
+          3 * plain_bytes) {
+        return std::shared_ptr<arrow::Array>(nullptr);
+      }
+    }
+    codes.push_back(it->second);
+  }
+
+  auto index_width = IndexWidthBytes(dict_values.size());
+  auto encoded_bytes =
+      num_rows * index_width + dict_data_bytes + dict_values.size() * sizeof(int32_t);
+  if (4 * encoded_bytes > 3 * plain_bytes) {
+    return std::shared_ptr<arrow::Array>(nullptr);
+  }
+
+  arrow::StringBuilder dict_builder(mem_pool);
+  PX_RETURN_IF_ERROR(dict_builder.Reserve(dict_values.size()));
+  PX_RETURN_IF_ERROR(dict_builder.ReserveData(dict_data_bytes));
+  for (const auto& value : dict_values) {
+    dict_builder.UnsafeAppend(value.data(), value.size());
+  }
+  std::shared_ptr<arrow::Array> dictionary;
+  PX_RETURN_IF_ERROR(dict_builder.Finish(&dictionary));
+
+  std::shared_ptr<arrow::Array> indices;
+  std::shared_ptr<arrow::DataType> index_type;
+  switch (index_width) {
+    case sizeof(int8_t):
+      PX_ASSIGN_OR_RETURN(indices, BuildIndices<arrow::Int8Builder>(codes, mem_pool));
+      index_type = arrow::int8();
+      break;
+    case sizeof(int16_t):
+      PX_ASSIGN_OR_RETURN(indices, BuildIndices<arrow::Int16Builder>(codes, mem_pool));
+      index_type = arrow::int16();
+      break;
+    default:
+      PX_ASSIGN_OR_RETURN(indices, BuildIndices<arrow::Int32Builder>(codes, mem_pool));
+      index_type = arrow::int32();
+      break;
+  }
+  return std::shared_ptr<arrow::Array>(std::make_shared<arrow::DictionaryArray>(
+      arrow::dictionary(index_type, arrow::utf8()), indices, dictionary));
+}
+
+StatusOr<std::shared_ptr<arrow::Array>> DecodeDictionaryArray(const arrow::Array* arr,
+                                                              arrow::MemoryPool* mem_pool) {
+  const auto* dictionary = DictionaryValues(arr);
+  auto length = arr->length();
+  arrow::StringBuilder builder(mem_pool);
+  PX_RETURN_IF_ERROR(builder.Reserve(length));
+  PX_RETURN_IF_ERROR(VisitIndices(arr, [&](const auto* indices) -> Status {
+    int64_t data_bytes = 0;
+    for (int64_t i = 0; i < length; ++i) {
+      data_bytes += dictionary->value_length(indices->Value(i));
+    }
+    PX_RETURN_IF_ERROR(builder.ReserveData(data_bytes));
+    for (int64_t i = 0; i < length; ++i) {
+      auto value = dictionary->GetView(indices->Value(i));
+      builder.UnsafeAppend(value.data(), value.size());
+    }
+    return Status::OK();
+  }));
+  std::shared_ptr<arrow::Array> out;
+  PX_RETURN_IF_ERROR(builder.Finish(&out));
+  return out;
+}
+
+StatusOr<std::shared_ptr<arrow::Array>> GatherDictionaryArray(const arrow::Array* arr,
+                                                              const std::vector<int64_t>& row_idxs,
+                                                              arrow::MemoryPool* mem_pool) {
+  auto gather_indices = [&](const auto* indices) -> StatusOr<std::shared_ptr<arrow::Array>> {
+    using TIndexArray = std::remove_cv_t<std::remove_pointer_t<decltype(indices)>>;
+    arrow::NumericBuilder<typename TIndexArray::TypeClass> builder(mem_pool);
+    PX_RETURN_IF_ERROR(builder.Reserve(row_idxs.size()));
+    for (int64_t idx : row_idxs) {
+      builder.UnsafeAppend(indices->Value(idx));
+    }
+    std::shared_ptr<arrow::Array> out;
+    PX_RETURN_IF_ERROR(builder.Finish(&out));
+    return out;
+  };
+  PX_ASSIGN_OR_RETURN(auto indices, VisitIndices(arr, gather_indices));
+  const auto* dict_arr = static_cast<const arrow::DictionaryArray*>(arr);
+  return std::shared_ptr<arrow::Array>(
+      std::make_shared<arrow::DictionaryArray>(dict_arr->type(), indices, dict_arr->dictionary()));
+}
+
+void GetDictionaryCodes(const arrow::Array* arr, std::vector<int32_t>* codes) {
+  codes->resize(arr->length());
+  VisitIndices(arr, [&](const auto* indices) {
+    for (int64_t i = 0; i < arr->length(); ++i) {
+      (*codes)[i] = indices->Value(i);
+    }
+  });
+}
+
+int32_t FindDictionaryCode(const arrow::Array* arr, std::string_view value) {
+  const auto* dictionary = DictionaryValues(arr);
+  for (int64_t code = 0; code < dictionary->length(); ++code) {
+    auto view = dictionary->GetView(code);
+    if (std::string_view(view.data(), view.size()) == value) {
+      return static_cast<int32_t>(code);
+    }
+  }
+  return -1;
+}
+
+}  // namespace schema
+}  // namespace table_store
+}  // namespace px
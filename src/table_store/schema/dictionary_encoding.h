@@ -0,0 +1,116 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <arrow/array.h>
+#include <arrow/memory_pool.h>
+
+#include <memory>
+#include <string_view>
+#include <vector>
+
+#include "src/common/base/base.h"
+
+namespace px {
+namespace table_store {
+namespace schema {
+
+// String columns with fewer rows than this are never dictionary encoded, the dictionary overhead
+// isn't worth it for such small batches.
+constexpr int64_t kDictionaryEncodingMinRows = 64;
+
+/**
+ * @return whether the array is a dictionary encoded string column, ie. an arrow::DictionaryArray
+ * of strings with int8, int16 or int32 indices. RowBatch allows these for STRING columns.
+ */
+inline bool IsDictionaryArray(const arrow::Array* arr) {
+  return arr->type_id() == arrow::Type::DICTIONARY;
+}
+
+/**
+ * StringArrayBytes returns the number of bytes a plain arrow::StringArray uses, as counted by the
+ * table store (a 4-byte offset per row, plus the string data).
+ */
+int64_t StringArrayBytes(const arrow::Array* arr);
+
+/**
+ * DictionaryArrayBytes returns the number of bytes a dictionary encoded string column uses, as
+ * counted by the table store (the indices plus the bytes of the string dictionary).
+ */
+int64_t DictionaryArrayBytes(const arrow::Array* arr);
+
+/**
+ * MaybeDictionaryEncodeStringArray converts the given arrow::StringArray into an
+ * arrow::DictionaryArray of strings, if doing so reduces the size of the column by at least a
+ * quarter. The indices use the narrowest integer type that can hold the number of distinct values.
+ * @param arr, the string array to encode.
+ * @param mem_pool, the memory pool to allocate the encoded array from.
+ * @return the DictionaryArray, or nullptr if the column is not worth encoding.
+ */
+StatusOr<std::shared_ptr<arrow::Array>> MaybeDictionaryEncodeStringArray(
+    const arrow::Array* arr, arrow::MemoryPool* mem_pool);
+
+/**
+ * DecodeDictionaryArray converts a (possibly sliced) dictionary encoded string column back into a
+ * plain arrow::StringArray.
+ * @param arr, the arrow::DictionaryArray to decode.
+ * @param mem_pool, the memory pool to allocate the decoded array from.
+ * @return the decoded arrow::StringArray.
+ */
+StatusOr<std::shared_ptr<arrow::Array>> DecodeDictionaryArray(const arrow::Array* arr,
+                                                              arrow::MemoryPool* mem_pool);
+
+/**
+ * GatherDictionaryArray copies the indices of the given rows of a dictionary encoded string column
+ * into a new arrow::DictionaryArray, which shares the dictionary of the input.
+ * @param arr, the arrow::DictionaryArray to gather from.
+ * @param row_idxs, the rows to gather.
+ * @param mem_pool, the memory pool to allocate the new indices from.
+ * @return the gathered arrow::DictionaryArray.
+ */
+StatusOr<std::shared_ptr<arrow::Array>> GatherDictionaryArray(const arrow::Array* arr,
+                                                              const std::vector<int64_t>& row_idxs,
+                                                              arrow::MemoryPool* mem_pool);
+
+/**
+ * GetDictionaryCodes widens the indices of a dictionary encoded string column to int32.
+ * @param arr, the arrow::DictionaryArray to read the indices of.
+ * @param codes, output, resized to the length of arr, holds the index of every row.
+ */
+void GetDictionaryCodes(const arrow::Array* arr, std::vector<int32_t>* codes);
+
+/**
+ * @return the dictionary of a dictionary encoded string column, as an arrow::StringArray.
+ */
+inline const arrow::StringArray* DictionaryValues(const arrow::Array* arr) {
+  DCHECK(IsDictionaryArray(arr));
+  return static_cast<const arrow::StringArray*>(
+      static_cast<const arrow::DictionaryArray*>(arr)->dictionary().get());
+}
+
+/**
+ * FindDictionaryCode looks up a string in the dictionary of a dictionary encoded string column.
+ * @return the index of the value in the dictionary, or -1 if the dictionary doesn't hold it (in
+ * which case no row of the column has that value).
+ */
+int32_t FindDictionaryCode(const arrow::Array* arr, std::string_view value);
+
+}  // namespace schema
+}  // namespace table_store
+}  // namespace px
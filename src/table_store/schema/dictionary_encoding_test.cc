@@ -0,0 +1,146 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string>
+#include <vector>
+
+#include <absl/strings/str_cat.h>
+
+#include "src/common/testing/testing.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/table_store/schema/dictionary_encoding.h"
+
+namespace px {
+namespace table_store {
+namespace schema {
+
+namespace {
+
+std::vector<types::StringValue> LowCardinalityStrings(size_t num_rows, size_t num_distinct) {
+  std::vector<types::StringValue> vals;
+  for (size_t i = 0; i < num_rows; ++i) {
+    vals.push_back(absl::StrCat("service/endpoint-", i % num_distinct));
+  }
+  return vals;
+}
+
+}  // namespace
+
+TEST(DictionaryEncodingTest, EncodeAndDecode) {
+  auto vals = LowCardinalityStrings(1000, 5);
+  auto arr = types::ToArrow(vals, arrow::default_memory_pool());
+
+  ASSERT_OK_AND_ASSIGN(auto encoded,
+                       MaybeDictionaryEncodeStringArray(arr.get(), arrow::default_memory_pool()));
+  ASSERT_NE(nullptr, encoded);
+  ASSERT_EQ(arrow::Type::DICTIONARY, encoded->type_id());
+  EXPECT_EQ(1000, encoded->length());
+
+  const auto* dict_arr = static_cast<const arrow::DictionaryArray*>(encoded.get());
+  EXPECT_EQ(5, dict_arr->dictionary()->length());
+  EXPECT_EQ(arrow::Type::INT8, dict_arr->indices()->type_id());
+  EXPECT_LT(DictionaryArrayBytes(encoded.get()), StringArrayBytes(arr.get()));
+
+  ASSERT_OK_AND_ASSIGN(auto decoded,
+                       DecodeDictionaryArray(encoded.get(), arrow::default_memory_pool()));
+  EXPECT_TRUE(decoded->Equals(arr));
+}
+
+TEST(DictionaryEncodingTest, DecodeSlice) {
+  auto vals = LowCardinalityStrings(200, 3);
+  auto arr = types::ToArrow(vals, arrow::default_memory_pool());
+
+  ASSERT_OK_AND_ASSIGN(auto encoded,
+                       MaybeDictionaryEncodeStringArray(arr.get(), arrow::default_memory_pool()));
+  ASSERT_NE(nullptr, encoded);
+
+  ASSERT_OK_AND_ASSIGN(auto decoded, DecodeDictionaryArray(encoded->Slice(17, 50).get(),
+                                                           arrow::default_memory_pool()));
+  EXPECT_TRUE(decoded->Equals(arr->Slice(17, 50)));
+}
+
+TEST(DictionaryEncodingTest, WideIndices) {
+  auto vals = LowCardinalityStrings(2000, 300);
+  auto arr = types::ToArrow(vals, arrow::default_memory_pool());
+
+  ASSERT_OK_AND_ASSIGN(auto encoded,
+                       MaybeDictionaryEncodeStringArray(arr.get(), arrow::default_memory_pool()));
+  ASSERT_NE(nullptr, encoded);
+  const auto* dict_arr = static_cast<const arrow::DictionaryArray*>(encoded.get());
+  EXPECT_EQ(arrow::Type::INT16, dict_arr->indices()->type_id());
+
+  ASSERT_OK_AND_ASSIGN(auto decoded,
+                       DecodeDictionaryArray(encoded.get(), arrow::default_memory_pool()));
+  EXPECT_TRUE(decoded->Equals(arr));
+}
+
+TEST(DictionaryEncodingTest, GatherSharesDictionary) {
+  auto vals = LowCardinalityStrings(200, 3);
+  auto arr = types::ToArrow(vals, arrow::default_memory_pool());
+  ASSERT_OK_AND_ASSIGN(auto encoded,
+                       MaybeDictionaryEncodeStringArray(arr.get(), arrow::default_memory_pool()));
+  ASSERT_NE(nullptr, encoded);
+
+  auto sliced = encoded->Slice(10, 100);
+  ASSERT_OK_AND_ASSIGN(auto gathered, GatherDictionaryArray(sliced.get(), {0, 4, 50, 99},
+                                                            arrow::default_memory_pool()));
+  ASSERT_TRUE(IsDictionaryArray(gathered.get()));
+  EXPECT_EQ(DictionaryValues(encoded.get()), DictionaryValues(gathered.get()));
+  ASSERT_OK_AND_ASSIGN(auto decoded,
+                       DecodeDictionaryArray(gathered.get(), arrow::default_memory_pool()));
+  EXPECT_TRUE(decoded->Equals(types::ToArrow(
+      std::vector<types::StringValue>{vals[10], vals[14], vals[60], vals[109]},
+      arrow::default_memory_pool())));
+}
+
+TEST(DictionaryEncodingTest, CodesOfSlice) {
+  auto vals = LowCardinalityStrings(200, 3);
+  auto arr = types::ToArrow(vals, arrow::default_memory_pool());
+  ASSERT_OK_AND_ASSIGN(auto encoded,
+                       MaybeDictionaryEncodeStringArray(arr.get(), arrow::default_memory_pool()));
+  ASSERT_NE(nullptr, encoded);
+
+  auto sliced = encoded->Slice(1, 5);
+  std::vector<int32_t> codes;
+  GetDictionaryCodes(sliced.get(), &codes);
+  // Codes are assigned in order of first appearance.
+  EXPECT_THAT(codes, ::testing::ElementsAre(1, 2, 0, 1, 2));
+
+  EXPECT_EQ(2, FindDictionaryCode(sliced.get(), "service/endpoint-2"));
+  EXPECT_EQ(-1, FindDictionaryCode(sliced.get(), "service/endpoint-3"));
+}
+
+TEST(DictionaryEncodingTest, SkipsHighCardinality) {
+  auto vals = LowCardinalityStrings(500, 500);
+  auto arr = types::ToArrow(vals, arrow::default_memory_pool());
+  ASSERT_OK_AND_ASSIGN(auto encoded,
+                       MaybeDictionaryEncodeStringArray(arr.get(), arrow::default_memory_pool()));
+  EXPECT_EQ(nullptr, encoded);
+}
+
+TEST(DictionaryEncodingTest, SkipsSmallArrays) {
+  auto vals = LowCardinalityStrings(kDictionaryEncodingMinRows - 1, 1);
+  auto arr = types::ToArrow(vals, arrow::default_memory_pool());
+  ASSERT_OK_AND_ASSIGN(auto encoded,
+                       MaybeDictionaryEncodeStringArray(arr.get(), arrow::default_memory_pool()));
+  EXPECT_EQ(nullptr, encoded);
+}
+
+}  // namespace schema
+}  // namespace table_store
+}  // namespace px
@@ -17,15 +17,23 @@
  */
 
 #include <arrow/array.h>
+#include <arrow/buffer.h>
 #include <algorithm>
+#include <cstring>
+#include <limits>
 #include <memory>
+#include <numeric>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <absl/strings/str_format.h>
+#include <absl/strings/str_join.h>
 #include "src/common/base/base.h"
+#include "src/common/zlib/zlib_wrapper.h"
 #include "src/shared/types/arrow_adapter.h"
 #include "src/shared/types/type_utils.h"
+#include "src/table_store/schema/dictionary_encoding.h"
 #include "src/table_store/schema/row_batch.h"
 
 namespace px {
@@ -43,7 +51,14 @@ Status RowBatch::AddColumn(const std::shared_ptr<arrow::Array>& col) {
   if (col->length() != num_rows_) {
     return error::InvalidArgument("Schema only allows $0 rows, got $1", num_rows_, col->length());
   }
-  if (col->type_id() != types::ToArrowType(desc_.type(columns_.size()))) {
+  auto type = desc_.type(columns_.size());
+  if (type == DataType::STRING && IsDictionaryArray(col.get())) {
+    const auto& dict_type = static_cast<const arrow::DictionaryType&>(*col->type());
+    if (dict_type.value_type()->id() != arrow::Type::STRING) {
+      return error::InvalidArgument("Column[$0] was given a dictionary of the incorrect type",
+                                    columns_.size());
+    }
+  } else if (col->type_id() != types::ToArrowType(type)) {
     return error::InvalidArgument("Column[$0] was given incorrect type", columns_.size());
   }
 
@@ -53,11 +68,125 @@ Status RowBatch::AddColumn(const std::shared_ptr<arrow::Array>& col) {
 
 bool RowBatch::HasColumn(int64_t i) const { return columns_.size() > static_cast<size_t>(i); }
 
+Status RowBatch::SetSelection(std::shared_ptr<const SelectionVector> selection) {
+  DCHECK(selection != nullptr);
+  if (!selection->empty() && (selection->front() < 0 || selection->back() >= num_rows_)) {
+    return error::InvalidArgument("Selection is out of bounds of the $0 rows of the row batch",
+                                  num_rows_);
+  }
+  DCHECK(std::is_sorted(selection->begin(), selection->end()));
+  selection_ = std::move(selection);
+  return Status::OK();
+}
+
+RowBatch RowBatch::WithoutSelection() const {
+  RowBatch output_rb = *this;
+  output_rb.selection_ = nullptr;
+  return output_rb;
+}
+
+template <DataType T>
+Status GatherValues(const arrow::Array* input_col, const RowBatch::SelectionVector& selection,
+                    arrow::MemoryPool* mem_pool, std::shared_ptr<arrow::Array>* output_col) {
+  auto builder_generic = types::MakeArrowBuilder(T, mem_pool);
+  auto* builder =
+      static_cast<typename types::DataTypeTraits<T>::arrow_builder_type*>(builder_generic.get());
+  PX_RETURN_IF_ERROR(builder->Reserve(selection.size()));
+  if constexpr (T == DataType::STRING) {
+    int64_t total_size = 0;
+    for (int64_t idx : selection) {
+      total_size += types::GetStringViewFromArrowArray(input_col, idx).size();
+    }
+    PX_RETURN_IF_ERROR(builder->ReserveData(total_size));
+  }
+  for (int64_t idx : selection) {
+    builder->UnsafeAppend(types::GetValueFromArrowArray<T>(input_col, idx));
+  }
+  PX_RETURN_IF_ERROR(builder->Finish(output_col));
+  return Status::OK();
+}
+
+StatusOr<std::shared_ptr<arrow::Array>> RowBatch::MaterializeColumn(
+    int64_t i, arrow::MemoryPool* mem_pool) const {
+  if (selection_ == nullptr) {
+    return columns_[i];
+  }
+  if (IsDictionaryArray(columns_[i].get())) {
+    // Only the codes are copied, the dictionary is shared with the input.
+    return GatherDictionaryArray(columns_[i].get(), *selection_, mem_pool);
+  }
+  std::shared_ptr<arrow::Array> output_col;
+#define TYPE_CASE(_dt_) \
+  PX_RETURN_IF_ERROR(GatherValues<_dt_>(columns_[i].get(), *selection_, mem_pool, &output_col));
+  PX_SWITCH_FOREACH_DATATYPE(desc_.type(i), TYPE_CASE);
+#undef TYPE_CASE
+  return output_col;
+}
+
+StatusOr<std::unique_ptr<RowBatch>> RowBatch::Materialize(arrow::MemoryPool* mem_pool) const {
+  auto output_rb = std::make_unique<RowBatch>(desc_, num_rows());
+  output_rb->set_eow(eow_);
+  output_rb->set_eos(eos_);
+  for (int64_t i = 0; i < static_cast<int64_t>(columns_.size()); ++i) {
+    PX_ASSIGN_OR_RETURN(auto col, MaterializeColumn(i, mem_pool));
+    PX_RETURN_IF_ERROR(output_rb->AddColumn(col));
+  }
+  return output_rb;
+}
+
+StatusOr<std::unique_ptr<RowBatch>> RowBatch::MaterializeColumns(
+    const std::vector<int64_t>& col_idxs, arrow::MemoryPool* mem_pool) const {
+  std::vector<bool> materialize(columns_.size(), false);
+  for (int64_t i : col_idxs) {
+    materialize[i] = true;
+  }
+  auto output_rb = std::make_unique<RowBatch>(desc_, num_rows());
+  output_rb->set_eow(eow_);
+  output_rb->set_eos(eos_);
+  for (int64_t i = 0; i < static_cast<int64_t>(columns_.size()); ++i) {
+    if (!materialize[i]) {
+      // The column isn't read, so a zero-copy slice of the right length stands in for it.
+      PX_RETURN_IF_ERROR(output_rb->AddColumn(columns_[i]->Slice(0, num_rows())));
+      continue;
+    }
+    PX_ASSIGN_OR_RETURN(auto col, MaterializeColumn(i, mem_pool));
+    PX_RETURN_IF_ERROR(output_rb->AddColumn(col));
+  }
+  return output_rb;
+}
+
+bool RowBatch::HasDictionaryColumns() const {
+  return std::any_of(columns_.begin(), columns_.end(),
+                     [](const auto& col) { return IsDictionaryArray(col.get()); });
+}
+
+StatusOr<std::unique_ptr<RowBatch>> RowBatch::DecodeDictionaryColumns(
+    const std::vector<int64_t>& col_idxs, arrow::MemoryPool* mem_pool) const {
+  auto output_rb = std::make_unique<RowBatch>(*this);
+  for (int64_t i : col_idxs) {
+    auto& col = output_rb->columns_[i];
+    if (IsDictionaryArray(col.get())) {
+      PX_ASSIGN_OR_RETURN(col, DecodeDictionaryArray(col.get(), mem_pool));
+    }
+  }
+  return output_rb;
+}
+
+StatusOr<std::unique_ptr<RowBatch>> RowBatch::DecodeDictionaryColumns(
+    arrow::MemoryPool* mem_pool) const {
+  std::vector<int64_t> col_idxs(columns_.size());
+  std::iota(col_idxs.begin(), col_idxs.end(), 0);
+  return DecodeDictionaryColumns(col_idxs, mem_pool);
+}
+
 std::string RowBatch::DebugString() const {
   if (columns_.empty()) {
     return "RowBatch: <empty>";
   }
   std::string debug_string = absl::StrFormat("RowBatch(eow=%d, eos=%d):\n", eow_, eos_);
+  if (selection_ != nullptr) {
+    debug_string += absl::StrFormat("  selection: [%s]\n", absl::StrJoin(*selection_, ", "));
+  }
   for (const auto& col : columns_) {
     debug_string += absl::StrFormat("  %s\n", col->ToString());
   }
@@ -71,10 +200,18 @@ int64_t RowBatch::NumBytes() const {
 
   int64_t total_bytes = 0;
   for (auto col : columns_) {
+    if (IsDictionaryArray(col.get())) {
+      total_bytes += DictionaryArrayBytes(col.get());
+      continue;
+    }
 #define TYPE_CASE(_dt_) total_bytes += types::GetArrowArrayBytes<_dt_>(col.get());
     PX_SWITCH_FOREACH_DATATYPE(types::ArrowToDataType(col->type_id()), TYPE_CASE);
 #undef TYPE_CASE
   }
+  if (selection_ != nullptr) {
+    // Estimate the bytes of the selected rows, assuming that rows are of similar size.
+    total_bytes = total_bytes * num_rows() / num_rows_;
+  }
   return total_bytes;
 }
 
@@ -120,13 +257,15 @@ constexpr const auto& GetPBDataColumn(const table_store::schemapb::Column& data_
 }
 
 template <DataType T>
-void CopyIntoOutputPB(table_store::schemapb::Column* output_column, arrow::Array* input_column) {
+void CopyIntoOutputPB(table_store::schemapb::Column* output_column, arrow::Array* input_column,
+                      const RowBatch::SelectionVector* selection) {
   CHECK_NOTNULL(input_column);
   CHECK_NOTNULL(output_column);
 
-  size_t col_length = input_column->length();
+  size_t col_length = selection == nullptr ? input_column->length() : selection->size();
   auto casted_output_data = GetMutablePBDataColumn<T>(output_column);
-  for (size_t i = 0; i < col_length; ++i) {
+  for (size_t row_idx = 0; row_idx < col_length; ++row_idx) {
+    size_t i = selection == nullptr ? row_idx : (*selection)[row_idx];
     if constexpr (T == DataType::UINT128) {
       auto out_datum = casted_output_data->add_data();
       auto val = types::GetValueFromArrowArray<DataType::UINT128>(input_column, i);
@@ -159,7 +298,7 @@ Status CopyFromInputPB(std::shared_ptr<arrow::Array>* output_column,
 }
 
 Status RowBatch::ToProto(table_store::schemapb::RowBatchData* proto) const {
-  proto->set_num_rows(num_rows_);
+  proto->set_num_rows(num_rows());
   proto->set_eow(eow_);
   proto->set_eos(eos_);
 
@@ -168,14 +307,294 @@ Status RowBatch::ToProto(table_store::schemapb::RowBatchData* proto) const {
     auto output_col_data = proto->add_cols();
     auto dt = desc_.type(col_idx);
 
-#define TYPE_CASE(_dt_) CopyIntoOutputPB<_dt_>(output_col_data, input_col);
+#define TYPE_CASE(_dt_) CopyIntoOutputPB<_dt_>(output_col_data, input_col, selection_.get());
+    PX_SWITCH_FOREACH_DATATYPE(dt, TYPE_CASE);
+#undef TYPE_CASE
+  }
+
+  return Status::OK();
+}
+
+// Columnar encoding, see schemapb::EncodedColumns.
+
+namespace {
+
+constexpr int64_t kEncodedBufferAlignment = 16;
+// The largest uncompressed size accepted from a peer, so that a corrupt or malicious row batch can't
+// make us allocate an arbitrary amount of memory. Row batches sent between Carnot instances are far
+// smaller.
+constexpr int64_t kMaxUncompressedSize = 256 * 1024 * 1024;
+
+int64_t PaddedSize(int64_t size) {
+  return (size + kEncodedBufferAlignment - 1) / kEncodedBufferAlignment * kEncodedBufferAlignment;
+}
+
+// Appends a zeroed buffer of the given size (plus padding) to out, and returns a pointer to it.
+uint8_t* AppendBuffer(int64_t size, std::string* out) {
+  size_t pos = out->size();
+  out->resize(pos + PaddedSize(size));
+  return reinterpret_cast<uint8_t*>(out->data() + pos);
+}
+
+/**
+ * StringBuffer is an arrow::Buffer that points into a string, and keeps the string alive.
+ */
+class StringBuffer : public arrow::Buffer {
+ public:
+  StringBuffer(std::shared_ptr<const std::string> str, int64_t offset, int64_t size)
+      : arrow::Buffer(reinterpret_cast<const uint8_t*>(str->data()) + offset, size),
+        str_(std::move(str)) {}
+
+ private:
+  std::shared_ptr<const std::string> str_;
+};
+
+// Returns the number of bytes of data after pos.
+int64_t RemainingBytes(const std::shared_ptr<const std::string>& data, int64_t pos) {
+  return std::max<int64_t>(0, static_cast<int64_t>(data->size()) - pos);
+}
+
+// Returns the next buffer of the given size, and advances pos past it.
+StatusOr<std::shared_ptr<arrow::Buffer>> NextBuffer(const std::shared_ptr<const std::string>& data,
+                                                    int64_t size, int64_t* pos) {
+  if (size < 0 || size > RemainingBytes(data, *pos)) {
+    return error::InvalidArgument("Encoded columns are truncated");
+  }
+  auto buffer = std::make_shared<StringBuffer>(data, *pos, size);
+  *pos += PaddedSize(size);
+  return std::static_pointer_cast<arrow::Buffer>(buffer);
+}
+
+template <DataType T>
+Status EncodeColumn(const arrow::Array* input_col, const RowBatch::SelectionVector* selection,
+                    int64_t num_rows, std::string* out) {
+  if constexpr (T == DataType::BOOLEAN) {
+    uint8_t* bits = AppendBuffer((num_rows + 7) / 8, out);
+    for (int64_t i = 0; i < num_rows; ++i) {
+      int64_t idx = selection == nullptr ? i : (*selection)[i];
+      if (types::GetValueFromArrowArray<T>(input_col, idx)) {
+        bits[i / 8] |= static_cast<uint8_t>(1 << (i % 8));
+      }
+    }
+  } else if constexpr (T == DataType::STRING) {
+    size_t offsets_pos = out->size();
+    AppendBuffer((num_rows + 1) * sizeof(int32_t), out);
+    size_t data_pos = out->size();
+    // The offsets are written through out->data() every time, since appending the string data
+    // can reallocate out.
+    auto set_offset = [&](int64_t i, int64_t offset) {
+      int32_t value = offset;
+      std::memcpy(out->data() + offsets_pos + i * sizeof(int32_t), &value, sizeof(value));
+    };
+    const auto* str_col = static_cast<const arrow::StringArray*>(input_col);
+    if (selection == nullptr && num_rows > 0) {
+      const int32_t* offsets = str_col->raw_value_offsets();
+      for (int64_t i = 1; i <= num_rows; ++i) {
+        set_offset(i, offsets[i] - offsets[0]);
+      }
+      out->append(reinterpret_cast<const char*>(str_col->value_data()->data()) + offsets[0],
+                  offsets[num_rows] - offsets[0]);
+    } else if (selection != nullptr) {
+      int64_t offset = 0;
+      for (int64_t i = 0; i < num_rows; ++i) {
+        auto value = types::GetStringViewFromArrowArray(input_col, (*selection)[i]);
+        out->append(value.data(), value.size());
+        offset += value.size();
+        if (offset > std::numeric_limits<int32_t>::max()) {
+          return error::ResourceUnavailable("String column is too large to encode");
+        }
+        set_offset(i + 1, offset);
+      }
+    }
+    out->resize(data_pos + PaddedSize(out->size() - data_pos));
+  } else {
+    constexpr int64_t kWidth = sizeof(typename types::DataTypeTraits<T>::native_type);
+    uint8_t* output_values = AppendBuffer(num_rows * kWidth, out);
+    if (num_rows == 0) {
+      return Status::OK();
+    }
+    const uint8_t* values = input_col->data()->buffers[1]->data() + input_col->offset() * kWidth;
+    if (selection == nullptr) {
+      std::memcpy(output_values, values, num_rows * kWidth);
+    } else {
+      for (int64_t i = 0; i < num_rows; ++i) {
+        std::memcpy(output_values + i * kWidth, values + (*selection)[i] * kWidth, kWidth);
+      }
+    }
+  }
+  return Status::OK();
+}
+
+template <DataType T>
+Status DecodeColumn(const std::shared_ptr<const std::string>& data, int64_t num_rows, int64_t* pos,
+                    std::shared_ptr<arrow::Array>* output_col) {
+  auto type = types::MakeArrowBuilder(T, arrow::default_memory_pool())->type();
+  std::vector<std::shared_ptr<arrow::Buffer>> buffers = {nullptr};
+  // num_rows comes from the peer, so it's checked against the remaining bytes before computing
+  // buffer sizes from it, which could otherwise overflow.
+  int64_t remaining = RemainingBytes(data, *pos);
+  if constexpr (T == DataType::BOOLEAN) {
+    if (num_rows / 8 > remaining) {
+      return error::InvalidArgument("Encoded columns are truncated");
+    }
+    PX_ASSIGN_OR_RETURN(auto bits, NextBuffer(data, (num_rows + 7) / 8, pos));
+    buffers.push_back(std::move(bits));
+  } else if constexpr (T == DataType::STRING) {
+    if (num_rows >= remaining / static_cast<int64_t>(sizeof(int32_t))) {
+      return error::InvalidArgument("Encoded columns are truncated");
+    }
+    PX_ASSIGN_OR_RETURN(auto offsets, NextBuffer(data, (num_rows + 1) * sizeof(int32_t), pos));
+    const auto* raw_offsets = reinterpret_cast<const int32_t*>(offsets->data());
+    // The offsets must start at 0 and never decrease. The last one is checked against the size of
+    // the data by NextBuffer.
+    if (raw_offsets[0] != 0) {
+      return error::InvalidArgument("Encoded string column has invalid offsets");
+    }
+    for (int64_t i = 0; i < num_rows; ++i) {
+      if (raw_offsets[i + 1] < raw_offsets[i]) {
+        return error::InvalidArgument("Encoded string column has invalid offsets");
+      }
+    }
+    PX_ASSIGN_OR_RETURN(auto values, NextBuffer(data, raw_offsets[num_rows], pos));
+    buffers.push_back(std::move(offsets));
+    buffers.push_back(std::move(values));
+  } else {
+    constexpr int64_t kWidth = sizeof(typename types::DataTypeTraits<T>::native_type);
+    if (num_rows > remaining / kWidth) {
+      return error::InvalidArgument("Encoded columns are truncated");
+    }
+    PX_ASSIGN_OR_RETURN(auto values, NextBuffer(data, num_rows * kWidth, pos));
+    buffers.push_back(std::move(values));
+  }
+  auto array_data = arrow::ArrayData::Make(type, num_rows, std::move(buffers), /*null_count*/ 0);
+  *output_col = arrow::MakeArray(array_data);
+  return Status::OK();
+}
+
+// PX_CARNOT_UPDATE_FOR_NEW_TYPES
+bool IsEncodableType(DataType dt) {
+  switch (dt) {
+    case DataType::BOOLEAN:
+    case DataType::INT64:
+    case DataType::UINT128:
+    case DataType::TIME64NS:
+    case DataType::FLOAT64:
+    case DataType::STRING:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Decodes the columns of an encoded row batch, taking ownership of the (possibly compressed)
+// buffers.
+StatusOr<std::unique_ptr<RowBatch>> DecodeRowBatch(
+    const table_store::schemapb::RowBatchData& proto, std::string buffers) {
+  const auto& encoded_cols = proto.encoded_cols();
+  if (proto.num_rows() < 0) {
+    return error::InvalidArgument("Encoded row batch has $0 rows", proto.num_rows());
+  }
+  std::shared_ptr<const std::string> data;
+  switch (encoded_cols.compression()) {
+    case table_store::schemapb::EncodedColumns::NONE:
+      data = std::make_shared<const std::string>(std::move(buffers));
+      break;
+    case table_store::schemapb::EncodedColumns::ZLIB: {
+      // The uncompressed size comes from the peer, so it's bounded before it's used to size the
+      // output, and inflating stops as soon as the output grows past it.
+      if (encoded_cols.uncompressed_size() < 0 ||
+          encoded_cols.uncompressed_size() > kMaxUncompressedSize) {
+        return error::InvalidArgument("Encoded columns have an invalid uncompressed size $0",
+                                      encoded_cols.uncompressed_size());
+      }
+      PX_ASSIGN_OR_RETURN(auto uncompressed,
+                          zlib::Inflate(buffers, encoded_cols.uncompressed_size() + 1,
+                                        encoded_cols.uncompressed_size()));
+      data = std::make_shared<const std::string>(std::move(uncompressed));
+      break;
+    }
+    default:
+      return error::InvalidArgument("Unknown row batch compression $0",
+                                    magic_enum::enum_name(encoded_cols.compression()));
+  }
+  if (static_cast<int64_t>(data->size()) != encoded_cols.uncompressed_size()) {
+    return error::InvalidArgument("Encoded columns have $0 bytes, expected $1", data->size(),
+                                  encoded_cols.uncompressed_size());
+  }
+
+  std::vector<DataType> types;
+  for (auto dt : encoded_cols.types()) {
+    if (!IsEncodableType(static_cast<DataType>(dt))) {
+      return error::InvalidArgument("Encoded column has unknown type $0", dt);
+    }
+    types.push_back(static_cast<DataType>(dt));
+  }
+  auto output_rb = std::make_unique<RowBatch>(RowDescriptor(types), proto.num_rows());
+  output_rb->set_eow(proto.eow());
+  output_rb->set_eos(proto.eos());
+
+  int64_t pos = 0;
+  for (auto dt : types) {
+    std::shared_ptr<arrow::Array> col;
+#define TYPE_CASE(_dt_) PX_RETURN_IF_ERROR(DecodeColumn<_dt_>(data, proto.num_rows(), &pos, &col));
     PX_SWITCH_FOREACH_DATATYPE(dt, TYPE_CASE);
 #undef TYPE_CASE
+    PX_RETURN_IF_ERROR(output_rb->AddColumn(col));
+  }
+  if (pos != static_cast<int64_t>(data->size())) {
+    return error::InvalidArgument("Encoded columns have $0 bytes, but the columns only use $1",
+                                  data->size(), pos);
   }
+  return output_rb;
+}
+
+}  // namespace
+
+Status RowBatch::ToEncodedProto(
+    table_store::schemapb::RowBatchData* proto,
+    table_store::schemapb::EncodedColumns::Compression compression) const {
+  proto->set_num_rows(num_rows());
+  proto->set_eow(eow_);
+  proto->set_eos(eos_);
 
+  auto* encoded_cols = proto->mutable_encoded_cols();
+  encoded_cols->set_compression(compression);
+  std::string buffers;
+  for (auto col_idx = 0; col_idx < num_columns(); ++col_idx) {
+    auto dt = desc_.type(col_idx);
+    encoded_cols->add_types(dt);
+#define TYPE_CASE(_dt_)  \
+  PX_RETURN_IF_ERROR(    \
+      EncodeColumn<_dt_>(ColumnAt(col_idx).get(), selection_.get(), num_rows(), &buffers));
+    PX_SWITCH_FOREACH_DATATYPE(dt, TYPE_CASE);
+#undef TYPE_CASE
+  }
+
+  encoded_cols->set_uncompressed_size(buffers.size());
+  switch (compression) {
+    case table_store::schemapb::EncodedColumns::NONE:
+      *encoded_cols->mutable_buffers() = std::move(buffers);
+      break;
+    case table_store::schemapb::EncodedColumns::ZLIB: {
+      PX_ASSIGN_OR_RETURN(*encoded_cols->mutable_buffers(), zlib::Deflate(buffers));
+      break;
+    }
+    default:
+      return error::InvalidArgument("Unknown row batch compression $0",
+                                    magic_enum::enum_name(compression));
+  }
   return Status::OK();
 }
 
+StatusOr<std::unique_ptr<RowBatch>> RowBatch::FromProto(
+    table_store::schemapb::RowBatchData&& proto) {
+  if (!proto.has_encoded_cols()) {
+    return FromProto(static_cast<const table_store::schemapb::RowBatchData&>(proto));
+  }
+  std::string buffers = std::move(*proto.mutable_encoded_cols()->mutable_buffers());
+  return DecodeRowBatch(proto, std::move(buffers));
+}
+
 // PX_CARNOT_UPDATE_FOR_NEW_TYPES
 StatusOr<DataType> ProtoDataType(const table_store::schemapb::Column& proto) {
   switch (proto.col_data_case()) {
@@ -199,6 +618,9 @@ StatusOr<DataType> ProtoDataType(const table_store::schemapb::Column& proto) {
 
 StatusOr<std::unique_ptr<RowBatch>> RowBatch::FromProto(
     const table_store::schemapb::RowBatchData& proto) {
+  if (proto.has_encoded_cols()) {
+    return DecodeRowBatch(proto, proto.encoded_cols().buffers());
+  }
   std::vector<DataType> types(proto.cols_size());
   std::vector<std::shared_ptr<arrow::Array>> data_columns(proto.cols_size());
 
@@ -257,6 +679,15 @@ StatusOr<std::unique_ptr<RowBatch>> RowBatch::Slice(int64_t offset, int64_t leng
     return error::InvalidArgument("Slice(offset=$0, length=$1) on rowbatch of length $2 is invalid",
                                   offset, length, num_rows());
   }
+  if (selection_ != nullptr) {
+    // Slice the selection rather than the arrays.
+    auto output_rb = std::make_unique<RowBatch>(WithoutSelection());
+    output_rb->set_eow(false);
+    output_rb->set_eos(false);
+    PX_RETURN_IF_ERROR(output_rb->SetSelection(std::make_shared<SelectionVector>(
+        selection_->begin() + offset, selection_->begin() + offset + length)));
+    return output_rb;
+  }
   std::unique_ptr<RowBatch> output_rb = std::make_unique<RowBatch>(desc(), length);
   for (int64_t input_col_idx = 0; input_col_idx < num_columns(); ++input_col_idx) {
     auto col = ColumnAt(input_col_idx);
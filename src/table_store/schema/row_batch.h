@@ -19,6 +19,7 @@
 #pragma once
 
 #include <arrow/array.h>
+#include <arrow/memory_pool.h>
 #include <arrow/type.h>
 #include <map>
 #include <memory>
@@ -36,9 +37,21 @@ namespace schema {
 /**
  * A RowBatch is a table-like structure which consists of equal-length arrays
  * that match the schema described by the RowDescriptor.
+ *
+ * A RowBatch can also have a selection vector, in which case its rows are only the rows of its
+ * arrays at the selected indices. This lets a node such as a filter drop rows without copying the
+ * arrays. Code that reads the arrays of a row batch directly has to either go through the
+ * selection (see ColumnRowIdx) or call Materialize first.
+ *
+ * STRING columns can also be dictionary encoded arrow::DictionaryArrays (see
+ * dictionary_encoding.h), eg. when they are read from the cold store of a table. Code that reads
+ * the arrays of such a row batch as arrow::StringArrays has to call DecodeDictionaryColumns first.
  */
 class RowBatch {
  public:
+  // Indices into the arrays of a row batch, in increasing order.
+  using SelectionVector = std::vector<int64_t>;
+
   /**
    * Creates a row batch.
    *
@@ -50,9 +63,29 @@ class RowBatch {
   }
 
   Status ToProto(table_store::schemapb::RowBatchData* row_batch_proto) const;
+
+  /**
+   * Serializes the row batch like ToProto, except that the columns are written to encoded_cols as
+   * raw columnar buffers, rather than value by value to cols. This is much cheaper to encode,
+   * decode and send for large batches.
+   * @param compression how to compress the column buffers.
+   */
+  Status ToEncodedProto(table_store::schemapb::RowBatchData* row_batch_proto,
+                        table_store::schemapb::EncodedColumns::Compression compression) const;
+
+  /**
+   * Deserializes a row batch that was serialized with either ToProto or ToEncodedProto.
+   */
   static StatusOr<std::unique_ptr<RowBatch>> FromProto(
       const table_store::schemapb::RowBatchData& row_batch_proto);
 
+  /**
+   * Like FromProto, except that the arrays of an encoded row batch point directly into the
+   * (uncompressed) buffers taken out of the proto, without copying them.
+   */
+  static StatusOr<std::unique_ptr<RowBatch>> FromProto(
+      table_store::schemapb::RowBatchData&& row_batch_proto);
+
   static StatusOr<std::unique_ptr<RowBatch>> FromColumnBuilders(
       const RowDescriptor& desc, bool eow, bool eos,
       std::vector<std::unique_ptr<arrow::ArrayBuilder>>* builders);
@@ -76,6 +109,68 @@ class RowBatch {
    */
   StatusOr<std::unique_ptr<RowBatch>> Slice(int64_t offset, int64_t length) const;
 
+  /**
+   * Selects the rows of the row batch's arrays at the given indices. num_rows() becomes the number
+   * of selected rows, while the arrays, and num_column_rows(), are left unchanged.
+   * @param selection the selected indices, in increasing order and smaller than num_column_rows().
+   */
+  Status SetSelection(std::shared_ptr<const SelectionVector> selection);
+
+  bool has_selection() const { return selection_ != nullptr; }
+  const std::shared_ptr<const SelectionVector>& selection() const { return selection_; }
+
+  /**
+   * @ return the index into the arrays of the row at the given index.
+   */
+  int64_t ColumnRowIdx(int64_t row_idx) const {
+    return selection_ == nullptr ? row_idx : (*selection_)[row_idx];
+  }
+
+  /**
+   * @ return a row batch with the same arrays as this one but without a selection, so that all of
+   * the rows of the arrays are included.
+   */
+  RowBatch WithoutSelection() const;
+
+  /**
+   * @ return the selected rows of the given column, copied into a new array if the row batch has a
+   * selection.
+   */
+  StatusOr<std::shared_ptr<arrow::Array>> MaterializeColumn(int64_t i,
+                                                            arrow::MemoryPool* mem_pool) const;
+
+  /**
+   * @ return a row batch without a selection, with the selected rows of every column copied into
+   * new arrays.
+   */
+  StatusOr<std::unique_ptr<RowBatch>> Materialize(arrow::MemoryPool* mem_pool) const;
+
+  /**
+   * @ return a row batch without a selection, with the selected rows of the given columns copied
+   * into new arrays. The other columns only have the right type and length, and must not be read.
+   */
+  StatusOr<std::unique_ptr<RowBatch>> MaterializeColumns(const std::vector<int64_t>& col_idxs,
+                                                         arrow::MemoryPool* mem_pool) const;
+
+  /**
+   * @ return whether any of the columns is a dictionary encoded string column.
+   */
+  bool HasDictionaryColumns() const;
+
+  /**
+   * @ return a row batch with the same selection, where the given columns are decoded into plain
+   * arrow::StringArrays if they are dictionary encoded. The other columns are shared with this row
+   * batch.
+   */
+  StatusOr<std::unique_ptr<RowBatch>> DecodeDictionaryColumns(const std::vector<int64_t>& col_idxs,
+                                                              arrow::MemoryPool* mem_pool) const;
+
+  /**
+   * @ return a row batch with the same selection, where all of the dictionary encoded columns are
+   * decoded into plain arrow::StringArrays.
+   */
+  StatusOr<std::unique_ptr<RowBatch>> DecodeDictionaryColumns(arrow::MemoryPool* mem_pool) const;
+
   /**
    * Adds the given column to the row batch, given that it correctly fits the schema.
    * param col ptr to the arrow array that should be added to the row batch.
@@ -97,7 +192,15 @@ class RowBatch {
   /**
    * @ return the number of rows that each row batch should contain.
    */
-  int64_t num_rows() const { return num_rows_; }
+  int64_t num_rows() const {
+    return selection_ == nullptr ? num_rows_ : static_cast<int64_t>(selection_->size());
+  }
+
+  /**
+   * @ return the length of the arrays of the row batch, which is larger than num_rows() if the row
+   * batch has a selection.
+   */
+  int64_t num_column_rows() const { return num_rows_; }
 
   /**
    * @ return the number of columns which the row batch should contain.
@@ -126,6 +229,7 @@ class RowBatch {
   bool eow_ = false;
   bool eos_ = false;
   std::vector<std::shared_ptr<arrow::Array>> columns_;
+  std::shared_ptr<const SelectionVector> selection_;
 };
 
 // Append a scalar value to an arrow::Array.
@@ -19,12 +19,16 @@
 #include <arrow/array.h>
 #include <google/protobuf/text_format.h>
 #include <google/protobuf/util/message_differencer.h>
+#include <limits>
+#include <memory>
+#include <utility>
 #include <vector>
 
 #include "src/common/testing/testing.h"
 #include "src/shared/types/arrow_adapter.h"
 #include "src/shared/types/types.h"
 #include "src/shared/types/typespb/wrapper/types_pb_wrapper.h"
+#include "src/table_store/schema/dictionary_encoding.h"
 #include "src/table_store/schema/row_batch.h"
 #include "src/table_store/schema/row_descriptor.h"
 #include "src/table_store/schemapb/schema.pb.h"
@@ -179,6 +183,137 @@ TEST_F(RowBatchTest, to_from_proto) {
   EXPECT_TRUE(differ.Compare(input_proto, output_proto));
 }
 
+TEST_F(RowBatchTest, to_from_encoded_proto) {
+  table_store::schemapb::RowBatchData input_proto;
+  ASSERT_TRUE(google::protobuf::TextFormat::MergeFromString(kTestRowBatchProto, &input_proto));
+  auto rb = RowBatch::FromProto(input_proto).ConsumeValueOrDie();
+
+  for (auto compression :
+       {table_store::schemapb::EncodedColumns::NONE, table_store::schemapb::EncodedColumns::ZLIB}) {
+    table_store::schemapb::RowBatchData encoded_proto;
+    EXPECT_OK(rb->ToEncodedProto(&encoded_proto, compression));
+    EXPECT_EQ(0, encoded_proto.cols_size());
+    EXPECT_EQ(3, encoded_proto.encoded_cols().types_size());
+
+    // Decoding from a const proto copies the buffers, decoding from an rvalue takes them.
+    auto copied_rb = RowBatch::FromProto(encoded_proto).ConsumeValueOrDie();
+    auto moved_rb = RowBatch::FromProto(std::move(encoded_proto)).ConsumeValueOrDie();
+    for (const auto& decoded_rb : {copied_rb.get(), moved_rb.get()}) {
+      EXPECT_TRUE(decoded_rb->eow());
+      EXPECT_FALSE(decoded_rb->eos());
+      EXPECT_EQ(rb->desc(), decoded_rb->desc());
+
+      table_store::schemapb::RowBatchData output_proto;
+      EXPECT_OK(decoded_rb->ToProto(&output_proto));
+      google::protobuf::util::MessageDifferencer differ;
+      EXPECT_TRUE(differ.Compare(input_proto, output_proto));
+    }
+  }
+}
+
+TEST_F(RowBatchTest, materialize_columns) {
+  ASSERT_OK(rb_->SetSelection(std::make_shared<RowBatch::SelectionVector>(
+      RowBatch::SelectionVector{0, 2})));
+  ASSERT_OK_AND_ASSIGN(auto materialized_rb,
+                       rb_->MaterializeColumns({1}, arrow::default_memory_pool()));
+  EXPECT_FALSE(materialized_rb->has_selection());
+  EXPECT_EQ(2, materialized_rb->num_rows());
+  EXPECT_EQ(3, materialized_rb->num_columns());
+  EXPECT_EQ("[\n  3,\n  5\n]", materialized_rb->ColumnAt(1)->ToString());
+  // The other columns are not copied.
+  EXPECT_EQ(rb_->ColumnAt(0)->data()->buffers[1], materialized_rb->ColumnAt(0)->data()->buffers[1]);
+  EXPECT_EQ(2, materialized_rb->ColumnAt(2)->length());
+}
+
+TEST_F(RowBatchTest, dictionary_columns) {
+  std::vector<types::StringValue> strings;
+  for (int64_t i = 0; i < kDictionaryEncodingMinRows; ++i) {
+    strings.push_back(i % 3 == 0 ? "GET" : "POST");
+  }
+  auto plain = types::ToArrow(strings, arrow::default_memory_pool());
+  ASSERT_OK_AND_ASSIGN(auto encoded,
+                       MaybeDictionaryEncodeStringArray(plain.get(), arrow::default_memory_pool()));
+  ASSERT_NE(nullptr, encoded);
+
+  RowBatch rb(RowDescriptor({types::DataType::STRING, types::DataType::STRING}),
+              kDictionaryEncodingMinRows);
+  ASSERT_OK(rb.AddColumn(encoded));
+  ASSERT_OK(rb.AddColumn(plain));
+  EXPECT_TRUE(rb.HasDictionaryColumns());
+  EXPECT_EQ(DictionaryArrayBytes(encoded.get()) +
+                types::GetArrowArrayBytes<types::DataType::STRING>(plain.get()),
+            rb.NumBytes());
+
+  // Materializing a selection copies the codes, and keeps the dictionary.
+  ASSERT_OK(rb.SetSelection(std::make_shared<RowBatch::SelectionVector>(
+      RowBatch::SelectionVector{0, 1, 3})));
+  ASSERT_OK_AND_ASSIGN(auto materialized_rb, rb.Materialize(arrow::default_memory_pool()));
+  ASSERT_TRUE(IsDictionaryArray(materialized_rb->ColumnAt(0).get()));
+  EXPECT_EQ(DictionaryValues(encoded.get()), DictionaryValues(materialized_rb->ColumnAt(0).get()));
+
+  ASSERT_OK_AND_ASSIGN(auto decoded_rb,
+                       materialized_rb->DecodeDictionaryColumns(arrow::default_memory_pool()));
+  EXPECT_FALSE(decoded_rb->HasDictionaryColumns());
+  EXPECT_TRUE(decoded_rb->ColumnAt(0)->Equals(types::ToArrow(
+      std::vector<types::StringValue>{"GET", "POST", "GET"}, arrow::default_memory_pool())));
+  EXPECT_TRUE(decoded_rb->ColumnAt(0)->Equals(decoded_rb->ColumnAt(1)));
+
+  // Dictionaries of other value types don't fit a STRING column.
+  auto int_dict = std::make_shared<arrow::DictionaryArray>(
+      arrow::dictionary(arrow::int8(), arrow::int64()),
+      static_cast<const arrow::DictionaryArray*>(encoded.get())->indices(),
+      types::ToArrow(std::vector<types::Int64Value>{1, 2}, arrow::default_memory_pool()));
+  RowBatch int_dict_rb(RowDescriptor({types::DataType::STRING}), kDictionaryEncodingMinRows);
+  EXPECT_NOT_OK(int_dict_rb.AddColumn(int_dict));
+}
+
+TEST_F(RowBatchTest, encoded_proto_with_selection) {
+  ASSERT_OK(rb_->SetSelection(std::make_shared<RowBatch::SelectionVector>(
+      RowBatch::SelectionVector{0, 2})));
+  ASSERT_OK_AND_ASSIGN(auto materialized_rb, rb_->Materialize(arrow::default_memory_pool()));
+
+  table_store::schemapb::RowBatchData proto;
+  EXPECT_OK(rb_->ToEncodedProto(&proto, table_store::schemapb::EncodedColumns::NONE));
+  auto rb_from_proto = RowBatch::FromProto(std::move(proto)).ConsumeValueOrDie();
+  EXPECT_EQ(materialized_rb->DebugString(), rb_from_proto->DebugString());
+}
+
+TEST_F(RowBatchTest, encoded_proto_truncated) {
+  table_store::schemapb::RowBatchData proto;
+  EXPECT_OK(rb_->ToEncodedProto(&proto, table_store::schemapb::EncodedColumns::NONE));
+  auto* buffers = proto.mutable_encoded_cols()->mutable_buffers();
+  buffers->resize(buffers->size() - 16);
+  proto.mutable_encoded_cols()->set_uncompressed_size(buffers->size());
+  EXPECT_NOT_OK(RowBatch::FromProto(proto));
+}
+
+TEST_F(RowBatchTest, encoded_proto_too_many_rows) {
+  table_store::schemapb::RowBatchData proto;
+  EXPECT_OK(rb_->ToEncodedProto(&proto, table_store::schemapb::EncodedColumns::NONE));
+  // The buffer sizes computed from this many rows overflow.
+  proto.set_num_rows(std::numeric_limits<int64_t>::max() / 4);
+  EXPECT_NOT_OK(RowBatch::FromProto(proto));
+}
+
+TEST_F(RowBatchTest, encoded_proto_trailing_bytes) {
+  table_store::schemapb::RowBatchData proto;
+  EXPECT_OK(rb_->ToEncodedProto(&proto, table_store::schemapb::EncodedColumns::NONE));
+  auto* buffers = proto.mutable_encoded_cols()->mutable_buffers();
+  buffers->append(16, '\0');
+  proto.mutable_encoded_cols()->set_uncompressed_size(buffers->size());
+  EXPECT_NOT_OK(RowBatch::FromProto(proto));
+}
+
+TEST_F(RowBatchTest, encoded_proto_wrong_uncompressed_size) {
+  table_store::schemapb::RowBatchData proto;
+  EXPECT_OK(rb_->ToEncodedProto(&proto, table_store::schemapb::EncodedColumns::ZLIB));
+  auto uncompressed_size = proto.encoded_cols().uncompressed_size();
+  proto.mutable_encoded_cols()->set_uncompressed_size(uncompressed_size - 1);
+  EXPECT_NOT_OK(RowBatch::FromProto(proto));
+  proto.mutable_encoded_cols()->set_uncompressed_size(std::numeric_limits<int64_t>::max());
+  EXPECT_NOT_OK(RowBatch::FromProto(proto));
+}
+
 TEST_F(RowBatchTest, with_zero_rows) {
   bool eow = true;
   bool eos = false;
@@ -231,6 +366,38 @@ TEST_F(RowBatchTest, slice) {
   ASSERT_EQ(status2.msg(), "Slice(offset=-1, length=3) on rowbatch of length 3 is invalid");
 }
 
+TEST_F(RowBatchTest, selection) {
+  ASSERT_OK(rb_->SetSelection(std::make_shared<RowBatch::SelectionVector>(
+      RowBatch::SelectionVector{0, 2})));
+  EXPECT_EQ(2, rb_->num_rows());
+  EXPECT_EQ(3, rb_->num_column_rows());
+  EXPECT_EQ(2, rb_->ColumnRowIdx(1));
+  EXPECT_EQ(3, rb_->WithoutSelection().num_rows());
+
+  ASSERT_OK_AND_ASSIGN(auto materialized_rb, rb_->Materialize(arrow::default_memory_pool()));
+  EXPECT_FALSE(materialized_rb->has_selection());
+  EXPECT_EQ(2, materialized_rb->num_rows());
+  EXPECT_EQ("RowBatch(eow=0, eos=0):\n  [\n  true,\n  true\n]\n  [\n  3,\n  5\n]\n  [\n  "
+            "3.3,\n  5.6\n]\n",
+            materialized_rb->DebugString());
+
+  // Slicing a selection leaves the arrays as is.
+  ASSERT_OK_AND_ASSIGN(auto sliced_rb, rb_->Slice(1, 1));
+  EXPECT_EQ(1, sliced_rb->num_rows());
+  EXPECT_EQ(3, sliced_rb->num_column_rows());
+  EXPECT_EQ(2, sliced_rb->ColumnRowIdx(0));
+
+  // Only the selected rows are serialized.
+  table_store::schemapb::RowBatchData proto;
+  EXPECT_OK(rb_->ToProto(&proto));
+  auto rb_from_proto = RowBatch::FromProto(proto).ConsumeValueOrDie();
+  EXPECT_EQ(materialized_rb->DebugString(), rb_from_proto->DebugString());
+
+  auto status = rb_->SetSelection(std::make_shared<RowBatch::SelectionVector>(
+      RowBatch::SelectionVector{1, 3}));
+  ASSERT_NOT_OK(status);
+}
+
 }  // namespace schema
 }  // namespace table_store
 }  // namespace px
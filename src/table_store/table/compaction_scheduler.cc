@@ -0,0 +1,117 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "src/table_store/table/compaction_scheduler.h"
+
+namespace px {
+namespace table_store {
+
+CompactionScheduler::CompactionScheduler(size_t num_workers, arrow::MemoryPool* mem_pool,
+                                         prometheus::Gauge* queue_depth_gauge)
+    : mem_pool_(mem_pool), queue_depth_gauge_(queue_depth_gauge) {
+  DCHECK_GT(num_workers, 0U);
+  for (size_t i = 0; i < num_workers; ++i) {
+    workers_.emplace_back(&CompactionScheduler::WorkerLoop, this);
+  }
+}
+
+CompactionScheduler::~CompactionScheduler() {
+  {
+    absl::MutexLock lock(&lock_);
+    stopped_ = true;
+  }
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+}
+
+void CompactionScheduler::Schedule(const std::vector<std::shared_ptr<Table>>& tables) {
+  absl::MutexLock lock(&lock_);
+  absl::flat_hash_map<const Table*, int64_t> bytes_added;
+  for (const auto& table : tables) {
+    auto stats = table->GetTableStats();
+    bytes_added[table.get()] = stats.bytes_added;
+    if (stats.hot_bytes == 0 || pending_.contains(table.get())) {
+      continue;
+    }
+    int64_t recently_added = stats.bytes_added;
+    auto it = last_bytes_added_.find(table.get());
+    if (it != last_bytes_added_.end()) {
+      recently_added -= it->second;
+    }
+    queue_.push_back(QueuedTable{stats.hot_bytes + recently_added, table});
+    std::push_heap(queue_.begin(), queue_.end());
+    pending_.insert(table.get());
+  }
+  // Only keep track of the tables that were passed in, so that dropped tables are forgotten.
+  last_bytes_added_ = std::move(bytes_added);
+  UpdateQueueDepthGauge();
+}
+
+size_t CompactionScheduler::QueueDepth() const {
+  absl::MutexLock lock(&lock_);
+  return queue_.size();
+}
+
+void CompactionScheduler::WaitUntilIdle() const {
+  absl::MutexLock lock(&lock_);
+  lock_.Await(absl::Condition(
+      +[](const absl::flat_hash_set<const Table*>* pending) { return pending->empty(); },
+      &pending_));
+}
+
+void CompactionScheduler::UpdateQueueDepthGauge() {
+  if (queue_depth_gauge_ != nullptr) {
+    queue_depth_gauge_->Set(queue_.size());
+  }
+}
+
+void CompactionScheduler::WorkerLoop() {
+  while (true) {
+    std::shared_ptr<Table> table;
+    {
+      absl::MutexLock lock(&lock_);
+      lock_.Await(absl::Condition(
+          +[](CompactionScheduler* scheduler) ABSL_EXCLUSIVE_LOCKS_REQUIRED(scheduler->lock_) {
+            return scheduler->stopped_ || !scheduler->queue_.empty();
+          },
+          this));
+      if (stopped_) {
+        return;
+      }
+      std::pop_heap(queue_.begin(), queue_.end());
+      table = std::move(queue_.back().table);
+      queue_.pop_back();
+      UpdateQueueDepthGauge();
+    }
+
+    auto s = table->CompactHotToCold(mem_pool_);
+    LOG_IF(ERROR, !s.ok()) << absl::Substitute("Failed to compact table: $0", s.msg());
+
+    absl::MutexLock lock(&lock_);
+    pending_.erase(table.get());
+  }
+}
+
+}  // namespace table_store
+}  // namespace px
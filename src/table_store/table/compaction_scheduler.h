@@ -0,0 +1,106 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <absl/base/thread_annotations.h>
+#include <absl/container/flat_hash_map.h>
+#include <absl/container/flat_hash_set.h>
+#include <absl/synchronization/mutex.h>
+#include <arrow/memory_pool.h>
+#include <prometheus/gauge.h>
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "src/common/base/base.h"
+#include "src/table_store/table/table.h"
+
+namespace px {
+namespace table_store {
+
+/**
+ * CompactionScheduler compacts tables from hot to cold on a pool of background worker threads, so
+ * that compaction doesn't run on (and delay) the caller's event loop.
+ *
+ * Every call to `Schedule` queues the given tables that have hot data. Tables are compacted in
+ * priority order, where the priority of a table is its hot bytes plus the bytes written to it since
+ * the previous `Schedule` call. So tables with the most uncompacted data, or the highest ingest
+ * rate, are compacted first. A table is never queued or compacted more than once at a time.
+ */
+class CompactionScheduler : public NotCopyable {
+ public:
+  /**
+   * @param num_workers number of worker threads to compact tables on.
+   * @param mem_pool arrow MemoryPool to be used for creating new cold batches.
+   * @param queue_depth_gauge gauge to export the queue depth to, or nullptr. It is owned by the
+   * caller, so that it's only registered once no matter how many schedulers there are.
+   */
+  CompactionScheduler(size_t num_workers, arrow::MemoryPool* mem_pool,
+                      prometheus::Gauge* queue_depth_gauge = nullptr);
+
+  /**
+   * Stops the workers. Compactions that haven't started yet are dropped.
+   */
+  ~CompactionScheduler();
+
+  /**
+   * Queues the given tables for compaction, and returns without waiting for the compactions.
+   * @param tables the tables to consider for compaction.
+   */
+  void Schedule(const std::vector<std::shared_ptr<Table>>& tables);
+
+  /**
+   * @return number of tables waiting for a worker.
+   */
+  size_t QueueDepth() const;
+
+  /**
+   * Blocks until there are no queued or running compactions.
+   */
+  void WaitUntilIdle() const;
+
+ private:
+  struct QueuedTable {
+    int64_t priority;
+    std::shared_ptr<Table> table;
+
+    bool operator<(const QueuedTable& other) const { return priority < other.priority; }
+  };
+
+  void WorkerLoop();
+  void UpdateQueueDepthGauge() ABSL_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  arrow::MemoryPool* mem_pool_;
+  prometheus::Gauge* queue_depth_gauge_;
+
+  mutable absl::Mutex lock_;
+  // Max heap ordered by priority.
+  std::vector<QueuedTable> queue_ ABSL_GUARDED_BY(lock_);
+  // Tables that are either queued or currently being compacted.
+  absl::flat_hash_set<const Table*> pending_ ABSL_GUARDED_BY(lock_);
+  // Value of TableStats::bytes_added for each table, as of the previous call to Schedule.
+  absl::flat_hash_map<const Table*, int64_t> last_bytes_added_ ABSL_GUARDED_BY(lock_);
+  bool stopped_ ABSL_GUARDED_BY(lock_) = false;
+
+  std::vector<std::thread> workers_;
+};
+
+}  // namespace table_store
+}  // namespace px
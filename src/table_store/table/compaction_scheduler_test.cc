@@ -0,0 +1,87 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <absl/strings/str_cat.h>
+
+#include "src/common/testing/testing.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/table_store/table/compaction_scheduler.h"
+
+namespace px {
+namespace table_store {
+
+class CompactionSchedulerTest : public ::testing::Test {
+ protected:
+  static constexpr int64_t kNumRows = 100;
+  static constexpr int64_t kBatchBytes = kNumRows * 2 * sizeof(int64_t);
+
+  std::shared_ptr<Table> MakeTable(const std::string& name, int64_t num_batches) {
+    schema::Relation rel({types::DataType::TIME64NS, types::DataType::INT64}, {"time_", "col1"});
+    auto table = std::make_shared<Table>(name, rel, 128 * 1024, kBatchBytes);
+    for (int64_t batch = 0; batch < num_batches; ++batch) {
+      std::vector<types::Time64NSValue> times;
+      std::vector<types::Int64Value> values;
+      for (int64_t i = 0; i < kNumRows; ++i) {
+        times.push_back(batch * kNumRows + i);
+        values.push_back(i);
+      }
+      auto rb = schema::RowBatch(schema::RowDescriptor(rel.col_types()), kNumRows);
+      PX_CHECK_OK(rb.AddColumn(types::ToArrow(times, arrow::default_memory_pool())));
+      PX_CHECK_OK(rb.AddColumn(types::ToArrow(values, arrow::default_memory_pool())));
+      PX_CHECK_OK(table->WriteRowBatch(rb));
+    }
+    return table;
+  }
+};
+
+TEST_F(CompactionSchedulerTest, CompactsAllTablesInBackground) {
+  std::vector<std::shared_ptr<Table>> tables;
+  for (int64_t i = 0; i < 4; ++i) {
+    tables.push_back(MakeTable(absl::StrCat("table", i), i + 1));
+  }
+
+  CompactionScheduler scheduler(2, arrow::default_memory_pool());
+  scheduler.Schedule(tables);
+  scheduler.WaitUntilIdle();
+
+  EXPECT_EQ(0U, scheduler.QueueDepth());
+  for (const auto& table : tables) {
+    auto stats = table->GetTableStats();
+    EXPECT_EQ(0, stats.hot_bytes);
+    EXPECT_GT(stats.compacted_batches, 0);
+  }
+}
+
+TEST_F(CompactionSchedulerTest, SkipsTablesWithoutHotData) {
+  auto table = MakeTable("table", 2);
+  ASSERT_OK(table->CompactHotToCold(arrow::default_memory_pool()));
+  auto compacted_batches = table->GetTableStats().compacted_batches;
+
+  CompactionScheduler scheduler(1, arrow::default_memory_pool());
+  scheduler.Schedule({table, MakeTable("empty_table", 0)});
+  EXPECT_EQ(0U, scheduler.QueueDepth());
+  scheduler.WaitUntilIdle();
+  EXPECT_EQ(compacted_batches, table->GetTableStats().compacted_batches);
+}
+
+}  // namespace table_store
+}  // namespace px
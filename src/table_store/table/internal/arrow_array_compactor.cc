@@ -17,6 +17,7 @@
  */
 #include <vector>
 
+#include "src/table_store/schema/dictionary_encoding.h"
 #include "src/table_store/table/internal/arrow_array_compactor.h"
 #include "src/table_store/table/internal/record_or_row_batch.h"
 
@@ -24,8 +25,9 @@ namespace px {
 namespace table_store {
 namespace internal {
 
-ArrowArrayCompactor::ArrowArrayCompactor(const schema::Relation& rel, arrow::MemoryPool* mem_pool)
-    : rel_(rel) {
+ArrowArrayCompactor::ArrowArrayCompactor(const schema::Relation& rel, arrow::MemoryPool* mem_pool,
+                                         bool dictionary_encode_strings)
+    : rel_(rel), mem_pool_(mem_pool), dictionary_encode_strings_(dictionary_encode_strings) {
   for (const auto& type : rel_.col_types()) {
     builders_.push_back(types::MakeTypeErasedArrowBuilder(type, mem_pool));
   }
@@ -52,9 +54,22 @@ void ArrowArrayCompactor::UnsafeAppendBatchSlice(const RecordOrRowBatch& batch,
 
 StatusOr<std::vector<ArrowArrayPtr>> ArrowArrayCompactor::Finish() {
   std::vector<ArrowArrayPtr> out_columns;
+  last_bytes_saved_by_encoding_ = 0;
   for (const auto& [col_idx, builder] : Enumerate(builders_)) {
     out_columns.emplace_back();
     PX_RETURN_IF_ERROR(builder->Finish(&out_columns.back()));
+    if (!dictionary_encode_strings_ || rel_.col_types()[col_idx] != types::DataType::STRING) {
+      continue;
+    }
+    PX_ASSIGN_OR_RETURN(auto encoded,
+                        schema::MaybeDictionaryEncodeStringArray(out_columns.back().get(), mem_pool_));
+    if (encoded == nullptr) {
+      continue;
+    }
+    last_bytes_saved_by_encoding_ +=
+        schema::StringArrayBytes(out_columns.back().get()) -
+        schema::DictionaryArrayBytes(encoded.get());
+    out_columns.back() = std::move(encoded);
   }
   return out_columns;
 }
@@ -42,10 +42,15 @@ namespace internal {
  *    compactor.UnsafeAppendBatchSlice(record_or_row_batch, 0, NumRows(record_or_row_batch));
  *  }
  *  auto output_arrow_arrays = compactor.Finish();
+ *
+ * If `dictionary_encode_strings` is set, string columns are dictionary encoded by `Finish` when
+ * that makes them sufficiently smaller (see schema::MaybeDictionaryEncodeStringArray). The output arrays
+ * for those columns are then arrow::DictionaryArrays instead of arrow::StringArrays.
  */
 class ArrowArrayCompactor {
  public:
-  ArrowArrayCompactor(const schema::Relation& rel, arrow::MemoryPool* mem_pool);
+  ArrowArrayCompactor(const schema::Relation& rel, arrow::MemoryPool* mem_pool,
+                      bool dictionary_encode_strings = false);
   /**
    * Reserve space for the given number of rows, and in the case of binary column types (eg. string
    * columns) reserve space for columns data given by col_size_bytes.
@@ -74,9 +79,16 @@ class ArrowArrayCompactor {
    * @return compacted arrow::Array's per column in the batch.
    */
   StatusOr<std::vector<ArrowArrayPtr>> Finish();
+  /**
+   * @return the number of bytes saved by dictionary encoding in the last call to `Finish`.
+   */
+  int64_t LastBytesSavedByEncoding() const { return last_bytes_saved_by_encoding_; }
 
  private:
   const schema::Relation& rel_;
+  arrow::MemoryPool* mem_pool_;
+  const bool dictionary_encode_strings_;
+  int64_t last_bytes_saved_by_encoding_ = 0;
   std::vector<std::unique_ptr<types::TypeErasedArrowBuilder>> builders_;
 };
 
@@ -21,6 +21,7 @@
 #include <vector>
 
 #include "src/common/testing/testing.h"
+#include "src/table_store/schema/dictionary_encoding.h"
 #include "src/table_store/schema/relation.h"
 #include "src/table_store/schema/row_batch.h"
 #include "src/table_store/table/internal/arrow_array_compactor.h"
@@ -146,6 +147,40 @@ TEST_P(ArrowArrayCompactorTest, SlicedCompaction) {
       std::vector<types::StringValue>{"s", "one", "very"}, arrow::default_memory_pool())));
 }
 
+TEST_P(ArrowArrayCompactorTest, DictionaryEncodedStrings) {
+  compactor_ = std::make_unique<ArrowArrayCompactor>(*rel_, arrow::default_memory_pool(),
+                                                     /*dictionary_encode_strings*/ true);
+  size_t num_rows = 2 * schema::kDictionaryEncodingMinRows;
+  std::vector<types::Time64NSValue> times;
+  std::vector<types::BoolValue> bools;
+  std::vector<types::StringValue> strings;
+  for (size_t i = 0; i < num_rows; ++i) {
+    times.push_back(i);
+    bools.push_back(i % 2 == 0);
+    strings.push_back(i % 3 == 0 ? "GET /healthz" : "POST /api/v1/query");
+  }
+  std::unique_ptr<RecordOrRowBatch> rb;
+  ColSizes col_sizes;
+  std::tie(rb, col_sizes) = MakeRecordOrRowBatch(times, bools, strings);
+
+  ASSERT_OK(compactor_->Reserve(num_rows, col_sizes));
+  compactor_->UnsafeAppendBatchSlice(*rb, 0, num_rows);
+  ASSERT_OK_AND_ASSIGN(auto out_columns, compactor_->Finish());
+
+  // Only the string column should be encoded.
+  EXPECT_EQ(arrow::Type::TIME64, out_columns[0]->type_id());
+  EXPECT_EQ(arrow::Type::BOOL, out_columns[1]->type_id());
+  ASSERT_EQ(arrow::Type::DICTIONARY, out_columns[2]->type_id());
+
+  auto expected_strings = types::ToArrow(strings, arrow::default_memory_pool());
+  EXPECT_EQ(schema::StringArrayBytes(expected_strings.get()) -
+                schema::DictionaryArrayBytes(out_columns[2].get()),
+            compactor_->LastBytesSavedByEncoding());
+  ASSERT_OK_AND_ASSIGN(auto decoded, schema::DecodeDictionaryArray(out_columns[2].get(),
+                                                                   arrow::default_memory_pool()));
+  EXPECT_TRUE(decoded->Equals(expected_strings));
+}
+
 INSTANTIATE_RECORD_OR_ROW_BATCH_TESTSUITE(ArrowArrayCompactor, ArrowArrayCompactorTest,
                                           /*include_mixed*/ true);
 
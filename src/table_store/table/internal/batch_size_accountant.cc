@@ -156,6 +156,8 @@ void BatchSizeAccountant::ExpireHotBatch() {
 void BatchSizeAccountant::ExpireColdBatch() {
   cold_bytes_ -= cold_batch_bytes_.front();
   cold_batch_bytes_.pop_front();
+  cold_logical_bytes_ -= cold_batch_logical_bytes_.front();
+  cold_batch_logical_bytes_.pop_front();
 }
 
 bool BatchSizeAccountant::CompactedBatchReady() const {
@@ -169,14 +171,17 @@ const BatchSizeAccountant::CompactedBatchSpec& BatchSizeAccountant::GetNextCompa
   return compacted_batch_specs_.front();
 }
 
-uint64_t BatchSizeAccountant::FinishCompactedBatch() {
+uint64_t BatchSizeAccountant::FinishCompactedBatch(uint64_t bytes_saved) {
   DCHECK(CompactedBatchReady());
   auto spec = std::move(compacted_batch_specs_.front());
   compacted_batch_specs_.pop_front();
+  DCHECK_LE(bytes_saved, spec.bytes);
 
   hot_bytes_ -= spec.bytes;
-  cold_bytes_ += spec.bytes;
-  cold_batch_bytes_.push_back(spec.bytes);
+  cold_bytes_ += spec.bytes - bytes_saved;
+  cold_batch_bytes_.push_back(spec.bytes - bytes_saved);
+  cold_logical_bytes_ += spec.bytes;
+  cold_batch_logical_bytes_.push_back(spec.bytes);
 
   if (spec.hot_slices.back().last_slice_for_batch) {
     // If the last slice in the compacted batch was the last slice for the corresponding hot batch,
@@ -216,6 +221,8 @@ uint64_t BatchSizeAccountant::HotBytes() const { return hot_bytes_; }
 
 uint64_t BatchSizeAccountant::ColdBytes() const { return cold_bytes_; }
 
+uint64_t BatchSizeAccountant::ColdLogicalBytes() const { return cold_logical_bytes_; }
+
 const BatchSizeAccountantNonMutableState& BatchSizeAccountant::NonMutableState() const {
   return non_mutable_state_;
 }
@@ -130,10 +130,12 @@ class BatchSizeAccountant {
    * update hot_bytes_ and cold_bytes_ accordingly. It returns the number of rows that need to be
    * removed from start of the first hot batch in order to prevent duplicated data between the hot
    * and cold stores.
+   * @param bytes_saved Number of bytes the compacted batch takes up less than the hot slices it was
+   * created from, eg. because some of its columns were dictionary encoded.
    * @return Number of rows to remove from the front of the hot store, since those rows were moved
    * into the cold store via CompactedBatchSpec.
    */
-  uint64_t FinishCompactedBatch();
+  uint64_t FinishCompactedBatch(uint64_t bytes_saved = 0);
   /**
    * @return the number of bytes stored in the hot store.
    */
@@ -142,6 +144,11 @@ class BatchSizeAccountant {
    * @return the number of bytes stored in the cold store.
    */
   uint64_t ColdBytes() const;
+  /**
+   * @return the number of bytes the data in the cold store would take up without any encoding or
+   * compression.
+   */
+  uint64_t ColdLogicalBytes() const;
 
   const BatchSizeAccountantNonMutableState& NonMutableState() const;
 
@@ -150,8 +157,10 @@ class BatchSizeAccountant {
 
   std::deque<CompactedBatchSpec> compacted_batch_specs_;
   std::deque<uint64_t> cold_batch_bytes_;
+  std::deque<uint64_t> cold_batch_logical_bytes_;
   uint64_t hot_bytes_ = 0;
   uint64_t cold_bytes_ = 0;
+  uint64_t cold_logical_bytes_ = 0;
 
   static BatchSizeAccountantNonMutableState CreateNonMutableState(const schema::Relation& rel,
                                                                   size_t compacted_size);
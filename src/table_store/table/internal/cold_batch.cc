@@ -0,0 +1,140 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "src/shared/types/arrow_adapter.h"
+#include "src/table_store/table/internal/cold_batch.h"
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+ColdBatch::ColdBatch(std::vector<ArrowArrayPtr> columns)
+    : columns_(std::move(columns)), encoded_columns_(columns_.size()) {
+  DCHECK(!columns_.empty());
+  length_ = columns_[0]->length();
+}
+
+int64_t ColdBatch::FindTimeFirstGreaterThanOrEqual(int64_t time_col_idx, Time time) const {
+  const auto* encoded = encoded_columns_[time_col_idx].get();
+  if (encoded == nullptr) {
+    return types::SearchArrowArrayGreaterThanOrEqual<types::DataType::TIME64NS>(
+        columns_[time_col_idx].get(), time);
+  }
+  // Binary search over row indices, decoding only the rows that are probed.
+  int64_t lo = 0;
+  int64_t hi = length_;
+  while (lo < hi) {
+    int64_t mid = lo + (hi - lo) / 2;
+    if (encoded->Value(mid) < time) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo == static_cast<int64_t>(length_) ? -1 : lo;
+}
+
+int64_t ColdBatch::FindTimeFirstGreaterThan(int64_t time_col_idx, Time time) const {
+  const auto* encoded = encoded_columns_[time_col_idx].get();
+  if (encoded == nullptr) {
+    return types::SearchArrowArrayLessThanOrEqual<types::DataType::TIME64NS>(
+               columns_[time_col_idx].get(), time) +
+           1;
+  }
+  int64_t lo = 0;
+  int64_t hi = length_;
+  while (lo < hi) {
+    int64_t mid = lo + (hi - lo) / 2;
+    if (encoded->Value(mid) <= time) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+
+Time ColdBatch::GetTimeValue(int64_t time_col_idx, int64_t row_idx) const {
+  const auto* encoded = encoded_columns_[time_col_idx].get();
+  if (encoded != nullptr) {
+    return encoded->Value(row_idx);
+  }
+  return types::GetValueFromArrowArray<types::DataType::TIME64NS>(columns_[time_col_idx].get(),
+                                                                  row_idx);
+}
+
+StatusOr<ArrowArrayPtr> ColdBatch::ColumnSlice(int64_t col_idx, int64_t offset, int64_t length,
+                                               arrow::MemoryPool* mem_pool) const {
+  if (encoded_columns_[col_idx] != nullptr) {
+    return encoded_columns_[col_idx]->DecodeSlice(offset, length, mem_pool);
+  }
+  // Dictionary encoded string columns are sliced like plain ones. Readers that can't handle the
+  // codes decode them, see Table::Cursor::set_keep_dictionary_columns.
+  return columns_[col_idx]->Slice(offset, length);
+}
+
+Status ColdBatch::AddBatchSliceToRowBatch(size_t row_start, size_t batch_size,
+                                          const std::vector<int64_t>& cols,
+                                          schema::RowBatch* output_rb,
+                                          arrow::MemoryPool* mem_pool) const {
+  for (auto col_idx : cols) {
+    PX_ASSIGN_OR_RETURN(auto arr, ColumnSlice(col_idx, row_start, batch_size, mem_pool));
+    PX_RETURN_IF_ERROR(output_rb->AddColumn(arr));
+  }
+  return Status::OK();
+}
+
+ColumnZoneMap ColdBatch::GetColumnZoneMap(int64_t col_idx, types::DataType col_data_type) const {
+  if (encoded_columns_[col_idx] == nullptr) {
+    return ComputeArrowArrayZoneMap(columns_[col_idx].get(), col_data_type);
+  }
+  // The min/max of compressed columns are recorded when they're encoded, so that computing the zone
+  // map doesn't decode the column.
+  const auto& encoded = *encoded_columns_[col_idx];
+  return ColumnZoneMap{true, encoded.min(), encoded.max()};
+}
+
+int64_t ColdBatch::CompressIntegerColumns(const schema::Relation& rel) {
+  if (static_cast<int64_t>(length_) < kCompressionMinRows) {
+    return 0;
+  }
+  int64_t bytes_saved = 0;
+  for (size_t col_idx = 0; col_idx < columns_.size(); ++col_idx) {
+    auto col_type = rel.col_types()[col_idx];
+    if (encoded_columns_[col_idx] != nullptr ||
+        (col_type != types::DataType::INT64 && col_type != types::DataType::TIME64NS)) {
+      continue;
+    }
+    auto encoded = EncodedInt64Column::MaybeEncode(columns_[col_idx].get(), col_type);
+    if (encoded == nullptr) {
+      continue;
+    }
+    bytes_saved += columns_[col_idx]->length() * sizeof(int64_t) - encoded->Bytes();
+    encoded_columns_[col_idx] = std::move(encoded);
+    columns_[col_idx] = nullptr;
+  }
+  return bytes_saved;
+}
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
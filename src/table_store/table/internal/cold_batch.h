@@ -0,0 +1,133 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "src/table_store/schema/relation.h"
+#include "src/table_store/schema/row_batch.h"
+#include "src/table_store/table/internal/column_codec.h"
+#include "src/table_store/table/internal/types.h"
+#include "src/table_store/table/internal/zone_map.h"
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+/**
+ * ColdBatch holds the columns of a single compacted batch in the cold store. Most columns are
+ * stored as arrow arrays (possibly dictionary encoded, see schema/dictionary_encoding.h), but INT64
+ * and TIME64NS columns can also be stored compressed (see EncodedInt64Column).
+ *
+ * Compressed columns are decompressed lazily, ie. `AddBatchSliceToRowBatch` only decodes the
+ * columns and rows that are asked for. The time column supports searching and random access
+ * without decompressing the whole column. The interface mirrors that of `RecordOrRowBatch`, so that
+ * `StoreWithRowTimeAccounting` can treat hot and cold batches alike.
+ */
+class ColdBatch {
+ public:
+  explicit ColdBatch(std::vector<ArrowArrayPtr> columns);
+
+  ColdBatch(ColdBatch&&) = default;
+  ColdBatch& operator=(ColdBatch&&) = default;
+
+  /**
+   * Length returns the number of rows in this batch.
+   * @return number of rows.
+   */
+  size_t Length() const { return length_; }
+  /**
+   * FindTimeFirstGreaterThanOrEqual returns the first row index within this batch that has time
+   * greater than or equal to the given time.
+   * @param time_col_idx, column index to use for times.
+   * @param time, the time to search for.
+   * @return row index of the first row with time greater than or equal to the given time, or -1 if
+   * no such row exists.
+   */
+  int64_t FindTimeFirstGreaterThanOrEqual(int64_t time_col_idx, Time time) const;
+  /**
+   * FindTimeFirstGreaterThan returns the first row index within this batch that has time greater
+   * than the given time.
+   * @param time_col_idx, column index to use for times.
+   * @param time, the time to search for.
+   * @return row index of the first row with time greater than the given time, or Length() if no
+   * such row exists.
+   */
+  int64_t FindTimeFirstGreaterThan(int64_t time_col_idx, Time time) const;
+  /**
+   * GetTimeValue returns the value of the time column at the given row index.
+   * @param time_col_idx, the index of the column to get the time value from.
+   * @param row_idx, the index of the row to get.
+   * @return the time value at the given row index.
+   */
+  Time GetTimeValue(int64_t time_col_idx, int64_t row_idx) const;
+  /**
+   * AddBatchSliceToRowBatch adds a slice of this batch to the given output schema::RowBatch.
+   * Compressed columns are decoded, while dictionary encoded string columns are added as zero-copy
+   * slices of their arrow::DictionaryArrays.
+   * @param row_start, row index within this batch to start the output slice at.
+   * @param batch_size, size of the output slice.
+   * @param cols, a vector of column indices to include in the output slice.
+   * @param output_rb, a pointer to the row batch to add the columns to.
+   * @param mem_pool, the arrow MemoryPool that decompressed columns are allocated from.
+   * @return Status, errors if decoding or adding columns to the row batch fails.
+   */
+  Status AddBatchSliceToRowBatch(size_t row_start, size_t batch_size,
+                                 const std::vector<int64_t>& cols, schema::RowBatch* output_rb,
+                                 arrow::MemoryPool* mem_pool = arrow::default_memory_pool()) const;
+  /**
+   * GetColumnZoneMap computes the min/max zone map of the given column.
+   * @param col_idx, index of the column to compute the zone map for.
+   * @param col_data_type, the DataType of the column.
+   * @return zone map of the column, invalid if the column type doesn't support zone maps.
+   */
+  ColumnZoneMap GetColumnZoneMap(int64_t col_idx, types::DataType col_data_type) const;
+
+  /**
+   * CompressIntegerColumns replaces each INT64 and TIME64NS column of the batch with an
+   * EncodedInt64Column, if compressing the column is worthwhile (see
+   * EncodedInt64Column::MaybeEncode). Batches with fewer than kCompressionMinRows rows are left as
+   * is.
+   * @param rel, the relation of the table the batch belongs to.
+   * @return the number of bytes saved by compressing the batch.
+   */
+  int64_t CompressIntegerColumns(const schema::Relation& rel);
+
+  /**
+   * @return whether the given column is stored as an EncodedInt64Column.
+   */
+  bool IsColumnCompressed(int64_t col_idx) const { return encoded_columns_[col_idx] != nullptr; }
+
+  static constexpr int64_t kCompressionMinRows = EncodedInt64Column::kBlockSize;
+
+ private:
+  StatusOr<ArrowArrayPtr> ColumnSlice(int64_t col_idx, int64_t offset, int64_t length,
+                                      arrow::MemoryPool* mem_pool) const;
+
+  size_t length_;
+  // Plain (or dictionary encoded) columns. Set to nullptr for columns that are compressed.
+  std::vector<ArrowArrayPtr> columns_;
+  // Compressed columns. Set to nullptr for columns that are not compressed.
+  std::vector<std::unique_ptr<EncodedInt64Column>> encoded_columns_;
+};
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
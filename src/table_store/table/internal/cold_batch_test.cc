@@ -0,0 +1,147 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "src/common/testing/testing.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/table_store/schema/dictionary_encoding.h"
+#include "src/table_store/table/internal/cold_batch.h"
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+class ColdBatchTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    rel_ = std::make_unique<schema::Relation>(
+        std::vector<types::DataType>{types::DataType::TIME64NS, types::DataType::INT64,
+                                     types::DataType::STRING},
+        std::vector<std::string>{"time_", "col1", "col2"});
+    for (int64_t i = 0; i < kNumRows; ++i) {
+      // Every time is repeated twice, to test searching with duplicate times.
+      times_.push_back(100 + 10 * (i / 2));
+      ints_.push_back(i % 5);
+      strings_.push_back(i % 2 == 0 ? "even" : "odd");
+    }
+    batch_ = std::make_unique<ColdBatch>(std::vector<ArrowArrayPtr>{
+        types::ToArrow(times_, arrow::default_memory_pool()),
+        types::ToArrow(ints_, arrow::default_memory_pool()),
+        types::ToArrow(strings_, arrow::default_memory_pool())});
+  }
+
+  static constexpr int64_t kNumRows = 1000;
+  std::unique_ptr<schema::Relation> rel_;
+  std::vector<types::Time64NSValue> times_;
+  std::vector<types::Int64Value> ints_;
+  std::vector<types::StringValue> strings_;
+  std::unique_ptr<ColdBatch> batch_;
+};
+
+TEST_F(ColdBatchTest, CompressIntegerColumns) {
+  EXPECT_GT(batch_->CompressIntegerColumns(*rel_), 0);
+  EXPECT_TRUE(batch_->IsColumnCompressed(0));
+  EXPECT_TRUE(batch_->IsColumnCompressed(1));
+  EXPECT_FALSE(batch_->IsColumnCompressed(2));
+  EXPECT_EQ(kNumRows, static_cast<int64_t>(batch_->Length()));
+
+  // Only the requested rows and columns are decoded.
+  schema::RowBatch rb(schema::RowDescriptor({types::DataType::INT64, types::DataType::STRING}),
+                      300);
+  ASSERT_OK(batch_->AddBatchSliceToRowBatch(250, 300, {1, 2}, &rb));
+  EXPECT_TRUE(rb.ColumnAt(0)->Equals(
+      types::ToArrow(ints_, arrow::default_memory_pool())->Slice(250, 300)));
+  EXPECT_TRUE(rb.ColumnAt(1)->Equals(
+      types::ToArrow(strings_, arrow::default_memory_pool())->Slice(250, 300)));
+}
+
+TEST_F(ColdBatchTest, TimeSearchOnCompressedColumn) {
+  ColdBatch plain_batch(std::vector<ArrowArrayPtr>{
+      types::ToArrow(times_, arrow::default_memory_pool()),
+      types::ToArrow(ints_, arrow::default_memory_pool()),
+      types::ToArrow(strings_, arrow::default_memory_pool())});
+  batch_->CompressIntegerColumns(*rel_);
+  ASSERT_TRUE(batch_->IsColumnCompressed(0));
+
+  // The compressed batch should behave exactly like the uncompressed one.
+  for (Time time : std::vector<Time>{0, 100, 105, 110, 2000, 5090, 6000}) {
+    EXPECT_EQ(plain_batch.FindTimeFirstGreaterThanOrEqual(0, time),
+              batch_->FindTimeFirstGreaterThanOrEqual(0, time))
+        << time;
+    EXPECT_EQ(plain_batch.FindTimeFirstGreaterThan(0, time),
+              batch_->FindTimeFirstGreaterThan(0, time))
+        << time;
+  }
+  EXPECT_EQ(100, batch_->GetTimeValue(0, 0));
+  EXPECT_EQ(100 + 10 * 499, batch_->GetTimeValue(0, kNumRows - 1));
+
+  auto zone_map = batch_->GetColumnZoneMap(1, types::DataType::INT64);
+  ASSERT_TRUE(zone_map.valid);
+  EXPECT_EQ(0, std::get<int64_t>(zone_map.min));
+  EXPECT_EQ(4, std::get<int64_t>(zone_map.max));
+}
+
+TEST_F(ColdBatchTest, DecodesIntoCallersPool) {
+  batch_->CompressIntegerColumns(*rel_);
+  ASSERT_TRUE(batch_->IsColumnCompressed(1));
+
+  arrow::ProxyMemoryPool pool(arrow::default_memory_pool());
+  schema::RowBatch rb(schema::RowDescriptor({types::DataType::INT64}), 300);
+  ASSERT_OK(batch_->AddBatchSliceToRowBatch(250, 300, {1}, &rb, &pool));
+  EXPECT_TRUE(rb.ColumnAt(0)->Equals(
+      types::ToArrow(ints_, arrow::default_memory_pool())->Slice(250, 300)));
+  EXPECT_GT(pool.bytes_allocated(), 0);
+}
+
+TEST_F(ColdBatchTest, KeepsDictionaryColumnsEncoded) {
+  auto strings = types::ToArrow(strings_, arrow::default_memory_pool());
+  ASSERT_OK_AND_ASSIGN(auto encoded, schema::MaybeDictionaryEncodeStringArray(
+                                         strings.get(), arrow::default_memory_pool()));
+  ASSERT_NE(nullptr, encoded);
+  ColdBatch dict_batch(std::vector<ArrowArrayPtr>{
+      types::ToArrow(times_, arrow::default_memory_pool()),
+      types::ToArrow(ints_, arrow::default_memory_pool()), encoded});
+
+  // The slice shares the indices and the dictionary of the batch, so nothing is allocated.
+  arrow::ProxyMemoryPool pool(arrow::default_memory_pool());
+  schema::RowBatch rb(schema::RowDescriptor({types::DataType::STRING}), 300);
+  ASSERT_OK(dict_batch.AddBatchSliceToRowBatch(250, 300, {2}, &rb, &pool));
+  EXPECT_EQ(0, pool.bytes_allocated());
+  ASSERT_TRUE(schema::IsDictionaryArray(rb.ColumnAt(0).get()));
+  ASSERT_OK_AND_ASSIGN(auto decoded, schema::DecodeDictionaryArray(rb.ColumnAt(0).get(),
+                                                                   arrow::default_memory_pool()));
+  EXPECT_TRUE(decoded->Equals(strings->Slice(250, 300)));
+}
+
+TEST_F(ColdBatchTest, SmallBatchesAreNotCompressed) {
+  ColdBatch small_batch(std::vector<ArrowArrayPtr>{
+      types::ToArrow(std::vector<types::Time64NSValue>{1, 2, 3}, arrow::default_memory_pool()),
+      types::ToArrow(std::vector<types::Int64Value>{1, 1, 1}, arrow::default_memory_pool()),
+      types::ToArrow(std::vector<types::StringValue>{"a", "b", "c"},
+                     arrow::default_memory_pool())});
+  EXPECT_EQ(0, small_batch.CompressIntegerColumns(*rel_));
+  EXPECT_FALSE(small_batch.IsColumnCompressed(0));
+  EXPECT_FALSE(small_batch.IsColumnCompressed(1));
+}
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
@@ -0,0 +1,255 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <arrow/buffer.h>
+
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <magic_enum.hpp>
+
+#include "src/shared/types/arrow_adapter.h"
+#include "src/table_store/table/internal/column_codec.h"
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+namespace {
+
+uint8_t BitWidth(uint64_t max_value) {
+  if (max_value == 0) {
+    return 0;
+  }
+  return 64 - __builtin_clzll(max_value);
+}
+
+void PackBits(std::vector<uint64_t>* words, uint64_t bit_pos, uint64_t value, uint8_t bit_width) {
+  if (bit_width == 0) {
+    return;
+  }
+  size_t word_idx = bit_pos / 64;
+  size_t shift = bit_pos % 64;
+  (*words)[word_idx] |= value << shift;
+  if (shift + bit_width > 64) {
+    (*words)[word_idx + 1] |= value >> (64 - shift);
+  }
+}
+
+// Computes the packed residuals of a single block for the given codec, returning the block's
+// reference value. Residuals are computed with unsigned (wrapping) arithmetic, so that any sequence
+// of int64 values round trips, even if the differences between values overflow int64.
+uint64_t BlockResiduals(EncodedInt64Column::Codec codec, const int64_t* values, int64_t num_values,
+                        std::array<uint64_t, EncodedInt64Column::kBlockSize>* residuals,
+                        int64_t* num_residuals) {
+  if (codec == EncodedInt64Column::Codec::kFrameOfReference) {
+    *num_residuals = num_values;
+    uint64_t reference = static_cast<uint64_t>(*std::min_element(values, values + num_values));
+    for (int64_t i = 0; i < num_values; ++i) {
+      (*residuals)[i] = static_cast<uint64_t>(values[i]) - reference;
+    }
+    return reference;
+  }
+  // The first value of the block is stored in full, so there is one less residual than values.
+  *num_residuals = num_values - 1;
+  if (*num_residuals == 0) {
+    return 0;
+  }
+  // Find the minimum difference, comparing as signed so that a decreasing step is the minimum.
+  int64_t min_delta = std::numeric_limits<int64_t>::max();
+  for (int64_t i = 1; i < num_values; ++i) {
+    auto delta = static_cast<int64_t>(static_cast<uint64_t>(values[i]) -
+                                      static_cast<uint64_t>(values[i - 1]));
+    min_delta = std::min(min_delta, delta);
+  }
+  uint64_t reference = static_cast<uint64_t>(min_delta);
+  for (int64_t i = 1; i < num_values; ++i) {
+    (*residuals)[i - 1] =
+        static_cast<uint64_t>(values[i]) - static_cast<uint64_t>(values[i - 1]) - reference;
+  }
+  return reference;
+}
+
+// Returns the number of bits needed to pack the given values with the given codec.
+uint64_t PackedBits(EncodedInt64Column::Codec codec, const int64_t* values, int64_t length) {
+  std::array<uint64_t, EncodedInt64Column::kBlockSize> residuals;
+  uint64_t total_bits = 0;
+  for (int64_t start = 0; start < length; start += EncodedInt64Column::kBlockSize) {
+    auto num_values = std::min(EncodedInt64Column::kBlockSize, length - start);
+    int64_t num_residuals;
+    BlockResiduals(codec, values + start, num_values, &residuals, &num_residuals);
+    uint64_t max_residual = 0;
+    for (int64_t i = 0; i < num_residuals; ++i) {
+      max_residual = std::max(max_residual, residuals[i]);
+    }
+    total_bits += BitWidth(max_residual) * num_residuals;
+  }
+  return total_bits;
+}
+
+}  // namespace
+
+std::unique_ptr<EncodedInt64Column> EncodedInt64Column::Encode(const arrow::Array* arr,
+                                                               types::DataType type, Codec codec) {
+  DCHECK(type == types::DataType::INT64 || type == types::DataType::TIME64NS);
+  DCHECK_EQ(0, arr->null_count());
+  const int64_t* values = arr->data()->GetValues<int64_t>(1);
+  auto length = arr->length();
+
+  std::unique_ptr<EncodedInt64Column> col(new EncodedInt64Column(type, codec, length));
+  if (length > 0) {
+    auto [min_it, max_it] = std::minmax_element(values, values + length);
+    col->min_ = *min_it;
+    col->max_ = *max_it;
+  }
+  col->blocks_.reserve((length + kBlockSize - 1) / kBlockSize);
+  col->packed_.resize((PackedBits(codec, values, length) + 63) / 64 + 1);
+
+  std::array<uint64_t, kBlockSize> residuals;
+  uint64_t bit_pos = 0;
+  for (int64_t start = 0; start < length; start += kBlockSize) {
+    auto num_values = std::min(kBlockSize, length - start);
+    int64_t num_residuals;
+    auto reference = BlockResiduals(codec, values + start, num_values, &residuals, &num_residuals);
+    uint64_t max_residual = 0;
+    for (int64_t i = 0; i < num_residuals; ++i) {
+      max_residual = std::max(max_residual, residuals[i]);
+    }
+    auto bit_width = BitWidth(max_residual);
+    col->blocks_.push_back(Block{values[start], reference, bit_pos, bit_width});
+    for (int64_t i = 0; i < num_residuals; ++i) {
+      PackBits(&col->packed_, bit_pos, residuals[i], bit_width);
+      bit_pos += bit_width;
+    }
+  }
+  return col;
+}
+
+std::unique_ptr<EncodedInt64Column> EncodedInt64Column::MaybeEncode(const arrow::Array* arr,
+                                                                    types::DataType type) {
+  if (arr->length() == 0 || arr->null_count() != 0) {
+    return nullptr;
+  }
+  const int64_t* values = arr->data()->GetValues<int64_t>(1);
+  auto for_bits = PackedBits(Codec::kFrameOfReference, values, arr->length());
+  auto delta_bits = PackedBits(Codec::kDelta, values, arr->length());
+  auto codec = delta_bits < for_bits ? Codec::kDelta : Codec::kFrameOfReference;
+
+  int64_t num_blocks = (arr->length() + kBlockSize - 1) / kBlockSize;
+  int64_t encoded_bytes =
+      num_blocks * sizeof(Block) + (std::min(for_bits, delta_bits) + 63) / 64 * sizeof(uint64_t);
+  int64_t plain_bytes = arr->length() * sizeof(int64_t);
+  if (4 * encoded_bytes > 3 * plain_bytes) {
+    return nullptr;
+  }
+  return Encode(arr, type, codec);
+}
+
+uint64_t EncodedInt64Column::UnpackBits(uint64_t bit_pos, uint8_t bit_width) const {
+  if (bit_width == 0) {
+    return 0;
+  }
+  size_t word_idx = bit_pos / 64;
+  size_t shift = bit_pos % 64;
+  uint64_t value = packed_[word_idx] >> shift;
+  if (shift + bit_width > 64) {
+    value |= packed_[word_idx + 1] << (64 - shift);
+  }
+  if (bit_width == 64) {
+    return value;
+  }
+  return value & ((uint64_t{1} << bit_width) - 1);
+}
+
+void EncodedInt64Column::DecodeBlock(int64_t block_idx, int64_t start, int64_t end,
+                                     int64_t* out) const {
+  const auto& block = blocks_[block_idx];
+  if (codec_ == Codec::kFrameOfReference) {
+    for (int64_t i = start; i < end; ++i) {
+      *out++ = static_cast<int64_t>(block.reference +
+                                    UnpackBits(block.bit_offset + i * block.bit_width,
+                                               block.bit_width));
+    }
+    return;
+  }
+  // Deltas have to be accumulated from the start of the block, even if the first rows aren't
+  // requested.
+  auto value = static_cast<uint64_t>(block.first);
+  if (start == 0) {
+    *out++ = block.first;
+  }
+  for (int64_t i = 1; i < end; ++i) {
+    value += block.reference +
+             UnpackBits(block.bit_offset + (i - 1) * block.bit_width, block.bit_width);
+    if (i >= start) {
+      *out++ = static_cast<int64_t>(value);
+    }
+  }
+}
+
+int64_t EncodedInt64Column::Value(int64_t row_idx) const {
+  DCHECK_LT(row_idx, length_);
+  auto block_idx = row_idx / kBlockSize;
+  auto block_row = row_idx % kBlockSize;
+  int64_t value;
+  DecodeBlock(block_idx, block_row, block_row + 1, &value);
+  return value;
+}
+
+StatusOr<ArrowArrayPtr> EncodedInt64Column::DecodeSlice(int64_t offset, int64_t length,
+                                                        arrow::MemoryPool* mem_pool) const {
+  DCHECK_LE(offset + length, length_);
+  std::shared_ptr<arrow::Buffer> buffer;
+  PX_RETURN_IF_ERROR(arrow::AllocateBuffer(mem_pool, length * sizeof(int64_t), &buffer));
+  auto* out = reinterpret_cast<int64_t*>(buffer->mutable_data());
+  for (int64_t row = offset; row < offset + length;) {
+    auto block_idx = row / kBlockSize;
+    auto block_start = row % kBlockSize;
+    auto block_end = std::min(kBlockSize, offset + length - block_idx * kBlockSize);
+    DecodeBlock(block_idx, block_start, block_end, out);
+    out += block_end - block_start;
+    row += block_end - block_start;
+  }
+  std::shared_ptr<arrow::DataType> type;
+  switch (data_type_) {
+    case types::DataType::INT64:
+      type = types::GetArrowBuilder<types::DataType::INT64>(mem_pool)->type();
+      break;
+    case types::DataType::TIME64NS:
+      type = types::GetArrowBuilder<types::DataType::TIME64NS>(mem_pool)->type();
+      break;
+    default:
+      return error::Internal("Unexpected data type for EncodedInt64Column: $0",
+                             magic_enum::enum_name(data_type_));
+  }
+  std::vector<std::shared_ptr<arrow::Buffer>> buffers = {nullptr, std::move(buffer)};
+  return arrow::MakeArray(
+      arrow::ArrayData::Make(std::move(type), length, std::move(buffers), /*null_count*/ 0));
+}
+
+int64_t EncodedInt64Column::Bytes() const {
+  return blocks_.size() * sizeof(Block) + packed_.size() * sizeof(uint64_t);
+}
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
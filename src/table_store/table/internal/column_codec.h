@@ -0,0 +1,138 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <arrow/array.h>
+#include <arrow/memory_pool.h>
+
+#include <memory>
+#include <vector>
+
+#include "src/common/base/base.h"
+#include "src/shared/types/types.h"
+#include "src/table_store/table/internal/types.h"
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+/**
+ * EncodedInt64Column is a compressed, immutable representation of an INT64 or TIME64NS column.
+ *
+ * The column is split into blocks of kBlockSize rows, and each block is bit-packed with the
+ * smallest bit width that fits the block, using one of two codecs:
+ *  - kFrameOfReference stores each value as an offset from the minimum value of the block.
+ *  - kDelta stores each value as the difference to the previous value, itself stored as an offset
+ *    from the minimum difference in the block. This is a good fit for sorted columns such as
+ *    `time_`: with evenly spaced values the differences are constant, and the block packs down to
+ *    zero bits per row.
+ *
+ * Every block stores its first value in full, so random access (`Value`) only has to decode within
+ * a single block.
+ */
+class EncodedInt64Column {
+ public:
+  enum class Codec {
+    kFrameOfReference,
+    kDelta,
+  };
+
+  static constexpr int64_t kBlockSize = 128;
+
+  /**
+   * Encode compresses the given INT64 or TIME64NS arrow array with the given codec.
+   * @param arr, the array to encode.
+   * @param type, the DataType of the array.
+   * @param codec, which codec to use.
+   * @return the encoded column.
+   */
+  static std::unique_ptr<EncodedInt64Column> Encode(const arrow::Array* arr, types::DataType type,
+                                                    Codec codec);
+
+  /**
+   * MaybeEncode compresses the given INT64 or TIME64NS arrow array with whichever codec produces
+   * the smaller output, if that reduces the size of the column by at least a quarter.
+   * @param arr, the array to encode.
+   * @param type, the DataType of the array.
+   * @return the encoded column, or nullptr if the column is not worth encoding.
+   */
+  static std::unique_ptr<EncodedInt64Column> MaybeEncode(const arrow::Array* arr,
+                                                         types::DataType type);
+
+  int64_t length() const { return length_; }
+  Codec codec() const { return codec_; }
+  types::DataType data_type() const { return data_type_; }
+  // The minimum and maximum value of the column, recorded when it's encoded so that zone maps don't
+  // have to decode the column.
+  int64_t min() const { return min_; }
+  int64_t max() const { return max_; }
+
+  /**
+   * Value returns the value at the given row.
+   * @param row_idx, index of the row to decode.
+   * @return the decoded value.
+   */
+  int64_t Value(int64_t row_idx) const;
+
+  /**
+   * DecodeSlice decompresses a slice of the column into a plain arrow array. The rows are decoded
+   * straight into the array's buffer.
+   * @param offset, the first row to decode.
+   * @param length, the number of rows to decode.
+   * @param mem_pool, the memory pool to allocate the decoded array from.
+   * @return the decoded arrow array, of the same type as the array that was encoded.
+   */
+  StatusOr<ArrowArrayPtr> DecodeSlice(int64_t offset, int64_t length,
+                                      arrow::MemoryPool* mem_pool) const;
+
+  /**
+   * @return the number of bytes used by the encoded column.
+   */
+  int64_t Bytes() const;
+
+ private:
+  struct Block {
+    // The first value of the block, stored in full.
+    int64_t first;
+    // The minimum value (kFrameOfReference) or the minimum difference (kDelta) of the block.
+    uint64_t reference;
+    // Bit offset of the block's packed values within `packed_`.
+    uint64_t bit_offset;
+    uint8_t bit_width;
+  };
+
+  EncodedInt64Column(types::DataType data_type, Codec codec, int64_t length)
+      : data_type_(data_type), codec_(codec), length_(length) {}
+
+  // Decodes the values of rows [start, end) within the given block into `out`.
+  void DecodeBlock(int64_t block_idx, int64_t start, int64_t end, int64_t* out) const;
+  uint64_t UnpackBits(uint64_t bit_pos, uint8_t bit_width) const;
+
+  const types::DataType data_type_;
+  const Codec codec_;
+  const int64_t length_;
+  int64_t min_ = 0;
+  int64_t max_ = 0;
+  std::vector<Block> blocks_;
+  std::vector<uint64_t> packed_;
+};
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
@@ -0,0 +1,114 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "src/common/testing/testing.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/table_store/table/internal/column_codec.h"
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+using Codec = EncodedInt64Column::Codec;
+
+class EncodedInt64ColumnTest : public ::testing::TestWithParam<Codec> {};
+
+TEST_P(EncodedInt64ColumnTest, RoundTrip) {
+  std::mt19937_64 gen(37);
+  std::uniform_int_distribution<int64_t> dist(-1000, 1000);
+  std::vector<types::Int64Value> vals;
+  // Use a length that isn't a multiple of the block size, to test the partial last block.
+  for (int64_t i = 0; i < 3 * EncodedInt64Column::kBlockSize + 17; ++i) {
+    vals.push_back(dist(gen));
+  }
+  // Include the extremes, to make sure wrapping differences are handled.
+  vals[5] = std::numeric_limits<int64_t>::min();
+  vals[6] = std::numeric_limits<int64_t>::max();
+  auto arr = types::ToArrow(vals, arrow::default_memory_pool());
+
+  auto encoded = EncodedInt64Column::Encode(arr.get(), types::DataType::INT64, GetParam());
+  ASSERT_EQ(arr->length(), encoded->length());
+  EXPECT_EQ(std::numeric_limits<int64_t>::min(), encoded->min());
+  EXPECT_EQ(std::numeric_limits<int64_t>::max(), encoded->max());
+  for (int64_t i = 0; i < arr->length(); ++i) {
+    EXPECT_EQ(vals[i].val, encoded->Value(i));
+  }
+
+  ASSERT_OK_AND_ASSIGN(auto decoded,
+                       encoded->DecodeSlice(0, arr->length(), arrow::default_memory_pool()));
+  EXPECT_TRUE(decoded->Equals(arr));
+
+  // Slices that start and end in the middle of blocks.
+  ASSERT_OK_AND_ASSIGN(auto slice, encoded->DecodeSlice(100, 200, arrow::default_memory_pool()));
+  EXPECT_TRUE(slice->Equals(arr->Slice(100, 200)));
+}
+
+INSTANTIATE_TEST_SUITE_P(Codecs, EncodedInt64ColumnTest,
+                         ::testing::Values(Codec::kFrameOfReference, Codec::kDelta));
+
+TEST(EncodedInt64ColumnTest, EvenlySpacedTimesUseDelta) {
+  std::vector<types::Time64NSValue> times;
+  for (int64_t i = 0; i < 1000; ++i) {
+    times.push_back(1600000000000000000 + 1000 * i);
+  }
+  auto arr = types::ToArrow(times, arrow::default_memory_pool());
+
+  auto encoded = EncodedInt64Column::MaybeEncode(arr.get(), types::DataType::TIME64NS);
+  ASSERT_NE(nullptr, encoded);
+  EXPECT_EQ(Codec::kDelta, encoded->codec());
+  // Constant differences pack down to zero bits, leaving just the per block headers.
+  EXPECT_LT(encoded->Bytes(), 1000);
+
+  ASSERT_OK_AND_ASSIGN(auto decoded,
+                       encoded->DecodeSlice(0, arr->length(), arrow::default_memory_pool()));
+  EXPECT_EQ(arrow::Type::TIME64, decoded->type_id());
+  EXPECT_TRUE(decoded->Equals(arr));
+}
+
+TEST(EncodedInt64ColumnTest, SmallRangeUsesFrameOfReference) {
+  std::vector<types::Int64Value> vals;
+  for (int64_t i = 0; i < 1000; ++i) {
+    vals.push_back(200 + (i * 7919) % 100);
+  }
+  auto arr = types::ToArrow(vals, arrow::default_memory_pool());
+
+  auto encoded = EncodedInt64Column::MaybeEncode(arr.get(), types::DataType::INT64);
+  ASSERT_NE(nullptr, encoded);
+  EXPECT_EQ(Codec::kFrameOfReference, encoded->codec());
+  ASSERT_OK_AND_ASSIGN(auto decoded,
+                       encoded->DecodeSlice(0, arr->length(), arrow::default_memory_pool()));
+  EXPECT_TRUE(decoded->Equals(arr));
+}
+
+TEST(EncodedInt64ColumnTest, SkipsIncompressible) {
+  std::mt19937_64 gen(37);
+  std::vector<types::Int64Value> vals;
+  for (int64_t i = 0; i < 1000; ++i) {
+    vals.push_back(static_cast<int64_t>(gen()));
+  }
+  auto arr = types::ToArrow(vals, arrow::default_memory_pool());
+  EXPECT_EQ(nullptr, EncodedInt64Column::MaybeEncode(arr.get(), types::DataType::INT64));
+}
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
@@ -0,0 +1,267 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <arrow/array.h>
+#include <arrow/buffer.h>
+
+#include <memory>
+#include <numeric>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <absl/strings/substitute.h>
+
+#include "src/table_store/table/internal/disk_batch.h"
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+/**
+ * MappedSegment owns a read-only memory mapping of a whole segment file.
+ */
+class MappedSegment {
+ public:
+  static StatusOr<std::shared_ptr<MappedSegment>> Map(const std::filesystem::path& path,
+                                                      int64_t size) {
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+      return error::Internal("Failed to open segment $0. errno $1.", path.string(), errno);
+    }
+    void* data = mmap(/*addr*/ nullptr, size, PROT_READ, MAP_SHARED, fd, /*offset*/ 0);
+    // The mapping stays valid after the file descriptor is closed.
+    close(fd);
+    if (data == MAP_FAILED) {
+      return error::Internal("Failed to map segment $0. errno $1.", path.string(), errno);
+    }
+    return std::shared_ptr<MappedSegment>(new MappedSegment(static_cast<uint8_t*>(data), size));
+  }
+
+  ~MappedSegment() { munmap(data_, size_); }
+
+  const uint8_t* data() const { return data_; }
+
+ private:
+  MappedSegment(uint8_t* data, int64_t size) : data_(data), size_(size) {}
+
+  uint8_t* data_;
+  int64_t size_;
+};
+
+namespace {
+
+/**
+ * MappedBuffer is an arrow::Buffer that points into a MappedSegment, and keeps the mapping alive.
+ */
+class MappedBuffer : public arrow::Buffer {
+ public:
+  MappedBuffer(std::shared_ptr<MappedSegment> segment, int64_t offset, int64_t size)
+      : arrow::Buffer(segment->data() + offset, size), segment_(std::move(segment)) {}
+
+ private:
+  std::shared_ptr<MappedSegment> segment_;
+};
+
+Status WriteAll(int fd, const uint8_t* data, int64_t size, const std::filesystem::path& path) {
+  while (size > 0) {
+    auto written = write(fd, data, size);
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return error::Internal("Failed to write segment $0. errno $1.", path.string(), errno);
+    }
+    data += written;
+    size -= written;
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
+StatusOr<DiskBatch> DiskBatch::Spill(const ColdBatch& batch, const schema::Relation& rel,
+                                     int64_t time_col_idx, const std::filesystem::path& path) {
+  DiskBatch disk_batch;
+  disk_batch.length_ = batch.Length();
+
+  // Decode the whole batch, so that the segment only holds plain arrow buffers.
+  std::vector<int64_t> cols(rel.NumColumns());
+  std::iota(cols.begin(), cols.end(), 0);
+  schema::RowBatch rb(schema::RowDescriptor(rel.col_types()), batch.Length());
+  PX_RETURN_IF_ERROR(batch.AddBatchSliceToRowBatch(0, batch.Length(), cols, &rb));
+  PX_ASSIGN_OR_RETURN(auto decoded_rb, rb.DecodeDictionaryColumns(arrow::default_memory_pool()));
+
+  int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+  if (fd < 0) {
+    return error::Internal("Failed to create segment $0. errno $1.", path.string(), errno);
+  }
+  // From here on, the DiskBatch owns the file and deletes it if spilling fails.
+  disk_batch.path_ = path;
+
+  const std::vector<uint8_t> padding(kSegmentAlignment, 0);
+  int64_t file_offset = 0;
+  Status s;
+  for (size_t col_idx = 0; col_idx < rel.NumColumns() && s.ok(); ++col_idx) {
+    const auto& arr = decoded_rb->ColumnAt(col_idx);
+    auto col_type = rel.col_types()[col_idx];
+    disk_batch.zone_map_.push_back(SupportsZoneMap(col_type)
+                                       ? ComputeArrowArrayZoneMap(arr.get(), col_type)
+                                       : ColumnZoneMap{});
+    if (static_cast<int64_t>(col_idx) == time_col_idx) {
+      disk_batch.time_column_ = EncodedInt64Column::Encode(arr.get(), col_type,
+                                                           EncodedInt64Column::Codec::kDelta);
+    }
+
+    ColumnLayout layout{arr->type(), arr->null_count(), arr->offset(), {}};
+    for (const auto& buffer : arr->data()->buffers) {
+      if (buffer == nullptr) {
+        layout.buffers.push_back(BufferLayout{-1, 0});
+        continue;
+      }
+      layout.buffers.push_back(BufferLayout{file_offset, buffer->size()});
+      s = WriteAll(fd, buffer->data(), buffer->size(), path);
+      if (!s.ok()) {
+        break;
+      }
+      auto padded_size = (buffer->size() + kSegmentAlignment - 1) / kSegmentAlignment *
+                         kSegmentAlignment;
+      s = WriteAll(fd, padding.data(), padded_size - buffer->size(), path);
+      file_offset += padded_size;
+      if (!s.ok()) {
+        break;
+      }
+    }
+    disk_batch.columns_.push_back(std::move(layout));
+  }
+  if (close(fd) != 0 && s.ok()) {
+    s = error::Internal("Failed to close segment $0. errno $1.", path.string(), errno);
+  }
+  PX_RETURN_IF_ERROR(s);
+  disk_batch.file_bytes_ = file_offset;
+  return disk_batch;
+}
+
+DiskBatch::DiskBatch(DiskBatch&& other) noexcept { *this = std::move(other); }
+
+DiskBatch& DiskBatch::operator=(DiskBatch&& other) noexcept {
+  if (this == &other) {
+    return *this;
+  }
+  RemoveSegment();
+  path_ = std::exchange(other.path_, std::filesystem::path());
+  length_ = other.length_;
+  file_bytes_ = other.file_bytes_;
+  columns_ = std::move(other.columns_);
+  zone_map_ = std::move(other.zone_map_);
+  time_column_ = std::move(other.time_column_);
+  segment_ = std::move(other.segment_);
+  return *this;
+}
+
+DiskBatch::~DiskBatch() { RemoveSegment(); }
+
+void DiskBatch::RemoveSegment() {
+  if (path_.empty()) {
+    return;
+  }
+  std::error_code ec;
+  std::filesystem::remove(path_, ec);
+  LOG_IF(WARNING, ec) << absl::Substitute("Failed to remove segment $0: $1", path_.string(),
+                                          ec.message());
+  path_.clear();
+}
+
+int64_t DiskBatch::FindTimeFirstGreaterThanOrEqual(int64_t, Time time) const {
+  DCHECK(time_column_ != nullptr);
+  int64_t lo = 0;
+  int64_t hi = length_;
+  while (lo < hi) {
+    int64_t mid = lo + (hi - lo) / 2;
+    if (time_column_->Value(mid) < time) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo == static_cast<int64_t>(length_) ? -1 : lo;
+}
+
+int64_t DiskBatch::FindTimeFirstGreaterThan(int64_t, Time time) const {
+  DCHECK(time_column_ != nullptr);
+  int64_t lo = 0;
+  int64_t hi = length_;
+  while (lo < hi) {
+    int64_t mid = lo + (hi - lo) / 2;
+    if (time_column_->Value(mid) <= time) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+
+Time DiskBatch::GetTimeValue(int64_t, int64_t row_idx) const {
+  DCHECK(time_column_ != nullptr);
+  return time_column_->Value(row_idx);
+}
+
+StatusOr<std::shared_ptr<MappedSegment>> DiskBatch::Segment() const {
+  auto segment = std::atomic_load(&segment_);
+  if (segment == nullptr) {
+    // Two readers might both map the segment, in which case the last one wins.
+    PX_ASSIGN_OR_RETURN(segment, MappedSegment::Map(path_, file_bytes_));
+    std::atomic_store(&segment_, segment);
+  }
+  return segment;
+}
+
+Status DiskBatch::AddBatchSliceToRowBatch(size_t row_start, size_t batch_size,
+                                          const std::vector<int64_t>& cols,
+                                          schema::RowBatch* output_rb,
+                                          arrow::MemoryPool* /*mem_pool*/) const {
+  std::shared_ptr<MappedSegment> segment;
+  if (file_bytes_ > 0) {
+    PX_ASSIGN_OR_RETURN(segment, Segment());
+  }
+  for (auto col_idx : cols) {
+    const auto& layout = columns_[col_idx];
+    std::vector<std::shared_ptr<arrow::Buffer>> buffers;
+    for (const auto& buffer_layout : layout.buffers) {
+      if (buffer_layout.file_offset < 0) {
+        buffers.push_back(nullptr);
+        continue;
+      }
+      buffers.push_back(
+          std::make_shared<MappedBuffer>(segment, buffer_layout.file_offset, buffer_layout.size));
+    }
+    auto data = arrow::ArrayData::Make(layout.type, length_, std::move(buffers), layout.null_count,
+                                       layout.array_offset);
+    PX_RETURN_IF_ERROR(output_rb->AddColumn(arrow::MakeArray(data)->Slice(row_start, batch_size)));
+  }
+  return Status::OK();
+}
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
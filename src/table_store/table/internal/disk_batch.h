@@ -0,0 +1,134 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <arrow/type.h>
+
+#include <filesystem>
+#include <memory>
+#include <vector>
+
+#include "src/table_store/schema/relation.h"
+#include "src/table_store/schema/row_batch.h"
+#include "src/table_store/table/internal/cold_batch.h"
+#include "src/table_store/table/internal/column_codec.h"
+#include "src/table_store/table/internal/types.h"
+#include "src/table_store/table/internal/zone_map.h"
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+class MappedSegment;
+
+/**
+ * DiskBatch is a batch that was spilled from the cold store to a segment file on local disk.
+ *
+ * The segment file holds the raw arrow buffers of every column (decoded, ie. without dictionary
+ * encoding or integer compression), each aligned to kSegmentAlignment bytes. The layout of the
+ * buffers is kept in memory, together with the batch's zone maps and a delta-compressed copy of
+ * the time column. So time lookups and batch pruning never touch the disk.
+ *
+ * The first read memory maps the segment, and all reads wrap the mapped buffers in arrow arrays
+ * without copying. The mapping stays alive for as long as the DiskBatch or any of the returned
+ * arrays reference it. The segment file is deleted when the DiskBatch is destroyed.
+ *
+ * The interface mirrors that of `ColdBatch`, so that `StoreWithRowTimeAccounting` can treat disk
+ * batches like any other batch.
+ */
+class DiskBatch {
+ public:
+  static constexpr int64_t kSegmentAlignment = 64;
+
+  /**
+   * Spill writes the given cold batch to a segment file at the given path.
+   * @param batch, the cold batch to spill.
+   * @param rel, the relation of the table the batch belongs to.
+   * @param time_col_idx, index of the time column, or -1 if the table has no time column.
+   * @param path, the path of the segment file to create.
+   * @return the DiskBatch backed by the new segment file.
+   */
+  static StatusOr<DiskBatch> Spill(const ColdBatch& batch, const schema::Relation& rel,
+                                   int64_t time_col_idx, const std::filesystem::path& path);
+
+  // A default constructed DiskBatch is empty and doesn't own a segment file.
+  DiskBatch() = default;
+  // A moved from DiskBatch no longer owns the segment file, so it won't delete it.
+  DiskBatch(DiskBatch&& other) noexcept;
+  DiskBatch& operator=(DiskBatch&& other) noexcept;
+  ~DiskBatch();
+
+  size_t Length() const { return length_; }
+  int64_t FindTimeFirstGreaterThanOrEqual(int64_t time_col_idx, Time time) const;
+  int64_t FindTimeFirstGreaterThan(int64_t time_col_idx, Time time) const;
+  Time GetTimeValue(int64_t time_col_idx, int64_t row_idx) const;
+  /**
+   * AddBatchSliceToRowBatch adds zero-copy slices of the requested columns of the (memory mapped)
+   * segment file to the given output schema::RowBatch.
+   * @param row_start, row index within this batch to start the output slice at.
+   * @param batch_size, size of the output slice.
+   * @param cols, a vector of column indices to include in the output slice.
+   * @param output_rb, a pointer to the row batch to add the columns to.
+   * @param mem_pool, unused since nothing is copied. Mirrors ColdBatch.
+   * @return Status, errors if the segment can't be mapped or adding columns fails.
+   */
+  Status AddBatchSliceToRowBatch(size_t row_start, size_t batch_size,
+                                 const std::vector<int64_t>& cols, schema::RowBatch* output_rb,
+                                 arrow::MemoryPool* mem_pool = arrow::default_memory_pool()) const;
+  ColumnZoneMap GetColumnZoneMap(int64_t col_idx, types::DataType) const {
+    return zone_map_[col_idx];
+  }
+
+  /**
+   * @return the size of the segment file in bytes.
+   */
+  int64_t FileBytes() const { return file_bytes_; }
+
+ private:
+  struct BufferLayout {
+    // Offset of the buffer within the segment file, or -1 if the buffer is null.
+    int64_t file_offset;
+    int64_t size;
+  };
+  struct ColumnLayout {
+    std::shared_ptr<arrow::DataType> type;
+    int64_t null_count;
+    int64_t array_offset;
+    std::vector<BufferLayout> buffers;
+  };
+
+  void RemoveSegment();
+  // Returns the mapping of the segment file, and maps it if this is the first read.
+  StatusOr<std::shared_ptr<MappedSegment>> Segment() const;
+
+  // Empty if the DiskBatch doesn't own a segment file.
+  std::filesystem::path path_;
+  size_t length_ = 0;
+  int64_t file_bytes_ = 0;
+  std::vector<ColumnLayout> columns_;
+  BatchZoneMap zone_map_;
+  std::unique_ptr<EncodedInt64Column> time_column_;
+  // Readers may map the segment concurrently, so this is only accessed with
+  // std::atomic_load/std::atomic_store. nullptr until the first read.
+  mutable std::shared_ptr<MappedSegment> segment_;
+};
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
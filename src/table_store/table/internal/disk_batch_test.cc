@@ -0,0 +1,132 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "src/common/testing/testing.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/table_store/table/internal/disk_batch.h"
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+class DiskBatchTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    rel_ = std::make_unique<schema::Relation>(
+        std::vector<types::DataType>{types::DataType::TIME64NS, types::DataType::INT64,
+                                     types::DataType::STRING, types::DataType::BOOLEAN},
+        std::vector<std::string>{"time_", "col1", "col2", "col3"});
+    for (int64_t i = 0; i < kNumRows; ++i) {
+      // Every time is repeated twice, to test searching with duplicate times.
+      times_.push_back(100 + 10 * (i / 2));
+      ints_.push_back(i % 5);
+      strings_.push_back(i % 2 == 0 ? "even" : "odd");
+      bools_.push_back(i % 3 == 0);
+    }
+  }
+
+  ColdBatch MakeColdBatch() {
+    return ColdBatch(std::vector<ArrowArrayPtr>{
+        types::ToArrow(times_, arrow::default_memory_pool()),
+        types::ToArrow(ints_, arrow::default_memory_pool()),
+        types::ToArrow(strings_, arrow::default_memory_pool()),
+        types::ToArrow(bools_, arrow::default_memory_pool())});
+  }
+
+  static constexpr int64_t kNumRows = 1000;
+  px::testing::TempDir spill_dir_;
+  std::unique_ptr<schema::Relation> rel_;
+  std::vector<types::Time64NSValue> times_;
+  std::vector<types::Int64Value> ints_;
+  std::vector<types::StringValue> strings_;
+  std::vector<types::BoolValue> bools_;
+};
+
+TEST_F(DiskBatchTest, SpillAndRead) {
+  auto cold_batch = MakeColdBatch();
+  // Spilled batches are stored decoded, so compressed columns have to round trip as well.
+  ASSERT_GT(cold_batch.CompressIntegerColumns(*rel_), 0);
+  auto path = spill_dir_.path() / "0.seg";
+  ASSERT_OK_AND_ASSIGN(auto disk_batch, DiskBatch::Spill(cold_batch, *rel_, 0, path));
+  EXPECT_EQ(kNumRows, static_cast<int64_t>(disk_batch.Length()));
+  EXPECT_EQ(static_cast<int64_t>(std::filesystem::file_size(path)), disk_batch.FileBytes());
+  EXPECT_EQ(0, disk_batch.FileBytes() % DiskBatch::kSegmentAlignment);
+
+  schema::RowBatch rb(schema::RowDescriptor(rel_->col_types()), 300);
+  ASSERT_OK(disk_batch.AddBatchSliceToRowBatch(250, 300, {0, 1, 2, 3}, &rb));
+  EXPECT_TRUE(rb.ColumnAt(0)->Equals(
+      types::ToArrow(times_, arrow::default_memory_pool())->Slice(250, 300)));
+  EXPECT_TRUE(rb.ColumnAt(1)->Equals(
+      types::ToArrow(ints_, arrow::default_memory_pool())->Slice(250, 300)));
+  EXPECT_TRUE(rb.ColumnAt(2)->Equals(
+      types::ToArrow(strings_, arrow::default_memory_pool())->Slice(250, 300)));
+  EXPECT_TRUE(rb.ColumnAt(3)->Equals(
+      types::ToArrow(bools_, arrow::default_memory_pool())->Slice(250, 300)));
+}
+
+TEST_F(DiskBatchTest, TimeSearchAndZoneMaps) {
+  auto cold_batch = MakeColdBatch();
+  ASSERT_OK_AND_ASSIGN(auto disk_batch,
+                       DiskBatch::Spill(cold_batch, *rel_, 0, spill_dir_.path() / "0.seg"));
+
+  // The spilled batch should behave exactly like the cold batch it was spilled from.
+  for (Time time : std::vector<Time>{0, 100, 105, 110, 2000, 5090, 6000}) {
+    EXPECT_EQ(cold_batch.FindTimeFirstGreaterThanOrEqual(0, time),
+              disk_batch.FindTimeFirstGreaterThanOrEqual(0, time))
+        << time;
+    EXPECT_EQ(cold_batch.FindTimeFirstGreaterThan(0, time),
+              disk_batch.FindTimeFirstGreaterThan(0, time))
+        << time;
+  }
+  EXPECT_EQ(100, disk_batch.GetTimeValue(0, 0));
+  EXPECT_EQ(100 + 10 * 499, disk_batch.GetTimeValue(0, kNumRows - 1));
+
+  auto zone_map = disk_batch.GetColumnZoneMap(1, types::DataType::INT64);
+  ASSERT_TRUE(zone_map.valid);
+  EXPECT_EQ(0, std::get<int64_t>(zone_map.min));
+  EXPECT_EQ(4, std::get<int64_t>(zone_map.max));
+}
+
+TEST_F(DiskBatchTest, SegmentOutlivesReadsButNotBatch) {
+  auto path = spill_dir_.path() / "0.seg";
+  ArrowArrayPtr strings;
+  {
+    ASSERT_OK_AND_ASSIGN(auto disk_batch, DiskBatch::Spill(MakeColdBatch(), *rel_, 0, path));
+    // Moving the batch must not delete the segment.
+    auto moved_batch = std::move(disk_batch);
+    EXPECT_TRUE(std::filesystem::exists(path));
+
+    schema::RowBatch rb(schema::RowDescriptor({types::DataType::STRING}), kNumRows);
+    ASSERT_OK(moved_batch.AddBatchSliceToRowBatch(0, kNumRows, {2}, &rb));
+    strings = rb.ColumnAt(0);
+  }
+  // The segment is deleted with the batch, but arrays that were read from it stay valid, since
+  // they keep the mapping alive.
+  EXPECT_FALSE(std::filesystem::exists(path));
+  EXPECT_TRUE(strings->Equals(types::ToArrow(strings_, arrow::default_memory_pool())));
+}
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
@@ -16,6 +16,9 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <atomic>
+#include <memory>
+#include <utility>
 #include <vector>
 
 #include "src/common/base/utils.h"
@@ -105,25 +108,47 @@ Time RecordOrRowBatch::GetTimeValue(int64_t time_col_idx, int64_t row_idx) const
 
 void RecordOrRowBatch::RemovePrefix(size_t num_rows) { row_offset_ += num_rows; }
 
+RecordOrRowBatch RecordOrRowBatch::ShallowCopy() const {
+  auto copy = std::visit(
+      overloaded{
+          [](const RecordBatchWithCache& record_batch_w_cache) {
+            RecordBatchWithCache copy_w_cache{
+                std::make_unique<types::ColumnWrapperRecordBatch>(
+                    *record_batch_w_cache.record_batch),
+                std::vector<ArrowArrayPtr>(record_batch_w_cache.arrow_cache.size()),
+            };
+            for (const auto& [col_idx, arr] : Enumerate(record_batch_w_cache.arrow_cache)) {
+              copy_w_cache.arrow_cache[col_idx] = std::atomic_load(&arr);
+            }
+            return RecordOrRowBatch(std::move(copy_w_cache));
+          },
+          [](const schema::RowBatch& row_batch) { return RecordOrRowBatch(row_batch); },
+      },
+      batch_);
+  copy.row_offset_ = row_offset_;
+  return copy;
+}
+
 Status RecordOrRowBatch::AddBatchSliceToRowBatch(size_t row_start, size_t batch_size,
                                                  const std::vector<int64_t>& cols,
-                                                 schema::RowBatch* output_rb) const {
+                                                 schema::RowBatch* output_rb,
+                                                 arrow::MemoryPool* /*mem_pool*/) const {
   row_start += row_offset_;
   return std::visit(
       overloaded{
           [row_start, batch_size, cols,
            output_rb](const RecordBatchWithCache& record_batch_w_cache) {
             for (auto col_idx : cols) {
-              if (!record_batch_w_cache.cache_validity[col_idx]) {
-                // Arrow array wasn't in cache, convert it to arrow and then add
-                // to cache.
-                auto arr = (*record_batch_w_cache.record_batch)[col_idx]->ConvertToArrow(
+              auto* cache_entry = &record_batch_w_cache.arrow_cache[col_idx];
+              auto cached = std::atomic_load(cache_entry);
+              if (cached == nullptr) {
+                // Arrow array wasn't in cache, convert it to arrow and then add to cache. Two
+                // readers might both convert the column, in which case the last one wins.
+                cached = (*record_batch_w_cache.record_batch)[col_idx]->ConvertToArrow(
                     arrow::default_memory_pool());
-                record_batch_w_cache.arrow_cache[col_idx] = arr;
-                record_batch_w_cache.cache_validity[col_idx] = true;
+                std::atomic_store(cache_entry, cached);
               }
-              auto arr = record_batch_w_cache.arrow_cache[col_idx]->Slice(row_start, batch_size);
-              PX_RETURN_IF_ERROR(output_rb->AddColumn(arr));
+              PX_RETURN_IF_ERROR(output_rb->AddColumn(cached->Slice(row_start, batch_size)));
             }
             return Status::OK();
           },
@@ -192,6 +217,26 @@ std::vector<uint64_t> RecordOrRowBatch::GetVariableSizedColumnRowBytes(size_t co
   return rows_bytes;
 }
 
+ColumnZoneMap RecordOrRowBatch::GetColumnZoneMap(int64_t col_idx,
+                                                 types::DataType col_data_type) const {
+  if (!SupportsZoneMap(col_data_type)) {
+    return ColumnZoneMap{};
+  }
+  return std::visit(
+      overloaded{
+          [this, col_idx, col_data_type](const RecordBatchWithCache& record_batch_w_cache) {
+            const auto& record_batch = *record_batch_w_cache.record_batch;
+            return ComputeColumnWrapperZoneMap(record_batch[col_idx].get(), col_data_type,
+                                               row_offset_);
+          },
+          [this, col_idx, col_data_type](const schema::RowBatch& row_batch) {
+            auto arr = row_batch.ColumnAt(col_idx)->Slice(row_offset_);
+            return ComputeArrowArrayZoneMap(arr.get(), col_data_type);
+          },
+      },
+      batch_);
+}
+
 }  // namespace internal
 }  // namespace table_store
 }  // namespace px
@@ -24,6 +24,7 @@
 
 #include "src/table_store/schema/row_batch.h"
 #include "src/table_store/table/internal/types.h"
+#include "src/table_store/table/internal/zone_map.h"
 
 namespace px {
 namespace table_store {
@@ -48,6 +49,13 @@ class RecordOrRowBatch {
 
   RecordOrRowBatch(RecordOrRowBatch&&) = default;
 
+  /**
+   * ShallowCopy returns a copy of this record or row batch that shares the underlying column data
+   * (and already converted arrow arrays) with this batch.
+   * @return the copied batch.
+   */
+  RecordOrRowBatch ShallowCopy() const;
+
   /**
    * Length returns the number of rows in this record or row batch.
    * @return number of rows.
@@ -89,16 +97,18 @@ class RecordOrRowBatch {
   void RemovePrefix(size_t num_rows_to_remove);
   /**
    * AddBatchSliceToRowBatch adds a slice of this record or row batch to the given output
-   * schema::RowBatch.
+   * schema::RowBatch. Safe to call concurrently from multiple threads.
    * @param row_start, row index within this batch to start the output slice at.
    * @param batch_size, size of the output slice.
    * @param cols, a vector of column indices to include in the output slice.
    * @param output_rb, a pointer to the row batch to add the columns to.
+   * @param mem_pool, unused: converted columns are cached and shared by all readers, so they are
+   * allocated from the default pool.
    * @return Status, errors if adding columns to the row batch fails.
    */
   Status AddBatchSliceToRowBatch(size_t row_start, size_t batch_size,
-                                 const std::vector<int64_t>& cols,
-                                 schema::RowBatch* output_rb) const;
+                                 const std::vector<int64_t>& cols, schema::RowBatch* output_rb,
+                                 arrow::MemoryPool* mem_pool = arrow::default_memory_pool()) const;
 
   /**
    * UnsafeAppendColumnToBuilder appends a slice of a column of this record or row batch to the
@@ -125,6 +135,15 @@ class RecordOrRowBatch {
    */
   std::vector<uint64_t> GetVariableSizedColumnRowBytes(size_t col_idx) const;
 
+  /**
+   * GetColumnZoneMap computes the min/max zone map of the given column, for all the rows in this
+   * batch (after `row_offset_`).
+   * @param col_idx, index of the column to compute the zone map for.
+   * @param col_data_type, the DataType of the column.
+   * @return zone map of the column, invalid if the column type doesn't support zone maps.
+   */
+  ColumnZoneMap GetColumnZoneMap(int64_t col_idx, types::DataType col_data_type) const;
+
  private:
   std::variant<RecordBatchWithCache, schema::RowBatch> batch_;
   int64_t row_offset_ = 0;
@@ -28,7 +28,10 @@
 #include "src/shared/types/arrow_adapter.h"
 #include "src/shared/types/column_wrapper.h"
 #include "src/table_store/schema/relation.h"
+#include "src/table_store/table/internal/cold_batch.h"
+#include "src/table_store/table/internal/disk_batch.h"
 #include "src/table_store/table/internal/types.h"
+#include "src/table_store/table/internal/zone_map.h"
 
 namespace px {
 namespace table_store {
@@ -53,19 +56,65 @@ void constexpr_else_static_assert_false() {
   static_assert(always_false, "constexpr else block reached");
 }
 
+/**
+ * PinnedBatchSlice is a slice of a single batch of a StoreWithRowTimeAccounting. It holds a
+ * reference to the batch, so the batch stays alive (and unchanged) even if it is expired or
+ * compacted out of the store. This allows the slice to be materialized into a RowBatch without
+ * holding the lock that protects the store.
+ */
+template <StoreType TStoreType>
+struct PinnedBatchSlice {
+  std::shared_ptr<const typename StoreTypeTraits<TStoreType>::batch_type> batch;
+  size_t row_offset;
+  size_t batch_size;
+
+  /**
+   * ToRowBatch copies (or, where possible, zero-copy slices) the pinned rows of the given columns
+   * into a new RowBatch.
+   * @param rel, the relation of the store the slice was pinned from.
+   * @param cols, a vector of column indices to include in the outputted row batch.
+   * @param mem_pool, the arrow MemoryPool that decoded columns are allocated from.
+   * @return a unique_ptr to the RowBatch, or an error Status.
+   */
+  StatusOr<std::unique_ptr<schema::RowBatch>> ToRowBatch(
+      const schema::Relation& rel, const std::vector<int64_t>& cols,
+      arrow::MemoryPool* mem_pool = arrow::default_memory_pool()) const {
+    // Get column types for row descriptor.
+    std::vector<types::DataType> col_types;
+    for (int64_t col_idx : cols) {
+      DCHECK(static_cast<size_t>(col_idx) < rel.NumColumns());
+      col_types.push_back(rel.col_types()[col_idx]);
+    }
+    auto output_rb =
+        std::make_unique<schema::RowBatch>(schema::RowDescriptor(col_types), batch_size);
+    PX_RETURN_IF_ERROR(
+        batch->AddBatchSliceToRowBatch(row_offset, batch_size, cols, output_rb.get(), mem_pool));
+    return output_rb;
+  }
+};
+
 /**
  * StoreWithRowTimeAccounting stores a deque of batches (hot or cold) and keeps track of the first
  * and last unique RowID's for each batch, as well as the first and last times for each batch (if
- * there is a time column in the table). The template parameter specifies whether this is the Hot or
- * Cold store. Since the logic between the Hot and Cold stores is roughly identical, this class
- * deduplicates that logic while allowing the explicit batch accesses to use the correct Hot or Cold
- * batch methods.
+ * there is a time column in the table). The template parameter specifies whether this is the Hot,
+ * Cold or Disk store. Since the logic between the stores is roughly identical, this class
+ * deduplicates that logic while allowing the explicit batch accesses to use the correct Hot, Cold
+ * or Disk batch methods.
  *
  * Times are used to find row batch's within a given time
  * range. RowIDs are used in case table compaction occurs during query execution. Since the size of
  * the batches changes when they are compacted from the hot store to the cold store, the unique
  * RowIDs are necessary to ensure that the query doesn't receive duplicate rows if the rows have
  * the same timestamp.
+ *
+ * Additionally, a zone map (the min and max value of each column that supports zone maps) is kept
+ * for every batch. The zone maps allow GetNextRowBatch to skip entire batches that can't match a
+ * set of simple column predicates, without touching the batch's data.
+ *
+ * Batches are reference counted, and are never modified in place once another reference to them
+ * exists (see `RemovePrefix`). So readers can pin a batch with `PinNextBatchSlice` while holding
+ * the store's lock, and then do the expensive work of converting or decoding the batch after
+ * releasing the lock, without blocking writers that append or expire batches in the meantime.
  */
 template <StoreType TStoreType>
 class StoreWithRowTimeAccounting {
@@ -76,26 +125,29 @@ class StoreWithRowTimeAccounting {
       : rel_(rel), time_col_idx_(time_col_idx) {}
 
   /**
-   * GetNextRowBatch returns the next row batch in this store after the given unique row id.
-   * @param last_read_row_id, pointer to the unique RowID of the last read row. The outputted batch
+   * PinNextBatchSlice finds the next slice of a batch in this store after the given unique row id,
+   * and pins the batch so that the slice can be read after the store's lock has been released.
+   * @param last_read_row_id, pointer to the unique RowID of the last read row. The outputted slice
    * should include only rows with a RowID greater than this RowID. After determining the output
-   * batch, this pointer is updated to point to the RowID of the last row in the outputted batch.
+   * slice, this pointer is updated to point to the RowID of the last row in the outputted slice.
    * @param hints, pointer to a BatchHints object (usually from a Table::Cursor), that provides a
    * hint to the store about which batch should be next. If the hint is correct, no searching for
    * the right batch is required, otherwise searching is performed as usual. This is purely an
    * optimization and passing a `nullptr` for hints is accepted.
-   * @param stop_row_id, an optional unique RowID to stop the batch at. If provided, the batch will
-   * be sliced such that no rows are included with `RowID >= stop_row_id.value()`.
-   * @param cols, a vector of column indices to include in the outputted row batch.
-   * @return a unique_ptr to the RowBatch or nullptr if there are no more rows in this store that
-   * match the parameters above. On error returns a Status.
+   * @param stop_row_id, an optional unique RowID to stop the slice at. If provided, the slice will
+   * be cut such that no rows are included with `RowID >= stop_row_id.value()`.
+   * @param predicates, a conjunction of column predicates. Batches whose zone maps prove that no
+   * row can match the predicates are skipped entirely, and `last_read_row_id` is advanced past
+   * them. Note that the rows of the returned slice are not filtered by the predicates.
+   * @return the pinned slice, or std::nullopt if there are no more rows in this store that match
+   * the parameters above.
    */
-  StatusOr<std::unique_ptr<schema::RowBatch>> GetNextRowBatch(
+  std::optional<PinnedBatchSlice<TStoreType>> PinNextBatchSlice(
       RowID* last_read_row_id, BatchHints* hints, std::optional<RowID> stop_row_id,
-      const std::vector<int64_t>& cols) const {
+      const std::vector<ColumnPredicate>& predicates = {}) const {
     auto start_row_id = *last_read_row_id + 1;
     if (batches_.empty() || start_row_id < FirstRowID() || start_row_id > LastRowID()) {
-      return std::unique_ptr<schema::RowBatch>(nullptr);
+      return std::nullopt;
     }
     if (DCHECK_IS_ON() && stop_row_id.has_value()) {
       DCHECK_LT(start_row_id, stop_row_id.value());
@@ -108,7 +160,21 @@ class StoreWithRowTimeAccounting {
       batch_id = FindBatchIDFromRowID(start_row_id);
     }
 
-    const auto& batch = GetBatchFromBatchID(batch_id);
+    while (!predicates.empty() && !BatchMayMatch(GetZoneMapFromBatchID(batch_id), predicates)) {
+      // None of the rows in this batch can match the predicates, so skip past the whole batch.
+      RowID skipped_last_row_id = BatchLastRowID(batch_id);
+      if (stop_row_id.has_value() && skipped_last_row_id >= stop_row_id.value() - 1) {
+        *last_read_row_id = stop_row_id.value() - 1;
+        return std::nullopt;
+      }
+      *last_read_row_id = skipped_last_row_id;
+      batch_id++;
+      if (batch_id > LastBatchID()) {
+        return std::nullopt;
+      }
+      start_row_id = *last_read_row_id + 1;
+    }
+
     RowID batch_first_row_id = BatchFirstRowID(batch_id);
     RowID batch_last_row_id = BatchLastRowID(batch_id);
     size_t row_offset = start_row_id - batch_first_row_id;
@@ -118,25 +184,36 @@ class StoreWithRowTimeAccounting {
       batch_size -= (batch_last_row_id - stop_row_id.value()) + 1;
     }
 
-    // Get column types for row descriptor.
-    std::vector<types::DataType> col_types;
-    for (int64_t col_idx : cols) {
-      DCHECK(static_cast<size_t>(col_idx) < rel_.NumColumns());
-      col_types.push_back(rel_.col_types()[col_idx]);
-    }
-    auto output_rb =
-        std::make_unique<schema::RowBatch>(schema::RowDescriptor(col_types), batch_size);
-    PX_RETURN_IF_ERROR(
-        AddBatchSliceToRowBatch(batch, row_offset, batch_size, cols, output_rb.get()));
-
     // Update the ptr to the last read row.
     *last_read_row_id = start_row_id + batch_size - 1;
 
     // Set hints to point to the next batch in the current store. It's fine if that batch doesn't
     // exist, as the next call will ignore the hints if that's the case.
-    hints->batch_id = batch_id + 1;
-    hints->hint_type = TStoreType;
-    return output_rb;
+    if (hints != nullptr) {
+      hints->batch_id = batch_id + 1;
+      hints->hint_type = TStoreType;
+    }
+    return PinnedBatchSlice<TStoreType>{batches_[batch_id - first_batch_id_], row_offset,
+                                        batch_size};
+  }
+
+  /**
+   * GetNextRowBatch returns the next row batch in this store after the given unique row id. It is
+   * equivalent to calling `PinNextBatchSlice` followed by `PinnedBatchSlice::ToRowBatch`, see
+   * `PinNextBatchSlice` for a description of the parameters.
+   * @param cols, a vector of column indices to include in the outputted row batch.
+   * @return a unique_ptr to the RowBatch or nullptr if there are no more rows in this store that
+   * match the parameters above. On error returns a Status.
+   */
+  StatusOr<std::unique_ptr<schema::RowBatch>> GetNextRowBatch(
+      RowID* last_read_row_id, BatchHints* hints, std::optional<RowID> stop_row_id,
+      const std::vector<int64_t>& cols,
+      const std::vector<ColumnPredicate>& predicates = {}) const {
+    auto slice = PinNextBatchSlice(last_read_row_id, hints, stop_row_id, predicates);
+    if (!slice.has_value()) {
+      return std::unique_ptr<schema::RowBatch>(nullptr);
+    }
+    return slice->ToRowBatch(rel_, cols);
   }
 
   /**
@@ -149,25 +226,48 @@ class StoreWithRowTimeAccounting {
    * front gets a reference to the first batch in the store.
    * @return reference to the first batch in the store.
    */
-  TBatch& front() {
+  const TBatch& front() const {
+    DCHECK(!batches_.empty());
+    return *batches_.front();
+  }
+
+  /**
+   * PinFront gets a reference counted pointer to the first batch in the store, which keeps the
+   * batch alive after it is removed from the store.
+   * @return pointer to the first batch in the store.
+   */
+  std::shared_ptr<const TBatch> PinFront() const {
     DCHECK(!batches_.empty());
     return batches_.front();
   }
 
   /**
-   * PopFront removes the first batch in the store, and returns an rvalue reference to it.
-   * @return rvalue reference to the removed batch.
+   * MoveFrontTo removes the first batch of this store, and appends it to the back of the given
+   * store without copying it. The batch keeps its RowIDs.
+   * @param other, the store to append the batch to.
    */
-  TBatch&& PopFront() {
+  void MoveFrontTo(StoreWithRowTimeAccounting* other) {
+    DCHECK(!batches_.empty());
+    other->batches_.push_back(batches_.front());
+    other->row_ids_.push_back(row_ids_.front());
+    other->zone_maps_.push_back(zone_maps_.front());
+    if (time_col_idx_ != -1) other->times_.push_back(times_.front());
+    PopFront();
+  }
+
+  /**
+   * PopFront removes the first batch in the store. The batch is destroyed once no reader has it
+   * pinned anymore.
+   */
+  void PopFront() {
     DCHECK(!batches_.empty());
     first_batch_id_++;
 
     row_ids_.pop_front();
+    zone_maps_.pop_front();
     if (time_col_idx_ != -1) times_.pop_front();
 
-    auto&& front = std::move(batches_.front());
     batches_.pop_front();
-    return std::move(front);
   }
 
   /**
@@ -177,10 +277,12 @@ class StoreWithRowTimeAccounting {
    * @return lvalue reference to the emplaced batch.
    */
   template <typename... Args>
-  TBatch& EmplaceBack(RowID first_row_id, Args... args) {
-    auto& batch = batches_.emplace_back(std::forward<Args>(args)...);
+  const TBatch& EmplaceBack(RowID first_row_id, Args... args) {
+    const auto& batch =
+        *batches_.emplace_back(std::make_shared<TBatch>(std::forward<Args>(args)...));
 
     row_ids_.emplace_back(first_row_id, first_row_id + BatchLength(batch) - 1);
+    zone_maps_.push_back(ComputeBatchZoneMap(batch));
     if (time_col_idx_ != -1) {
       auto first_time = GetTimeValue(batch, 0);
       auto last_time = GetTimeValue(batch, BatchLength(batch) - 1);
@@ -207,6 +309,15 @@ class StoreWithRowTimeAccounting {
     return row_ids_.back().second;
   }
 
+  /**
+   * LastZoneMap returns the zone map of the last batch in the store.
+   * @return the min/max of each column of the last batch.
+   */
+  const BatchZoneMap& LastZoneMap() const {
+    DCHECK(!batches_.empty());
+    return zone_maps_.back();
+  }
+
   /**
    * FindRowIDFromTimeFirstGreaterThanOrEqual returns the RowID of the first row in the store with
    * time greater than or equal to the given time, or returns std::nullopt if no such row exists.
@@ -224,7 +335,7 @@ class StoreWithRowTimeAccounting {
       return std::nullopt;
     }
     size_t batch_index = std::distance(times_.begin(), it);
-    auto row_offset = FindTimeFirstGreaterThanOrEqual(batches_[batch_index], time);
+    auto row_offset = FindTimeFirstGreaterThanOrEqual(*batches_[batch_index], time);
     return row_ids_[batch_index].first + row_offset;
   }
 
@@ -245,29 +356,38 @@ class StoreWithRowTimeAccounting {
       return std::nullopt;
     }
     size_t batch_index = std::distance(times_.begin(), it);
-    auto row_offset = FindTimeFirstGreaterThan(batches_[batch_index], time);
+    auto row_offset = FindTimeFirstGreaterThan(*batches_[batch_index], time);
     return row_ids_[batch_index].first + row_offset;
   }
 
   /**
    * RemovePrefix removes the given number of rows from the first batch in the store. This method is
-   * only valid for the `Hot` store, and fails to compile if called on the `Cold` store. Note that
-   * no reallocation or copies occur when removing prefix, instead the HotBatch representation
-   * maintains a row offset internally that is updated when remove prefix is called on it.
+   * only valid for the `Hot` store, and fails to compile if called on the other stores. Note that
+   * no reallocation or copies of the data occur when removing prefix, instead the HotBatch
+   * representation maintains a row offset internally that is updated when remove prefix is called
+   * on it. If a reader has the batch pinned, the (shallow) HotBatch is copied first, so that the
+   * reader's view of the batch doesn't change. The zone map of the batch is left as is, since the
+   * zone map of a superset of rows is still a valid (albeit looser) bound for the remaining rows.
    * @param num_rows, number of rows to remove.
    */
   void RemovePrefix(size_t num_rows) {
     DCHECK(!batches_.empty());
 
     if constexpr (std::is_same_v<TBatch, HotBatch>) {
-      batches_.front().RemovePrefix(num_rows);
+      auto& front = batches_.front();
+      // Batches are only pinned while holding the store's lock, so if the store holds the only
+      // reference, no reader can start using the batch while it is modified.
+      if (front.use_count() > 1) {
+        front = std::make_shared<TBatch>(front->ShallowCopy());
+      }
+      front->RemovePrefix(num_rows);
     } else {
       constexpr_else_static_assert_false();
     }
 
     row_ids_.front().first += num_rows;
     if (time_col_idx_ != -1) {
-      times_.front().first = GetTimeValue(batches_.front(), 0);
+      times_.front().first = GetTimeValue(*batches_.front(), 0);
     }
   }
 
@@ -311,16 +431,22 @@ class StoreWithRowTimeAccounting {
     return row_ids_[batch_id - first_batch_id_].second;
   }
 
-  TBatch& GetBatchFromBatchID(BatchID batch_id) {
+  const BatchZoneMap& GetZoneMapFromBatchID(BatchID batch_id) const {
     DCHECK_GE(batch_id, first_batch_id_);
     DCHECK_LT(batch_id, first_batch_id_ + static_cast<int64_t>(batches_.size()));
-    return batches_[batch_id - first_batch_id_];
+    return zone_maps_[batch_id - first_batch_id_];
   }
 
-  const TBatch& GetBatchFromBatchID(BatchID batch_id) const {
-    DCHECK_GE(batch_id, first_batch_id_);
-    DCHECK_LT(batch_id, first_batch_id_ + static_cast<int64_t>(batches_.size()));
-    return batches_[batch_id - first_batch_id_];
+  BatchZoneMap ComputeBatchZoneMap(const TBatch& batch) const {
+    BatchZoneMap zone_map(rel_.NumColumns());
+    for (size_t col_idx = 0; col_idx < rel_.NumColumns(); ++col_idx) {
+      auto col_type = rel_.col_types()[col_idx];
+      if (!SupportsZoneMap(col_type)) {
+        continue;
+      }
+      zone_map[col_idx] = batch.GetColumnZoneMap(col_idx, col_type);
+    }
+    return zone_map;
   }
 
   bool BatchHintValid(const BatchHints& hints, RowID row_id) const {
@@ -340,71 +466,28 @@ class StoreWithRowTimeAccounting {
     return first_batch_id_ + std::distance(row_ids_.begin(), it);
   }
 
-  size_t BatchLength(const TBatch& batch) const {
-    if constexpr (std::is_same_v<ColdBatch, TBatch>) {
-      return batch[0]->length();
-    } else if constexpr (std::is_same_v<HotBatch, TBatch>) {
-      return batch.Length();
-    } else {
-      constexpr_else_static_assert_false();
-    }
-  }
+  // Hot, cold and disk batches (RecordOrRowBatch, ColdBatch and DiskBatch) share the same
+  // interface, so the accessors below work for all stores.
+  size_t BatchLength(const TBatch& batch) const { return batch.Length(); }
 
   size_t FindTimeFirstGreaterThanOrEqual(const TBatch& batch, Time time) const {
-    if constexpr (std::is_same_v<TBatch, ColdBatch>) {
-      return types::SearchArrowArrayGreaterThanOrEqual<types::DataType::TIME64NS>(
-          batch[time_col_idx_].get(), time);
-    } else if constexpr (std::is_same_v<TBatch, HotBatch>) {
-      return batch.FindTimeFirstGreaterThanOrEqual(time_col_idx_, time);
-    } else {
-      constexpr_else_static_assert_false();
-    }
+    return batch.FindTimeFirstGreaterThanOrEqual(time_col_idx_, time);
   }
 
   size_t FindTimeFirstGreaterThan(const TBatch& batch, Time time) const {
-    if constexpr (std::is_same_v<TBatch, ColdBatch>) {
-      return types::SearchArrowArrayLessThanOrEqual<types::DataType::TIME64NS>(
-                 batch[time_col_idx_].get(), time) +
-             1;
-    } else if constexpr (std::is_same_v<TBatch, HotBatch>) {
-      return batch.FindTimeFirstGreaterThan(time_col_idx_, time);
-    } else {
-      constexpr_else_static_assert_false();
-    }
+    return batch.FindTimeFirstGreaterThan(time_col_idx_, time);
   }
 
   Time GetTimeValue(const TBatch& batch, int64_t row_idx) const {
-    if constexpr (std::is_same_v<TBatch, ColdBatch>) {
-      return types::GetValueFromArrowArray<types::DataType::TIME64NS>(batch[time_col_idx_].get(),
-                                                                      row_idx);
-    } else if constexpr (std::is_same_v<TBatch, HotBatch>) {
-      return batch.GetTimeValue(time_col_idx_, row_idx);
-    } else {
-      constexpr_else_static_assert_false();
-    }
-  }
-
-  Status AddBatchSliceToRowBatch(const TBatch& batch, size_t row_offset, size_t batch_size,
-                                 const std::vector<int64_t>& cols,
-                                 schema::RowBatch* output_rb) const {
-    if constexpr (std::is_same_v<TBatch, ColdBatch>) {
-      for (auto col_idx : cols) {
-        auto arr = batch[col_idx]->Slice(row_offset, batch_size);
-        PX_RETURN_IF_ERROR(output_rb->AddColumn(arr));
-      }
-      return Status::OK();
-    } else if constexpr (std::is_same_v<TBatch, HotBatch>) {
-      return batch.AddBatchSliceToRowBatch(row_offset, batch_size, cols, output_rb);
-    } else {
-      constexpr_else_static_assert_false();
-    }
+    return batch.GetTimeValue(time_col_idx_, row_idx);
   }
 
   BatchID first_batch_id_ = 0;
   const schema::Relation& rel_;
   const int64_t time_col_idx_;
-  std::deque<TBatch> batches_;
+  std::deque<std::shared_ptr<TBatch>> batches_;
   std::deque<RowIDInterval> row_ids_;
+  std::deque<BatchZoneMap> zone_maps_;
   std::deque<TimeInterval> times_;
 };
 
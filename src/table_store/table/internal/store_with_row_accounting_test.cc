@@ -124,6 +124,52 @@ TEST_F(ColdStoreTest, PushRowBatchesCheckProperties) {
   EXPECT_EQ(4, optional_row_id.value());
 }
 
+TEST_F(ColdStoreTest, GetNextRowBatchSkipsBatchesWithZoneMaps) {
+  auto rb0 = MakeRowBatch({1, 2, 3}, {true, true, true}, {"a", "b", "c"});
+  auto rb1 = MakeRowBatch({10, 11, 12}, {false, false, false}, {"d", "e", "f"});
+  auto rb2 = MakeRowBatch({20, 21, 22}, {true, false, true}, {"g", "h", "i"});
+  store_->EmplaceBack(0, rb0.columns());
+  store_->EmplaceBack(3, rb1.columns());
+  store_->EmplaceBack(6, rb2.columns());
+
+  std::vector<ColumnPredicate> predicates = {
+      {0, ColumnPredicate::kGreaterThanEqual, int64_t{11}},
+      {0, ColumnPredicate::kLessThan, int64_t{12}},
+  };
+
+  RowID last_read_row_id = -1;
+  BatchHints hints;
+  ASSERT_OK_AND_ASSIGN(auto rb, store_->GetNextRowBatch(&last_read_row_id, &hints, std::nullopt,
+                                                        {0, 2}, predicates));
+  ASSERT_NE(nullptr, rb);
+  // The first batch is skipped, the second batch is returned unfiltered.
+  EXPECT_EQ(3, rb->num_rows());
+  EXPECT_EQ(5, last_read_row_id);
+  EXPECT_EQ(10, types::GetValueFromArrowArray<types::DataType::TIME64NS>(rb->ColumnAt(0).get(), 0));
+
+  // The last batch doesn't match, so the store is exhausted after skipping it.
+  ASSERT_OK_AND_ASSIGN(rb, store_->GetNextRowBatch(&last_read_row_id, &hints, std::nullopt, {0, 2},
+                                                   predicates));
+  EXPECT_EQ(nullptr, rb);
+  EXPECT_EQ(8, last_read_row_id);
+}
+
+TEST_F(ColdStoreTest, GetNextRowBatchSkipStopsAtStopRowID) {
+  auto rb0 = MakeRowBatch({1, 2, 3}, {true, true, true}, {"a", "b", "c"});
+  auto rb1 = MakeRowBatch({10, 11, 12}, {false, false, false}, {"d", "e", "f"});
+  store_->EmplaceBack(0, rb0.columns());
+  store_->EmplaceBack(3, rb1.columns());
+
+  std::vector<ColumnPredicate> predicates = {{0, ColumnPredicate::kEqual, int64_t{100}}};
+
+  RowID last_read_row_id = -1;
+  BatchHints hints;
+  ASSERT_OK_AND_ASSIGN(auto rb, store_->GetNextRowBatch(&last_read_row_id, &hints, /*stop*/ 4,
+                                                        {0}, predicates));
+  EXPECT_EQ(nullptr, rb);
+  EXPECT_EQ(3, last_read_row_id);
+}
+
 TEST_P(HotStoreTest, PushRowBatchesCheckProperties) {
   std::vector<types::Time64NSValue> times = {1, 1, 10, 11};
   std::vector<types::BoolValue> bools = {true, false, true, false};
@@ -218,6 +264,34 @@ TEST_P(HotStoreTest, RemovePrefix) {
   EXPECT_EQ(2, optional_row_id.value());
 }
 
+TEST_P(HotStoreTest, PinnedSliceUnaffectedByRemovePrefixAndPopFront) {
+  std::vector<types::Time64NSValue> times = {1, 1, 10, 11};
+  std::vector<types::BoolValue> bools = {true, false, true, false};
+  std::vector<types::StringValue> strings = {"ab", "cd", "ef", "gh"};
+  auto [rb0, _] = MakeRecordOrRowBatch(times, bools, strings);
+  store_->EmplaceBack(0, std::move(*rb0));
+
+  RowID last_read_row_id = 0;
+  auto slice = store_->PinNextBatchSlice(&last_read_row_id, nullptr, std::nullopt);
+  ASSERT_TRUE(slice.has_value());
+  EXPECT_EQ(3, last_read_row_id);
+
+  // Modifying the store after pinning must not change the rows the slice refers to.
+  store_->RemovePrefix(2);
+  EXPECT_EQ(2, store_->FirstRowID());
+  EXPECT_EQ(10, store_->MinTime());
+  store_->PopFront();
+  EXPECT_EQ(0, store_->Size());
+
+  ASSERT_OK_AND_ASSIGN(auto rb, slice->ToRowBatch(*rel_, {0, 2}));
+  std::vector<types::Time64NSValue> expected_times = {1, 10, 11};
+  std::vector<types::StringValue> expected_strings = {"cd", "ef", "gh"};
+  EXPECT_TRUE(
+      rb->ColumnAt(0)->Equals(types::ToArrow(expected_times, arrow::default_memory_pool())));
+  EXPECT_TRUE(
+      rb->ColumnAt(1)->Equals(types::ToArrow(expected_strings, arrow::default_memory_pool())));
+}
+
 INSTANTIATE_RECORD_OR_ROW_BATCH_TESTSUITE(HotStore, HotStoreTest, /*include_mixed*/ true);
 
 }  // namespace internal
@@ -46,13 +46,15 @@ struct RecordBatchWithCache {
   RecordBatchPtr record_batch;
   // Whenever we have to convert a hot batch to an arrow array, we store the arrow array in
   // this cache. Compaction will eventually take these arrow arrays and move them into cold.
+  // Readers may fill the cache concurrently, so entries are only accessed with
+  // std::atomic_load/std::atomic_store. A nullptr entry means the column hasn't been converted yet.
   mutable std::vector<ArrowArrayPtr> arrow_cache;
-  mutable std::vector<bool> cache_validity;
 };
 
 enum StoreType {
   Hot,
   Cold,
+  Disk,
 };
 
 struct BatchHints {
@@ -61,8 +63,8 @@ struct BatchHints {
 };
 
 class RecordOrRowBatch;
-
-using ColdBatch = std::vector<ArrowArrayPtr>;
+class ColdBatch;
+class DiskBatch;
 
 template <StoreType type>
 struct StoreTypeTraits {};
@@ -74,6 +76,10 @@ template <>
 struct StoreTypeTraits<StoreType::Cold> {
   using batch_type = ColdBatch;
 };
+template <>
+struct StoreTypeTraits<StoreType::Disk> {
+  using batch_type = DiskBatch;
+};
 
 }  // namespace internal
 }  // namespace table_store
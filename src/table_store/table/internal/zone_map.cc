@@ -0,0 +1,177 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <absl/strings/substitute.h>
+
+#include "src/common/base/base.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/table_store/table/internal/zone_map.h"
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+namespace {
+
+template <types::DataType TDataType>
+using ZoneMapNativeType =
+    std::conditional_t<TDataType == types::DataType::UINT128, absl::uint128, int64_t>;
+
+template <types::DataType TDataType, typename TGetFn>
+ColumnZoneMap ComputeZoneMap(size_t start, size_t end, TGetFn get) {
+  using TNative = ZoneMapNativeType<TDataType>;
+  ColumnZoneMap zone_map;
+  if (start >= end) {
+    return zone_map;
+  }
+  TNative min = get(start);
+  TNative max = min;
+  for (size_t i = start + 1; i < end; ++i) {
+    TNative val = get(i);
+    min = std::min(min, val);
+    max = std::max(max, val);
+  }
+  zone_map.valid = true;
+  zone_map.min = min;
+  zone_map.max = max;
+  return zone_map;
+}
+
+template <types::DataType TDataType>
+ColumnZoneMap ComputeArrowArrayZoneMapImpl(const arrow::Array* arr) {
+  using TValueType = typename types::DataTypeTraits<TDataType>::value_type;
+  return ComputeZoneMap<TDataType>(0, arr->length(), [arr](size_t i) {
+    TValueType val = types::GetValueFromArrowArray<TDataType>(arr, i);
+    return val.val;
+  });
+}
+
+template <types::DataType TDataType>
+ColumnZoneMap ComputeColumnWrapperZoneMapImpl(const types::ColumnWrapper* col, size_t row_offset) {
+  using TValueType = typename types::DataTypeTraits<TDataType>::value_type;
+  return ComputeZoneMap<TDataType>(row_offset, col->Size(),
+                                   [col](size_t i) { return col->Get<TValueType>(i).val; });
+}
+
+template <typename T>
+bool CompareMayMatch(ColumnPredicate::Op op, const T& min, const T& max, const T& value) {
+  switch (op) {
+    case ColumnPredicate::kEqual:
+      return min <= value && value <= max;
+    case ColumnPredicate::kLessThan:
+      return min < value;
+    case ColumnPredicate::kLessThanEqual:
+      return min <= value;
+    case ColumnPredicate::kGreaterThan:
+      return max > value;
+    case ColumnPredicate::kGreaterThanEqual:
+      return max >= value;
+  }
+  // This return is not necessary but GCC complains without it.
+  return true;
+}
+
+bool PredicateMayMatch(const ColumnZoneMap& zone_map, const ColumnPredicate& predicate) {
+  if (!zone_map.valid || zone_map.min.index() != predicate.value.index()) {
+    return true;
+  }
+  if (std::holds_alternative<int64_t>(predicate.value)) {
+    return CompareMayMatch(predicate.op, std::get<int64_t>(zone_map.min),
+                           std::get<int64_t>(zone_map.max), std::get<int64_t>(predicate.value));
+  }
+  return CompareMayMatch(predicate.op, std::get<absl::uint128>(zone_map.min),
+                         std::get<absl::uint128>(zone_map.max),
+                         std::get<absl::uint128>(predicate.value));
+}
+
+std::string_view OpToString(ColumnPredicate::Op op) {
+  switch (op) {
+    case ColumnPredicate::kEqual:
+      return "==";
+    case ColumnPredicate::kLessThan:
+      return "<";
+    case ColumnPredicate::kLessThanEqual:
+      return "<=";
+    case ColumnPredicate::kGreaterThan:
+      return ">";
+    case ColumnPredicate::kGreaterThanEqual:
+      return ">=";
+  }
+  return "?";
+}
+
+}  // namespace
+
+std::string ColumnPredicate::DebugString() const {
+  std::string value_str = std::visit(
+      overloaded{
+          [](int64_t v) { return std::to_string(v); },
+          [](absl::uint128 v) {
+            return absl::Substitute("$0:$1", absl::Uint128High64(v), absl::Uint128Low64(v));
+          },
+      },
+      value);
+  return absl::Substitute("col[$0] $1 $2", col_idx, OpToString(op), value_str);
+}
+
+ColumnZoneMap ComputeArrowArrayZoneMap(const arrow::Array* arr, types::DataType type) {
+  switch (type) {
+    case types::DataType::INT64:
+      return ComputeArrowArrayZoneMapImpl<types::DataType::INT64>(arr);
+    case types::DataType::TIME64NS:
+      return ComputeArrowArrayZoneMapImpl<types::DataType::TIME64NS>(arr);
+    case types::DataType::UINT128:
+      return ComputeArrowArrayZoneMapImpl<types::DataType::UINT128>(arr);
+    default:
+      return ColumnZoneMap{};
+  }
+}
+
+ColumnZoneMap ComputeColumnWrapperZoneMap(const types::ColumnWrapper* col, types::DataType type,
+                                          size_t row_offset) {
+  switch (type) {
+    case types::DataType::INT64:
+      return ComputeColumnWrapperZoneMapImpl<types::DataType::INT64>(col, row_offset);
+    case types::DataType::TIME64NS:
+      return ComputeColumnWrapperZoneMapImpl<types::DataType::TIME64NS>(col, row_offset);
+    case types::DataType::UINT128:
+      return ComputeColumnWrapperZoneMapImpl<types::DataType::UINT128>(col, row_offset);
+    default:
+      return ColumnZoneMap{};
+  }
+}
+
+bool BatchMayMatch(const BatchZoneMap& zone_map, const std::vector<ColumnPredicate>& predicates) {
+  for (const auto& predicate : predicates) {
+    if (predicate.col_idx < 0 || static_cast<size_t>(predicate.col_idx) >= zone_map.size()) {
+      continue;
+    }
+    if (!PredicateMayMatch(zone_map[predicate.col_idx], predicate)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
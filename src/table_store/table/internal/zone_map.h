@@ -0,0 +1,114 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <arrow/array.h>
+
+#include <string>
+#include <variant>
+#include <vector>
+
+#include <absl/numeric/int128.h>
+
+#include "src/shared/types/column_wrapper.h"
+#include "src/shared/types/types.h"
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+/**
+ * ZoneMapValue holds a min/max bound (or a predicate literal) for a column that supports zone maps.
+ * INT64 and TIME64NS columns use int64_t, while UINT128 columns use absl::uint128.
+ */
+using ZoneMapValue = std::variant<int64_t, absl::uint128>;
+
+/**
+ * ColumnZoneMap stores the minimum and maximum value of a single column in a single batch. Zone
+ * maps are only computed for the column types that SupportsZoneMap returns true for, for all other
+ * columns `valid` is false, and the zone map can't be used to prune the batch.
+ */
+struct ColumnZoneMap {
+  bool valid = false;
+  ZoneMapValue min;
+  ZoneMapValue max;
+};
+
+using BatchZoneMap = std::vector<ColumnZoneMap>;
+
+/**
+ * ColumnPredicate is a simple comparison between a column and a literal value, of the form
+ * `column <op> value`. A list of ColumnPredicates is interpreted as a conjunction. ColumnPredicates
+ * are only used to skip entire batches that can't possibly match, they are not a replacement for
+ * evaluating the actual filter on the rows that are returned.
+ */
+struct ColumnPredicate {
+  enum Op {
+    kEqual,
+    kLessThan,
+    kLessThanEqual,
+    kGreaterThan,
+    kGreaterThanEqual,
+  };
+  int64_t col_idx;
+  Op op;
+  ZoneMapValue value;
+
+  std::string DebugString() const;
+};
+
+/**
+ * SupportsZoneMap returns whether zone maps are tracked for columns of the given type.
+ */
+inline bool SupportsZoneMap(types::DataType type) {
+  return type == types::DataType::INT64 || type == types::DataType::TIME64NS ||
+         type == types::DataType::UINT128;
+}
+
+/**
+ * ComputeArrowArrayZoneMap computes the zone map of the rows in the given arrow array.
+ * @param arr, the arrow array to compute the zone map for.
+ * @param type, the DataType of the array.
+ * @return zone map for the column, invalid if the type is not supported or the array is empty.
+ */
+ColumnZoneMap ComputeArrowArrayZoneMap(const arrow::Array* arr, types::DataType type);
+
+/**
+ * ComputeColumnWrapperZoneMap computes the zone map of the rows in the given column wrapper,
+ * starting at `row_offset`.
+ * @param col, the column wrapper to compute the zone map for.
+ * @param type, the DataType of the column.
+ * @param row_offset, the first row to include in the zone map.
+ * @return zone map for the column, invalid if the type is not supported or there are no rows.
+ */
+ColumnZoneMap ComputeColumnWrapperZoneMap(const types::ColumnWrapper* col, types::DataType type,
+                                          size_t row_offset);
+
+/**
+ * BatchMayMatch returns false only if the zone map proves that no row in the batch can satisfy all
+ * of the given predicates. Predicates on columns without a valid zone map are ignored.
+ * @param zone_map, the zone map of the batch.
+ * @param predicates, conjunction of predicates to check.
+ * @return whether the batch may contain matching rows.
+ */
+bool BatchMayMatch(const BatchZoneMap& zone_map, const std::vector<ColumnPredicate>& predicates);
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
@@ -0,0 +1,93 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <vector>
+
+#include "src/common/testing/testing.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/table_store/table/internal/zone_map.h"
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+TEST(ZoneMapTest, ArrowArrayInt64) {
+  std::vector<types::Int64Value> vals = {5, -3, 10, 7};
+  auto arr = types::ToArrow(vals, arrow::default_memory_pool());
+  auto zone_map = ComputeArrowArrayZoneMap(arr.get(), types::DataType::INT64);
+  ASSERT_TRUE(zone_map.valid);
+  EXPECT_EQ(-3, std::get<int64_t>(zone_map.min));
+  EXPECT_EQ(10, std::get<int64_t>(zone_map.max));
+}
+
+TEST(ZoneMapTest, ArrowArrayUInt128) {
+  std::vector<types::UInt128Value> vals = {{1, 10}, {0, 5}, {1, 2}};
+  auto arr = types::ToArrow(vals, arrow::default_memory_pool());
+  auto zone_map = ComputeArrowArrayZoneMap(arr.get(), types::DataType::UINT128);
+  ASSERT_TRUE(zone_map.valid);
+  EXPECT_EQ(absl::MakeUint128(0, 5), std::get<absl::uint128>(zone_map.min));
+  EXPECT_EQ(absl::MakeUint128(1, 10), std::get<absl::uint128>(zone_map.max));
+}
+
+TEST(ZoneMapTest, UnsupportedTypeIsInvalid) {
+  std::vector<types::StringValue> vals = {"a", "b"};
+  auto arr = types::ToArrow(vals, arrow::default_memory_pool());
+  EXPECT_FALSE(ComputeArrowArrayZoneMap(arr.get(), types::DataType::STRING).valid);
+}
+
+TEST(ZoneMapTest, ColumnWrapperWithOffset) {
+  std::vector<types::Time64NSValue> vals = {1, 2, 30, 40};
+  auto col = types::ColumnWrapper::FromArrow(types::DataType::TIME64NS,
+                                             types::ToArrow(vals, arrow::default_memory_pool()));
+  auto zone_map = ComputeColumnWrapperZoneMap(col.get(), types::DataType::TIME64NS, 2);
+  ASSERT_TRUE(zone_map.valid);
+  EXPECT_EQ(30, std::get<int64_t>(zone_map.min));
+  EXPECT_EQ(40, std::get<int64_t>(zone_map.max));
+
+  EXPECT_FALSE(ComputeColumnWrapperZoneMap(col.get(), types::DataType::TIME64NS, 4).valid);
+}
+
+TEST(ZoneMapTest, BatchMayMatch) {
+  BatchZoneMap zone_map(3);
+  zone_map[0] = ColumnZoneMap{true, int64_t{10}, int64_t{20}};
+  // Column 1 has no zone map.
+  zone_map[2] = ColumnZoneMap{true, absl::MakeUint128(0, 1), absl::MakeUint128(0, 5)};
+
+  using Op = ColumnPredicate::Op;
+  EXPECT_TRUE(BatchMayMatch(zone_map, {}));
+  EXPECT_TRUE(BatchMayMatch(zone_map, {{0, Op::kEqual, int64_t{15}}}));
+  EXPECT_FALSE(BatchMayMatch(zone_map, {{0, Op::kEqual, int64_t{21}}}));
+  EXPECT_FALSE(BatchMayMatch(zone_map, {{0, Op::kLessThan, int64_t{10}}}));
+  EXPECT_TRUE(BatchMayMatch(zone_map, {{0, Op::kLessThanEqual, int64_t{10}}}));
+  EXPECT_FALSE(BatchMayMatch(zone_map, {{0, Op::kGreaterThan, int64_t{20}}}));
+  EXPECT_TRUE(BatchMayMatch(zone_map, {{0, Op::kGreaterThanEqual, int64_t{20}}}));
+
+  // Predicates on columns without zone maps can't prune.
+  EXPECT_TRUE(BatchMayMatch(zone_map, {{1, Op::kEqual, int64_t{100}}}));
+
+  EXPECT_TRUE(BatchMayMatch(zone_map, {{2, Op::kEqual, absl::MakeUint128(0, 3)}}));
+  EXPECT_FALSE(BatchMayMatch(zone_map, {{2, Op::kEqual, absl::MakeUint128(1, 3)}}));
+
+  // All predicates must be satisfiable for the batch to match.
+  EXPECT_FALSE(BatchMayMatch(zone_map, {{0, Op::kEqual, int64_t{15}},
+                                        {2, Op::kEqual, absl::MakeUint128(1, 3)}}));
+}
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
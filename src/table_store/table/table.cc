@@ -17,6 +17,8 @@
  */
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cmath>
 #include <cstddef>
 #include <iterator>
@@ -26,14 +28,18 @@
 #include <variant>
 #include <vector>
 
+#include <absl/strings/str_cat.h>
 #include <absl/strings/str_format.h>
+#include <absl/strings/substitute.h>
 #include "internal/store_with_row_accounting.h"
 #include "src/common/base/base.h"
 #include "src/common/base/status.h"
+#include "src/common/fs/fs_wrapper.h"
 #include "src/shared/types/arrow_adapter.h"
 #include "src/shared/types/type_utils.h"
 #include "src/table_store/schema/relation.h"
 #include "src/table_store/table/internal/batch_size_accountant.h"
+#include "src/table_store/table/internal/disk_batch.h"
 #include "src/table_store/table/internal/record_or_row_batch.h"
 #include "src/table_store/table/internal/types.h"
 #include "src/table_store/table/table.h"
@@ -44,12 +50,59 @@ DEFINE_int32(table_store_table_size_limit,
              gflags::Int32FromEnv("PL_TABLE_STORE_TABLE_SIZE_LIMIT", 1024 * 1024 * 64),
              "The maximal size a table allows. When the size grows beyond this limit, "
              "old data will be discarded.");
+DEFINE_bool(table_store_dictionary_encode_strings,
+            gflags::BoolFromEnv("PL_TABLE_STORE_DICTIONARY_ENCODE_STRINGS", true),
+            "Whether low cardinality string columns are dictionary encoded when they are "
+            "compacted into the cold store. Filters and aggregates read the codes of encoded "
+            "columns, other readers decode them.");
+DEFINE_bool(table_store_compress_cold_batches,
+            gflags::BoolFromEnv("PL_TABLE_STORE_COMPRESS_COLD_BATCHES", false),
+            "Whether INT64 and TIME64NS columns are compressed (delta or frame-of-reference "
+            "bit-packing) when they are compacted into the cold store. Reads of compressed "
+            "columns decode the rows they return instead of slicing the stored array.");
+DEFINE_string(table_store_spill_dir, gflags::StringFromEnv("PL_TABLE_STORE_SPILL_DIR", ""),
+              "Local directory that cold batches are spilled to when they are expired from memory. "
+              "Each table uses its own subdirectory. Spilling is disabled if empty. The directory "
+              "must not be shared between processes.");
+DEFINE_int64(table_store_table_disk_size_limit,
+             gflags::Int64FromEnv("PL_TABLE_STORE_TABLE_DISK_SIZE_LIMIT", 1024 * 1024 * 256),
+             "The maximal number of bytes a table keeps spilled to disk. When the size grows "
+             "beyond this limit, the oldest spilled data is deleted.");
 
 namespace px {
 namespace table_store {
 
-Table::Cursor::Cursor(const Table* table, StartSpec start, StopSpec stop)
-    : table_(table), hints_(internal::BatchHints{}) {
+namespace {
+
+// Generations are drawn from a single counter, so no two tables of the process share one.
+int64_t NextTableGeneration() {
+  static std::atomic<int64_t> next_generation = 0;
+  return next_generation++;
+}
+
+}  // namespace
+
+std::shared_ptr<Table> Table::Create(std::string_view table_name,
+                                     const schema::Relation& relation) {
+  // Create naked pointer, because std::make_shared() cannot access the private ctor.
+  auto table =
+      std::shared_ptr<Table>(new Table(table_name, relation, FLAGS_table_store_table_size_limit));
+  if (!FLAGS_table_store_spill_dir.empty()) {
+    // Tables can be recreated with the same name (eg. tablets), so a counter keeps their spill
+    // directories apart.
+    static std::atomic<int64_t> next_spill_dir_id = 0;
+    auto spill_dir = std::filesystem::path(FLAGS_table_store_spill_dir) /
+                     absl::StrCat(table_name, ".", next_spill_dir_id++);
+    auto s = table->EnableSpillToDisk(spill_dir, FLAGS_table_store_table_disk_size_limit);
+    LOG_IF(ERROR, !s.ok()) << absl::Substitute(
+        "Failed to enable spilling to disk for table $0: $1", table_name, s.msg());
+  }
+  return table;
+}
+
+Table::Cursor::Cursor(const Table* table, StartSpec start, StopSpec stop,
+                      std::vector<ColumnPredicate> predicates)
+    : table_(table), hints_(internal::BatchHints{}), predicates_(std::move(predicates)) {
   AdvanceToStart(start);
   StopStateFromSpec(std::move(stop));
 }
@@ -163,8 +216,8 @@ std::optional<internal::RowID> Table::Cursor::StopRowID() const {
 }
 
 StatusOr<std::unique_ptr<schema::RowBatch>> Table::Cursor::GetNextRowBatch(
-    const std::vector<int64_t>& cols) {
-  return table_->GetNextRowBatch(this, cols);
+    const std::vector<int64_t>& cols, arrow::MemoryPool* mem_pool) {
+  return table_->GetNextRowBatch(this, cols, mem_pool);
 }
 
 Table::Table(std::string_view table_name, const schema::Relation& relation, size_t max_table_size,
@@ -174,9 +227,11 @@ Table::Table(std::string_view table_name, const schema::Relation& relation, size
       max_table_size_(max_table_size),
       compacted_batch_size_(compacted_batch_size),
       // TODO(james): move mem_pool into constructor.
-      compactor_(rel_, arrow::default_memory_pool()) {
+      compactor_(rel_, arrow::default_memory_pool(), FLAGS_table_store_dictionary_encode_strings) {
   absl::base_internal::SpinLockHolder cold_lock(&cold_lock_);
   absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
+  generation_ = NextTableGeneration();
+  first_generation_ = generation_;
   for (const auto& [i, col_name] : Enumerate(rel_.col_names())) {
     if (col_name == "time_" && rel_.GetColumnType(i) == types::DataType::TIME64NS) {
       time_col_idx_ = i;
@@ -187,6 +242,35 @@ Table::Table(std::string_view table_name, const schema::Relation& relation, size
       rel_, time_col_idx_);
   cold_store_ = std::make_unique<internal::StoreWithRowTimeAccounting<internal::StoreType::Cold>>(
       rel_, time_col_idx_);
+  absl::base_internal::SpinLockHolder disk_lock(&disk_lock_);
+  spill_queue_ = std::make_unique<internal::StoreWithRowTimeAccounting<internal::StoreType::Cold>>(
+      rel_, time_col_idx_);
+  disk_store_ = std::make_unique<internal::StoreWithRowTimeAccounting<internal::StoreType::Disk>>(
+      rel_, time_col_idx_);
+}
+
+Table::~Table() {
+  if (spill_dir_.empty()) {
+    return;
+  }
+  {
+    absl::base_internal::SpinLockHolder disk_lock(&disk_lock_);
+    // Deletes the segment files.
+    disk_store_.reset();
+  }
+  auto s = fs::RemoveAll(spill_dir_);
+  LOG_IF(WARNING, !s.ok()) << s.msg();
+}
+
+Status Table::EnableSpillToDisk(const std::filesystem::path& spill_dir, int64_t max_disk_bytes) {
+  // Remove any segments left behind by a previous table with the same spill directory.
+  PX_RETURN_IF_ERROR(fs::RemoveAll(spill_dir));
+  PX_RETURN_IF_ERROR(fs::CreateDirectories(spill_dir));
+  absl::base_internal::SpinLockHolder cold_lock(&cold_lock_);
+  absl::base_internal::SpinLockHolder disk_lock(&disk_lock_);
+  spill_dir_ = spill_dir;
+  max_disk_bytes_ = max_disk_bytes;
+  return Status::OK();
 }
 
 Status Table::ToProto(table_store::schemapb::Table* table_proto) const {
@@ -210,31 +294,76 @@ Status Table::ToProto(table_store::schemapb::Table* table_proto) const {
 }
 
 StatusOr<std::unique_ptr<schema::RowBatch>> Table::GetNextRowBatch(
-    Cursor* cursor, const std::vector<int64_t>& cols) const {
+    Cursor* cursor, const std::vector<int64_t>& cols, arrow::MemoryPool* mem_pool) const {
   DCHECK(!cursor->Done()) << "Calling GetNextRowBatch on an exhausted Cursor";
-  absl::base_internal::SpinLockHolder cold_lock(&cold_lock_);
-  PX_ASSIGN_OR_RETURN(auto rb,
-                      cold_store_->GetNextRowBatch(cursor->LastReadRowID(), cursor->Hints(),
-                                                   cursor->StopRowID(), cols));
-  if (rb == nullptr) {
-    absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
-    PX_ASSIGN_OR_RETURN(rb, hot_store_->GetNextRowBatch(cursor->LastReadRowID(), cursor->Hints(),
-                                                        cursor->StopRowID(), cols));
-    if (rb == nullptr && hot_store_->Size() > 0) {
-      // If the cursor was pointing to an expired row batch, update the cursor to point to the start
-      // of the table, then try to get the next row batch.
-      *cursor->LastReadRowID() = hot_store_->FirstRowID() - 1;
-      if (!cursor->Done()) {
-        PX_ASSIGN_OR_RETURN(rb,
-                            hot_store_->GetNextRowBatch(cursor->LastReadRowID(), cursor->Hints(),
-                                                        cursor->StopRowID(), cols));
-      }
+  const auto& predicates = cursor->Predicates();
+  // Cursor::Done() can't be used while holding the table locks, since it might need to take them.
+  auto reached_stop = [cursor]() {
+    auto stop_row_id = cursor->StopRowID();
+    return stop_row_id.has_value() && *cursor->LastReadRowID() + 1 >= stop_row_id.value();
+  };
+
+  // Only the batch to read is pinned while holding the locks. The (potentially expensive)
+  // conversion or decoding of the batch happens after the locks are released, so that writers and
+  // compaction don't have to wait on readers.
+  std::optional<internal::PinnedBatchSlice<internal::StoreType::Disk>> disk_slice;
+  std::optional<internal::PinnedBatchSlice<internal::StoreType::Cold>> cold_slice;
+  std::optional<internal::PinnedBatchSlice<internal::StoreType::Hot>> hot_slice;
+  RowID initial_last_read_row_id;
+  {
+    absl::base_internal::SpinLockHolder cold_lock(&cold_lock_);
+    absl::base_internal::SpinLockHolder disk_lock(&disk_lock_);
+    // If the cursor was pointing to an expired row batch, update the cursor to point to the start
+    // of the table, before trying to get the next row batch.
+    auto first_row_id = FirstRowIDUnlocked();
+    if (first_row_id != -1 && *cursor->LastReadRowID() + 1 < first_row_id) {
+      *cursor->LastReadRowID() = first_row_id - 1;
+    }
+    // Moving past expired rows doesn't count as skipping batches below.
+    initial_last_read_row_id = *cursor->LastReadRowID();
+    // The disk store holds the oldest rows, followed by the batches waiting to be spilled, the cold
+    // store and then the hot store.
+    if (!reached_stop()) {
+      disk_slice = disk_store_->PinNextBatchSlice(cursor->LastReadRowID(), cursor->Hints(),
+                                                  cursor->StopRowID(), predicates);
     }
+    if (!disk_slice.has_value() && !reached_stop()) {
+      cold_slice = spill_queue_->PinNextBatchSlice(cursor->LastReadRowID(), cursor->Hints(),
+                                                   cursor->StopRowID(), predicates);
+    }
+    if (!disk_slice.has_value() && !cold_slice.has_value() && !reached_stop()) {
+      cold_slice = cold_store_->PinNextBatchSlice(cursor->LastReadRowID(), cursor->Hints(),
+                                                  cursor->StopRowID(), predicates);
+    }
+    if (!disk_slice.has_value() && !cold_slice.has_value() && !reached_stop()) {
+      absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
+      hot_slice = hot_store_->PinNextBatchSlice(cursor->LastReadRowID(), cursor->Hints(),
+                                                cursor->StopRowID(), predicates);
+    }
+  }
+  if (disk_slice.has_value()) {
+    return disk_slice->ToRowBatch(rel_, cols, mem_pool);
+  }
+  if (cold_slice.has_value()) {
+    PX_ASSIGN_OR_RETURN(auto rb, cold_slice->ToRowBatch(rel_, cols, mem_pool));
+    if (cursor->keep_dictionary_columns() || !rb->HasDictionaryColumns()) {
+      return rb;
+    }
+    return rb->DecodeDictionaryColumns(mem_pool);
+  }
+  if (hot_slice.has_value()) {
+    return hot_slice->ToRowBatch(rel_, cols, mem_pool);
   }
-  if (rb == nullptr) {
-    return error::InvalidArgument("Data after Cursor is not in the table.");
+  if (*cursor->LastReadRowID() > initial_last_read_row_id) {
+    // All the batches that were available to the cursor were skipped by the zone maps.
+    std::vector<types::DataType> col_types;
+    for (int64_t col_idx : cols) {
+      col_types.push_back(rel_.col_types()[col_idx]);
+    }
+    return schema::RowBatch::WithZeroRows(schema::RowDescriptor(col_types), /* eow */ false,
+                                          /* eos */ false);
   }
-  return rb;
+  return error::InvalidArgument("Data after Cursor is not in the table.");
 }
 
 Status Table::ExpireRowBatches(int64_t row_batch_size) {
@@ -284,7 +413,6 @@ Status Table::TransferRecordBatch(
   auto record_batch_w_cache = internal::RecordBatchWithCache{
       std::move(record_batch),
       std::vector<ArrowArrayPtr>(rel_.NumColumns()),
-      std::vector<bool>(rel_.NumColumns(), false),
   };
   internal::RecordOrRowBatch record_or_row_batch(std::move(record_batch_w_cache));
 
@@ -306,6 +434,25 @@ Status Table::WriteHot(internal::RecordOrRowBatch&& record_or_row_batch) {
     batch_size_accountant_->NewHotBatch(std::move(batch_stats));
     hot_store_->EmplaceBack(next_row_id_, std::move(record_or_row_batch));
     next_row_id_ += batch_length;
+    if (time_col_idx_ != -1) {
+      const auto& times = hot_store_->LastZoneMap()[time_col_idx_];
+      if (times.valid) {
+        auto min_time = std::get<int64_t>(times.min);
+        if (min_time < max_time_written_) {
+          generation_ = NextTableGeneration();
+          while (!out_of_order_writes_.empty() &&
+                 out_of_order_writes_.back().min_time >= min_time) {
+            out_of_order_writes_.pop_back();
+          }
+          out_of_order_writes_.push_back({generation_, min_time});
+          if (out_of_order_writes_.size() > kMaxOutOfOrderWrites) {
+            out_of_order_writes_[1].min_time = out_of_order_writes_[0].min_time;
+            out_of_order_writes_.pop_front();
+          }
+        }
+        max_time_written_ = std::max(max_time_written_, std::get<int64_t>(times.max));
+      }
+    }
   }
 
   {
@@ -323,6 +470,17 @@ Status Table::WriteHot(internal::RecordOrRowBatch&& record_or_row_batch) {
 
 Table::RowID Table::FirstRowID() const {
   absl::base_internal::SpinLockHolder cold_lock(&cold_lock_);
+  absl::base_internal::SpinLockHolder disk_lock(&disk_lock_);
+  return FirstRowIDUnlocked();
+}
+
+Table::RowID Table::FirstRowIDUnlocked() const {
+  if (disk_store_->Size() > 0) {
+    return disk_store_->FirstRowID();
+  }
+  if (spill_queue_->Size() > 0) {
+    return spill_queue_->FirstRowID();
+  }
   if (cold_store_->Size() > 0) {
     return cold_store_->FirstRowID();
   }
@@ -335,6 +493,7 @@ Table::RowID Table::FirstRowID() const {
 
 Table::RowID Table::LastRowID() const {
   absl::base_internal::SpinLockHolder cold_lock(&cold_lock_);
+  absl::base_internal::SpinLockHolder disk_lock(&disk_lock_);
   absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
   if (hot_store_->Size() > 0) {
     return hot_store_->LastRowID();
@@ -342,11 +501,18 @@ Table::RowID Table::LastRowID() const {
   if (cold_store_->Size() > 0) {
     return cold_store_->LastRowID();
   }
+  if (spill_queue_->Size() > 0) {
+    return spill_queue_->LastRowID();
+  }
+  if (disk_store_->Size() > 0) {
+    return disk_store_->LastRowID();
+  }
   return -1;
 }
 
 Table::Time Table::MaxTime() const {
   absl::base_internal::SpinLockHolder cold_lock(&cold_lock_);
+  absl::base_internal::SpinLockHolder disk_lock(&disk_lock_);
   absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
   if (hot_store_->Size() > 0) {
     return hot_store_->MaxTime();
@@ -354,12 +520,27 @@ Table::Time Table::MaxTime() const {
   if (cold_store_->Size() > 0) {
     return cold_store_->MaxTime();
   }
+  if (spill_queue_->Size() > 0) {
+    return spill_queue_->MaxTime();
+  }
+  if (disk_store_->Size() > 0) {
+    return disk_store_->MaxTime();
+  }
   return -1;
 }
 
 Table::RowID Table::FindRowIDFromTimeFirstGreaterThanOrEqual(Time time) const {
   absl::base_internal::SpinLockHolder cold_lock(&cold_lock_);
-  auto optional_row_id = cold_store_->FindRowIDFromTimeFirstGreaterThanOrEqual(time);
+  absl::base_internal::SpinLockHolder disk_lock(&disk_lock_);
+  auto optional_row_id = disk_store_->FindRowIDFromTimeFirstGreaterThanOrEqual(time);
+  if (optional_row_id.has_value()) {
+    return optional_row_id.value();
+  }
+  optional_row_id = spill_queue_->FindRowIDFromTimeFirstGreaterThanOrEqual(time);
+  if (optional_row_id.has_value()) {
+    return optional_row_id.value();
+  }
+  optional_row_id = cold_store_->FindRowIDFromTimeFirstGreaterThanOrEqual(time);
   if (optional_row_id.has_value()) {
     return optional_row_id.value();
   }
@@ -373,7 +554,16 @@ Table::RowID Table::FindRowIDFromTimeFirstGreaterThanOrEqual(Time time) const {
 
 Table::RowID Table::FindRowIDFromTimeFirstGreaterThan(Time time) const {
   absl::base_internal::SpinLockHolder cold_lock(&cold_lock_);
-  auto optional_row_id = cold_store_->FindRowIDFromTimeFirstGreaterThan(time);
+  absl::base_internal::SpinLockHolder disk_lock(&disk_lock_);
+  auto optional_row_id = disk_store_->FindRowIDFromTimeFirstGreaterThan(time);
+  if (optional_row_id.has_value()) {
+    return optional_row_id.value();
+  }
+  optional_row_id = spill_queue_->FindRowIDFromTimeFirstGreaterThan(time);
+  if (optional_row_id.has_value()) {
+    return optional_row_id.value();
+  }
+  optional_row_id = cold_store_->FindRowIDFromTimeFirstGreaterThan(time);
   if (optional_row_id.has_value()) {
     return optional_row_id.value();
   }
@@ -387,20 +577,52 @@ Table::RowID Table::FindRowIDFromTimeFirstGreaterThan(Time time) const {
 
 schema::Relation Table::GetRelation() const { return rel_; }
 
+int64_t Table::generation() const {
+  absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
+  return generation_;
+}
+
+Table::Time Table::MinTimeWrittenOutOfOrderSince(int64_t generation) const {
+  if (generation < first_generation_) {
+    return std::numeric_limits<Time>::min();
+  }
+  absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
+  // The times increase with the generations, so the first write after the generation is the oldest.
+  for (const auto& write : out_of_order_writes_) {
+    if (write.generation > generation) {
+      return write.min_time;
+    }
+  }
+  return std::numeric_limits<Time>::max();
+}
+
 TableStats Table::GetTableStats() const {
   TableStats info;
   int64_t min_time = -1;
   int64_t num_batches = 0;
   int64_t hot_bytes = 0;
   int64_t cold_bytes = 0;
+  int64_t cold_logical_bytes = 0;
+  int64_t disk_bytes = 0;
   {
     absl::base_internal::SpinLockHolder cold_lock(&cold_lock_);
-    min_time = cold_store_->MinTime();
+    absl::base_internal::SpinLockHolder disk_lock(&disk_lock_);
+    min_time = disk_store_->MinTime();
+    num_batches += disk_store_->Size();
+    disk_bytes = disk_bytes_;
+    if (min_time == -1) {
+      min_time = spill_queue_->MinTime();
+    }
+    num_batches += spill_queue_->Size();
+    if (min_time == -1) {
+      min_time = cold_store_->MinTime();
+    }
     num_batches += cold_store_->Size();
     absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
     num_batches += hot_store_->Size();
     hot_bytes = batch_size_accountant_->HotBytes();
     cold_bytes = batch_size_accountant_->ColdBytes();
+    cold_logical_bytes = batch_size_accountant_->ColdLogicalBytes();
     if (min_time == -1) {
       min_time = hot_store_->MinTime();
     }
@@ -414,6 +636,8 @@ TableStats Table::GetTableStats() const {
   info.bytes = hot_bytes + cold_bytes;
   info.hot_bytes = hot_bytes;
   info.cold_bytes = cold_bytes;
+  info.cold_logical_bytes = cold_logical_bytes;
+  info.disk_bytes = disk_bytes;
   info.compacted_batches = compacted_batches_;
   info.max_table_size = max_table_size_;
   info.min_time = min_time;
@@ -440,10 +664,15 @@ Status Table::CompactSingleBatchUnlocked(arrow::MemoryPool*) {
   }
 
   PX_ASSIGN_OR_RETURN(std::vector<ArrowArrayPtr> out_columns, compactor_.Finish());
+  uint64_t bytes_saved = compactor_.LastBytesSavedByEncoding();
 
-  cold_store_->EmplaceBack(first_row_id, out_columns);
+  ColdBatch cold_batch(std::move(out_columns));
+  if (FLAGS_table_store_compress_cold_batches) {
+    bytes_saved += cold_batch.CompressIntegerColumns(rel_);
+  }
+  cold_store_->EmplaceBack(first_row_id, std::move(cold_batch));
 
-  auto num_rows_to_remove = batch_size_accountant_->FinishCompactedBatch();
+  auto num_rows_to_remove = batch_size_accountant_->FinishCompactedBatch(bytes_saved);
   if (num_rows_to_remove > 0) {
     hot_store_->RemovePrefix(num_rows_to_remove);
   }
@@ -457,12 +686,17 @@ Status Table::CompactSingleBatchUnlocked(arrow::MemoryPool*) {
 }
 
 Status Table::CompactHotToCold(arrow::MemoryPool* mem_pool) {
+  SpillQueuedBatches();
   bool next_ready = false;
   {
     absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
     next_ready = batch_size_accountant_->CompactedBatchReady();
   }
-  while (next_ready) {
+  if (!next_ready) {
+    return Status::OK();
+  }
+  auto start = std::chrono::steady_clock::now();
+  for (int64_t i = 0; next_ready && i < kMaxBatchesPerCompactionCall; ++i) {
     absl::base_internal::SpinLockHolder cold_lock(&cold_lock_);
     absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
     // We have to check CompactedBatchReady() again, in case hot batches were expired since the last
@@ -473,15 +707,74 @@ Status Table::CompactHotToCold(arrow::MemoryPool* mem_pool) {
     PX_RETURN_IF_ERROR(CompactSingleBatchUnlocked(mem_pool));
     next_ready = batch_size_accountant_->CompactedBatchReady();
   }
+  metrics_.compaction_latency_ns_gauge.Set(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start)
+          .count());
   return Status::OK();
 }
 
+void Table::SpillQueuedBatches() {
+  absl::MutexLock spill_lock(&spill_lock_);
+  while (true) {
+    std::shared_ptr<const internal::ColdBatch> batch;
+    int64_t first_row_id;
+    std::filesystem::path path;
+    {
+      absl::base_internal::SpinLockHolder disk_lock(&disk_lock_);
+      if (spill_queue_->Size() == 0) {
+        return;
+      }
+      batch = spill_queue_->PinFront();
+      first_row_id = spill_queue_->FirstRowID();
+      path = spill_dir_ / absl::StrCat(next_segment_id_++, ".seg");
+    }
+
+    // Writing the segment is done without holding any of the table locks.
+    auto disk_batch_or_s = internal::DiskBatch::Spill(*batch, rel_, time_col_idx_, path);
+    // Segments evicted over the size limit are only deleted once the lock is released.
+    std::vector<std::shared_ptr<const internal::DiskBatch>> evicted;
+    {
+      absl::base_internal::SpinLockHolder disk_lock(&disk_lock_);
+      // The batch might have been dropped from the queue while it was being spilled.
+      if (spill_queue_->Size() == 0 || spill_queue_->FirstRowID() != first_row_id) {
+        continue;
+      }
+      spill_queue_->PopFront();
+      if (!disk_batch_or_s.ok()) {
+        // The batch is dropped, as it would have been without spilling.
+        LOG(ERROR) << absl::Substitute("Failed to spill cold batch to disk: $0",
+                                       disk_batch_or_s.msg());
+        continue;
+      }
+      auto disk_batch = disk_batch_or_s.ConsumeValueOrDie();
+      disk_bytes_ += disk_batch.FileBytes();
+      disk_store_->EmplaceBack(first_row_id, std::move(disk_batch));
+      while (disk_bytes_ > max_disk_bytes_ && disk_store_->Size() > 0) {
+        disk_bytes_ -= disk_store_->front().FileBytes();
+        evicted.push_back(disk_store_->PinFront());
+        disk_store_->PopFront();
+      }
+    }
+  }
+}
+
 StatusOr<bool> Table::ExpireCold() {
   absl::base_internal::SpinLockHolder cold_lock(&cold_lock_);
   if (cold_store_->Size() == 0) {
     return false;
   }
-  cold_store_->PopFront();
+  if (!spill_dir_.empty()) {
+    // The batch is spilled to disk later on, by the compaction thread.
+    absl::base_internal::SpinLockHolder disk_lock(&disk_lock_);
+    cold_store_->MoveFrontTo(spill_queue_.get());
+    if (spill_queue_->Size() > kMaxSpillQueueBatches) {
+      LOG_EVERY_N(WARNING, 100)
+          << "Spilling to disk is falling behind, dropping expired cold batches.";
+      spill_queue_->PopFront();
+    }
+  } else {
+    cold_store_->PopFront();
+  }
   absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
   batch_size_accountant_->ExpireColdBatch();
   return true;
@@ -512,7 +805,9 @@ Status Table::UpdateTableMetricGauges() {
   auto stats = GetTableStats();
   // Set gauge values
   metrics_.cold_bytes_gauge.Set(stats.cold_bytes);
+  metrics_.cold_logical_bytes_gauge.Set(stats.cold_logical_bytes);
   metrics_.hot_bytes_gauge.Set(stats.hot_bytes);
+  metrics_.disk_bytes_gauge.Set(stats.disk_bytes);
   metrics_.num_batches_gauge.Set(stats.num_batches);
   metrics_.max_table_size_gauge.Set(stats.max_table_size);
   // Compute retention gauge
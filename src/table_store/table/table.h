@@ -23,6 +23,8 @@
 #include <arrow/record_batch.h>
 #include <algorithm>
 #include <deque>
+#include <filesystem>
+#include <limits>
 #include <memory>
 #include <optional>
 #include <string>
@@ -46,9 +48,14 @@
 #include "src/table_store/table/internal/record_or_row_batch.h"
 #include "src/table_store/table/internal/store_with_row_accounting.h"
 #include "src/table_store/table/internal/types.h"
+#include "src/table_store/table/internal/zone_map.h"
 #include "src/table_store/table/table_metrics.h"
 
 DECLARE_int32(table_store_table_size_limit);
+DECLARE_bool(table_store_dictionary_encode_strings);
+DECLARE_bool(table_store_compress_cold_batches);
+DECLARE_string(table_store_spill_dir);
+DECLARE_int64(table_store_table_disk_size_limit);
 
 namespace px {
 namespace table_store {
@@ -59,6 +66,11 @@ struct TableStats {
   int64_t bytes;
   int64_t hot_bytes;
   int64_t cold_bytes;
+  // Number of bytes the cold data would take up without encoding or compression. The difference to
+  // cold_bytes is the space saved by dictionary encoding and integer compression.
+  int64_t cold_logical_bytes;
+  // Number of bytes of expired cold data that were spilled to local disk. Not included in bytes.
+  int64_t disk_bytes;
   int64_t num_batches;
   int64_t batches_added;
   int64_t batches_expired;
@@ -71,14 +83,20 @@ struct TableStats {
 /**
  * Table stores data in two separate partitions, hot and cold. Hot data is "hot" from the
  * perspective of writes, in other words data is first written to the hot partitiion, and then later
- * moved to the cold partition. Reads can hit both hot and cold data. Hot data can be written in
- * RecordBatch format (i.e. for writes from stirling) or schema::RowBatch format (i.e. for writes
- * from MemorySinkNodes, which are not currently used). Both stores use a wrapper around std::deque
- * to store the data while keeping track of row and time indexes (see `StoreWithRowTimeAccounting`
- * and `Time and Row Indexing` below).
+ * moved to the cold partition. Reads can hit both hot and cold data. Optionally, cold batches that
+ * are expired from memory are spilled to a third partition on local disk (see `Disk Spilling`).
+ * Hot data can be written in RecordBatch format (i.e. for writes from stirling) or
+ * schema::RowBatch format (i.e. for writes from MemorySinkNodes, which are not currently used).
+ * All stores use a wrapper around std::deque to store the data while keeping track of row and time
+ * indexes (see `StoreWithRowTimeAccounting` and `Time and Row Indexing` below).
  *
  * Synchronization Scheme:
- * The hot and cold partitions are synchronized separately with spinlocks.
+ * The hot, cold and disk partitions are synchronized separately with spinlocks. When more than one
+ * of the locks is needed, they are acquired in the order cold, disk, hot. None of them are held
+ * while doing disk I/O.
+ * Readers only hold the locks while looking up the batch to read, and pin that batch (see
+ * `internal::PinnedBatchSlice`). Converting or decoding the batch into the returned RowBatch
+ * happens after the locks are released, so long reads don't stall writes or compaction.
  *
  * Compaction Scheme:
  * Hot batches are compacted into batches of size roughly `compacted_batch_size_` +/- the size of a
@@ -100,6 +118,23 @@ struct TableStats {
  * Cursor stores the unique row identifier of the last read row, so
  * that when GetNextRowBatch is called on the cursor it can work out that it needs to return a slice
  * of the batch with the original "second" batch's data.
+ *
+ * Zone Maps:
+ * Both stores keep the min and max value of each INT64, TIME64NS and UINT128 column for every batch.
+ * A Cursor can be created with a set of `ColumnPredicate`s, in which case batches whose zone maps
+ * prove that no row can satisfy the predicates are skipped without being read. The predicates only
+ * prune whole batches, the rows of returned batches still need to be filtered by the caller.
+ *
+ * Disk Spilling:
+ * If spilling is enabled (see `EnableSpillToDisk`), cold batches that are expired to make room for
+ * new data are written to segment files in the table's spill directory instead of being dropped,
+ * and are read back by memory mapping the segments (see `internal::DiskBatch`). The disk partition
+ * holds the oldest rows of the table and has its own size limit, once it is exceeded the oldest
+ * segments are deleted. Spilled data doesn't count towards the in-memory max_table_size.
+ * Expiring a batch happens on the write path, so it only moves the batch to a queue of batches to
+ * spill, which stays readable. The segments are written (and deleted) by `CompactHotToCold`, which
+ * runs on the compaction threads. At most kMaxSpillQueueBatches batches wait in the queue; if
+ * spilling falls behind, the oldest are dropped.
  */
 class Table : public NotCopyable {
   using RecordBatchPtr = internal::RecordBatchPtr;
@@ -115,13 +150,15 @@ class Table : public NotCopyable {
 
  public:
   static inline constexpr int64_t kMaxBatchesPerCompactionCall = 256;
+  static inline constexpr int64_t kMaxSpillQueueBatches = 64;
   using StopPosition = int64_t;
-  static inline std::shared_ptr<Table> Create(std::string_view table_name,
-                                              const schema::Relation& relation) {
-    // Create naked pointer, because std::make_shared() cannot access the private ctor.
-    return std::shared_ptr<Table>(
-        new Table(table_name, relation, FLAGS_table_store_table_size_limit));
-  }
+  using ColumnPredicate = internal::ColumnPredicate;
+  /**
+   * Create a table with the size limit given by the table store flags. If
+   * --table_store_spill_dir is set, spilling to disk is enabled for the table.
+   */
+  static std::shared_ptr<Table> Create(std::string_view table_name,
+                                       const schema::Relation& relation);
 
   /**
    * Cursor allows iterating the table, while guaranteeing that no row is returned twice (even when
@@ -174,7 +211,12 @@ class Table : public NotCopyable {
     };
 
     explicit Cursor(const Table* table) : Cursor(table, StartSpec{}, StopSpec{}) {}
-    Cursor(const Table* table, StartSpec start, StopSpec stop);
+    Cursor(const Table* table, StartSpec start, StopSpec stop)
+        : Cursor(table, start, stop, std::vector<ColumnPredicate>{}) {}
+    // The given predicates are used to skip batches that have no rows matching all of the
+    // predicates. The column indices of the predicates refer to the columns of the table.
+    Cursor(const Table* table, StartSpec start, StopSpec stop,
+           std::vector<ColumnPredicate> predicates);
 
     // In the case of StopType == Infinite or StopType == StopAtTime, this returns whether the table
     // has the next batch ready. In the case of StopType == CurrentEndOfTable, this returns !Done().
@@ -183,11 +225,20 @@ class Table : public NotCopyable {
     // `NextBatchReady()` and `GetNextRowBatch(...)`, and then the row batch after the expired one
     // is past the stopping condition. In this case `GetNextRowBatch(...)` will return an error.
     bool NextBatchReady();
-    StatusOr<std::unique_ptr<schema::RowBatch>> GetNextRowBatch(const std::vector<int64_t>& cols);
+    // Columns that are stored encoded are decoded into buffers allocated from mem_pool.
+    // Dictionary encoded string columns are only decoded if keep_dictionary_columns() is false.
+    StatusOr<std::unique_ptr<schema::RowBatch>> GetNextRowBatch(
+        const std::vector<int64_t>& cols,
+        arrow::MemoryPool* mem_pool = arrow::default_memory_pool());
     // In the case of StopType == Infinite, this function always returns false.
     bool Done();
     // Change the StopSpec of the cursor.
     void UpdateStopSpec(StopSpec stop);
+    // Whether GetNextRowBatch returns dictionary encoded string columns as arrow::DictionaryArrays,
+    // rather than decoding them into arrow::StringArrays. Off by default, since most readers only
+    // handle plain arrays.
+    bool keep_dictionary_columns() const { return keep_dictionary_columns_; }
+    void set_keep_dictionary_columns(bool keep) { keep_dictionary_columns_ = keep; }
 
    private:
     void AdvanceToStart(const StartSpec& start);
@@ -198,6 +249,7 @@ class Table : public NotCopyable {
     internal::RowID* LastReadRowID();
     internal::BatchHints* Hints();
     std::optional<internal::RowID> StopRowID() const;
+    const std::vector<ColumnPredicate>& Predicates() const { return predicates_; }
 
     struct StopState {
       StopSpec spec;
@@ -210,6 +262,8 @@ class Table : public NotCopyable {
     internal::BatchHints hints_;
     RowID last_read_row_id_;
     StopState stop_;
+    std::vector<ColumnPredicate> predicates_;
+    bool keep_dictionary_columns_ = false;
 
     friend class Table;
   };
@@ -229,14 +283,30 @@ class Table : public NotCopyable {
   Table(std::string_view table_name, const schema::Relation& relation, size_t max_table_size,
         size_t compacted_batch_size_);
 
+  ~Table();
+
+  /**
+   * Enables spilling expired cold batches to disk. Should be called before any data is written to
+   * the table.
+   * @param spill_dir directory to write the segment files to. It is created if it doesn't exist,
+   * and any existing contents are removed. The directory is removed when the table is destroyed.
+   * @param max_disk_bytes the maximum number of bytes of segment files the table keeps on disk.
+   * @return error if the spill directory can't be created.
+   */
+  Status EnableSpillToDisk(const std::filesystem::path& spill_dir, int64_t max_disk_bytes);
+
   /**
-   * Get a RowBatch of data corresponding to the next data after the given cursor.
+   * Get a RowBatch of data corresponding to the next data after the given cursor. If the cursor has
+   * predicates, batches that can't match them are skipped. If all the remaining batches up to the
+   * cursor's stop (or the end of the table) are skipped, a RowBatch with zero rows is returned.
    * @param cursor the Table::Cursor to get the next row batch after.
    * @param cols a vector of column indices to get data for.
+   * @param mem_pool the arrow MemoryPool that decoded columns are allocated from.
    * @return a unique ptr to a RowBatch with the requested data.
    */
   StatusOr<std::unique_ptr<schema::RowBatch>> GetNextRowBatch(
-      Cursor* cursor, const std::vector<int64_t>& cols) const;
+      Cursor* cursor, const std::vector<int64_t>& cols,
+      arrow::MemoryPool* mem_pool = arrow::default_memory_pool()) const;
 
   /**
    * Get the unique identifier of the first row in the table.
@@ -294,9 +364,31 @@ class Table : public NotCopyable {
 
   TableStats GetTableStats() const;
 
+  /**
+   * Identifies the rows of this table as a time ordered sequence of appends. The generation is
+   * unique among the tables of the process, and changes whenever rows are written that are older
+   * than rows already written, so state derived from the times of the rows under one generation
+   * never applies to another.
+   * @return the current generation of the table.
+   */
+  int64_t generation() const;
+
+  /**
+   * Returns the oldest time of the rows that were written out of time order since the table was at
+   * the given generation, so that state derived from the rows older than that time under the given
+   * generation is still valid. Only the most recent out of order writes are tracked exactly, older
+   * ones are folded together, which can only make the returned time older.
+   * @param generation A generation returned by generation().
+   * @return the oldest time written out of order since the generation, the max int64 if there were
+   * no such writes, or the min int64 if the generation isn't one of this table's.
+   */
+  Time MinTimeWrittenOutOfOrderSince(int64_t generation) const;
+
   /**
    * Compacts hot batches into compacted_batch_size_ sized cold batches. Each call to
    * CompactHotToCold will create a maximum of kMaxBatchesPerCompactionCall cold batches.
+   * If spilling to disk is enabled, this also spills the cold batches that were expired from
+   * memory since the last call.
    * @param mem_pool arrow MemoryPool to be used for creating new cold batches.
    */
   Status CompactHotToCold(arrow::MemoryPool* mem_pool);
@@ -322,22 +414,56 @@ class Table : public NotCopyable {
       ABSL_GUARDED_BY(cold_lock_);
   std::deque<int64_t> cold_batch_bytes_ ABSL_GUARDED_BY(cold_lock_);
 
+  mutable absl::base_internal::SpinLock disk_lock_;
+  // Cold batches that were expired from memory and are waiting to be spilled. Their rows come
+  // after the rows of the disk store, and before the rows of the cold store.
+  std::unique_ptr<internal::StoreWithRowTimeAccounting<internal::StoreType::Cold>> spill_queue_
+      ABSL_GUARDED_BY(disk_lock_);
+  std::unique_ptr<internal::StoreWithRowTimeAccounting<internal::StoreType::Disk>> disk_store_
+      ABSL_GUARDED_BY(disk_lock_);
+  int64_t disk_bytes_ ABSL_GUARDED_BY(disk_lock_) = 0;
+  // Empty if spilling to disk is disabled.
+  std::filesystem::path spill_dir_;
+  int64_t max_disk_bytes_ = 0;
+  // Serializes SpillQueuedBatches(), which writes the segments without holding the other locks.
+  absl::Mutex spill_lock_;
+  // Counter used to name the segment files of spilled batches.
+  int64_t next_segment_id_ ABSL_GUARDED_BY(spill_lock_) = 0;
+
   // Counter to assign a unique row ID to each row. Synchronized by hot_lock_ since its only
   // accessed on a hot write.
   int64_t next_row_id_ ABSL_GUARDED_BY(hot_lock_) = 0;
   int64_t time_col_idx_ = -1;
+  int64_t generation_ ABSL_GUARDED_BY(hot_lock_);
+  // The generation the table was created with.
+  int64_t first_generation_;
+  // The out of order writes of the table, as the generation they started and the oldest time they
+  // wrote, with both increasing. A write is dropped once a later write is at least as old, since
+  // any generation before the first also precedes the second. At most kMaxOutOfOrderWrites are
+  // kept, by folding the oldest write into the next one.
+  struct OutOfOrderWrite {
+    int64_t generation;
+    Time min_time;
+  };
+  static constexpr size_t kMaxOutOfOrderWrites = 64;
+  std::deque<OutOfOrderWrite> out_of_order_writes_ ABSL_GUARDED_BY(hot_lock_);
+  // The newest time of the rows written to the table.
+  int64_t max_time_written_ ABSL_GUARDED_BY(hot_lock_) = std::numeric_limits<int64_t>::min();
 
   Status WriteHot(internal::RecordOrRowBatch&& record_or_row_batch);
 
   Status ExpireBatch();
   Status ExpireHot();
   StatusOr<bool> ExpireCold();
+  void SpillQueuedBatches();
   Status ExpireRowBatches(int64_t row_batch_size);
   Status CompactSingleBatchUnlocked(arrow::MemoryPool* mem_pool)
       ABSL_EXCLUSIVE_LOCKS_REQUIRED(cold_lock_) ABSL_EXCLUSIVE_LOCKS_REQUIRED(hot_lock_);
   Status UpdateTableMetricGauges();
 
   Time MaxTime() const;
+  RowID FirstRowIDUnlocked() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(cold_lock_)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(disk_lock_);
 
   std::unique_ptr<internal::BatchSizeAccountant> batch_size_accountant_ ABSL_GUARDED_BY(hot_lock_);
 
@@ -24,6 +24,7 @@
 #include <numeric>
 #include <random>
 #include <thread>
+#include <vector>
 
 #include "src/shared/types/types.h"
 #include "src/table_store/table/table.h"
@@ -360,6 +361,54 @@ static void BM_TableThreaded(benchmark::State& state) {
   state.counters["Write"] = benchmark::Counter(write_average_time);
 }
 
+// Measures the latency of a single writer (with periodic compaction, like the table store does),
+// while state.range(0) reader threads continuously iterate the whole table.
+// NOLINTNEXTLINE : runtime/references.
+static void BM_TableWriteContention(benchmark::State& state) {
+  int64_t num_readers = state.range(0);
+  int64_t table_size = 4 * 1024 * 1024;
+  int64_t compaction_size = 64 * 1024;
+  int64_t batch_length = 256;
+  int64_t batches_per_compaction = 16;
+  auto table = MakeTable(table_size, compaction_size);
+  int64_t time_counter = FillTableCold(table.get(), table_size, batch_length);
+
+  absl::Notification done;
+  std::vector<std::thread> reader_threads;
+  for (int64_t i = 0; i < num_readers; ++i) {
+    reader_threads.emplace_back([&table, &done]() {
+      while (!done.HasBeenNotified()) {
+        Table::Cursor cursor(table.get());
+        while (!cursor.Done()) {
+          // Reads can fail if the rows are expired while reading, in which case we start over.
+          if (!cursor.GetNextRowBatch({0, 1}).ok()) {
+            break;
+          }
+        }
+      }
+    });
+  }
+
+  int64_t num_writes = 0;
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto batch = MakeHotBatch(batch_length, &time_counter);
+    state.ResumeTiming();
+    PX_CHECK_OK(table->TransferRecordBatch(std::move(batch)));
+    if (++num_writes % batches_per_compaction == 0) {
+      PX_CHECK_OK(table->CompactHotToCold(arrow::default_memory_pool()));
+    }
+  }
+
+  done.Notify();
+  for (auto& thread : reader_threads) {
+    thread.join();
+  }
+
+  int64_t batch_size = batch_length * sizeof(int64_t) + batch_length * sizeof(double);
+  state.SetBytesProcessed(state.iterations() * batch_size);
+}
+
 BENCHMARK(BM_TableReadAllHot);
 BENCHMARK(BM_TableReadAllCold);
 BENCHMARK(BM_TableReadLastBatchAllHot)->Iterations(1000);
@@ -368,5 +417,6 @@ BENCHMARK(BM_TableWriteEmpty);
 BENCHMARK(BM_TableWriteFull);
 BENCHMARK(BM_TableCompaction);
 BENCHMARK(BM_TableThreaded)->UseManualTime()->Iterations(1);
+BENCHMARK(BM_TableWriteContention)->Arg(0)->Arg(1)->Arg(4)->Arg(8)->UseRealTime();
 
 }  // namespace px::table_store
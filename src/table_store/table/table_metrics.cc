@@ -31,11 +31,22 @@ TableMetrics::TableMetrics(prometheus::Registry* registry, std::string table_nam
                            .Help("Current cold data bytes in the table")
                            .Register(*registry)
                            .Add({{"name", table_name}})),
+      cold_logical_bytes_gauge(
+          prometheus::BuildGauge()
+              .Name("table_cold_logical_bytes")
+              .Help("Current cold data bytes in the table, before encoding and compression")
+              .Register(*registry)
+              .Add({{"name", table_name}})),
       hot_bytes_gauge(prometheus::BuildGauge()
                           .Name("table_hot_bytes")
                           .Help("Current hot data bytes in the table")
                           .Register(*registry)
                           .Add({{"name", table_name}})),
+      disk_bytes_gauge(prometheus::BuildGauge()
+                           .Name("table_disk_bytes")
+                           .Help("Current bytes of the table spilled to local disk")
+                           .Register(*registry)
+                           .Add({{"name", table_name}})),
       num_batches_gauge(prometheus::BuildGauge()
                             .Name("table_num_batches")
                             .Help("Current number of row batches in the table")
@@ -58,6 +69,12 @@ TableMetrics::TableMetrics(prometheus::Registry* registry, std::string table_nam
               .Help("Total batches compacted in the table in the table's lifetime")
               .Register(*registry)
               .Add({{"name", table_name}})),
+      compaction_latency_ns_gauge(
+          prometheus::BuildGauge()
+              .Name("table_compaction_latency_ns")
+              .Help("Duration of the table's most recent hot to cold compaction, in nanoseconds")
+              .Register(*registry)
+              .Add({{"name", table_name}})),
       max_table_size_gauge(prometheus::BuildGauge()
                                .Name("table_max_table_size")
                                .Help("The cap on the table size")
@@ -68,3 +85,10 @@ TableMetrics::TableMetrics(prometheus::Registry* registry, std::string table_nam
                              .Help("The current retention window for data in this table")
                              .Register(*registry)
                              .Add({{"name", table_name}})) {}
+
+TableStoreMetrics::TableStoreMetrics(prometheus::Registry* registry)
+    : compaction_queue_depth_gauge(prometheus::BuildGauge()
+                                       .Name("table_store_compaction_queue_depth")
+                                       .Help("Number of tables waiting to be compacted")
+                                       .Register(*registry)
+                                       .Add({})) {}
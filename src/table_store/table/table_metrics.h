@@ -27,11 +27,21 @@ struct TableMetrics {
 
   prometheus::Counter& bytes_added_counter;
   prometheus::Gauge& cold_bytes_gauge;
+  prometheus::Gauge& cold_logical_bytes_gauge;
   prometheus::Gauge& hot_bytes_gauge;
+  prometheus::Gauge& disk_bytes_gauge;
   prometheus::Gauge& num_batches_gauge;
   prometheus::Counter& batches_added_counter;
   prometheus::Counter& batches_expired_counter;
   prometheus::Counter& compacted_batches_counter;
+  prometheus::Gauge& compaction_latency_ns_gauge;
   prometheus::Gauge& max_table_size_gauge;
   prometheus::Gauge& retention_ns_gauge;
 };
+
+// Metrics of the table store as a whole, rather than of a single table.
+struct TableStoreMetrics {
+  explicit TableStoreMetrics(prometheus::Registry* registry);
+
+  prometheus::Gauge& compaction_queue_depth_gauge;
+};
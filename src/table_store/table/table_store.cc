@@ -17,11 +17,18 @@
  */
 
 #include <algorithm>
+#include <memory>
 #include <utility>
 #include <vector>
 
+#include "src/common/metrics/metrics.h"
 #include "src/table_store/table/table_store.h"
 
+DEFINE_int32(table_store_compaction_threads,
+             gflags::Int32FromEnv("PL_TABLE_STORE_COMPACTION_THREADS", 2),
+             "Number of background threads that compact tables from hot to cold. If 0, tables are "
+             "compacted inline on the caller's thread.");
+
 namespace px {
 namespace table_store {
 
@@ -165,5 +172,23 @@ Status TableStore::RunCompaction(arrow::MemoryPool* mem_pool) {
   return Status::OK();
 }
 
+Status TableStore::ScheduleCompaction(arrow::MemoryPool* mem_pool) {
+  if (FLAGS_table_store_compaction_threads <= 0) {
+    return RunCompaction(mem_pool);
+  }
+  if (compaction_scheduler_ == nullptr) {
+    metrics_ = std::make_unique<TableStoreMetrics>(&GetMetricsRegistry());
+    compaction_scheduler_ = std::make_unique<CompactionScheduler>(
+        FLAGS_table_store_compaction_threads, mem_pool, &metrics_->compaction_queue_depth_gauge);
+  }
+  std::vector<std::shared_ptr<Table>> tables;
+  tables.reserve(name_to_table_map_.size());
+  for (const auto& it : name_to_table_map_) {
+    tables.push_back(it.second);
+  }
+  compaction_scheduler_->Schedule(tables);
+  return Status::OK();
+}
+
 }  // namespace table_store
 }  // namespace px
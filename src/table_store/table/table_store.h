@@ -31,9 +31,13 @@
 #include "src/shared/types/hash_utils.h"
 #include "src/table_store/schema/relation.h"
 #include "src/table_store/schema/schema.h"
+#include "src/table_store/table/compaction_scheduler.h"
 #include "src/table_store/table/table.h"
+#include "src/table_store/table/table_metrics.h"
 #include "src/table_store/table/tablets_group.h"
 
+DECLARE_int32(table_store_compaction_threads);
+
 namespace px {
 namespace table_store {
 
@@ -167,6 +171,15 @@ class TableStore {
 
   Status RunCompaction(arrow::MemoryPool* mem_pool);
 
+  /**
+   * ScheduleCompaction queues every table for hot to cold compaction on a pool of background
+   * threads, and returns without waiting for the compactions to finish. Tables with the most hot
+   * data and the highest ingest rate are compacted first. If
+   * FLAGS_table_store_compaction_threads is 0, this compacts every table inline, like
+   * RunCompaction.
+   */
+  Status ScheduleCompaction(arrow::MemoryPool* mem_pool);
+
  private:
   void RegisterTableName(const std::string& table_name, const types::TabletID& tablet_id,
                          const schema::Relation& table_relation,
@@ -197,6 +210,10 @@ class TableStore {
   absl::flat_hash_map<std::string, schema::Relation> name_to_relation_map_;
   // Mapping from id to name and relation pair for adding new tablets.
   absl::flat_hash_map<uint64_t, TableInfo> id_to_table_info_map_;
+  // Created on the first call to ScheduleCompaction, along with the metrics that it exports.
+  // Declared last, so that the workers are stopped before the tables and metrics are destroyed.
+  std::unique_ptr<TableStoreMetrics> metrics_;
+  std::unique_ptr<CompactionScheduler> compaction_scheduler_;
 };
 
 }  // namespace table_store
@@ -20,12 +20,15 @@
 #include <arrow/array.h>
 #include <google/protobuf/text_format.h>
 #include <google/protobuf/util/message_differencer.h>
+#include <filesystem>
+#include <limits>
 #include <random>
 #include <vector>
 
 #include "src/common/testing/testing.h"
 #include "src/shared/types/arrow_adapter.h"
 #include "src/shared/types/typespb/types.pb.h"
+#include "src/table_store/schema/dictionary_encoding.h"
 #include "src/table_store/schema/relation.h"
 #include "src/table_store/schemapb/schema.pb.h"
 #include "src/table_store/table/table.h"
@@ -289,6 +292,27 @@ TEST(TableTest, expiry_test) {
   EXPECT_EQ(table.GetTableStats().bytes, rb5_size);
 }
 
+TEST(TableTest, compaction_is_bounded_per_call) {
+  schema::Relation rel({types::DataType::INT64}, {"col1"});
+  // Every written batch becomes its own cold batch.
+  Table table("test_table", rel, 1024 * 1024, sizeof(int64_t));
+  const int64_t num_batches = Table::kMaxBatchesPerCompactionCall + 10;
+  for (int64_t i = 0; i < num_batches; ++i) {
+    schema::RowBatch rb(schema::RowDescriptor(rel.col_types()), 1);
+    std::vector<types::Int64Value> values = {i};
+    EXPECT_OK(rb.AddColumn(types::ToArrow(values, arrow::default_memory_pool())));
+    EXPECT_OK(table.WriteRowBatch(rb));
+  }
+
+  EXPECT_OK(table.CompactHotToCold(arrow::default_memory_pool()));
+  EXPECT_EQ(Table::kMaxBatchesPerCompactionCall, table.GetTableStats().compacted_batches);
+  EXPECT_EQ(static_cast<int64_t>(10 * sizeof(int64_t)), table.GetTableStats().hot_bytes);
+
+  EXPECT_OK(table.CompactHotToCold(arrow::default_memory_pool()));
+  EXPECT_EQ(num_batches, table.GetTableStats().compacted_batches);
+  EXPECT_EQ(0, table.GetTableStats().hot_bytes);
+}
+
 TEST(TableTest, expiry_test_w_compaction) {
   auto rd = schema::RowDescriptor({types::DataType::INT64, types::DataType::STRING});
   schema::Relation rel(rd.types(), {"col1", "col2"});
@@ -575,6 +599,73 @@ TEST(TableTest, find_rowid_from_time_first_greater_than_or_equal) {
             table.FindRowIDFromTimeFirstGreaterThanOrEqual(24));
 }
 
+TEST(TableTest, generation_changes_on_out_of_order_write) {
+  schema::Relation rel(std::vector<types::DataType>({types::DataType::TIME64NS}),
+                       std::vector<std::string>({"time_"}));
+  Table table("test_table", rel, 128 * 1024);
+  Table other_table("test_table", rel, 128 * 1024);
+  EXPECT_NE(table.generation(), other_table.generation());
+
+  auto write_times = [&](std::vector<types::Time64NSValue> times) {
+    auto wrapper_batch = std::make_unique<types::ColumnWrapperRecordBatch>();
+    auto col_wrapper = std::make_shared<types::Time64NSValueColumnWrapper>(times.size());
+    col_wrapper->Clear();
+    col_wrapper->AppendFromVector(times);
+    wrapper_batch->push_back(col_wrapper);
+    EXPECT_OK(table.TransferRecordBatch(std::move(wrapper_batch)));
+  };
+
+  auto generation = table.generation();
+  write_times({2, 3, 4});
+  write_times({4, 6, 8});
+  EXPECT_EQ(generation, table.generation());
+
+  // A row older than rows that were already written.
+  write_times({7, 9});
+  EXPECT_NE(generation, table.generation());
+  EXPECT_NE(other_table.generation(), table.generation());
+
+  generation = table.generation();
+  write_times({9, 10});
+  EXPECT_EQ(generation, table.generation());
+}
+
+TEST(TableTest, min_time_written_out_of_order_since) {
+  schema::Relation rel(std::vector<types::DataType>({types::DataType::TIME64NS}),
+                       std::vector<std::string>({"time_"}));
+  Table table("test_table", rel, 128 * 1024);
+  auto write_times = [&](std::vector<types::Time64NSValue> times) {
+    auto wrapper_batch = std::make_unique<types::ColumnWrapperRecordBatch>();
+    auto col_wrapper = std::make_shared<types::Time64NSValueColumnWrapper>(times.size());
+    col_wrapper->Clear();
+    col_wrapper->AppendFromVector(times);
+    wrapper_batch->push_back(col_wrapper);
+    EXPECT_OK(table.TransferRecordBatch(std::move(wrapper_batch)));
+  };
+
+  write_times({10, 20, 30});
+  auto first = table.generation();
+  EXPECT_EQ(std::numeric_limits<int64_t>::max(), table.MinTimeWrittenOutOfOrderSince(first));
+
+  write_times({25, 40});
+  auto second = table.generation();
+  EXPECT_EQ(25, table.MinTimeWrittenOutOfOrderSince(first));
+  EXPECT_EQ(std::numeric_limits<int64_t>::max(), table.MinTimeWrittenOutOfOrderSince(second));
+
+  write_times({35});
+  EXPECT_EQ(25, table.MinTimeWrittenOutOfOrderSince(first));
+  EXPECT_EQ(35, table.MinTimeWrittenOutOfOrderSince(second));
+  // An older late row covers all of the generations before it.
+  write_times({15});
+  EXPECT_EQ(15, table.MinTimeWrittenOutOfOrderSince(first));
+  EXPECT_EQ(15, table.MinTimeWrittenOutOfOrderSince(second));
+
+  // Generations of other tables are never valid.
+  Table other_table("test_table", rel, 128 * 1024);
+  EXPECT_EQ(std::numeric_limits<int64_t>::min(),
+            other_table.MinTimeWrittenOutOfOrderSince(first));
+}
+
 TEST(TableTest, find_rowid_from_time_first_greater_than_or_equal_with_compaction) {
   schema::Relation rel(std::vector<types::DataType>({types::DataType::TIME64NS}),
                        std::vector<std::string>({"time_"}));
@@ -939,6 +1030,262 @@ TEST(TableTest, GetNextRowBatch_after_expiry) {
   EXPECT_TRUE(rb1->ColumnAt(1)->Equals(types::ToArrow(col2_in2, arrow::default_memory_pool())));
 }
 
+TEST(TableTest, cursor_with_predicates_skips_batches) {
+  schema::Relation rel({types::DataType::BOOLEAN, types::DataType::INT64}, {"col1", "col2"});
+  Table table("test_table", rel, 128 * 1024, 3 * sizeof(bool) + 3 * sizeof(int64_t));
+
+  auto write_batch = [&](const std::vector<types::BoolValue>& col1,
+                         const std::vector<types::Int64Value>& col2) {
+    auto rb = schema::RowBatch(schema::RowDescriptor(rel.col_types()), col1.size());
+    PX_CHECK_OK(rb.AddColumn(types::ToArrow(col1, arrow::default_memory_pool())));
+    PX_CHECK_OK(rb.AddColumn(types::ToArrow(col2, arrow::default_memory_pool())));
+    PX_CHECK_OK(table.WriteRowBatch(rb));
+  };
+  write_batch({true, false, true}, {1, 2, 3});
+  write_batch({false, false, true}, {10, 11, 12});
+  // Move the first two batches into the cold store, so that both stores are exercised.
+  EXPECT_OK(table.CompactHotToCold(arrow::default_memory_pool()));
+  write_batch({true, true}, {20, 21});
+  write_batch({false, true}, {30, 31});
+
+  std::vector<Table::ColumnPredicate> predicates = {
+      {1, Table::ColumnPredicate::kGreaterThan, int64_t{5}},
+      {1, Table::ColumnPredicate::kLessThanEqual, int64_t{20}},
+  };
+  Table::Cursor cursor(&table, Table::Cursor::StartSpec{}, Table::Cursor::StopSpec{}, predicates);
+
+  ASSERT_OK_AND_ASSIGN(auto rb1, cursor.GetNextRowBatch({1}));
+  std::vector<types::Int64Value> expected1 = {10, 11, 12};
+  EXPECT_TRUE(rb1->ColumnAt(0)->Equals(types::ToArrow(expected1, arrow::default_memory_pool())));
+
+  ASSERT_OK_AND_ASSIGN(auto rb2, cursor.GetNextRowBatch({1}));
+  std::vector<types::Int64Value> expected2 = {20, 21};
+  EXPECT_TRUE(rb2->ColumnAt(0)->Equals(types::ToArrow(expected2, arrow::default_memory_pool())));
+  EXPECT_FALSE(cursor.Done());
+
+  // The last batch can't match the predicates, so the cursor skips it and returns no rows.
+  ASSERT_OK_AND_ASSIGN(auto rb3, cursor.GetNextRowBatch({1}));
+  EXPECT_EQ(0, rb3->num_rows());
+  EXPECT_EQ(1, rb3->num_columns());
+  EXPECT_TRUE(cursor.Done());
+}
+
+TEST(TableTest, compressed_cold_batches) {
+  PX_SET_FOR_SCOPE(FLAGS_table_store_compress_cold_batches, true);
+  schema::Relation rel({types::DataType::TIME64NS, types::DataType::INT64}, {"time_", "col2"});
+  constexpr int64_t kNumRows = 1000;
+  Table table("test_table", rel, 128 * 1024, kNumRows * 2 * sizeof(int64_t));
+
+  std::vector<types::Time64NSValue> times;
+  std::vector<types::Int64Value> values;
+  for (int64_t i = 0; i < kNumRows; ++i) {
+    times.push_back(1000000 + 10 * i);
+    values.push_back(i % 7);
+  }
+  auto rb = schema::RowBatch(schema::RowDescriptor(rel.col_types()), kNumRows);
+  EXPECT_OK(rb.AddColumn(types::ToArrow(times, arrow::default_memory_pool())));
+  EXPECT_OK(rb.AddColumn(types::ToArrow(values, arrow::default_memory_pool())));
+  EXPECT_OK(table.WriteRowBatch(rb));
+  EXPECT_OK(table.CompactHotToCold(arrow::default_memory_pool()));
+
+  auto stats = table.GetTableStats();
+  EXPECT_EQ(0, stats.hot_bytes);
+  EXPECT_EQ(kNumRows * 2 * sizeof(int64_t), stats.cold_logical_bytes);
+  EXPECT_LT(stats.cold_bytes, stats.cold_logical_bytes);
+  EXPECT_EQ(stats.cold_bytes, stats.bytes);
+
+  Table::Cursor cursor(&table);
+  ASSERT_OK_AND_ASSIGN(auto all_rows, cursor.GetNextRowBatch({0, 1}));
+  EXPECT_TRUE(all_rows->ColumnAt(0)->Equals(types::ToArrow(times, arrow::default_memory_pool())));
+  EXPECT_TRUE(all_rows->ColumnAt(1)->Equals(types::ToArrow(values, arrow::default_memory_pool())));
+
+  // Time based lookups have to search the compressed time column.
+  Table::Cursor time_cursor(&table,
+                            Table::Cursor::StartSpec{Table::Cursor::StartSpec::StartAtTime,
+                                                     1000000 + 10 * 500 - 5},
+                            Table::Cursor::StopSpec{});
+  ASSERT_OK_AND_ASSIGN(auto later_rows, time_cursor.GetNextRowBatch({1}));
+  ASSERT_EQ(kNumRows - 500, later_rows->num_rows());
+  EXPECT_TRUE(later_rows->ColumnAt(0)->Equals(
+      types::ToArrow(values, arrow::default_memory_pool())->Slice(500)));
+}
+
+TEST(TableTest, dictionary_encoded_cold_batches) {
+  PX_SET_FOR_SCOPE(FLAGS_table_store_dictionary_encode_strings, true);
+  schema::Relation rel({types::DataType::TIME64NS, types::DataType::STRING}, {"time_", "method"});
+  constexpr int64_t kNumRows = 1000;
+  std::vector<types::Time64NSValue> times;
+  std::vector<types::StringValue> methods;
+  int64_t batch_bytes = 0;
+  for (int64_t i = 0; i < kNumRows; ++i) {
+    times.push_back(1000000 + 10 * i);
+    methods.push_back(i % 3 == 0 ? "GET" : "POST");
+    batch_bytes += sizeof(int64_t) + sizeof(uint32_t) + methods.back().size();
+  }
+  Table table("test_table", rel, 128 * 1024, batch_bytes);
+  auto rb = schema::RowBatch(schema::RowDescriptor(rel.col_types()), kNumRows);
+  EXPECT_OK(rb.AddColumn(types::ToArrow(times, arrow::default_memory_pool())));
+  EXPECT_OK(rb.AddColumn(types::ToArrow(methods, arrow::default_memory_pool())));
+  EXPECT_OK(table.WriteRowBatch(rb));
+  EXPECT_OK(table.CompactHotToCold(arrow::default_memory_pool()));
+
+  auto stats = table.GetTableStats();
+  EXPECT_EQ(0, stats.hot_bytes);
+  EXPECT_LT(stats.cold_bytes, stats.cold_logical_bytes);
+
+  // Readers get plain string columns, unless they ask for the codes.
+  auto expected_methods = types::ToArrow(methods, arrow::default_memory_pool());
+  Table::Cursor cursor(&table);
+  ASSERT_OK_AND_ASSIGN(auto decoded_rows, cursor.GetNextRowBatch({1}));
+  EXPECT_TRUE(decoded_rows->ColumnAt(0)->Equals(expected_methods));
+
+  Table::Cursor encoded_cursor(&table);
+  encoded_cursor.set_keep_dictionary_columns(true);
+  ASSERT_OK_AND_ASSIGN(auto encoded_rows, encoded_cursor.GetNextRowBatch({1}));
+  ASSERT_TRUE(schema::IsDictionaryArray(encoded_rows->ColumnAt(0).get()));
+  ASSERT_OK_AND_ASSIGN(auto decoded, schema::DecodeDictionaryArray(encoded_rows->ColumnAt(0).get(),
+                                                                   arrow::default_memory_pool()));
+  EXPECT_TRUE(decoded->Equals(expected_methods));
+}
+
+TEST(TableTest, spill_expired_cold_batches_to_disk) {
+  px::testing::TempDir spill_dir;
+  schema::Relation rel({types::DataType::TIME64NS, types::DataType::INT64}, {"time_", "col2"});
+  constexpr int64_t kNumRows = 1000;
+  constexpr int64_t kBatchBytes = kNumRows * 2 * sizeof(int64_t);
+  // The table only fits a single uncompressed batch in memory.
+  Table table("test_table", rel, kBatchBytes, kBatchBytes);
+  ASSERT_OK(table.EnableSpillToDisk(spill_dir.path() / "test_table", 1024 * 1024));
+
+  std::vector<types::Time64NSValue> times;
+  std::vector<types::Int64Value> values;
+  for (int64_t i = 0; i < 2 * kNumRows; ++i) {
+    times.push_back(1000000 + 10 * i);
+    values.push_back(i % 7);
+  }
+  auto times_arr = types::ToArrow(times, arrow::default_memory_pool());
+  auto values_arr = types::ToArrow(values, arrow::default_memory_pool());
+  for (int64_t batch = 0; batch < 2; ++batch) {
+    auto rb = schema::RowBatch(schema::RowDescriptor(rel.col_types()), kNumRows);
+    EXPECT_OK(rb.AddColumn(times_arr->Slice(batch * kNumRows, kNumRows)));
+    EXPECT_OK(rb.AddColumn(values_arr->Slice(batch * kNumRows, kNumRows)));
+    EXPECT_OK(table.WriteRowBatch(rb));
+    EXPECT_OK(table.CompactHotToCold(arrow::default_memory_pool()));
+  }
+
+  // Writing the second batch expired the first one from memory, and spilled it to disk.
+  auto stats = table.GetTableStats();
+  EXPECT_EQ(0, stats.hot_bytes);
+  EXPECT_GT(stats.disk_bytes, 0);
+  EXPECT_EQ(2, stats.num_batches);
+  EXPECT_EQ(1000000, stats.min_time);
+
+  Table::Cursor cursor(&table);
+  ASSERT_OK_AND_ASSIGN(auto disk_rows, cursor.GetNextRowBatch({0, 1}));
+  EXPECT_TRUE(disk_rows->ColumnAt(0)->Equals(times_arr->Slice(0, kNumRows)));
+  EXPECT_TRUE(disk_rows->ColumnAt(1)->Equals(values_arr->Slice(0, kNumRows)));
+  ASSERT_OK_AND_ASSIGN(auto cold_rows, cursor.GetNextRowBatch({0, 1}));
+  EXPECT_TRUE(cold_rows->ColumnAt(0)->Equals(times_arr->Slice(kNumRows)));
+  EXPECT_TRUE(cold_rows->ColumnAt(1)->Equals(values_arr->Slice(kNumRows)));
+  EXPECT_TRUE(cursor.Done());
+
+  // Time based lookups search the time column of the spilled batch.
+  Table::Cursor time_cursor(&table,
+                            Table::Cursor::StartSpec{Table::Cursor::StartSpec::StartAtTime,
+                                                     1000000 + 10 * 500 - 5},
+                            Table::Cursor::StopSpec{});
+  ASSERT_OK_AND_ASSIGN(auto later_rows, time_cursor.GetNextRowBatch({1}));
+  ASSERT_EQ(kNumRows - 500, later_rows->num_rows());
+  EXPECT_TRUE(later_rows->ColumnAt(0)->Equals(values_arr->Slice(500, kNumRows - 500)));
+}
+
+TEST(TableTest, cold_batches_pending_spill_stay_readable) {
+  px::testing::TempDir spill_dir;
+  schema::Relation rel({types::DataType::TIME64NS, types::DataType::INT64}, {"time_", "col2"});
+  constexpr int64_t kNumRows = 1000;
+  constexpr int64_t kBatchBytes = kNumRows * 2 * sizeof(int64_t);
+  Table table("test_table", rel, kBatchBytes, kBatchBytes);
+  ASSERT_OK(table.EnableSpillToDisk(spill_dir.path() / "test_table", 1024 * 1024));
+
+  std::vector<types::Time64NSValue> times;
+  std::vector<types::Int64Value> values;
+  for (int64_t i = 0; i < 2 * kNumRows; ++i) {
+    times.push_back(1000000 + 10 * i);
+    values.push_back(i % 7);
+  }
+  auto times_arr = types::ToArrow(times, arrow::default_memory_pool());
+  auto values_arr = types::ToArrow(values, arrow::default_memory_pool());
+  for (int64_t batch = 0; batch < 2; ++batch) {
+    auto rb = schema::RowBatch(schema::RowDescriptor(rel.col_types()), kNumRows);
+    EXPECT_OK(rb.AddColumn(times_arr->Slice(batch * kNumRows, kNumRows)));
+    EXPECT_OK(rb.AddColumn(values_arr->Slice(batch * kNumRows, kNumRows)));
+    EXPECT_OK(table.WriteRowBatch(rb));
+    if (batch == 0) {
+      EXPECT_OK(table.CompactHotToCold(arrow::default_memory_pool()));
+    }
+  }
+
+  // Writing the second batch expired the first one, but it isn't spilled until the next compaction.
+  auto stats = table.GetTableStats();
+  EXPECT_EQ(0, stats.disk_bytes);
+  EXPECT_EQ(2, stats.num_batches);
+  EXPECT_EQ(1000000, stats.min_time);
+  EXPECT_EQ(0, table.FirstRowID());
+
+  Table::Cursor cursor(&table);
+  ASSERT_OK_AND_ASSIGN(auto pending_rows, cursor.GetNextRowBatch({0, 1}));
+  EXPECT_TRUE(pending_rows->ColumnAt(0)->Equals(times_arr->Slice(0, kNumRows)));
+  EXPECT_TRUE(pending_rows->ColumnAt(1)->Equals(values_arr->Slice(0, kNumRows)));
+
+  EXPECT_OK(table.CompactHotToCold(arrow::default_memory_pool()));
+  EXPECT_GT(table.GetTableStats().disk_bytes, 0);
+  EXPECT_EQ(0, table.FirstRowID());
+  // The cursor continues after the spilled batch.
+  ASSERT_OK_AND_ASSIGN(auto hot_rows, cursor.GetNextRowBatch({0, 1}));
+  EXPECT_TRUE(hot_rows->ColumnAt(0)->Equals(times_arr->Slice(kNumRows)));
+  EXPECT_TRUE(cursor.Done());
+}
+
+TEST(TableTest, spill_to_disk_expires_oldest_segments) {
+  px::testing::TempDir spill_dir;
+  schema::Relation rel({types::DataType::TIME64NS, types::DataType::INT64}, {"time_", "col2"});
+  constexpr int64_t kNumRows = 1000;
+  constexpr int64_t kBatchBytes = kNumRows * 2 * sizeof(int64_t);
+  Table table("test_table", rel, kBatchBytes, kBatchBytes);
+  // Only a single spilled batch fits on disk.
+  ASSERT_OK(table.EnableSpillToDisk(spill_dir.path() / "test_table", kBatchBytes + 1024));
+
+  std::unique_ptr<Table::Cursor> cursor;
+  for (int64_t batch = 0; batch < 4; ++batch) {
+    std::vector<types::Time64NSValue> times;
+    std::vector<types::Int64Value> values;
+    for (int64_t i = 0; i < kNumRows; ++i) {
+      times.push_back(1000000 + 10 * (batch * kNumRows + i));
+      values.push_back(i);
+    }
+    auto rb = schema::RowBatch(schema::RowDescriptor(rel.col_types()), kNumRows);
+    EXPECT_OK(rb.AddColumn(types::ToArrow(times, arrow::default_memory_pool())));
+    EXPECT_OK(rb.AddColumn(types::ToArrow(values, arrow::default_memory_pool())));
+    EXPECT_OK(table.WriteRowBatch(rb));
+    EXPECT_OK(table.CompactHotToCold(arrow::default_memory_pool()));
+    if (cursor == nullptr) {
+      cursor = std::make_unique<Table::Cursor>(
+          &table, Table::Cursor::StartSpec{},
+          Table::Cursor::StopSpec{Table::Cursor::StopSpec::StopType::Infinite});
+    }
+  }
+
+  // The first two batches were spilled, but the first one was deleted again.
+  EXPECT_EQ(2 * kNumRows, table.FirstRowID());
+  EXPECT_EQ(1000000 + 10 * 2 * kNumRows, table.GetTableStats().min_time);
+  EXPECT_EQ(1, std::distance(std::filesystem::directory_iterator(spill_dir.path() / "test_table"),
+                             std::filesystem::directory_iterator{}));
+
+  // A cursor pointing at a deleted batch moves to the start of the table.
+  ASSERT_OK_AND_ASSIGN(auto rb, cursor->GetNextRowBatch({1}));
+  EXPECT_EQ(kNumRows, rb->num_rows());
+}
+
 struct CursorTestCase {
   std::string name;
   std::vector<std::vector<int64_t>> initial_time_batches;
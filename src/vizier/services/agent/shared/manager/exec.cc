@@ -18,6 +18,7 @@
 
 #include "src/vizier/services/agent/shared/manager/exec.h"
 
+#include <algorithm>
 #include <memory>
 #include <string>
 #include <utility>
@@ -29,6 +30,15 @@
 #include "src/common/perf/perf.h"
 #include "src/vizier/services/agent/shared/manager/manager.h"
 
+DEFINE_int64(max_concurrent_queries, gflags::Int64FromEnv("PL_MAX_CONCURRENT_QUERIES", 0),
+             "The number of queries that an agent runs at once. Further queries are queued until "
+             "a running query completes. 0 disables the limit.");
+DEFINE_int64(max_queued_queries, gflags::Int64FromEnv("PL_MAX_QUEUED_QUERIES", 64),
+             "The number of queries that an agent queues for admission. Further queries fail "
+             "right away.");
+DEFINE_int64(max_query_queue_wait_ms, gflags::Int64FromEnv("PL_MAX_QUERY_QUEUE_WAIT_MS", 30000),
+             "The time that a query waits to be admitted before it fails.");
+
 namespace px {
 namespace vizier {
 namespace agent {
@@ -37,17 +47,32 @@ using ::px::event::AsyncTask;
 
 class ExecuteQueryMessageHandler::ExecuteQueryTask : public AsyncTask {
  public:
+  /**
+   * @param reject_reason if not OK, the query is failed with this error instead of being executed.
+   */
   ExecuteQueryTask(ExecuteQueryMessageHandler* h, carnot::Carnot* carnot,
-                   std::unique_ptr<messages::VizierMessage> msg)
+                   std::unique_ptr<messages::VizierMessage> msg,
+                   Status reject_reason = Status::OK())
       : parent_(h),
         carnot_(carnot),
         msg_(std::move(msg)),
         req_(msg_->execute_query_request()),
-        query_id_(ParseUUID(req_.query_id()).ConsumeValueOrDie()) {}
+        query_id_(ParseUUID(req_.query_id()).ConsumeValueOrDie()),
+        reject_reason_(std::move(reject_reason)) {}
 
   sole::uuid query_id() { return query_id_; }
 
   void Work() override {
+    if (!reject_reason_.ok()) {
+      LOG(WARNING) << absl::Substitute("Rejected query $0, reason: $1", query_id_.str(),
+                                       reject_reason_.ToString());
+      auto s = carnot_->RejectPlan(req_.plan(), query_id_, reject_reason_);
+      if (!s.ok()) {
+        LOG(ERROR) << absl::Substitute("Failed to report rejected query $0: $1", query_id_.str(),
+                                       s.ToString());
+      }
+      return;
+    }
     LOG(INFO) << absl::Substitute("Executing query: id=$0", query_id_.str());
     VLOG(1) << absl::Substitute("Query Plan: $0=$1", query_id_.str(), req_.plan().DebugString());
 
@@ -73,6 +98,7 @@ class ExecuteQueryMessageHandler::ExecuteQueryTask : public AsyncTask {
   std::unique_ptr<messages::VizierMessage> msg_;
   const messages::ExecuteQueryRequest& req_;
   sole::uuid query_id_;
+  Status reject_reason_;
 };
 
 ExecuteQueryMessageHandler::ExecuteQueryMessageHandler(px::event::Dispatcher* dispatcher,
@@ -81,13 +107,106 @@ ExecuteQueryMessageHandler::ExecuteQueryMessageHandler(px::event::Dispatcher* di
                                                        carnot::Carnot* carnot)
     : MessageHandler(dispatcher, agent_info, nats_conn),
       carnot_(carnot),
+      queue_timer_(dispatcher->CreateTimer([this] { ExpireQueuedQueries(); })),
       num_queries_in_flight_(prometheus::BuildGauge()
                                  .Name("num_queries_in_flight")
                                  .Help("The number of queries currently running.")
                                  .Register(GetMetricsRegistry())
-                                 .Add({})) {}
+                                 .Add({})),
+      num_queries_queued_(prometheus::BuildGauge()
+                              .Name("num_queries_queued")
+                              .Help("The number of queries waiting to be admitted.")
+                              .Register(GetMetricsRegistry())
+                              .Add({})) {}
 
 Status ExecuteQueryMessageHandler::HandleMessage(std::unique_ptr<messages::VizierMessage> msg) {
+  // Queries that arrive while others are queued wait their turn, even if they would fit.
+  if (!queued_queries_.empty() || !CanAdmitQuery()) {
+    if (static_cast<int64_t>(queued_queries_.size()) >= FLAGS_max_queued_queries) {
+      RejectQuery(std::move(msg),
+                  error::ResourceUnavailable("Agent is busy: $0 queries are running and $1 are "
+                                             "queued, try again later.",
+                                             running_queries_.size(), queued_queries_.size()));
+      return Status::OK();
+    }
+    LOG(INFO) << absl::Substitute("Queueing query. Queries in flight: $0, queued: $1",
+                                  running_queries_.size(), queued_queries_.size());
+    queued_queries_.push_back({std::move(msg), dispatcher()->GetTimeSource().MonotonicTime()});
+    num_queries_queued_.Set(queued_queries_.size());
+    ArmQueueTimer();
+    return Status::OK();
+  }
+  RunQuery(std::move(msg));
+  return Status::OK();
+}
+
+bool ExecuteQueryMessageHandler::CanAdmitQuery() const {
+  // Always admit a query when nothing else runs, so that queries can't wait forever.
+  if (running_queries_.empty()) {
+    return true;
+  }
+  if (FLAGS_max_concurrent_queries > 0 &&
+      static_cast<int64_t>(running_queries_.size()) >= FLAGS_max_concurrent_queries) {
+    return false;
+  }
+  const auto* memory_tracker = carnot_->GetEngineState()->memory_tracker();
+  if (memory_tracker->limit_bytes() > 0 &&
+      memory_tracker->available_bytes() < FLAGS_carnot_query_memory_limit_bytes) {
+    return false;
+  }
+  return true;
+}
+
+void ExecuteQueryMessageHandler::RunQueuedQueries() {
+  while (!queued_queries_.empty() && CanAdmitQuery()) {
+    auto msg = std::move(queued_queries_.front().msg);
+    queued_queries_.pop_front();
+    RunQuery(std::move(msg));
+  }
+  num_queries_queued_.Set(queued_queries_.size());
+  ArmQueueTimer();
+}
+
+void ExecuteQueryMessageHandler::ExpireQueuedQueries() {
+  auto deadline = dispatcher()->GetTimeSource().MonotonicTime() -
+                  std::chrono::milliseconds(FLAGS_max_query_queue_wait_ms);
+  while (!queued_queries_.empty() && queued_queries_.front().queued_at <= deadline) {
+    auto msg = std::move(queued_queries_.front().msg);
+    queued_queries_.pop_front();
+    RejectQuery(std::move(msg), error::DeadlineExceeded(
+                                    "Query was not admitted within $0ms, $1 queries are running.",
+                                    FLAGS_max_query_queue_wait_ms, running_queries_.size()));
+  }
+  num_queries_queued_.Set(queued_queries_.size());
+  ArmQueueTimer();
+}
+
+void ExecuteQueryMessageHandler::ArmQueueTimer() {
+  if (queued_queries_.empty()) {
+    queue_timer_->DisableTimer();
+    return;
+  }
+  // Fire when the oldest queued query expires.
+  auto wait = queued_queries_.front().queued_at +
+              std::chrono::milliseconds(FLAGS_max_query_queue_wait_ms) -
+              dispatcher()->GetTimeSource().MonotonicTime();
+  queue_timer_->EnableTimer(
+      std::max(std::chrono::milliseconds(0), std::chrono::ceil<std::chrono::milliseconds>(wait)));
+}
+
+void ExecuteQueryMessageHandler::RejectQuery(std::unique_ptr<messages::VizierMessage> msg,
+                                             Status reason) {
+  // The error is sent to the query broker from the threadpool, like the results of a query.
+  auto task =
+      std::make_unique<ExecuteQueryTask>(this, carnot_, std::move(msg), std::move(reason));
+  auto query_id = task->query_id();
+  auto runnable = dispatcher()->CreateAsyncTask(std::move(task));
+  auto runnable_ptr = runnable.get();
+  rejected_queries_[query_id] = std::move(runnable);
+  runnable_ptr->Run();
+}
+
+void ExecuteQueryMessageHandler::RunQuery(std::unique_ptr<messages::VizierMessage> msg) {
   // Create a task and run it on the threadpool.
   auto task = std::make_unique<ExecuteQueryTask>(this, carnot_, std::move(msg));
 
@@ -98,18 +217,20 @@ Status ExecuteQueryMessageHandler::HandleMessage(std::unique_ptr<messages::Vizie
   num_queries_in_flight_.Set(running_queries_.size());
   running_queries_[query_id] = std::move(runnable);
   runnable_ptr->Run();
-
-  return Status::OK();
 }
 
 void ExecuteQueryMessageHandler::HandleQueryExecutionComplete(sole::uuid query_id) {
   // Upon completion of the query, we makr the runnable task for deletion.
   auto node = running_queries_.extract(query_id);
+  if (node.empty()) {
+    node = rejected_queries_.extract(query_id);
+  }
   if (node.empty()) {
     LOG(ERROR) << "Attempting to delete non-existent query: " << query_id.str();
     return;
   }
   dispatcher()->DeferredDelete(std::move(node.mapped()));
+  RunQueuedQueries();
 }
 
 }  // namespace agent
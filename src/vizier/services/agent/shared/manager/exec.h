@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include <deque>
 #include <memory>
 
 #include <absl/container/flat_hash_map.h>
@@ -35,6 +36,12 @@ namespace agent {
  * otherwise only query execution is performed.
  *
  * This class runs all of it's work on a thread pool and tracks pending queries internally.
+ *
+ * Queries are admitted while fewer than --max_concurrent_queries are running, and while the
+ * running queries leave enough of --carnot_node_memory_limit_bytes for another query to use its
+ * whole limit. The other queries are queued, and admitted in order as running queries complete.
+ * Queries that don't fit in the queue (--max_queued_queries), or that aren't admitted within
+ * --max_query_queue_wait_ms, fail and their error is sent to the query broker.
  */
 class ExecuteQueryMessageHandler : public Manager::MessageHandler {
  public:
@@ -56,11 +63,30 @@ class ExecuteQueryMessageHandler : public Manager::MessageHandler {
   // Forward declare private task class.
   class ExecuteQueryTask;
 
+  struct QueuedQuery {
+    std::unique_ptr<messages::VizierMessage> msg;
+    px::event::MonotonicTimePoint queued_at;
+  };
+
+  bool CanAdmitQuery() const;
+  void RunQuery(std::unique_ptr<messages::VizierMessage> msg);
+  void RunQueuedQueries();
+  void ExpireQueuedQueries();
+  // Arms the queue timer for the expiry of the oldest queued query.
+  void ArmQueueTimer();
+  void RejectQuery(std::unique_ptr<messages::VizierMessage> msg, Status reason);
+
   carnot::Carnot* carnot_;
   // Map from query_id -> Running query task.
   absl::flat_hash_map<sole::uuid, px::event::RunnableAsyncTaskUPtr> running_queries_;
+  // Map from query_id -> Task that reports the error of a query that wasn't admitted.
+  absl::flat_hash_map<sole::uuid, px::event::RunnableAsyncTaskUPtr> rejected_queries_;
+  // The execute query requests that weren't admitted yet, in the order they were received.
+  std::deque<QueuedQuery> queued_queries_;
+  px::event::TimerUPtr queue_timer_;
 
   prometheus::Gauge& num_queries_in_flight_;
+  prometheus::Gauge& num_queries_queued_;
 };
 
 }  // namespace agent
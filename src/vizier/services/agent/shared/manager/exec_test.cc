@@ -0,0 +1,184 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "src/carnot/carnot.h"
+#include "src/carnot/engine_state.h"
+#include "src/common/testing/testing.h"
+#include "src/common/uuid/uuid_utils.h"
+#include "src/vizier/messages/messagespb/messages.pb.h"
+#include "src/vizier/services/agent/shared/manager/exec.h"
+#include "src/vizier/services/agent/shared/manager/test_utils.h"
+
+DECLARE_int64(max_concurrent_queries);
+DECLARE_int64(max_queued_queries);
+DECLARE_int64(max_query_queue_wait_ms);
+
+namespace px {
+namespace vizier {
+namespace agent {
+
+using ::px::testing::status::StatusIs;
+using ::testing::_;
+using ::testing::HasSubstr;
+using ::testing::InSequence;
+using ::testing::NiceMock;
+using ::testing::Return;
+
+class MockCarnot : public carnot::Carnot {
+ public:
+  MOCK_METHOD(Status, ExecuteQuery,
+              (const std::string& query, const sole::uuid& query_id,
+               types::Time64NSValue time_now, bool analyze),
+              (override));
+  MOCK_METHOD(Status, ExecutePlan,
+              (const carnot::planpb::Plan& plan, const sole::uuid& query_id, bool analyze),
+              (override));
+  MOCK_METHOD(Status, RejectPlan,
+              (const carnot::planpb::Plan& plan, const sole::uuid& query_id, const Status& reason),
+              (override));
+  MOCK_METHOD(void, RegisterAgentMetadataCallback, (AgentMetadataCallbackFunc func), (override));
+  MOCK_METHOD(const carnot::udf::Registry*, FuncRegistry, (), (const, override));
+  MOCK_METHOD(carnot::EngineState*, GetEngineState, (), (override));
+};
+
+class ExecuteQueryMessageHandlerTest : public ::testing::Test {
+ protected:
+  ExecuteQueryMessageHandlerTest() {
+    engine_state_ =
+        carnot::EngineState::CreateDefault(
+            std::make_unique<carnot::udf::Registry>("test_registry"),
+            std::make_shared<table_store::TableStore>(),
+            [](const std::string&, const std::string&)
+                -> std::unique_ptr<carnotpb::ResultSinkService::StubInterface> { return nullptr; },
+            [](grpc::ClientContext*) {}, /* grpc_router */ nullptr)
+            .ConsumeValueOrDie();
+    ON_CALL(carnot_, GetEngineState()).WillByDefault(Return(engine_state_.get()));
+    handler_ = std::make_unique<ExecuteQueryMessageHandler>(&dispatcher_, &agent_info_,
+                                                            /* nats_conn */ nullptr, &carnot_);
+  }
+
+  // Sends an execute query request for a new query to the handler, and returns the query's ID.
+  sole::uuid SendQuery() {
+    auto query_id = sole::uuid4();
+    auto msg = std::make_unique<messages::VizierMessage>();
+    ToProto(query_id, msg->mutable_execute_query_request()->mutable_query_id());
+    EXPECT_OK(handler_->HandleMessage(std::move(msg)));
+    return query_id;
+  }
+
+  FakeDispatcher dispatcher_;
+  agent::Info agent_info_;
+  std::unique_ptr<carnot::EngineState> engine_state_;
+  NiceMock<MockCarnot> carnot_;
+  std::unique_ptr<ExecuteQueryMessageHandler> handler_;
+};
+
+TEST_F(ExecuteQueryMessageHandlerTest, queues_queries_over_max_concurrent_queries) {
+  PX_SET_FOR_SCOPE(FLAGS_max_concurrent_queries, 2);
+  PX_SET_FOR_SCOPE(FLAGS_max_query_queue_wait_ms, 1000);
+
+  std::vector<sole::uuid> query_ids;
+  for (int i = 0; i < 4; ++i) {
+    query_ids.push_back(SendQuery());
+  }
+  // Only the first two queries run, the others wait for one of them to complete.
+  EXPECT_EQ(2, dispatcher_.num_pending_tasks());
+  dispatcher_.AdvanceTime(std::chrono::milliseconds(999));
+  EXPECT_EQ(2, dispatcher_.num_pending_tasks());
+
+  EXPECT_CALL(carnot_, ExecutePlan(_, query_ids[0], _)).WillOnce(Return(Status::OK()));
+  EXPECT_CALL(carnot_, ExecutePlan(_, query_ids[1], _)).WillOnce(Return(Status::OK()));
+  EXPECT_CALL(carnot_, RejectPlan(_, _, _)).Times(0);
+  dispatcher_.RunNextTask();
+  dispatcher_.RunNextTask();
+}
+
+TEST_F(ExecuteQueryMessageHandlerTest, admits_queued_query_when_running_query_completes) {
+  PX_SET_FOR_SCOPE(FLAGS_max_concurrent_queries, 1);
+
+  auto running_query_id = SendQuery();
+  auto queued_query_id = SendQuery();
+  EXPECT_EQ(1, dispatcher_.num_pending_tasks());
+
+  {
+    InSequence s;
+    EXPECT_CALL(carnot_, ExecutePlan(_, running_query_id, _)).WillOnce(Return(Status::OK()));
+    EXPECT_CALL(carnot_, ExecutePlan(_, queued_query_id, _)).WillOnce(Return(Status::OK()));
+  }
+  EXPECT_CALL(carnot_, RejectPlan(_, _, _)).Times(0);
+  // Completing the running query admits the queued one.
+  dispatcher_.RunNextTask();
+  EXPECT_EQ(1, dispatcher_.num_pending_tasks());
+  dispatcher_.RunNextTask();
+  EXPECT_EQ(0, dispatcher_.num_pending_tasks());
+}
+
+TEST_F(ExecuteQueryMessageHandlerTest, rejects_queries_over_max_queued_queries) {
+  PX_SET_FOR_SCOPE(FLAGS_max_concurrent_queries, 1);
+  PX_SET_FOR_SCOPE(FLAGS_max_queued_queries, 1);
+
+  auto running_query_id = SendQuery();
+  SendQuery();
+  auto rejected_query_id = SendQuery();
+  // The running query, and the task that reports the rejected query's error.
+  EXPECT_EQ(2, dispatcher_.num_pending_tasks());
+
+  EXPECT_CALL(carnot_, ExecutePlan(_, running_query_id, _)).WillOnce(Return(Status::OK()));
+  EXPECT_CALL(carnot_, RejectPlan(_, rejected_query_id,
+                                  StatusIs(statuspb::RESOURCE_UNAVAILABLE,
+                                           HasSubstr("1 queries are running and 1 are queued"))))
+      .WillOnce(Return(Status::OK()));
+  dispatcher_.RunNextTask();
+  dispatcher_.RunNextTask();
+  // The queued query was admitted when the running one completed.
+  EXPECT_EQ(1, dispatcher_.num_pending_tasks());
+}
+
+TEST_F(ExecuteQueryMessageHandlerTest, rejects_queries_queued_for_max_query_queue_wait_ms) {
+  PX_SET_FOR_SCOPE(FLAGS_max_concurrent_queries, 1);
+  PX_SET_FOR_SCOPE(FLAGS_max_query_queue_wait_ms, 1000);
+
+  auto running_query_id = SendQuery();
+  auto expired_query_id = SendQuery();
+  EXPECT_EQ(1, dispatcher_.num_pending_tasks());
+  dispatcher_.AdvanceTime(std::chrono::milliseconds(999));
+  EXPECT_EQ(1, dispatcher_.num_pending_tasks());
+  dispatcher_.AdvanceTime(std::chrono::milliseconds(1));
+  EXPECT_EQ(2, dispatcher_.num_pending_tasks());
+
+  EXPECT_CALL(carnot_, ExecutePlan(_, running_query_id, _)).WillOnce(Return(Status::OK()));
+  EXPECT_CALL(carnot_, ExecutePlan(_, expired_query_id, _)).Times(0);
+  EXPECT_CALL(carnot_, RejectPlan(_, expired_query_id,
+                                  StatusIs(statuspb::DEADLINE_EXCEEDED,
+                                           HasSubstr("not admitted within 1000ms"))))
+      .WillOnce(Return(Status::OK()));
+  dispatcher_.RunNextTask();
+  dispatcher_.RunNextTask();
+  EXPECT_EQ(0, dispatcher_.num_pending_tasks());
+}
+
+}  // namespace agent
+}  // namespace vizier
+}  // namespace px
@@ -18,8 +18,11 @@
 
 #pragma once
 
+#include <algorithm>
+#include <deque>
 #include <memory>
 #include <queue>
+#include <set>
 #include <utility>
 #include <vector>
 
@@ -113,6 +116,125 @@ class FakeAgentMetadataStateManager : public md::AgentMetadataStateManager {
   std::queue<std::unique_ptr<md::PIDStatusEvent>> pid_status_events_;
 };
 
+/**
+ * A time source whose time only moves when the test advances it.
+ */
+class FakeTimeSource : public event::TimeSource {
+ public:
+  event::SystemTimePoint SystemTime() const override { return system_time_; }
+  event::MonotonicTimePoint MonotonicTime() const override { return monotonic_time_; }
+
+  void Advance(std::chrono::milliseconds duration) {
+    system_time_ += duration;
+    monotonic_time_ += duration;
+  }
+
+ private:
+  event::SystemTimePoint system_time_ = event::SystemTimePoint(event::kDefaultSimulatedTime);
+  event::MonotonicTimePoint monotonic_time_ =
+      event::MonotonicTimePoint(event::kDefaultSimulatedTime);
+};
+
+/**
+ * A dispatcher that doesn't run anything on its own. Its timers fire when the test advances its
+ * time with AdvanceTime(), and the async tasks that were started run when the test calls
+ * RunNextTask(), so that tests control the order of events. Its timers must not outlive it.
+ */
+class FakeDispatcher : public event::Dispatcher {
+ public:
+  event::TimerUPtr CreateTimer(event::TimerCB cb) override {
+    return std::make_unique<FakeTimer>(this, std::move(cb));
+  }
+  const event::TimeSource& GetTimeSource() const override { return time_source_; }
+  void Stop() override {}
+  void Exit() override {}
+  void Post(event::PostCB callback) override { callback(); }
+  void DeferredDelete(event::DeferredDeletableUPtr&& to_delete) override {
+    deferred_deletes_.push_back(std::move(to_delete));
+  }
+  void Run(RunType) override {}
+  event::RunnableAsyncTaskUPtr CreateAsyncTask(std::unique_ptr<event::AsyncTask> task) override {
+    return std::make_unique<FakeRunnableAsyncTask>(this, std::move(task));
+  }
+  event::MonotonicTimePoint ApproximateMonotonicTime() const override {
+    return time_source_.MonotonicTime();
+  }
+  void UpdateMonotonicTime() override {}
+
+  /**
+   * Moves the time forward, and fires the timers that are due by then.
+   */
+  void AdvanceTime(std::chrono::milliseconds duration) {
+    time_source_.Advance(duration);
+    auto due = [this](const FakeTimer* timer) {
+      return timer->enabled_ && timer->deadline_ <= time_source_.MonotonicTime();
+    };
+    for (auto it = std::find_if(timers_.begin(), timers_.end(), due); it != timers_.end();
+         it = std::find_if(timers_.begin(), timers_.end(), due)) {
+      // The callback may re-arm or destroy the timer.
+      (*it)->enabled_ = false;
+      (*it)->cb_();
+    }
+  }
+
+  /**
+   * The number of async tasks that were started and didn't run yet.
+   */
+  size_t num_pending_tasks() const { return pending_tasks_.size(); }
+
+  /**
+   * Runs the oldest async task that was started: its Work(), then its Done().
+   */
+  void RunNextTask() {
+    CHECK(!pending_tasks_.empty());
+    event::AsyncTask* task = pending_tasks_.front();
+    pending_tasks_.pop_front();
+    task->Work();
+    task->Done();
+  }
+
+ private:
+  class FakeTimer : public event::Timer {
+   public:
+    FakeTimer(FakeDispatcher* dispatcher, event::TimerCB cb)
+        : dispatcher_(dispatcher), cb_(std::move(cb)) {
+      dispatcher_->timers_.insert(this);
+    }
+    ~FakeTimer() override { dispatcher_->timers_.erase(this); }
+
+    void DisableTimer() override { enabled_ = false; }
+    void EnableTimer(const std::chrono::milliseconds& ms) override {
+      enabled_ = true;
+      deadline_ = dispatcher_->time_source_.MonotonicTime() + ms;
+    }
+    bool Enabled() override { return enabled_; }
+
+   private:
+    friend class FakeDispatcher;
+
+    FakeDispatcher* dispatcher_;
+    event::TimerCB cb_;
+    bool enabled_ = false;
+    event::MonotonicTimePoint deadline_;
+  };
+
+  class FakeRunnableAsyncTask : public event::RunnableAsyncTask {
+   public:
+    FakeRunnableAsyncTask(FakeDispatcher* dispatcher, std::unique_ptr<event::AsyncTask> task)
+        : event::RunnableAsyncTask(std::move(task)), dispatcher_(dispatcher) {}
+
+    void Run() override { dispatcher_->pending_tasks_.push_back(task_.get()); }
+
+   private:
+    FakeDispatcher* dispatcher_;
+  };
+
+  FakeTimeSource time_source_;
+  std::set<FakeTimer*> timers_;
+  std::deque<event::AsyncTask*> pending_tasks_;
+  std::vector<event::DeferredDeletableUPtr> deferred_deletes_;
+};
+
 }  // namespace agent
 }  // namespace vizier
 }  // namespace px